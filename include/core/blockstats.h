@@ -0,0 +1,78 @@
+#ifndef BLOCKSTATS_H
+#define BLOCKSTATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "global.h"
+
+#define BLOCKSTATS_BLOCK_SIZE (64 * 1024)
+#define BLOCKSTATS_MAX_LENGTH 0xFFFFFFFFull
+#define BLOCKSTATS_SCAN_CHUNK (1024 * 1024)
+
+struct ByteRangeStats
+{
+  uint64_t histogram[256];
+  uint64_t total;
+};
+
+void ByteRangeStats_Clear(ByteRangeStats* stats);
+void ByteRangeStats_Count(ByteRangeStats* stats, const uint8_t* data, size_t length);
+double ByteRangeStats_Entropy(const ByteRangeStats& stats);
+
+class BlockStatsIndex
+{
+public:
+  BlockStatsIndex();
+  ~BlockStatsIndex();
+
+  bool start(const uint8_t* buffer, uint64_t length);
+  void stop();
+  bool poll();
+  bool isBuiltOn(const uint8_t* buffer, uint64_t length) const { return data && data == buffer && size == length; }
+  bool isReady() const { return ready; }
+  uint32_t getVersion() const { return version; }
+
+  void noteEdit(uint64_t offset, uint8_t newValue);
+  bool query(uint64_t offset, uint64_t length, ByteRangeStats* outStats) const;
+
+private:
+  BlockStatsIndex(const BlockStatsIndex&);
+  BlockStatsIndex& operator=(const BlockStatsIndex&);
+
+  bool launch();
+  void run();
+  void addPrefix(size_t blocks, uint64_t* histogram, bool subtract) const;
+
+#ifdef _WIN32
+  static DWORD WINAPI threadMain(LPVOID param);
+#else
+  static void* threadMain(void* param);
+#endif
+
+  uint32_t* tree;
+  size_t blockCount;
+  const uint8_t* data;
+  uint64_t size;
+  uint64_t indexed;
+  uint32_t version;
+  bool running;
+  bool ready;
+  bool stale;
+  volatile long finished;
+  volatile long cancelRequested;
+
+#ifdef _WIN32
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+};
+
+#endif
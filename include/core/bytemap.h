@@ -0,0 +1,69 @@
+#ifndef BYTEMAP_H
+#define BYTEMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define BYTEMAP_SIDE 256
+#define BYTEMAP_PIXELS (BYTEMAP_SIDE * BYTEMAP_SIDE)
+#define BYTEMAP_MIN_SIDE 16
+#define BYTEMAP_CHUNK_SIZE (4 * 1024 * 1024)
+#define BYTEMAP_MAX_THREADS 8
+#define BYTEMAP_MAX_LENGTH 0xFFFFFFFFull
+
+enum ByteMapView
+{
+  BYTEMAP_DIGRAPH,
+  BYTEMAP_HILBERT
+};
+
+class ByteMap
+{
+public:
+  ByteMap();
+  ~ByteMap();
+
+  bool build(const uint8_t* buffer, uint64_t bufferLength, uint64_t rangeStart, uint64_t rangeLength);
+  void clear();
+  bool isBuiltOn(const uint8_t* buffer, uint64_t length) const { return built && data == buffer && size == length; }
+  bool isTruncated() const { return truncated; }
+  uint64_t getStart() const { return start; }
+  uint64_t getLength() const { return length; }
+  uint64_t getBytesPerPixel() const { return bytesPerPixel; }
+  int getHilbertSide() const { return side; }
+  uint32_t getPairCount(uint8_t first, uint8_t second) const { return pairs[((uint32_t)first << 8) | second]; }
+
+  void noteEdit(uint64_t offset, uint8_t newValue);
+  bool hilbertOffset(int x, int y, uint64_t* outOffset) const;
+  const uint32_t* getImage(ByteMapView view, int* outWidth, int* outHeight, uint32_t* outVersion);
+
+private:
+  ByteMap(const ByteMap&);
+  ByteMap& operator=(const ByteMap&);
+
+  void refreshCells();
+  void renderDigraph();
+  void renderHilbert();
+
+  uint32_t* pairs;
+  uint32_t* cells;
+  uint8_t* dirty;
+  uint32_t* image;
+  const uint8_t* data;
+  uint64_t size;
+  uint64_t start;
+  uint64_t length;
+  uint64_t bytesPerPixel;
+  size_t pixelCount;
+  Vector<uint32_t> dirtyPixels;
+  int side;
+  ByteMapView imageView;
+  bool imageValid;
+  uint32_t version;
+  bool built;
+  bool truncated;
+};
+
+#endif
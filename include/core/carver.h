@@ -0,0 +1,44 @@
+#ifndef CARVER_H
+#define CARVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define CARVE_CHUNK_SIZE (4 * 1024 * 1024)
+#define CARVE_MAX_THREADS 8
+#define CARVE_MAX_RESULTS 65536
+#define CARVE_SEARCH_LIMIT (64ull * 1024 * 1024)
+
+enum CarveFormat
+{
+  CARVE_PE,
+  CARVE_ELF,
+  CARVE_PNG,
+  CARVE_JPEG,
+  CARVE_GIF,
+  CARVE_ZIP,
+  CARVE_GZIP,
+  CARVE_BZIP2,
+  CARVE_XZ,
+  CARVE_7Z,
+  CARVE_SQUASHFS,
+  CARVE_PDF,
+  CARVE_UIMAGE,
+  CARVE_FORMAT_COUNT
+};
+
+struct CarveResult
+{
+  uint64_t offset;
+  uint64_t length;
+  CarveFormat format;
+  bool lengthKnown;
+  char description[64];
+};
+
+const char* CarveFormatName(CarveFormat format);
+bool CarveBuffer(const uint8_t* data, uint64_t size, Vector<CarveResult>* outResults);
+
+#endif
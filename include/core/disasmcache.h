@@ -0,0 +1,89 @@
+#ifndef DISASMCACHE_H
+#define DISASMCACHE_H
+
+#include "global.h"
+
+#define DISASM_BLOCK_LINES 64
+#define DISASM_DEFAULT_LINE_BUDGET 65536
+#define DISASM_MIN_LINE_BUDGET (DISASM_BLOCK_LINES * 4)
+
+struct ByteInterval
+{
+  size_t start;
+  size_t end;
+};
+
+class IntervalSet
+{
+public:
+  IntervalSet();
+  ~IntervalSet();
+
+  void add(size_t start, size_t end);
+  void remove(size_t start, size_t end);
+  bool covers(size_t start, size_t end) const;
+  void clear() { count = 0; }
+
+  size_t size() const { return count; }
+  const ByteInterval& operator[](size_t index) const { return items[index]; }
+
+private:
+  IntervalSet(const IntervalSet&);
+  IntervalSet& operator=(const IntervalSet&);
+
+  size_t lowerBound(size_t offset) const;
+  bool reserve(size_t needed);
+  void splice(size_t first, size_t removeCount, const ByteInterval* insert, size_t insertCount);
+
+  ByteInterval* items;
+  size_t count;
+  size_t capacity;
+};
+
+class DisassemblyCache
+{
+public:
+  DisassemblyCache();
+  ~DisassemblyCache();
+
+  void reset(int bytesPerLine);
+  void clear();
+
+  void setLineBudget(size_t lines);
+  size_t getLineBudget() const { return lineBudget; }
+  size_t getStoredLines() const { return blockCount * DISASM_BLOCK_LINES; }
+
+  bool covers(size_t startOffset, size_t endOffset);
+  void markCovered(size_t startOffset, size_t endOffset);
+
+  bool setLine(size_t lineIndex, const char* text);
+  const char* getLine(size_t lineIndex) const;
+
+  void trim();
+
+private:
+  DisassemblyCache(const DisassemblyCache&);
+  DisassemblyCache& operator=(const DisassemblyCache&);
+
+  struct Block
+  {
+    size_t index;
+    uint64_t lastUsed;
+    SimpleString* lines;
+  };
+
+  size_t findBlock(size_t blockIndex) const;
+  Block* getOrCreateBlock(size_t blockIndex);
+  void touchRange(size_t startOffset, size_t endOffset);
+  void evictBlock(size_t position);
+
+  IntervalSet coverage;
+  Block* blocks;
+  size_t blockCount;
+  size_t blockCapacity;
+  size_t lineBudget;
+  uint64_t clock;
+  int bytesPerLine;
+};
+
+#endif
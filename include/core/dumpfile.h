@@ -0,0 +1,29 @@
+#ifndef DUMPFILE_H
+#define DUMPFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+#include "processmemory.h"
+
+#define DUMP_PROBE_SIZE 64
+
+enum DumpFormat
+{
+  DUMP_FORMAT_NONE,
+  DUMP_FORMAT_ELF_CORE,
+  DUMP_FORMAT_MINIDUMP
+};
+
+struct DumpSegment
+{
+  MemoryRegion region;
+  uint64_t dumpOffset;
+  uint64_t storedSize;
+};
+
+DumpFormat DetectDumpFormat(const uint8_t* data, size_t size);
+bool ParseDumpSegments(const uint8_t* data, uint64_t size, Vector<DumpSegment>* outSegments);
+
+#endif
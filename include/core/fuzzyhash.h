@@ -0,0 +1,92 @@
+#ifndef FUZZYHASH_H
+#define FUZZYHASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define FUZZY_CHUNK_SIZE (1024 * 1024)
+#define FUZZY_MAX_MATCHES 16
+#define FUZZY_NAME_LEN 128
+#define FUZZY_ERROR_LEN 128
+
+#define SSDEEP_SPAMSUM_LENGTH 64
+#define SSDEEP_NUM_BLOCKHASHES 31
+#define SSDEEP_MAX_RESULT (2 * SSDEEP_SPAMSUM_LENGTH + 20)
+
+#define TLSH_BUCKETS 256
+#define TLSH_EFF_BUCKETS 128
+#define TLSH_CODE_SIZE 32
+#define TLSH_MIN_LENGTH 50
+#define TLSH_MAX_RESULT (2 * (TLSH_CODE_SIZE + 3) + 3)
+#define TLSH_MATCH_DISTANCE 100
+
+class SsdeepHasher
+{
+public:
+  SsdeepHasher();
+
+  void reset(uint64_t totalLength);
+  void update(const uint8_t* data, size_t length);
+  bool digest(char* out, size_t max) const;
+
+private:
+  struct BlockHash
+  {
+    uint32_t index;
+    char digest[SSDEEP_SPAMSUM_LENGTH];
+    char halfDigest;
+    uint8_t h;
+    uint8_t halfH;
+  };
+
+  void forkBlockHash();
+  void reduceBlockHash();
+
+  BlockHash hashes[SSDEEP_NUM_BLOCKHASHES];
+  uint32_t first;
+  uint32_t last;
+  uint32_t limit;
+  uint64_t total;
+  uint8_t window[7];
+  uint32_t windowIndex;
+  uint32_t h1;
+  uint32_t h2;
+  uint32_t h3;
+};
+
+class TlshHasher
+{
+public:
+  TlshHasher();
+
+  void reset();
+  void update(const uint8_t* data, size_t length);
+  bool digest(char* out, size_t max) const;
+
+private:
+  uint64_t buckets[TLSH_BUCKETS];
+  uint64_t length;
+  uint8_t window[4];
+  uint8_t checksum;
+};
+
+struct FuzzyDigests
+{
+  char ssdeep[SSDEEP_MAX_RESULT];
+  char tlsh[TLSH_MAX_RESULT];
+};
+
+struct FuzzyMatch
+{
+  char name[FUZZY_NAME_LEN];
+  int ssdeepScore;
+  int tlshDistance;
+};
+
+int SsdeepCompare(const char* a, const char* b);
+int TlshDistance(const char* a, const char* b);
+size_t FuzzyMatchDigestList(const char* text, size_t length, const FuzzyDigests& digests, Vector<FuzzyMatch>* outMatches);
+
+#endif
@@ -275,7 +275,7 @@ inline void itoaDec(long long value, char* out, int max)
   int i = 0;
 
   bool neg = value < 0;
-  unsigned long long v = neg ? -value : value;
+  unsigned long long v = neg ? 0 - (unsigned long long)value : (unsigned long long)value;
 
   do
   {
@@ -743,6 +743,28 @@ public:
     count--;
   }
 
+  void insert(size_t index, const T& item)
+  {
+    if (index >= count)
+    {
+      push_back(item);
+      return;
+    }
+
+    T copy(item);
+    T last(data[count - 1]);
+    push_back(last);
+
+    for (size_t i = count - 2; i > index; i--)
+    {
+      data[i].~T();
+      new (&data[i]) T(data[i - 1]);
+    }
+
+    data[index].~T();
+    new (&data[index]) T(copy);
+  }
+
   T& operator[](size_t index) { return data[index]; }
   const T& operator[](size_t index) const { return data[index]; }
   size_t size() const { return count; }
@@ -5,52 +5,88 @@
 
 #include "global.h"
 #include "pluginexecutor.h"
+#include "pluginresultcache.h"
+#include "disasmcache.h"
+#include "processmemory.h"
+#include "memorywatch.h"
+#include "valuescanner.h"
+#include "carver.h"
+#include "structure.h"
+#include "template.h"
+#include "stringindex.h"
+#include "transform.h"
+#include "fuzzyhash.h"
+#include "bytemap.h"
+#include "blockstats.h"
+#include "x86decoder.h"
+#include "projectfile.h"
 #include "options.h"
 
 #define MAX_PLUGINS 10
 
-struct MemoryRegion
-{
-  uint64_t virtualAddress;
-  size_t bufferOffset;
-  size_t size;
-};
-
 class HexData
 {
 public:
-  struct DisasmCache
-  {
-    size_t startOffset;
-    size_t endOffset;
-    bool valid;
-  };
-  Vector<DisasmCache> disasmRanges;
   Vector<MemoryRegion> memoryMap;
   HexData();
   ~HexData();
 
   ByteBuffer fileData;
   bool virtualAddressToOffset(uint64_t virtualAddress, size_t* outOffset) const;
+  bool offsetToVirtualAddress(size_t offset, uint64_t* outVirtualAddress) const;
+  const MemoryRegion* findMemoryRegion(size_t offset) const;
+  bool resolveGoToTarget(uint64_t value, size_t* outOffset) const;
   bool loadFile(const char* filepath);
+  bool attachProcess(int pid, const Vector<MemoryRegion>& regions);
+  bool attachDump(const char* filepath);
+  bool commitProcessEdits(Vector<ProcessWriteFailure>* failures = nullptr);
+  ProcessMemorySource* getProcessSource() const { return processSource; }
+  bool startMemoryWatch(uint32_t intervalMs = WATCH_DEFAULT_INTERVAL_MS);
+  void stopMemoryWatch();
+  bool isWatchingMemory() const { return memoryWatch && memoryWatch->isRunning(); }
+  MemoryWatch* getMemoryWatch() const { return memoryWatch; }
+  bool pollMemoryWatch();
+  ValueScanner& getValueScanner() { return valueScanner; }
+  const ValueScanner& getValueScanner() const { return valueScanner; }
+  void getScanTarget(ScanTarget* outTarget);
+  bool carveEmbeddedFiles(Vector<CarveResult>* outResults) const;
+  StructureDecoder* getStructure();
+  bool loadTemplate(const char* path, char* outError, size_t errorMax);
+  void clearTemplate();
+  TemplateEngine* getTemplate();
+  bool extractStrings(uint32_t minLength = STRING_MIN_LENGTH);
+  StringIndex* getStrings();
+  bool addTransformStep(const TransformStep& step, uint64_t start, uint64_t length, char* outError, size_t errorMax);
+  TransformPipeline* getTransform() const { return transform; }
+  void discardTransform();
+  bool commitTransform(char* outError, size_t errorMax);
+  bool computeFuzzyDigests(uint64_t start, uint64_t length, bool ssdeep, bool tlsh, FuzzyDigests* outDigests) const;
+  bool matchDigestList(const char* path, const FuzzyDigests& digests, Vector<FuzzyMatch>* outMatches, size_t* outScanned, char* outError, size_t errorMax);
+  bool buildByteMap(uint64_t start, uint64_t length);
+  ByteMap* getByteMap();
+  BlockStatsIndex* getBlockStats();
+  bool getRangeStats(uint64_t start, uint64_t length, ByteRangeStats* outStats, uint64_t maxScanBytes = ~0ull);
   bool saveFile(const char* filepath);
   void clear();
 
   bool isRangeDisassembled(size_t startOffset, size_t endOffset);
   void disassembleRange(size_t offset, size_t size);
   void clearDisassemblyCache();
+  void setDisassemblyLineBudget(size_t lines) { disasmCache.setLineBudget(lines); }
+  const char* getDisassemblyLine(size_t lineIndex) const { return disasmCache.getLine(lineIndex); }
 
   const LineArray& getHexLines() const { return hexLines; }
-  const LineArray& getDisassemblyLines() const { return disassemblyLines; }
   const SimpleString& getHeaderLine() const { return headerLine; }
 
-  size_t getFileSize() const { return fileData.size; }
-  bool isEmpty() const { return fileData.size == 0; }
+  size_t getFileSize() const { return processSource ? (size_t)processSource->getSize() : fileData.size; }
+  bool isEmpty() const { return getFileSize() == 0; }
   int getCurrentBytesPerLine() const { return currentBytesPerLine; }
+  int getOffsetDigits() const { return offsetDigits; }
 
   bool editByte(size_t offset, uint8_t newValue);
   uint8_t getByte(size_t offset) const;
   uint8_t readByte(size_t offset) const { return getByte(offset); }
+  size_t readBytes(size_t offset, uint8_t* out, size_t length) const;
 
   bool isModified() const { return modified; }
   void setModified(bool mod) { modified = mod; }
@@ -60,6 +96,7 @@ public:
 
   void setMemoryMap(const Vector<MemoryRegion>& map) {
     memoryMap = map;
+    SortMemoryRegions(memoryMap);
     isProcessMemory = true;
   }
 
@@ -87,15 +124,20 @@ public:
 
   void generateDisassemblyFromPlugin(int bytesPerLine);
   void setArchitecture(int arch, int mode);
+  X86Mode getDisassemblyMode() const;
 
   PluginBookmarkArray* getPluginAnnotations() { return &pluginAnnotations; }
   const PluginBookmarkArray* getPluginAnnotations() const { return &pluginAnnotations; }
   void clearPluginAnnotations();
-  void executeBookmarkPlugins();
+  const PluginBookmark* findPluginAnnotation(uint64_t offset) const;
+  bool executeBookmarkPlugins(PluginProgressCallback progress = nullptr, void* userData = nullptr);
   void convertDataToHex(int bytesPerLine);
 
   void getHexLine(size_t lineIndex, char* outBuffer, size_t bufferSize) const;
 
+  void invalidateContentHash() { contentHashValid = false; }
+  uint64_t getContentFingerprint() const;
+
 private:
   char pluginPaths[MAX_PLUGINS][512];
   int pluginCount;
@@ -105,14 +147,20 @@ private:
   bool usePlugin;
 
   void generateHeader(int bytesPerLine);
+  void updateOffsetDigits();
+  size_t findMemoryRegionIndex(size_t offset) const;
   void generateDisassembly(int bytesPerLine);
   void disassembleInstruction(size_t offset, int& instructionLength, SimpleString& outInstr);
+  void disassembleNative(size_t offset, size_t size);
+  uint64_t disassemblyAddress(size_t offset) const;
   bool initializeCapstone();
   void cleanupCapstone();
+  bool getPluginCacheKey(const char* pluginPath, PluginCacheKey* outKey);
+  void bindTemplate();
 
 private:
   LineArray hexLines;
-  LineArray disassemblyLines;
+  DisassemblyCache disasmCache;
   SimpleString headerLine;
   int currentBytesPerLine;
   bool modified;
@@ -121,5 +169,18 @@ private:
   int currentMode;
   size_t csHandle;
   PluginBookmarkArray pluginAnnotations;
+  StructureDecoder structure;
+  TemplateEngine templateEngine;
+  StringIndex strings;
+  TransformPipeline* transform;
+  ByteMap byteMap;
+  BlockStatsIndex blockStats;
+  uint64_t contentHash;
+  bool contentHashValid;
+  int pendingCacheWrites;
+  ProcessMemorySource* processSource;
+  MemoryWatch* memoryWatch;
+  ValueScanner valueScanner;
+  int offsetDigits;
 };
 #endif
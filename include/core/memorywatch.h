@@ -0,0 +1,141 @@
+#ifndef MEMORYWATCH_H
+#define MEMORYWATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "global.h"
+#include "processmemory.h"
+
+#define WATCH_PAGE_SIZE 4096
+#define WATCH_MASK_BYTES (WATCH_PAGE_SIZE / 8)
+#define WATCH_DEFAULT_INTERVAL_MS 1000
+#define WATCH_DEFAULT_GENERATIONS 16
+#define WATCH_MAX_GENERATIONS 256
+#define WATCH_SCAN_CHUNK (PROCESS_SNAPSHOT_BATCH_BYTES * 4)
+#define WATCH_SHADOW_LIMIT (256ULL * 1024 * 1024)
+#define WATCH_MAX_DETAILED_PAGES 4096
+
+struct WatchPage
+{
+  uint64_t index;
+  uint8_t* before;
+  uint8_t* mask;
+};
+
+struct WatchGeneration
+{
+  uint32_t serial;
+  uint64_t timestamp;
+  size_t changedBytes;
+  Vector<WatchPage> pages;
+};
+
+struct WatchGenerationInfo
+{
+  uint32_t serial;
+  uint64_t timestamp;
+  size_t changedPages;
+  size_t changedBytes;
+};
+
+class MemoryWatch
+{
+public:
+  MemoryWatch();
+  ~MemoryWatch();
+
+  bool start(int pid, const Vector<MemoryRegion>& regions,
+             uint32_t intervalMs = WATCH_DEFAULT_INTERVAL_MS);
+  void stop();
+  bool isRunning() const { return running; }
+
+  bool setHistoryDepth(size_t generations);
+  size_t getHistoryDepth() const { return ringCapacity; }
+  uint64_t getWatchedBytes() const { return watchedBytes; }
+  bool hasExactDiffs() const { return shadow != nullptr; }
+
+  bool poll();
+
+  size_t getGenerationCount();
+  bool getGenerationInfo(size_t index, WatchGenerationInfo* out);
+
+  void selectLive() { selectedSerial = 0; }
+  bool isLive() const { return selectedSerial == 0; }
+  bool stepGeneration(int delta);
+  int getSelectedGeneration();
+
+  size_t getChangeFlags(uint64_t offset, size_t length, uint8_t* outFlags);
+  void overlayHistory(uint64_t offset, uint8_t* data, size_t length);
+
+private:
+  MemoryWatch(const MemoryWatch&);
+  MemoryWatch& operator=(const MemoryWatch&);
+
+  struct WatchSpan
+  {
+    uint64_t start;
+    uint64_t end;
+    uint64_t shadowOffset;
+  };
+
+#ifdef _WIN32
+  static DWORD WINAPI threadMain(LPVOID param);
+#else
+  static void* threadMain(void* param);
+#endif
+
+  void run();
+  void scan(bool baseline);
+  void recordChange(WatchGeneration* generation, uint64_t pageIndex,
+                    const uint8_t* data, size_t length, uint8_t* known);
+  void publish(WatchGeneration* generation);
+  bool sleepInterval();
+  bool shouldStop();
+
+  void lock();
+  void unlock();
+
+  WatchGeneration* generationAt(size_t index) const;
+  int findSelectedLocked() const;
+  static size_t findPage(const WatchGeneration* generation, uint64_t pageIndex);
+  static void freeGeneration(WatchGeneration* generation);
+
+  ProcessMemorySource source;
+  Vector<WatchSpan> spans;
+  uint64_t watchedBytes;
+  uint32_t intervalMs;
+
+  uint64_t* pageHashes;
+  size_t pageCount;
+  uint8_t* shadow;
+  uint8_t* scratch;
+
+  WatchGeneration** ring;
+  size_t ringCapacity;
+  size_t ringHead;
+  size_t ringCount;
+  uint32_t nextSerial;
+  uint32_t latestSerial;
+  uint32_t seenSerial;
+  uint32_t selectedSerial;
+
+  bool running;
+  bool stopRequested;
+
+#ifdef _WIN32
+  HANDLE thread;
+  CRITICAL_SECTION mutex;
+#else
+  pthread_t thread;
+  pthread_mutex_t mutex;
+#endif
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "render.h"
 #include "menu.h"
 #include "options.h"
+#include "bytemap.h"
 
 struct PatternSearchState
 {
@@ -16,6 +17,14 @@ struct ChecksumState
     bool sha1;
     bool sha256;
     bool crc32;
+    bool ssdeep;
+    bool tlsh;
+    bool entireFile;
+};
+
+struct ByteMapPanelState
+{
+    ByteMapView view;
     bool entireFile;
 };
 
@@ -93,6 +102,26 @@ struct ByteStatistics {
     bool computed;
 };
 
+struct StructurePanelState {
+    int firstRow;
+};
+
+#define STRUCTURE_PANEL_ROWS 16
+
+struct TemplatePanelState {
+    int firstRow;
+};
+
+#define TEMPLATE_PANEL_ROWS 16
+
+struct StringsPanelState {
+    size_t firstRow;
+};
+
+#define STRINGS_PANEL_ROWS 16
+
+#define ENTROPY_PROFILE_MAX_BARS 256
+
 struct DetectItEasyState {
     bool analyzed;
     char fileType[64];
@@ -108,6 +137,10 @@ extern CompareState       g_Compare;
 extern BookmarksState     g_Bookmarks;
 extern ByteStatistics     g_ByteStats;
 extern int g_PluginAnnotationHoveredIndex;
+extern StructurePanelState g_StructurePanel;
+extern TemplatePanelState g_TemplatePanel;
+extern StringsPanelState g_StringsPanel;
+extern ByteMapPanelState g_ByteMapPanel;
 
 Rect GetBookmarkRect(int bookmarkIndex, const Rect& panelBounds);
 void Bookmarks_UpdateValues();
@@ -121,10 +154,20 @@ void Checksum_ToggleMD5();
 void Checksum_ToggleSHA1();
 void Checksum_ToggleSHA256();
 void Checksum_ToggleCRC32();
+void Checksum_ToggleSsdeep();
+void Checksum_ToggleTlsh();
 void Checksum_SetModeEntireFile();
 void Checksum_SetModeSelection();
 void Checksum_Compare();
 void Checksum_Compute();
+bool Checksum_CompareList(const char* path, char* outError, size_t errorMax);
+
+Rect ByteMap_GetImageRect(int contentX, int contentY, int contentWidth, int contentHeight);
+void ByteMap_SetView(ByteMapView view);
+void ByteMap_SetModeEntireFile();
+void ByteMap_SetModeSelection();
+void ByteMap_Compute();
+void ByteMap_Activate(int x, int y, const Rect& imageRect);
 
 void Compare_OpenFileDialog();
 void Compare_Run();
@@ -133,13 +176,27 @@ bool HandleBottomPanelContentClick(int x, int y, int windowWidth, int windowHeig
 bool HandleLeftPanelContentClick(int x, int y, int windowWidth, int windowHeight);
 
 void Bookmarks_Add(long long byteOffset, const char* name, Color color);
+int Bookmarks_Insert(const Bookmark& bm);
+int Bookmarks_LowerBound(long long byteOffset);
 void Bookmarks_Remove(int index);
 void Bookmarks_JumpTo(int index);
 void Bookmarks_clear();
+void Structure_Scroll(int rows);
+void Structure_Activate(int nodeIndex);
+void Template_Scroll(int rows);
+void Template_Activate(int nodeIndex);
+void Strings_Scroll(long long rows);
+void Strings_ShowNear(long long byteOffset);
+void Strings_Activate(size_t index);
 int Bookmarks_findAtOffset(long long byteOffset);
 const Bookmark* Bookmarks_GetAtOffset(long long byteOffset);
+bool PluginAnnotations_UpdateHover(long long byteOffset);
+bool Project_Load(const char* filePath);
+bool Project_Save(const char* filePath);
 
 void ByteStats_Compute(HexData& hexData);
+int DataInspector_RowCount();
+int Entropy_GetProfile(int barCount, const float** outValues);
 void ByteStats_clear();
 
 void InitializeLeftPanelSections(Vector<PanelSection>& sections, HexData& hexData);
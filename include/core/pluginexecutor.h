@@ -6,6 +6,24 @@
 
 struct LineArray;
 struct PluginInfo;
+struct MemoryRegion;
+
+#define PLUGIN_BOOKMARK_CHUNK_ENTRY "generate_bookmarks_chunk"
+#define PLUGIN_BOOKMARK_CHUNK_SIZE (4 * 1024 * 1024)
+#define PLUGIN_BOOKMARK_REPORT_INTERVAL 256
+#define PLUGIN_BOOKMARK_MAX_WHOLE_READ (256 * 1024 * 1024)
+
+typedef bool (*PluginProgressCallback)(void* userData, size_t bookmarkCount,
+                                       uint64_t bytesProcessed, uint64_t bytesTotal);
+
+typedef size_t (*PluginDataReader)(void* context, uint64_t offset, uint8_t* out, size_t length);
+
+struct PluginDataView {
+  const uint8_t* data;
+  uint64_t size;
+  PluginDataReader read;
+  void* context;
+};
 
 struct PluginColor {
   uint8_t r;
@@ -32,6 +50,30 @@ struct PluginBookmarkArray {
   size_t capacity;
 };
 
+enum PluginEntryPoint {
+  PLUGIN_ENTRY_GET_INFO = 0,
+  PLUGIN_ENTRY_DISASSEMBLE,
+  PLUGIN_ENTRY_GENERATE_BOOKMARKS,
+  PLUGIN_ENTRY_TRANSFORM,
+  PLUGIN_ENTRY_COUNT
+};
+
+struct PluginCallStats {
+  uint64_t calls;
+  uint64_t totalMicros;
+  uint64_t maxMicros;
+  uint64_t bytesIn;
+  uint64_t results;
+  uint64_t errors;
+};
+
+struct PluginProfile {
+  char path[512];
+  char moduleName[128];
+  char lastError[256];
+  PluginCallStats entries[PLUGIN_ENTRY_COUNT];
+};
+
 bool InitializePythonRuntime();
 void ShutdownPythonRuntime();
 
@@ -45,13 +87,27 @@ static void ExtractModuleName(const char* pluginPath, char* moduleName, int maxL
 void pba_init(PluginBookmarkArray* arr);
 void pba_push_back(PluginBookmarkArray* arr, const PluginBookmark* bookmark);
 void pba_free(PluginBookmarkArray* arr);
+void pba_sort(PluginBookmarkArray* arr);
+void pba_merge_tail(PluginBookmarkArray* arr, size_t sortedCount);
+size_t pba_lower_bound(const PluginBookmarkArray* arr, uint64_t offset);
 bool CanPluginGenerateBookmarks(const char* pluginPath);
 
 bool ExecutePluginBookmarks(
   const char* pluginPath,
-  const uint8_t* data,
-  size_t dataSize,
-  PluginBookmarkArray* outBookmarks);
+  const PluginDataView* view,
+  PluginBookmarkArray* outBookmarks,
+  const Vector<MemoryRegion>* memoryMap,
+  PluginProgressCallback progress = nullptr,
+  void* userData = nullptr,
+  bool* outCancelled = nullptr);
+
+int GetPluginProfileCount();
+const PluginProfile* GetPluginProfileAt(int index);
+const PluginProfile* FindPluginProfile(const char* pluginPath);
+void GetPluginProfileTotals(const PluginProfile* profile, PluginCallStats* outTotals);
+const char* GetPluginEntryPointName(int entryPoint);
+void ResetPluginProfiles();
+bool ExportPluginProfiles(const char* outputPath);
 
 bool ExecutePythonDisassembly(
   const char* pluginPath,
@@ -60,4 +116,13 @@ bool ExecutePythonDisassembly(
   size_t offset,
   LineArray* outLines);
 
+bool ExecutePluginTransform(
+  const char* pluginPath,
+  const uint8_t* data,
+  size_t length,
+  uint64_t position,
+  ByteBuffer* outData,
+  char* outError,
+  size_t errorMax);
+
 #endif
@@ -0,0 +1,38 @@
+#ifndef PLUGINRESULTCACHE_H
+#define PLUGINRESULTCACHE_H
+
+#include "global.h"
+#include "pluginexecutor.h"
+
+#define PLUGIN_CACHE_FILE_NAME "plugin_cache.bin"
+#define PLUGIN_CACHE_DEFAULT_BUDGET (64 * 1024 * 1024)
+
+enum PluginCacheKind
+{
+  PLUGIN_CACHE_BOOKMARKS = 1,
+  PLUGIN_CACHE_DISASSEMBLY = 2
+};
+
+struct PluginCacheKey
+{
+  uint64_t contentHash;
+  uint64_t contentSize;
+  const char* pluginPath;
+};
+
+uint64_t PluginCache_HashContent(const uint8_t* data, size_t size);
+
+void PluginCache_SetBudget(size_t maxBytes);
+size_t PluginCache_GetBudget();
+size_t PluginCache_GetUsage();
+
+bool PluginCache_GetBookmarks(const PluginCacheKey* key, PluginBookmarkArray* outBookmarks);
+void PluginCache_PutBookmarks(const PluginCacheKey* key, const PluginBookmark* bookmarks, size_t count);
+
+bool PluginCache_GetDisassembly(const PluginCacheKey* key, size_t offset, size_t size, SimpleString* outText);
+void PluginCache_PutDisassembly(const PluginCacheKey* key, size_t offset, size_t size, const char* text);
+
+bool PluginCache_Flush();
+void PluginCache_Clear();
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef PROCESSMEMORY_H
+#define PROCESSMEMORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define PROCESS_PAGE_SIZE 65536
+#define PROCESS_CACHE_WAYS 4
+#define PROCESS_DEFAULT_PAGE_BUDGET 1024
+#define PROCESS_MIN_PAGE_BUDGET (PROCESS_CACHE_WAYS * 4)
+#define PROCESS_CACHE_BYPASS_SIZE (PROCESS_PAGE_SIZE * 16)
+#define PROCESS_SNAPSHOT_SLICE (4 * 1024 * 1024)
+#define PROCESS_SNAPSHOT_BATCH_BYTES (16 * 1024 * 1024)
+#define PROCESS_SNAPSHOT_MAX_THREADS 8
+
+#define MEMORY_PROT_READ 0x1
+#define MEMORY_PROT_WRITE 0x2
+#define MEMORY_PROT_EXEC 0x4
+#define MEMORY_PROT_SHARED 0x8
+
+#define MEMORY_REGION_NAME_LEN 128
+
+struct MemoryRegion
+{
+  uint64_t virtualAddress;
+  size_t bufferOffset;
+  size_t size;
+  uint32_t protection;
+  uint64_t fileOffset;
+  char name[MEMORY_REGION_NAME_LEN];
+};
+
+void SortMemoryRegions(Vector<MemoryRegion>& regions);
+void FormatMemoryProtection(uint32_t protection, char* out);
+
+struct ProcessReadFailure
+{
+  uint64_t virtualAddress;
+  size_t bufferOffset;
+  size_t size;
+  int error;
+};
+
+struct ProcessWriteFailure
+{
+  uint64_t virtualAddress;
+  size_t bufferOffset;
+  size_t size;
+  int error;
+};
+
+struct ProcessByteEdit
+{
+  uint64_t offset;
+  uint8_t value;
+};
+
+class ProcessMemorySource
+{
+public:
+  ProcessMemorySource();
+  ~ProcessMemorySource();
+
+  bool attach(int pid, const Vector<MemoryRegion>& regions);
+  bool attachDump(const char* path);
+  void detach();
+
+  bool isAttached() const { return pid > 0 || mappedBase != nullptr; }
+  bool isDump() const { return mappedBase != nullptr; }
+  const char* getDumpPath() const { return dumpPath; }
+  int getPid() const { return pid; }
+  uint64_t getSize() const { return totalSize; }
+  const Vector<MemoryRegion>& getRegions() const { return regions; }
+
+  size_t read(uint64_t offset, uint8_t* out, size_t length);
+  uint8_t readByte(uint64_t offset);
+  size_t snapshot(uint64_t offset, uint8_t* dest, size_t length,
+                  Vector<ProcessReadFailure>* failures = nullptr);
+
+  bool writeByte(uint64_t offset, uint8_t value);
+  const Vector<ProcessByteEdit>& getEdits() const { return edits; }
+  void clearEdits();
+  bool canCommitEdits() const { return pid > 0 && !edits.empty(); }
+  bool commitEdits(Vector<ProcessWriteFailure>* failures = nullptr);
+
+  void setPageBudget(size_t pages);
+  size_t getPageBudget() const { return setCount * PROCESS_CACHE_WAYS; }
+  void invalidate();
+
+private:
+  ProcessMemorySource(const ProcessMemorySource&);
+  ProcessMemorySource& operator=(const ProcessMemorySource&);
+
+  struct DumpExtent
+  {
+    uint64_t dumpOffset;
+    uint64_t storedSize;
+  };
+
+  struct CachedPage
+  {
+    uint64_t index;
+    uint64_t lastUsed;
+    uint8_t* data;
+    size_t length;
+  };
+
+  bool allocateCache(size_t pages);
+  void freeCache();
+  CachedPage* fetchPage(uint64_t pageIndex);
+  size_t findRegion(uint64_t offset) const;
+  void readRemote(uint64_t offset, uint8_t* out, size_t length);
+  void readMapped(uint64_t offset, uint8_t* out, size_t length) const;
+  bool mapDump(const char* path);
+  void unmapDump();
+  void applyEdits(uint64_t offset, uint8_t* out, size_t length) const;
+  size_t lowerBoundEdit(uint64_t offset) const;
+
+  int pid;
+  int memFd;
+  uint64_t totalSize;
+  Vector<MemoryRegion> regions;
+  Vector<ProcessByteEdit> edits;
+  Vector<DumpExtent> extents;
+
+  const uint8_t* mappedBase;
+  uint64_t mappedSize;
+  void* dumpFile;
+  void* dumpMapping;
+  char dumpPath[512];
+
+  CachedPage* pages;
+  size_t setCount;
+  uint64_t clock;
+  CachedPage* lastPage;
+};
+
+#endif
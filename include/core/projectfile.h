@@ -0,0 +1,88 @@
+#ifndef PROJECTFILE_H
+#define PROJECTFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+#include "pluginexecutor.h"
+
+#define PROJECT_FILE_EXTENSION ".hvproj"
+#define PROJECT_JOURNAL_LIMIT (1024 * 1024)
+#define PROJECT_PATH_MAX 520
+#define PROJECT_FINGERPRINT_WINDOW 2048
+#define PROJECT_FINGERPRINT_WINDOWS 16
+
+struct ProjectBookmark
+{
+  uint64_t offset;
+  const char* name;
+  const char* description;
+  uint32_t color;
+  uint8_t byteValue;
+};
+
+struct ProjectViewState
+{
+  int64_t cursor;
+  int64_t selectionStart;
+  int64_t selectionEnd;
+  uint64_t topByte;
+  uint32_t nibble;
+  bool selectionActive;
+};
+
+class ProjectFile
+{
+public:
+  ProjectFile();
+  ~ProjectFile();
+
+  bool open(const char* dataPath, uint64_t contentSize, uint64_t fingerprint);
+  void close();
+  void reset();
+  bool isOpen() const { return mappedBase != nullptr; }
+
+  size_t getBookmarkCount() const;
+  bool getBookmark(size_t index, ProjectBookmark* outBookmark) const;
+  size_t getAnnotationCount() const;
+  bool loadAnnotations(PluginBookmarkArray* outAnnotations) const;
+  const ProjectViewState& getViewState() const { return view; }
+
+  bool save(const char* dataPath, uint64_t contentSize, uint64_t fingerprint,
+            const ProjectBookmark* bookmarks, size_t bookmarkCount,
+            const PluginBookmarkArray* annotations, const ProjectViewState& viewState);
+  bool saveView(const char* dataPath, const ProjectBookmark* bookmarks, size_t bookmarkCount,
+                const ProjectViewState& viewState);
+
+private:
+  ProjectFile(const ProjectFile&);
+  ProjectFile& operator=(const ProjectFile&);
+
+  bool map(const char* path);
+  bool parse(uint64_t contentSize, uint64_t fingerprint);
+
+  char path[PROJECT_PATH_MAX];
+  const uint8_t* mappedBase;
+  uint64_t mappedSize;
+  void* mappedFile;
+  void* mappedMapping;
+
+  const uint8_t* snapshot;
+  const uint8_t* current;
+  bool contentMatches;
+  ProjectViewState view;
+
+  bool stored;
+  uint64_t storedContentSize;
+  uint64_t storedFingerprint;
+  uint64_t storedAnnotationHash;
+  uint64_t snapshotEnd;
+  uint64_t journalEnd;
+
+  bool baseValid;
+  uint64_t baseContentSize;
+  uint64_t baseFingerprint;
+};
+
+#endif
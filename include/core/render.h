@@ -13,6 +13,7 @@
 #endif
 
 #include "global.h"
+#include "fuzzyhash.h"
 
 struct PatternSearchState;
 struct ChecksumState;
@@ -262,7 +263,8 @@ struct BottomPanelState
     EntropyAnalysis,
     PatternSearch,
     Checksum,
-    Compare
+    Compare,
+    ByteMap
   };
 
   bool visible;
@@ -457,10 +459,14 @@ struct ChecksumResults
   char *sha256;
   char *crc32;
   bool calculating;
+  FuzzyDigests fuzzy;
+  bool fuzzyValid;
+  Vector<FuzzyMatch> matches;
+  size_t digestsScanned;
 
   ChecksumResults()
       : md5(nullptr), sha1(nullptr), sha256(nullptr),
-        crc32(nullptr), calculating(false) {}
+        crc32(nullptr), calculating(false), fuzzyValid(false), digestsScanned(0) {}
 
   ~ChecksumResults()
   {
@@ -624,6 +630,7 @@ public:
 #else
   void drawX11Pixmap(Pixmap pixmap, int width, int height, int x, int y);
 #endif
+  void drawPixelImage(const uint32_t* pixels, int width, int height, uint32_t version, const Rect& dest);
 
   void drawDropdown(const WidgetState& state, const Theme& theme, const char* selectedText, bool isOpen, const Vector<char*>& items, int selectedIndex, int hoveredIndex, int scrollOffset);
   void renderHexViewer(const Vector<char*>& hexLines, const char* headerLine, int scrollPos, int maxScrollPos, bool scrollbarHovered, bool scrollbarPressed, const Rect& scrollbarRect, const Rect& thumbRect, bool darkMode, int editingRow, int editingCol, const char* editBuffer, long long cursorBytePos, int cursorNibblePos, long long totalBytes, int leftPanelWidth, int effectiveWindowHeight = 0);
@@ -685,14 +692,20 @@ private:
   HFONT font;
   void* pixels;
   BITMAPINFO bitmapInfo;
+  HBITMAP pixelBitmap;
 #elif __APPLE__
   CGContextRef context;
   void* backBuffer;
+  CGImageRef pixelImage;
 #else
   Display* display;
   GC gc;
   Pixmap backBuffer;
   XFontStruct* fontInfo;
+  Pixmap pixelPixmap;
 #endif
+  int pixelImageWidth;
+  int pixelImageHeight;
+  uint32_t pixelImageVersion;
   void setColor(const Color& color);
 };
@@ -0,0 +1,60 @@
+#ifndef STRINGINDEX_H
+#define STRINGINDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define STRING_CHUNK_SIZE (4 * 1024 * 1024)
+#define STRING_MAX_THREADS 8
+#define STRING_MIN_LENGTH 4
+#define STRING_MAX_RESULTS (16 * 1024 * 1024)
+#define STRING_OFFSET_BITS 40
+#define STRING_LENGTH_BITS 22
+#define STRING_MAX_OFFSET (1ull << STRING_OFFSET_BITS)
+#define STRING_MAX_LENGTH ((1u << STRING_LENGTH_BITS) - 1)
+
+enum StringEncoding
+{
+  STRING_ASCII,
+  STRING_UTF16LE,
+  STRING_UTF16BE
+};
+
+class StringIndex
+{
+public:
+  StringIndex();
+  ~StringIndex();
+
+  bool build(const uint8_t* buffer, uint64_t length, uint32_t minimumLength);
+  void clear();
+  bool isBuiltOn(const uint8_t* buffer, uint64_t length) const { return built && data == buffer && size == length; }
+  bool isTruncated() const { return truncated; }
+  uint32_t getMinimumLength() const { return minLength; }
+
+  size_t getCount() const { return count; }
+  uint64_t getOffset(size_t index) const { return entries[index] & (STRING_MAX_OFFSET - 1); }
+  uint32_t getLength(size_t index) const { return (uint32_t)(entries[index] >> STRING_OFFSET_BITS) & STRING_MAX_LENGTH; }
+  StringEncoding getEncoding(size_t index) const { return (StringEncoding)(entries[index] >> (STRING_OFFSET_BITS + STRING_LENGTH_BITS)); }
+  uint64_t getByteLength(size_t index) const { return (uint64_t)getLength(index) * (getEncoding(index) == STRING_ASCII ? 1 : 2); }
+  size_t findOffset(uint64_t offset) const;
+  size_t format(size_t index, char* out, size_t maxChars) const;
+
+private:
+  StringIndex(const StringIndex&);
+  StringIndex& operator=(const StringIndex&);
+
+  uint64_t* entries;
+  size_t count;
+  const uint8_t* data;
+  uint64_t size;
+  uint32_t minLength;
+  bool built;
+  bool truncated;
+};
+
+const char* StringEncodingName(StringEncoding encoding);
+
+#endif
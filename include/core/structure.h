@@ -0,0 +1,156 @@
+#ifndef STRUCTURE_H
+#define STRUCTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+#include "processmemory.h"
+
+#define STRUCT_LABEL_LEN 64
+#define STRUCT_VALUE_LEN 48
+#define STRUCT_PAGE_SIZE 256
+#define STRUCT_MAX_LIST 65536
+
+enum StructureFormat
+{
+  STRUCT_FORMAT_NONE,
+  STRUCT_FORMAT_ELF,
+  STRUCT_FORMAT_PE,
+  STRUCT_FORMAT_MACHO
+};
+
+enum StructureNodeKind
+{
+  STRUCT_NODE_ROOT,
+  STRUCT_NODE_FIELD,
+  STRUCT_NODE_DOS_HEADER,
+  STRUCT_NODE_FILE_HEADER,
+  STRUCT_NODE_OPTIONAL_HEADER,
+  STRUCT_NODE_DIRECTORIES,
+  STRUCT_NODE_DIRECTORY,
+  STRUCT_NODE_SEGMENTS,
+  STRUCT_NODE_SEGMENT,
+  STRUCT_NODE_SECTIONS,
+  STRUCT_NODE_SECTION,
+  STRUCT_NODE_SYMBOLS,
+  STRUCT_NODE_SYMBOL,
+  STRUCT_NODE_IMPORTS,
+  STRUCT_NODE_IMPORT_MODULE,
+  STRUCT_NODE_IMPORT,
+  STRUCT_NODE_EXPORTS,
+  STRUCT_NODE_EXPORT,
+  STRUCT_NODE_LOAD_COMMANDS,
+  STRUCT_NODE_LOAD_COMMAND,
+  STRUCT_NODE_ARCHITECTURES,
+  STRUCT_NODE_ARCHITECTURE,
+  STRUCT_NODE_MORE
+};
+
+struct StructureNode
+{
+  char label[STRUCT_LABEL_LEN];
+  char value[STRUCT_VALUE_LEN];
+  uint64_t offset;
+  uint64_t size;
+  uint64_t tableOffset;
+  uint64_t stringOffset;
+  uint32_t entryCount;
+  uint32_t entrySize;
+  uint32_t firstEntry;
+  int parent;
+  int firstChild;
+  int lastChild;
+  int nextSibling;
+  int depth;
+  StructureNodeKind kind;
+  bool expandable;
+  bool expanded;
+  bool decoded;
+};
+
+struct StructureFieldDef
+{
+  const char* name;
+  uint16_t offset;
+  uint8_t size;
+  bool hex;
+};
+
+class StructureDecoder
+{
+public:
+  StructureDecoder();
+  ~StructureDecoder();
+
+  bool open(const uint8_t* data, uint64_t size);
+  void close();
+  bool isOpen() const { return format != STRUCT_FORMAT_NONE; }
+  bool isOpenOn(const uint8_t* buffer, uint64_t length) const { return isOpen() && data == buffer && size == length; }
+  StructureFormat getFormat() const { return format; }
+  const char* getFormatName() const;
+  bool is64Bit() const { return is64; }
+
+  size_t getNodeCount() const { return nodes.size(); }
+  const StructureNode* getNode(int index) const;
+  bool expand(int index);
+  void collapse(int index);
+  bool toggle(int index);
+  void getVisibleNodes(Vector<int>* outNodes) const;
+
+  const Vector<MemoryRegion>& getRegions() const { return regions; }
+  bool virtualAddressToOffset(uint64_t virtualAddress, uint64_t* outOffset) const;
+  bool offsetToVirtualAddress(uint64_t offset, uint64_t* outVirtualAddress) const;
+
+private:
+  StructureDecoder(const StructureDecoder&);
+  StructureDecoder& operator=(const StructureDecoder&);
+
+  bool inRange(uint64_t offset, uint64_t length) const { return offset <= size && length <= size - offset; }
+  uint64_t readField(uint64_t offset, size_t width) const;
+  uint16_t read16(uint64_t offset) const { return (uint16_t)readField(offset, 2); }
+  uint32_t read32(uint64_t offset) const { return (uint32_t)readField(offset, 4); }
+  uint64_t read64(uint64_t offset) const { return readField(offset, 8); }
+  uint64_t readWord(uint64_t offset) const { return readField(offset, is64 ? 8 : 4); }
+  void readString(uint64_t offset, char* out, size_t max) const;
+  bool rvaToOffset(uint64_t rva, uint64_t* outOffset) const;
+
+  int addNode(int parent, StructureNodeKind kind, const char* label, uint64_t offset, uint64_t size);
+  int addList(int parent, StructureNodeKind kind, const char* label, uint64_t table, uint32_t count, uint32_t entrySize);
+  void setValue(int index, const char* value);
+  void setHexValue(int index, const char* prefix, uint64_t value);
+  void addRegion(uint64_t virtualAddress, uint64_t offset, uint64_t length, uint32_t protection, const char* name);
+  void addFields(int parent, uint64_t base, const StructureFieldDef* fields, size_t count);
+
+  bool openELF();
+  bool openPE();
+  bool openMachO();
+  bool openMachSlice(uint64_t base);
+
+  void decodeChildren(int index);
+  void decodeList(int parent, uint32_t start);
+  void decodeEntry(int parent, uint32_t entry);
+  void decodeMore(int index);
+  void decodeELFImports(int parent);
+  void decodePEImports(int parent);
+  void decodeMachCommands(int parent);
+  void decodeMachSegment(int parent);
+  void decodeMachImports(int parent);
+
+  const uint8_t* data;
+  uint64_t size;
+  StructureFormat format;
+  bool is64;
+  bool bigEndian;
+  Vector<StructureNode> nodes;
+  Vector<MemoryRegion> regions;
+
+  uint64_t imageBase;
+  uint64_t sizeOfHeaders;
+  uint64_t sectionStrings;
+  uint64_t machBase;
+  uint64_t machCommands;
+  uint32_t machCommandCount;
+};
+
+#endif
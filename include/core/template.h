@@ -0,0 +1,249 @@
+#ifndef TEMPLATE_H
+#define TEMPLATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define TEMPLATE_NAME_LEN 32
+#define TEMPLATE_LABEL_LEN 64
+#define TEMPLATE_VALUE_LEN 48
+#define TEMPLATE_ERROR_LEN 128
+#define TEMPLATE_PAGE_SIZE 256
+#define TEMPLATE_CHECKPOINT 64
+#define TEMPLATE_MAX_DEPTH 32
+#define TEMPLATE_MAX_STACK 32
+#define TEMPLATE_MAX_NODES (1 << 20)
+#define TEMPLATE_SPAN_BUDGET 16384
+#define TEMPLATE_PALETTE_SIZE 8
+
+enum TemplatePrimitive
+{
+  TPL_U8,
+  TPL_U16,
+  TPL_U32,
+  TPL_U64,
+  TPL_I8,
+  TPL_I16,
+  TPL_I32,
+  TPL_I64,
+  TPL_F32,
+  TPL_F64,
+  TPL_CHAR,
+  TPL_STRUCT
+};
+
+enum TemplateOpCode
+{
+  TPL_OP_FIELD,
+  TPL_OP_IF,
+  TPL_OP_JUMP
+};
+
+enum TemplateInstrCode
+{
+  TPL_INSTR_CONST,
+  TPL_INSTR_FIELD,
+  TPL_INSTR_MEMBER,
+  TPL_INSTR_POSITION,
+  TPL_INSTR_UNARY,
+  TPL_INSTR_BINARY
+};
+
+enum TemplateOperator
+{
+  TPL_OPERATOR_NEGATE,
+  TPL_OPERATOR_NOT,
+  TPL_OPERATOR_COMPLEMENT,
+  TPL_OPERATOR_MUL,
+  TPL_OPERATOR_DIV,
+  TPL_OPERATOR_MOD,
+  TPL_OPERATOR_ADD,
+  TPL_OPERATOR_SUB,
+  TPL_OPERATOR_SHL,
+  TPL_OPERATOR_SHR,
+  TPL_OPERATOR_LT,
+  TPL_OPERATOR_LE,
+  TPL_OPERATOR_GT,
+  TPL_OPERATOR_GE,
+  TPL_OPERATOR_EQ,
+  TPL_OPERATOR_NE,
+  TPL_OPERATOR_AND,
+  TPL_OPERATOR_XOR,
+  TPL_OPERATOR_OR,
+  TPL_OPERATOR_LOGICAL_AND,
+  TPL_OPERATOR_LOGICAL_OR
+};
+
+struct TemplateInstr
+{
+  TemplateInstrCode code;
+  TemplateOperator op;
+  int64_t value;
+  char name[TEMPLATE_NAME_LEN];
+};
+
+struct TemplateExpr
+{
+  int first;
+  int count;
+};
+
+struct TemplateOp
+{
+  TemplateOpCode code;
+  char name[TEMPLATE_NAME_LEN];
+  TemplatePrimitive primitive;
+  int structIndex;
+  int enumIndex;
+  int countExpr;
+  int atExpr;
+  int condExpr;
+  int target;
+  bool isArray;
+  bool bigEndian;
+};
+
+struct TemplateEnumValue
+{
+  char name[TEMPLATE_NAME_LEN];
+  int64_t value;
+};
+
+struct TemplateEnum
+{
+  char name[TEMPLATE_NAME_LEN];
+  TemplatePrimitive primitive;
+  int firstValue;
+  int valueCount;
+};
+
+struct TemplateStruct
+{
+  char name[TEMPLATE_NAME_LEN];
+  int firstOp;
+  int opCount;
+  uint64_t size;
+  bool fixedSize;
+  bool contained;
+};
+
+struct TemplateProgram
+{
+  Vector<TemplateStruct> structs;
+  Vector<TemplateEnum> enums;
+  Vector<TemplateEnumValue> enumValues;
+  Vector<TemplateOp> ops;
+  Vector<TemplateInstr> code;
+  Vector<TemplateExpr> exprs;
+
+  void clear();
+};
+
+enum TemplateNodeKind
+{
+  TPL_NODE_STRUCT,
+  TPL_NODE_ARRAY,
+  TPL_NODE_VALUE,
+  TPL_NODE_MORE
+};
+
+struct TemplateNode
+{
+  char label[TEMPLATE_LABEL_LEN];
+  char value[TEMPLATE_VALUE_LEN];
+  uint64_t offset;
+  uint64_t size;
+  uint64_t count;
+  uint64_t firstElement;
+  uint64_t raw;
+  int op;
+  int structIndex;
+  int checkpoints;
+  int parent;
+  int firstChild;
+  int lastChild;
+  int nextSibling;
+  int depth;
+  TemplateNodeKind kind;
+  TemplatePrimitive primitive;
+  bool expandable;
+  bool expanded;
+  bool decoded;
+  bool sized;
+};
+
+struct TemplateSpan
+{
+  uint64_t offset;
+  uint64_t size;
+  int color;
+};
+
+typedef size_t (*TemplateReadFn)(void* context, uint64_t offset, uint8_t* out, size_t length);
+
+bool TemplateCompile(const char* text, size_t length, TemplateProgram* outProgram, char* outError, size_t errorMax);
+
+class TemplateEngine
+{
+public:
+  TemplateEngine();
+  ~TemplateEngine();
+
+  bool load(const char* templateName, const char* text, size_t length, char* outError, size_t errorMax);
+  void unload();
+  bool isLoaded() const { return loaded; }
+  const char* getName() const { return name; }
+
+  void bind(TemplateReadFn readFn, void* context, uint64_t length);
+  void refreshValues();
+
+  size_t getNodeCount() const { return nodes.size(); }
+  const TemplateNode* getNode(int index) const;
+  bool expand(int index);
+  void collapse(int index);
+  bool toggle(int index);
+  void getVisibleNodes(Vector<int>* outNodes) const;
+  void getSpans(uint64_t start, uint64_t end, Vector<TemplateSpan>* outSpans);
+
+private:
+  TemplateEngine(const TemplateEngine&);
+  TemplateEngine& operator=(const TemplateEngine&);
+
+  uint64_t readValue(uint64_t offset, TemplatePrimitive primitive, bool bigEndian) const;
+  int64_t nodeNumber(int index) const;
+  void formatValue(int index);
+
+  int addNode(int parent, TemplateNodeKind kind, const char* label, int op, uint64_t offset, bool linked);
+  int addField(int frame, int op, uint64_t offset);
+  int addElement(int parent, uint64_t element, uint64_t offset, bool linked);
+  void discardFrom(size_t nodeMark, size_t checkpointMark);
+
+  bool evaluate(int expr, int frame, uint64_t cursor, int64_t* outValue);
+  int enclosingFrame(int index) const;
+  int findField(int frame, const char* fieldName);
+  int findMember(int index, const char* fieldName);
+
+  void decodeStruct(int index);
+  void decodeArray(int index, uint64_t start);
+  void decodeMore(int index);
+  uint64_t elementOffset(int index, uint64_t element, uint64_t* outReached);
+  uint64_t measureElement(int index, uint64_t element, uint64_t offset);
+  void collectElement(int index, uint64_t element, uint64_t offset, uint64_t start, uint64_t end, Vector<TemplateSpan>* outSpans, int level);
+  void collectSpans(int index, uint64_t start, uint64_t end, Vector<TemplateSpan>* outSpans, int level);
+
+  TemplateProgram program;
+  Vector<TemplateNode> nodes;
+  Vector<Vector<uint64_t> > checkpoints;
+  TemplateReadFn read;
+  void* readContext;
+  uint64_t dataSize;
+  char name[TEMPLATE_LABEL_LEN];
+  bool loaded;
+  int depth;
+  int lowestDecoded;
+  int budget;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define TRANSFORM_MAX_KEY 64
+#define TRANSFORM_MAX_STEPS 16
+#define TRANSFORM_PATH_LEN 512
+#define TRANSFORM_ERROR_LEN 128
+#define TRANSFORM_BLOCK_SIZE (1024 * 1024)
+#define TRANSFORM_PAGE_SIZE 4096
+#define TRANSFORM_PAGE_CACHE 8
+#define TRANSFORM_MAX_PROCESS_BYTES (16 * 1024 * 1024)
+
+enum TransformKind
+{
+  TRANSFORM_XOR,
+  TRANSFORM_ADD,
+  TRANSFORM_SUB,
+  TRANSFORM_ROTATE_LEFT,
+  TRANSFORM_ROTATE_RIGHT,
+  TRANSFORM_SWAP16,
+  TRANSFORM_SWAP32,
+  TRANSFORM_SWAP64,
+  TRANSFORM_BASE64_DECODE,
+  TRANSFORM_BASE64_ENCODE,
+  TRANSFORM_HEX_DECODE,
+  TRANSFORM_HEX_ENCODE,
+  TRANSFORM_PLUGIN
+};
+
+struct TransformStep
+{
+  TransformKind kind;
+  uint8_t key[TRANSFORM_MAX_KEY];
+  uint32_t keyLength;
+  uint32_t bits;
+  char pluginPath[TRANSFORM_PATH_LEN];
+};
+
+typedef size_t (*TransformReadFn)(void* context, uint64_t offset, uint8_t* out, size_t length);
+
+const char* TransformKindName(TransformKind kind);
+bool TransformParseStep(TransformKind kind, const char* argument, TransformStep* outStep, char* outError, size_t errorMax);
+void TransformApplyBytes(const TransformStep& step, uint8_t* data, size_t length, uint64_t position);
+
+class TransformPipeline
+{
+public:
+  TransformPipeline(TransformReadFn readFn, void* context, uint64_t rangeStart, uint64_t rangeLength);
+  ~TransformPipeline();
+
+  bool addStep(const TransformStep& step, char* outError, size_t errorMax);
+  void invalidate();
+
+  size_t getStepCount() const { return steps.size(); }
+  const TransformStep& getStep(size_t index) const { return steps[index]; }
+  uint64_t getStart() const { return start; }
+  uint64_t getInputLength() const { return inputLength; }
+  uint64_t getOutputLength() const { return lengths.empty() ? inputLength : lengths[lengths.size() - 1]; }
+  bool isInPlace() const;
+  void describe(char* out, size_t max) const;
+
+  bool read(uint64_t position, uint8_t* out, size_t length, char* outError, size_t errorMax);
+  void overlay(uint64_t offset, uint8_t* data, size_t length);
+
+private:
+  TransformPipeline(const TransformPipeline&);
+  TransformPipeline& operator=(const TransformPipeline&);
+
+  struct Page
+  {
+    uint64_t index;
+    uint64_t lastUsed;
+    uint8_t* data;
+    size_t length;
+    bool valid;
+  };
+
+  bool readStep(int step, uint64_t position, uint8_t* out, size_t length, char* outError, size_t errorMax);
+  const Page* fetchPage(uint64_t index);
+
+  Vector<TransformStep> steps;
+  Vector<uint64_t> lengths;
+  TransformReadFn source;
+  void* sourceContext;
+  uint64_t start;
+  uint64_t inputLength;
+  Page pages[TRANSFORM_PAGE_CACHE];
+  uint64_t useCounter;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef VALUESCANNER_H
+#define VALUESCANNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+#include "processmemory.h"
+
+#define SCAN_BLOCK_SIZE (256 * 1024)
+#define SCAN_MAX_THREADS 8
+#define SCAN_MAX_STRING 64
+
+enum ScanValueType
+{
+  SCAN_TYPE_U8,
+  SCAN_TYPE_U16,
+  SCAN_TYPE_U32,
+  SCAN_TYPE_U64,
+  SCAN_TYPE_I8,
+  SCAN_TYPE_I16,
+  SCAN_TYPE_I32,
+  SCAN_TYPE_I64,
+  SCAN_TYPE_FLOAT,
+  SCAN_TYPE_DOUBLE,
+  SCAN_TYPE_STRING
+};
+
+enum ScanCompare
+{
+  SCAN_EXACT,
+  SCAN_UNKNOWN,
+  SCAN_CHANGED,
+  SCAN_UNCHANGED,
+  SCAN_INCREASED,
+  SCAN_DECREASED
+};
+
+enum ScanBlockEncoding
+{
+  SCAN_BLOCK_ALL,
+  SCAN_BLOCK_BITMAP,
+  SCAN_BLOCK_DELTA
+};
+
+struct ScanValue
+{
+  ScanValueType type;
+  uint8_t bytes[SCAN_MAX_STRING];
+  size_t size;
+  double real;
+  double tolerance;
+};
+
+struct ScanTarget
+{
+  const uint8_t* data;
+  uint64_t size;
+  ProcessMemorySource* process;
+  bool writableOnly;
+};
+
+struct ScanBlock
+{
+  uint64_t base;
+  uint32_t length;
+  uint32_t tail;
+  uint32_t count;
+  uint32_t encoding;
+  uint8_t* encoded;
+  size_t encodedSize;
+  uint8_t* values;
+  size_t valuesSize;
+};
+
+size_t ScanTypeSize(ScanValueType type);
+bool ParseScanValue(ScanValueType type, const char* text, ScanValue* outValue);
+bool ParseScanQuery(const char* text, ScanValue* outValue, bool* outUnknown);
+
+class ValueScanner
+{
+public:
+  ValueScanner();
+  ~ValueScanner();
+
+  bool firstScan(const ScanTarget& target, const ScanValue& value, ScanCompare compare,
+                 size_t alignment = 0);
+  bool nextScan(const ScanTarget& target, ScanCompare compare, const ScanValue* value = nullptr);
+  void reset();
+
+  bool hasResults() const { return scanCount > 0; }
+  int getScanCount() const { return scanCount; }
+  uint64_t getCandidateCount() const { return candidateCount; }
+  ScanValueType getType() const { return value.type; }
+  size_t getValueSize() const { return valueSize; }
+  size_t getAlignment() const { return alignment; }
+  size_t getMemoryUsage() const;
+
+  bool findNextCandidate(uint64_t from, uint64_t* outOffset) const;
+  size_t getCandidateFlags(uint64_t offset, size_t length, uint8_t* outFlags) const;
+
+private:
+  ValueScanner(const ValueScanner&);
+  ValueScanner& operator=(const ValueScanner&);
+
+  bool run(const ScanTarget& target, ScanBlock* input, size_t count, ScanCompare compare,
+           const ScanValue* compareValue, bool first);
+  size_t findBlock(uint64_t offset) const;
+  static void freeBlock(ScanBlock& block);
+
+  Vector<ScanBlock> blocks;
+  ScanValue value;
+  size_t valueSize;
+  size_t alignment;
+  uint64_t candidateCount;
+  int scanCount;
+  bool uniformValues;
+  uint8_t uniformValue[SCAN_MAX_STRING];
+};
+
+#endif
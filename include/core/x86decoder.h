@@ -0,0 +1,67 @@
+#ifndef X86DECODER_H
+#define X86DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "global.h"
+
+#define X86_MAX_INSTRUCTION 15
+#define X86_SYNC_WINDOW 64
+#define X86_SWEEP_CHUNK (1024 * 1024)
+#define X86_MAX_THREADS 8
+#define X86_TEXT_LEN 64
+
+enum X86Mode
+{
+  X86_MODE_16 = 16,
+  X86_MODE_32 = 32,
+  X86_MODE_64 = 64
+};
+
+enum X86Encoding
+{
+  X86_ENCODING_LEGACY,
+  X86_ENCODING_VEX,
+  X86_ENCODING_EVEX,
+  X86_ENCODING_XOP
+};
+
+enum X86Map
+{
+  X86_MAP_PRIMARY,
+  X86_MAP_0F,
+  X86_MAP_0F38,
+  X86_MAP_0F3A,
+  X86_MAP_3DNOW,
+  X86_MAP_OTHER
+};
+
+struct X86Instruction
+{
+  uint64_t address;
+  uint64_t target;
+  uint64_t immediate;
+  uint8_t length;
+  uint8_t opcode;
+  uint8_t modrm;
+  uint8_t rex;
+  uint8_t mandatoryPrefix;
+  uint8_t operandBits;
+  X86Encoding encoding;
+  X86Map map;
+  bool hasModrm;
+  bool hasTarget;
+  bool hasImmediate;
+  bool lock;
+  bool rep;
+  bool repne;
+  bool valid;
+};
+
+bool X86Decode(const uint8_t* code, size_t available, uint64_t address, X86Mode mode, X86Instruction* outInstruction);
+size_t X86InstructionLength(const uint8_t* code, size_t available, X86Mode mode);
+size_t X86Format(const X86Instruction& instruction, X86Mode mode, char* out, size_t max);
+uint64_t X86SweepBoundaries(const uint8_t* code, size_t length, X86Mode mode, uint8_t* outStartBits);
+
+#endif
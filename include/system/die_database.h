@@ -10,6 +10,10 @@
 #include <curl/curl.h>
 #endif
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 #include "global.h"
 
 
@@ -19,36 +23,99 @@
 #define DIE_DB_ELF_URL DIE_DB_BASE_URL "ELF/elf.db"
 #define DIE_DB_MACH_URL DIE_DB_BASE_URL "MACH/mach.db"
 
+#define DIE_MAX_PATTERN 256
+#define DIE_INITIAL_CAPACITY 256
+#define DIE_CACHE_FILE "signatures.cache"
+#define DIE_CACHE_VERSION 1
+
+enum DIEDatabaseKind
+{
+  DIE_DB_BINARY,
+  DIE_DB_PE,
+  DIE_DB_ELF,
+  DIE_DB_MACH,
+  DIE_DB_COUNT
+};
+
+enum DIERebuildState
+{
+  DIE_REBUILD_IDLE,
+  DIE_REBUILD_RUNNING,
+  DIE_REBUILD_DONE
+};
+
 struct DIESignature
 {
   char name[256];
   char type[64];
-  uint8_t pattern[256];
+  uint8_t pattern[DIE_MAX_PATTERN];
+  uint8_t mask[DIE_MAX_PATTERN];
   int patternLength;
   int offset;
 };
 
+struct DIEAnchorGroup
+{
+  int offset;
+  int first[257];
+};
+
 struct DIEDatabase
 {
-  DIESignature* signatures;
+  const DIESignature* signatures;
   int signatureCount;
-  int signatureCapacity;
+  const DIEAnchorGroup* groups;
+  int groupCount;
+  const int* anchored;
+  const int* unanchored;
+  int unanchoredCount;
   bool loaded;
 };
 
+struct DIEMatch
+{
+  const DIESignature* type;
+  const DIESignature* compiler;
+};
+
 class DIEDatabaseManager
 {
 private:
-  DIEDatabase binaryDb;
-  DIEDatabase peDb;
-  DIEDatabase elfDb;
-  DIEDatabase machDb;
+  DIEDatabase databases[DIE_DB_COUNT];
 
   char dbDirectory[512];
 
+  const uint8_t* cacheBase;
+  size_t cacheSize;
+  bool cacheMapped;
+  void* cacheMapping;
+
+  uint8_t* rebuiltCache;
+  size_t rebuiltCacheSize;
+  volatile long rebuildState;
+#ifdef _WIN32
+  HANDLE rebuildThread;
+#else
+  pthread_t rebuildThread;
+  bool rebuildThreadStarted;
+#endif
+
   bool DownloadFile(const char* url, const char* destPath);
-  bool ParseDatabase(const char* dbPath, DIEDatabase& db);
-  bool MatchSignature(const uint8_t* data, size_t dataSize, const DIESignature& sig);
+  void GetDatabasePath(int kind, char* outPath) const;
+  void GetCachePath(char* outPath) const;
+  bool MapCache(const char* path);
+  bool BindCache(const uint8_t* base, size_t size, bool* outStale);
+  void ReleaseCache();
+  bool StartRebuild();
+  void FinishRebuild(bool wait);
+  void RunRebuild();
+#ifdef _WIN32
+  static DWORD WINAPI RebuildThreadMain(LPVOID param);
+#else
+  static void* RebuildThreadMain(void* param);
+#endif
+  void MatchDatabase(const uint8_t* data, size_t dataSize, const DIEDatabase& db, DIEMatch& match) const;
+  bool MatchSignature(const uint8_t* data, size_t dataSize, const DIESignature& sig) const;
 
 public:
   DIEDatabaseManager();
@@ -57,6 +124,8 @@ public:
   bool Initialize(const char* dieExecutablePath = nullptr);
   bool DownloadDatabases(void (*progressCallback)(const char*, int) = nullptr);
   bool LoadDatabases();
+  bool IsRebuilding() const { return rebuildState == DIE_REBUILD_RUNNING; }
+  int GetSignatureCount() const;
 
   bool AnalyzeFile(const uint8_t* data, size_t dataSize,
   char* outType, char* outCompiler, char* outArch);
@@ -44,7 +44,43 @@ enum ContextMenuAction
   ID_FILL_FF = 111,
   ID_FILL_PATTERN = 112,
   ID_ADD_BOOKMARK = 114,
-  ID_SELECT_BLOCK = 115
+  ID_SELECT_BLOCK = 115,
+  ID_WATCH_MEMORY = 116,
+  ID_WATCH_TOGGLE = 117,
+  ID_WATCH_PREVIOUS = 118,
+  ID_WATCH_NEXT = 119,
+  ID_WATCH_LIVE = 120,
+  ID_VALUE_SCAN = 121,
+  ID_SCAN_FIRST = 122,
+  ID_SCAN_CHANGED = 123,
+  ID_SCAN_UNCHANGED = 124,
+  ID_SCAN_INCREASED = 125,
+  ID_SCAN_DECREASED = 126,
+  ID_SCAN_EQUAL = 127,
+  ID_SCAN_NEXT_RESULT = 128,
+  ID_SCAN_RESET = 129,
+  ID_COMMIT_PROCESS_EDITS = 130,
+  ID_CARVE_FILES = 131,
+  ID_APPLY_TEMPLATE = 132,
+  ID_CLEAR_TEMPLATE = 133,
+  ID_EXTRACT_STRINGS = 134,
+  ID_STRINGS_NEAR_CURSOR = 135,
+  ID_TRANSFORM = 136,
+  ID_TRANSFORM_XOR = 137,
+  ID_TRANSFORM_ADD = 138,
+  ID_TRANSFORM_SUB = 139,
+  ID_TRANSFORM_ROTATE_LEFT = 140,
+  ID_TRANSFORM_ROTATE_RIGHT = 141,
+  ID_TRANSFORM_SWAP16 = 142,
+  ID_TRANSFORM_SWAP32 = 143,
+  ID_TRANSFORM_SWAP64 = 144,
+  ID_TRANSFORM_BASE64_DECODE = 145,
+  ID_TRANSFORM_BASE64_ENCODE = 146,
+  ID_TRANSFORM_HEX_DECODE = 147,
+  ID_TRANSFORM_HEX_ENCODE = 148,
+  ID_COMMIT_TRANSFORM = 149,
+  ID_DISCARD_TRANSFORM = 150,
+  ID_TRANSFORM_PLUGIN = 151
 };
 
 long long ParseNumber(const char* text, int numberFormat);
@@ -17,6 +17,7 @@ struct PluginManagerData {
     int hoveredPlugin;
     int selectedPlugin;
     int scrollOffset;
+    char statusText[256];
     
     int mouseX;
     int mouseY;
@@ -66,10 +66,10 @@ struct GoToDialogData {
   RenderManager* renderer = nullptr;
   PlatformWindow platformWindow = {};
 #ifdef _WIN32
-  void (*callback)(int) = nullptr;
+  void (*callback)(long long) = nullptr;
   void* callbackUserData = nullptr;
 #else
-  std::function<void(int)> callback;
+  std::function<void(long long)> callback;
 #endif
 };
 
@@ -115,14 +115,14 @@ namespace SearchDialogs {
   void ShowGoToDialog(
     void* parentHandle,
     bool darkMode,
-    void (*callback)(int),
+    void (*callback)(long long),
     void* userData = nullptr
   );
 #else
   void ShowfindReplaceDialog(void* parentHandle, bool darkMode,
     std::function<void(const std::string&, const std::string&)> callback);
   void ShowGoToDialog(void* parentHandle, bool darkMode,
-    std::function<void(int)> callback);
+    std::function<void(long long)> callback);
 #endif
 
 #ifdef _WIN32
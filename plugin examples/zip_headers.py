@@ -0,0 +1,49 @@
+def get_info():
+    return {
+        "name": "ZIP Local Header Bookmarks",
+        "version": "1.0",
+        "author": "HexViewer",
+        "description": "Bookmarks ZIP local file headers using the chunked bookmark protocol"
+    }
+
+SIGNATURE = b"PK\x03\x04"
+
+def generate_bookmarks_chunk(chunk: bytes, base_offset: int, total_size: int, state, memory_map=None):
+    """
+    Called once per chunk of the file, in order.
+
+    Args:
+        chunk: Bytes of the current chunk
+        base_offset: Offset of chunk[0] in the file
+        total_size: Size of the whole file
+        state: Value returned by the previous call (None on the first chunk)
+        memory_map: List of memory regions (only for process memory)
+
+    Returns:
+        (bookmarks, new_state) where bookmarks is any iterable of bookmark
+        dicts with absolute offsets. Yielding from a generator lets the
+        host show results while the chunk is still being scanned.
+    """
+    carry = state["tail"] if state else b""
+    found = state["found"] if state else 0
+
+    data = carry + chunk
+    start = base_offset - len(carry)
+
+    bookmarks = []
+    pos = data.find(SIGNATURE)
+    while pos != -1:
+        found += 1
+        bookmarks.append({
+            "offset": start + pos,
+            "label": "ZIP entry %d" % found,
+            "description": "Local file header",
+            "color": {"r": 255, "g": 200, "b": 80}
+        })
+        pos = data.find(SIGNATURE, pos + 1)
+
+    tail = data[-(len(SIGNATURE) - 1):]
+    if tail.find(SIGNATURE[:1]) == -1:
+        tail = b""
+
+    return bookmarks, {"tail": tail, "found": found}
@@ -0,0 +1,337 @@
+#include "blockstats.h"
+
+static uint32_t g_BlockStatsVersion = 0;
+
+static long BlockStatsLoad(volatile long* value)
+{
+#ifdef _WIN32
+  return InterlockedCompareExchange(value, 0, 0);
+#else
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void BlockStatsStore(volatile long* value, long newValue)
+{
+#ifdef _WIN32
+  InterlockedExchange(value, newValue);
+#else
+  __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+#endif
+}
+
+// log2 for x > 0 from the exponent bits and an atanh series on the mantissa;
+// accurate to about 1e-7, which is plenty for an 8-bit entropy readout.
+static double BlockStatsLog2(double x)
+{
+  union
+  {
+    double d;
+    uint64_t i;
+  } u = { x };
+
+  int exponent = (int)((u.i >> 52) & 0x7FF) - 1023;
+  u.i &= ~((uint64_t)0x7FF << 52);
+  u.i |= (uint64_t)1023 << 52;
+
+  double z = (u.d - 1.0) / (u.d + 1.0);
+  double z2 = z * z;
+  double series = z * (1.0 + z2 * (1.0 / 3.0 + z2 * (1.0 / 5.0 + z2 * (1.0 / 7.0 + z2 * (1.0 / 9.0 + z2 * (1.0 / 11.0))))));
+  return (double)exponent + 2.0 * series * 1.4426950408889634;
+}
+
+void ByteRangeStats_Clear(ByteRangeStats* stats)
+{
+  memSet(stats, 0, sizeof(ByteRangeStats));
+}
+
+void ByteRangeStats_Count(ByteRangeStats* stats, const uint8_t* data, size_t length)
+{
+  // Four interleaved tables keep runs of the same byte from serialising on
+  // one counter.
+  uint32_t counts[4][256];
+  memSet(counts, 0, sizeof(counts));
+
+  size_t i = 0;
+  for (; i + 4 <= length; i += 4)
+  {
+    counts[0][data[i]]++;
+    counts[1][data[i + 1]]++;
+    counts[2][data[i + 2]]++;
+    counts[3][data[i + 3]]++;
+  }
+  for (; i < length; i++)
+    counts[0][data[i]]++;
+
+  for (int b = 0; b < 256; b++)
+    stats->histogram[b] += (uint64_t)counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b];
+  stats->total += length;
+}
+
+double ByteRangeStats_Entropy(const ByteRangeStats& stats)
+{
+  if (stats.total == 0)
+    return 0.0;
+
+  double entropy = 0.0;
+  double total = (double)stats.total;
+  for (int b = 0; b < 256; b++)
+  {
+    if (stats.histogram[b] == 0)
+      continue;
+    double p = (double)stats.histogram[b] / total;
+    entropy -= p * BlockStatsLog2(p);
+  }
+  return entropy < 0.0 ? 0.0 : entropy;
+}
+
+BlockStatsIndex::BlockStatsIndex()
+  : tree(nullptr), blockCount(0), data(nullptr), size(0), indexed(0), version(0),
+    running(false), ready(false), stale(false), finished(0), cancelRequested(0)
+{
+#ifdef _WIN32
+  thread = nullptr;
+#endif
+}
+
+BlockStatsIndex::~BlockStatsIndex()
+{
+  stop();
+}
+
+bool BlockStatsIndex::start(const uint8_t* buffer, uint64_t length)
+{
+  stop();
+  if (!buffer)
+    return false;
+
+  indexed = length > BLOCKSTATS_MAX_LENGTH ? BLOCKSTATS_MAX_LENGTH : length;
+  blockCount = (size_t)((indexed + BLOCKSTATS_BLOCK_SIZE - 1) / BLOCKSTATS_BLOCK_SIZE);
+  tree = (uint32_t*)platformAlloc((blockCount > 0 ? blockCount : 1) * 256 * sizeof(uint32_t));
+  if (!tree)
+  {
+    blockCount = 0;
+    indexed = 0;
+    return false;
+  }
+
+  data = buffer;
+  size = length;
+  if (!launch())
+  {
+    stop();
+    return false;
+  }
+  return true;
+}
+
+bool BlockStatsIndex::launch()
+{
+  stale = false;
+  ready = false;
+  BlockStatsStore(&finished, 0);
+  BlockStatsStore(&cancelRequested, 0);
+
+#ifdef _WIN32
+  thread = CreateThread(nullptr, 0, threadMain, this, 0, nullptr);
+  running = thread != nullptr;
+#else
+  running = pthread_create(&thread, nullptr, threadMain, this) == 0;
+#endif
+  return running;
+}
+
+void BlockStatsIndex::stop()
+{
+  if (running)
+  {
+    BlockStatsStore(&cancelRequested, 1);
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    thread = nullptr;
+#else
+    pthread_join(thread, nullptr);
+#endif
+    running = false;
+  }
+
+  if (tree)
+    platformFree(tree, (blockCount > 0 ? blockCount : 1) * 256 * sizeof(uint32_t));
+  tree = nullptr;
+  blockCount = 0;
+  data = nullptr;
+  size = 0;
+  indexed = 0;
+  ready = false;
+  stale = false;
+}
+
+// Publishes a finished build. An edit that landed while the worker was
+// reading may or may not be in its counts, so such a build is redone.
+bool BlockStatsIndex::poll()
+{
+  if (running && BlockStatsLoad(&finished))
+  {
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    thread = nullptr;
+#else
+    pthread_join(thread, nullptr);
+#endif
+    running = false;
+
+    if (stale)
+    {
+      launch();
+    }
+    else
+    {
+      ready = true;
+      version = ++g_BlockStatsVersion;
+    }
+  }
+  return ready;
+}
+
+#ifdef _WIN32
+DWORD WINAPI BlockStatsIndex::threadMain(LPVOID param)
+{
+  ((BlockStatsIndex*)param)->run();
+  return 0;
+}
+#else
+void* BlockStatsIndex::threadMain(void* param)
+{
+  ((BlockStatsIndex*)param)->run();
+  return nullptr;
+}
+#endif
+
+// Node i of the Fenwick tree (1-based) holds the histogram of blocks
+// (i - lowbit(i), i], so a prefix over any block count touches at most
+// log2(blockCount) nodes and an edit updates the same number.
+void BlockStatsIndex::run()
+{
+  memSet(tree, 0, (blockCount > 0 ? blockCount : 1) * 256 * sizeof(uint32_t));
+
+  bool cancelled = false;
+  for (size_t block = 0; block < blockCount; block++)
+  {
+    if (BlockStatsLoad(&cancelRequested))
+    {
+      cancelled = true;
+      break;
+    }
+
+    uint64_t offset = (uint64_t)block * BLOCKSTATS_BLOCK_SIZE;
+    size_t count = indexed - offset < BLOCKSTATS_BLOCK_SIZE ? (size_t)(indexed - offset) : BLOCKSTATS_BLOCK_SIZE;
+    const uint8_t* bytes = data + offset;
+    uint32_t counts[4][256];
+    memSet(counts, 0, sizeof(counts));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      counts[0][bytes[i]]++;
+      counts[1][bytes[i + 1]]++;
+      counts[2][bytes[i + 2]]++;
+      counts[3][bytes[i + 3]]++;
+    }
+    for (; i < count; i++)
+      counts[0][bytes[i]]++;
+
+    uint32_t* node = tree + block * 256;
+    for (int b = 0; b < 256; b++)
+      node[b] = counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b];
+  }
+
+  if (!cancelled)
+  {
+    for (size_t i = 1; i <= blockCount; i++)
+    {
+      size_t parent = i + (i & (0 - i));
+      if (parent > blockCount)
+        continue;
+      uint32_t* from = tree + (i - 1) * 256;
+      uint32_t* to = tree + (parent - 1) * 256;
+      for (int b = 0; b < 256; b++)
+        to[b] += from[b];
+    }
+  }
+
+  BlockStatsStore(&finished, 1);
+}
+
+// Called before the byte at offset is overwritten.
+void BlockStatsIndex::noteEdit(uint64_t offset, uint8_t newValue)
+{
+  if (!data || offset >= size)
+    return;
+  uint8_t oldValue = data[offset];
+  if (oldValue == newValue)
+    return;
+
+  version = ++g_BlockStatsVersion;
+  if (running)
+  {
+    stale = true;
+    return;
+  }
+  if (!ready || offset >= indexed)
+    return;
+
+  for (size_t i = (size_t)(offset / BLOCKSTATS_BLOCK_SIZE) + 1; i <= blockCount; i += i & (0 - i))
+  {
+    uint32_t* node = tree + (i - 1) * 256;
+    node[oldValue]--;
+    node[newValue]++;
+  }
+}
+
+void BlockStatsIndex::addPrefix(size_t blocks, uint64_t* histogram, bool subtract) const
+{
+  for (size_t i = blocks; i > 0; i -= i & (0 - i))
+  {
+    const uint32_t* node = tree + (i - 1) * 256;
+    if (subtract)
+    {
+      for (int b = 0; b < 256; b++)
+        histogram[b] -= node[b];
+    }
+    else
+    {
+      for (int b = 0; b < 256; b++)
+        histogram[b] += node[b];
+    }
+  }
+}
+
+bool BlockStatsIndex::query(uint64_t offset, uint64_t length, ByteRangeStats* outStats) const
+{
+  if (!ready || offset > size || length > size - offset)
+    return false;
+
+  ByteRangeStats_Clear(outStats);
+  uint64_t end = offset + length;
+  uint64_t firstBlock = (offset + BLOCKSTATS_BLOCK_SIZE - 1) / BLOCKSTATS_BLOCK_SIZE;
+  uint64_t lastBlock = (end < indexed ? end : indexed) / BLOCKSTATS_BLOCK_SIZE;
+
+  if (lastBlock <= firstBlock)
+  {
+    ByteRangeStats_Count(outStats, data + offset, (size_t)length);
+    return true;
+  }
+
+  // Whole blocks come from two prefix sums; the counts are exact, so the
+  // unsigned subtraction never leaves a wrapped value behind.
+  addPrefix((size_t)lastBlock, outStats->histogram, false);
+  addPrefix((size_t)firstBlock, outStats->histogram, true);
+  outStats->total = (lastBlock - firstBlock) * BLOCKSTATS_BLOCK_SIZE;
+
+  uint64_t headEnd = firstBlock * BLOCKSTATS_BLOCK_SIZE;
+  uint64_t tailStart = lastBlock * BLOCKSTATS_BLOCK_SIZE;
+  ByteRangeStats_Count(outStats, data + offset, (size_t)(headEnd - offset));
+  ByteRangeStats_Count(outStats, data + tailStart, (size_t)(end - tailStart));
+  return true;
+}
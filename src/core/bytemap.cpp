@@ -0,0 +1,490 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#include "bytemap.h"
+
+#define BYTEMAP_CLASS_ZERO 0
+#define BYTEMAP_CLASS_FF 1
+#define BYTEMAP_CLASS_PRINTABLE 2
+#define BYTEMAP_CLASS_CONTROL 3
+#define BYTEMAP_CLASS_HIGH 4
+#define BYTEMAP_CLASS_COUNT 5
+#define BYTEMAP_NO_PREVIOUS 256
+#define BYTEMAP_PAIR_SLOTS ((BYTEMAP_NO_PREVIOUS + 1) * 256)
+#define BYTEMAP_EMPTY_PIXEL 0x202024u
+
+struct ByteMapJob
+{
+  const uint8_t* data;
+  uint64_t length;
+  uint64_t bytesPerPixel;
+  uint32_t* cells;
+  size_t pixelCount;
+  size_t pixelsPerChunk;
+  size_t chunkCount;
+  volatile long nextChunk;
+};
+
+struct ByteMapWorker
+{
+  ByteMapJob* job;
+  uint32_t* pairs;
+#ifdef _WIN32
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+  bool started;
+};
+
+static const uint8_t g_ByteMapClassColor[BYTEMAP_CLASS_COUNT][3] = {
+  { 0, 0, 0 },
+  { 255, 255, 255 },
+  { 55, 126, 184 },
+  { 77, 175, 74 },
+  { 228, 26, 28 } };
+
+static const uint8_t g_ByteMapRamp[4][3] = {
+  { 20, 20, 90 },
+  { 30, 140, 230 },
+  { 250, 220, 40 },
+  { 255, 255, 255 } };
+
+static uint8_t g_ByteMapClass[256];
+static bool g_ByteMapClassBuilt = false;
+static uint32_t g_ByteMapVersion = 0;
+
+static void ByteMapBuildClassTable()
+{
+  if (g_ByteMapClassBuilt)
+    return;
+  for (int c = 0; c < 256; c++)
+  {
+    if (c == 0)
+      g_ByteMapClass[c] = BYTEMAP_CLASS_ZERO;
+    else if (c == 0xFF)
+      g_ByteMapClass[c] = BYTEMAP_CLASS_FF;
+    else if (c >= 0x20 && c < 0x7F)
+      g_ByteMapClass[c] = BYTEMAP_CLASS_PRINTABLE;
+    else if (c < 0x80)
+      g_ByteMapClass[c] = BYTEMAP_CLASS_CONTROL;
+    else
+      g_ByteMapClass[c] = BYTEMAP_CLASS_HIGH;
+  }
+  g_ByteMapClassBuilt = true;
+}
+
+static uint32_t ByteMapCellColor(const uint32_t* counts, uint64_t total)
+{
+  if (total == 0)
+    return BYTEMAP_EMPTY_PIXEL;
+  uint64_t rgb[3] = { 0, 0, 0 };
+  for (int k = 0; k < BYTEMAP_CLASS_COUNT; k++)
+  {
+    for (int c = 0; c < 3; c++)
+      rgb[c] += (uint64_t)counts[k] * g_ByteMapClassColor[k][c];
+  }
+  return (uint32_t)((rgb[0] / total) << 16 | (rgb[1] / total) << 8 | (rgb[2] / total));
+}
+
+static uint32_t ByteMapCell(const uint8_t* bytes, uint64_t count)
+{
+  uint32_t counts[BYTEMAP_CLASS_COUNT] = { 0, 0, 0, 0, 0 };
+  for (uint64_t i = 0; i < count; i++)
+    counts[g_ByteMapClass[bytes[i]]]++;
+  return ByteMapCellColor(counts, count);
+}
+
+// log2(value) in 8.8 fixed point, so the heatmap can be log-scaled without libm.
+static uint32_t ByteMapLog2(uint32_t value)
+{
+  int msb = 0;
+  while ((value >> msb) > 1)
+    msb++;
+  uint32_t fraction = msb >= 8 ? (value >> (msb - 8)) & 0xFF : (value << (8 - msb)) & 0xFF;
+  return (uint32_t)msb * 256 + fraction;
+}
+
+static uint32_t ByteMapRampColor(uint32_t level)
+{
+  uint32_t segment = level >= 255 ? 2 : level / 85;
+  uint32_t t = level - segment * 85;
+  const uint8_t* a = g_ByteMapRamp[segment];
+  const uint8_t* b = g_ByteMapRamp[segment + 1];
+  uint32_t rgb = 0;
+  for (int c = 0; c < 3; c++)
+    rgb = (rgb << 8) | (uint32_t)((a[c] * (85 - t) + b[c] * t) / 85);
+  return rgb;
+}
+
+static void HilbertPoint(int n, uint32_t d, int* outX, int* outY)
+{
+  int x = 0;
+  int y = 0;
+  for (int s = 1; s < n; s *= 2)
+  {
+    int rx = 1 & (int)(d / 2);
+    int ry = 1 & (int)(d ^ (uint32_t)rx);
+    if (ry == 0)
+    {
+      if (rx == 1)
+      {
+        x = s - 1 - x;
+        y = s - 1 - y;
+      }
+      int t = x;
+      x = y;
+      y = t;
+    }
+    x += s * rx;
+    y += s * ry;
+    d /= 4;
+  }
+  *outX = x;
+  *outY = y;
+}
+
+static uint32_t HilbertIndex(int n, int x, int y)
+{
+  uint32_t d = 0;
+  for (int s = n / 2; s > 0; s /= 2)
+  {
+    int rx = (x & s) > 0;
+    int ry = (y & s) > 0;
+    d += (uint32_t)s * (uint32_t)s * (uint32_t)((3 * rx) ^ ry);
+    if (ry == 0)
+    {
+      if (rx == 1)
+      {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      int t = x;
+      x = y;
+      y = t;
+    }
+  }
+  return d;
+}
+
+// Pixel colours and byte pairs are counted in the same pass. The pair owned
+// by a byte is (previous, current), so a chunk only needs the byte before it;
+// the first byte of the range pairs with a dummy row that is never merged.
+static void ByteMapScanChunk(ByteMapWorker* worker, size_t index)
+{
+  ByteMapJob* job = worker->job;
+  const uint8_t* bytes = job->data;
+  uint32_t* pairs = worker->pairs;
+  size_t first = index * job->pixelsPerChunk;
+  size_t last = first + job->pixelsPerChunk;
+  if (last > job->pixelCount)
+    last = job->pixelCount;
+
+  uint64_t offset = (uint64_t)first * job->bytesPerPixel;
+  uint32_t prev = offset > 0 ? bytes[offset - 1] : BYTEMAP_NO_PREVIOUS;
+  for (size_t p = first; p < last; p++)
+  {
+    uint64_t end = offset + job->bytesPerPixel;
+    if (end > job->length)
+      end = job->length;
+    uint64_t total = end - offset;
+    uint32_t counts[BYTEMAP_CLASS_COUNT] = { 0, 0, 0, 0, 0 };
+    for (; offset < end; offset++)
+    {
+      uint32_t c = bytes[offset];
+      counts[g_ByteMapClass[c]]++;
+      pairs[(prev << 8) | c]++;
+      prev = c;
+    }
+    job->cells[p] = ByteMapCellColor(counts, total);
+  }
+}
+
+static void RunByteMapJob(ByteMapWorker* worker)
+{
+  ByteMapJob* job = worker->job;
+  for (;;)
+  {
+#ifdef _WIN32
+    size_t index = (size_t)(InterlockedIncrement(&job->nextChunk) - 1);
+#else
+    size_t index = (size_t)__atomic_fetch_add(&job->nextChunk, 1, __ATOMIC_RELAXED);
+#endif
+    if (index >= job->chunkCount)
+      break;
+    ByteMapScanChunk(worker, index);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI RunByteMapWorker(LPVOID param)
+{
+  RunByteMapJob((ByteMapWorker*)param);
+  return 0;
+}
+#else
+static void* RunByteMapWorker(void* param)
+{
+  RunByteMapJob((ByteMapWorker*)param);
+  return nullptr;
+}
+#endif
+
+static size_t ByteMapWorkerCount(size_t chunkCount)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t cpuCount = info.dwNumberOfProcessors;
+#else
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t cpuCount = online > 0 ? (size_t)online : 1;
+#endif
+  if (cpuCount > BYTEMAP_MAX_THREADS)
+    cpuCount = BYTEMAP_MAX_THREADS;
+  if (cpuCount > chunkCount)
+    cpuCount = chunkCount;
+  return cpuCount > 0 ? cpuCount : 1;
+}
+
+ByteMap::ByteMap()
+  : pairs(nullptr), cells(nullptr), dirty(nullptr), image(nullptr), data(nullptr), size(0), start(0), length(0),
+    bytesPerPixel(1), pixelCount(0), side(BYTEMAP_MIN_SIDE), imageView(BYTEMAP_DIGRAPH), imageValid(false),
+    version(0), built(false), truncated(false)
+{
+}
+
+ByteMap::~ByteMap()
+{
+  clear();
+}
+
+void ByteMap::clear()
+{
+  platformFree(pairs, BYTEMAP_PAIR_SLOTS * sizeof(uint32_t));
+  platformFree(cells, pixelCount * sizeof(uint32_t));
+  platformFree(dirty, pixelCount);
+  platformFree(image, BYTEMAP_PIXELS * sizeof(uint32_t));
+  pairs = nullptr;
+  cells = nullptr;
+  dirty = nullptr;
+  image = nullptr;
+  dirtyPixels.clear();
+  data = nullptr;
+  size = 0;
+  start = 0;
+  length = 0;
+  bytesPerPixel = 1;
+  pixelCount = 0;
+  side = BYTEMAP_MIN_SIDE;
+  imageValid = false;
+  built = false;
+  truncated = false;
+}
+
+bool ByteMap::build(const uint8_t* buffer, uint64_t bufferLength, uint64_t rangeStart, uint64_t rangeLength)
+{
+  clear();
+  if (!buffer || rangeStart > bufferLength || rangeLength > bufferLength - rangeStart)
+    return false;
+
+  ByteMapBuildClassTable();
+
+  if (rangeLength > BYTEMAP_MAX_LENGTH)
+  {
+    rangeLength = BYTEMAP_MAX_LENGTH;
+    truncated = true;
+  }
+
+  bytesPerPixel = rangeLength > BYTEMAP_PIXELS ? (rangeLength + BYTEMAP_PIXELS - 1) / BYTEMAP_PIXELS : 1;
+  pixelCount = (size_t)((rangeLength + bytesPerPixel - 1) / bytesPerPixel);
+  side = BYTEMAP_MIN_SIDE;
+  while ((size_t)side * (size_t)side < pixelCount)
+    side *= 2;
+
+  pairs = (uint32_t*)platformAlloc(BYTEMAP_PAIR_SLOTS * sizeof(uint32_t));
+  cells = (uint32_t*)platformAlloc((pixelCount > 0 ? pixelCount : 1) * sizeof(uint32_t));
+  dirty = (uint8_t*)platformAlloc(pixelCount > 0 ? pixelCount : 1);
+  image = (uint32_t*)platformAlloc(BYTEMAP_PIXELS * sizeof(uint32_t));
+  if (!pairs || !cells || !dirty || !image)
+  {
+    clear();
+    return false;
+  }
+  memSet(pairs, 0, BYTEMAP_PAIR_SLOTS * sizeof(uint32_t));
+  memSet(dirty, 0, pixelCount > 0 ? pixelCount : 1);
+
+  data = buffer;
+  size = bufferLength;
+  start = rangeStart;
+  length = rangeLength;
+  built = true;
+  if (pixelCount == 0)
+    return true;
+
+  ByteMapJob job;
+  job.data = buffer + rangeStart;
+  job.length = rangeLength;
+  job.bytesPerPixel = bytesPerPixel;
+  job.cells = cells;
+  job.pixelCount = pixelCount;
+  job.pixelsPerChunk = bytesPerPixel >= BYTEMAP_CHUNK_SIZE ? 1 : (size_t)(BYTEMAP_CHUNK_SIZE / bytesPerPixel);
+  job.chunkCount = (pixelCount + job.pixelsPerChunk - 1) / job.pixelsPerChunk;
+  job.nextChunk = 0;
+
+  // Each worker counts into a private 256 KB pair table that stays resident
+  // in its core's cache; the tables are merged once at the end.
+  size_t workerCount = ByteMapWorkerCount(job.chunkCount);
+  ByteMapWorker workers[BYTEMAP_MAX_THREADS];
+  for (size_t i = 0; i < workerCount; i++)
+  {
+    workers[i].job = &job;
+    workers[i].pairs = i == 0 ? pairs : nullptr;
+    workers[i].started = false;
+  }
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+    workers[i].pairs = (uint32_t*)platformAlloc(BYTEMAP_PAIR_SLOTS * sizeof(uint32_t));
+    if (!workers[i].pairs)
+      continue;
+    memSet(workers[i].pairs, 0, BYTEMAP_PAIR_SLOTS * sizeof(uint32_t));
+#ifdef _WIN32
+    workers[i].thread = CreateThread(nullptr, 0, RunByteMapWorker, &workers[i], 0, nullptr);
+    workers[i].started = workers[i].thread != nullptr;
+#else
+    workers[i].started = pthread_create(&workers[i].thread, nullptr, RunByteMapWorker, &workers[i]) == 0;
+#endif
+  }
+
+  RunByteMapJob(&workers[0]);
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+    if (workers[i].started)
+    {
+#ifdef _WIN32
+      WaitForSingleObject(workers[i].thread, INFINITE);
+      CloseHandle(workers[i].thread);
+#else
+      pthread_join(workers[i].thread, nullptr);
+#endif
+      for (size_t k = 0; k < BYTEMAP_PIXELS; k++)
+        pairs[k] += workers[i].pairs[k];
+    }
+    platformFree(workers[i].pairs, BYTEMAP_PAIR_SLOTS * sizeof(uint32_t));
+  }
+
+  return true;
+}
+
+// Called before the byte at offset is overwritten: the two pairs that touch
+// it are moved to their new cells and the covering pixel is recoloured lazily.
+void ByteMap::noteEdit(uint64_t offset, uint8_t newValue)
+{
+  if (!built || offset < start || offset - start >= length)
+    return;
+  uint8_t oldValue = data[offset];
+  if (oldValue == newValue)
+    return;
+
+  if (offset > start)
+  {
+    uint32_t row = (uint32_t)data[offset - 1] << 8;
+    pairs[row | oldValue]--;
+    pairs[row | newValue]++;
+  }
+  if (offset - start + 1 < length)
+  {
+    uint32_t next = data[offset + 1];
+    pairs[((uint32_t)oldValue << 8) | next]--;
+    pairs[((uint32_t)newValue << 8) | next]++;
+  }
+
+  size_t pixel = (size_t)((offset - start) / bytesPerPixel);
+  if (!dirty[pixel])
+  {
+    dirty[pixel] = 1;
+    dirtyPixels.push_back((uint32_t)pixel);
+  }
+  imageValid = false;
+}
+
+bool ByteMap::hilbertOffset(int x, int y, uint64_t* outOffset) const
+{
+  if (!built || x < 0 || y < 0 || x >= side || y >= side)
+    return false;
+  uint64_t pixel = HilbertIndex(side, x, y);
+  if (pixel >= pixelCount)
+    return false;
+  *outOffset = start + pixel * bytesPerPixel;
+  return true;
+}
+
+void ByteMap::refreshCells()
+{
+  for (size_t i = 0; i < dirtyPixels.size(); i++)
+  {
+    size_t pixel = dirtyPixels[i];
+    uint64_t offset = (uint64_t)pixel * bytesPerPixel;
+    uint64_t count = length - offset < bytesPerPixel ? length - offset : bytesPerPixel;
+    cells[pixel] = ByteMapCell(data + start + offset, count);
+    dirty[pixel] = 0;
+  }
+  dirtyPixels.clear();
+}
+
+void ByteMap::renderDigraph()
+{
+  uint32_t maxCount = 0;
+  for (size_t i = 0; i < BYTEMAP_PIXELS; i++)
+  {
+    if (pairs[i] > maxCount)
+      maxCount = pairs[i];
+  }
+  uint32_t scale = maxCount > 0 ? ByteMapLog2(maxCount + 1) : 1;
+  for (size_t i = 0; i < BYTEMAP_PIXELS; i++)
+  {
+    uint32_t count = pairs[i];
+    image[i] = count == 0 ? 0 : ByteMapRampColor((uint32_t)((uint64_t)ByteMapLog2(count + 1) * 255 / scale));
+  }
+}
+
+void ByteMap::renderHilbert()
+{
+  size_t total = (size_t)side * (size_t)side;
+  for (size_t d = 0; d < total; d++)
+  {
+    int x;
+    int y;
+    HilbertPoint(side, (uint32_t)d, &x, &y);
+    image[(size_t)y * side + x] = d < pixelCount ? cells[d] : BYTEMAP_EMPTY_PIXEL;
+  }
+}
+
+const uint32_t* ByteMap::getImage(ByteMapView view, int* outWidth, int* outHeight, uint32_t* outVersion)
+{
+  if (!built)
+    return nullptr;
+
+  if (!imageValid || imageView != view)
+  {
+    refreshCells();
+    if (view == BYTEMAP_DIGRAPH)
+      renderDigraph();
+    else
+      renderHilbert();
+    imageView = view;
+    imageValid = true;
+    version = ++g_ByteMapVersion;
+  }
+
+  *outWidth = view == BYTEMAP_DIGRAPH ? BYTEMAP_SIDE : side;
+  *outHeight = *outWidth;
+  *outVersion = version;
+  return image;
+}
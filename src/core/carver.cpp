@@ -0,0 +1,921 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#include "carver.h"
+
+#define CARVE_NOT_FOUND ((uint64_t)-1)
+
+struct CarveJob
+{
+  const uint8_t* data;
+  uint64_t size;
+  Vector<CarveResult>* chunks;
+  size_t chunkCount;
+  volatile long nextChunk;
+};
+
+struct CarveWorker
+{
+  CarveJob* job;
+#ifdef _WIN32
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+  bool started;
+};
+
+typedef bool (*CarveProbe)(const uint8_t* p, uint64_t avail, CarveResult* result);
+
+static uint16_t g_CarvePrefix[65536];
+static bool g_CarvePrefixBuilt = false;
+
+static const char* g_CarveNames[CARVE_FORMAT_COUNT] = {
+  "PE", "ELF", "PNG", "JPEG", "GIF", "ZIP", "gzip", "bzip2", "xz", "7z", "squashfs", "PDF", "uImage"
+};
+
+const char* CarveFormatName(CarveFormat format)
+{
+  if (format < 0 || format >= CARVE_FORMAT_COUNT)
+    return "?";
+  return g_CarveNames[format];
+}
+
+static inline uint16_t CarveLE16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t CarveLE32(const uint8_t* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+static inline uint64_t CarveLE64(const uint8_t* p) { return (uint64_t)CarveLE32(p) | ((uint64_t)CarveLE32(p + 4) << 32); }
+static inline uint16_t CarveBE16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static inline uint32_t CarveBE32(const uint8_t* p) { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3]; }
+static inline uint64_t CarveBE64(const uint8_t* p) { return ((uint64_t)CarveBE32(p) << 32) | (uint64_t)CarveBE32(p + 4); }
+
+static inline uint16_t CarveRead16(const uint8_t* p, bool be) { return be ? CarveBE16(p) : CarveLE16(p); }
+static inline uint32_t CarveRead32(const uint8_t* p, bool be) { return be ? CarveBE32(p) : CarveLE32(p); }
+static inline uint64_t CarveRead64(const uint8_t* p, bool be) { return be ? CarveBE64(p) : CarveLE64(p); }
+
+static bool CarveMatch(const uint8_t* p, uint64_t avail, const char* magic, size_t length)
+{
+  if (avail < length)
+    return false;
+  for (size_t i = 0; i < length; i++)
+  {
+    if (p[i] != (uint8_t)magic[i])
+      return false;
+  }
+  return true;
+}
+
+static uint64_t CarveFind(const uint8_t* p, uint64_t avail, uint64_t from, const char* needle, size_t length)
+{
+  uint64_t limit = avail;
+  if (from < CARVE_NOT_FOUND - CARVE_SEARCH_LIMIT && from + CARVE_SEARCH_LIMIT < limit)
+    limit = from + CARVE_SEARCH_LIMIT;
+  if (limit < length)
+    return CARVE_NOT_FOUND;
+
+  uint8_t first = (uint8_t)needle[0];
+  for (uint64_t i = from; i + length <= limit; i++)
+  {
+    if (p[i] == first && CarveMatch(p + i, limit - i, needle, length))
+      return i;
+  }
+  return CARVE_NOT_FOUND;
+}
+
+static void CarveDescribe(CarveResult* result, const char* text)
+{
+  size_t used = strLen(result->description);
+  size_t room = sizeof(result->description) - 1;
+  for (size_t i = 0; text[i] && used < room; i++)
+    result->description[used++] = text[i];
+  result->description[used] = '\0';
+}
+
+static void CarveDescribeName(CarveResult* result, const uint8_t* p, uint64_t avail, size_t maxLength)
+{
+  char name[33];
+  size_t length = 0;
+  while (length < maxLength && length < avail && length < sizeof(name) - 1 && p[length] >= 0x20 && p[length] < 0x7F)
+  {
+    name[length] = (char)p[length];
+    length++;
+  }
+  name[length] = '\0';
+  if (length > 0)
+  {
+    CarveDescribe(result, ": ");
+    CarveDescribe(result, name);
+  }
+}
+
+static void CarveSetLength(CarveResult* result, uint64_t end, uint64_t avail, bool complete)
+{
+  if (complete && end <= avail)
+  {
+    result->length = end;
+    result->lengthKnown = true;
+    return;
+  }
+  result->length = end < avail ? end : avail;
+  result->lengthKnown = false;
+  CarveDescribe(result, " (truncated)");
+}
+
+static inline void CarveExtend(uint64_t* end, uint64_t offset, uint64_t size)
+{
+  if (offset > CARVE_NOT_FOUND - size)
+  {
+    *end = CARVE_NOT_FOUND;
+    return;
+  }
+  if (offset + size > *end)
+    *end = offset + size;
+}
+
+static bool CarvePE(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 0x40)
+    return false;
+  uint32_t peOffset = CarveLE32(p + 0x3C);
+  if (peOffset < 0x40 || peOffset > 0x1000 || (uint64_t)peOffset + 24 > avail)
+    return false;
+  if (CarveLE32(p + peOffset) != 0x00004550)
+    return false;
+
+  uint16_t machine = CarveLE16(p + peOffset + 4);
+  uint16_t sectionCount = CarveLE16(p + peOffset + 6);
+  uint16_t optionalSize = CarveLE16(p + peOffset + 20);
+  uint16_t characteristics = CarveLE16(p + peOffset + 22);
+  if (sectionCount == 0 || sectionCount > 96 || optionalSize < 64)
+    return false;
+
+  uint64_t optional = (uint64_t)peOffset + 24;
+  uint64_t table = optional + optionalSize;
+  if (table + (uint64_t)sectionCount * 40 > avail)
+    return false;
+  uint16_t magic = CarveLE16(p + optional);
+  if (magic != 0x10B && magic != 0x20B)
+    return false;
+
+  uint64_t end = table + (uint64_t)sectionCount * 40;
+  CarveExtend(&end, 0, CarveLE32(p + optional + 60));
+  for (uint16_t i = 0; i < sectionCount; i++)
+  {
+    const uint8_t* section = p + table + (uint64_t)i * 40;
+    uint32_t rawSize = CarveLE32(section + 16);
+    uint32_t rawOffset = CarveLE32(section + 20);
+    if (rawSize > 0)
+      CarveExtend(&end, rawOffset, rawSize);
+  }
+
+  // The Authenticode blob sits after the last section and is addressed by
+  // file offset rather than RVA, so it is part of the on-disk image.
+  uint64_t directories = optional + (magic == 0x20B ? 112 : 96);
+  if (directories + 5 * 8 <= table && CarveLE32(p + directories - 4) > 4)
+  {
+    uint32_t securityOffset = CarveLE32(p + directories + 32);
+    uint32_t securitySize = CarveLE32(p + directories + 36);
+    if (securityOffset > 0 && securitySize > 0)
+      CarveExtend(&end, securityOffset, securitySize);
+  }
+
+  CarveDescribe(result, magic == 0x20B ? "PE32+" : "PE32");
+  if (machine == 0x14C)
+    CarveDescribe(result, " x86");
+  else if (machine == 0x8664)
+    CarveDescribe(result, " x86-64");
+  else if (machine == 0x1C0 || machine == 0x1C4)
+    CarveDescribe(result, " ARM");
+  else if (machine == 0xAA64)
+    CarveDescribe(result, " ARM64");
+  CarveDescribe(result, (characteristics & 0x2000) ? " DLL" : " executable");
+  CarveSetLength(result, end, avail, true);
+  return true;
+}
+
+static bool CarveELF(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 52 || !CarveMatch(p, avail, "\x7F" "ELF", 4))
+    return false;
+  uint8_t elfClass = p[4];
+  uint8_t encoding = p[5];
+  if ((elfClass != 1 && elfClass != 2) || (encoding != 1 && encoding != 2) || p[6] != 1)
+    return false;
+
+  bool is64 = elfClass == 2;
+  bool be = encoding == 2;
+  if (is64 && avail < 64)
+    return false;
+
+  uint16_t type = CarveRead16(p + 16, be);
+  uint16_t machine = CarveRead16(p + 18, be);
+  if (type == 0 || type > 4)
+    return false;
+
+  uint64_t phOffset, shOffset;
+  uint16_t headerSize, phEntrySize, phCount, shEntrySize, shCount;
+  if (is64)
+  {
+    phOffset = CarveRead64(p + 32, be);
+    shOffset = CarveRead64(p + 40, be);
+    headerSize = CarveRead16(p + 52, be);
+    phEntrySize = CarveRead16(p + 54, be);
+    phCount = CarveRead16(p + 56, be);
+    shEntrySize = CarveRead16(p + 58, be);
+    shCount = CarveRead16(p + 60, be);
+  }
+  else
+  {
+    phOffset = CarveRead32(p + 28, be);
+    shOffset = CarveRead32(p + 32, be);
+    headerSize = CarveRead16(p + 40, be);
+    phEntrySize = CarveRead16(p + 42, be);
+    phCount = CarveRead16(p + 44, be);
+    shEntrySize = CarveRead16(p + 46, be);
+    shCount = CarveRead16(p + 48, be);
+  }
+
+  if (headerSize != (is64 ? 64 : 52))
+    return false;
+  if (phCount > 0 && phEntrySize != (is64 ? 56 : 32))
+    return false;
+  if (shCount > 0 && shEntrySize != (is64 ? 64 : 40))
+    return false;
+  if (phCount == 0 && shCount == 0)
+    return false;
+
+  uint64_t end = headerSize;
+  if (phCount > 0)
+  {
+    uint64_t tableSize = (uint64_t)phCount * phEntrySize;
+    if (phOffset > avail || tableSize > avail - phOffset)
+      return false;
+    CarveExtend(&end, phOffset, tableSize);
+    for (uint16_t i = 0; i < phCount; i++)
+    {
+      const uint8_t* entry = p + phOffset + (uint64_t)i * phEntrySize;
+      uint64_t offset = is64 ? CarveRead64(entry + 8, be) : CarveRead32(entry + 4, be);
+      uint64_t fileSize = is64 ? CarveRead64(entry + 32, be) : CarveRead32(entry + 16, be);
+      if (fileSize > 0)
+        CarveExtend(&end, offset, fileSize);
+    }
+  }
+
+  if (shCount > 0)
+  {
+    uint64_t tableSize = (uint64_t)shCount * shEntrySize;
+    CarveExtend(&end, shOffset, tableSize);
+    if (shOffset <= avail && tableSize <= avail - shOffset)
+    {
+      for (uint16_t i = 0; i < shCount; i++)
+      {
+        const uint8_t* entry = p + shOffset + (uint64_t)i * shEntrySize;
+        if (CarveRead32(entry + 4, be) == 8)
+          continue;
+        uint64_t offset = is64 ? CarveRead64(entry + 24, be) : CarveRead32(entry + 16, be);
+        uint64_t size = is64 ? CarveRead64(entry + 32, be) : CarveRead32(entry + 20, be);
+        if (size > 0)
+          CarveExtend(&end, offset, size);
+      }
+    }
+  }
+
+  CarveDescribe(result, is64 ? "ELF64" : "ELF32");
+  if (machine == 3)
+    CarveDescribe(result, " x86");
+  else if (machine == 0x3E)
+    CarveDescribe(result, " x86-64");
+  else if (machine == 0x28)
+    CarveDescribe(result, " ARM");
+  else if (machine == 0xB7)
+    CarveDescribe(result, " AArch64");
+  else if (machine == 8)
+    CarveDescribe(result, " MIPS");
+  else if (machine == 0x14 || machine == 0x15)
+    CarveDescribe(result, " PowerPC");
+  else if (machine == 0xF3)
+    CarveDescribe(result, " RISC-V");
+  static const char* typeNames[] = {"", " relocatable", " executable", " shared object", " core"};
+  CarveDescribe(result, typeNames[type]);
+  CarveSetLength(result, end, avail, true);
+  return true;
+}
+
+static bool CarvePNG(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (!CarveMatch(p, avail, "\x89PNG\r\n\x1A\n", 8) || avail < 33)
+    return false;
+  if (CarveBE32(p + 8) != 13 || !CarveMatch(p + 12, avail - 12, "IHDR", 4))
+    return false;
+
+  uint64_t pos = 8;
+  bool complete = false;
+  while (pos + 12 <= avail)
+  {
+    uint32_t length = CarveBE32(p + pos);
+    const uint8_t* type = p + pos + 4;
+    bool validType = length <= 0x7FFFFFFF;
+    for (int i = 0; i < 4 && validType; i++)
+      validType = (type[i] >= 'A' && type[i] <= 'Z') || (type[i] >= 'a' && type[i] <= 'z');
+    if (!validType)
+      break;
+    pos += 12 + (uint64_t)length;
+    if (CarveMatch(type, 4, "IEND", 4))
+    {
+      complete = true;
+      break;
+    }
+  }
+
+  char text[16];
+  CarveDescribe(result, "PNG ");
+  itoaDec(CarveBE32(p + 16), text, sizeof(text));
+  CarveDescribe(result, text);
+  CarveDescribe(result, "x");
+  itoaDec(CarveBE32(p + 20), text, sizeof(text));
+  CarveDescribe(result, text);
+  CarveSetLength(result, pos, avail, complete);
+  return true;
+}
+
+static bool CarveJPEG(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 4 || p[0] != 0xFF || p[1] != 0xD8 || p[2] != 0xFF)
+    return false;
+  uint8_t firstMarker = p[3];
+  if (!((firstMarker >= 0xE0 && firstMarker <= 0xEF) || (firstMarker >= 0xC0 && firstMarker <= 0xC4) ||
+        firstMarker == 0xDB || firstMarker == 0xDD || firstMarker == 0xFE))
+    return false;
+
+  uint64_t limit = avail < CARVE_SEARCH_LIMIT ? avail : CARVE_SEARCH_LIMIT;
+  uint64_t pos = 2;
+  bool sawScan = false;
+  bool complete = false;
+  while (pos + 2 <= limit)
+  {
+    if (p[pos] != 0xFF)
+      break;
+    uint8_t marker = p[pos + 1];
+    if (marker == 0xFF)
+    {
+      pos++;
+      continue;
+    }
+    if (marker == 0xD9)
+    {
+      pos += 2;
+      complete = sawScan;
+      break;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+    {
+      pos += 2;
+      continue;
+    }
+    if (pos + 4 > limit)
+      break;
+    uint16_t length = CarveBE16(p + pos + 2);
+    if (length < 2)
+      break;
+    pos += 2 + (uint64_t)length;
+
+    if (marker == 0xDA)
+    {
+      sawScan = true;
+      while (pos + 1 < limit)
+      {
+        uint8_t next = p[pos + 1];
+        if (p[pos] == 0xFF && next != 0x00 && next != 0xFF && !(next >= 0xD0 && next <= 0xD7))
+          break;
+        pos++;
+      }
+    }
+  }
+
+  if (!sawScan)
+    return false;
+  CarveDescribe(result, firstMarker == 0xE1 ? "JPEG (Exif)" : "JPEG");
+  CarveSetLength(result, pos, avail, complete);
+  return true;
+}
+
+static uint64_t CarveSkipSubBlocks(const uint8_t* p, uint64_t avail, uint64_t pos)
+{
+  while (pos < avail)
+  {
+    uint8_t length = p[pos++];
+    if (length == 0)
+      break;
+    pos += length;
+  }
+  return pos;
+}
+
+static bool CarveGIF(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 13 || (!CarveMatch(p, avail, "GIF87a", 6) && !CarveMatch(p, avail, "GIF89a", 6)))
+    return false;
+  uint16_t width = CarveLE16(p + 6);
+  uint16_t height = CarveLE16(p + 8);
+  if (width == 0 || height == 0)
+    return false;
+
+  uint64_t pos = 13;
+  if (p[10] & 0x80)
+    pos += 3ull << ((p[10] & 7) + 1);
+
+  int images = 0;
+  bool complete = false;
+  while (pos < avail)
+  {
+    uint8_t block = p[pos];
+    if (block == 0x3B)
+    {
+      pos++;
+      complete = images > 0;
+      break;
+    }
+    if (block == 0x21)
+    {
+      pos = CarveSkipSubBlocks(p, avail, pos + 2);
+    }
+    else if (block == 0x2C)
+    {
+      if (pos + 10 > avail)
+        break;
+      uint8_t flags = p[pos + 9];
+      pos += 10;
+      if (flags & 0x80)
+        pos += 3ull << ((flags & 7) + 1);
+      pos = CarveSkipSubBlocks(p, avail, pos + 1);
+      images++;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (images == 0)
+    return false;
+  char text[16];
+  CarveDescribe(result, "GIF ");
+  itoaDec(width, text, sizeof(text));
+  CarveDescribe(result, text);
+  CarveDescribe(result, "x");
+  itoaDec(height, text, sizeof(text));
+  CarveDescribe(result, text);
+  CarveSetLength(result, pos, avail, complete);
+  return true;
+}
+
+static bool CarveZIP(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 30 || CarveLE32(p) != 0x04034B50)
+    return false;
+  uint16_t version = CarveLE16(p + 4);
+  uint16_t method = CarveLE16(p + 8);
+  uint16_t nameLength = CarveLE16(p + 26);
+  if (version > 100 || nameLength == 0 || nameLength > 1024)
+    return false;
+  if (method > 20 && method != 93 && method != 95 && method != 98 && method != 99)
+    return false;
+
+  uint64_t limit = avail < CARVE_SEARCH_LIMIT ? avail : CARVE_SEARCH_LIMIT;
+  uint64_t pos = 0;
+  uint64_t end = CARVE_NOT_FOUND;
+  int entries = 0;
+  bool search = false;
+  while (pos <= limit && limit - pos >= 4 && end == CARVE_NOT_FOUND && !search)
+  {
+    uint32_t signature = CarveLE32(p + pos);
+    if (signature == 0x04034B50)
+    {
+      if (avail - pos < 30)
+        break;
+      uint16_t flags = CarveLE16(p + pos + 6);
+      uint32_t compressed = CarveLE32(p + pos + 18);
+      // Streamed entries (data descriptor) and ZIP64 sizes do not say where
+      // the data ends, so fall back to locating the end-of-central-directory.
+      if ((flags & 8) || compressed == 0xFFFFFFFF)
+      {
+        search = true;
+        break;
+      }
+      pos += 30 + (uint64_t)CarveLE16(p + pos + 26) + CarveLE16(p + pos + 28) + compressed;
+      entries++;
+    }
+    else if (signature == 0x02014B50)
+    {
+      if (avail - pos < 46)
+        break;
+      pos += 46 + (uint64_t)CarveLE16(p + pos + 28) + CarveLE16(p + pos + 30) + CarveLE16(p + pos + 32);
+    }
+    else if (signature == 0x05054B50)
+    {
+      if (avail - pos < 6)
+        break;
+      pos += 6 + (uint64_t)CarveLE16(p + pos + 4);
+    }
+    else if (signature == 0x06064B50)
+    {
+      if (avail - pos < 12)
+        break;
+      // The record size is 64 bits of file data; anything past the buffer
+      // would wrap pos, so locate the end-of-central-directory instead.
+      uint64_t recordSize = CarveLE64(p + pos + 4);
+      if (recordSize > avail - pos - 12)
+      {
+        search = true;
+        break;
+      }
+      pos += 12 + recordSize;
+    }
+    else if (signature == 0x07064B50)
+    {
+      pos += 20;
+    }
+    else if (signature == 0x06054B50)
+    {
+      if (avail - pos < 22)
+        break;
+      end = pos + 22 + CarveLE16(p + pos + 20);
+    }
+    else
+    {
+      search = true;
+    }
+  }
+
+  if (search)
+  {
+    uint64_t found = CarveFind(p, avail, pos, "PK\x05\x06", 4);
+    if (found != CARVE_NOT_FOUND && avail - found >= 22)
+      end = found + 22 + CarveLE16(p + found + 20);
+  }
+
+  char text[16];
+  CarveDescribe(result, "ZIP");
+  if (end != CARVE_NOT_FOUND && !search)
+  {
+    CarveDescribe(result, ", ");
+    itoaDec(entries, text, sizeof(text));
+    CarveDescribe(result, text);
+    CarveDescribe(result, entries == 1 ? " entry" : " entries");
+  }
+  CarveDescribeName(result, p + 30, avail - 30, nameLength);
+  if (end == CARVE_NOT_FOUND)
+    CarveSetLength(result, pos, avail, false);
+  else
+    CarveSetLength(result, end, avail, true);
+  return true;
+}
+
+static bool CarveGZIP(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 18 || p[2] != 8 || (p[3] & 0xE0) != 0)
+    return false;
+  if (p[8] != 0 && p[8] != 2 && p[8] != 4)
+    return false;
+  if (p[9] > 13 && p[9] != 255)
+    return false;
+
+  CarveDescribe(result, "gzip");
+  if (p[3] & 0x08)
+  {
+    uint64_t pos = 10;
+    if (p[3] & 0x04)
+      pos += 2 + (uint64_t)CarveLE16(p + 10);
+    if (pos < avail)
+      CarveDescribeName(result, p + pos, avail - pos, 32);
+  }
+  return true;
+}
+
+static bool CarveBZIP2(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 10 || p[2] != 'h' || p[3] < '1' || p[3] > '9')
+    return false;
+  if (!CarveMatch(p + 4, 6, "\x31\x41\x59\x26\x53\x59", 6) && !CarveMatch(p + 4, 6, "\x17\x72\x45\x38\x50\x90", 6))
+    return false;
+
+  char text[4] = {(char)p[3], '0', '0', '\0'};
+  CarveDescribe(result, "bzip2, ");
+  CarveDescribe(result, text);
+  CarveDescribe(result, "k blocks");
+  return true;
+}
+
+static bool CarveXZ(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (!CarveMatch(p, avail, "\xFD" "7zXZ\x00", 6) || avail < 12)
+    return false;
+  uint8_t check = p[7];
+  if (p[6] != 0 || (check != 0 && check != 1 && check != 4 && check != 10))
+    return false;
+
+  CarveDescribe(result, "xz");
+  return true;
+}
+
+static bool Carve7Z(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (!CarveMatch(p, avail, "7z\xBC\xAF\x27\x1C", 6) || avail < 32 || p[6] != 0)
+    return false;
+  uint64_t nextOffset = CarveLE64(p + 12);
+  uint64_t nextSize = CarveLE64(p + 20);
+  if (nextSize == 0 || nextSize > 0xFFFFFFFFull || nextOffset > CARVE_NOT_FOUND - 32 - nextSize)
+    return false;
+
+  char text[8];
+  CarveDescribe(result, "7z 0.");
+  itoaDec(p[7], text, sizeof(text));
+  CarveDescribe(result, text);
+  CarveSetLength(result, 32 + nextOffset + nextSize, avail, true);
+  return true;
+}
+
+static bool CarveSquashFS(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (!CarveMatch(p, avail, "hsqs", 4) || avail < 96)
+    return false;
+  uint32_t inodes = CarveLE32(p + 4);
+  uint32_t blockSize = CarveLE32(p + 12);
+  uint16_t compression = CarveLE16(p + 20);
+  uint16_t blockLog = CarveLE16(p + 22);
+  uint16_t major = CarveLE16(p + 28);
+  uint64_t bytesUsed = CarveLE64(p + 40);
+  if (major != 4 || inodes == 0 || blockLog < 12 || blockLog > 20 || blockSize != (1u << blockLog))
+    return false;
+  if (bytesUsed < 96)
+    return false;
+
+  static const char* compressors[] = {"", " gzip", " lzma", " lzo", " xz", " lz4", " zstd"};
+  char text[16];
+  CarveDescribe(result, "squashfs 4.");
+  itoaDec(CarveLE16(p + 30), text, sizeof(text));
+  CarveDescribe(result, text);
+  if (compression < sizeof(compressors) / sizeof(compressors[0]))
+    CarveDescribe(result, compressors[compression]);
+  CarveDescribe(result, ", ");
+  itoaDec(inodes, text, sizeof(text));
+  CarveDescribe(result, text);
+  CarveDescribe(result, " inodes");
+  CarveSetLength(result, bytesUsed, avail, true);
+  return true;
+}
+
+static bool CarvePDF(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (!CarveMatch(p, avail, "%PDF-", 5) || avail < 8)
+    return false;
+  if (p[5] < '1' || p[5] > '2' || p[6] != '.' || p[7] < '0' || p[7] > '9')
+    return false;
+
+  char version[4] = {(char)p[5], '.', (char)p[7], '\0'};
+  CarveDescribe(result, "PDF ");
+  CarveDescribe(result, version);
+
+  uint64_t found = CarveFind(p, avail, 8, "%%EOF", 5);
+  if (found == CARVE_NOT_FOUND)
+    return true;
+  uint64_t end = found + 5;
+  while (end < avail && end < found + 7 && (p[end] == '\r' || p[end] == '\n'))
+    end++;
+  CarveSetLength(result, end, avail, true);
+  return true;
+}
+
+static bool CarveUImage(const uint8_t* p, uint64_t avail, CarveResult* result)
+{
+  if (avail < 64 || CarveBE32(p) != 0x27051956)
+    return false;
+  uint32_t dataSize = CarveBE32(p + 12);
+  uint8_t type = p[30];
+  uint8_t compression = p[31];
+  if (dataSize == 0 || type == 0 || type > 0x30 || compression > 5)
+    return false;
+
+  CarveDescribe(result, "uImage");
+  CarveDescribeName(result, p + 32, 32, 32);
+  CarveSetLength(result, 64 + (uint64_t)dataSize, avail, true);
+  return true;
+}
+
+static const CarveProbe g_CarveProbes[CARVE_FORMAT_COUNT] = {
+  CarvePE, CarveELF, CarvePNG, CarveJPEG, CarveGIF, CarveZIP, CarveGZIP,
+  CarveBZIP2, CarveXZ, Carve7Z, CarveSquashFS, CarvePDF, CarveUImage
+};
+
+static void CarveAddPrefix(uint8_t first, uint8_t second, CarveFormat format)
+{
+  g_CarvePrefix[first | (second << 8)] |= (uint16_t)(1u << format);
+}
+
+static void CarveBuildPrefixTable()
+{
+  if (g_CarvePrefixBuilt)
+    return;
+  CarveAddPrefix('M', 'Z', CARVE_PE);
+  CarveAddPrefix(0x7F, 'E', CARVE_ELF);
+  CarveAddPrefix(0x89, 'P', CARVE_PNG);
+  CarveAddPrefix(0xFF, 0xD8, CARVE_JPEG);
+  CarveAddPrefix('G', 'I', CARVE_GIF);
+  CarveAddPrefix('P', 'K', CARVE_ZIP);
+  CarveAddPrefix(0x1F, 0x8B, CARVE_GZIP);
+  CarveAddPrefix('B', 'Z', CARVE_BZIP2);
+  CarveAddPrefix(0xFD, '7', CARVE_XZ);
+  CarveAddPrefix('7', 'z', CARVE_7Z);
+  CarveAddPrefix('h', 's', CARVE_SQUASHFS);
+  CarveAddPrefix('%', 'P', CARVE_PDF);
+  CarveAddPrefix(0x27, 0x05, CARVE_UIMAGE);
+  g_CarvePrefixBuilt = true;
+}
+
+static void CarveChunk(CarveJob* job, size_t chunkIndex)
+{
+  const uint8_t* data = job->data;
+  uint64_t size = job->size;
+  uint64_t start = (uint64_t)chunkIndex * CARVE_CHUNK_SIZE;
+  uint64_t end = start + CARVE_CHUNK_SIZE;
+  if (end > size - 1)
+    end = size - 1;
+
+  Vector<CarveResult>& out = job->chunks[chunkIndex];
+  uint64_t covered[CARVE_FORMAT_COUNT];
+  for (int i = 0; i < CARVE_FORMAT_COUNT; i++)
+    covered[i] = 0;
+
+  for (uint64_t pos = start; pos < end; pos++)
+  {
+    uint16_t candidates = g_CarvePrefix[data[pos] | (data[pos + 1] << 8)];
+    if (!candidates)
+      continue;
+
+    for (int format = 0; format < CARVE_FORMAT_COUNT; format++)
+    {
+      if (!(candidates & (1u << format)) || pos < covered[format])
+        continue;
+
+      CarveResult result;
+      result.offset = pos;
+      result.length = 0;
+      result.format = (CarveFormat)format;
+      result.lengthKnown = false;
+      result.description[0] = '\0';
+      if (!g_CarveProbes[format](data + pos, size - pos, &result))
+        continue;
+
+      // Members of a ZIP or sections of a PE would otherwise each revalidate
+      // the whole container; skip the rest of it within this chunk.
+      if (result.length > 0)
+        covered[format] = pos + result.length;
+      out.push_back(result);
+      if (out.size() >= CARVE_MAX_RESULTS)
+        return;
+    }
+  }
+}
+
+static void RunCarveJob(CarveWorker* worker)
+{
+  CarveJob* job = worker->job;
+  for (;;)
+  {
+#ifdef _WIN32
+    size_t index = (size_t)(InterlockedIncrement(&job->nextChunk) - 1);
+#else
+    size_t index = (size_t)__atomic_fetch_add(&job->nextChunk, 1, __ATOMIC_RELAXED);
+#endif
+    if (index >= job->chunkCount)
+      break;
+    CarveChunk(job, index);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI RunCarveWorker(LPVOID param)
+{
+  RunCarveJob((CarveWorker*)param);
+  return 0;
+}
+#else
+static void* RunCarveWorker(void* param)
+{
+  RunCarveJob((CarveWorker*)param);
+  return nullptr;
+}
+#endif
+
+static size_t CarveWorkerCount(size_t chunkCount)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t cpuCount = info.dwNumberOfProcessors;
+#else
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t cpuCount = online > 0 ? (size_t)online : 1;
+#endif
+  if (cpuCount > CARVE_MAX_THREADS)
+    cpuCount = CARVE_MAX_THREADS;
+  if (cpuCount > chunkCount)
+    cpuCount = chunkCount;
+  return cpuCount > 0 ? cpuCount : 1;
+}
+
+bool CarveBuffer(const uint8_t* data, uint64_t size, Vector<CarveResult>* outResults)
+{
+  if (!outResults)
+    return false;
+  outResults->clear();
+  if (!data || size < 2)
+    return true;
+
+  CarveBuildPrefixTable();
+
+  CarveJob job;
+  job.data = data;
+  job.size = size;
+  job.chunkCount = (size_t)((size + CARVE_CHUNK_SIZE - 1) / CARVE_CHUNK_SIZE);
+  job.nextChunk = 0;
+  job.chunks = new Vector<CarveResult>[job.chunkCount];
+  if (!job.chunks)
+    return false;
+
+  size_t workerCount = CarveWorkerCount(job.chunkCount);
+  CarveWorker workers[CARVE_MAX_THREADS];
+  for (size_t i = 0; i < workerCount; i++)
+  {
+    workers[i].job = &job;
+    workers[i].started = false;
+  }
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+#ifdef _WIN32
+    workers[i].thread = CreateThread(nullptr, 0, RunCarveWorker, &workers[i], 0, nullptr);
+    workers[i].started = workers[i].thread != nullptr;
+#else
+    workers[i].started = pthread_create(&workers[i].thread, nullptr, RunCarveWorker, &workers[i]) == 0;
+#endif
+  }
+
+  RunCarveJob(&workers[0]);
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+    if (!workers[i].started)
+      continue;
+#ifdef _WIN32
+    WaitForSingleObject(workers[i].thread, INFINITE);
+    CloseHandle(workers[i].thread);
+#else
+    pthread_join(workers[i].thread, nullptr);
+#endif
+  }
+
+  // Chunks only suppressed nested hits locally; an object that starts in one
+  // chunk still covers same-format hits found by later chunks.
+  uint64_t covered[CARVE_FORMAT_COUNT];
+  for (int i = 0; i < CARVE_FORMAT_COUNT; i++)
+    covered[i] = 0;
+
+  for (size_t c = 0; c < job.chunkCount && outResults->size() < CARVE_MAX_RESULTS; c++)
+  {
+    Vector<CarveResult>& chunk = job.chunks[c];
+    for (size_t i = 0; i < chunk.size() && outResults->size() < CARVE_MAX_RESULTS; i++)
+    {
+      const CarveResult& result = chunk[i];
+      if (result.offset < covered[result.format])
+        continue;
+      if (result.length > 0)
+        covered[result.format] = result.offset + result.length;
+      outResults->push_back(result);
+    }
+  }
+  delete[] job.chunks;
+
+  // Stream formats carry no length in their header; assume each one runs
+  // until the next carved object or the end of the buffer.
+  for (size_t i = 0; i < outResults->size(); i++)
+  {
+    CarveResult& result = (*outResults)[i];
+    if (result.length > 0)
+      continue;
+    uint64_t next = size;
+    for (size_t j = i + 1; j < outResults->size(); j++)
+    {
+      if ((*outResults)[j].offset > result.offset)
+      {
+        next = (*outResults)[j].offset;
+        break;
+      }
+    }
+    result.length = next - result.offset;
+  }
+  return true;
+}
@@ -0,0 +1,312 @@
+#include "disasmcache.h"
+
+IntervalSet::IntervalSet()
+  : items(nullptr),
+  count(0),
+  capacity(0)
+{
+}
+
+IntervalSet::~IntervalSet()
+{
+  if (items)
+    platformFree(items, capacity * sizeof(ByteInterval));
+}
+
+bool IntervalSet::reserve(size_t needed)
+{
+  if (needed <= capacity)
+    return true;
+
+  size_t newCapacity = capacity ? capacity * 2 : 16;
+  while (newCapacity < needed)
+    newCapacity *= 2;
+
+  ByteInterval* newItems = (ByteInterval*)platformAlloc(newCapacity * sizeof(ByteInterval));
+  if (!newItems)
+    return false;
+
+  if (items)
+  {
+    memCopy(newItems, items, count * sizeof(ByteInterval));
+    platformFree(items, capacity * sizeof(ByteInterval));
+  }
+
+  items = newItems;
+  capacity = newCapacity;
+  return true;
+}
+
+size_t IntervalSet::lowerBound(size_t offset) const
+{
+  size_t lo = 0;
+  size_t hi = count;
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (items[mid].end < offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+void IntervalSet::splice(size_t first, size_t removeCount, const ByteInterval* insert, size_t insertCount)
+{
+  size_t newCount = count - removeCount + insertCount;
+  if (!reserve(newCount))
+    return;
+
+  size_t tail = count - first - removeCount;
+  if (tail > 0 && removeCount != insertCount)
+  {
+    memCopy(items + first + insertCount, items + first + removeCount, tail * sizeof(ByteInterval));
+  }
+
+  for (size_t i = 0; i < insertCount; i++)
+    items[first + i] = insert[i];
+
+  count = newCount;
+}
+
+void IntervalSet::add(size_t start, size_t end)
+{
+  if (start >= end)
+    return;
+
+  size_t first = lowerBound(start);
+  size_t last = first;
+
+  ByteInterval merged;
+  merged.start = start;
+  merged.end = end;
+
+  while (last < count && items[last].start <= end)
+  {
+    if (items[last].start < merged.start)
+      merged.start = items[last].start;
+    if (items[last].end > merged.end)
+      merged.end = items[last].end;
+    last++;
+  }
+
+  splice(first, last - first, &merged, 1);
+}
+
+void IntervalSet::remove(size_t start, size_t end)
+{
+  if (start >= end)
+    return;
+
+  size_t first = lowerBound(start + 1);
+  size_t last = first;
+
+  ByteInterval pieces[2];
+  size_t pieceCount = 0;
+
+  while (last < count && items[last].start < end)
+  {
+    if (items[last].start < start)
+    {
+      pieces[pieceCount].start = items[last].start;
+      pieces[pieceCount].end = start;
+      pieceCount++;
+    }
+    if (items[last].end > end)
+    {
+      pieces[pieceCount].start = end;
+      pieces[pieceCount].end = items[last].end;
+      pieceCount++;
+    }
+    last++;
+  }
+
+  if (last > first)
+    splice(first, last - first, pieces, pieceCount);
+}
+
+bool IntervalSet::covers(size_t start, size_t end) const
+{
+  if (start >= end)
+    return true;
+
+  size_t i = lowerBound(end);
+  return i < count && items[i].start <= start;
+}
+
+DisassemblyCache::DisassemblyCache()
+  : blocks(nullptr),
+  blockCount(0),
+  blockCapacity(0),
+  lineBudget(DISASM_DEFAULT_LINE_BUDGET),
+  clock(0),
+  bytesPerLine(16)
+{
+}
+
+DisassemblyCache::~DisassemblyCache()
+{
+  clear();
+  if (blocks)
+    platformFree(blocks, blockCapacity * sizeof(Block));
+}
+
+void DisassemblyCache::reset(int newBytesPerLine)
+{
+  clear();
+  bytesPerLine = newBytesPerLine > 0 ? newBytesPerLine : 16;
+}
+
+void DisassemblyCache::clear()
+{
+  for (size_t i = 0; i < blockCount; i++)
+  {
+    for (int j = 0; j < DISASM_BLOCK_LINES; j++)
+      ss_free(&blocks[i].lines[j]);
+    sysFree(blocks[i].lines);
+  }
+  blockCount = 0;
+  coverage.clear();
+}
+
+void DisassemblyCache::setLineBudget(size_t lines)
+{
+  lineBudget = lines < DISASM_MIN_LINE_BUDGET ? DISASM_MIN_LINE_BUDGET : lines;
+  trim();
+}
+
+size_t DisassemblyCache::findBlock(size_t blockIndex) const
+{
+  size_t lo = 0;
+  size_t hi = blockCount;
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (blocks[mid].index < blockIndex)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+DisassemblyCache::Block* DisassemblyCache::getOrCreateBlock(size_t blockIndex)
+{
+  size_t pos = findBlock(blockIndex);
+  if (pos < blockCount && blocks[pos].index == blockIndex)
+    return &blocks[pos];
+
+  if (blockCount >= blockCapacity)
+  {
+    size_t newCapacity = blockCapacity ? blockCapacity * 2 : 16;
+    Block* newBlocks = (Block*)platformAlloc(newCapacity * sizeof(Block));
+    if (!newBlocks)
+      return nullptr;
+    if (blocks)
+    {
+      memCopy(newBlocks, blocks, blockCount * sizeof(Block));
+      platformFree(blocks, blockCapacity * sizeof(Block));
+    }
+    blocks = newBlocks;
+    blockCapacity = newCapacity;
+  }
+
+  SimpleString* lines = (SimpleString*)sysAlloc(DISASM_BLOCK_LINES * sizeof(SimpleString));
+  if (!lines)
+    return nullptr;
+  for (int j = 0; j < DISASM_BLOCK_LINES; j++)
+    ss_init(&lines[j]);
+
+  if (pos < blockCount)
+    memCopy(blocks + pos + 1, blocks + pos, (blockCount - pos) * sizeof(Block));
+
+  blocks[pos].index = blockIndex;
+  blocks[pos].lastUsed = clock;
+  blocks[pos].lines = lines;
+  blockCount++;
+  return &blocks[pos];
+}
+
+bool DisassemblyCache::setLine(size_t lineIndex, const char* text)
+{
+  Block* block = getOrCreateBlock(lineIndex / DISASM_BLOCK_LINES);
+  if (!block)
+    return false;
+
+  SimpleString& line = block->lines[lineIndex % DISASM_BLOCK_LINES];
+  ss_clear(&line);
+  if (text && text[0])
+    ss_append_cstr(&line, text);
+
+  block->lastUsed = ++clock;
+  return true;
+}
+
+const char* DisassemblyCache::getLine(size_t lineIndex) const
+{
+  size_t blockIndex = lineIndex / DISASM_BLOCK_LINES;
+  size_t pos = findBlock(blockIndex);
+  if (pos >= blockCount || blocks[pos].index != blockIndex)
+    return nullptr;
+
+  const SimpleString& line = blocks[pos].lines[lineIndex % DISASM_BLOCK_LINES];
+  return line.length > 0 ? line.data : nullptr;
+}
+
+void DisassemblyCache::touchRange(size_t startOffset, size_t endOffset)
+{
+  size_t blockBytes = (size_t)bytesPerLine * DISASM_BLOCK_LINES;
+  size_t firstBlock = startOffset / blockBytes;
+  size_t lastBlock = (endOffset - 1) / blockBytes;
+
+  clock++;
+  for (size_t pos = findBlock(firstBlock); pos < blockCount && blocks[pos].index <= lastBlock; pos++)
+  {
+    blocks[pos].lastUsed = clock;
+  }
+}
+
+bool DisassemblyCache::covers(size_t startOffset, size_t endOffset)
+{
+  if (!coverage.covers(startOffset, endOffset))
+    return false;
+
+  if (endOffset > startOffset)
+    touchRange(startOffset, endOffset);
+  return true;
+}
+
+void DisassemblyCache::markCovered(size_t startOffset, size_t endOffset)
+{
+  coverage.add(startOffset, endOffset);
+}
+
+void DisassemblyCache::evictBlock(size_t position)
+{
+  Block& block = blocks[position];
+  size_t blockBytes = (size_t)bytesPerLine * DISASM_BLOCK_LINES;
+  coverage.remove(block.index * blockBytes, (block.index + 1) * blockBytes);
+
+  for (int j = 0; j < DISASM_BLOCK_LINES; j++)
+    ss_free(&block.lines[j]);
+  sysFree(block.lines);
+
+  if (position + 1 < blockCount)
+    memCopy(blocks + position, blocks + position + 1, (blockCount - position - 1) * sizeof(Block));
+  blockCount--;
+}
+
+void DisassemblyCache::trim()
+{
+  while (blockCount * DISASM_BLOCK_LINES > lineBudget)
+  {
+    size_t oldest = 0;
+    for (size_t i = 1; i < blockCount; i++)
+    {
+      if (blocks[i].lastUsed < blocks[oldest].lastUsed)
+        oldest = i;
+    }
+    evictBlock(oldest);
+  }
+}
@@ -0,0 +1,523 @@
+#include "dumpfile.h"
+
+#define ELF_ET_CORE 4
+#define ELF_PT_LOAD 1
+#define ELF_PT_NOTE 4
+#define ELF_PN_XNUM 0xFFFF
+#define ELF_PF_X 0x1
+#define ELF_PF_W 0x2
+#define ELF_PF_R 0x4
+#define ELF_NT_FILE 0x46494C45
+
+#define MINIDUMP_STREAM_MODULE_LIST 4
+#define MINIDUMP_STREAM_MEMORY_LIST 5
+#define MINIDUMP_STREAM_MEMORY64_LIST 9
+#define MINIDUMP_STREAM_MEMORY_INFO_LIST 16
+#define MINIDUMP_MODULE_SIZE 108
+#define MINIDUMP_MEMORY_INFO_MIN_SIZE 48
+#define MINIDUMP_MEM_COMMIT 0x1000
+#define MINIDUMP_MEM_MAPPED 0x40000
+
+struct DumpReader
+{
+  const uint8_t* data;
+  uint64_t size;
+  bool bigEndian;
+};
+
+struct DumpProtection
+{
+  uint64_t start;
+  uint64_t end;
+  uint32_t protection;
+};
+
+static bool DumpHas(const DumpReader& reader, uint64_t offset, uint64_t length)
+{
+  return offset <= reader.size && length <= reader.size - offset;
+}
+
+static uint64_t DumpRead(const DumpReader& reader, uint64_t offset, int width)
+{
+  if (!DumpHas(reader, offset, (uint64_t)width))
+    return 0;
+
+  const uint8_t* p = reader.data + offset;
+  uint64_t value = 0;
+  for (int i = 0; i < width; i++)
+  {
+    int shift = reader.bigEndian ? (width - 1 - i) * 8 : i * 8;
+    value |= (uint64_t)p[i] << shift;
+  }
+  return value;
+}
+
+static void SortDumpSegments(Vector<DumpSegment>& segments)
+{
+  for (size_t i = 1; i < segments.size(); i++)
+  {
+    if (segments[i].region.virtualAddress >= segments[i - 1].region.virtualAddress)
+      continue;
+
+    DumpSegment moving = segments[i];
+    size_t j = i;
+    while (j > 0 && segments[j - 1].region.virtualAddress > moving.region.virtualAddress)
+    {
+      segments[j] = segments[j - 1];
+      j--;
+    }
+    segments[j] = moving;
+  }
+}
+
+static size_t FindDumpSegment(const Vector<DumpSegment>& segments, uint64_t address)
+{
+  size_t lo = 0;
+  size_t hi = segments.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (segments[mid].region.virtualAddress + segments[mid].region.size <= address)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static void AddDumpSegment(const DumpReader& reader, uint64_t address, uint64_t memorySize,
+                           uint64_t dumpOffset, uint64_t storedSize, uint32_t protection,
+                           Vector<DumpSegment>* out)
+{
+  if (memorySize == 0 || memorySize > (uint64_t)(size_t)-1 || address + memorySize < address)
+    return;
+
+  if (dumpOffset > reader.size)
+    storedSize = 0;
+  else if (storedSize > reader.size - dumpOffset)
+    storedSize = reader.size - dumpOffset;
+  if (storedSize > memorySize)
+    storedSize = memorySize;
+
+  DumpSegment segment;
+  memSet(&segment, 0, sizeof(segment));
+  segment.region.virtualAddress = address;
+  segment.region.size = (size_t)memorySize;
+  segment.region.protection = protection;
+  segment.dumpOffset = dumpOffset;
+  segment.storedSize = storedSize;
+  out->push_back(segment);
+}
+
+static void NameDumpSegments(Vector<DumpSegment>& segments, uint64_t start, uint64_t end,
+                             uint64_t fileOffset, const char* name)
+{
+  for (size_t i = FindDumpSegment(segments, start);
+       i < segments.size() && segments[i].region.virtualAddress < end; i++)
+  {
+    MemoryRegion& region = segments[i].region;
+    if (region.virtualAddress < start)
+      continue;
+
+    region.fileOffset = fileOffset + (region.virtualAddress - start);
+    stringCopy(region.name, name, sizeof(region.name));
+  }
+}
+
+static void ParseElfFileNote(const DumpReader& reader, uint64_t offset, uint64_t length,
+                             bool is64, Vector<DumpSegment>& segments)
+{
+  int word = is64 ? 8 : 4;
+  if (length < (uint64_t)word * 2)
+    return;
+
+  uint64_t count = DumpRead(reader, offset, word);
+  uint64_t pageSize = DumpRead(reader, offset + word, word);
+  uint64_t table = offset + (uint64_t)word * 2;
+  if (count > (length - (uint64_t)word * 2) / ((uint64_t)word * 3))
+    return;
+
+  uint64_t name = table + count * word * 3;
+  uint64_t end = offset + length;
+
+  for (uint64_t i = 0; i < count && name < end; i++)
+  {
+    uint64_t entry = table + i * word * 3;
+    uint64_t start = DumpRead(reader, entry, word);
+    uint64_t stop = DumpRead(reader, entry + word, word);
+    uint64_t pageOffset = DumpRead(reader, entry + word * 2, word);
+
+    const char* text = (const char*)reader.data + name;
+    uint64_t textLength = 0;
+    while (name + textLength < end && text[textLength] != 0)
+      textLength++;
+    if (name + textLength >= end)
+      break;
+
+    NameDumpSegments(segments, start, stop, pageOffset * pageSize, text);
+    name += textLength + 1;
+  }
+}
+
+static void ParseElfNotes(const DumpReader& reader, uint64_t offset, uint64_t length,
+                          bool is64, Vector<DumpSegment>& segments)
+{
+  uint64_t position = offset;
+  uint64_t end = offset + length;
+
+  while (position + 12 <= end)
+  {
+    uint64_t nameSize = DumpRead(reader, position, 4);
+    uint64_t descSize = DumpRead(reader, position + 4, 4);
+    uint32_t type = (uint32_t)DumpRead(reader, position + 8, 4);
+
+    uint64_t desc = position + 12 + ((nameSize + 3) & ~3ULL);
+    if (desc > end || descSize > end - desc)
+      break;
+
+    const char* name = (const char*)reader.data + position + 12;
+    if (type == ELF_NT_FILE && nameSize == 5 && strEquals(name, "CORE"))
+      ParseElfFileNote(reader, desc, descSize, is64, segments);
+
+    position = desc + ((descSize + 3) & ~3ULL);
+  }
+}
+
+static bool ParseElfCore(const DumpReader& reader, Vector<DumpSegment>* out)
+{
+  bool is64 = reader.data[4] == 2;
+  int word = is64 ? 8 : 4;
+
+  uint64_t phoff = DumpRead(reader, is64 ? 0x20 : 0x1C, word);
+  uint64_t shoff = DumpRead(reader, is64 ? 0x28 : 0x20, word);
+  uint64_t phentsize = DumpRead(reader, is64 ? 0x36 : 0x2A, 2);
+  uint64_t phnum = DumpRead(reader, is64 ? 0x38 : 0x2C, 2);
+
+  if (phnum == ELF_PN_XNUM && shoff != 0)
+    phnum = DumpRead(reader, shoff + (is64 ? 0x2C : 0x1C), 4);
+
+  if (phentsize < (uint64_t)(is64 ? 56 : 32) || !DumpHas(reader, phoff, phnum * phentsize))
+    return false;
+
+  Vector<uint64_t> notes;
+  for (uint64_t i = 0; i < phnum; i++)
+  {
+    uint64_t ph = phoff + i * phentsize;
+    uint32_t type = (uint32_t)DumpRead(reader, ph, 4);
+    uint32_t flags = (uint32_t)DumpRead(reader, ph + (is64 ? 4 : 24), 4);
+    uint64_t fileOffset = DumpRead(reader, ph + (is64 ? 8 : 4), word);
+    uint64_t address = DumpRead(reader, ph + (is64 ? 16 : 8), word);
+    uint64_t fileSize = DumpRead(reader, ph + (is64 ? 32 : 16), word);
+    uint64_t memorySize = DumpRead(reader, ph + (is64 ? 40 : 20), word);
+
+    if (type == ELF_PT_LOAD)
+    {
+      uint32_t protection = 0;
+      if (flags & ELF_PF_R)
+        protection |= MEMORY_PROT_READ;
+      if (flags & ELF_PF_W)
+        protection |= MEMORY_PROT_WRITE;
+      if (flags & ELF_PF_X)
+        protection |= MEMORY_PROT_EXEC;
+      AddDumpSegment(reader, address, memorySize, fileOffset, fileSize, protection, out);
+    }
+    else if (type == ELF_PT_NOTE && DumpHas(reader, fileOffset, fileSize))
+    {
+      notes.push_back(fileOffset);
+      notes.push_back(fileSize);
+    }
+  }
+
+  SortDumpSegments(*out);
+
+  for (size_t i = 0; i + 1 < notes.size(); i += 2)
+    ParseElfNotes(reader, notes[i], notes[i + 1], is64, *out);
+
+  return true;
+}
+
+static uint32_t MinidumpProtection(uint32_t protect, uint32_t type)
+{
+  uint32_t protection = 0;
+  if (protect & 0xFE)
+    protection |= MEMORY_PROT_READ;
+  if (protect & (0x04 | 0x08 | 0x40 | 0x80))
+    protection |= MEMORY_PROT_WRITE;
+  if (protect & (0x10 | 0x20 | 0x40 | 0x80))
+    protection |= MEMORY_PROT_EXEC;
+  if (type == MINIDUMP_MEM_MAPPED)
+    protection |= MEMORY_PROT_SHARED;
+  return protection;
+}
+
+// Full-memory dumps store whole allocations in one range, so ranges are cut
+// at memory-info boundaries to keep per-page protections accurate.
+static void ApplyMinidumpProtections(const Vector<DumpProtection>& infos, Vector<DumpSegment>& segments)
+{
+  Vector<DumpSegment> split;
+
+  for (size_t s = 0; s < segments.size(); s++)
+  {
+    const DumpSegment& segment = segments[s];
+    uint64_t start = segment.region.virtualAddress;
+    uint64_t end = start + segment.region.size;
+    uint64_t position = start;
+
+    size_t lo = 0;
+    size_t hi = infos.size();
+    while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (infos[mid].end <= position)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    while (position < end)
+    {
+      uint64_t pieceEnd = end;
+      uint32_t protection = segment.region.protection;
+
+      if (lo < infos.size())
+      {
+        if (infos[lo].start <= position)
+        {
+          protection = infos[lo].protection;
+          if (infos[lo].end < pieceEnd)
+            pieceEnd = infos[lo].end;
+          lo++;
+        }
+        else if (infos[lo].start < pieceEnd)
+        {
+          pieceEnd = infos[lo].start;
+        }
+      }
+
+      DumpSegment piece = segment;
+      uint64_t skip = position - start;
+      piece.region.virtualAddress = position;
+      piece.region.size = (size_t)(pieceEnd - position);
+      piece.region.protection = protection;
+      piece.dumpOffset = segment.dumpOffset + skip;
+      piece.storedSize = segment.storedSize > skip ? segment.storedSize - skip : 0;
+      if (piece.storedSize > piece.region.size)
+        piece.storedSize = piece.region.size;
+      split.push_back(piece);
+
+      position = pieceEnd;
+    }
+  }
+
+  segments = split;
+}
+
+static void ReadMinidumpName(const DumpReader& reader, uint64_t rva, char* out, int outSize)
+{
+  out[0] = 0;
+  uint64_t length = DumpRead(reader, rva, 4) / 2;
+  if (!DumpHas(reader, rva + 4, length * 2))
+    return;
+
+  int count = 0;
+  for (uint64_t i = 0; i < length && count < outSize - 1; i++)
+  {
+    uint64_t c = DumpRead(reader, rva + 4 + i * 2, 2);
+    out[count++] = (c >= 0x20 && c < 0x7F) ? (char)c : '?';
+  }
+  out[count] = 0;
+}
+
+static bool ParseMinidump(const DumpReader& reader, Vector<DumpSegment>* out)
+{
+  uint64_t streamCount = DumpRead(reader, 8, 4);
+  uint64_t directory = DumpRead(reader, 12, 4);
+  if (!DumpHas(reader, directory, streamCount * 12))
+    return false;
+
+  uint64_t memory64 = 0;
+  uint64_t memory32 = 0;
+  uint64_t memoryInfo = 0;
+  uint64_t modules = 0;
+  bool hasMemory64 = false;
+  bool hasMemory32 = false;
+  bool hasMemoryInfo = false;
+  bool hasModules = false;
+
+  for (uint64_t i = 0; i < streamCount; i++)
+  {
+    uint64_t entry = directory + i * 12;
+    uint32_t type = (uint32_t)DumpRead(reader, entry, 4);
+    uint64_t rva = DumpRead(reader, entry + 8, 4);
+
+    if (type == MINIDUMP_STREAM_MEMORY64_LIST && !hasMemory64)
+    {
+      memory64 = rva;
+      hasMemory64 = true;
+    }
+    else if (type == MINIDUMP_STREAM_MEMORY_LIST && !hasMemory32)
+    {
+      memory32 = rva;
+      hasMemory32 = true;
+    }
+    else if (type == MINIDUMP_STREAM_MEMORY_INFO_LIST && !hasMemoryInfo)
+    {
+      memoryInfo = rva;
+      hasMemoryInfo = true;
+    }
+    else if (type == MINIDUMP_STREAM_MODULE_LIST && !hasModules)
+    {
+      modules = rva;
+      hasModules = true;
+    }
+  }
+
+  if (hasMemory64)
+  {
+    uint64_t count = DumpRead(reader, memory64, 8);
+    uint64_t dataOffset = DumpRead(reader, memory64 + 8, 8);
+    if (!DumpHas(reader, memory64 + 16, count * 16) || count > reader.size / 16)
+      return false;
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+      uint64_t descriptor = memory64 + 16 + i * 16;
+      uint64_t address = DumpRead(reader, descriptor, 8);
+      uint64_t length = DumpRead(reader, descriptor + 8, 8);
+      AddDumpSegment(reader, address, length, dataOffset, length, MEMORY_PROT_READ, out);
+      dataOffset += length;
+    }
+  }
+  else if (hasMemory32)
+  {
+    uint64_t count = DumpRead(reader, memory32, 4);
+    if (!DumpHas(reader, memory32 + 4, count * 16))
+      return false;
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+      uint64_t descriptor = memory32 + 4 + i * 16;
+      uint64_t address = DumpRead(reader, descriptor, 8);
+      uint64_t length = DumpRead(reader, descriptor + 8, 4);
+      uint64_t rva = DumpRead(reader, descriptor + 12, 4);
+      AddDumpSegment(reader, address, length, rva, length, MEMORY_PROT_READ, out);
+    }
+  }
+  else
+  {
+    return false;
+  }
+
+  SortDumpSegments(*out);
+
+  if (hasMemoryInfo)
+  {
+    uint64_t headerSize = DumpRead(reader, memoryInfo, 4);
+    uint64_t entrySize = DumpRead(reader, memoryInfo + 4, 4);
+    uint64_t count = DumpRead(reader, memoryInfo + 8, 8);
+    uint64_t first = memoryInfo + headerSize;
+
+    if (entrySize >= MINIDUMP_MEMORY_INFO_MIN_SIZE && count <= reader.size / entrySize &&
+        DumpHas(reader, first, count * entrySize))
+    {
+      Vector<DumpProtection> infos;
+      for (uint64_t i = 0; i < count; i++)
+      {
+        uint64_t entry = first + i * entrySize;
+        uint64_t base = DumpRead(reader, entry, 8);
+        uint64_t size = DumpRead(reader, entry + 24, 8);
+        uint32_t state = (uint32_t)DumpRead(reader, entry + 32, 4);
+        if (state != MINIDUMP_MEM_COMMIT || size == 0 || base + size < base)
+          continue;
+
+        DumpProtection info;
+        info.start = base;
+        info.end = base + size;
+        info.protection = MinidumpProtection((uint32_t)DumpRead(reader, entry + 36, 4),
+                                             (uint32_t)DumpRead(reader, entry + 40, 4));
+        if (!infos.empty() && infos[infos.size() - 1].end > info.start)
+          continue;
+        infos.push_back(info);
+      }
+      ApplyMinidumpProtections(infos, *out);
+    }
+  }
+
+  if (hasModules)
+  {
+    uint64_t count = DumpRead(reader, modules, 4);
+    if (DumpHas(reader, modules + 4, count * MINIDUMP_MODULE_SIZE))
+    {
+      for (uint64_t i = 0; i < count; i++)
+      {
+        uint64_t module = modules + 4 + i * MINIDUMP_MODULE_SIZE;
+        uint64_t base = DumpRead(reader, module, 8);
+        uint64_t size = DumpRead(reader, module + 8, 4);
+
+        char path[MEMORY_REGION_NAME_LEN * 2];
+        ReadMinidumpName(reader, DumpRead(reader, module + 20, 4), path, sizeof(path));
+
+        const char* name = path;
+        for (const char* c = path; *c; c++)
+        {
+          if (*c == '\\' || *c == '/')
+            name = c + 1;
+        }
+
+        NameDumpSegments(*out, base, base + size, 0, name);
+      }
+    }
+  }
+
+  return true;
+}
+
+DumpFormat DetectDumpFormat(const uint8_t* data, size_t size)
+{
+  if (!data || size < 4)
+    return DUMP_FORMAT_NONE;
+
+  if (size >= 32 && data[0] == 'M' && data[1] == 'D' && data[2] == 'M' && data[3] == 'P')
+    return DUMP_FORMAT_MINIDUMP;
+
+  if (size >= 52 && data[0] == 0x7F && data[1] == 'E' && data[2] == 'L' && data[3] == 'F' &&
+      (data[4] == 1 || data[4] == 2) && (data[5] == 1 || data[5] == 2))
+  {
+    DumpReader reader;
+    reader.data = data;
+    reader.size = size;
+    reader.bigEndian = data[5] == 2;
+    if (DumpRead(reader, 16, 2) == ELF_ET_CORE)
+      return DUMP_FORMAT_ELF_CORE;
+  }
+
+  return DUMP_FORMAT_NONE;
+}
+
+bool ParseDumpSegments(const uint8_t* data, uint64_t size, Vector<DumpSegment>* outSegments)
+{
+  if (!outSegments)
+    return false;
+  outSegments->clear();
+
+  DumpFormat format = DetectDumpFormat(data, size > DUMP_PROBE_SIZE ? DUMP_PROBE_SIZE : (size_t)size);
+  if (format == DUMP_FORMAT_NONE)
+    return false;
+
+  DumpReader reader;
+  reader.data = data;
+  reader.size = size;
+  reader.bigEndian = format == DUMP_FORMAT_ELF_CORE && data[5] == 2;
+
+  bool parsed = format == DUMP_FORMAT_ELF_CORE
+      ? ParseElfCore(reader, outSegments)
+      : ParseMinidump(reader, outSegments);
+
+  if (!parsed || outSegments->empty())
+  {
+    outSegments->clear();
+    return false;
+  }
+
+  return true;
+}
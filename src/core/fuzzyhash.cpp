@@ -0,0 +1,731 @@
+#include "fuzzyhash.h"
+
+#define SSDEEP_MIN_BLOCKSIZE 3
+#define SSDEEP_ROLLING_WINDOW 7
+#define SSDEEP_HASH_INIT 0x27
+
+static const char g_Base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char g_HexDigitsUpper[] = "0123456789ABCDEF";
+
+static const uint8_t g_TlshTable[256] = {
+  1, 87, 49, 12, 176, 178, 102, 166, 121, 193, 6, 84, 249, 230, 44, 163,
+  14, 197, 213, 181, 161, 85, 218, 80, 64, 239, 24, 226, 236, 142, 38, 200,
+  110, 177, 104, 103, 141, 253, 255, 50, 77, 101, 81, 18, 45, 96, 31, 222,
+  25, 107, 190, 70, 86, 237, 240, 34, 72, 242, 20, 214, 244, 227, 149, 235,
+  97, 234, 57, 22, 60, 250, 82, 175, 208, 5, 127, 199, 111, 62, 135, 248,
+  174, 169, 211, 58, 66, 154, 106, 195, 245, 171, 17, 187, 182, 179, 0, 243,
+  132, 56, 148, 75, 128, 133, 158, 100, 130, 126, 91, 13, 153, 246, 216, 219,
+  119, 68, 223, 78, 83, 88, 201, 99, 122, 11, 92, 32, 136, 114, 52, 10,
+  138, 30, 48, 183, 156, 35, 61, 26, 143, 74, 251, 94, 129, 162, 63, 152,
+  170, 7, 115, 167, 241, 206, 3, 150, 55, 59, 151, 220, 90, 53, 23, 131,
+  125, 173, 15, 238, 79, 95, 89, 16, 105, 137, 225, 224, 217, 160, 37, 123,
+  118, 73, 2, 157, 46, 116, 9, 145, 134, 228, 207, 212, 202, 215, 69, 229,
+  27, 188, 67, 124, 168, 252, 42, 4, 29, 108, 21, 247, 19, 205, 39, 203,
+  233, 40, 186, 147, 198, 192, 155, 33, 164, 191, 98, 204, 165, 180, 117, 76,
+  140, 36, 210, 172, 41, 54, 159, 8, 185, 232, 113, 196, 231, 47, 146, 120,
+  51, 65, 28, 144, 254, 221, 93, 189, 194, 139, 112, 43, 71, 109, 184, 209,
+};
+
+// Largest input length for each TLSH length code, matching the log based
+// formula of the reference implementation without needing libm.
+static const uint64_t g_TlshLengthTops[] = {
+  1, 2, 3, 5, 7, 11,
+  17, 25, 38, 57, 86, 129,
+  194, 291, 437, 656, 854, 1110,
+  1443, 1876, 2439, 3171, 3475, 3823,
+  4205, 4626, 5088, 5597, 6157, 6772,
+  7450, 8195, 9014, 9916, 10907, 11998,
+  13198, 14518, 15970, 17567, 19323, 21256,
+  23382, 25720, 28292, 31121, 34233, 37656,
+  41422, 45564, 50121, 55133, 60646, 66711,
+  73382, 80721, 88793, 97672, 107439, 118183,
+  130002, 143002, 157302, 173032, 190336, 209369,
+  230306, 253337, 278671, 306538, 337191, 370911,
+  408002, 448802, 493682, 543051, 597356, 657091,
+  722800, 795081, 874589, 962048, 1058252, 1164078,
+  1280485, 1408534, 1549387, 1704326, 1874759, 2062235,
+  2268458, 2495304, 2744835, 3019318, 3321250, 3653375,
+  4018713, 4420584, 4862643, 5348907, 5883798, 6472178,
+  7119395, 7831335, 8614469, 9475915, 10423507, 11465858,
+  12612444, 13873688, 15261057, 16787162, 18465878, 20312466,
+  22343714, 24578085, 27035894, 29739482, 32713430, 35984773,
+  39583253, 43541578, 47895733, 52685309, 57953842, 63749226,
+  70124148, 77136564, 84850219, 93335236, 102668763, 112935636,
+  124229204, 136652119, 150317335, 165349064, 181883976, 200072375,
+  220079607, 242087575, 266296328, 292925968, 322218543, 354440400,
+  389884463, 428872912, 471760208, 518936208, 570829856, 627912799,
+  690704095, 759774496, 835751968, 919327136, 1011259871, 1112385856,
+  1223624512, 1345986880, 1480585536, 1628644160, 1791508544, 1970659392,
+  2167725439, 2384497792, 2622947711, 2885242496, 3173766784, 3491143296,
+  3840257664, 4224283519, 4646712063ull, 5111382783ull, 5622521088ull, 6184773375ull,
+  6803250943ull, 7483576063ull, 8231933695ull, 9055127039ull, 9960638976ull, 10956703231ull,
+  12052374016ull, 13257610751ull, 14583372288ull, 16041709055ull, 17645880320ull, 19410467839ull,
+  21351515136ull, 23486667775ull, 25835332608ull, 28418866175ull, 31260752895ull, 34386827263ull,
+  37825513472ull, 41608062976ull, 45768869888ull, 50345756672ull, 55380330496ull, 60918364159ull,
+  67010201600ull, 73711218687ull, 81082347519ull, 89190576127ull, 98109632511ull, 107920601087ull,
+  118712659967ull, 130583924736ull, 143642320895ull, 158006550528ull, 173807198207ull, 191187918848ull,
+  210306719743ull, 231337385983ull, 254471135231ull, 279918231552ull, 307910066175ull, 338701074432ull,
+  372571193344ull, 409828311039ull, 450811117567ull, 495892250624ull, 545481474047ull, 600029626367ull,
+  660032552959ull, 726035824639ull, 798639423488ull, 878503362559ull, 966353715199ull, 1062989037567ull,
+};
+
+static inline uint64_t SsdeepBlockSize(uint32_t index)
+{
+  return (uint64_t)SSDEEP_MIN_BLOCKSIZE << index;
+}
+
+// Only the low six bits of the FNV sum ever reach a digest character, so the
+// state is kept in a byte and the prime reduced to the same six bits.
+static inline uint8_t SsdeepSumHash(uint8_t c, uint8_t h)
+{
+  return (uint8_t)(((h * 0x13) ^ c) & 0x3F);
+}
+
+SsdeepHasher::SsdeepHasher()
+{
+  reset(0);
+}
+
+void SsdeepHasher::reset(uint64_t totalLength)
+{
+  first = 0;
+  last = 1;
+  total = totalLength;
+
+  // The digest never uses more than one size above the initial guess, so
+  // with the length known up front the larger sizes are never tracked.
+  limit = 0;
+  while (limit < SSDEEP_NUM_BLOCKHASHES - 2 && SsdeepBlockSize(limit) * SSDEEP_SPAMSUM_LENGTH < totalLength)
+    limit++;
+  limit += 2;
+
+  hashes[0].index = 0;
+  hashes[0].digest[0] = '\0';
+  hashes[0].halfDigest = '\0';
+  hashes[0].h = SSDEEP_HASH_INIT;
+  hashes[0].halfH = SSDEEP_HASH_INIT;
+  memSet(window, 0, sizeof(window));
+  windowIndex = 0;
+  h1 = 0;
+  h2 = 0;
+  h3 = 0;
+}
+
+void SsdeepHasher::forkBlockHash()
+{
+  if (last >= limit)
+    return;
+
+  BlockHash& next = hashes[last];
+  const BlockHash& previous = hashes[last - 1];
+  next.h = previous.h;
+  next.halfH = previous.halfH;
+  next.digest[0] = '\0';
+  next.halfDigest = '\0';
+  next.index = 0;
+  last++;
+}
+
+void SsdeepHasher::reduceBlockHash()
+{
+  if (last - first < 2)
+    return;
+  if (SsdeepBlockSize(first) * SSDEEP_SPAMSUM_LENGTH >= total)
+    return;
+  if (hashes[first + 1].index < SSDEEP_SPAMSUM_LENGTH / 2)
+    return;
+  first++;
+}
+
+void SsdeepHasher::update(const uint8_t* data, size_t length)
+{
+  for (size_t n = 0; n < length; n++)
+  {
+    uint8_t c = data[n];
+
+    h2 -= h1;
+    h2 += SSDEEP_ROLLING_WINDOW * (uint32_t)c;
+    h1 += c;
+    h1 -= window[windowIndex];
+    window[windowIndex] = c;
+    windowIndex = windowIndex + 1 == SSDEEP_ROLLING_WINDOW ? 0 : windowIndex + 1;
+    h3 = (h3 << 5) ^ c;
+    uint32_t sum = h1 + h2 + h3;
+
+    for (uint32_t i = first; i < last; i++)
+    {
+      hashes[i].h = SsdeepSumHash(c, hashes[i].h);
+      hashes[i].halfH = SsdeepSumHash(c, hashes[i].halfH);
+    }
+
+    // Block sizes are three times a power of two, so sum hitting
+    // blockSize - 1 means sum + 1 is a multiple of three with enough low
+    // zero bits. The division is done once instead of once per size.
+    if (sum % SSDEEP_MIN_BLOCKSIZE != SSDEEP_MIN_BLOCKSIZE - 1)
+      continue;
+    uint64_t boundary = (uint64_t)sum + 1;
+
+    for (uint32_t i = first; i < last; i++)
+    {
+      if (boundary & ((1ull << i) - 1))
+        break;
+
+      BlockHash& hash = hashes[i];
+      if (hash.index == 0)
+        forkBlockHash();
+
+      hash.digest[hash.index] = g_Base64[hash.h];
+      hash.halfDigest = g_Base64[hash.halfH];
+      if (hash.index < SSDEEP_SPAMSUM_LENGTH - 1)
+      {
+        hash.digest[++hash.index] = '\0';
+        hash.h = SSDEEP_HASH_INIT;
+        if (hash.index < SSDEEP_SPAMSUM_LENGTH / 2)
+        {
+          hash.halfH = SSDEEP_HASH_INIT;
+          hash.halfDigest = '\0';
+        }
+      }
+      else
+      {
+        reduceBlockHash();
+      }
+    }
+  }
+}
+
+bool SsdeepHasher::digest(char* out, size_t max) const
+{
+  if (!out || max < SSDEEP_MAX_RESULT)
+    return false;
+
+  uint32_t sum = h1 + h2 + h3;
+  uint32_t index = first;
+  while (SsdeepBlockSize(index) * SSDEEP_SPAMSUM_LENGTH < total)
+  {
+    if (++index >= SSDEEP_NUM_BLOCKHASHES)
+      return false;
+  }
+  while (index >= last)
+    index--;
+  while (index > first && hashes[index].index < SSDEEP_SPAMSUM_LENGTH / 2)
+    index--;
+
+  char* p = out;
+  itoaDec((long long)SsdeepBlockSize(index), p, 24);
+  p += strLen(p);
+  *p++ = ':';
+
+  const BlockHash& hash = hashes[index];
+  memCopy(p, hash.digest, hash.index);
+  p += hash.index;
+  if (sum != 0)
+    *p++ = g_Base64[hash.h];
+  else if (hash.digest[hash.index] != '\0')
+    *p++ = hash.digest[hash.index];
+  *p++ = ':';
+
+  if (index < last - 1)
+  {
+    const BlockHash& next = hashes[index + 1];
+    uint32_t count = next.index < SSDEEP_SPAMSUM_LENGTH / 2 - 1 ? next.index : SSDEEP_SPAMSUM_LENGTH / 2 - 1;
+    memCopy(p, next.digest, count);
+    p += count;
+    if (sum != 0)
+      *p++ = g_Base64[next.halfH];
+    else if (next.halfDigest != '\0')
+      *p++ = next.halfDigest;
+  }
+  else if (sum != 0)
+  {
+    *p++ = g_Base64[hash.h];
+  }
+  *p = '\0';
+  return true;
+}
+
+struct SsdeepParsed
+{
+  uint64_t blockSize;
+  char first[SSDEEP_SPAMSUM_LENGTH];
+  char second[SSDEEP_SPAMSUM_LENGTH];
+  uint32_t firstLength;
+  uint32_t secondLength;
+};
+
+// Copies one digest half, dropping any run of a character past its third
+// repeat the same way ssdeep does before scoring.
+static const char* SsdeepParsePart(const char* p, char* out, uint32_t* outLength, bool last)
+{
+  uint32_t length = 0;
+  while (*p && *p != ':' && !(last && (*p == ',' || *p == ' ' || *p == '\t' || *p == '"')))
+  {
+    if (length >= SSDEEP_SPAMSUM_LENGTH)
+      return nullptr;
+    if (length < 3 || *p != out[length - 1] || *p != out[length - 2] || *p != out[length - 3])
+      out[length++] = *p;
+    p++;
+  }
+  *outLength = length;
+  return p;
+}
+
+static bool SsdeepParse(const char* text, SsdeepParsed* out)
+{
+  const char* p = text;
+  uint64_t blockSize = 0;
+  while (*p >= '0' && *p <= '9')
+  {
+    if (blockSize > (SsdeepBlockSize(SSDEEP_NUM_BLOCKHASHES - 1) << 1))
+      return false;
+    blockSize = blockSize * 10 + (uint64_t)(*p++ - '0');
+  }
+  if (blockSize == 0 || *p++ != ':')
+    return false;
+
+  p = SsdeepParsePart(p, out->first, &out->firstLength, false);
+  if (!p || *p++ != ':')
+    return false;
+  p = SsdeepParsePart(p, out->second, &out->secondLength, true);
+  if (!p)
+    return false;
+
+  out->blockSize = blockSize;
+  return true;
+}
+
+static bool SsdeepCommonSubstring(const char* a, uint32_t aLength, const char* b, uint32_t bLength)
+{
+  for (uint32_t i = 0; i + SSDEEP_ROLLING_WINDOW <= aLength; i++)
+  {
+    for (uint32_t j = 0; j + SSDEEP_ROLLING_WINDOW <= bLength; j++)
+    {
+      uint32_t k = 0;
+      while (k < SSDEEP_ROLLING_WINDOW && a[i + k] == b[j + k])
+        k++;
+      if (k == SSDEEP_ROLLING_WINDOW)
+        return true;
+    }
+  }
+  return false;
+}
+
+// Levenshtein distance where a substitution costs as much as a removal plus
+// an insertion, as in ssdeep's edit_distn.
+static uint32_t SsdeepEditDistance(const char* a, uint32_t aLength, const char* b, uint32_t bLength)
+{
+  uint32_t rows[2][SSDEEP_SPAMSUM_LENGTH + 1];
+  uint32_t* previous = rows[0];
+  uint32_t* current = rows[1];
+
+  for (uint32_t j = 0; j <= bLength; j++)
+    previous[j] = j;
+
+  for (uint32_t i = 0; i < aLength; i++)
+  {
+    current[0] = i + 1;
+    for (uint32_t j = 0; j < bLength; j++)
+    {
+      uint32_t cost = previous[j] + (a[i] == b[j] ? 0 : 2);
+      if (previous[j + 1] + 1 < cost)
+        cost = previous[j + 1] + 1;
+      if (current[j] + 1 < cost)
+        cost = current[j] + 1;
+      current[j + 1] = cost;
+    }
+    uint32_t* swap = previous;
+    previous = current;
+    current = swap;
+  }
+  return previous[bLength];
+}
+
+static int SsdeepScoreStrings(const char* a, uint32_t aLength, const char* b, uint32_t bLength, uint64_t blockSize)
+{
+  if (aLength < SSDEEP_ROLLING_WINDOW || bLength < SSDEEP_ROLLING_WINDOW)
+    return 0;
+  if (!SsdeepCommonSubstring(a, aLength, b, bLength))
+    return 0;
+
+  uint32_t score = SsdeepEditDistance(a, aLength, b, bLength);
+  score = score * SSDEEP_SPAMSUM_LENGTH / (aLength + bLength);
+  score = 100 * score / SSDEEP_SPAMSUM_LENGTH;
+  score = 100 - score;
+
+  if (blockSize >= (99 + SSDEEP_ROLLING_WINDOW) / SSDEEP_ROLLING_WINDOW * SSDEEP_MIN_BLOCKSIZE)
+    return (int)score;
+
+  uint64_t cap = blockSize / SSDEEP_MIN_BLOCKSIZE * (aLength < bLength ? aLength : bLength);
+  return (int)(score > cap ? cap : score);
+}
+
+static bool SsdeepSamePart(const char* a, uint32_t aLength, const char* b, uint32_t bLength)
+{
+  if (aLength != bLength)
+    return false;
+  for (uint32_t i = 0; i < aLength; i++)
+  {
+    if (a[i] != b[i])
+      return false;
+  }
+  return true;
+}
+
+static int SsdeepCompareParsed(const SsdeepParsed& a, const SsdeepParsed& b)
+{
+  if (a.blockSize != b.blockSize && a.blockSize * 2 != b.blockSize && b.blockSize * 2 != a.blockSize)
+    return 0;
+
+  if (a.blockSize == b.blockSize &&
+      SsdeepSamePart(a.first, a.firstLength, b.first, b.firstLength) &&
+      SsdeepSamePart(a.second, a.secondLength, b.second, b.secondLength))
+    return 100;
+
+  if (a.blockSize == b.blockSize)
+  {
+    int firstScore = SsdeepScoreStrings(a.first, a.firstLength, b.first, b.firstLength, a.blockSize);
+    int secondScore = SsdeepScoreStrings(a.second, a.secondLength, b.second, b.secondLength, a.blockSize * 2);
+    return firstScore > secondScore ? firstScore : secondScore;
+  }
+  if (a.blockSize * 2 == b.blockSize)
+    return SsdeepScoreStrings(b.first, b.firstLength, a.second, a.secondLength, b.blockSize);
+  return SsdeepScoreStrings(a.first, a.firstLength, b.second, b.secondLength, a.blockSize);
+}
+
+int SsdeepCompare(const char* a, const char* b)
+{
+  SsdeepParsed left;
+  SsdeepParsed right;
+  if (!a || !b || !SsdeepParse(a, &left) || !SsdeepParse(b, &right))
+    return -1;
+  return SsdeepCompareParsed(left, right);
+}
+
+// The first Pearson step only ever sees the salt, so callers pass the
+// already mapped salt and three lookups remain.
+static inline uint8_t TlshMap(uint8_t salt, uint8_t i, uint8_t j, uint8_t k)
+{
+  return g_TlshTable[g_TlshTable[g_TlshTable[salt ^ i] ^ j] ^ k];
+}
+
+static inline uint8_t TlshSwapNibbles(uint8_t value)
+{
+  return (uint8_t)((value >> 4) | (value << 4));
+}
+
+static uint8_t TlshLengthCode(uint64_t length)
+{
+  size_t low = 0;
+  size_t high = sizeof(g_TlshLengthTops) / sizeof(g_TlshLengthTops[0]);
+  while (low < high)
+  {
+    size_t middle = (low + high) / 2;
+    if (g_TlshLengthTops[middle] < length)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return (uint8_t)low;
+}
+
+TlshHasher::TlshHasher()
+{
+  reset();
+}
+
+void TlshHasher::reset()
+{
+  memSet(buckets, 0, sizeof(buckets));
+  memSet(window, 0, sizeof(window));
+  length = 0;
+  checksum = 0;
+}
+
+void TlshHasher::update(const uint8_t* data, size_t count)
+{
+  uint8_t w1 = window[0];
+  uint8_t w2 = window[1];
+  uint8_t w3 = window[2];
+  uint8_t w4 = window[3];
+  size_t n = 0;
+
+  for (; n < count && length + n < 4; n++)
+  {
+    w4 = w3;
+    w3 = w2;
+    w2 = w1;
+    w1 = data[n];
+  }
+
+  for (; n < count; n++)
+  {
+    uint8_t c = data[n];
+    checksum = TlshMap(1, c, w1, checksum);
+    buckets[TlshMap(49, c, w1, w2)]++;
+    buckets[TlshMap(12, c, w1, w3)]++;
+    buckets[TlshMap(178, c, w2, w3)]++;
+    buckets[TlshMap(166, c, w2, w4)]++;
+    buckets[TlshMap(84, c, w1, w4)]++;
+    buckets[TlshMap(230, c, w3, w4)]++;
+    w4 = w3;
+    w3 = w2;
+    w2 = w1;
+    w1 = c;
+  }
+
+  window[0] = w1;
+  window[1] = w2;
+  window[2] = w3;
+  window[3] = w4;
+  length += count;
+}
+
+bool TlshHasher::digest(char* out, size_t max) const
+{
+  if (!out || max < TLSH_MAX_RESULT || length < TLSH_MIN_LENGTH)
+    return false;
+
+  uint64_t sorted[TLSH_EFF_BUCKETS];
+  int nonZero = 0;
+  for (int i = 0; i < TLSH_EFF_BUCKETS; i++)
+  {
+    uint64_t value = buckets[i];
+    if (value > 0)
+      nonZero++;
+
+    int j = i;
+    while (j > 0 && sorted[j - 1] > value)
+    {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+
+  uint64_t q1 = sorted[TLSH_EFF_BUCKETS / 4 - 1];
+  uint64_t q2 = sorted[TLSH_EFF_BUCKETS / 2 - 1];
+  uint64_t q3 = sorted[TLSH_EFF_BUCKETS * 3 / 4 - 1];
+  if (q3 == 0 || nonZero <= TLSH_EFF_BUCKETS / 2)
+    return false;
+
+  uint8_t bytes[TLSH_CODE_SIZE + 3];
+  bytes[0] = TlshSwapNibbles(checksum);
+  bytes[1] = TlshSwapNibbles(TlshLengthCode(length));
+  uint32_t q1Ratio = (uint32_t)((float)(q1 * 100) / (float)q3) % 16;
+  uint32_t q2Ratio = (uint32_t)((float)(q2 * 100) / (float)q3) % 16;
+  bytes[2] = (uint8_t)((q1Ratio << 4) | q2Ratio);
+
+  for (int i = 0; i < TLSH_CODE_SIZE; i++)
+  {
+    uint8_t code = 0;
+    for (int j = 0; j < 4; j++)
+    {
+      uint64_t value = buckets[4 * i + j];
+      if (value > q3)
+        code |= (uint8_t)(3 << (j * 2));
+      else if (value > q2)
+        code |= (uint8_t)(2 << (j * 2));
+      else if (value > q1)
+        code |= (uint8_t)(1 << (j * 2));
+    }
+    bytes[3 + TLSH_CODE_SIZE - 1 - i] = code;
+  }
+
+  char* p = out;
+  *p++ = 'T';
+  *p++ = '1';
+  for (size_t i = 0; i < sizeof(bytes); i++)
+  {
+    *p++ = g_HexDigitsUpper[bytes[i] >> 4];
+    *p++ = g_HexDigitsUpper[bytes[i] & 15];
+  }
+  *p = '\0';
+  return true;
+}
+
+struct TlshParsed
+{
+  uint8_t checksum;
+  uint8_t lengthCode;
+  uint8_t q1Ratio;
+  uint8_t q2Ratio;
+  uint8_t code[TLSH_CODE_SIZE];
+};
+
+static bool TlshParse(const char* text, TlshParsed* out)
+{
+  if ((text[0] == 'T' || text[0] == 't') && text[1] == '1')
+    text += 2;
+
+  uint8_t bytes[TLSH_CODE_SIZE + 3];
+  for (size_t i = 0; i < sizeof(bytes); i++)
+  {
+    if (!isXDigit(text[2 * i]) || !isXDigit(text[2 * i + 1]))
+      return false;
+    bytes[i] = (uint8_t)((hexDigitToInt(text[2 * i]) << 4) | hexDigitToInt(text[2 * i + 1]));
+  }
+  if (isXDigit(text[2 * sizeof(bytes)]))
+    return false;
+
+  out->checksum = TlshSwapNibbles(bytes[0]);
+  out->lengthCode = TlshSwapNibbles(bytes[1]);
+  out->q1Ratio = bytes[2] >> 4;
+  out->q2Ratio = bytes[2] & 15;
+  for (int i = 0; i < TLSH_CODE_SIZE; i++)
+    out->code[i] = bytes[3 + TLSH_CODE_SIZE - 1 - i];
+  return true;
+}
+
+static int TlshModDiff(int x, int y, int range)
+{
+  int left = y > x ? y - x : x - y;
+  int right = range - left;
+  return left < right ? left : right;
+}
+
+static int TlshDistanceParsed(const TlshParsed& a, const TlshParsed& b)
+{
+  int distance = 0;
+
+  int lengthDiff = TlshModDiff(a.lengthCode, b.lengthCode, 256);
+  distance += lengthDiff <= 1 ? lengthDiff : lengthDiff * 12;
+
+  int q1Diff = TlshModDiff(a.q1Ratio, b.q1Ratio, 16);
+  distance += q1Diff <= 1 ? q1Diff : (q1Diff - 1) * 12;
+  int q2Diff = TlshModDiff(a.q2Ratio, b.q2Ratio, 16);
+  distance += q2Diff <= 1 ? q2Diff : (q2Diff - 1) * 12;
+
+  if (a.checksum != b.checksum)
+    distance++;
+
+  for (int i = 0; i < TLSH_CODE_SIZE; i++)
+  {
+    for (int j = 0; j < 4; j++)
+    {
+      int x = (a.code[i] >> (j * 2)) & 3;
+      int y = (b.code[i] >> (j * 2)) & 3;
+      int diff = x > y ? x - y : y - x;
+      distance += diff == 3 ? 6 : diff;
+    }
+  }
+  return distance;
+}
+
+int TlshDistance(const char* a, const char* b)
+{
+  TlshParsed left;
+  TlshParsed right;
+  if (!a || !b || !TlshParse(a, &left) || !TlshParse(b, &right))
+    return -1;
+  return TlshDistanceParsed(left, right);
+}
+
+static bool FuzzyBetter(const FuzzyMatch& a, const FuzzyMatch& b)
+{
+  if ((a.ssdeepScore >= 0) != (b.ssdeepScore >= 0))
+    return a.ssdeepScore >= 0;
+  if (a.ssdeepScore >= 0)
+    return a.ssdeepScore > b.ssdeepScore;
+  return a.tlshDistance < b.tlshDistance;
+}
+
+static void FuzzyInsertMatch(Vector<FuzzyMatch>* matches, const FuzzyMatch& match)
+{
+  size_t position = 0;
+  size_t sameKind = 0;
+  size_t lastSameKind = 0;
+  for (size_t i = 0; i < matches->size(); i++)
+  {
+    if (FuzzyBetter((*matches)[i], match))
+      position = i + 1;
+    if (((*matches)[i].ssdeepScore >= 0) == (match.ssdeepScore >= 0))
+    {
+      sameKind++;
+      lastSameKind = i;
+    }
+  }
+
+  if (sameKind >= FUZZY_MAX_MATCHES)
+  {
+    if (position > lastSameKind)
+      return;
+    matches->remove(lastSameKind);
+  }
+  matches->insert(position, match);
+}
+
+size_t FuzzyMatchDigestList(const char* text, size_t length, const FuzzyDigests& digests, Vector<FuzzyMatch>* outMatches)
+{
+  outMatches->clear();
+
+  SsdeepParsed ownSsdeep;
+  TlshParsed ownTlsh;
+  bool haveSsdeep = digests.ssdeep[0] && SsdeepParse(digests.ssdeep, &ownSsdeep);
+  bool haveTlsh = digests.tlsh[0] && TlshParse(digests.tlsh, &ownTlsh);
+  if (!haveSsdeep && !haveTlsh)
+    return 0;
+
+  size_t scanned = 0;
+  size_t position = 0;
+  while (position < length)
+  {
+    size_t end = position;
+    while (end < length && text[end] != '\n')
+      end++;
+
+    char line[512];
+    size_t lineLength = end - position;
+    if (lineLength > sizeof(line) - 1)
+      lineLength = sizeof(line) - 1;
+    memCopy(line, text + position, lineLength);
+    line[lineLength] = '\0';
+    position = end + 1;
+
+    while (lineLength > 0 && (line[lineLength - 1] == '\r' || line[lineLength - 1] == ' '))
+      line[--lineLength] = '\0';
+
+    size_t tokenEnd = 0;
+    while (line[tokenEnd] && line[tokenEnd] != ',' && line[tokenEnd] != '\t' && line[tokenEnd] != ' ')
+      tokenEnd++;
+
+    FuzzyMatch match;
+    match.ssdeepScore = -1;
+    match.tlshDistance = -1;
+
+    SsdeepParsed otherSsdeep;
+    TlshParsed otherTlsh;
+    if (SsdeepParse(line, &otherSsdeep))
+    {
+      if (!haveSsdeep)
+        continue;
+      match.ssdeepScore = SsdeepCompareParsed(ownSsdeep, otherSsdeep);
+    }
+    else if (TlshParse(line, &otherTlsh))
+    {
+      if (!haveTlsh)
+        continue;
+      match.tlshDistance = TlshDistanceParsed(ownTlsh, otherTlsh);
+    }
+    else
+    {
+      continue;
+    }
+    scanned++;
+
+    if (match.ssdeepScore <= 0 && (match.tlshDistance < 0 || match.tlshDistance > TLSH_MATCH_DISTANCE))
+      continue;
+
+    const char* name = line + tokenEnd;
+    while (*name == ',' || *name == '\t' || *name == ' ' || *name == '"')
+      name++;
+    stringCopy(match.name, name, FUZZY_NAME_LEN);
+    size_t nameLength = strLen(match.name);
+    if (nameLength > 0 && match.name[nameLength - 1] == '"')
+      match.name[nameLength - 1] = '\0';
+    if (!match.name[0])
+      stringCopy(match.name, line, (int)(tokenEnd + 1 < FUZZY_NAME_LEN ? tokenEnd + 1 : FUZZY_NAME_LEN));
+
+    FuzzyInsertMatch(outMatches, match);
+  }
+  return scanned;
+}
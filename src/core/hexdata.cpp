@@ -97,6 +97,16 @@ static bool read_file_all(const char *path, ByteBuffer *outBuffer)
 #endif
 }
 
+static size_t read_template_bytes(void* context, uint64_t offset, uint8_t* out, size_t length)
+{
+    return ((const HexData*)context)->readBytes((size_t)offset, out, length);
+}
+
+static size_t read_transform_bytes(void* context, uint64_t offset, uint8_t* out, size_t length)
+{
+    return ((const HexData*)context)->readBytes((size_t)offset, out, length);
+}
+
 static bool write_file_all(const char *path, const uint8_t *data, size_t size)
 {
 #ifdef _WIN32
@@ -152,20 +162,26 @@ static int clamp_int(int v, int lo, int hi)
 }
 
 HexData::HexData()
-  : currentBytesPerLine(16),
+  : isProcessMemory(false),
+  pluginCount(0),
+  usePlugins(false),
+  usePlugin(false),
+  currentBytesPerLine(16),
   modified(false),
-  isProcessMemory(false),
   capstoneInitialized(false),
   currentArch(0),
   currentMode(0),
   csHandle(0),
-  usePlugin(false),
-  pluginCount(0),      
-  usePlugins(false)    
+  transform(nullptr),
+  contentHash(0),
+  contentHashValid(false),
+  pendingCacheWrites(0),
+  processSource(nullptr),
+  memoryWatch(nullptr),
+  offsetDigits(8)
 {
   bb_init(&fileData);
   la_init(&hexLines);
-  la_init(&disassemblyLines);
   ss_init(&headerLine);
   pluginPath[0] = '\0';
   pba_init(&pluginAnnotations);
@@ -178,10 +194,10 @@ HexData::HexData()
 
 HexData::~HexData()
 {
+    PluginCache_Flush();
     clear();
     bb_free(&fileData);
     la_free(&hexLines);
-    la_free(&disassemblyLines);
     ss_free(&headerLine);
     pba_free(&pluginAnnotations);
 }
@@ -208,7 +224,7 @@ void HexData::addPlugin(const char* path)
   pluginCount++;
   usePlugins = true;
 
-  if (!bb_empty(&fileData))
+  if (!isEmpty())
   {
     convertDataToHex(currentBytesPerLine);
   }
@@ -224,7 +240,7 @@ void HexData::clearAllPlugins()
     pluginPaths[i][0] = '\0';
   }
 
-  if (!bb_empty(&fileData))
+  if (!isEmpty())
   {
     convertDataToHex(currentBytesPerLine);
   }
@@ -276,30 +292,12 @@ bool HexData::hasDisassemblyPlugin() const
 
 void HexData::generateDisassemblyFromPlugin(int bytesPerLine)
 {
-  la_clear(&disassemblyLines);
-
-  if (!hasPlugins())
-    return;
-
-  size_t numLines = (fileData.size + bytesPerLine - 1) / bytesPerLine;
-  for (size_t i = 0; i < numLines; i++)
-  {
-    SimpleString line;
-    ss_init(&line);
-    la_push_back(&disassemblyLines, &line);
-    ss_free(&line);
-  }
+  disasmCache.reset(bytesPerLine);
 }
 
 void HexData::generateDisassembly(int bytesPerLine)
 {
-    if (usePlugin)
-    {
-        generateDisassemblyFromPlugin(bytesPerLine);
-        return;
-    }
-
-    la_clear(&disassemblyLines);
+    disasmCache.reset(bytesPerLine);
 }
 
 bool HexData::initializeCapstone()
@@ -311,20 +309,148 @@ void HexData::cleanupCapstone()
 {
 }
 
-void HexData::setArchitecture(int /*arch*/, int /*mode*/)
+// The built-in decoder only knows x86, so arch is recorded for plugins and
+// mode is the code width in bits (16, 32 or 64); 0 follows the loaded image.
+void HexData::setArchitecture(int arch, int mode)
 {
+  if (arch == currentArch && mode == currentMode)
+    return;
+  currentArch = arch;
+  currentMode = mode;
+  disasmCache.clear();
 }
 
-void HexData::disassembleInstruction(size_t /*offset*/,
+X86Mode HexData::getDisassemblyMode() const
+{
+  if (currentMode == X86_MODE_16 || currentMode == X86_MODE_32 || currentMode == X86_MODE_64)
+    return (X86Mode)currentMode;
+  if (!processSource && !isProcessMemory && structure.isOpenOn(fileData.data, fileData.size) && !structure.is64Bit())
+    return X86_MODE_32;
+  return X86_MODE_64;
+}
+
+uint64_t HexData::disassemblyAddress(size_t offset) const
+{
+  uint64_t address = offset;
+  if (offsetToVirtualAddress(offset, &address))
+    return address;
+  if (!processSource && !isProcessMemory && structure.isOpenOn(fileData.data, fileData.size) &&
+      structure.offsetToVirtualAddress(offset, &address))
+    return address;
+  return offset;
+}
+
+void HexData::disassembleInstruction(size_t offset,
                                      int &instructionLength,
                                      SimpleString &outInstr)
 {
     ss_clear(&outInstr);
     instructionLength = 1;
+
+    uint8_t code[X86_MAX_INSTRUCTION];
+    size_t available = readBytes(offset, code, sizeof(code));
+    if (available == 0)
+        return;
+
+    X86Mode mode = getDisassemblyMode();
+    X86Instruction instruction;
+    char text[X86_TEXT_LEN];
+    if (X86Decode(code, available, disassemblyAddress(offset), mode, &instruction))
+    {
+        X86Format(instruction, mode, text, sizeof(text));
+        instructionLength = instruction.length;
+    }
+    else
+    {
+        strCopy(text, "db 0x");
+        itoaHex(code[0], text + 5, (int)sizeof(text) - 5);
+    }
+    ss_append_cstr(&outInstr, text);
+}
+
+static bool is_same_file(const char* a, const char* b)
+{
+  if (!a || !b || !a[0] || !b[0])
+    return false;
+
+#ifdef _WIN32
+  char fullA[MAX_PATH];
+  char fullB[MAX_PATH];
+  if (!GetFullPathNameA(a, MAX_PATH, fullA, NULL) || !GetFullPathNameA(b, MAX_PATH, fullB, NULL))
+    return strEquals(a, b);
+  return lstrcmpiA(fullA, fullB) == 0;
+#else
+  struct stat stA;
+  struct stat stB;
+  if (stat(a, &stA) != 0 || stat(b, &stB) != 0)
+    return strEquals(a, b);
+  return stA.st_dev == stB.st_dev && stA.st_ino == stB.st_ino;
+#endif
+}
+
+static bool write_source_all(const char* path, ProcessMemorySource* source)
+{
+  const size_t chunkSize = PROCESS_SNAPSHOT_BATCH_BYTES * 4;
+  uint8_t* chunk = (uint8_t*)platformAlloc(chunkSize);
+  if (!chunk)
+    return false;
+
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  bool ok = hFile != INVALID_HANDLE_VALUE;
+#else
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  bool ok = fd >= 0;
+#endif
+
+  for (uint64_t offset = 0; ok && offset < source->getSize(); offset += chunkSize)
+  {
+    size_t length = source->read(offset, chunk, chunkSize);
+    if (length == 0)
+    {
+      ok = false;
+      break;
+    }
+
+#ifdef _WIN32
+    DWORD written = 0;
+    ok = WriteFile(hFile, chunk, (DWORD)length, &written, NULL) && written == length;
+#else
+    size_t totalWritten = 0;
+    while (ok && totalWritten < length)
+    {
+      ssize_t w = write(fd, chunk + totalWritten, length - totalWritten);
+      if (w <= 0)
+        ok = false;
+      else
+        totalWritten += (size_t)w;
+    }
+#endif
+  }
+
+#ifdef _WIN32
+  if (hFile != INVALID_HANDLE_VALUE)
+    CloseHandle(hFile);
+#else
+  if (fd >= 0)
+    close(fd);
+#endif
+
+  platformFree(chunk, chunkSize);
+  return ok;
 }
 
 bool HexData::loadFile(const char* filepath)
 {
+  stopMemoryWatch();
+  blockStats.stop();
+  valueScanner.reset();
+  delete processSource;
+  processSource = nullptr;
+
+  if (attachDump(filepath))
+    return true;
+
   if (!read_file_all(filepath, &fileData))
   {
     la_clear(&hexLines);
@@ -336,15 +462,457 @@ bool HexData::loadFile(const char* filepath)
   clearPluginAnnotations();
   clearMemoryMap();
   isProcessMemory = false;
+  contentHashValid = false;
+  byteMap.clear();
+  strings.clear();
+  blockStats.start(fileData.data, fileData.size);
+  structure.open(fileData.data, fileData.size);
+  bindTemplate();
 
   convertDataToHex(16);
   modified = false;
   return true;
 }
 
+bool HexData::attachProcess(int pid, const Vector<MemoryRegion>& regions)
+{
+  clear();
+
+  processSource = new ProcessMemorySource();
+  if (!processSource->attach(pid, regions))
+  {
+    delete processSource;
+    processSource = nullptr;
+    return false;
+  }
+
+  setMemoryMap(processSource->getRegions());
+  convertDataToHex(16);
+  bindTemplate();
+  return true;
+}
+
+bool HexData::attachDump(const char* filepath)
+{
+  ProcessMemorySource* source = new ProcessMemorySource();
+  if (!source->attachDump(filepath))
+  {
+    delete source;
+    return false;
+  }
+
+  clear();
+  processSource = source;
+  setMemoryMap(processSource->getRegions());
+  convertDataToHex(16);
+  bindTemplate();
+  return true;
+}
+
+bool HexData::commitProcessEdits(Vector<ProcessWriteFailure>* failures)
+{
+  if (!processSource || !processSource->canCommitEdits())
+    return false;
+
+  bool complete = processSource->commitEdits(failures);
+  modified = !processSource->getEdits().empty();
+  contentHashValid = false;
+  return complete;
+}
+
+bool HexData::startMemoryWatch(uint32_t intervalMs)
+{
+  if (!processSource)
+    return false;
+
+  if (!memoryWatch)
+    memoryWatch = new MemoryWatch();
+
+  return memoryWatch->start(processSource->getPid(), processSource->getRegions(), intervalMs);
+}
+
+void HexData::stopMemoryWatch()
+{
+  delete memoryWatch;
+  memoryWatch = nullptr;
+}
+
+bool HexData::pollMemoryWatch()
+{
+  if (!memoryWatch || !processSource || !memoryWatch->poll())
+    return false;
+
+  processSource->invalidate();
+  if (transform)
+    transform->invalidate();
+  contentHashValid = false;
+  templateEngine.refreshValues();
+  return true;
+}
+
+void HexData::getScanTarget(ScanTarget* outTarget)
+{
+  outTarget->data = processSource ? nullptr : fileData.data;
+  outTarget->size = getFileSize();
+  outTarget->process = processSource;
+  outTarget->writableOnly = true;
+}
+
+bool HexData::carveEmbeddedFiles(Vector<CarveResult>* outResults) const
+{
+  if (processSource || !fileData.data)
+    return false;
+  return CarveBuffer(fileData.data, fileData.size, outResults);
+}
+
+StructureDecoder* HexData::getStructure()
+{
+  if (processSource || isProcessMemory || !structure.isOpenOn(fileData.data, fileData.size))
+    return nullptr;
+  return &structure;
+}
+
+bool HexData::loadTemplate(const char* path, char* outError, size_t errorMax)
+{
+  ByteBuffer text;
+  bb_init(&text);
+  if (!read_file_all(path, &text))
+  {
+    stringCopy(outError, "Failed to read template file", (int)errorMax);
+    bb_free(&text);
+    return false;
+  }
+
+  const char* name = path;
+  for (const char* p = path; *p; p++)
+  {
+    if (*p == '/' || *p == '\\')
+      name = p + 1;
+  }
+
+  bool loaded = templateEngine.load(name, (const char*)text.data, text.size, outError, errorMax);
+  bb_free(&text);
+  if (loaded)
+    bindTemplate();
+  return loaded;
+}
+
+void HexData::clearTemplate()
+{
+  templateEngine.unload();
+}
+
+TemplateEngine* HexData::getTemplate()
+{
+  if (!templateEngine.isLoaded() || templateEngine.getNodeCount() == 0)
+    return nullptr;
+  return &templateEngine;
+}
+
+bool HexData::extractStrings(uint32_t minLength)
+{
+  if (processSource || !fileData.data)
+    return false;
+  return strings.build(fileData.data, fileData.size, minLength);
+}
+
+StringIndex* HexData::getStrings()
+{
+  if (processSource || !strings.isBuiltOn(fileData.data, fileData.size))
+    return nullptr;
+  return &strings;
+}
+
+bool HexData::buildByteMap(uint64_t start, uint64_t length)
+{
+  if (processSource || !fileData.data)
+    return false;
+  return byteMap.build(fileData.data, fileData.size, start, length);
+}
+
+ByteMap* HexData::getByteMap()
+{
+  if (processSource || !byteMap.isBuiltOn(fileData.data, fileData.size))
+    return nullptr;
+  return &byteMap;
+}
+
+BlockStatsIndex* HexData::getBlockStats()
+{
+  if (processSource || !blockStats.isBuiltOn(fileData.data, fileData.size))
+    return nullptr;
+  return blockStats.poll() ? &blockStats : nullptr;
+}
+
+bool HexData::getRangeStats(uint64_t start, uint64_t length, ByteRangeStats* outStats, uint64_t maxScanBytes)
+{
+  uint64_t fileSize = getFileSize();
+  if (start > fileSize || length > fileSize - start)
+    return false;
+
+  BlockStatsIndex* index = getBlockStats();
+  if (index && index->query(start, length, outStats))
+    return true;
+  if (length > maxScanBytes)
+    return false;
+
+  ByteRangeStats_Clear(outStats);
+  if (!processSource)
+  {
+    ByteRangeStats_Count(outStats, fileData.data + start, (size_t)length);
+    return true;
+  }
+
+  uint8_t* chunk = (uint8_t*)platformAlloc(BLOCKSTATS_SCAN_CHUNK);
+  if (!chunk)
+    return false;
+  for (uint64_t done = 0; done < length; )
+  {
+    size_t count = length - done < BLOCKSTATS_SCAN_CHUNK ? (size_t)(length - done) : BLOCKSTATS_SCAN_CHUNK;
+    size_t got = processSource->read(start + done, chunk, count);
+    if (got < count)
+      memSet(chunk + got, 0, count - got);
+    ByteRangeStats_Count(outStats, chunk, count);
+    done += count;
+  }
+  platformFree(chunk, BLOCKSTATS_SCAN_CHUNK);
+  return true;
+}
+
+bool HexData::addTransformStep(const TransformStep& step, uint64_t start, uint64_t length, char* outError, size_t errorMax)
+{
+  if (transform && (transform->getStart() != start || transform->getInputLength() != length))
+    discardTransform();
+
+  if (!transform)
+  {
+    if (length == 0 || start + length > getFileSize())
+    {
+      stringCopy(outError, "Transform range is outside the data", (int)errorMax);
+      return false;
+    }
+    transform = new TransformPipeline(read_transform_bytes, this, start, length);
+  }
+
+  if (!transform->addStep(step, outError, errorMax))
+  {
+    if (transform->getStepCount() == 0)
+      discardTransform();
+    return false;
+  }
+  return true;
+}
+
+void HexData::discardTransform()
+{
+  delete transform;
+  transform = nullptr;
+}
+
+bool HexData::commitTransform(char* outError, size_t errorMax)
+{
+  if (!transform || transform->getStepCount() == 0)
+  {
+    stringCopy(outError, "No transform to commit", (int)errorMax);
+    return false;
+  }
+
+  uint64_t start = transform->getStart();
+  uint64_t inputLength = transform->getInputLength();
+  uint64_t outputLength = transform->getOutputLength();
+  bool inPlace = transform->isInPlace() && outputLength == inputLength;
+
+  if (!inPlace && processSource)
+  {
+    stringCopy(outError, "Transforms that change the length need a file view", (int)errorMax);
+    return false;
+  }
+  if (processSource && inputLength > TRANSFORM_MAX_PROCESS_BYTES)
+  {
+    stringCopy(outError, "Transform range is too large for a memory view", (int)errorMax);
+    return false;
+  }
+
+  if (!processSource)
+    blockStats.stop();
+
+  bool ok = true;
+  bool written = false;
+  if (inPlace)
+  {
+    uint8_t* block = (uint8_t*)platformAlloc(TRANSFORM_BLOCK_SIZE);
+    if (!block)
+    {
+      stringCopy(outError, "Out of memory", (int)errorMax);
+      return false;
+    }
+
+    // Each block is read before anything is written over it, and every step
+    // works within aligned units, so writing back block by block never
+    // feeds already transformed bytes into a later read.
+    for (uint64_t done = 0; ok && done < outputLength; )
+    {
+      size_t count = outputLength - done < TRANSFORM_BLOCK_SIZE ? (size_t)(outputLength - done) : TRANSFORM_BLOCK_SIZE;
+      ok = transform->read(done, block, count, outError, errorMax);
+      for (size_t i = 0; ok && i < count; i++)
+      {
+        if (processSource)
+          ok = processSource->writeByte(start + done + i, block[i]);
+        else
+          fileData.data[start + done + i] = block[i];
+      }
+      if (ok)
+        written = true;
+      done += count;
+    }
+    platformFree(block, TRANSFORM_BLOCK_SIZE);
+  }
+  else
+  {
+    uint64_t suffix = fileData.size - (start + inputLength);
+    ByteBuffer spliced;
+    bb_init(&spliced);
+    ok = bb_resize(&spliced, (size_t)(start + outputLength + suffix));
+    if (!ok)
+      stringCopy(outError, "Out of memory", (int)errorMax);
+
+    if (ok)
+    {
+      memCopy(spliced.data, fileData.data, (size_t)start);
+      for (uint64_t done = 0; ok && done < outputLength; )
+      {
+        size_t count = outputLength - done < TRANSFORM_BLOCK_SIZE ? (size_t)(outputLength - done) : TRANSFORM_BLOCK_SIZE;
+        ok = transform->read(done, spliced.data + start + done, count, outError, errorMax);
+        done += count;
+      }
+      memCopy(spliced.data + start + outputLength, fileData.data + start + inputLength, (size_t)suffix);
+    }
+
+    if (ok)
+    {
+      written = true;
+      bb_free(&fileData);
+      fileData = spliced;
+      structure.open(fileData.data, fileData.size);
+      strings.clear();
+      bindTemplate();
+    }
+    else
+    {
+      bb_free(&spliced);
+    }
+  }
+
+  if (!processSource)
+    blockStats.start(fileData.data, fileData.size);
+  if (!written)
+    return false;
+
+  discardTransform();
+  byteMap.clear();
+  modified = true;
+  contentHashValid = false;
+  templateEngine.refreshValues();
+  regenerateHexLines(currentBytesPerLine);
+  return ok;
+}
+
+bool HexData::computeFuzzyDigests(uint64_t start, uint64_t length, bool ssdeep, bool tlsh, FuzzyDigests* outDigests) const
+{
+  outDigests->ssdeep[0] = '\0';
+  outDigests->tlsh[0] = '\0';
+  if (start > getFileSize() || length > getFileSize() - start)
+    return false;
+
+  uint8_t* block = nullptr;
+  if (processSource)
+  {
+    block = (uint8_t*)platformAlloc(FUZZY_CHUNK_SIZE);
+    if (!block)
+      return false;
+  }
+
+  SsdeepHasher ssdeepHasher;
+  TlshHasher tlshHasher;
+  ssdeepHasher.reset(length);
+
+  // Both digests are fed from the same chunk while it is still in cache, so
+  // the range is read once however large it is.
+  uint64_t done = 0;
+  while (done < length)
+  {
+    size_t count = length - done < FUZZY_CHUNK_SIZE ? (size_t)(length - done) : FUZZY_CHUNK_SIZE;
+    const uint8_t* chunk = fileData.data + start + done;
+    if (processSource)
+    {
+      count = processSource->read(start + done, block, count);
+      if (count == 0)
+        break;
+      chunk = block;
+    }
+
+    if (ssdeep)
+      ssdeepHasher.update(chunk, count);
+    if (tlsh)
+      tlshHasher.update(chunk, count);
+    done += count;
+  }
+  platformFree(block, FUZZY_CHUNK_SIZE);
+
+  // ssdeep picks its block size from the length passed to reset(), so a short
+  // process read cannot produce a valid digest.
+  if (done < length)
+    return false;
+
+  if (ssdeep)
+    ssdeepHasher.digest(outDigests->ssdeep, sizeof(outDigests->ssdeep));
+  if (tlsh)
+    tlshHasher.digest(outDigests->tlsh, sizeof(outDigests->tlsh));
+  return true;
+}
+
+bool HexData::matchDigestList(const char* path, const FuzzyDigests& digests, Vector<FuzzyMatch>* outMatches,
+                              size_t* outScanned, char* outError, size_t errorMax)
+{
+  ByteBuffer text;
+  bb_init(&text);
+  if (!read_file_all(path, &text))
+  {
+    stringCopy(outError, "Failed to read digest list", (int)errorMax);
+    bb_free(&text);
+    return false;
+  }
+
+  *outScanned = FuzzyMatchDigestList((const char*)text.data, text.size, digests, outMatches);
+  bb_free(&text);
+  if (*outScanned == 0)
+  {
+    stringCopy(outError, "No comparable ssdeep or TLSH digests in the list", (int)errorMax);
+    return false;
+  }
+  return true;
+}
+
+void HexData::bindTemplate()
+{
+  if (templateEngine.isLoaded())
+    templateEngine.bind(read_template_bytes, this, getFileSize());
+}
+
 bool HexData::saveFile(const char *filepath)
 {
-    if (!write_file_all(filepath, fileData.data, fileData.size))
+    // A dump view is read through a mapping of the dump itself, and what is
+    // written is the flattened address space, so it must go elsewhere.
+    if (processSource && processSource->isDump() && is_same_file(filepath, processSource->getDumpPath()))
+    {
+        return false;
+    }
+
+    bool written = processSource
+        ? write_source_all(filepath, processSource)
+        : write_file_all(filepath, fileData.data, fileData.size);
+
+    if (!written)
     {
         return false;
     }
@@ -354,37 +922,96 @@ bool HexData::saveFile(const char *filepath)
 
 bool HexData::editByte(size_t offset, uint8_t newValue)
 {
-    if (offset >= fileData.size)
-        return false;
-    fileData.data[offset] = newValue;
+    if (processSource)
+    {
+        if (!processSource->writeByte(offset, newValue))
+            return false;
+    }
+    else
+    {
+        if (offset >= fileData.size)
+            return false;
+        byteMap.noteEdit(offset, newValue);
+        blockStats.noteEdit(offset, newValue);
+        fileData.data[offset] = newValue;
+    }
+    if (transform)
+        transform->invalidate();
     modified = true;
+    contentHashValid = false;
+    templateEngine.refreshValues();
     regenerateHexLines(currentBytesPerLine);
     return true;
 }
 
 uint8_t HexData::getByte(size_t offset) const
 {
+    if (processSource)
+        return processSource->readByte(offset);
     if (offset >= fileData.size)
         return 0;
     return fileData.data[offset];
 }
 
+size_t HexData::readBytes(size_t offset, uint8_t* out, size_t length) const
+{
+    if (processSource)
+        return processSource->read(offset, out, length);
+
+    if (offset >= fileData.size)
+        return 0;
+    if (length > fileData.size - offset)
+        length = fileData.size - offset;
+
+    memCopy(out, fileData.data + offset, length);
+    return length;
+}
+
+// Sampled rather than a full content hash so a project file can be checked
+// against a multi-gigabyte file without reading all of it.
+uint64_t HexData::getContentFingerprint() const
+{
+  uint8_t window[PROJECT_FINGERPRINT_WINDOW];
+  size_t size = getFileSize();
+  uint64_t fingerprint = size;
+  for (int i = 0; i < PROJECT_FINGERPRINT_WINDOWS; i++)
+  {
+    size_t offset = 0;
+    if (size > PROJECT_FINGERPRINT_WINDOW)
+      offset = (size_t)((uint64_t)(size - PROJECT_FINGERPRINT_WINDOW) * i / (PROJECT_FINGERPRINT_WINDOWS - 1));
+    size_t got = readBytes(offset, window, PROJECT_FINGERPRINT_WINDOW);
+    fingerprint = fingerprint * 0x9E3779B97F4A7C15ULL ^ PluginCache_HashContent(window, got);
+  }
+  return fingerprint;
+}
+
 void HexData::clear()
 {
+  stopMemoryWatch();
+  valueScanner.reset();
+  delete processSource;
+  processSource = nullptr;
   bb_resize(&fileData, 0);
   la_clear(&hexLines);
-  la_clear(&disassemblyLines);
   ss_clear(&headerLine);
   clearDisassemblyCache();
   clearMemoryMap();
   clearPluginAnnotations();
+  structure.close();
+  templateEngine.bind(nullptr, nullptr, 0);
+  strings.clear();
+  discardTransform();
+  byteMap.clear();
+  blockStats.stop();
   isProcessMemory = false;
   modified = false;
+  contentHashValid = false;
+  PluginCache_Flush();
 }
 
 void HexData::regenerateHexLines(int bytesPerLine)
 {
-    if (!bb_empty(&fileData))
+    if (!isEmpty())
     {
         convertDataToHex(bytesPerLine);
     }
@@ -392,28 +1019,100 @@ void HexData::regenerateHexLines(int bytesPerLine)
 
 bool HexData::isRangeDisassembled(size_t startOffset, size_t endOffset)
 {
-    if (!hasDisassemblyPlugin())
+    return disasmCache.covers(startOffset, endOffset);
+}
+
+// Linear sweep with the built-in decoder. The sweep starts a little before
+// the first line so it has resynchronised with the instruction stream by the
+// time it reaches it; each line lists the instructions that start in it.
+void HexData::disassembleNative(size_t offset, size_t size)
+{
+  size_t dataSize = getFileSize();
+  size_t bytesPerLine = (size_t)currentBytesPerLine;
+  size_t startLine = offset / bytesPerLine;
+  size_t endLine = (offset + size) / bytesPerLine;
+  if (endLine >= hexLines.count)
+    endLine = hexLines.count - 1;
+  size_t rangeStart = startLine * bytesPerLine;
+  size_t rangeEnd = (endLine + 1) * bytesPerLine;
+  if (rangeEnd > dataSize)
+    rangeEnd = dataSize;
+  if (rangeStart >= rangeEnd)
+    return;
+
+  size_t syncStart = rangeStart > X86_SYNC_WINDOW ? rangeStart - X86_SYNC_WINDOW : 0;
+  size_t readEnd = dataSize - rangeEnd > X86_MAX_INSTRUCTION ? rangeEnd + X86_MAX_INSTRUCTION : dataSize;
+  size_t bufferSize = readEnd - syncStart;
+  uint8_t* buffer = (uint8_t*)platformAlloc(bufferSize);
+  if (!buffer)
+    return;
+  bufferSize = readBytes(syncStart, buffer, bufferSize);
+
+  X86Mode mode = getDisassemblyMode();
+  size_t pos = 0;
+  while (pos < bufferSize && syncStart + pos < rangeStart)
+  {
+    size_t length = X86InstructionLength(buffer + pos, bufferSize - pos, mode);
+    pos += length > 0 ? length : 1;
+  }
+
+  SimpleString line;
+  ss_init(&line);
+  char text[X86_TEXT_LEN];
+  size_t lineIdx = startLine;
+
+  while (pos < bufferSize && syncStart + pos < rangeEnd)
+  {
+    size_t absolute = syncStart + pos;
+    for (; lineIdx < absolute / bytesPerLine; lineIdx++)
     {
-        return true;
+      disasmCache.setLine(lineIdx, line.data);
+      ss_clear(&line);
     }
 
-    for (size_t i = 0; i < disasmRanges.size(); i++)
+    X86Instruction instruction;
+    size_t length = 1;
+    if (X86Decode(buffer + pos, bufferSize - pos, disassemblyAddress(absolute), mode, &instruction))
     {
-        if (disasmRanges[i].valid &&
-            disasmRanges[i].startOffset <= startOffset &&
-            disasmRanges[i].endOffset >= endOffset)
-        {
-            return true;
-        }
+      X86Format(instruction, mode, text, sizeof(text));
+      length = instruction.length;
     }
-    return false;
+    else
+    {
+      strCopy(text, "db 0x");
+      itoaHex(buffer[pos], text + 5, (int)sizeof(text) - 5);
+    }
+
+    if (line.length > 0)
+      ss_append_cstr(&line, "; ");
+    ss_append_cstr(&line, text);
+    pos += length;
+  }
+
+  for (; lineIdx <= endLine; lineIdx++)
+  {
+    disasmCache.setLine(lineIdx, line.data);
+    ss_clear(&line);
+  }
+
+  ss_free(&line);
+  platformFree(buffer, readEnd - syncStart);
 }
 
 void HexData::disassembleRange(size_t offset, size_t size)
 {
-  if (!hasPlugins() || size == 0)
+  if (size == 0 || hexLines.count == 0)
     return;
 
+  disassembleNative(offset, size);
+
+  if (!hasPlugins())
+  {
+    disasmCache.markCovered(offset, offset + size);
+    disasmCache.trim();
+    return;
+  }
+
   extern bool ExecutePythonDisassembly(
     const char* pluginPath,
     const uint8_t * data,
@@ -424,15 +1123,22 @@ void HexData::disassembleRange(size_t offset, size_t size)
   size_t startLine = offset / currentBytesPerLine;
   size_t endLine = (offset + size) / currentBytesPerLine;
 
+  SimpleString cachedText;
+  ss_init(&cachedText);
+
+  uint8_t lineBytes[64];
+  size_t dataSize = getFileSize();
+
   for (size_t lineIdx = startLine; lineIdx <= endLine && lineIdx < hexLines.count; lineIdx++)
   {
     size_t byteOffset = lineIdx * currentBytesPerLine;
 
-    if (byteOffset >= fileData.size)
+    if (byteOffset >= dataSize)
       break;
 
-    size_t remaining = fileData.size - byteOffset;
+    size_t remaining = dataSize - byteOffset;
     size_t chunkSize = remaining < (size_t)currentBytesPerLine ? remaining : (size_t)currentBytesPerLine;
+    bool bytesLoaded = false;
 
     LineArray tempLines;
     la_init(&tempLines);
@@ -440,24 +1146,38 @@ void HexData::disassembleRange(size_t offset, size_t size)
     bool disassembled = false;
     for (int pluginIdx = 0; pluginIdx < pluginCount && !disassembled; pluginIdx++)
     {
+      PluginCacheKey cacheKey;
+      bool cacheable = getPluginCacheKey(pluginPaths[pluginIdx], &cacheKey);
+
+      if (cacheable && PluginCache_GetDisassembly(&cacheKey, byteOffset, chunkSize, &cachedText))
+      {
+        disasmCache.setLine(lineIdx, cachedText.data);
+        disassembled = true;
+        continue;
+      }
+
       if (CanPluginDisassemble(pluginPaths[pluginIdx]))
       {
+        if (!bytesLoaded)
+        {
+          chunkSize = readBytes(byteOffset, lineBytes, chunkSize);
+          bytesLoaded = true;
+        }
+
         if (ExecutePythonDisassembly(
           pluginPaths[pluginIdx],
-          fileData.data + byteOffset,
+          lineBytes,
           chunkSize,
           byteOffset,
           &tempLines))
         {
-          if (lineIdx < disassemblyLines.count)
-          {
-            ss_free(&disassemblyLines.lines[lineIdx]);
-            ss_init(&disassemblyLines.lines[lineIdx]);
+          const char* text = (tempLines.count > 0 && tempLines.lines[0].length > 0) ? tempLines.lines[0].data : "";
+          disasmCache.setLine(lineIdx, text);
 
-            if (tempLines.count > 0 && tempLines.lines[0].length > 0)
-            {
-              ss_append_cstr(&disassemblyLines.lines[lineIdx], tempLines.lines[0].data);
-            }
+          if (cacheable)
+          {
+            PluginCache_PutDisassembly(&cacheKey, byteOffset, chunkSize, text);
+            pendingCacheWrites++;
           }
           disassembled = true;
         }
@@ -467,22 +1187,29 @@ void HexData::disassembleRange(size_t offset, size_t size)
     la_free(&tempLines);
   }
 
-  DisasmCache cache;
-  cache.startOffset = offset;
-  cache.endOffset = offset + size;
-  cache.valid = true;
-  disasmRanges.push_back(cache);
+  ss_free(&cachedText);
+
+  if (pendingCacheWrites >= 256)
+  {
+    PluginCache_Flush();
+    pendingCacheWrites = 0;
+  }
+
+  disasmCache.markCovered(offset, offset + size);
+  disasmCache.trim();
 }
 
 void HexData::clearDisassemblyCache()
 {
-    disasmRanges.clear();
+    disasmCache.clear();
 }
 
 void HexData::generateHeader(int bytesPerLine)
 {
     ss_clear(&headerLine);
-    ss_append_cstr(&headerLine, "Offset    ");
+    ss_append_cstr(&headerLine, memoryMap.empty() ? "Offset" : "Address");
+    for (int i = memoryMap.empty() ? 6 : 7; i < offsetDigits + 2; ++i)
+        ss_append_char(&headerLine, ' ');
     for (int i = 0; i < bytesPerLine; ++i)
     {
         ss_append_dec2(&headerLine, (unsigned int)i);
@@ -496,7 +1223,7 @@ void HexData::convertDataToHex(int bytesPerLine)
 {
   la_clear(&hexLines);
 
-  if (bb_empty(&fileData))
+  if (isEmpty())
   {
     la_push_back_cstr(&hexLines, "No data to display");
     ss_clear(&headerLine);
@@ -506,10 +1233,12 @@ void HexData::convertDataToHex(int bytesPerLine)
   bytesPerLine = clamp_int(bytesPerLine, 8, 48);
   currentBytesPerLine = bytesPerLine;
 
+  updateOffsetDigits();
+
   generateHeader(bytesPerLine);
   generateDisassembly(bytesPerLine);
 
-  size_t lineCount = (fileData.size + bytesPerLine - 1) / bytesPerLine;
+  size_t lineCount = (getFileSize() + bytesPerLine - 1) / bytesPerLine;
 
   hexLines.count = lineCount;
   hexLines.capacity = lineCount;
@@ -521,25 +1250,70 @@ void HexData::convertDataToHex(int bytesPerLine)
   }
 }
 
-void HexData::executeBookmarkPlugins()
+static size_t ReadProcessSourceForPlugin(void* context, uint64_t offset, uint8_t* out, size_t length)
+{
+  return ((ProcessMemorySource*)context)->read(offset, out, length);
+}
+
+struct AnnotationStream
+{
+  PluginBookmarkArray* annotations;
+  PluginBookmarkArray results;
+  size_t merged;
+  PluginProgressCallback progress;
+  void* userData;
+};
+
+static void MergeStreamedAnnotations(AnnotationStream* stream)
+{
+  size_t sortedCount = stream->annotations->count;
+  for (size_t i = stream->merged; i < stream->results.count; i++)
+    pba_push_back(stream->annotations, &stream->results.bookmarks[i]);
+  stream->merged = stream->results.count;
+  pba_merge_tail(stream->annotations, sortedCount);
+}
+
+static bool StreamAnnotationsProgress(void* userData, size_t /*bookmarkCount*/,
+                                      uint64_t bytesProcessed, uint64_t bytesTotal)
+{
+  AnnotationStream* stream = (AnnotationStream*)userData;
+  MergeStreamedAnnotations(stream);
+
+  if (!stream->progress)
+    return true;
+  return stream->progress(stream->userData, stream->annotations->count, bytesProcessed, bytesTotal);
+}
+
+bool HexData::executeBookmarkPlugins(PluginProgressCallback progress, void* userData)
 {
   clearPluginAnnotations();
 
-  if (bb_empty(&fileData) || !hasPlugins())
-    return;
+  if (isEmpty() || !hasPlugins())
+    return true;
 
-  extern bool ExecutePluginBookmarks(
-    const char* pluginPath,
-    const uint8_t * data,
-    size_t dataSize,
-    PluginBookmarkArray * outBookmarks,
-    const Vector<MemoryRegion>*memoryMap);
+  bool cancelled = false;
 
-  for (int i = 0; i < pluginCount; i++)
+  PluginDataView view;
+  view.data = processSource ? nullptr : fileData.data;
+  view.size = getFileSize();
+  view.read = processSource ? ReadProcessSourceForPlugin : nullptr;
+  view.context = processSource;
+
+  for (int i = 0; i < pluginCount && !cancelled; i++)
   {
     if (!CanPluginGenerateBookmarks(pluginPaths[i]))
       continue;
 
+    PluginCacheKey cacheKey;
+    bool cacheable = getPluginCacheKey(pluginPaths[i], &cacheKey);
+
+    size_t sortedCount = pluginAnnotations.count;
+    if (cacheable && PluginCache_GetBookmarks(&cacheKey, &pluginAnnotations))
+    {
+      pba_merge_tail(&pluginAnnotations, sortedCount);
+      continue;
+    }
+
     const Vector<MemoryRegion>* mapPtr = nullptr;
 
     if (isProcessMemory && !memoryMap.empty())
@@ -547,36 +1321,151 @@ void HexData::executeBookmarkPlugins()
       mapPtr = &memoryMap;
     }
 
-    ExecutePluginBookmarks(
+    AnnotationStream stream;
+    stream.annotations = &pluginAnnotations;
+    pba_init(&stream.results);
+    stream.merged = 0;
+    stream.progress = progress;
+    stream.userData = userData;
+
+    bool completed = ExecutePluginBookmarks(
       pluginPaths[i],
-      fileData.data,
-      fileData.size,
-      &pluginAnnotations,
-      mapPtr);
+      &view,
+      &stream.results,
+      mapPtr,
+      StreamAnnotationsProgress,
+      &stream,
+      &cancelled);
+
+    MergeStreamedAnnotations(&stream);
+
+    if (cacheable && completed)
+      PluginCache_PutBookmarks(&cacheKey, stream.results.bookmarks, stream.results.count);
+
+    pba_free(&stream.results);
   }
+
+  PluginCache_Flush();
+  return !cancelled;
+}
+
+const PluginBookmark* HexData::findPluginAnnotation(uint64_t offset) const
+{
+  size_t index = pba_lower_bound(&pluginAnnotations, offset);
+  if (index < pluginAnnotations.count && pluginAnnotations.bookmarks[index].offset == offset)
+    return &pluginAnnotations.bookmarks[index];
+  return nullptr;
+}
+
+bool HexData::getPluginCacheKey(const char* path, PluginCacheKey* outKey)
+{
+  if (modified || processSource || bb_empty(&fileData) || !path || !path[0])
+    return false;
+
+  if (!contentHashValid)
+  {
+    contentHash = PluginCache_HashContent(fileData.data, fileData.size);
+    contentHashValid = true;
+  }
+
+  outKey->contentHash = contentHash;
+  outKey->contentSize = fileData.size;
+  outKey->pluginPath = path;
+  return true;
 }
 
 bool HexData::virtualAddressToOffset(uint64_t virtualAddress, size_t* outOffset) const
 {
-  if (!isProcessMemory || !outOffset)
+  size_t lo = 0;
+  size_t hi = memoryMap.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (memoryMap[mid].virtualAddress + memoryMap[mid].size <= virtualAddress)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo >= memoryMap.size() || virtualAddress < memoryMap[lo].virtualAddress)
     return false;
 
-  for (size_t i = 0; i < memoryMap.size(); i++)
+  *outOffset = memoryMap[lo].bufferOffset + (size_t)(virtualAddress - memoryMap[lo].virtualAddress);
+  return true;
+}
+
+size_t HexData::findMemoryRegionIndex(size_t offset) const
+{
+  size_t lo = 0;
+  size_t hi = memoryMap.size();
+  while (lo < hi)
   {
-    const MemoryRegion& region = memoryMap[i];
+    size_t mid = lo + (hi - lo) / 2;
+    if (memoryMap[mid].bufferOffset + memoryMap[mid].size <= offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
 
-    if (virtualAddress >= region.virtualAddress &&
-      virtualAddress < region.virtualAddress + region.size)
-    {
-      uint64_t offsetInRegion = virtualAddress - region.virtualAddress;
-      *outOffset = region.bufferOffset + offsetInRegion;
-      return true;
-    }
+  if (lo >= memoryMap.size() || offset < memoryMap[lo].bufferOffset)
+    return (size_t)-1;
+  return lo;
+}
+
+const MemoryRegion* HexData::findMemoryRegion(size_t offset) const
+{
+  size_t index = findMemoryRegionIndex(offset);
+  return index == (size_t)-1 ? nullptr : &memoryMap[index];
+}
+
+bool HexData::offsetToVirtualAddress(size_t offset, uint64_t* outVirtualAddress) const
+{
+  size_t index = findMemoryRegionIndex(offset);
+  if (index == (size_t)-1)
+    return false;
+
+  *outVirtualAddress = memoryMap[index].virtualAddress + (offset - memoryMap[index].bufferOffset);
+  return true;
+}
+
+bool HexData::resolveGoToTarget(uint64_t value, size_t* outOffset) const
+{
+  if (virtualAddressToOffset(value, outOffset))
+    return true;
+
+  if (value < (uint64_t)getFileSize())
+  {
+    *outOffset = (size_t)value;
+    return true;
+  }
+
+  uint64_t imageOffset;
+  if (!processSource && !isProcessMemory && structure.isOpenOn(fileData.data, fileData.size) &&
+      structure.virtualAddressToOffset(value, &imageOffset) && imageOffset < fileData.size)
+  {
+    *outOffset = (size_t)imageOffset;
+    return true;
   }
 
   return false;
 }
 
+void HexData::updateOffsetDigits()
+{
+  uint64_t highest = getFileSize() > 0 ? (uint64_t)getFileSize() - 1 : 0;
+
+  if (!memoryMap.empty())
+  {
+    const MemoryRegion& last = memoryMap[memoryMap.size() - 1];
+    if (last.virtualAddress + last.size - 1 > highest)
+      highest = last.virtualAddress + last.size - 1;
+  }
+
+  offsetDigits = 8;
+  while (offsetDigits < 16 && (highest >> (offsetDigits * 4)) != 0)
+    offsetDigits++;
+}
+
 void HexData::clearPluginAnnotations()
 {
   pba_free(&pluginAnnotations);
@@ -590,7 +1479,14 @@ void HexData::getHexLine(size_t lineIndex, char* outBuffer, size_t bufferSize) c
 
   size_t byteOffset = lineIndex * currentBytesPerLine;
 
-  if (byteOffset >= fileData.size)
+  uint8_t lineBytes[64];
+  size_t lineLength = readBytes(byteOffset, lineBytes, (size_t)currentBytesPerLine);
+  if (memoryWatch)
+    memoryWatch->overlayHistory(byteOffset, lineBytes, lineLength);
+  if (transform)
+    transform->overlay(byteOffset, lineBytes, lineLength);
+
+  if (lineLength == 0)
   {
     outBuffer[0] = 0;
     return;
@@ -599,14 +1495,14 @@ void HexData::getHexLine(size_t lineIndex, char* outBuffer, size_t bufferSize) c
   char* ptr = outBuffer;
   size_t remaining = bufferSize;
 
-  if (remaining > 10)
+  if (remaining > (size_t)offsetDigits + 2)
   {
-    char hex8[8];
-    uintToHex8((unsigned int)byteOffset, hex8);
+    uint64_t address = byteOffset;
+    offsetToVirtualAddress(byteOffset, &address);
 
-    for (int i = 0; i < 8 && remaining > 1; i++)
+    for (int i = offsetDigits - 1; i >= 0 && remaining > 1; i--)
     {
-      *ptr++ = hex8[i];
+      *ptr++ = intToHexChar((int)((address >> (i * 4)) & 0xF));
       remaining--;
     }
 
@@ -623,12 +1519,10 @@ void HexData::getHexLine(size_t lineIndex, char* outBuffer, size_t bufferSize) c
     if (remaining < 3)
       break;
 
-    size_t idx = byteOffset + j;
-
-    if (idx < fileData.size)
+    if ((size_t)j < lineLength)
     {
       char hx[2];
-      byteToHex(fileData.data[idx], hx);
+      byteToHex(lineBytes[j], hx);
 
       *ptr++ = hx[0];
       *ptr++ = hx[1];
@@ -655,11 +1549,10 @@ void HexData::getHexLine(size_t lineIndex, char* outBuffer, size_t bufferSize) c
     if (remaining < 2)
       break;
 
-    size_t idx = byteOffset + j;
-    if (idx >= fileData.size)
+    if ((size_t)j >= lineLength)
       break;
 
-    uint8_t b = fileData.data[idx];
+    uint8_t b = lineBytes[j];
     *ptr++ = (b >= 32 && b != 127) ? (char)b : '.';
     remaining--;
   }
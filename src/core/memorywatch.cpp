@@ -0,0 +1,605 @@
+#ifndef _WIN32
+#include <unistd.h>
+#include <time.h>
+#endif
+
+#include "memorywatch.h"
+#include "pluginresultcache.h"
+
+#define WATCH_SLEEP_STEP_MS 50
+
+static uint64_t WatchNowMs()
+{
+#ifdef _WIN32
+  return GetTickCount64();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+MemoryWatch::MemoryWatch()
+  : watchedBytes(0),
+    intervalMs(WATCH_DEFAULT_INTERVAL_MS),
+    pageHashes(nullptr),
+    pageCount(0),
+    shadow(nullptr),
+    scratch(nullptr),
+    ring(nullptr),
+    ringCapacity(0),
+    ringHead(0),
+    ringCount(0),
+    nextSerial(0),
+    latestSerial(0),
+    seenSerial(0),
+    selectedSerial(0),
+    running(false),
+    stopRequested(false)
+{
+#ifdef _WIN32
+  thread = nullptr;
+  InitializeCriticalSection(&mutex);
+#else
+  pthread_mutex_init(&mutex, nullptr);
+#endif
+  setHistoryDepth(WATCH_DEFAULT_GENERATIONS);
+}
+
+MemoryWatch::~MemoryWatch()
+{
+  stop();
+
+  for (size_t i = 0; i < ringCount; i++)
+    freeGeneration(generationAt(i));
+  if (ring)
+    platformFree(ring, ringCapacity * sizeof(WatchGeneration*));
+
+#ifdef _WIN32
+  DeleteCriticalSection(&mutex);
+#else
+  pthread_mutex_destroy(&mutex);
+#endif
+}
+
+void MemoryWatch::lock()
+{
+#ifdef _WIN32
+  EnterCriticalSection(&mutex);
+#else
+  pthread_mutex_lock(&mutex);
+#endif
+}
+
+void MemoryWatch::unlock()
+{
+#ifdef _WIN32
+  LeaveCriticalSection(&mutex);
+#else
+  pthread_mutex_unlock(&mutex);
+#endif
+}
+
+bool MemoryWatch::setHistoryDepth(size_t generations)
+{
+  if (running)
+    return false;
+
+  if (generations < 1)
+    generations = 1;
+  if (generations > WATCH_MAX_GENERATIONS)
+    generations = WATCH_MAX_GENERATIONS;
+
+  WatchGeneration** newRing = (WatchGeneration**)platformAlloc(generations * sizeof(WatchGeneration*));
+  if (!newRing)
+    return false;
+
+  size_t skip = ringCount > generations ? ringCount - generations : 0;
+  for (size_t i = 0; i < skip; i++)
+    freeGeneration(generationAt(i));
+  for (size_t i = skip; i < ringCount; i++)
+    newRing[i - skip] = generationAt(i);
+
+  if (ring)
+    platformFree(ring, ringCapacity * sizeof(WatchGeneration*));
+
+  ring = newRing;
+  ringCapacity = generations;
+  ringHead = 0;
+  ringCount -= skip;
+  return true;
+}
+
+bool MemoryWatch::start(int pid, const Vector<MemoryRegion>& regions, uint32_t interval)
+{
+  stop();
+
+  if (!source.attach(pid, regions))
+    return false;
+
+  // Read-only mappings cannot change without being remapped, so only the
+  // writable ones are rescanned. Spans are widened to whole watch pages so a
+  // page never straddles two scans.
+  spans.clear();
+  watchedBytes = 0;
+  const Vector<MemoryRegion>& sorted = source.getRegions();
+  for (size_t i = 0; i < sorted.size(); i++)
+  {
+    const MemoryRegion& region = sorted[i];
+    if (region.size == 0)
+      continue;
+    if (region.protection != 0 && !(region.protection & MEMORY_PROT_WRITE))
+      continue;
+
+    uint64_t start = region.bufferOffset - region.bufferOffset % WATCH_PAGE_SIZE;
+    uint64_t end = region.bufferOffset + region.size;
+    end += (WATCH_PAGE_SIZE - end % WATCH_PAGE_SIZE) % WATCH_PAGE_SIZE;
+    if (end > source.getSize())
+      end = source.getSize();
+
+    if (!spans.empty() && spans[spans.size() - 1].end >= start)
+    {
+      WatchSpan& last = spans[spans.size() - 1];
+      if (end > last.end)
+      {
+        watchedBytes += end - last.end;
+        last.end = end;
+      }
+      continue;
+    }
+
+    WatchSpan span;
+    span.start = start;
+    span.end = end;
+    span.shadowOffset = watchedBytes;
+    spans.push_back(span);
+    watchedBytes += end - start;
+  }
+
+  if (spans.empty())
+  {
+    source.detach();
+    return false;
+  }
+
+  pageCount = (size_t)((source.getSize() + WATCH_PAGE_SIZE - 1) / WATCH_PAGE_SIZE);
+  pageHashes = (uint64_t*)platformAlloc(pageCount * sizeof(uint64_t));
+  scratch = (uint8_t*)platformAlloc(WATCH_SCAN_CHUNK);
+  if (watchedBytes <= WATCH_SHADOW_LIMIT)
+    shadow = (uint8_t*)platformAlloc((size_t)watchedBytes);
+
+  if (!pageHashes || !scratch)
+  {
+    stop();
+    return false;
+  }
+
+  for (size_t i = 0; i < ringCount; i++)
+    freeGeneration(generationAt(i));
+  ringHead = 0;
+  ringCount = 0;
+  latestSerial = nextSerial;
+  seenSerial = nextSerial;
+  selectedSerial = 0;
+
+  intervalMs = interval > 0 ? interval : WATCH_DEFAULT_INTERVAL_MS;
+  stopRequested = false;
+
+#ifdef _WIN32
+  thread = CreateThread(nullptr, 0, threadMain, this, 0, nullptr);
+  running = thread != nullptr;
+#else
+  running = pthread_create(&thread, nullptr, threadMain, this) == 0;
+#endif
+
+  if (!running)
+    stop();
+  return running;
+}
+
+void MemoryWatch::stop()
+{
+  if (running)
+  {
+    lock();
+    stopRequested = true;
+    unlock();
+
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    thread = nullptr;
+#else
+    pthread_join(thread, nullptr);
+#endif
+    running = false;
+  }
+
+  if (pageHashes)
+    platformFree(pageHashes, pageCount * sizeof(uint64_t));
+  if (shadow)
+    platformFree(shadow, (size_t)watchedBytes);
+  if (scratch)
+    platformFree(scratch, WATCH_SCAN_CHUNK);
+
+  pageHashes = nullptr;
+  shadow = nullptr;
+  scratch = nullptr;
+  pageCount = 0;
+  source.detach();
+}
+
+#ifdef _WIN32
+DWORD WINAPI MemoryWatch::threadMain(LPVOID param)
+{
+  ((MemoryWatch*)param)->run();
+  return 0;
+}
+#else
+void* MemoryWatch::threadMain(void* param)
+{
+  ((MemoryWatch*)param)->run();
+  return nullptr;
+}
+#endif
+
+bool MemoryWatch::shouldStop()
+{
+  lock();
+  bool stopping = stopRequested;
+  unlock();
+  return stopping;
+}
+
+bool MemoryWatch::sleepInterval()
+{
+  uint64_t deadline = WatchNowMs() + intervalMs;
+  while (!shouldStop())
+  {
+    uint64_t now = WatchNowMs();
+    if (now >= deadline)
+      return true;
+
+    uint64_t wait = deadline - now;
+    if (wait > WATCH_SLEEP_STEP_MS)
+      wait = WATCH_SLEEP_STEP_MS;
+#ifdef _WIN32
+    Sleep((DWORD)wait);
+#else
+    usleep((useconds_t)(wait * 1000));
+#endif
+  }
+  return false;
+}
+
+void MemoryWatch::run()
+{
+  scan(true);
+  while (sleepInterval())
+    scan(false);
+}
+
+void MemoryWatch::scan(bool baseline)
+{
+  WatchGeneration* generation = baseline ? nullptr : new WatchGeneration();
+  if (generation)
+  {
+    generation->timestamp = WatchNowMs();
+    generation->changedBytes = 0;
+  }
+
+  for (size_t s = 0; s < spans.size(); s++)
+  {
+    const WatchSpan& span = spans[s];
+
+    for (uint64_t pos = span.start; pos < span.end; pos += WATCH_SCAN_CHUNK)
+    {
+      if (shouldStop())
+      {
+        freeGeneration(generation);
+        return;
+      }
+
+      size_t length = (size_t)(span.end - pos);
+      if (length > WATCH_SCAN_CHUNK)
+        length = WATCH_SCAN_CHUNK;
+
+      length = source.snapshot(pos, scratch, length);
+
+      for (size_t off = 0; off < length; off += WATCH_PAGE_SIZE)
+      {
+        size_t pageLength = length - off;
+        if (pageLength > WATCH_PAGE_SIZE)
+          pageLength = WATCH_PAGE_SIZE;
+
+        uint64_t pageIndex = (pos + off) / WATCH_PAGE_SIZE;
+        uint64_t hash = PluginCache_HashContent(scratch + off, pageLength);
+        uint8_t* known = shadow ? shadow + (size_t)(span.shadowOffset + pos - span.start + off) : nullptr;
+
+        if (baseline)
+        {
+          pageHashes[pageIndex] = hash;
+          if (known)
+            memCopy(known, scratch + off, pageLength);
+          continue;
+        }
+
+        if (pageHashes[pageIndex] == hash)
+          continue;
+
+        pageHashes[pageIndex] = hash;
+        recordChange(generation, pageIndex, scratch + off, pageLength, known);
+      }
+    }
+  }
+
+  if (generation && !generation->pages.empty())
+    publish(generation);
+  else
+    delete generation;
+}
+
+void MemoryWatch::recordChange(WatchGeneration* generation, uint64_t pageIndex,
+                               const uint8_t* data, size_t length, uint8_t* known)
+{
+  WatchPage page;
+  page.index = pageIndex;
+  page.before = nullptr;
+  page.mask = nullptr;
+
+  if (!known || generation->pages.size() >= WATCH_MAX_DETAILED_PAGES)
+  {
+    generation->changedBytes += length;
+    if (known)
+      memCopy(known, data, length);
+    generation->pages.push_back(page);
+    return;
+  }
+
+  page.before = (uint8_t*)platformAlloc(WATCH_PAGE_SIZE);
+  page.mask = (uint8_t*)platformAlloc(WATCH_MASK_BYTES);
+  if (!page.before || !page.mask)
+  {
+    if (page.before)
+      platformFree(page.before, WATCH_PAGE_SIZE);
+    if (page.mask)
+      platformFree(page.mask, WATCH_MASK_BYTES);
+    page.before = nullptr;
+    page.mask = nullptr;
+    generation->changedBytes += length;
+    memCopy(known, data, length);
+    generation->pages.push_back(page);
+    return;
+  }
+
+  memSet(page.before, 0, WATCH_PAGE_SIZE);
+  memSet(page.mask, 0, WATCH_MASK_BYTES);
+  memCopy(page.before, known, length);
+
+  for (size_t i = 0; i < length; i++)
+  {
+    if (known[i] != data[i])
+    {
+      page.mask[i >> 3] |= (uint8_t)(1 << (i & 7));
+      generation->changedBytes++;
+    }
+  }
+
+  memCopy(known, data, length);
+  generation->pages.push_back(page);
+}
+
+void MemoryWatch::publish(WatchGeneration* generation)
+{
+  WatchGeneration* evicted = nullptr;
+
+  lock();
+  generation->serial = ++nextSerial;
+  if (ringCount == ringCapacity)
+  {
+    evicted = ring[ringHead];
+    ringHead = (ringHead + 1) % ringCapacity;
+    ringCount--;
+  }
+  ring[(ringHead + ringCount) % ringCapacity] = generation;
+  ringCount++;
+  latestSerial = generation->serial;
+  unlock();
+
+  freeGeneration(evicted);
+}
+
+void MemoryWatch::freeGeneration(WatchGeneration* generation)
+{
+  if (!generation)
+    return;
+
+  for (size_t i = 0; i < generation->pages.size(); i++)
+  {
+    WatchPage& page = generation->pages[i];
+    if (page.before)
+      platformFree(page.before, WATCH_PAGE_SIZE);
+    if (page.mask)
+      platformFree(page.mask, WATCH_MASK_BYTES);
+  }
+  delete generation;
+}
+
+WatchGeneration* MemoryWatch::generationAt(size_t index) const
+{
+  return ring[(ringHead + index) % ringCapacity];
+}
+
+size_t MemoryWatch::findPage(const WatchGeneration* generation, uint64_t pageIndex)
+{
+  size_t lo = 0;
+  size_t hi = generation->pages.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (generation->pages[mid].index < pageIndex)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int MemoryWatch::findSelectedLocked() const
+{
+  if (ringCount == 0)
+    return -1;
+  if (selectedSerial == 0)
+    return (int)ringCount - 1;
+
+  for (size_t i = 0; i < ringCount; i++)
+  {
+    if (generationAt(i)->serial >= selectedSerial)
+      return (int)i;
+  }
+  return (int)ringCount - 1;
+}
+
+bool MemoryWatch::poll()
+{
+  lock();
+  bool fresh = latestSerial != seenSerial;
+  seenSerial = latestSerial;
+  if (selectedSerial != 0 && ringCount > 0 && generationAt(0)->serial > selectedSerial)
+    selectedSerial = generationAt(0)->serial;
+  unlock();
+  return fresh;
+}
+
+size_t MemoryWatch::getGenerationCount()
+{
+  lock();
+  size_t count = ringCount;
+  unlock();
+  return count;
+}
+
+bool MemoryWatch::getGenerationInfo(size_t index, WatchGenerationInfo* out)
+{
+  if (!out)
+    return false;
+
+  lock();
+  bool found = index < ringCount;
+  if (found)
+  {
+    const WatchGeneration* generation = generationAt(index);
+    out->serial = generation->serial;
+    out->timestamp = generation->timestamp;
+    out->changedPages = generation->pages.size();
+    out->changedBytes = generation->changedBytes;
+  }
+  unlock();
+  return found;
+}
+
+int MemoryWatch::getSelectedGeneration()
+{
+  lock();
+  int index = findSelectedLocked();
+  unlock();
+  return index;
+}
+
+bool MemoryWatch::stepGeneration(int delta)
+{
+  lock();
+  int index = findSelectedLocked();
+  bool moved = false;
+  if (index >= 0)
+  {
+    int target = index + delta;
+    if (target < 0)
+      target = 0;
+
+    if (target >= (int)ringCount - 1 && delta > 0)
+    {
+      moved = selectedSerial != 0;
+      selectedSerial = 0;
+    }
+    else if (target != index || selectedSerial == 0)
+    {
+      selectedSerial = generationAt((size_t)target)->serial;
+      moved = true;
+    }
+  }
+  unlock();
+  return moved;
+}
+
+size_t MemoryWatch::getChangeFlags(uint64_t offset, size_t length, uint8_t* outFlags)
+{
+  memSet(outFlags, 0, length);
+
+  lock();
+  int selected = findSelectedLocked();
+  size_t flagged = 0;
+  if (selected >= 0)
+  {
+    const WatchGeneration* generation = generationAt((size_t)selected);
+    uint64_t end = offset + length;
+
+    for (size_t i = findPage(generation, offset / WATCH_PAGE_SIZE); i < generation->pages.size(); i++)
+    {
+      const WatchPage& page = generation->pages[i];
+      uint64_t pageStart = page.index * WATCH_PAGE_SIZE;
+      if (pageStart >= end)
+        break;
+
+      uint64_t from = pageStart > offset ? pageStart : offset;
+      uint64_t to = pageStart + WATCH_PAGE_SIZE < end ? pageStart + WATCH_PAGE_SIZE : end;
+      for (uint64_t pos = from; pos < to; pos++)
+      {
+        size_t bit = (size_t)(pos - pageStart);
+        if (!page.mask || (page.mask[bit >> 3] & (1 << (bit & 7))))
+        {
+          outFlags[pos - offset] = 1;
+          flagged++;
+        }
+      }
+    }
+  }
+  unlock();
+  return flagged;
+}
+
+void MemoryWatch::overlayHistory(uint64_t offset, uint8_t* data, size_t length)
+{
+  if (selectedSerial == 0 || length == 0)
+    return;
+
+  lock();
+  int selected = findSelectedLocked();
+  if (selected >= 0)
+  {
+    // A page's content as of the selected generation is whatever it held just
+    // before its next recorded change; pages that never changed since are live.
+    uint64_t end = offset + length;
+    for (uint64_t pageIndex = offset / WATCH_PAGE_SIZE; pageIndex * WATCH_PAGE_SIZE < end; pageIndex++)
+    {
+      for (size_t g = (size_t)selected + 1; g < ringCount; g++)
+      {
+        const WatchGeneration* generation = generationAt(g);
+        size_t i = findPage(generation, pageIndex);
+        if (i >= generation->pages.size() || generation->pages[i].index != pageIndex)
+          continue;
+
+        const uint8_t* before = generation->pages[i].before;
+        if (before)
+        {
+          uint64_t pageStart = pageIndex * WATCH_PAGE_SIZE;
+          uint64_t from = pageStart > offset ? pageStart : offset;
+          uint64_t to = pageStart + WATCH_PAGE_SIZE < end ? pageStart + WATCH_PAGE_SIZE : end;
+          memCopy(data + (from - offset), before + (from - pageStart), (size_t)(to - from));
+        }
+        break;
+      }
+    }
+  }
+  unlock();
+}
@@ -24,8 +24,14 @@ BookmarksState g_Bookmarks = { {}, -1, -1 };
 ByteStatistics g_ByteStats = {{0}, 0, 0, 0, 0, 0, 0.0, false};
 DetectItEasyState g_DIEState = {false, "", "", ""};
 PatternSearchState g_PatternSearch = { "", -1, false };
-ChecksumState g_Checksum = { false, false, false, false, true };
+ChecksumState g_Checksum = { false, false, false, false, true, true, true };
 CompareState g_Compare = { "", false };
+StructurePanelState g_StructurePanel = { 0 };
+TemplatePanelState g_TemplatePanel = { 0 };
+StringsPanelState g_StringsPanel = { 0 };
+ByteMapPanelState g_ByteMapPanel = { BYTEMAP_DIGRAPH, true };
+int g_PluginAnnotationHoveredIndex = -1;
+static ProjectFile g_Project;
 
 void InvalidateWindow();
 
@@ -163,6 +169,16 @@ void Checksum_ToggleCRC32()
     g_Checksum.crc32 = !g_Checksum.crc32;
 }
 
+void Checksum_ToggleSsdeep()
+{
+    g_Checksum.ssdeep = !g_Checksum.ssdeep;
+}
+
+void Checksum_ToggleTlsh()
+{
+    g_Checksum.tlsh = !g_Checksum.tlsh;
+}
+
 void Checksum_SetModeEntireFile()
 {
     g_Checksum.entireFile = true;
@@ -173,12 +189,105 @@ void Checksum_SetModeSelection()
     g_Checksum.entireFile = false;
 }
 
+void OnDigestListOpen();
+
 void Checksum_Compare()
 {
+    OnDigestListOpen();
 }
 
 void Checksum_Compute()
 {
+    extern long long selectionLength;
+
+    g_Checksums.fuzzyValid = false;
+    g_Checksums.matches.clear();
+    g_Checksums.digestsScanned = 0;
+    if (g_HexData.isEmpty() || (!g_Checksum.entireFile && selectionLength <= 0))
+        return;
+
+    uint64_t start = g_Checksum.entireFile ? 0 : (uint64_t)cursorBytePos;
+    uint64_t length = g_Checksum.entireFile ? g_HexData.getFileSize() : (uint64_t)selectionLength;
+    g_Checksums.fuzzyValid = g_HexData.computeFuzzyDigests(start, length, g_Checksum.ssdeep, g_Checksum.tlsh, &g_Checksums.fuzzy);
+}
+
+bool Checksum_CompareList(const char* path, char* outError, size_t errorMax)
+{
+    Checksum_Compute();
+    if (!g_Checksums.fuzzyValid || (!g_Checksums.fuzzy.ssdeep[0] && !g_Checksums.fuzzy.tlsh[0]))
+    {
+        stringCopy(outError, "Select data to hash with ssdeep or TLSH first", (int)errorMax);
+        return false;
+    }
+    return g_HexData.matchDigestList(path, g_Checksums.fuzzy, &g_Checksums.matches,
+                                     &g_Checksums.digestsScanned, outError, errorMax);
+}
+
+Rect ByteMap_GetImageRect(int contentX, int contentY, int contentWidth, int contentHeight)
+{
+    int side = contentHeight < contentWidth / 2 ? contentHeight : contentWidth / 2;
+    if (side > 2 * BYTEMAP_SIDE)
+        side = 2 * BYTEMAP_SIDE;
+    if (side < 0)
+        side = 0;
+    return Rect(contentX, contentY, side, side);
+}
+
+void ByteMap_SetView(ByteMapView view)
+{
+    g_ByteMapPanel.view = view;
+}
+
+void ByteMap_SetModeEntireFile()
+{
+    g_ByteMapPanel.entireFile = true;
+}
+
+void ByteMap_SetModeSelection()
+{
+    g_ByteMapPanel.entireFile = false;
+}
+
+void ByteMap_Compute()
+{
+    extern long long selectionLength;
+
+    if (g_HexData.isEmpty() || (!g_ByteMapPanel.entireFile && selectionLength <= 0))
+        return;
+
+    uint64_t start = g_ByteMapPanel.entireFile ? 0 : (uint64_t)cursorBytePos;
+    uint64_t length = g_ByteMapPanel.entireFile ? g_HexData.getFileSize() : (uint64_t)selectionLength;
+    g_HexData.buildByteMap(start, length);
+}
+
+void ByteMap_Activate(int x, int y, const Rect& imageRect)
+{
+    ByteMap* map = g_HexData.getByteMap();
+    if (!map || g_ByteMapPanel.view != BYTEMAP_HILBERT || imageRect.width <= 0 || imageRect.height <= 0)
+        return;
+
+    int side = map->getHilbertSide();
+    uint64_t offset;
+    if (!map->hilbertOffset((x - imageRect.x) * side / imageRect.width,
+                            (y - imageRect.y) * side / imageRect.height, &offset))
+        return;
+
+    extern long long selectionLength;
+    cursorBytePos = (long long)offset;
+    cursorNibblePos = 0;
+    selectionLength = 0;
+
+    long long line = cursorBytePos / 16;
+    if (line < g_ScrollY || line >= g_ScrollY + g_LinesPerPage)
+    {
+        g_ScrollY = (int)line;
+
+#ifdef _WIN32
+        SetScrollPos(g_Hwnd, SB_VERT, g_ScrollY, TRUE);
+#endif
+    }
+
+    InvalidateWindow();
 }
 
 void Compare_OpenFileDialog()
@@ -230,6 +339,40 @@ static int ParseHexPattern(const char *text, uint8_t *out, int maxOut)
     return count;
 }
 
+int Bookmarks_LowerBound(long long byteOffset)
+{
+  int lo = 0;
+  int hi = (int)g_Bookmarks.bookmarks.size();
+  while (lo < hi)
+  {
+    int mid = lo + (hi - lo) / 2;
+    if (g_Bookmarks.bookmarks[mid].byteOffset < byteOffset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int Bookmarks_Insert(const Bookmark& bm)
+{
+  int index = Bookmarks_LowerBound(bm.byteOffset);
+  while (index < (int)g_Bookmarks.bookmarks.size() &&
+    g_Bookmarks.bookmarks[index].byteOffset == bm.byteOffset)
+  {
+    index++;
+  }
+
+  g_Bookmarks.bookmarks.insert(index, bm);
+
+  if (g_Bookmarks.selectedIndex >= index)
+    g_Bookmarks.selectedIndex++;
+  if (g_Bookmarks.hoveredIndex >= index)
+    g_Bookmarks.hoveredIndex++;
+
+  return index;
+}
+
 void Bookmarks_Add(long long byteOffset, const char* name, Color color)
 {
   if (Bookmarks_findAtOffset(byteOffset) >= 0)
@@ -252,7 +395,7 @@ void Bookmarks_Add(long long byteOffset, const char* name, Color color)
     bm.byteValue = 0;
   }
 
-  g_Bookmarks.bookmarks.push_back(bm);
+  Bookmarks_Insert(bm);
   InvalidateWindow();
 }
 
@@ -297,6 +440,155 @@ void Bookmarks_JumpTo(int index)
     }
 }
 
+void Structure_Scroll(int rows)
+{
+  StructureDecoder* structure = g_HexData.getStructure();
+  if (!structure)
+    return;
+
+  Vector<int> visible;
+  structure->getVisibleNodes(&visible);
+  g_StructurePanel.firstRow = clamp(g_StructurePanel.firstRow + rows, 0, visible.empty() ? 0 : (int)visible.size() - 1);
+  InvalidateWindow();
+}
+
+void Structure_Activate(int nodeIndex)
+{
+  StructureDecoder* structure = g_HexData.getStructure();
+  const StructureNode* node = structure ? structure->getNode(nodeIndex) : nullptr;
+  if (!node)
+    return;
+
+  bool more = node->kind == STRUCT_NODE_MORE;
+  long long offset = (long long)node->offset;
+  long long length = (long long)node->size;
+  structure->toggle(nodeIndex);
+
+  long long fileSize = (long long)g_HexData.getFileSize();
+  if (!more && offset < fileSize)
+  {
+    extern long long selectionLength;
+    cursorBytePos = offset;
+    cursorNibblePos = 0;
+    selectionLength = length > 1 ? (offset + length > fileSize ? fileSize - offset : length) : 0;
+
+    long long line = cursorBytePos / 16;
+    if (line < g_ScrollY || line >= g_ScrollY + g_LinesPerPage)
+    {
+      g_ScrollY = (int)line;
+
+#ifdef _WIN32
+      extern HWND g_Hwnd;
+      SetScrollPos(g_Hwnd, SB_VERT, g_ScrollY, TRUE);
+#endif
+    }
+  }
+
+  InvalidateWindow();
+}
+
+void Template_Scroll(int rows)
+{
+  TemplateEngine* templateEngine = g_HexData.getTemplate();
+  if (!templateEngine)
+    return;
+
+  Vector<int> visible;
+  templateEngine->getVisibleNodes(&visible);
+  g_TemplatePanel.firstRow = clamp(g_TemplatePanel.firstRow + rows, 0, visible.empty() ? 0 : (int)visible.size() - 1);
+  InvalidateWindow();
+}
+
+void Template_Activate(int nodeIndex)
+{
+  TemplateEngine* templateEngine = g_HexData.getTemplate();
+  const TemplateNode* node = templateEngine ? templateEngine->getNode(nodeIndex) : nullptr;
+  if (!node)
+    return;
+
+  bool more = node->kind == TPL_NODE_MORE;
+  long long offset = (long long)node->offset;
+  templateEngine->toggle(nodeIndex);
+  node = templateEngine->getNode(nodeIndex);
+  long long length = (long long)node->size;
+
+  long long fileSize = (long long)g_HexData.getFileSize();
+  if (!more && offset < fileSize)
+  {
+    extern long long selectionLength;
+    cursorBytePos = offset;
+    cursorNibblePos = 0;
+    selectionLength = length > 1 ? (offset + length > fileSize ? fileSize - offset : length) : 0;
+
+    long long line = cursorBytePos / 16;
+    if (line < g_ScrollY || line >= g_ScrollY + g_LinesPerPage)
+    {
+      g_ScrollY = (int)line;
+
+#ifdef _WIN32
+      extern HWND g_Hwnd;
+      SetScrollPos(g_Hwnd, SB_VERT, g_ScrollY, TRUE);
+#endif
+    }
+  }
+
+  InvalidateWindow();
+}
+
+void Strings_Scroll(long long rows)
+{
+  StringIndex* strings = g_HexData.getStrings();
+  if (!strings)
+    return;
+
+  long long last = strings->getCount() > 0 ? (long long)strings->getCount() - 1 : 0;
+  long long firstRow = (long long)g_StringsPanel.firstRow + rows;
+  g_StringsPanel.firstRow = (size_t)(firstRow < 0 ? 0 : (firstRow > last ? last : firstRow));
+  InvalidateWindow();
+}
+
+void Strings_ShowNear(long long byteOffset)
+{
+  StringIndex* strings = g_HexData.getStrings();
+  if (!strings)
+    return;
+
+  size_t index = strings->findOffset(byteOffset > 0 ? (uint64_t)byteOffset : 0);
+  g_StringsPanel.firstRow = index < strings->getCount() ? index : (strings->getCount() > 0 ? strings->getCount() - 1 : 0);
+  InvalidateWindow();
+}
+
+void Strings_Activate(size_t index)
+{
+  StringIndex* strings = g_HexData.getStrings();
+  if (!strings || index >= strings->getCount())
+    return;
+
+  long long offset = (long long)strings->getOffset(index);
+  long long length = (long long)strings->getByteLength(index);
+  long long fileSize = (long long)g_HexData.getFileSize();
+  if (offset >= fileSize)
+    return;
+
+  extern long long selectionLength;
+  cursorBytePos = offset;
+  cursorNibblePos = 0;
+  selectionLength = offset + length > fileSize ? fileSize - offset : length;
+
+  long long line = cursorBytePos / 16;
+  if (line < g_ScrollY || line >= g_ScrollY + g_LinesPerPage)
+  {
+    g_ScrollY = (int)line;
+
+#ifdef _WIN32
+    extern HWND g_Hwnd;
+    SetScrollPos(g_Hwnd, SB_VERT, g_ScrollY, TRUE);
+#endif
+  }
+
+  InvalidateWindow();
+}
+
 void Bookmarks_clear()
 {
     g_Bookmarks.bookmarks.clear();
@@ -318,47 +610,178 @@ void Bookmarks_UpdateValues()
 
 int Bookmarks_findAtOffset(long long byteOffset)
 {
-    for (int i = 0; i < (int)g_Bookmarks.bookmarks.size(); i++)
+    int index = Bookmarks_LowerBound(byteOffset);
+    if (index < (int)g_Bookmarks.bookmarks.size() &&
+        g_Bookmarks.bookmarks[index].byteOffset == byteOffset)
     {
-        if (g_Bookmarks.bookmarks[i].byteOffset == byteOffset)
-        {
-            return i;
-        }
+        return index;
     }
     return -1;
 }
 
 const Bookmark* Bookmarks_GetAtOffset(long long byteOffset)
 {
-  for (int i = 0; i < (int)g_Bookmarks.bookmarks.size(); i++)
+  int index = Bookmarks_findAtOffset(byteOffset);
+  return index >= 0 ? &g_Bookmarks.bookmarks[index] : nullptr;
+}
+
+bool PluginAnnotations_UpdateHover(long long byteOffset)
+{
+  int hovered = -1;
+  if (byteOffset >= 0)
   {
-    if (g_Bookmarks.bookmarks[i].byteOffset == byteOffset)
-    {
-      return &g_Bookmarks.bookmarks[i];
-    }
+    const PluginBookmark* annotation = g_HexData.findPluginAnnotation((uint64_t)byteOffset);
+    if (annotation)
+      hovered = (int)(annotation - g_HexData.getPluginAnnotations()->bookmarks);
   }
-  return nullptr;
+
+  if (hovered == g_PluginAnnotationHoveredIndex)
+    return false;
+
+  g_PluginAnnotationHoveredIndex = hovered;
+  return true;
+}
+
+// Bookmarks, plugin annotations and the view are kept per file in a
+// PROJECT_FILE_EXTENSION sidecar; annotations are only restored when the
+// file content still matches the one they were generated from.
+bool Project_Load(const char* filePath)
+{
+  extern SelectionState g_Selection;
+  extern int g_TotalLines;
+
+  g_Bookmarks.bookmarks.clear();
+  g_Bookmarks.selectedIndex = -1;
+  g_Bookmarks.hoveredIndex = -1;
+
+  long long fileSize = (long long)g_HexData.getFileSize();
+  if (!filePath || !filePath[0] || fileSize <= 0)
+    return false;
+
+  if (!g_Project.open(filePath, (uint64_t)fileSize, g_HexData.getContentFingerprint()))
+    return false;
+
+  for (size_t i = 0; i < g_Project.getBookmarkCount(); i++)
+  {
+    ProjectBookmark record;
+    if (!g_Project.getBookmark(i, &record))
+      break;
+
+    Bookmark bm;
+    bm.byteOffset = (long long)record.offset;
+    stringCopy(bm.name, record.name, sizeof(bm.name));
+    stringCopy(bm.description, record.description, sizeof(bm.description));
+    bm.color = Color((uint8_t)record.color, (uint8_t)(record.color >> 8),
+                     (uint8_t)(record.color >> 16), (uint8_t)(record.color >> 24));
+    bm.byteValue = bm.byteOffset >= 0 && bm.byteOffset < fileSize
+                       ? g_HexData.getByte((size_t)bm.byteOffset)
+                       : record.byteValue;
+    Bookmarks_Insert(bm);
+  }
+
+  if (g_Project.getAnnotationCount() > 0)
+  {
+    g_HexData.clearPluginAnnotations();
+    g_Project.loadAnnotations(g_HexData.getPluginAnnotations());
+  }
+
+  const ProjectViewState& view = g_Project.getViewState();
+  if (view.cursor >= 0 && view.cursor < fileSize)
+  {
+    cursorBytePos = view.cursor;
+    cursorNibblePos = view.nibble ? 1 : 0;
+  }
+
+  g_Selection.clear();
+  if (view.selectionActive && view.selectionStart >= 0 && view.selectionStart < fileSize &&
+      view.selectionEnd >= 0 && view.selectionEnd < fileSize)
+  {
+    g_Selection.startByte = view.selectionStart;
+    g_Selection.endByte = view.selectionEnd;
+    g_Selection.active = true;
+  }
+
+  int bytesPerLine = g_HexData.getCurrentBytesPerLine();
+  if (bytesPerLine > 0 && (long long)view.topByte < fileSize)
+  {
+    long long line = (long long)view.topByte / bytesPerLine;
+    g_ScrollY = line < g_TotalLines ? (int)line : 0;
+#ifdef _WIN32
+    SetScrollPos(g_Hwnd, SB_VERT, g_ScrollY, TRUE);
+#endif
+  }
+
+  InvalidateWindow();
+  return true;
+}
+
+bool Project_Save(const char* filePath)
+{
+  extern SelectionState g_Selection;
+
+  size_t fileSize = g_HexData.getFileSize();
+  ProcessMemorySource* source = g_HexData.getProcessSource();
+  if (!filePath || !filePath[0] || fileSize == 0 || (source && !source->isDump()))
+    return false;
+
+  Vector<ProjectBookmark> records;
+  for (size_t i = 0; i < g_Bookmarks.bookmarks.size(); i++)
+  {
+    const Bookmark& bm = g_Bookmarks.bookmarks[i];
+    if (bm.byteOffset < 0)
+      continue;
+
+    ProjectBookmark record;
+    record.offset = (uint64_t)bm.byteOffset;
+    record.name = bm.name;
+    record.description = bm.description;
+    record.color = (uint32_t)bm.color.r | ((uint32_t)bm.color.g << 8) |
+                   ((uint32_t)bm.color.b << 16) | ((uint32_t)bm.color.a << 24);
+    record.byteValue = bm.byteValue;
+    records.push_back(record);
+  }
+
+  ProjectViewState view;
+  view.cursor = cursorBytePos;
+  view.nibble = (uint32_t)cursorNibblePos;
+  view.selectionActive = g_Selection.active;
+  view.selectionStart = g_Selection.startByte;
+  view.selectionEnd = g_Selection.endByte;
+  view.topByte = (uint64_t)(g_ScrollY > 0 ? g_ScrollY : 0) * (uint64_t)g_HexData.getCurrentBytesPerLine();
+
+  // Unsaved edits are not what the next open will fingerprint.
+  if (g_HexData.isModified())
+  {
+    return g_Project.saveView(filePath, records.empty() ? nullptr : &records[0], records.size(), view);
+  }
+
+  return g_Project.save(filePath, fileSize, g_HexData.getContentFingerprint(),
+                        records.empty() ? nullptr : &records[0], records.size(),
+                        g_HexData.getPluginAnnotations(), view);
 }
 
 void ByteStats_Compute(HexData &hexData)
 {
+    extern long long selectionLength;
+
     memSet(&g_ByteStats, 0, sizeof(ByteStatistics));
 
-    uint64_t fileSize = (uint64_t)hexData.getFileSize();
-    if (fileSize == 0)
+    bool useSelection = selectionLength > 1 && cursorBytePos >= 0;
+    uint64_t start = useSelection ? (uint64_t)cursorBytePos : 0;
+    uint64_t length = useSelection ? (uint64_t)selectionLength : (uint64_t)hexData.getFileSize();
+
+    ByteRangeStats stats;
+    if (length == 0 || !hexData.getRangeStats(start, length, &stats))
     {
         g_ByteStats.computed = false;
         return;
     }
 
-    for (uint64_t i = 0; i < fileSize; i++)
-    {
-        uint8_t b = hexData.getByte((size_t)i);
-        g_ByteStats.histogram[b]++;
-    }
+    for (int i = 0; i < 256; i++)
+        g_ByteStats.histogram[i] = stats.histogram[i] > 0x7FFFFFFF ? 0x7FFFFFFF : (int)stats.histogram[i];
 
     g_ByteStats.mostCommonCount = 0;
-    g_ByteStats.leastCommonCount = (int)fileSize + 1;
+    g_ByteStats.leastCommonCount = 0x7FFFFFFF;
 
     for (int i = 0; i < 256; i++)
     {
@@ -378,17 +801,7 @@ void ByteStats_Compute(HexData &hexData)
     }
 
     g_ByteStats.nullByteCount = g_ByteStats.histogram[0];
-
-    int distinct = 0;
-    for (int i = 0; i < 256; i++)
-    {
-        if (g_ByteStats.histogram[i] > 0)
-            distinct++;
-    }
-
-    double entropy = (double)distinct * (8.0 / 256.0);
-
-    g_ByteStats.entropy = entropy;
+    g_ByteStats.entropy = ByteRangeStats_Entropy(stats);
 
     g_ByteStats.computed = true;
     InvalidateWindow();
@@ -400,6 +813,50 @@ void ByteStats_clear()
     g_ByteStats.computed = false;
 }
 
+int Entropy_GetProfile(int barCount, const float** outValues)
+{
+    static float values[ENTROPY_PROFILE_MAX_BARS];
+    static uint32_t cachedVersion = 0;
+    static int cachedBars = 0;
+    static int cachedUsed = 0;
+
+    BlockStatsIndex* index = g_HexData.getBlockStats();
+    if (!index || barCount <= 0)
+        return 0;
+    if (barCount > ENTROPY_PROFILE_MAX_BARS)
+        barCount = ENTROPY_PROFILE_MAX_BARS;
+
+    *outValues = values;
+    if (index->getVersion() == cachedVersion && barCount == cachedBars)
+        return cachedUsed;
+
+    // Segments of whole blocks are answered from the index alone, so the
+    // profile costs a few tree lookups per bar regardless of file size.
+    uint64_t fileSize = g_HexData.getFileSize();
+    uint64_t segment = (fileSize + barCount - 1) / barCount;
+    if (segment > BLOCKSTATS_BLOCK_SIZE)
+        segment = (segment + BLOCKSTATS_BLOCK_SIZE - 1) / BLOCKSTATS_BLOCK_SIZE * BLOCKSTATS_BLOCK_SIZE;
+
+    int used = 0;
+    for (uint64_t offset = 0; segment > 0 && offset < fileSize && used < barCount; offset += segment)
+    {
+        uint64_t length = fileSize - offset < segment ? fileSize - offset : segment;
+        ByteRangeStats stats;
+        values[used++] = index->query(offset, length, &stats) ? (float)ByteRangeStats_Entropy(stats) : 0.0f;
+    }
+
+    cachedVersion = index->getVersion();
+    cachedBars = barCount;
+    cachedUsed = used;
+    return used;
+}
+
+int DataInspector_RowCount()
+{
+    extern long long selectionLength;
+    return selectionLength > 1 ? 6 : 5;
+}
+
 Rect GetDIEButtonRect(const Rect& panelBounds)
 {
   int contentX = panelBounds.x + 15;
@@ -445,7 +902,7 @@ Rect GetPluginAnnotationRect(int annotationIndex, const Rect& panelBounds)
   currentY += headerHeight + sectionSpacing;
   if (cursorBytePos >= 0 && cursorBytePos < fileSize)
   {
-    currentY += (rowHeight + itemSpacing) * 5;
+    currentY += (rowHeight + itemSpacing) * DataInspector_RowCount();
     currentY += 8;
   }
   else
@@ -527,7 +984,7 @@ Rect GetBookmarkRect(int bookmarkIndex, const Rect& panelBounds)
   currentY += headerHeight + sectionSpacing;
   if (cursorBytePos >= 0 && cursorBytePos < (long long)g_HexData.getFileSize())
   {
-    currentY += (rowHeight + itemSpacing) * 5;
+    currentY += (rowHeight + itemSpacing) * DataInspector_RowCount();
     currentY += 8;
   }
   else
@@ -648,7 +1105,7 @@ bool HandleBottomPanelContentClick(int x, int y, int windowWidth, int windowHeig
 
     int contentX = bottomBounds.x + 15;
     int contentY = bottomBounds.y + PANEL_TITLE_HEIGHT +
-                   (isVertical ? (tabHeight * 4) : tabHeight) + 10;
+                   (isVertical ? (tabHeight * 5) : tabHeight) + 10;
 
     int contentWidth = bottomBounds.width - 30;
     int contentHeight = bottomBounds.height - (contentY - bottomBounds.y) - 10;
@@ -743,6 +1200,22 @@ bool HandleBottomPanelContentClick(int x, int y, int windowWidth, int windowHeig
             return true;
         }
 
+        Rect ssdeepCheck(contentX + 430, cy, 16, 16);
+        if (IsPointInRect(x, y, ssdeepCheck))
+        {
+            Checksum_ToggleSsdeep();
+            InvalidateWindow();
+            return true;
+        }
+
+        Rect tlshCheck(contentX + 530, cy, 16, 16);
+        if (IsPointInRect(x, y, tlshCheck))
+        {
+            Checksum_ToggleTlsh();
+            InvalidateWindow();
+            return true;
+        }
+
         cy += 35;
 
         Rect entireFileRadio(contentX, cy, 16, 16);
@@ -787,6 +1260,72 @@ bool HandleBottomPanelContentClick(int x, int y, int windowWidth, int windowHeig
         return false;
     }
 
+    case BottomPanelState::Tab::ByteMap:
+    {
+        int cy = contentY;
+        cy += 25;
+
+        Rect imageRect = ByteMap_GetImageRect(contentX, cy, contentWidth, contentHeight - 25);
+        if (IsPointInRect(x, y, imageRect))
+        {
+            ByteMap_Activate(x, y, imageRect);
+            return true;
+        }
+
+        int cx = contentX + imageRect.width + 20;
+
+        Rect digraphRadio(cx, cy, 16, 16);
+        if (IsPointInRect(x, y, digraphRadio))
+        {
+            ByteMap_SetView(BYTEMAP_DIGRAPH);
+            InvalidateWindow();
+            return true;
+        }
+
+        Rect hilbertRadio(cx + 130, cy, 16, 16);
+        if (IsPointInRect(x, y, hilbertRadio))
+        {
+            ByteMap_SetView(BYTEMAP_HILBERT);
+            InvalidateWindow();
+            return true;
+        }
+
+        cy += 26;
+
+        Rect entireFileRadio(cx, cy, 16, 16);
+        if (IsPointInRect(x, y, entireFileRadio))
+        {
+            ByteMap_SetModeEntireFile();
+            InvalidateWindow();
+            return true;
+        }
+
+        Rect selectionRadio(cx + 130, cy, 16, 16);
+        if (IsPointInRect(x, y, selectionRadio))
+        {
+            ByteMap_SetModeSelection();
+            InvalidateWindow();
+            return true;
+        }
+
+        cy += 26;
+
+        Rect computeBtn(cx, cy, 100, 28);
+        if (IsPointInRect(x, y, computeBtn))
+        {
+            ByteMap_Compute();
+            InvalidateWindow();
+            return true;
+        }
+
+        if (IsPointInRect(x, y, bottomBounds))
+        {
+            return true;
+        }
+
+        return false;
+    }
+
     case BottomPanelState::Tab::Compare:
     {
         int cy = contentY;
@@ -847,7 +1386,7 @@ bool HandleLeftPanelContentClick(int x, int y, int windowWidth, int windowHeight
   currentY += headerHeight + sectionSpacing;
   if (cursorBytePos >= 0 && cursorBytePos < fileSize)
   {
-    currentY += (rowHeight + itemSpacing) * 5;
+    currentY += (rowHeight + itemSpacing) * DataInspector_RowCount();
     currentY += 8;
   }
   else
@@ -889,53 +1428,7 @@ bool HandleLeftPanelContentClick(int x, int y, int windowWidth, int windowHeight
     if (x >= computeRect.x && x <= computeRect.x + computeRect.width &&
       y >= computeRect.y && y <= computeRect.y + computeRect.height)
     {
-      g_ByteStats.computed = true;
-
-      for (int i = 0; i < 256; i++)
-        g_ByteStats.histogram[i] = 0;
-
-      for (size_t i = 0; i < g_HexData.getFileSize(); i++)
-      {
-        uint8_t byte = g_HexData.getByte(i);
-        g_ByteStats.histogram[byte]++;
-      }
-
-      g_ByteStats.mostCommonByte = 0;
-      g_ByteStats.mostCommonCount = g_ByteStats.histogram[0];
-      g_ByteStats.leastCommonByte = 0;
-      g_ByteStats.leastCommonCount = g_ByteStats.histogram[0];
-
-      for (int i = 1; i < 256; i++)
-      {
-        if (g_ByteStats.histogram[i] > g_ByteStats.mostCommonCount)
-        {
-          g_ByteStats.mostCommonByte = (uint8_t)i;
-          g_ByteStats.mostCommonCount = g_ByteStats.histogram[i];
-        }
-        if (g_ByteStats.histogram[i] < g_ByteStats.leastCommonCount)
-        {
-          g_ByteStats.leastCommonByte = (uint8_t)i;
-          g_ByteStats.leastCommonCount = g_ByteStats.histogram[i];
-        }
-      }
-
-      g_ByteStats.nullByteCount = g_ByteStats.histogram[0];
-
-      g_ByteStats.entropy = 0.0;
-      long long total = (long long)g_HexData.getFileSize();
-
-      if (total > 0)
-      {
-        for (int i = 0; i < 256; i++)
-        {
-          if (g_ByteStats.histogram[i] > 0)
-          {
-            double p = (double)g_ByteStats.histogram[i] / (double)total;
-            g_ByteStats.entropy -= p * fast_log2(p);
-          }
-        }
-      }
-
+      ByteStats_Compute(g_HexData);
       return true;
     }
 
@@ -1013,6 +1506,157 @@ bool HandleLeftPanelContentClick(int x, int y, int windowWidth, int windowHeight
         currentY += rowHeight + itemSpacing;
       }
     }
+
+    if (pluginAnnotations->count > 10)
+      currentY += rowHeight + itemSpacing;
+  }
+  else
+  {
+    currentY += (rowHeight + itemSpacing) * 2;
+  }
+
+  currentY += 8;
+
+  currentY += headerHeight + sectionSpacing;
+
+  StructureDecoder* structure = g_HexData.getStructure();
+  if (structure)
+  {
+    Vector<int> visible;
+    structure->getVisibleNodes(&visible);
+    int firstRow = clamp(g_StructurePanel.firstRow, 0, visible.empty() ? 0 : (int)visible.size() - 1);
+    int lastRow = firstRow + STRUCTURE_PANEL_ROWS < (int)visible.size() ? firstRow + STRUCTURE_PANEL_ROWS : (int)visible.size();
+
+    if (firstRow > 0)
+    {
+      Rect upRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (upRect.contains(x, y))
+      {
+        Structure_Scroll(-STRUCTURE_PANEL_ROWS);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+
+    for (int row = firstRow; row < lastRow; row++)
+    {
+      Rect nodeRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (nodeRect.contains(x, y))
+      {
+        Structure_Activate(visible[row]);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+
+    if (lastRow < (int)visible.size())
+    {
+      Rect downRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (downRect.contains(x, y))
+      {
+        Structure_Scroll(STRUCTURE_PANEL_ROWS);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+  }
+  else
+  {
+    currentY += rowHeight + itemSpacing;
+  }
+
+  currentY += 8;
+
+  currentY += headerHeight + sectionSpacing;
+
+  TemplateEngine* templateEngine = g_HexData.getTemplate();
+  if (templateEngine)
+  {
+    Vector<int> visible;
+    templateEngine->getVisibleNodes(&visible);
+    int firstRow = clamp(g_TemplatePanel.firstRow, 0, visible.empty() ? 0 : (int)visible.size() - 1);
+    int lastRow = firstRow + TEMPLATE_PANEL_ROWS < (int)visible.size() ? firstRow + TEMPLATE_PANEL_ROWS : (int)visible.size();
+
+    if (firstRow > 0)
+    {
+      Rect upRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (upRect.contains(x, y))
+      {
+        Template_Scroll(-TEMPLATE_PANEL_ROWS);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+
+    for (int row = firstRow; row < lastRow; row++)
+    {
+      Rect nodeRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (nodeRect.contains(x, y))
+      {
+        Template_Activate(visible[row]);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+
+    if (lastRow < (int)visible.size())
+    {
+      Rect downRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (downRect.contains(x, y))
+      {
+        Template_Scroll(TEMPLATE_PANEL_ROWS);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+  }
+  else
+  {
+    currentY += rowHeight + itemSpacing;
+  }
+
+  currentY += 8;
+
+  currentY += headerHeight + sectionSpacing;
+
+  StringIndex* strings = g_HexData.getStrings();
+  if (strings)
+  {
+    size_t count = strings->getCount();
+    size_t firstRow = g_StringsPanel.firstRow < count ? g_StringsPanel.firstRow : (count > 0 ? count - 1 : 0);
+    size_t lastRow = count - firstRow > STRINGS_PANEL_ROWS ? firstRow + STRINGS_PANEL_ROWS : count;
+
+    if (firstRow > 0)
+    {
+      Rect upRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (upRect.contains(x, y))
+      {
+        Strings_Scroll(-STRINGS_PANEL_ROWS);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+
+    for (size_t row = firstRow; row < lastRow; row++)
+    {
+      Rect stringRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (stringRect.contains(x, y))
+      {
+        Strings_Activate(row);
+        return true;
+      }
+      currentY += rowHeight + itemSpacing;
+    }
+
+    if (lastRow < count)
+    {
+      Rect downRect(contentX, currentY, contentWidth, rowHeight + itemSpacing);
+      if (downRect.contains(x, y))
+      {
+        Strings_Scroll(STRINGS_PANEL_ROWS);
+        return true;
+      }
+    }
   }
 
   return false;
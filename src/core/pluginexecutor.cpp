@@ -3,6 +3,9 @@
 #else
 #include <dlfcn.h>
 #include <cstring>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
 #endif
 
 #include "pluginexecutor.h"
@@ -59,6 +62,72 @@ static void *pythonLib = nullptr;
 #endif
 
 void GetPluginDirectory(char *outPath, int maxLen);
+static void GetPythonErrorString(char* outBuffer, int maxLen);
+
+#define MAX_PLUGIN_PROFILES 32
+
+static PluginProfile g_PluginProfiles[MAX_PLUGIN_PROFILES];
+static int g_PluginProfileCount = 0;
+
+static uint64_t GetTimeMicros()
+{
+#ifdef _WIN32
+  static LARGE_INTEGER frequency = {};
+  if (frequency.QuadPart == 0)
+    QueryPerformanceFrequency(&frequency);
+
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  uint64_t seconds = (uint64_t)(now.QuadPart / frequency.QuadPart);
+  uint64_t rest = (uint64_t)(now.QuadPart % frequency.QuadPart);
+  return seconds * 1000000 + rest * 1000000 / (uint64_t)frequency.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
+
+static PluginProfile* GetOrCreateProfile(const char* pluginPath)
+{
+  for (int i = 0; i < g_PluginProfileCount; i++)
+  {
+    if (strEquals(g_PluginProfiles[i].path, pluginPath))
+      return &g_PluginProfiles[i];
+  }
+
+  if (g_PluginProfileCount >= MAX_PLUGIN_PROFILES)
+    return nullptr;
+
+  PluginProfile* profile = &g_PluginProfiles[g_PluginProfileCount++];
+  memSet(profile, 0, sizeof(PluginProfile));
+  stringCopy(profile->path, pluginPath, sizeof(profile->path));
+  ExtractModuleName(pluginPath, profile->moduleName, sizeof(profile->moduleName));
+  return profile;
+}
+
+static void RecordPluginCall(const char* pluginPath, int entryPoint, uint64_t startMicros,
+                             size_t bytesIn, size_t results, const char* error)
+{
+  PluginProfile* profile = GetOrCreateProfile(pluginPath);
+  if (!profile || entryPoint < 0 || entryPoint >= PLUGIN_ENTRY_COUNT)
+    return;
+
+  uint64_t elapsed = GetTimeMicros() - startMicros;
+  PluginCallStats& stats = profile->entries[entryPoint];
+  stats.calls++;
+  stats.totalMicros += elapsed;
+  if (elapsed > stats.maxMicros)
+    stats.maxMicros = elapsed;
+  stats.bytesIn += bytesIn;
+  stats.results += results;
+
+  if (error)
+  {
+    stats.errors++;
+    stringCopy(profile->lastError, error[0] ? error : "Unknown Python error", sizeof(profile->lastError));
+  }
+}
 
 #ifdef _WIN32
 HMODULE LoadPythonFromRegistry()
@@ -179,7 +248,7 @@ bool InitializePythonRuntime()
 
     PyErr_Print = (PyErrPrintFunc)GetProcAddress(pythonDLL, "PyErr_Print");
     PyErr_Occurred = (PyErrOccurredFunc)GetProcAddress(pythonDLL, "PyErr_Occurred");
-    PyErr_clear = (PyErrclearFunc)GetProcAddress(pythonDLL, "PyErr_clear");
+    PyErr_clear = (PyErrclearFunc)GetProcAddress(pythonDLL, "PyErr_Clear");
 
 #else
     const char *libNames[] = {
@@ -215,7 +284,7 @@ bool InitializePythonRuntime()
 
     PyErr_Print = (PyErrPrintFunc)dlsym(pythonLib, "PyErr_Print");
     PyErr_Occurred = (PyErrOccurredFunc)dlsym(pythonLib, "PyErr_Occurred");
-    PyErr_clear = (PyErrclearFunc)dlsym(pythonLib, "PyErr_clear");
+    PyErr_clear = (PyErrclearFunc)dlsym(pythonLib, "PyErr_Clear");
 #endif
 
     if (!Py_Initialize)
@@ -303,8 +372,20 @@ bool GetPythonPluginInfo(const char *pluginPath, PluginInfo *info)
         return false;
     }
 
+    uint64_t startMicros = GetTimeMicros();
     void *pResult = PyObject_CallObject(pFunc, nullptr);
 
+    if (!pResult)
+    {
+        char error[256];
+        GetPythonErrorString(error, sizeof(error));
+        RecordPluginCall(pluginPath, PLUGIN_ENTRY_GET_INFO, startMicros, 0, 0, error);
+    }
+    else
+    {
+        RecordPluginCall(pluginPath, PLUGIN_ENTRY_GET_INFO, startMicros, 0, 1, nullptr);
+    }
+
     if (pResult && PyDict_GetItemString)
     {
         void *pName = PyDict_GetItemString(pResult, "name");
@@ -500,6 +581,127 @@ void pba_push_back(PluginBookmarkArray* arr, const PluginBookmark* bookmark) {
   arr->count++;
 }
 
+struct PluginBookmarkSortKey {
+  uint64_t offset;
+  size_t index;
+};
+
+static void SortBookmarkKeys(PluginBookmarkSortKey* keys, PluginBookmarkSortKey* scratch, size_t count) {
+  for (size_t width = 1; width < count; width *= 2) {
+    for (size_t left = 0; left < count; left += width * 2) {
+      size_t mid = left + width < count ? left + width : count;
+      size_t right = left + width * 2 < count ? left + width * 2 : count;
+      size_t i = left;
+      size_t j = mid;
+      size_t k = left;
+
+      while (i < mid && j < right)
+        scratch[k++] = keys[j].offset < keys[i].offset ? keys[j++] : keys[i++];
+      while (i < mid)
+        scratch[k++] = keys[i++];
+      while (j < right)
+        scratch[k++] = keys[j++];
+    }
+
+    memcpy(keys, scratch, count * sizeof(PluginBookmarkSortKey));
+  }
+}
+
+void pba_sort(PluginBookmarkArray* arr) {
+  size_t count = arr->count;
+  bool sorted = true;
+  for (size_t i = 1; i < count && sorted; i++) {
+    if (arr->bookmarks[i].offset < arr->bookmarks[i - 1].offset)
+      sorted = false;
+  }
+  if (sorted)
+    return;
+
+  PluginBookmarkSortKey* keys = (PluginBookmarkSortKey*)platformAlloc(
+    count * 2 * sizeof(PluginBookmarkSortKey));
+  PluginBookmark* sortedBookmarks = (PluginBookmark*)platformAlloc(
+    arr->capacity * sizeof(PluginBookmark));
+
+  if (!keys || !sortedBookmarks) {
+    if (keys)
+      platformFree(keys);
+    if (sortedBookmarks)
+      platformFree(sortedBookmarks);
+    return;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    keys[i].offset = arr->bookmarks[i].offset;
+    keys[i].index = i;
+  }
+
+  SortBookmarkKeys(keys, keys + count, count);
+
+  for (size_t i = 0; i < count; i++)
+    sortedBookmarks[i] = arr->bookmarks[keys[i].index];
+
+  platformFree(keys);
+  platformFree(arr->bookmarks);
+  arr->bookmarks = sortedBookmarks;
+}
+
+void pba_merge_tail(PluginBookmarkArray* arr, size_t sortedCount) {
+  size_t count = arr->count;
+  if (sortedCount >= count)
+    return;
+
+  size_t tailCount = count - sortedCount;
+  PluginBookmarkSortKey* keys = (PluginBookmarkSortKey*)platformAlloc(
+    tailCount * 2 * sizeof(PluginBookmarkSortKey));
+  PluginBookmark* tail = (PluginBookmark*)platformAlloc(tailCount * sizeof(PluginBookmark));
+
+  if (!keys || !tail) {
+    if (keys)
+      platformFree(keys);
+    if (tail)
+      platformFree(tail);
+    pba_sort(arr);
+    return;
+  }
+
+  for (size_t i = 0; i < tailCount; i++) {
+    keys[i].offset = arr->bookmarks[sortedCount + i].offset;
+    keys[i].index = sortedCount + i;
+  }
+
+  SortBookmarkKeys(keys, keys + tailCount, tailCount);
+
+  for (size_t i = 0; i < tailCount; i++)
+    tail[i] = arr->bookmarks[keys[i].index];
+  platformFree(keys);
+
+  // Merge from the back so only prefix entries that sort after the new batch move.
+  size_t i = sortedCount;
+  size_t j = tailCount;
+  size_t k = count;
+  while (j > 0) {
+    if (i > 0 && arr->bookmarks[i - 1].offset > tail[j - 1].offset)
+      arr->bookmarks[--k] = arr->bookmarks[--i];
+    else
+      arr->bookmarks[--k] = tail[--j];
+  }
+
+  platformFree(tail);
+}
+
+size_t pba_lower_bound(const PluginBookmarkArray* arr, uint64_t offset) {
+  size_t lo = 0;
+  size_t hi = arr->count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (arr->bookmarks[mid].offset < offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
 void pba_free(PluginBookmarkArray* arr) {
   if (arr->bookmarks) {
     platformFree(arr->bookmarks);
@@ -565,6 +767,25 @@ static void GetPythonErrorString(char* outBuffer, int maxLen)
   if (pTraceback) Py_DecRef(pTraceback);
 }
 
+static void* LookupPythonSymbol(const char* name)
+{
+#ifdef _WIN32
+  return (void*)GetProcAddress(pythonDLL, name);
+#else
+  return dlsym(pythonLib, name);
+#endif
+}
+
+static void* NewPythonNone()
+{
+  typedef void (*PyIncRefFunc)(void*);
+  void* none = LookupPythonSymbol("_Py_NoneStruct");
+  PyIncRefFunc Py_IncRef = (PyIncRefFunc)LookupPythonSymbol("Py_IncRef");
+  if (none && Py_IncRef)
+    Py_IncRef(none);
+  return none;
+}
+
 bool CanPluginGenerateBookmarks(const char* pluginPath) {
   if (!pythonInitialized) {
     if (!InitializePythonRuntime())
@@ -581,7 +802,13 @@ bool CanPluginGenerateBookmarks(const char* pluginPath) {
     return false;
   }
 
-  void* pFunc = PyObject_GetAttrString(pModule, "generate_bookmarks");
+  void* pFunc = PyObject_GetAttrString(pModule, PLUGIN_BOOKMARK_CHUNK_ENTRY);
+  if (!pFunc)
+  {
+    if (PyErr_clear)
+      PyErr_clear();
+    pFunc = PyObject_GetAttrString(pModule, "generate_bookmarks");
+  }
   bool canGenerate = (pFunc != nullptr);
 
   if (!pFunc && PyErr_clear)
@@ -596,13 +823,209 @@ bool CanPluginGenerateBookmarks(const char* pluginPath) {
   return canGenerate;
 }
 
+static void* BuildMemoryMapList(const Vector<MemoryRegion>* memoryMap)
+{
+  typedef void* (*PyListNewFunc)(long long);
+  typedef int (*PyListSetFunc)(void*, long long, void*);
+  typedef void* (*PyDictNewFunc)();
+  typedef int (*PyDictSetFunc)(void*, const char*, void*);
+
+  PyListNewFunc PyList_New = (PyListNewFunc)LookupPythonSymbol("PyList_New");
+  PyListSetFunc PyList_SetItem = (PyListSetFunc)LookupPythonSymbol("PyList_SetItem");
+  PyDictNewFunc PyDict_New = (PyDictNewFunc)LookupPythonSymbol("PyDict_New");
+  PyDictSetFunc PyDict_SetItemString = (PyDictSetFunc)LookupPythonSymbol("PyDict_SetItemString");
+
+  if (!PyList_New)
+    return NewPythonNone();
+
+  if (!memoryMap || memoryMap->size() == 0 || !PyList_SetItem || !PyDict_New || !PyDict_SetItemString)
+    return PyList_New(0);
+
+  void* pMemoryMap = PyList_New((long long)memoryMap->size());
+
+  for (size_t i = 0; i < memoryMap->size(); i++)
+  {
+    const MemoryRegion& region = (*memoryMap)[i];
+
+    void* pDict = PyDict_New();
+
+    void* pVA = PyLong_FromLongLong((long long)region.virtualAddress);
+    void* pOffset = PyLong_FromLongLong((long long)region.bufferOffset);
+    void* pRegionSize = PyLong_FromLongLong((long long)region.size);
+
+    char protection[5];
+    FormatMemoryProtection(region.protection, protection);
+
+    void* pProtection = PyUnicode_FromString(protection);
+    void* pFileOffset = PyLong_FromLongLong((long long)region.fileOffset);
+    void* pName = PyUnicode_FromString(region.name);
+
+    PyDict_SetItemString(pDict, "virtual_address", pVA);
+    PyDict_SetItemString(pDict, "buffer_offset", pOffset);
+    PyDict_SetItemString(pDict, "size", pRegionSize);
+    PyDict_SetItemString(pDict, "protection", pProtection);
+    PyDict_SetItemString(pDict, "file_offset", pFileOffset);
+    PyDict_SetItemString(pDict, "name", pName);
+
+    PyList_SetItem(pMemoryMap, (long long)i, pDict);
+
+    Py_DecRef(pVA);
+    Py_DecRef(pOffset);
+    Py_DecRef(pRegionSize);
+    Py_DecRef(pProtection);
+    Py_DecRef(pFileOffset);
+    Py_DecRef(pName);
+  }
+
+  return pMemoryMap;
+}
+
+static bool ParseBookmarkItem(void* pItem, const char* moduleName, PluginBookmark* bookmark)
+{
+  typedef long long (*PyLongAsLongLongFunc)(void*);
+  static PyLongAsLongLongFunc PyLong_AsLongLong = nullptr;
+  if (!PyLong_AsLongLong)
+    PyLong_AsLongLong = (PyLongAsLongLongFunc)LookupPythonSymbol("PyLong_AsLongLong");
+
+  void* pOffset = PyDict_GetItemString(pItem, "offset");
+  void* pLabel = PyDict_GetItemString(pItem, "label");
+  void* pDesc = PyDict_GetItemString(pItem, "description");
+
+  if (!pOffset || !pLabel)
+    return false;
+
+  memSet(bookmark, 0, sizeof(PluginBookmark));
+
+  if (PyLong_AsLongLong) {
+    bookmark->offset = (uint64_t)PyLong_AsLongLong(pOffset);
+  }
+
+  if (PyUnicode_AsUTF8) {
+    char* label = PyUnicode_AsUTF8(pLabel);
+    if (label)
+      stringCopy(bookmark->label, label, sizeof(bookmark->label));
+  }
+
+  if (pDesc && PyUnicode_AsUTF8) {
+    char* desc = PyUnicode_AsUTF8(pDesc);
+    if (desc)
+      stringCopy(bookmark->description, desc, sizeof(bookmark->description));
+  }
+
+  void* pColor = PyDict_GetItemString(pItem, "color");
+  if (pColor) {
+    void* pR = PyDict_GetItemString(pColor, "r");
+    void* pG = PyDict_GetItemString(pColor, "g");
+    void* pB = PyDict_GetItemString(pColor, "b");
+
+    if (pR && pG && pB && PyLong_AsLongLong) {
+      bookmark->color.r = (uint8_t)PyLong_AsLongLong(pR);
+      bookmark->color.g = (uint8_t)PyLong_AsLongLong(pG);
+      bookmark->color.b = (uint8_t)PyLong_AsLongLong(pB);
+    }
+  }
+
+  stringCopy(bookmark->pluginSource, moduleName, sizeof(bookmark->pluginSource));
+  return true;
+}
+
+enum BookmarkConsumeResult
+{
+  BOOKMARKS_CONSUMED,
+  BOOKMARKS_CANCELLED,
+  BOOKMARKS_FAILED
+};
+
+static BookmarkConsumeResult ConsumeBookmarkIterable(
+  void* pIterable,
+  const char* moduleName,
+  PluginBookmarkArray* outBookmarks,
+  PluginProgressCallback progress,
+  void* userData,
+  uint64_t bytesDone,
+  uint64_t bytesTotal)
+{
+  typedef void* (*PyGetIterFunc)(void*);
+  typedef void* (*PyIterNextFunc)(void*);
+  PyGetIterFunc PyObject_GetIter = (PyGetIterFunc)LookupPythonSymbol("PyObject_GetIter");
+  PyIterNextFunc PyIter_Next = (PyIterNextFunc)LookupPythonSymbol("PyIter_Next");
+
+  if (!PyObject_GetIter || !PyIter_Next)
+    return BOOKMARKS_FAILED;
+
+  void* pIter = PyObject_GetIter(pIterable);
+  if (!pIter)
+    return BOOKMARKS_FAILED;
+
+  size_t sinceReport = 0;
+  void* pItem = nullptr;
+
+  while ((pItem = PyIter_Next(pIter)) != nullptr)
+  {
+    PluginBookmark bookmark;
+    if (ParseBookmarkItem(pItem, moduleName, &bookmark))
+    {
+      pba_push_back(outBookmarks, &bookmark);
+      sinceReport++;
+    }
+    Py_DecRef(pItem);
+
+    if (progress && sinceReport >= PLUGIN_BOOKMARK_REPORT_INTERVAL)
+    {
+      sinceReport = 0;
+      if (!progress(userData, outBookmarks->count, bytesDone, bytesTotal))
+      {
+        Py_DecRef(pIter);
+        return BOOKMARKS_CANCELLED;
+      }
+    }
+  }
+
+  Py_DecRef(pIter);
+
+  if (PyErr_Occurred && PyErr_Occurred())
+    return BOOKMARKS_FAILED;
+
+  return BOOKMARKS_CONSUMED;
+}
+
+static const uint8_t* GetPluginViewBytes(const PluginDataView* view, uint64_t offset, size_t length,
+                                         uint8_t** buffer, size_t* bufferSize)
+{
+  if (view->data)
+    return view->data + offset;
+
+  if (!view->read)
+    return nullptr;
+
+  if (*bufferSize < length)
+  {
+    if (*buffer)
+      platformFree(*buffer, *bufferSize);
+    *buffer = (uint8_t*)platformAlloc(length);
+    *bufferSize = *buffer ? length : 0;
+    if (!*buffer)
+      return nullptr;
+  }
+
+  if (view->read(view->context, offset, *buffer, length) != length)
+    return nullptr;
+
+  return *buffer;
+}
+
 bool ExecutePluginBookmarks(
   const char* pluginPath,
-  const uint8_t* data,
-  size_t dataSize,
+  const PluginDataView* view,
   PluginBookmarkArray* outBookmarks,
-  const Vector<MemoryRegion>* memoryMap)
+  const Vector<MemoryRegion>* memoryMap,
+  PluginProgressCallback progress,
+  void* userData,
+  bool* outCancelled)
 {
+  if (outCancelled)
+    *outCancelled = false;
+
   if (!pythonInitialized) {
     if (!InitializePythonRuntime())
       return false;
@@ -618,7 +1041,15 @@ bool ExecutePluginBookmarks(
     return false;
   }
 
-  void* pFunc = PyObject_GetAttrString(pModule, "generate_bookmarks");
+  bool chunked = true;
+  void* pFunc = PyObject_GetAttrString(pModule, PLUGIN_BOOKMARK_CHUNK_ENTRY);
+  if (!pFunc) {
+    if (PyErr_clear)
+      PyErr_clear();
+    chunked = false;
+    pFunc = PyObject_GetAttrString(pModule, "generate_bookmarks");
+  }
+
   if (!pFunc) {
     if (PyErr_clear)
       PyErr_clear();
@@ -626,164 +1057,147 @@ bool ExecutePluginBookmarks(
     return false;
   }
 
-  typedef void* (*PyListNewFunc)(long long);
-  typedef int (*PyListSetFunc)(void*, long long, void*);
-  typedef void* (*PyDictNewFunc)();
-  typedef int (*PyDictSetFunc)(void*, const char*, void*);
-
-#ifdef _WIN32
-  PyListNewFunc PyList_New = (PyListNewFunc)GetProcAddress(pythonDLL, "PyList_New");
-  PyListSetFunc PyList_SetItem = (PyListSetFunc)GetProcAddress(pythonDLL, "PyList_SetItem");
-  PyDictNewFunc PyDict_New = (PyDictNewFunc)GetProcAddress(pythonDLL, "PyDict_New");
-  PyDictSetFunc PyDict_SetItemString = (PyDictSetFunc)GetProcAddress(pythonDLL, "PyDict_SetItemString");
-#else
-  PyListNewFunc PyList_New = (PyListNewFunc)dlsym(pythonLib, "PyList_New");
-  PyListSetFunc PyList_SetItem = (PyListSetFunc)dlsym(pythonLib, "PyList_SetItem");
-  PyDictNewFunc PyDict_New = (PyDictNewFunc)dlsym(pythonLib, "PyDict_New");
-  PyDictSetFunc PyDict_SetItemString = (PyDictSetFunc)dlsym(pythonLib, "PyDict_SetItemString");
-#endif
-
-  void* pArgs = PyTuple_New(3);
-
-  void* pData = PyBytes_FromStringAndSize((const char*)data, (long long)dataSize);
-  PyTuple_SetItem(pArgs, 0, pData);
+  size_t dataSize = (size_t)view->size;
+  uint8_t* readBuffer = nullptr;
+  size_t readBufferSize = 0;
 
-  void* pSize = PyLong_FromLongLong((long long)dataSize);
-  PyTuple_SetItem(pArgs, 1, pSize);
+  if (!chunked && !view->data && dataSize > PLUGIN_BOOKMARK_MAX_WHOLE_READ)
+  {
+    RecordPluginCall(pluginPath, PLUGIN_ENTRY_GENERATE_BOOKMARKS, GetTimeMicros(), 0, 0,
+                     "Source too large for generate_bookmarks; implement " PLUGIN_BOOKMARK_CHUNK_ENTRY);
+    Py_DecRef(pFunc);
+    Py_DecRef(pModule);
+    return false;
+  }
 
-  void* pMemoryMap = nullptr;
+  void* pMemoryMap = BuildMemoryMapList(memoryMap);
+  size_t firstBookmark = outBookmarks->count;
+  uint64_t startMicros = GetTimeMicros();
+  BookmarkConsumeResult result = BOOKMARKS_CONSUMED;
 
-  if (memoryMap && memoryMap->size() > 0 && PyList_New && PyList_SetItem && PyDict_New && PyDict_SetItemString)
+  if (!chunked)
   {
-    pMemoryMap = PyList_New((long long)memoryMap->size());
+    const uint8_t* data = GetPluginViewBytes(view, 0, dataSize, &readBuffer, &readBufferSize);
+    void* pResult = nullptr;
 
-    for (size_t i = 0; i < memoryMap->size(); i++)
+    if (data)
     {
-      const MemoryRegion& region = (*memoryMap)[i];
-
-      void* pDict = PyDict_New();
-
-      void* pVA = PyLong_FromLongLong((long long)region.virtualAddress);
-      void* pOffset = PyLong_FromLongLong((long long)region.bufferOffset);
-      void* pRegionSize = PyLong_FromLongLong((long long)region.size);
-
-      PyDict_SetItemString(pDict, "virtual_address", pVA);
-      PyDict_SetItemString(pDict, "buffer_offset", pOffset);
-      PyDict_SetItemString(pDict, "size", pRegionSize);
-
-      PyList_SetItem(pMemoryMap, (long long)i, pDict);
+      void* pArgs = PyTuple_New(3);
+      PyTuple_SetItem(pArgs, 0, PyBytes_FromStringAndSize((const char*)data, (long long)dataSize));
+      PyTuple_SetItem(pArgs, 1, PyLong_FromLongLong((long long)dataSize));
+      PyTuple_SetItem(pArgs, 2, pMemoryMap);
+      pMemoryMap = nullptr;
+
+      pResult = PyObject_CallObject(pFunc, pArgs);
+      Py_DecRef(pArgs);
+    }
 
-      Py_DecRef(pVA);
-      Py_DecRef(pOffset);
-      Py_DecRef(pRegionSize);
+    if (!pResult)
+    {
+      result = BOOKMARKS_FAILED;
     }
-  }
-  else if (PyList_New)
-  {
-    pMemoryMap = PyList_New(0);
-  }
-  else
-  {
-    typedef void* (*PyNoneFunc)();
-#ifdef _WIN32
-    PyNoneFunc Py_None_Func = (PyNoneFunc)GetProcAddress(pythonDLL, "_Py_NoneStruct");
-#else
-    PyNoneFunc Py_None_Func = (PyNoneFunc)dlsym(pythonLib, "_Py_NoneStruct");
-#endif
-    if (Py_None_Func)
+    else
     {
-      pMemoryMap = Py_None_Func();
-      typedef void (*PyIncRefFunc)(void*);
-#ifdef _WIN32
-      PyIncRefFunc Py_IncRef = (PyIncRefFunc)GetProcAddress(pythonDLL, "Py_IncRef");
-#else
-      PyIncRefFunc Py_IncRef = (PyIncRefFunc)dlsym(pythonLib, "Py_IncRef");
-#endif
-      if (Py_IncRef)
-        Py_IncRef(pMemoryMap);
+      result = ConsumeBookmarkIterable(pResult, moduleName, outBookmarks,
+                                       progress, userData, 0, dataSize);
+      Py_DecRef(pResult);
     }
   }
-
-  PyTuple_SetItem(pArgs, 2, pMemoryMap);
-  void* pResult = PyObject_CallObject(pFunc, pArgs);
-
-  if (!pResult)
+  else
   {
-    if (PyErr_clear)
-      PyErr_clear();
-
-    Py_DecRef(pArgs);
-    Py_DecRef(pFunc);
-    Py_DecRef(pModule);
-    return false;
-  }
+    typedef void* (*PyTupleGetFunc)(void*, long long);
+    typedef long long (*PyTupleSizeFunc)(void*);
+    typedef void (*PyIncRefFunc)(void*);
+    PyTupleGetFunc PyTuple_GetItem = (PyTupleGetFunc)LookupPythonSymbol("PyTuple_GetItem");
+    PyTupleSizeFunc PyTuple_Size = (PyTupleSizeFunc)LookupPythonSymbol("PyTuple_Size");
+    PyIncRefFunc Py_IncRef = (PyIncRefFunc)LookupPythonSymbol("Py_IncRef");
 
-  bool success = false;
+    void* pState = NewPythonNone();
+    size_t offset = 0;
 
-  if (pResult && PyList_Size) {
-    long long listSize = PyList_Size(pResult);
-    for (long long i = 0; i < listSize; i++) {
-      void* pItem = PyList_GetItem(pResult, i);
+    if (!PyTuple_GetItem || !PyTuple_Size || !Py_IncRef || !pState)
+      result = BOOKMARKS_FAILED;
 
-      void* pOffset = PyDict_GetItemString(pItem, "offset");
-      void* pLabel = PyDict_GetItemString(pItem, "label");
-      void* pDesc = PyDict_GetItemString(pItem, "description");
+    while (result == BOOKMARKS_CONSUMED && offset < dataSize)
+    {
+      size_t chunkSize = dataSize - offset;
+      if (chunkSize > PLUGIN_BOOKMARK_CHUNK_SIZE)
+        chunkSize = PLUGIN_BOOKMARK_CHUNK_SIZE;
 
-      if (pOffset && pLabel) {
-        PluginBookmark bookmark;
-        memSet(&bookmark, 0, sizeof(PluginBookmark));
+      const uint8_t* chunk = GetPluginViewBytes(view, offset, chunkSize, &readBuffer, &readBufferSize);
+      if (!chunk)
+      {
+        result = BOOKMARKS_FAILED;
+        break;
+      }
 
-        typedef long long (*PyLongAsLongLongFunc)(void*);
-#ifdef _WIN32
-        PyLongAsLongLongFunc PyLong_AsLongLong =
-          (PyLongAsLongLongFunc)GetProcAddress(pythonDLL, "PyLong_AsLongLong");
-#else
-        PyLongAsLongLongFunc PyLong_AsLongLong =
-          (PyLongAsLongLongFunc)dlsym(pythonLib, "PyLong_AsLongLong");
-#endif
+      void* pArgs = PyTuple_New(5);
+      PyTuple_SetItem(pArgs, 0, PyBytes_FromStringAndSize((const char*)chunk, (long long)chunkSize));
+      PyTuple_SetItem(pArgs, 1, PyLong_FromLongLong((long long)offset));
+      PyTuple_SetItem(pArgs, 2, PyLong_FromLongLong((long long)dataSize));
+      PyTuple_SetItem(pArgs, 3, pState);
+      Py_IncRef(pMemoryMap);
+      PyTuple_SetItem(pArgs, 4, pMemoryMap);
+      pState = nullptr;
 
-        if (PyLong_AsLongLong) {
-          bookmark.offset = (uint64_t)PyLong_AsLongLong(pOffset);
-        }
+      void* pResult = PyObject_CallObject(pFunc, pArgs);
+      Py_DecRef(pArgs);
 
-        if (PyUnicode_AsUTF8) {
-          char* label = PyUnicode_AsUTF8(pLabel);
-          if (label)
-            strCopy(bookmark.label, label);
-        }
+      if (!pResult || PyTuple_Size(pResult) != 2)
+      {
+        if (pResult)
+          Py_DecRef(pResult);
+        result = BOOKMARKS_FAILED;
+        break;
+      }
 
-        if (pDesc && PyUnicode_AsUTF8) {
-          char* desc = PyUnicode_AsUTF8(pDesc);
-          if (desc)
-            strCopy(bookmark.description, desc);
-        }
+      pState = PyTuple_GetItem(pResult, 1);
+      Py_IncRef(pState);
 
-        void* pColor = PyDict_GetItemString(pItem, "color");
-        if (pColor && PyDict_GetItemString) {
-          void* pR = PyDict_GetItemString(pColor, "r");
-          void* pG = PyDict_GetItemString(pColor, "g");
-          void* pB = PyDict_GetItemString(pColor, "b");
-
-          if (pR && pG && pB && PyLong_AsLongLong) {
-            bookmark.color.r = (uint8_t)PyLong_AsLongLong(pR);
-            bookmark.color.g = (uint8_t)PyLong_AsLongLong(pG);
-            bookmark.color.b = (uint8_t)PyLong_AsLongLong(pB);
-          }
-        }
+      offset += chunkSize;
+      result = ConsumeBookmarkIterable(PyTuple_GetItem(pResult, 0), moduleName, outBookmarks,
+                                       progress, userData, offset, dataSize);
+      Py_DecRef(pResult);
 
-        strCopy(bookmark.pluginSource, moduleName);
-        pba_push_back(outBookmarks, &bookmark);
-        success = true;
+      if (result == BOOKMARKS_CONSUMED && progress &&
+          !progress(userData, outBookmarks->count, offset, dataSize))
+      {
+        result = BOOKMARKS_CANCELLED;
       }
     }
 
-    Py_DecRef(pResult);
+    if (pState)
+      Py_DecRef(pState);
   }
 
-  Py_DecRef(pArgs);
+  if (pMemoryMap)
+    Py_DecRef(pMemoryMap);
+
+  if (readBuffer)
+    platformFree(readBuffer, readBufferSize);
+
+  if (result == BOOKMARKS_FAILED)
+  {
+    char error[256];
+    GetPythonErrorString(error, sizeof(error));
+    RecordPluginCall(pluginPath, PLUGIN_ENTRY_GENERATE_BOOKMARKS, startMicros, dataSize,
+                     outBookmarks->count - firstBookmark, error);
+
+    if (PyErr_clear)
+      PyErr_clear();
+  }
+  else
+  {
+    RecordPluginCall(pluginPath, PLUGIN_ENTRY_GENERATE_BOOKMARKS, startMicros, dataSize,
+                     outBookmarks->count - firstBookmark, nullptr);
+  }
+
+  if (outCancelled)
+    *outCancelled = (result == BOOKMARKS_CANCELLED);
+
   Py_DecRef(pFunc);
   Py_DecRef(pModule);
-  return success;
+  return result == BOOKMARKS_CONSUMED;
 }
 
 bool ExecutePythonDisassembly(
@@ -842,8 +1256,17 @@ bool ExecutePythonDisassembly(
     void *pMaxInst = PyLong_FromLongLong((long long)dataSize);
     PyTuple_SetItem(pArgs, 3, pMaxInst);
 
+    uint64_t startMicros = GetTimeMicros();
+    size_t firstLine = outLines->count;
     void *pResult = PyObject_CallObject(cachedFunc, pArgs);
 
+    if (!pResult)
+    {
+        char error[256];
+        GetPythonErrorString(error, sizeof(error));
+        RecordPluginCall(pluginPath, PLUGIN_ENTRY_DISASSEMBLE, startMicros, dataSize, 0, error);
+    }
+
     if (pResult && PyList_Size)
     {
         long long listSize = PyList_Size(pResult);
@@ -876,6 +1299,8 @@ bool ExecutePythonDisassembly(
         }
 
         Py_DecRef(pResult);
+        RecordPluginCall(pluginPath, PLUGIN_ENTRY_DISASSEMBLE, startMicros, dataSize,
+                         outLines->count - firstLine, nullptr);
     }
 
     Py_DecRef(pArgs);
@@ -883,3 +1308,266 @@ bool ExecutePythonDisassembly(
 
     return outLines->count > 0;
 }
+
+bool ExecutePluginTransform(
+    const char* pluginPath,
+    const uint8_t* data,
+    size_t length,
+    uint64_t position,
+    ByteBuffer* outData,
+    char* outError,
+    size_t errorMax)
+{
+    if (outError && errorMax > 0)
+        outError[0] = '\0';
+
+    if (!pythonInitialized)
+    {
+        if (!InitializePythonRuntime())
+        {
+            stringCopy(outError, "Python runtime is not available", (int)errorMax);
+            return false;
+        }
+    }
+
+    typedef int (*PyBytesAsStringAndSizeFunc)(void*, char**, long long*);
+    PyBytesAsStringAndSizeFunc PyBytes_AsStringAndSize =
+        (PyBytesAsStringAndSizeFunc)LookupPythonSymbol("PyBytes_AsStringAndSize");
+    if (!PyBytes_AsStringAndSize)
+    {
+        stringCopy(outError, "Python runtime lacks PyBytes_AsStringAndSize", (int)errorMax);
+        return false;
+    }
+
+    char moduleName[256];
+    ExtractModuleName(pluginPath, moduleName, 256);
+
+    void* pModule = PyImport_ImportModule(moduleName);
+    if (!pModule)
+    {
+        GetPythonErrorString(outError, (int)errorMax);
+        return false;
+    }
+
+    void* pFunc = PyObject_GetAttrString(pModule, "transform");
+    if (!pFunc)
+    {
+        GetPythonErrorString(outError, (int)errorMax);
+        Py_DecRef(pModule);
+        return false;
+    }
+
+    void* pArgs = PyTuple_New(2);
+    PyTuple_SetItem(pArgs, 0, PyBytes_FromStringAndSize((const char*)data, (long long)length));
+    PyTuple_SetItem(pArgs, 1, PyLong_FromLongLong((long long)position));
+
+    uint64_t startMicros = GetTimeMicros();
+    void* pResult = PyObject_CallObject(pFunc, pArgs);
+    Py_DecRef(pArgs);
+
+    bool ok = false;
+    if (pResult)
+    {
+        char* bytes = nullptr;
+        long long size = 0;
+        if (PyBytes_AsStringAndSize(pResult, &bytes, &size) == 0 && size >= 0 &&
+            bb_resize(outData, (size_t)size))
+        {
+            if (size > 0)
+                memCopy(outData->data, bytes, (size_t)size);
+            ok = true;
+        }
+        Py_DecRef(pResult);
+    }
+
+    if (!ok)
+    {
+        char error[256];
+        GetPythonErrorString(error, sizeof(error));
+        if (!error[0])
+            stringCopy(error, "transform() must return bytes", sizeof(error));
+        stringCopy(outError, error, (int)errorMax);
+        RecordPluginCall(pluginPath, PLUGIN_ENTRY_TRANSFORM, startMicros, length, 0, error);
+    }
+    else
+    {
+        RecordPluginCall(pluginPath, PLUGIN_ENTRY_TRANSFORM, startMicros, length, outData->size, nullptr);
+    }
+
+    Py_DecRef(pFunc);
+    Py_DecRef(pModule);
+    return ok;
+}
+
+int GetPluginProfileCount()
+{
+    return g_PluginProfileCount;
+}
+
+const PluginProfile* GetPluginProfileAt(int index)
+{
+    if (index < 0 || index >= g_PluginProfileCount)
+        return nullptr;
+    return &g_PluginProfiles[index];
+}
+
+const PluginProfile* FindPluginProfile(const char* pluginPath)
+{
+    if (!pluginPath)
+        return nullptr;
+
+    for (int i = 0; i < g_PluginProfileCount; i++)
+    {
+        if (strEquals(g_PluginProfiles[i].path, pluginPath))
+            return &g_PluginProfiles[i];
+    }
+    return nullptr;
+}
+
+void GetPluginProfileTotals(const PluginProfile* profile, PluginCallStats* outTotals)
+{
+    memSet(outTotals, 0, sizeof(PluginCallStats));
+    if (!profile)
+        return;
+
+    for (int i = 0; i < PLUGIN_ENTRY_COUNT; i++)
+    {
+        const PluginCallStats& stats = profile->entries[i];
+        outTotals->calls += stats.calls;
+        outTotals->totalMicros += stats.totalMicros;
+        if (stats.maxMicros > outTotals->maxMicros)
+            outTotals->maxMicros = stats.maxMicros;
+        outTotals->bytesIn += stats.bytesIn;
+        outTotals->results += stats.results;
+        outTotals->errors += stats.errors;
+    }
+}
+
+const char* GetPluginEntryPointName(int entryPoint)
+{
+    switch (entryPoint)
+    {
+    case PLUGIN_ENTRY_GET_INFO:
+        return "get_info";
+    case PLUGIN_ENTRY_DISASSEMBLE:
+        return "disassemble";
+    case PLUGIN_ENTRY_GENERATE_BOOKMARKS:
+        return "generate_bookmarks";
+    case PLUGIN_ENTRY_TRANSFORM:
+        return "transform";
+    }
+    return "unknown";
+}
+
+void ResetPluginProfiles()
+{
+    g_PluginProfileCount = 0;
+}
+
+static void AppendJsonString(SimpleString* out, const char* value)
+{
+    ss_append_char(out, '"');
+    for (const char* p = value; *p; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\')
+        {
+            ss_append_char(out, '\\');
+            ss_append_char(out, (char)c);
+        }
+        else if (c < 0x20)
+        {
+            ss_append_cstr(out, "\\u00");
+            ss_append_hex2(out, c);
+        }
+        else
+        {
+            ss_append_char(out, (char)c);
+        }
+    }
+    ss_append_char(out, '"');
+}
+
+static void AppendJsonNumber(SimpleString* out, const char* key, uint64_t value, bool last)
+{
+    char number[32];
+    itoaDec((long long)value, number, sizeof(number));
+    ss_append_char(out, '"');
+    ss_append_cstr(out, key);
+    ss_append_cstr(out, "\": ");
+    ss_append_cstr(out, number);
+    ss_append_cstr(out, last ? "" : ", ");
+}
+
+bool ExportPluginProfiles(const char* outputPath)
+{
+    if (!outputPath || !outputPath[0])
+        return false;
+
+    SimpleString json;
+    ss_init(&json);
+    ss_append_cstr(&json, "{\n  \"plugins\": [");
+
+    for (int i = 0; i < g_PluginProfileCount; i++)
+    {
+        const PluginProfile& profile = g_PluginProfiles[i];
+
+        ss_append_cstr(&json, i == 0 ? "\n    {\n" : ",\n    {\n");
+        ss_append_cstr(&json, "      \"name\": ");
+        AppendJsonString(&json, profile.moduleName);
+        ss_append_cstr(&json, ",\n      \"path\": ");
+        AppendJsonString(&json, profile.path);
+        ss_append_cstr(&json, ",\n      \"last_error\": ");
+        AppendJsonString(&json, profile.lastError);
+        ss_append_cstr(&json, ",\n      \"entry_points\": {");
+
+        for (int e = 0; e < PLUGIN_ENTRY_COUNT; e++)
+        {
+            const PluginCallStats& stats = profile.entries[e];
+            ss_append_cstr(&json, e == 0 ? "\n        " : ",\n        ");
+            AppendJsonString(&json, GetPluginEntryPointName(e));
+            ss_append_cstr(&json, ": { ");
+            AppendJsonNumber(&json, "calls", stats.calls, false);
+            AppendJsonNumber(&json, "total_us", stats.totalMicros, false);
+            AppendJsonNumber(&json, "max_us", stats.maxMicros, false);
+            AppendJsonNumber(&json, "bytes_in", stats.bytesIn, false);
+            AppendJsonNumber(&json, "results", stats.results, false);
+            AppendJsonNumber(&json, "errors", stats.errors, true);
+            ss_append_cstr(&json, " }");
+        }
+
+        ss_append_cstr(&json, "\n      }\n    }");
+    }
+
+    ss_append_cstr(&json, g_PluginProfileCount > 0 ? "\n  ]\n}\n" : "]\n}\n");
+
+    bool ok = false;
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(outputPath, GENERIC_WRITE, 0, nullptr,
+                               CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        DWORD written = 0;
+        ok = WriteFile(hFile, json.data, (DWORD)json.length, &written, nullptr) && written == json.length;
+        CloseHandle(hFile);
+    }
+#else
+    int fd = open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0)
+    {
+        size_t total = 0;
+        while (total < json.length)
+        {
+            ssize_t w = write(fd, json.data + total, json.length - total);
+            if (w <= 0)
+                break;
+            total += (size_t)w;
+        }
+        ok = total == json.length;
+        close(fd);
+    }
+#endif
+
+    ss_free(&json);
+    return ok;
+}
@@ -0,0 +1,998 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "pluginresultcache.h"
+#include "plugintypes.h"
+#include "options.h"
+
+#define PLUGIN_CACHE_MAGIC 0x43505648u
+#define PLUGIN_CACHE_VERSION 1
+#define PLUGIN_CACHE_ENTRY_HEADER 40
+#define PLUGIN_CACHE_MAX_STAMPS 32
+
+static const uint64_t PRIME64_1 = 11400714785074694791ULL;
+static const uint64_t PRIME64_2 = 14029467366897019727ULL;
+static const uint64_t PRIME64_3 = 1609587929392839161ULL;
+static const uint64_t PRIME64_4 = 9650029242287828579ULL;
+static const uint64_t PRIME64_5 = 2870177450012600261ULL;
+
+struct CacheEntry
+{
+  uint64_t key;
+  uint64_t contentHash;
+  uint64_t contentSize;
+  uint64_t lastUsed;
+  uint32_t kind;
+  uint32_t payloadSize;
+  uint8_t* payload;
+};
+
+struct PluginStamp
+{
+  char path[512];
+  uint64_t fileSize;
+  uint64_t fileTime;
+  uint64_t versionHash;
+};
+
+static Vector<CacheEntry> g_CacheEntries;
+static int* g_CacheIndex = nullptr;
+static size_t g_CacheIndexCapacity = 0;
+static uint64_t g_CacheClock = 0;
+static size_t g_CacheUsage = 0;
+static size_t g_CacheBudget = PLUGIN_CACHE_DEFAULT_BUDGET;
+static bool g_CacheLoaded = false;
+static bool g_CacheDirty = false;
+static bool g_CacheRewrite = true;
+static size_t g_CacheFlushedCount = 0;
+static uint64_t g_CacheFileEnd = 0;
+
+static PluginStamp g_PluginStamps[PLUGIN_CACHE_MAX_STAMPS];
+static int g_PluginStampCount = 0;
+
+static inline uint64_t Rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t Read64(const uint8_t* p)
+{
+  return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+         ((uint64_t)p[3] << 24) | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) |
+         ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+static inline uint32_t Read32(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t HashRound(uint64_t acc, uint64_t input)
+{
+  acc += input * PRIME64_2;
+  acc = Rotl64(acc, 31);
+  return acc * PRIME64_1;
+}
+
+static inline uint64_t HashMerge(uint64_t acc, uint64_t val)
+{
+  acc ^= HashRound(0, val);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+static uint64_t Hash64(const uint8_t* data, size_t size, uint64_t seed)
+{
+  const uint8_t* p = data;
+  const uint8_t* end = data + size;
+  uint64_t h;
+
+  if (size >= 32)
+  {
+    uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+    uint64_t v2 = seed + PRIME64_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME64_1;
+    const uint8_t* limit = end - 32;
+
+    do
+    {
+      v1 = HashRound(v1, Read64(p));
+      v2 = HashRound(v2, Read64(p + 8));
+      v3 = HashRound(v3, Read64(p + 16));
+      v4 = HashRound(v4, Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+    h = HashMerge(h, v1);
+    h = HashMerge(h, v2);
+    h = HashMerge(h, v3);
+    h = HashMerge(h, v4);
+  }
+  else
+  {
+    h = seed + PRIME64_5;
+  }
+
+  h += (uint64_t)size;
+
+  while (p + 8 <= end)
+  {
+    h ^= HashRound(0, Read64(p));
+    h = Rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    p += 8;
+  }
+
+  if (p + 4 <= end)
+  {
+    h ^= (uint64_t)Read32(p) * PRIME64_1;
+    h = Rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+
+  while (p < end)
+  {
+    h ^= (uint64_t)(*p) * PRIME64_5;
+    h = Rotl64(h, 11) * PRIME64_1;
+    p++;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+uint64_t PluginCache_HashContent(const uint8_t* data, size_t size)
+{
+  if (!data)
+    return 0;
+  return Hash64(data, size, 0);
+}
+
+static bool GetPluginFileStamp(const char* path, uint64_t* outSize, uint64_t* outTime)
+{
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA attr;
+  if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attr))
+    return false;
+  *outSize = ((uint64_t)attr.nFileSizeHigh << 32) | attr.nFileSizeLow;
+  *outTime = ((uint64_t)attr.ftLastWriteTime.dwHighDateTime << 32) | attr.ftLastWriteTime.dwLowDateTime;
+  return true;
+#else
+  struct stat st;
+  if (stat(path, &st) != 0)
+    return false;
+  *outSize = (uint64_t)st.st_size;
+  *outTime = (uint64_t)st.st_mtime;
+  return true;
+#endif
+}
+
+static uint64_t GetPluginVersionHash(const char* pluginPath)
+{
+  uint64_t fileSize = 0;
+  uint64_t fileTime = 0;
+  GetPluginFileStamp(pluginPath, &fileSize, &fileTime);
+
+  PluginStamp* stamp = nullptr;
+  for (int i = 0; i < g_PluginStampCount; i++)
+  {
+    if (strEquals(g_PluginStamps[i].path, pluginPath))
+    {
+      stamp = &g_PluginStamps[i];
+      break;
+    }
+  }
+
+  if (stamp && stamp->fileSize == fileSize && stamp->fileTime == fileTime)
+    return stamp->versionHash;
+
+  if (!stamp)
+  {
+    int slot = g_PluginStampCount < PLUGIN_CACHE_MAX_STAMPS ? g_PluginStampCount++ : PLUGIN_CACHE_MAX_STAMPS - 1;
+    stamp = &g_PluginStamps[slot];
+    stringCopy(stamp->path, pluginPath, 512);
+  }
+
+  PluginInfo info;
+  memSet(&info, 0, sizeof(info));
+  GetPythonPluginInfo(pluginPath, &info);
+
+  uint64_t h = Hash64((const uint8_t*)info.version, strLen(info.version), fileSize);
+  h = Hash64((const uint8_t*)&fileTime, sizeof(fileTime), h);
+
+  stamp->fileSize = fileSize;
+  stamp->fileTime = fileTime;
+  stamp->versionHash = h;
+  return h;
+}
+
+static uint64_t MakeEntryKey(const PluginCacheKey* key, uint32_t kind, uint64_t offset, uint64_t size)
+{
+  uint64_t h = Hash64((const uint8_t*)key->pluginPath, strLen(key->pluginPath), key->contentHash);
+  uint64_t parts[5];
+  parts[0] = key->contentSize;
+  parts[1] = GetPluginVersionHash(key->pluginPath);
+  parts[2] = kind;
+  parts[3] = offset;
+  parts[4] = size;
+  return Hash64((const uint8_t*)parts, sizeof(parts), h);
+}
+
+static void RebuildIndex()
+{
+  size_t needed = 64;
+  while (needed < g_CacheEntries.size() * 2)
+    needed *= 2;
+
+  if (needed != g_CacheIndexCapacity)
+  {
+    if (g_CacheIndex)
+      platformFree(g_CacheIndex, g_CacheIndexCapacity * sizeof(int));
+    g_CacheIndex = (int*)platformAlloc(needed * sizeof(int));
+    g_CacheIndexCapacity = needed;
+  }
+
+  for (size_t i = 0; i < g_CacheIndexCapacity; i++)
+    g_CacheIndex[i] = -1;
+
+  size_t mask = g_CacheIndexCapacity - 1;
+  for (size_t i = 0; i < g_CacheEntries.size(); i++)
+  {
+    size_t slot = (size_t)g_CacheEntries[i].key & mask;
+    while (g_CacheIndex[slot] >= 0)
+      slot = (slot + 1) & mask;
+    g_CacheIndex[slot] = (int)i;
+  }
+}
+
+static CacheEntry* FindEntry(uint64_t key)
+{
+  if (!g_CacheIndex)
+    return nullptr;
+
+  size_t mask = g_CacheIndexCapacity - 1;
+  size_t slot = (size_t)key & mask;
+  while (g_CacheIndex[slot] >= 0)
+  {
+    CacheEntry& entry = g_CacheEntries[g_CacheIndex[slot]];
+    if (entry.key == key)
+      return &entry;
+    slot = (slot + 1) & mask;
+  }
+  return nullptr;
+}
+
+static void GetCacheFilePath(char* outPath, int maxLen)
+{
+  GetConfigPath(outPath, maxLen);
+
+  int lastSlash = -1;
+  for (int i = 0; outPath[i]; i++)
+  {
+    if (outPath[i] == '\\' || outPath[i] == '/')
+      lastSlash = i;
+  }
+
+  int start = lastSlash + 1;
+  if (start + (int)sizeof(PLUGIN_CACHE_FILE_NAME) >= maxLen)
+  {
+    outPath[0] = '\0';
+    return;
+  }
+  strCopy(outPath + start, PLUGIN_CACHE_FILE_NAME);
+}
+
+static void EnsureCacheDirectory(const char* filePath)
+{
+  char dir[512];
+  stringCopy(dir, filePath, 512);
+
+  char* slash = nullptr;
+  for (char* p = dir; *p; p++)
+  {
+    if (*p == '\\' || *p == '/')
+      slash = p;
+  }
+  if (!slash)
+    return;
+  *slash = '\0';
+
+#ifdef _WIN32
+  CreateDirectoryA(dir, nullptr);
+#else
+  char* parent = nullptr;
+  for (char* p = dir; *p; p++)
+  {
+    if (*p == '/')
+      parent = p;
+  }
+  if (parent && parent != dir)
+  {
+    *parent = '\0';
+    mkdir(dir, 0755);
+    *parent = '/';
+  }
+  mkdir(dir, 0755);
+#endif
+}
+
+static bool ReadWholeFile(const char* path, ByteBuffer* out)
+{
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER liSize;
+  if (!GetFileSizeEx(hFile, &liSize) || liSize.QuadPart < 0 || liSize.QuadPart > 0x7FFFFFFFLL)
+  {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  size_t size = (size_t)liSize.QuadPart;
+  if (!bb_resize(out, size))
+  {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  DWORD readBytes = 0;
+  bool ok = size == 0 || (ReadFile(hFile, out->data, (DWORD)size, &readBytes, NULL) && readBytes == size);
+  CloseHandle(hFile);
+  return ok;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  size_t size = (size_t)st.st_size;
+  if (!bb_resize(out, size))
+  {
+    close(fd);
+    return false;
+  }
+
+  size_t total = 0;
+  while (total < size)
+  {
+    ssize_t r = read(fd, out->data + total, size - total);
+    if (r <= 0)
+    {
+      close(fd);
+      return false;
+    }
+    total += (size_t)r;
+  }
+
+  close(fd);
+  return true;
+#endif
+}
+
+static bool WriteWholeFile(const char* path, const uint8_t* data, size_t size)
+{
+  char tempPath[520];
+  strCopy(tempPath, path);
+  strCat(tempPath, ".tmp");
+
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(tempPath, GENERIC_WRITE, 0, NULL,
+                             CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD written = 0;
+  bool ok = WriteFile(hFile, data, (DWORD)size, &written, NULL) && written == size;
+  CloseHandle(hFile);
+
+  if (!ok)
+  {
+    DeleteFileA(tempPath);
+    return false;
+  }
+  return MoveFileExA(tempPath, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+
+  size_t total = 0;
+  while (total < size)
+  {
+    ssize_t w = write(fd, data + total, size - total);
+    if (w <= 0)
+    {
+      close(fd);
+      unlink(tempPath);
+      return false;
+    }
+    total += (size_t)w;
+  }
+
+  close(fd);
+  return rename(tempPath, path) == 0;
+#endif
+}
+
+static void FreeEntry(CacheEntry& entry)
+{
+  if (entry.payload)
+    platformFree(entry.payload, entry.payloadSize);
+  entry.payload = nullptr;
+  entry.payloadSize = 0;
+}
+
+struct EvictionSlot
+{
+  uint64_t lastUsed;
+  size_t size;
+};
+
+static void SiftDown(EvictionSlot* slots, size_t root, size_t count)
+{
+  while (root * 2 + 1 < count)
+  {
+    size_t child = root * 2 + 1;
+    if (child + 1 < count && slots[child].lastUsed < slots[child + 1].lastUsed)
+      child++;
+    if (slots[root].lastUsed >= slots[child].lastUsed)
+      return;
+    EvictionSlot t = slots[root];
+    slots[root] = slots[child];
+    slots[child] = t;
+    root = child;
+  }
+}
+
+static void SortSlots(EvictionSlot* slots, size_t count)
+{
+  if (count < 2)
+    return;
+
+  for (size_t start = count / 2; start-- > 0;)
+    SiftDown(slots, start, count);
+
+  for (size_t end = count - 1; end > 0; end--)
+  {
+    EvictionSlot t = slots[0];
+    slots[0] = slots[end];
+    slots[end] = t;
+    SiftDown(slots, 0, end);
+  }
+}
+
+static void EvictToBudget()
+{
+  if (g_CacheUsage <= g_CacheBudget || g_CacheEntries.empty())
+    return;
+
+  size_t count = g_CacheEntries.size();
+  EvictionSlot* slots = (EvictionSlot*)platformAlloc(count * sizeof(EvictionSlot));
+  if (!slots)
+    return;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    slots[i].lastUsed = g_CacheEntries[i].lastUsed;
+    slots[i].size = PLUGIN_CACHE_ENTRY_HEADER + g_CacheEntries[i].payloadSize;
+  }
+  SortSlots(slots, count);
+
+  size_t target = g_CacheBudget - g_CacheBudget / 8;
+  size_t kept = 0;
+  uint64_t cutoff = slots[count - 1].lastUsed + 1;
+
+  // The newest entry always survives, otherwise a result larger than the
+  // target would be evicted as soon as it was stored.
+  for (size_t i = count; i-- > 0;)
+  {
+    if (i < count - 1 && kept + slots[i].size > target)
+      break;
+    kept += slots[i].size;
+    cutoff = slots[i].lastUsed;
+  }
+  platformFree(slots, count * sizeof(EvictionSlot));
+
+  Vector<CacheEntry> survivors;
+  size_t usage = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (g_CacheEntries[i].lastUsed >= cutoff)
+    {
+      survivors.push_back(g_CacheEntries[i]);
+      usage += PLUGIN_CACHE_ENTRY_HEADER + g_CacheEntries[i].payloadSize;
+    }
+    else
+    {
+      FreeEntry(g_CacheEntries[i]);
+    }
+  }
+
+  g_CacheEntries = survivors;
+  g_CacheUsage = usage;
+  g_CacheDirty = true;
+  g_CacheRewrite = true;
+  RebuildIndex();
+}
+
+static void EnsureLoaded()
+{
+  if (g_CacheLoaded)
+    return;
+  g_CacheLoaded = true;
+
+  char path[512];
+  GetCacheFilePath(path, 512);
+  if (!path[0])
+    return;
+
+  ByteBuffer file;
+  bb_init(&file);
+  if (!ReadWholeFile(path, &file) || file.size < 20 ||
+      Read32(file.data) != PLUGIN_CACHE_MAGIC ||
+      Read32(file.data + 4) != PLUGIN_CACHE_VERSION)
+  {
+    bb_free(&file);
+    RebuildIndex();
+    return;
+  }
+
+  g_CacheClock = Read64(file.data + 8);
+  uint32_t count = Read32(file.data + 16);
+  size_t pos = 20;
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (pos + PLUGIN_CACHE_ENTRY_HEADER > file.size)
+      break;
+
+    CacheEntry entry;
+    entry.key = Read64(file.data + pos);
+    entry.contentHash = Read64(file.data + pos + 8);
+    entry.contentSize = Read64(file.data + pos + 16);
+    entry.lastUsed = Read64(file.data + pos + 24);
+    entry.kind = Read32(file.data + pos + 32);
+    entry.payloadSize = Read32(file.data + pos + 36);
+    pos += PLUGIN_CACHE_ENTRY_HEADER;
+
+    if (entry.payloadSize > file.size - pos)
+      break;
+
+    entry.payload = (uint8_t*)platformAlloc(entry.payloadSize ? entry.payloadSize : 1);
+    if (!entry.payload)
+      break;
+    memCopy(entry.payload, file.data + pos, entry.payloadSize);
+    pos += entry.payloadSize;
+
+    if (entry.lastUsed >= g_CacheClock)
+      g_CacheClock = entry.lastUsed + 1;
+
+    g_CacheEntries.push_back(entry);
+    g_CacheUsage += PLUGIN_CACHE_ENTRY_HEADER + entry.payloadSize;
+  }
+
+  bb_free(&file);
+  g_CacheRewrite = g_CacheEntries.size() != count;
+  g_CacheFlushedCount = g_CacheEntries.size();
+  g_CacheFileEnd = pos;
+  RebuildIndex();
+  EvictToBudget();
+}
+
+static void StoreEntry(uint64_t key, const PluginCacheKey* cacheKey, uint32_t kind,
+                       const uint8_t* payload, size_t payloadSize)
+{
+  if (payloadSize > 0xFFFFFFFFu || payloadSize + PLUGIN_CACHE_ENTRY_HEADER > g_CacheBudget)
+    return;
+
+  uint8_t* copy = (uint8_t*)platformAlloc(payloadSize ? payloadSize : 1);
+  if (!copy)
+    return;
+  memCopy(copy, payload, payloadSize);
+
+  CacheEntry* existing = FindEntry(key);
+  if (existing)
+  {
+    if ((size_t)(existing - &g_CacheEntries[0]) < g_CacheFlushedCount)
+      g_CacheRewrite = true;
+    g_CacheUsage -= existing->payloadSize;
+    FreeEntry(*existing);
+    existing->payload = copy;
+    existing->payloadSize = (uint32_t)payloadSize;
+    existing->lastUsed = g_CacheClock++;
+    g_CacheUsage += payloadSize;
+  }
+  else
+  {
+    CacheEntry entry;
+    entry.key = key;
+    entry.contentHash = cacheKey->contentHash;
+    entry.contentSize = cacheKey->contentSize;
+    entry.lastUsed = g_CacheClock++;
+    entry.kind = kind;
+    entry.payloadSize = (uint32_t)payloadSize;
+    entry.payload = copy;
+    g_CacheEntries.push_back(entry);
+    g_CacheUsage += PLUGIN_CACHE_ENTRY_HEADER + payloadSize;
+
+    if (g_CacheEntries.size() * 2 > g_CacheIndexCapacity)
+    {
+      RebuildIndex();
+    }
+    else
+    {
+      size_t mask = g_CacheIndexCapacity - 1;
+      size_t slot = (size_t)key & mask;
+      while (g_CacheIndex[slot] >= 0)
+        slot = (slot + 1) & mask;
+      g_CacheIndex[slot] = (int)(g_CacheEntries.size() - 1);
+    }
+  }
+
+  g_CacheDirty = true;
+  EvictToBudget();
+}
+
+static void RemoveEntry(CacheEntry* entry)
+{
+  size_t index = (size_t)(entry - &g_CacheEntries[0]);
+  g_CacheUsage -= PLUGIN_CACHE_ENTRY_HEADER + entry->payloadSize;
+  FreeEntry(*entry);
+  g_CacheEntries.remove(index);
+  g_CacheDirty = true;
+  g_CacheRewrite = true;
+  RebuildIndex();
+}
+
+static void PutU16(ByteBuffer* b, uint16_t v)
+{
+  size_t pos = b->size;
+  if (!bb_resize(b, pos + 2))
+    return;
+  b->data[pos] = (uint8_t)v;
+  b->data[pos + 1] = (uint8_t)(v >> 8);
+}
+
+static void PutU32(ByteBuffer* b, uint32_t v)
+{
+  size_t pos = b->size;
+  if (!bb_resize(b, pos + 4))
+    return;
+  for (int i = 0; i < 4; i++)
+    b->data[pos + i] = (uint8_t)(v >> (i * 8));
+}
+
+static void PutU64(ByteBuffer* b, uint64_t v)
+{
+  size_t pos = b->size;
+  if (!bb_resize(b, pos + 8))
+    return;
+  for (int i = 0; i < 8; i++)
+    b->data[pos + i] = (uint8_t)(v >> (i * 8));
+}
+
+static void PutBytes(ByteBuffer* b, const void* data, size_t size)
+{
+  size_t pos = b->size;
+  if (size == 0 || !bb_resize(b, pos + size))
+    return;
+  memCopy(b->data + pos, data, size);
+}
+
+static void PutString16(ByteBuffer* b, const char* s, size_t maxLen)
+{
+  size_t len = 0;
+  while (len < maxLen - 1 && s[len])
+    len++;
+  PutU16(b, (uint16_t)len);
+  PutBytes(b, s, len);
+}
+
+static bool GetString16(const uint8_t* data, size_t size, size_t* pos, char* out, size_t maxLen)
+{
+  if (*pos + 2 > size)
+    return false;
+  size_t len = (size_t)data[*pos] | ((size_t)data[*pos + 1] << 8);
+  *pos += 2;
+  if (*pos + len > size)
+    return false;
+
+  size_t copyLen = len < maxLen - 1 ? len : maxLen - 1;
+  memCopy(out, data + *pos, copyLen);
+  out[copyLen] = '\0';
+  *pos += len;
+  return true;
+}
+
+void PluginCache_SetBudget(size_t maxBytes)
+{
+  g_CacheBudget = maxBytes;
+  if (g_CacheLoaded)
+    EvictToBudget();
+}
+
+size_t PluginCache_GetBudget()
+{
+  return g_CacheBudget;
+}
+
+size_t PluginCache_GetUsage()
+{
+  EnsureLoaded();
+  return g_CacheUsage;
+}
+
+bool PluginCache_GetBookmarks(const PluginCacheKey* key, PluginBookmarkArray* outBookmarks)
+{
+  if (!key || !key->pluginPath || !outBookmarks)
+    return false;
+
+  EnsureLoaded();
+
+  CacheEntry* entry = FindEntry(MakeEntryKey(key, PLUGIN_CACHE_BOOKMARKS, 0, 0));
+  if (!entry || entry->kind != PLUGIN_CACHE_BOOKMARKS ||
+      entry->contentHash != key->contentHash || entry->contentSize != key->contentSize ||
+      entry->payloadSize < 4)
+    return false;
+
+  const uint8_t* data = entry->payload;
+  size_t size = entry->payloadSize;
+  uint32_t count = Read32(data);
+  size_t pos = 4;
+  size_t firstNew = outBookmarks->count;
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (pos + 11 > size)
+    {
+      outBookmarks->count = firstNew;
+      RemoveEntry(entry);
+      return false;
+    }
+
+    PluginBookmark bookmark;
+    memSet(&bookmark, 0, sizeof(PluginBookmark));
+    bookmark.offset = Read64(data + pos);
+    bookmark.color.r = data[pos + 8];
+    bookmark.color.g = data[pos + 9];
+    bookmark.color.b = data[pos + 10];
+    pos += 11;
+
+    if (!GetString16(data, size, &pos, bookmark.label, sizeof(bookmark.label)) ||
+        !GetString16(data, size, &pos, bookmark.description, sizeof(bookmark.description)) ||
+        !GetString16(data, size, &pos, bookmark.pluginSource, sizeof(bookmark.pluginSource)))
+    {
+      outBookmarks->count = firstNew;
+      RemoveEntry(entry);
+      return false;
+    }
+
+    pba_push_back(outBookmarks, &bookmark);
+  }
+
+  // Recency alone does not dirty the cache; it is written out with the
+  // next put or eviction.
+  entry->lastUsed = g_CacheClock++;
+  return true;
+}
+
+void PluginCache_PutBookmarks(const PluginCacheKey* key, const PluginBookmark* bookmarks, size_t count)
+{
+  if (!key || !key->pluginPath || (count > 0 && !bookmarks))
+    return;
+
+  EnsureLoaded();
+
+  ByteBuffer payload;
+  bb_init(&payload);
+  PutU32(&payload, (uint32_t)count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const PluginBookmark& bookmark = bookmarks[i];
+    PutU64(&payload, bookmark.offset);
+    PutBytes(&payload, &bookmark.color.r, 1);
+    PutBytes(&payload, &bookmark.color.g, 1);
+    PutBytes(&payload, &bookmark.color.b, 1);
+    PutString16(&payload, bookmark.label, sizeof(bookmark.label));
+    PutString16(&payload, bookmark.description, sizeof(bookmark.description));
+    PutString16(&payload, bookmark.pluginSource, sizeof(bookmark.pluginSource));
+  }
+
+  StoreEntry(MakeEntryKey(key, PLUGIN_CACHE_BOOKMARKS, 0, 0), key,
+             PLUGIN_CACHE_BOOKMARKS, payload.data, payload.size);
+  bb_free(&payload);
+}
+
+bool PluginCache_GetDisassembly(const PluginCacheKey* key, size_t offset, size_t size, SimpleString* outText)
+{
+  if (!key || !key->pluginPath || !outText)
+    return false;
+
+  EnsureLoaded();
+
+  CacheEntry* entry = FindEntry(MakeEntryKey(key, PLUGIN_CACHE_DISASSEMBLY, offset, size));
+  if (!entry || entry->kind != PLUGIN_CACHE_DISASSEMBLY ||
+      entry->contentHash != key->contentHash || entry->contentSize != key->contentSize)
+    return false;
+
+  ss_clear(outText);
+  if (entry->payloadSize > 0 && ss_reserve(outText, entry->payloadSize))
+  {
+    memCopy(outText->data, entry->payload, entry->payloadSize);
+    outText->length = entry->payloadSize;
+    outText->data[outText->length] = '\0';
+  }
+
+  entry->lastUsed = g_CacheClock++;
+  return true;
+}
+
+void PluginCache_PutDisassembly(const PluginCacheKey* key, size_t offset, size_t size, const char* text)
+{
+  if (!key || !key->pluginPath)
+    return;
+
+  EnsureLoaded();
+
+  size_t len = text ? strLen(text) : 0;
+  StoreEntry(MakeEntryKey(key, PLUGIN_CACHE_DISASSEMBLY, offset, size), key,
+             PLUGIN_CACHE_DISASSEMBLY, (const uint8_t*)text, len);
+}
+
+static void PutEntry(ByteBuffer* b, const CacheEntry& entry)
+{
+  PutU64(b, entry.key);
+  PutU64(b, entry.contentHash);
+  PutU64(b, entry.contentSize);
+  PutU64(b, entry.lastUsed);
+  PutU32(b, entry.kind);
+  PutU32(b, entry.payloadSize);
+  PutBytes(b, entry.payload, entry.payloadSize);
+}
+
+static void PutHeader(ByteBuffer* b)
+{
+  PutU32(b, PLUGIN_CACHE_MAGIC);
+  PutU32(b, PLUGIN_CACHE_VERSION);
+  PutU64(b, g_CacheClock);
+  PutU32(b, (uint32_t)g_CacheEntries.size());
+}
+
+// Writes data at offset, truncates anything after it and then rewrites the
+// header, so a failed append leaves the old entry count pointing at whole
+// records.
+static bool AppendToFile(const char* path, uint64_t offset, const uint8_t* data, size_t size,
+                         const uint8_t* header, size_t headerSize)
+{
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(path, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER position;
+  position.QuadPart = (LONGLONG)offset;
+  DWORD written = 0;
+  bool ok = SetFilePointerEx(hFile, position, NULL, FILE_BEGIN) &&
+            WriteFile(hFile, data, (DWORD)size, &written, NULL) && written == size &&
+            SetEndOfFile(hFile);
+
+  position.QuadPart = 0;
+  ok = ok && SetFilePointerEx(hFile, position, NULL, FILE_BEGIN) &&
+       WriteFile(hFile, header, (DWORD)headerSize, &written, NULL) && written == headerSize;
+  CloseHandle(hFile);
+  return ok;
+#else
+  int fd = open(path, O_WRONLY);
+  if (fd < 0)
+    return false;
+
+  size_t total = 0;
+  while (total < size)
+  {
+    ssize_t w = pwrite(fd, data + total, size - total, (off_t)(offset + total));
+    if (w <= 0)
+    {
+      close(fd);
+      return false;
+    }
+    total += (size_t)w;
+  }
+
+  bool ok = ftruncate(fd, (off_t)(offset + size)) == 0 &&
+            pwrite(fd, header, headerSize, 0) == (ssize_t)headerSize;
+  close(fd);
+  return ok;
+#endif
+}
+
+// Entries are only ever appended between evictions, so a flush writes the new
+// records after the ones already on disk; anything that drops or replaces a
+// flushed record forces a full rewrite.
+bool PluginCache_Flush()
+{
+  if (!g_CacheLoaded || !g_CacheDirty)
+    return true;
+
+  char path[512];
+  GetCacheFilePath(path, 512);
+  if (!path[0])
+    return false;
+
+  ByteBuffer out;
+  bb_init(&out);
+  bool ok = false;
+
+  if (!g_CacheRewrite && g_CacheFlushedCount <= g_CacheEntries.size())
+  {
+    ByteBuffer header;
+    bb_init(&header);
+    PutHeader(&header);
+
+    for (size_t i = g_CacheFlushedCount; i < g_CacheEntries.size(); i++)
+      PutEntry(&out, g_CacheEntries[i]);
+
+    ok = AppendToFile(path, g_CacheFileEnd, out.data, out.size, header.data, header.size);
+    bb_free(&header);
+
+    if (ok)
+      g_CacheFileEnd += out.size;
+  }
+
+  if (!ok)
+  {
+    bb_free(&out);
+    PutHeader(&out);
+    for (size_t i = 0; i < g_CacheEntries.size(); i++)
+      PutEntry(&out, g_CacheEntries[i]);
+
+    EnsureCacheDirectory(path);
+    ok = WriteWholeFile(path, out.data, out.size);
+
+    if (ok)
+      g_CacheFileEnd = out.size;
+  }
+  bb_free(&out);
+
+  if (ok)
+  {
+    g_CacheDirty = false;
+    g_CacheRewrite = false;
+    g_CacheFlushedCount = g_CacheEntries.size();
+  }
+  return ok;
+}
+
+void PluginCache_Clear()
+{
+  for (size_t i = 0; i < g_CacheEntries.size(); i++)
+    FreeEntry(g_CacheEntries[i]);
+  g_CacheEntries.clear();
+  g_CacheUsage = 0;
+  g_CacheLoaded = true;
+  g_CacheDirty = true;
+  g_CacheRewrite = true;
+  RebuildIndex();
+}
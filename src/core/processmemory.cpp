@@ -0,0 +1,898 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <stdio.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#endif
+
+#include "processmemory.h"
+#include "dumpfile.h"
+
+#define PROCESS_READ_BATCH 64
+
+#ifdef __linux__
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+static void RecoverProcessSpan(int memFd, const struct iovec& local, const struct iovec& remote,
+                               uint64_t bufferOffset, Vector<ProcessReadFailure>* failures)
+{
+  if (memFd >= 0 &&
+      pread(memFd, local.iov_base, local.iov_len, (off_t)(uintptr_t)remote.iov_base) == (ssize_t)local.iov_len)
+  {
+    return;
+  }
+
+  int error = errno;
+  memSet(local.iov_base, 0, local.iov_len);
+
+  if (failures)
+  {
+    ProcessReadFailure failure;
+    failure.virtualAddress = (uint64_t)(uintptr_t)remote.iov_base;
+    failure.bufferOffset = bufferOffset;
+    failure.size = local.iov_len;
+    failure.error = error;
+    failures->push_back(failure);
+  }
+}
+
+static void ReadProcessSpans(int pid, int memFd, struct iovec* local, struct iovec* remote,
+                             const uint64_t* bufferOffsets, size_t count,
+                             Vector<ProcessReadFailure>* failures)
+{
+  size_t k = 0;
+  while (k < count)
+  {
+    ssize_t result = process_vm_readv(pid, local + k, (unsigned long)(count - k),
+                                      remote + k, (unsigned long)(count - k), 0);
+    size_t got = result > 0 ? (size_t)result : 0;
+
+    while (k < count && got >= local[k].iov_len)
+    {
+      got -= local[k].iov_len;
+      k++;
+    }
+
+    if (k == count)
+      break;
+
+    struct iovec restLocal;
+    struct iovec restRemote;
+    restLocal.iov_base = (uint8_t*)local[k].iov_base + got;
+    restLocal.iov_len = local[k].iov_len - got;
+    restRemote.iov_base = (uint8_t*)remote[k].iov_base + got;
+    restRemote.iov_len = restLocal.iov_len;
+
+    RecoverProcessSpan(memFd, restLocal, restRemote, bufferOffsets[k] + got, failures);
+    k++;
+  }
+}
+
+static bool WriteProcessSpans(int pid, int memFd, struct iovec* local, struct iovec* remote,
+                              const uint64_t* bufferOffsets, size_t count,
+                              Vector<ProcessWriteFailure>* failures)
+{
+  bool complete = true;
+  size_t k = 0;
+  while (k < count)
+  {
+    size_t batch = count - k;
+    if (batch > IOV_MAX)
+      batch = IOV_MAX;
+
+    ssize_t result = process_vm_writev(pid, local + k, (unsigned long)batch,
+                                       remote + k, (unsigned long)batch, 0);
+    size_t got = result > 0 ? (size_t)result : 0;
+    size_t batchEnd = k + batch;
+
+    while (k < batchEnd && got >= local[k].iov_len)
+    {
+      got -= local[k].iov_len;
+      k++;
+    }
+
+    if (k == batchEnd)
+      continue;
+
+    // process_vm_writev honours page protections; /proc/<pid>/mem writes
+    // through read-only private mappings the way a debugger does.
+    uint8_t* rest = (uint8_t*)local[k].iov_base + got;
+    size_t restLength = local[k].iov_len - got;
+    uint64_t address = (uint64_t)(uintptr_t)remote[k].iov_base + got;
+
+    if (memFd < 0 || pwrite(memFd, rest, restLength, (off_t)address) != (ssize_t)restLength)
+    {
+      complete = false;
+      if (failures)
+      {
+        ProcessWriteFailure failure;
+        failure.virtualAddress = address;
+        failure.bufferOffset = (size_t)(bufferOffsets[k] + got);
+        failure.size = restLength;
+        failure.error = memFd < 0 ? EACCES : errno;
+        failures->push_back(failure);
+      }
+    }
+    k++;
+  }
+
+  return complete;
+}
+
+struct SnapshotBatch
+{
+  size_t first;
+  size_t count;
+};
+
+struct SnapshotJob
+{
+  int pid;
+  int memFd;
+  struct iovec* local;
+  struct iovec* remote;
+  uint64_t* bufferOffsets;
+  SnapshotBatch* batches;
+  size_t batchCount;
+  size_t nextBatch;
+};
+
+struct SnapshotWorker
+{
+  SnapshotJob* job;
+  Vector<ProcessReadFailure> failures;
+  pthread_t thread;
+  bool started;
+};
+
+static void* RunSnapshotWorker(void* param)
+{
+  SnapshotWorker* worker = (SnapshotWorker*)param;
+  SnapshotJob* job = worker->job;
+
+  for (;;)
+  {
+    size_t b = __atomic_fetch_add(&job->nextBatch, 1, __ATOMIC_RELAXED);
+    if (b >= job->batchCount)
+      break;
+
+    const SnapshotBatch& batch = job->batches[b];
+    ReadProcessSpans(job->pid, job->memFd,
+                     job->local + batch.first, job->remote + batch.first,
+                     job->bufferOffsets + batch.first, batch.count, &worker->failures);
+  }
+
+  return nullptr;
+}
+#endif
+
+void SortMemoryRegions(Vector<MemoryRegion>& regions)
+{
+  for (size_t i = 1; i < regions.size(); i++)
+  {
+    if (regions[i].virtualAddress >= regions[i - 1].virtualAddress)
+      continue;
+
+    MemoryRegion moving = regions[i];
+    size_t j = i;
+    while (j > 0 && regions[j - 1].virtualAddress > moving.virtualAddress)
+    {
+      regions[j] = regions[j - 1];
+      j--;
+    }
+    regions[j] = moving;
+  }
+}
+
+void FormatMemoryProtection(uint32_t protection, char* out)
+{
+  out[0] = (protection & MEMORY_PROT_READ) ? 'r' : '-';
+  out[1] = (protection & MEMORY_PROT_WRITE) ? 'w' : '-';
+  out[2] = (protection & MEMORY_PROT_EXEC) ? 'x' : '-';
+  out[3] = (protection & MEMORY_PROT_SHARED) ? 's' : 'p';
+  out[4] = '\0';
+}
+
+ProcessMemorySource::ProcessMemorySource()
+  : pid(0),
+  memFd(-1),
+  totalSize(0),
+  mappedBase(nullptr),
+  mappedSize(0),
+  dumpFile(nullptr),
+  dumpMapping(nullptr),
+  pages(nullptr),
+  setCount(0),
+  clock(0),
+  lastPage(nullptr)
+{
+  dumpPath[0] = '\0';
+}
+
+ProcessMemorySource::~ProcessMemorySource()
+{
+  detach();
+}
+
+bool ProcessMemorySource::attach(int processId, const Vector<MemoryRegion>& source)
+{
+  detach();
+
+  if (processId <= 0 || source.empty())
+    return false;
+
+  for (size_t i = 0; i < source.size(); i++)
+  {
+    if (source[i].size > 0)
+      regions.push_back(source[i]);
+  }
+  SortMemoryRegions(regions);
+
+  uint64_t offset = 0;
+  for (size_t i = 0; i < regions.size(); i++)
+  {
+    regions[i].bufferOffset = (size_t)offset;
+    offset += regions[i].size;
+  }
+
+  if (offset == 0 || !allocateCache(PROCESS_DEFAULT_PAGE_BUDGET))
+  {
+    regions.clear();
+    return false;
+  }
+
+  pid = processId;
+  totalSize = offset;
+
+#ifdef __linux__
+  char memPath[64];
+  snprintf(memPath, sizeof(memPath), "/proc/%d/mem", pid);
+  memFd = open(memPath, O_RDONLY);
+#endif
+
+  return true;
+}
+
+bool ProcessMemorySource::attachDump(const char* path)
+{
+  detach();
+
+  if (!path || !mapDump(path))
+    return false;
+
+  Vector<DumpSegment> segments;
+  if (!ParseDumpSegments(mappedBase, mappedSize, &segments))
+  {
+    unmapDump();
+    return false;
+  }
+
+  uint64_t offset = 0;
+  for (size_t i = 0; i < segments.size(); i++)
+  {
+    DumpExtent extent;
+    extent.dumpOffset = segments[i].dumpOffset;
+    extent.storedSize = segments[i].storedSize;
+    extents.push_back(extent);
+
+    segments[i].region.bufferOffset = (size_t)offset;
+    regions.push_back(segments[i].region);
+    offset += segments[i].region.size;
+  }
+
+  totalSize = offset;
+  stringCopy(dumpPath, path, sizeof(dumpPath));
+  return true;
+}
+
+bool ProcessMemorySource::mapDump(const char* path)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize;
+  HANDLE mapping = NULL;
+  void* view = nullptr;
+  if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping)
+    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+  if (!view)
+  {
+    if (mapping)
+      CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  dumpFile = file;
+  dumpMapping = mapping;
+  mappedBase = (const uint8_t*)view;
+  mappedSize = (uint64_t)fileSize.QuadPart;
+  return true;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  void* view = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+      (uint64_t)st.st_size <= (uint64_t)(size_t)-1)
+  {
+    view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+
+  if (view == MAP_FAILED)
+    return false;
+
+  mappedBase = (const uint8_t*)view;
+  mappedSize = (uint64_t)st.st_size;
+  return true;
+#endif
+}
+
+void ProcessMemorySource::unmapDump()
+{
+  if (!mappedBase)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(mappedBase);
+  CloseHandle((HANDLE)dumpMapping);
+  CloseHandle((HANDLE)dumpFile);
+#else
+  munmap((void*)mappedBase, (size_t)mappedSize);
+#endif
+
+  mappedBase = nullptr;
+  mappedSize = 0;
+  dumpFile = nullptr;
+  dumpMapping = nullptr;
+}
+
+void ProcessMemorySource::detach()
+{
+#ifdef __linux__
+  if (memFd >= 0)
+    close(memFd);
+#endif
+  memFd = -1;
+
+  unmapDump();
+  freeCache();
+  regions.clear();
+  edits.clear();
+  extents.clear();
+  pid = 0;
+  totalSize = 0;
+  dumpPath[0] = '\0';
+}
+
+bool ProcessMemorySource::allocateCache(size_t budget)
+{
+  size_t sets = budget / PROCESS_CACHE_WAYS;
+  if (sets < PROCESS_MIN_PAGE_BUDGET / PROCESS_CACHE_WAYS)
+    sets = PROCESS_MIN_PAGE_BUDGET / PROCESS_CACHE_WAYS;
+
+  CachedPage* newPages = (CachedPage*)platformAlloc(sets * PROCESS_CACHE_WAYS * sizeof(CachedPage));
+  if (!newPages)
+    return false;
+
+  freeCache();
+  memSet(newPages, 0, sets * PROCESS_CACHE_WAYS * sizeof(CachedPage));
+  pages = newPages;
+  setCount = sets;
+  return true;
+}
+
+void ProcessMemorySource::freeCache()
+{
+  if (!pages)
+    return;
+
+  for (size_t i = 0; i < setCount * PROCESS_CACHE_WAYS; i++)
+  {
+    if (pages[i].data)
+      platformFree(pages[i].data, PROCESS_PAGE_SIZE);
+  }
+
+  platformFree(pages, setCount * PROCESS_CACHE_WAYS * sizeof(CachedPage));
+  pages = nullptr;
+  setCount = 0;
+  lastPage = nullptr;
+}
+
+void ProcessMemorySource::setPageBudget(size_t budget)
+{
+  if (!pages)
+    return;
+  allocateCache(budget);
+}
+
+void ProcessMemorySource::invalidate()
+{
+  for (size_t i = 0; i < setCount * PROCESS_CACHE_WAYS; i++)
+    pages[i].length = 0;
+  lastPage = nullptr;
+}
+
+size_t ProcessMemorySource::findRegion(uint64_t offset) const
+{
+  size_t lo = 0;
+  size_t hi = regions.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (regions[mid].bufferOffset + regions[mid].size <= offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+void ProcessMemorySource::readMapped(uint64_t offset, uint8_t* out, size_t length) const
+{
+  size_t done = 0;
+  for (size_t r = findRegion(offset); r < regions.size() && done < length; r++)
+  {
+    uint64_t inRegion = offset + done - regions[r].bufferOffset;
+    size_t span = (size_t)(regions[r].size - inRegion);
+    if (span > length - done)
+      span = length - done;
+
+    const DumpExtent& extent = extents[r];
+    size_t stored = 0;
+    if (inRegion < extent.storedSize)
+    {
+      stored = (size_t)(extent.storedSize - inRegion);
+      if (stored > span)
+        stored = span;
+      memCopy(out + done, mappedBase + extent.dumpOffset + inRegion, stored);
+    }
+    if (stored < span)
+      memSet(out + done + stored, 0, span - stored);
+
+    done += span;
+  }
+
+  applyEdits(offset, out, length);
+}
+
+void ProcessMemorySource::readRemote(uint64_t offset, uint8_t* out, size_t length)
+{
+  memSet(out, 0, length);
+
+#ifdef __linux__
+  struct iovec local[PROCESS_READ_BATCH];
+  struct iovec remote[PROCESS_READ_BATCH];
+  uint64_t bufferOffsets[PROCESS_READ_BATCH];
+  size_t spanCount = 0;
+#endif
+
+  size_t done = 0;
+  for (size_t r = findRegion(offset); r < regions.size() && done < length; r++)
+  {
+    const MemoryRegion& region = regions[r];
+    uint64_t inRegion = offset + done - region.bufferOffset;
+    size_t span = (size_t)(region.size - inRegion);
+    if (span > length - done)
+      span = length - done;
+
+#ifdef __linux__
+    if (spanCount == PROCESS_READ_BATCH)
+    {
+      ReadProcessSpans(pid, memFd, local, remote, bufferOffsets, spanCount, nullptr);
+      spanCount = 0;
+    }
+
+    local[spanCount].iov_base = out + done;
+    local[spanCount].iov_len = span;
+    remote[spanCount].iov_base = (void*)(uintptr_t)(region.virtualAddress + inRegion);
+    remote[spanCount].iov_len = span;
+    bufferOffsets[spanCount] = offset + done;
+    spanCount++;
+#endif
+
+    done += span;
+  }
+
+#ifdef __linux__
+  if (spanCount > 0)
+    ReadProcessSpans(pid, memFd, local, remote, bufferOffsets, spanCount, nullptr);
+#endif
+
+  applyEdits(offset, out, length);
+}
+
+size_t ProcessMemorySource::snapshot(uint64_t offset, uint8_t* dest, size_t length,
+                                     Vector<ProcessReadFailure>* failures)
+{
+  if (offset >= totalSize || length == 0)
+    return 0;
+
+  if (length > totalSize - offset)
+    length = (size_t)(totalSize - offset);
+
+  if (mappedBase)
+  {
+    readMapped(offset, dest, length);
+    return length;
+  }
+
+#ifdef __linux__
+  size_t pieceCount = 0;
+  size_t done = 0;
+  for (size_t r = findRegion(offset); r < regions.size() && done < length; r++)
+  {
+    size_t span = (size_t)(regions[r].size - (offset + done - regions[r].bufferOffset));
+    if (span > length - done)
+      span = length - done;
+    pieceCount += (span + PROCESS_SNAPSHOT_SLICE - 1) / PROCESS_SNAPSHOT_SLICE;
+    done += span;
+  }
+
+  struct iovec* local = (struct iovec*)platformAlloc(pieceCount * sizeof(struct iovec));
+  struct iovec* remote = (struct iovec*)platformAlloc(pieceCount * sizeof(struct iovec));
+  uint64_t* bufferOffsets = (uint64_t*)platformAlloc(pieceCount * sizeof(uint64_t));
+  SnapshotBatch* batches = (SnapshotBatch*)platformAlloc(pieceCount * sizeof(SnapshotBatch));
+
+  if (local && remote && bufferOffsets && batches)
+  {
+    size_t piece = 0;
+    size_t batchCount = 0;
+    size_t batchBytes = 0;
+
+    done = 0;
+    for (size_t r = findRegion(offset); r < regions.size() && done < length; r++)
+    {
+      const MemoryRegion& region = regions[r];
+      uint64_t inRegion = offset + done - region.bufferOffset;
+      size_t span = (size_t)(region.size - inRegion);
+      if (span > length - done)
+        span = length - done;
+
+      for (size_t sliceStart = 0; sliceStart < span; sliceStart += PROCESS_SNAPSHOT_SLICE)
+      {
+        size_t slice = span - sliceStart;
+        if (slice > PROCESS_SNAPSHOT_SLICE)
+          slice = PROCESS_SNAPSHOT_SLICE;
+
+        if (batchCount == 0 || batches[batchCount - 1].count == IOV_MAX ||
+            batchBytes >= PROCESS_SNAPSHOT_BATCH_BYTES)
+        {
+          batches[batchCount].first = piece;
+          batches[batchCount].count = 0;
+          batchCount++;
+          batchBytes = 0;
+        }
+
+        local[piece].iov_base = dest + done + sliceStart;
+        local[piece].iov_len = slice;
+        remote[piece].iov_base = (void*)(uintptr_t)(region.virtualAddress + inRegion + sliceStart);
+        remote[piece].iov_len = slice;
+        bufferOffsets[piece] = offset + done + sliceStart;
+        batches[batchCount - 1].count++;
+        batchBytes += slice;
+        piece++;
+      }
+
+      done += span;
+    }
+
+    SnapshotJob job;
+    job.pid = pid;
+    job.memFd = memFd;
+    job.local = local;
+    job.remote = remote;
+    job.bufferOffsets = bufferOffsets;
+    job.batches = batches;
+    job.batchCount = batchCount;
+    job.nextBatch = 0;
+
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t workerCount = cpuCount > 0 ? (size_t)cpuCount : 1;
+    if (workerCount > PROCESS_SNAPSHOT_MAX_THREADS)
+      workerCount = PROCESS_SNAPSHOT_MAX_THREADS;
+    if (workerCount > batchCount)
+      workerCount = batchCount;
+
+    SnapshotWorker workers[PROCESS_SNAPSHOT_MAX_THREADS];
+    for (size_t i = 0; i < workerCount; i++)
+    {
+      workers[i].job = &job;
+      workers[i].started = false;
+    }
+
+    for (size_t i = 1; i < workerCount; i++)
+      workers[i].started = pthread_create(&workers[i].thread, nullptr, RunSnapshotWorker, &workers[i]) == 0;
+
+    RunSnapshotWorker(&workers[0]);
+
+    for (size_t i = 0; i < workerCount; i++)
+    {
+      if (i > 0 && workers[i].started)
+        pthread_join(workers[i].thread, nullptr);
+
+      if (failures)
+      {
+        for (size_t f = 0; f < workers[i].failures.size(); f++)
+          failures->push_back(workers[i].failures[f]);
+      }
+    }
+  }
+  else
+  {
+    readRemote(offset, dest, length);
+  }
+
+  if (local)
+    platformFree(local, pieceCount * sizeof(struct iovec));
+  if (remote)
+    platformFree(remote, pieceCount * sizeof(struct iovec));
+  if (bufferOffsets)
+    platformFree(bufferOffsets, pieceCount * sizeof(uint64_t));
+  if (batches)
+    platformFree(batches, pieceCount * sizeof(SnapshotBatch));
+
+  applyEdits(offset, dest, length);
+#else
+  (void)failures;
+  readRemote(offset, dest, length);
+#endif
+
+  return length;
+}
+
+ProcessMemorySource::CachedPage* ProcessMemorySource::fetchPage(uint64_t pageIndex)
+{
+  if (lastPage && lastPage->length > 0 && lastPage->index == pageIndex)
+    return lastPage;
+
+  uint64_t hash = pageIndex * 0x9E3779B97F4A7C15ULL;
+  CachedPage* set = pages + (size_t)((hash >> 32) % setCount) * PROCESS_CACHE_WAYS;
+  CachedPage* victim = set;
+
+  clock++;
+  for (int way = 0; way < PROCESS_CACHE_WAYS; way++)
+  {
+    CachedPage* page = &set[way];
+    if (page->length > 0 && page->index == pageIndex)
+    {
+      page->lastUsed = clock;
+      lastPage = page;
+      return page;
+    }
+
+    if (victim->length > 0 && (page->length == 0 || page->lastUsed < victim->lastUsed))
+      victim = page;
+  }
+
+  if (!victim->data)
+  {
+    victim->data = (uint8_t*)platformAlloc(PROCESS_PAGE_SIZE);
+    if (!victim->data)
+      return nullptr;
+  }
+
+  uint64_t start = pageIndex * PROCESS_PAGE_SIZE;
+  size_t length = PROCESS_PAGE_SIZE;
+  if (start + length > totalSize)
+    length = (size_t)(totalSize - start);
+
+  readRemote(start, victim->data, length);
+
+  victim->index = pageIndex;
+  victim->length = length;
+  victim->lastUsed = clock;
+  lastPage = victim;
+  return victim;
+}
+
+size_t ProcessMemorySource::read(uint64_t offset, uint8_t* out, size_t length)
+{
+  if (mappedBase)
+    return snapshot(offset, out, length, nullptr);
+
+  if (!pages || offset >= totalSize || length == 0)
+    return 0;
+
+  if (length > totalSize - offset)
+    length = (size_t)(totalSize - offset);
+
+  if (length >= PROCESS_CACHE_BYPASS_SIZE)
+    return snapshot(offset, out, length, nullptr);
+
+  size_t done = 0;
+  while (done < length)
+  {
+    uint64_t position = offset + done;
+    CachedPage* page = fetchPage(position / PROCESS_PAGE_SIZE);
+    if (!page)
+      return done;
+
+    size_t inPage = (size_t)(position % PROCESS_PAGE_SIZE);
+    size_t count = page->length - inPage;
+    if (count > length - done)
+      count = length - done;
+
+    memCopy(out + done, page->data + inPage, count);
+    done += count;
+  }
+
+  return done;
+}
+
+uint8_t ProcessMemorySource::readByte(uint64_t offset)
+{
+  if (mappedBase)
+  {
+    uint8_t value = 0;
+    if (offset < totalSize)
+      readMapped(offset, &value, 1);
+    return value;
+  }
+
+  if (!pages || offset >= totalSize)
+    return 0;
+
+  CachedPage* page = fetchPage(offset / PROCESS_PAGE_SIZE);
+  return page ? page->data[offset % PROCESS_PAGE_SIZE] : 0;
+}
+
+size_t ProcessMemorySource::lowerBoundEdit(uint64_t offset) const
+{
+  size_t lo = 0;
+  size_t hi = edits.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (edits[mid].offset < offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+void ProcessMemorySource::applyEdits(uint64_t offset, uint8_t* out, size_t length) const
+{
+  for (size_t i = lowerBoundEdit(offset); i < edits.size() && edits[i].offset < offset + length; i++)
+    out[edits[i].offset - offset] = edits[i].value;
+}
+
+bool ProcessMemorySource::writeByte(uint64_t offset, uint8_t value)
+{
+  if (offset >= totalSize)
+    return false;
+
+  size_t index = lowerBoundEdit(offset);
+  if (index < edits.size() && edits[index].offset == offset)
+  {
+    edits[index].value = value;
+  }
+  else
+  {
+    ProcessByteEdit edit;
+    edit.offset = offset;
+    edit.value = value;
+    edits.insert(index, edit);
+  }
+
+  if (mappedBase)
+    return true;
+
+  CachedPage* page = fetchPage(offset / PROCESS_PAGE_SIZE);
+  if (page)
+    page->data[offset % PROCESS_PAGE_SIZE] = value;
+  return true;
+}
+
+void ProcessMemorySource::clearEdits()
+{
+  edits.clear();
+  invalidate();
+}
+
+bool ProcessMemorySource::commitEdits(Vector<ProcessWriteFailure>* failures)
+{
+  if (pid <= 0)
+    return false;
+  if (edits.empty())
+    return true;
+
+#ifdef __linux__
+  size_t count = edits.size();
+  uint8_t* values = (uint8_t*)platformAlloc(count);
+  if (!values)
+    return false;
+
+  Vector<struct iovec> local;
+  Vector<struct iovec> remote;
+  Vector<uint64_t> bufferOffsets;
+
+  size_t r = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    uint64_t offset = edits[i].offset;
+    values[i] = edits[i].value;
+
+    while (r < regions.size() && regions[r].bufferOffset + regions[r].size <= offset)
+      r++;
+    if (r == regions.size())
+      break;
+
+    bool extends = i > 0 && edits[i - 1].offset + 1 == offset && offset != regions[r].bufferOffset;
+    if (extends)
+    {
+      local[local.size() - 1].iov_len++;
+      remote[remote.size() - 1].iov_len++;
+      continue;
+    }
+
+    struct iovec localSpan;
+    struct iovec remoteSpan;
+    localSpan.iov_base = values + i;
+    localSpan.iov_len = 1;
+    remoteSpan.iov_base = (void*)(uintptr_t)(regions[r].virtualAddress + (offset - regions[r].bufferOffset));
+    remoteSpan.iov_len = 1;
+    local.push_back(localSpan);
+    remote.push_back(remoteSpan);
+    bufferOffsets.push_back(offset);
+  }
+
+  char memPath[64];
+  snprintf(memPath, sizeof(memPath), "/proc/%d/mem", pid);
+  int writeFd = open(memPath, O_RDWR);
+
+  Vector<ProcessWriteFailure> failed;
+  bool complete = local.empty() ||
+      WriteProcessSpans(pid, writeFd, &local[0], &remote[0], &bufferOffsets[0], local.size(), &failed);
+
+  if (writeFd >= 0)
+    close(writeFd);
+  platformFree(values, count);
+
+  Vector<ProcessByteEdit> remaining;
+  size_t f = 0;
+  for (size_t i = 0; i < edits.size(); i++)
+  {
+    while (f < failed.size() && failed[f].bufferOffset + failed[f].size <= edits[i].offset)
+      f++;
+    if (f < failed.size() && failed[f].bufferOffset <= edits[i].offset)
+      remaining.push_back(edits[i]);
+  }
+  edits = remaining;
+
+  if (failures)
+  {
+    for (size_t i = 0; i < failed.size(); i++)
+      failures->push_back(failed[i]);
+  }
+
+  invalidate();
+  return complete;
+#else
+  (void)failures;
+  return false;
+#endif
+}
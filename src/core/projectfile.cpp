@@ -0,0 +1,738 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "projectfile.h"
+#include "pluginresultcache.h"
+
+#define PROJECT_FILE_MAGIC 0x4A505648u
+#define PROJECT_FILE_VERSION 1
+#define PROJECT_HEADER_SIZE 64
+#define PROJECT_BLOCK_HEADER 64
+#define PROJECT_RECORD_SIZE 24
+#define PROJECT_BLOCK_SNAPSHOT 1
+#define PROJECT_BLOCK_JOURNAL 2
+#define PROJECT_HEADER_JOURNAL_END 40
+#define PROJECT_STRING_EMPTY 0xFFFFFFFFu
+
+// File layout: a 64-byte header, one snapshot block holding bookmarks,
+// annotations and view state, then journal blocks that each replace the
+// bookmarks and view state. Every block is a fixed header, 24-byte records
+// and a string table the records reference by byte offset; offset 0 is the
+// empty string.
+
+static inline uint64_t Read64(const uint8_t* p)
+{
+  return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+         ((uint64_t)p[3] << 24) | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) |
+         ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+static inline uint32_t Read32(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void Write64(uint8_t* p, uint64_t v)
+{
+  for (int i = 0; i < 8; i++)
+    p[i] = (uint8_t)(v >> (i * 8));
+}
+
+static inline void Write32(uint8_t* p, uint32_t v)
+{
+  for (int i = 0; i < 4; i++)
+    p[i] = (uint8_t)(v >> (i * 8));
+}
+
+static inline uint64_t MixHash(uint64_t h, uint64_t v)
+{
+  h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+  return h * 0xBF58476D1CE4E5B9ULL;
+}
+
+static uint64_t HashString(const char* s)
+{
+  return PluginCache_HashContent((const uint8_t*)s, strLen(s));
+}
+
+static uint64_t HashAnnotations(const PluginBookmarkArray* annotations)
+{
+  size_t count = annotations ? annotations->count : 0;
+  uint64_t h = MixHash(0, count);
+  for (size_t i = 0; i < count; i++)
+  {
+    const PluginBookmark& a = annotations->bookmarks[i];
+    h = MixHash(h, a.offset);
+    h = MixHash(h, ((uint64_t)a.color.r << 16) | ((uint64_t)a.color.g << 8) | a.color.b);
+    h = MixHash(h, HashString(a.label));
+    h = MixHash(h, HashString(a.description));
+    h = MixHash(h, HashString(a.pluginSource));
+  }
+  return h;
+}
+
+static bool BuildProjectPath(const char* dataPath, char* outPath)
+{
+  if (!dataPath || !dataPath[0])
+    return false;
+  if (strLen(dataPath) + sizeof(PROJECT_FILE_EXTENSION) > PROJECT_PATH_MAX)
+    return false;
+  strCopy(outPath, dataPath);
+  strCat(outPath, PROJECT_FILE_EXTENSION);
+  return true;
+}
+
+struct ProjectStringTable
+{
+  ByteBuffer bytes;
+  uint32_t* slots;
+  size_t slotCount;
+  size_t used;
+};
+
+static uint32_t StringSlotHash(const char* s)
+{
+  uint32_t h = 2166136261u;
+  while (*s)
+    h = (h ^ (uint8_t)*s++) * 16777619u;
+  return h;
+}
+
+static void FreeStringTable(ProjectStringTable* table)
+{
+  bb_free(&table->bytes);
+  if (table->slots)
+    platformFree(table->slots, table->slotCount * sizeof(uint32_t));
+  table->slots = nullptr;
+  table->slotCount = 0;
+}
+
+static bool GrowStringSlots(ProjectStringTable* table)
+{
+  size_t newCount = table->slotCount ? table->slotCount * 2 : 1024;
+  uint32_t* slots = (uint32_t*)platformAlloc(newCount * sizeof(uint32_t));
+  if (!slots)
+    return false;
+  for (size_t i = 0; i < newCount; i++)
+    slots[i] = PROJECT_STRING_EMPTY;
+
+  size_t mask = newCount - 1;
+  for (size_t i = 0; i < table->slotCount; i++)
+  {
+    uint32_t ref = table->slots[i];
+    if (ref == PROJECT_STRING_EMPTY)
+      continue;
+    size_t slot = StringSlotHash((const char*)table->bytes.data + ref) & mask;
+    while (slots[slot] != PROJECT_STRING_EMPTY)
+      slot = (slot + 1) & mask;
+    slots[slot] = ref;
+  }
+
+  if (table->slots)
+    platformFree(table->slots, table->slotCount * sizeof(uint32_t));
+  table->slots = slots;
+  table->slotCount = newCount;
+  return true;
+}
+
+static bool InternString(ProjectStringTable* table, const char* s, uint32_t* outRef)
+{
+  if (!s || !s[0])
+  {
+    *outRef = 0;
+    return true;
+  }
+
+  if ((table->used + 1) * 2 > table->slotCount && !GrowStringSlots(table))
+    return false;
+
+  size_t mask = table->slotCount - 1;
+  size_t slot = StringSlotHash(s) & mask;
+  while (table->slots[slot] != PROJECT_STRING_EMPTY)
+  {
+    uint32_t ref = table->slots[slot];
+    if (strEquals((const char*)table->bytes.data + ref, s))
+    {
+      *outRef = ref;
+      return true;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  size_t length = strLen(s) + 1;
+  size_t ref = table->bytes.size;
+  if (ref + length >= PROJECT_STRING_EMPTY || !bb_resize(&table->bytes, ref + length))
+    return false;
+  memCopy(table->bytes.data + ref, s, length);
+
+  table->slots[slot] = (uint32_t)ref;
+  table->used++;
+  *outRef = (uint32_t)ref;
+  return true;
+}
+
+static void WriteViewState(uint8_t* block, const ProjectViewState& view)
+{
+  Write64(block + 24, (uint64_t)view.cursor);
+  Write64(block + 32, (uint64_t)view.selectionStart);
+  Write64(block + 40, (uint64_t)view.selectionEnd);
+  Write64(block + 48, view.topByte);
+  Write32(block + 56, view.nibble);
+  Write32(block + 60, view.selectionActive ? 1 : 0);
+}
+
+static void ReadViewState(const uint8_t* block, ProjectViewState* outView)
+{
+  outView->cursor = (int64_t)Read64(block + 24);
+  outView->selectionStart = (int64_t)Read64(block + 32);
+  outView->selectionEnd = (int64_t)Read64(block + 40);
+  outView->topByte = Read64(block + 48);
+  outView->nibble = Read32(block + 56);
+  outView->selectionActive = (Read32(block + 60) & 1) != 0;
+}
+
+// Serialises one block at out->data + prefix. Records are laid down first
+// and the string table appended once its final size is known.
+static bool BuildBlock(ByteBuffer* out, size_t prefix, uint32_t kind,
+                       const ProjectBookmark* bookmarks, size_t bookmarkCount,
+                       const PluginBookmarkArray* annotations, const ProjectViewState& view)
+{
+  size_t annotationCount = annotations ? annotations->count : 0;
+  if (bookmarkCount > 0xFFFFFFFFu || annotationCount > 0xFFFFFFFFu)
+    return false;
+
+  size_t recordStart = prefix + PROJECT_BLOCK_HEADER;
+  size_t recordEnd = recordStart + (bookmarkCount + annotationCount) * PROJECT_RECORD_SIZE;
+  if (!bb_resize(out, recordEnd))
+    return false;
+
+  ProjectStringTable table;
+  bb_init(&table.bytes);
+  table.slots = nullptr;
+  table.slotCount = 0;
+  table.used = 0;
+  bool ok = bb_resize(&table.bytes, 1);
+  if (ok)
+    table.bytes.data[0] = 0;
+
+  uint8_t* record = out->data + recordStart;
+  for (size_t i = 0; ok && i < bookmarkCount; i++, record += PROJECT_RECORD_SIZE)
+  {
+    uint32_t nameRef = 0;
+    uint32_t descRef = 0;
+    ok = InternString(&table, bookmarks[i].name, &nameRef) &&
+         InternString(&table, bookmarks[i].description, &descRef);
+    Write64(record, bookmarks[i].offset);
+    Write32(record + 8, nameRef);
+    Write32(record + 12, descRef);
+    Write32(record + 16, bookmarks[i].color);
+    record[20] = bookmarks[i].byteValue;
+    record[21] = 0;
+    record[22] = 0;
+    record[23] = 0;
+  }
+
+  for (size_t i = 0; ok && i < annotationCount; i++, record += PROJECT_RECORD_SIZE)
+  {
+    const PluginBookmark& a = annotations->bookmarks[i];
+    uint32_t labelRef = 0;
+    uint32_t descRef = 0;
+    uint32_t sourceRef = 0;
+    ok = InternString(&table, a.label, &labelRef) &&
+         InternString(&table, a.description, &descRef) &&
+         InternString(&table, a.pluginSource, &sourceRef);
+    Write64(record, a.offset);
+    Write32(record + 8, labelRef);
+    Write32(record + 12, descRef);
+    Write32(record + 16, sourceRef);
+    record[20] = a.color.r;
+    record[21] = a.color.g;
+    record[22] = a.color.b;
+    record[23] = 0;
+  }
+
+  size_t stringBytes = table.bytes.size;
+  ok = ok && bb_resize(out, recordEnd + stringBytes);
+  if (ok)
+  {
+    memCopy(out->data + recordEnd, table.bytes.data, stringBytes);
+
+    uint8_t* block = out->data + prefix;
+    Write32(block + 8, kind);
+    Write32(block + 12, (uint32_t)stringBytes);
+    Write32(block + 16, (uint32_t)bookmarkCount);
+    Write32(block + 20, (uint32_t)annotationCount);
+    WriteViewState(block, view);
+    Write64(block, PluginCache_HashContent(block + 8, out->size - prefix - 8));
+  }
+
+  FreeStringTable(&table);
+  return ok;
+}
+
+static const uint8_t* BlockStrings(const uint8_t* block)
+{
+  uint64_t records = (uint64_t)Read32(block + 16) + Read32(block + 20);
+  return block + PROJECT_BLOCK_HEADER + records * PROJECT_RECORD_SIZE;
+}
+
+static const char* BlockString(const uint8_t* block, uint32_t ref)
+{
+  if (ref >= Read32(block + 12))
+    return "";
+  return (const char*)BlockStrings(block) + ref;
+}
+
+static bool BlockMatches(const uint8_t* block, const ProjectBookmark* bookmarks, size_t bookmarkCount,
+                         const ProjectViewState& view)
+{
+  ProjectViewState stored;
+  ReadViewState(block, &stored);
+  if (stored.cursor != view.cursor || stored.selectionStart != view.selectionStart ||
+      stored.selectionEnd != view.selectionEnd || stored.topByte != view.topByte ||
+      stored.nibble != view.nibble || stored.selectionActive != view.selectionActive)
+  {
+    return false;
+  }
+  if (Read32(block + 16) != bookmarkCount)
+    return false;
+
+  const uint8_t* record = block + PROJECT_BLOCK_HEADER;
+  for (size_t i = 0; i < bookmarkCount; i++, record += PROJECT_RECORD_SIZE)
+  {
+    const ProjectBookmark& bm = bookmarks[i];
+    if (Read64(record) != bm.offset || Read32(record + 16) != bm.color || record[20] != bm.byteValue)
+      return false;
+    if (!strEquals(BlockString(block, Read32(record + 8)), bm.name ? bm.name : ""))
+      return false;
+    if (!strEquals(BlockString(block, Read32(record + 12)), bm.description ? bm.description : ""))
+      return false;
+  }
+  return true;
+}
+
+// Checks a block's shape and returns its size. The snapshot is replaced
+// atomically and skips the checksum pass; journal blocks are appended in
+// place, so a torn write is caught here.
+static bool ValidateBlock(const uint8_t* block, uint64_t available, bool verifyChecksum, uint64_t* outSize)
+{
+  if (available < PROJECT_BLOCK_HEADER)
+    return false;
+
+  uint64_t stringBytes = Read32(block + 12);
+  uint64_t records = (uint64_t)Read32(block + 16) + Read32(block + 20);
+  uint64_t size = PROJECT_BLOCK_HEADER + records * PROJECT_RECORD_SIZE + stringBytes;
+  if (size > available || stringBytes == 0)
+    return false;
+  if (block[size - 1] != 0)
+    return false;
+  if (verifyChecksum && Read64(block) != PluginCache_HashContent(block + 8, (size_t)(size - 8)))
+    return false;
+
+  *outSize = size;
+  return true;
+}
+
+#ifdef _WIN32
+static bool WriteAt(HANDLE file, uint64_t offset, const uint8_t* data, size_t size)
+{
+  LARGE_INTEGER position;
+  position.QuadPart = (LONGLONG)offset;
+  if (!SetFilePointerEx(file, position, NULL, FILE_BEGIN))
+    return false;
+  DWORD written = 0;
+  return WriteFile(file, data, (DWORD)size, &written, NULL) && written == size;
+}
+#else
+static bool WriteAt(int fd, uint64_t offset, const uint8_t* data, size_t size)
+{
+  size_t total = 0;
+  while (total < size)
+  {
+    ssize_t w = pwrite(fd, data + total, size - total, (off_t)(offset + total));
+    if (w <= 0)
+      return false;
+    total += (size_t)w;
+  }
+  return true;
+}
+#endif
+
+// Writes the block past the current journal end and only then moves the
+// header's journal end over it, so an interrupted append leaves the
+// previous state readable.
+static bool AppendBlock(const char* path, uint64_t offset, const uint8_t* data, size_t size)
+{
+  uint8_t end[8];
+  Write64(end, offset + size);
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  bool ok = WriteAt(file, offset, data, size) && WriteAt(file, PROJECT_HEADER_JOURNAL_END, end, 8);
+  CloseHandle(file);
+  return ok;
+#else
+  int fd = open(path, O_WRONLY);
+  if (fd < 0)
+    return false;
+  bool ok = WriteAt(fd, offset, data, size) && WriteAt(fd, PROJECT_HEADER_JOURNAL_END, end, 8);
+  close(fd);
+  return ok;
+#endif
+}
+
+static bool WriteWholeFile(const char* path, const uint8_t* data, size_t size)
+{
+  char tempPath[PROJECT_PATH_MAX + 8];
+  strCopy(tempPath, path);
+  strCat(tempPath, ".tmp");
+
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(tempPath, GENERIC_WRITE, 0, NULL,
+                             CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  bool ok = WriteAt(hFile, 0, data, size);
+  CloseHandle(hFile);
+
+  if (!ok)
+  {
+    DeleteFileA(tempPath);
+    return false;
+  }
+  return MoveFileExA(tempPath, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+
+  bool ok = WriteAt(fd, 0, data, size);
+  close(fd);
+
+  if (!ok)
+  {
+    unlink(tempPath);
+    return false;
+  }
+  return rename(tempPath, path) == 0;
+#endif
+}
+
+ProjectFile::ProjectFile()
+  : mappedBase(nullptr), mappedSize(0), mappedFile(nullptr), mappedMapping(nullptr)
+{
+  reset();
+}
+
+ProjectFile::~ProjectFile()
+{
+  close();
+}
+
+void ProjectFile::reset()
+{
+  close();
+  path[0] = '\0';
+  memSet(&view, 0, sizeof(view));
+  view.cursor = -1;
+  view.selectionStart = -1;
+  view.selectionEnd = -1;
+  contentMatches = false;
+  stored = false;
+  storedContentSize = 0;
+  storedFingerprint = 0;
+  storedAnnotationHash = 0;
+  snapshotEnd = 0;
+  journalEnd = 0;
+  baseValid = false;
+  baseContentSize = 0;
+  baseFingerprint = 0;
+}
+
+bool ProjectFile::map(const char* filePath)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize;
+  HANDLE mapping = NULL;
+  void* base = nullptr;
+  if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping)
+    base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+  if (!base)
+  {
+    if (mapping)
+      CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  mappedFile = file;
+  mappedMapping = mapping;
+  mappedBase = (const uint8_t*)base;
+  mappedSize = (uint64_t)fileSize.QuadPart;
+  return true;
+#else
+  int fd = ::open(filePath, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  void* base = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+      (uint64_t)st.st_size <= (uint64_t)(size_t)-1)
+  {
+    base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+
+  if (base == MAP_FAILED)
+    return false;
+
+  mappedBase = (const uint8_t*)base;
+  mappedSize = (uint64_t)st.st_size;
+  return true;
+#endif
+}
+
+void ProjectFile::close()
+{
+  if (mappedBase)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(mappedBase);
+    CloseHandle((HANDLE)mappedMapping);
+    CloseHandle((HANDLE)mappedFile);
+#else
+    munmap((void*)mappedBase, (size_t)mappedSize);
+#endif
+  }
+
+  mappedBase = nullptr;
+  mappedSize = 0;
+  mappedFile = nullptr;
+  mappedMapping = nullptr;
+  snapshot = nullptr;
+  current = nullptr;
+}
+
+bool ProjectFile::parse(uint64_t contentSize, uint64_t fingerprint)
+{
+  if (mappedSize < PROJECT_HEADER_SIZE)
+    return false;
+  if (Read32(mappedBase) != PROJECT_FILE_MAGIC || Read32(mappedBase + 4) != PROJECT_FILE_VERSION)
+    return false;
+
+  uint64_t headerSnapshotEnd = Read64(mappedBase + 32);
+  uint64_t headerJournalEnd = Read64(mappedBase + PROJECT_HEADER_JOURNAL_END);
+  if (headerJournalEnd > mappedSize || headerSnapshotEnd > headerJournalEnd)
+    return false;
+
+  uint64_t blockSize = 0;
+  const uint8_t* block = mappedBase + PROJECT_HEADER_SIZE;
+  if (headerSnapshotEnd < PROJECT_HEADER_SIZE ||
+      !ValidateBlock(block, headerSnapshotEnd - PROJECT_HEADER_SIZE, false, &blockSize) ||
+      blockSize != headerSnapshotEnd - PROJECT_HEADER_SIZE ||
+      Read32(block + 8) != PROJECT_BLOCK_SNAPSHOT)
+  {
+    return false;
+  }
+
+  snapshot = block;
+  current = block;
+
+  // The last intact journal block wins; anything after a damaged one is
+  // dropped and overwritten by the next append.
+  uint64_t position = headerSnapshotEnd;
+  while (position < headerJournalEnd)
+  {
+    block = mappedBase + position;
+    if (!ValidateBlock(block, headerJournalEnd - position, true, &blockSize) ||
+        Read32(block + 8) != PROJECT_BLOCK_JOURNAL || Read32(block + 20) != 0)
+    {
+      break;
+    }
+    current = block;
+    position += blockSize;
+  }
+
+  storedContentSize = Read64(mappedBase + 8);
+  storedFingerprint = Read64(mappedBase + 16);
+  storedAnnotationHash = Read64(mappedBase + 24);
+  snapshotEnd = headerSnapshotEnd;
+  journalEnd = position;
+  stored = true;
+  contentMatches = storedContentSize == contentSize && storedFingerprint == fingerprint;
+  ReadViewState(current, &view);
+  return true;
+}
+
+bool ProjectFile::open(const char* dataPath, uint64_t contentSize, uint64_t fingerprint)
+{
+  reset();
+  if (!BuildProjectPath(dataPath, path))
+    return false;
+
+  baseValid = true;
+  baseContentSize = contentSize;
+  baseFingerprint = fingerprint;
+  if (!map(path))
+    return false;
+  if (!parse(contentSize, fingerprint))
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+size_t ProjectFile::getBookmarkCount() const
+{
+  return current ? Read32(current + 16) : 0;
+}
+
+bool ProjectFile::getBookmark(size_t index, ProjectBookmark* outBookmark) const
+{
+  if (index >= getBookmarkCount())
+    return false;
+
+  const uint8_t* record = current + PROJECT_BLOCK_HEADER + index * PROJECT_RECORD_SIZE;
+  outBookmark->offset = Read64(record);
+  outBookmark->name = BlockString(current, Read32(record + 8));
+  outBookmark->description = BlockString(current, Read32(record + 12));
+  outBookmark->color = Read32(record + 16);
+  outBookmark->byteValue = record[20];
+  return true;
+}
+
+size_t ProjectFile::getAnnotationCount() const
+{
+  return snapshot && contentMatches ? Read32(snapshot + 20) : 0;
+}
+
+bool ProjectFile::loadAnnotations(PluginBookmarkArray* outAnnotations) const
+{
+  pba_free(outAnnotations);
+
+  size_t count = getAnnotationCount();
+  if (count == 0)
+    return true;
+
+  PluginBookmark* annotations = (PluginBookmark*)platformAlloc(count * sizeof(PluginBookmark));
+  if (!annotations)
+    return false;
+
+  const uint8_t* record = snapshot + PROJECT_BLOCK_HEADER + (size_t)Read32(snapshot + 16) * PROJECT_RECORD_SIZE;
+  for (size_t i = 0; i < count; i++, record += PROJECT_RECORD_SIZE)
+  {
+    PluginBookmark& a = annotations[i];
+    a.offset = Read64(record);
+    stringCopy(a.label, BlockString(snapshot, Read32(record + 8)), sizeof(a.label));
+    stringCopy(a.description, BlockString(snapshot, Read32(record + 12)), sizeof(a.description));
+    stringCopy(a.pluginSource, BlockString(snapshot, Read32(record + 16)), sizeof(a.pluginSource));
+    a.color = PluginColor(record[20], record[21], record[22]);
+  }
+
+  outAnnotations->bookmarks = annotations;
+  outAnnotations->count = count;
+  outAnnotations->capacity = count;
+  pba_sort(outAnnotations);
+  return true;
+}
+
+bool ProjectFile::save(const char* dataPath, uint64_t contentSize, uint64_t fingerprint,
+                       const ProjectBookmark* bookmarks, size_t bookmarkCount,
+                       const PluginBookmarkArray* annotations, const ProjectViewState& viewState)
+{
+  char target[PROJECT_PATH_MAX];
+  if (!BuildProjectPath(dataPath, target))
+    return false;
+  if (!strEquals(target, path))
+    reset();
+
+  // Files that never had bookmarks or annotations get no sidecar.
+  size_t annotationCount = annotations ? annotations->count : 0;
+  if (!stored && bookmarkCount == 0 && annotationCount == 0)
+    return true;
+
+  uint64_t annotationHash = HashAnnotations(annotations);
+  bool sameBase = stored && storedContentSize == contentSize &&
+                  storedFingerprint == fingerprint && storedAnnotationHash == annotationHash;
+
+  if (sameBase && current && BlockMatches(current, bookmarks, bookmarkCount, viewState))
+    return true;
+
+  ByteBuffer out;
+  bb_init(&out);
+  bool written = false;
+  if (sameBase && BuildBlock(&out, 0, PROJECT_BLOCK_JOURNAL, bookmarks, bookmarkCount, nullptr, viewState))
+  {
+    if (journalEnd - snapshotEnd + out.size <= PROJECT_JOURNAL_LIMIT)
+    {
+      close();
+      written = AppendBlock(target, journalEnd, out.data, out.size);
+    }
+  }
+
+  if (!written)
+  {
+    close();
+    if (BuildBlock(&out, PROJECT_HEADER_SIZE, PROJECT_BLOCK_SNAPSHOT, bookmarks, bookmarkCount, annotations, viewState))
+    {
+      memSet(out.data, 0, PROJECT_HEADER_SIZE);
+      Write32(out.data, PROJECT_FILE_MAGIC);
+      Write32(out.data + 4, PROJECT_FILE_VERSION);
+      Write64(out.data + 8, contentSize);
+      Write64(out.data + 16, fingerprint);
+      Write64(out.data + 24, annotationHash);
+      Write64(out.data + 32, out.size);
+      Write64(out.data + PROJECT_HEADER_JOURNAL_END, out.size);
+      written = WriteWholeFile(target, out.data, out.size);
+    }
+  }
+
+  bb_free(&out);
+  if (!written)
+    return false;
+
+  open(dataPath, contentSize, fingerprint);
+  return true;
+}
+
+// Used while the buffer holds unsaved edits: the content on disk is still
+// the one last opened or saved, so its fingerprint and the stored
+// annotations are kept and only bookmarks and view state change.
+bool ProjectFile::saveView(const char* dataPath, const ProjectBookmark* bookmarks, size_t bookmarkCount,
+                           const ProjectViewState& viewState)
+{
+  char target[PROJECT_PATH_MAX];
+  if (!BuildProjectPath(dataPath, target) || !baseValid || !strEquals(target, path))
+    return false;
+
+  PluginBookmarkArray kept;
+  pba_init(&kept);
+  if (!loadAnnotations(&kept))
+    return false;
+
+  bool ok = save(dataPath, baseContentSize, baseFingerprint, bookmarks, bookmarkCount, &kept, viewState);
+  pba_free(&kept);
+  return ok;
+}
@@ -29,6 +29,31 @@ extern long long cursorBytePos;
 int fontSize = g_Options.fontSize;
 const int PANEL_TITLE_HEIGHT = 28;
 
+static void FormatEntropy(double entropy, char *out)
+{
+  int hundredths = (int)(entropy * 100.0 + 0.5);
+  itoaDec(hundredths / 100, out, 8);
+  strCat(out, ".");
+  if (hundredths % 100 < 10)
+    strCat(out, "0");
+  itoaDec(hundredths % 100, out + strLen(out), 8);
+  strCat(out, " bits");
+}
+
+static Color TemplateColor(int index)
+{
+  Color colors[TEMPLATE_PALETTE_SIZE] = {
+      Color(255, 100, 100),
+      Color(100, 200, 100),
+      Color(100, 140, 255),
+      Color(230, 200, 60),
+      Color(220, 100, 220),
+      Color(80, 200, 220),
+      Color(255, 150, 60),
+      Color(160, 120, 255) };
+  return colors[index % TEMPLATE_PALETTE_SIZE];
+}
+
 RenderManager::RenderManager()
     : window(NATIVE_WINDOW_NULL),
   _disasmColumnWidth(300),
@@ -36,14 +61,16 @@ RenderManager::RenderManager()
 #ifdef _WIN32
       ,
       hdc(nullptr), memDC(nullptr), memBitmap(nullptr), oldBitmap(nullptr),
-      font(nullptr), pixels(nullptr)
+      font(nullptr), pixels(nullptr), pixelBitmap(nullptr)
 #elif __APPLE__
       ,
-      context(nullptr), backBuffer(nullptr)
+      context(nullptr), backBuffer(nullptr), pixelImage(nullptr)
 #else
       ,
-      display(nullptr), gc(nullptr), backBuffer(0), fontInfo(nullptr)
+      display(nullptr), gc(nullptr), backBuffer(0), fontInfo(nullptr), pixelPixmap(0)
 #endif
+      ,
+      pixelImageWidth(0), pixelImageHeight(0), pixelImageVersion(0)
 {
   currentTheme = Theme::Dark();
 }
@@ -111,6 +138,12 @@ void RenderManager::cleanup()
 #ifdef _WIN32
   destroyFont();
 
+  if (pixelBitmap)
+  {
+    DeleteObject(pixelBitmap);
+    pixelBitmap = nullptr;
+  }
+
   if (memBitmap)
   {
     SelectObject(memDC, oldBitmap);
@@ -136,6 +169,12 @@ void RenderManager::cleanup()
   }
 
 #elif __APPLE__
+  if (pixelImage)
+  {
+    CGImageRelease(pixelImage);
+    pixelImage = nullptr;
+  }
+
   if (backBuffer)
   {
     platformFree(backBuffer);
@@ -143,6 +182,12 @@ void RenderManager::cleanup()
   }
 
 #else
+  if (pixelPixmap)
+  {
+    XFreePixmap(display, pixelPixmap);
+    pixelPixmap = 0;
+  }
+
   if (backBuffer)
   {
     XFreePixmap(display, backBuffer);
@@ -257,7 +302,7 @@ void RenderManager::UpdateHexMetrics(int leftPanelWidth, int menuBarHeight)
   _charWidth = (int)layout.charWidth;
   _charHeight = (int)layout.lineHeight;
 
-  _hexAreaX = leftPanelWidth + (int)(layout.margin + (10 * layout.charWidth));
+  _hexAreaX = leftPanelWidth + (int)(layout.margin + ((g_HexData.getOffsetDigits() + 2) * layout.charWidth));
   _hexAreaY = menuBarHeight + (int)(layout.margin + layout.headerHeight + 2);
 }
 
@@ -1232,6 +1277,130 @@ void RenderManager::drawX11Pixmap(Pixmap pixmap, int width, int height, int x, i
 }
 #endif
 
+#if defined(_WIN32) || defined(__APPLE__)
+static void ScalePixelImage(const uint32_t *src, int srcWidth, int srcHeight,
+                            uint32_t *dst, int dstWidth, int dstHeight)
+{
+  for (int y = 0; y < dstHeight; y++)
+  {
+    const uint32_t *row = src + (size_t)(y * srcHeight / dstHeight) * srcWidth;
+    for (int x = 0; x < dstWidth; x++)
+      dst[(size_t)y * dstWidth + x] = row[x * srcWidth / dstWidth];
+  }
+}
+#endif
+
+// The platform image is rebuilt only when the source version or the target
+// size changes; every other frame is a single blit.
+void RenderManager::drawPixelImage(const uint32_t *source, int width, int height, uint32_t version, const Rect &dest)
+{
+  if (!source || width <= 0 || height <= 0 || dest.width <= 0 || dest.height <= 0)
+    return;
+
+  bool stale = version != pixelImageVersion ||
+               dest.width != pixelImageWidth ||
+               dest.height != pixelImageHeight;
+
+#ifdef _WIN32
+  if (!memDC)
+    return;
+  if (stale || !pixelBitmap)
+  {
+    if (pixelBitmap)
+      DeleteObject(pixelBitmap);
+
+    BITMAPINFO info;
+    memSet(&info, 0, sizeof(BITMAPINFO));
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = dest.width;
+    info.bmiHeader.biHeight = -dest.height;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    void *bits = nullptr;
+    pixelBitmap = CreateDIBSection(memDC, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (!pixelBitmap)
+      return;
+    ScalePixelImage(source, width, height, (uint32_t *)bits, dest.width, dest.height);
+  }
+  drawBitmap(pixelBitmap, dest.width, dest.height, dest.x, dest.y);
+
+#elif __APPLE__
+  if (!context)
+    return;
+  if (stale || !pixelImage)
+  {
+    if (pixelImage)
+      CGImageRelease(pixelImage);
+    pixelImage = nullptr;
+
+    uint32_t *scaled = (uint32_t *)platformAlloc((size_t)dest.width * dest.height * 4);
+    if (!scaled)
+      return;
+    ScalePixelImage(source, width, height, scaled, dest.width, dest.height);
+
+    CGColorSpaceRef space = CGColorSpaceCreateDeviceRGB();
+    CGContextRef bitmap = CGBitmapContextCreate(scaled, dest.width, dest.height, 8, dest.width * 4, space,
+                                                kCGImageAlphaNoneSkipFirst | kCGBitmapByteOrder32Little);
+    if (bitmap)
+    {
+      pixelImage = CGBitmapContextCreateImage(bitmap);
+      CGContextRelease(bitmap);
+    }
+    CGColorSpaceRelease(space);
+    platformFree(scaled);
+    if (!pixelImage)
+      return;
+  }
+  CGContextDrawImage(context, CGRectMake(dest.x, flipY(dest.y, dest.height), dest.width, dest.height), pixelImage);
+
+#else
+  if (!display || !backBuffer)
+    return;
+  if (stale || !pixelPixmap)
+  {
+    if (pixelPixmap)
+      XFreePixmap(display, pixelPixmap);
+    pixelPixmap = 0;
+
+    int screen = DefaultScreen(display);
+    int depth = DefaultDepth(display, screen);
+    XImage *ximage = XCreateImage(display, DefaultVisual(display, screen), depth, ZPixmap, 0, nullptr,
+                                  dest.width, dest.height, 32, 0);
+    if (!ximage)
+      return;
+    ximage->data = (char *)platformAlloc((size_t)dest.height * ximage->bytes_per_line);
+    if (!ximage->data)
+    {
+      XDestroyImage(ximage);
+      return;
+    }
+
+    for (int y = 0; y < dest.height; y++)
+    {
+      const uint32_t *row = source + (size_t)(y * height / dest.height) * width;
+      for (int x = 0; x < dest.width; x++)
+        XPutPixel(ximage, x, y, row[x * width / dest.width]);
+    }
+
+    pixelPixmap = XCreatePixmap(display, backBuffer, dest.width, dest.height, depth);
+    GC tempGC = XCreateGC(display, pixelPixmap, 0, nullptr);
+    XPutImage(display, pixelPixmap, tempGC, ximage, 0, 0, 0, 0, dest.width, dest.height);
+    XFreeGC(display, tempGC);
+
+    platformFree(ximage->data);
+    ximage->data = nullptr;
+    XDestroyImage(ximage);
+  }
+  drawX11Pixmap(pixelPixmap, dest.width, dest.height, dest.x, dest.y);
+#endif
+
+  pixelImageVersion = version;
+  pixelImageWidth = dest.width;
+  pixelImageHeight = dest.height;
+}
+
 int MeasureTextHeight(const char *text)
 {
   return 16;
@@ -1500,6 +1669,19 @@ void RenderManager::drawLeftPanel(
     drawText(buf, contentX + 85, currentY, theme.textColor);
     currentY += rowHeight + itemSpacing;
 
+    extern long long selectionLength;
+    if (selectionLength > 1)
+    {
+      ByteRangeStats stats;
+      if (g_HexData.getRangeStats((uint64_t)cursorBytePos, (uint64_t)selectionLength, &stats, BLOCKSTATS_SCAN_CHUNK))
+        FormatEntropy(ByteRangeStats_Entropy(stats), buf);
+      else
+        strCopy(buf, "Indexing...");
+      drawText("Entropy:", contentX, currentY, faded);
+      drawText(buf, contentX + 85, currentY, theme.textColor);
+      currentY += rowHeight + itemSpacing;
+    }
+
     currentY += 8;
   }
   else
@@ -1692,6 +1874,191 @@ void RenderManager::drawLeftPanel(
     }
   }
 
+  currentY += 8;
+
+  drawText("Structure", contentX, currentY, theme.headerColor);
+  currentY += headerHeight + sectionSpacing;
+
+  StructureDecoder* structure = g_HexData.getStructure();
+  if (!structure)
+  {
+    drawText("No ELF, PE or Mach-O headers", contentX, currentY, halfText);
+    currentY += rowHeight + itemSpacing;
+  }
+  else
+  {
+    Vector<int> visible;
+    structure->getVisibleNodes(&visible);
+    int firstRow = clamp(g_StructurePanel.firstRow, 0, visible.empty() ? 0 : (int)visible.size() - 1);
+    int lastRow = firstRow + STRUCTURE_PANEL_ROWS < (int)visible.size() ? firstRow + STRUCTURE_PANEL_ROWS : (int)visible.size();
+    Color valueColor = isDarkTheme ? Color(150, 100, 200) : Color(120, 70, 170);
+
+    if (firstRow > 0)
+    {
+      itoaDec(firstRow, buf, 256);
+      strCat(buf, " rows above");
+      drawText(buf, contentX, currentY, halfText);
+      currentY += rowHeight + itemSpacing;
+    }
+
+    for (int row = firstRow; row < lastRow; row++)
+    {
+      const StructureNode* node = structure->getNode(visible[row]);
+      int textX = contentX + node->depth * 12;
+
+      strCopy(buf, node->expandable ? (node->expanded ? "- " : "+ ") : "  ");
+      strCat(buf, node->label);
+      drawText(buf, textX, currentY, node->kind == STRUCT_NODE_MORE ? halfText : theme.textColor);
+      if (node->value[0])
+        drawText(node->value, textX + measureTextWidth(buf) + 8, currentY, valueColor);
+
+      currentY += rowHeight + itemSpacing;
+    }
+
+    if (lastRow < (int)visible.size())
+    {
+      itoaDec((int)visible.size() - lastRow, buf, 256);
+      strCat(buf, " rows below");
+      drawText(buf, contentX, currentY, halfText);
+      currentY += rowHeight + itemSpacing;
+    }
+  }
+
+  currentY += 8;
+
+  TemplateEngine* templateEngine = g_HexData.getTemplate();
+  strCopy(buf, "Template");
+  if (templateEngine)
+  {
+    strCat(buf, " (");
+    strCat(buf, templateEngine->getName());
+    strCat(buf, ")");
+  }
+  drawText(buf, contentX, currentY, theme.headerColor);
+  currentY += headerHeight + sectionSpacing;
+
+  if (!templateEngine)
+  {
+    drawText("No template applied", contentX, currentY, halfText);
+    currentY += rowHeight + itemSpacing;
+  }
+  else
+  {
+    Vector<int> visible;
+    templateEngine->getVisibleNodes(&visible);
+    int firstRow = clamp(g_TemplatePanel.firstRow, 0, visible.empty() ? 0 : (int)visible.size() - 1);
+    int lastRow = firstRow + TEMPLATE_PANEL_ROWS < (int)visible.size() ? firstRow + TEMPLATE_PANEL_ROWS : (int)visible.size();
+    Color valueColor = isDarkTheme ? Color(150, 100, 200) : Color(120, 70, 170);
+
+    if (firstRow > 0)
+    {
+      itoaDec(firstRow, buf, 256);
+      strCat(buf, " rows above");
+      drawText(buf, contentX, currentY, halfText);
+      currentY += rowHeight + itemSpacing;
+    }
+
+    for (int row = firstRow; row < lastRow; row++)
+    {
+      const TemplateNode* node = templateEngine->getNode(visible[row]);
+      int textX = contentX + node->depth * 12;
+
+      if (node->kind == TPL_NODE_VALUE || (node->kind == TPL_NODE_ARRAY && node->primitive != TPL_STRUCT))
+        drawRect(Rect(textX, currentY + 4, 8, 8), TemplateColor(node->op), true);
+      textX += 12;
+
+      strCopy(buf, node->expandable ? (node->expanded ? "- " : "+ ") : "  ");
+      strCat(buf, node->label);
+      drawText(buf, textX, currentY, node->kind == TPL_NODE_MORE ? halfText : theme.textColor);
+      if (node->value[0])
+        drawText(node->value, textX + measureTextWidth(buf) + 8, currentY, valueColor);
+
+      currentY += rowHeight + itemSpacing;
+    }
+
+    if (lastRow < (int)visible.size())
+    {
+      itoaDec((int)visible.size() - lastRow, buf, 256);
+      strCat(buf, " rows below");
+      drawText(buf, contentX, currentY, halfText);
+      currentY += rowHeight + itemSpacing;
+    }
+  }
+
+  currentY += 8;
+
+  StringIndex* strings = g_HexData.getStrings();
+  strCopy(buf, "Strings");
+  if (strings)
+  {
+    strCat(buf, " (");
+    itoaDec((long long)strings->getCount(), buf + strLen(buf), 64);
+    strCat(buf, strings->isTruncated() ? "+)" : ")");
+  }
+  drawText(buf, contentX, currentY, theme.headerColor);
+  currentY += headerHeight + sectionSpacing;
+
+  if (!strings)
+  {
+    drawText("No strings extracted", contentX, currentY, halfText);
+    currentY += rowHeight + itemSpacing;
+  }
+  else
+  {
+    size_t count = strings->getCount();
+    size_t firstRow = g_StringsPanel.firstRow < count ? g_StringsPanel.firstRow : (count > 0 ? count - 1 : 0);
+    size_t lastRow = count - firstRow > STRINGS_PANEL_ROWS ? firstRow + STRINGS_PANEL_ROWS : count;
+    Color offsetColor = isDarkTheme ? Color(150, 100, 200) : Color(120, 70, 170);
+
+    int encodingX = contentX + measureTextWidth("0x0000000000") + 8;
+    int textX = encodingX + measureTextWidth("BE") + 8;
+    int charWidth = measureTextWidth("W");
+    size_t previewChars = charWidth > 0 && contentX + contentWidth > textX ? (size_t)((contentX + contentWidth - textX) / charWidth) : 0;
+    if (previewChars < 8)
+      previewChars = 8;
+    if (previewChars > 200)
+      previewChars = 200;
+
+    if (firstRow > 0)
+    {
+      itoaDec((long long)firstRow, buf, 256);
+      strCat(buf, " rows above");
+      drawText(buf, contentX, currentY, halfText);
+      currentY += rowHeight + itemSpacing;
+    }
+
+    for (size_t row = firstRow; row < lastRow; row++)
+    {
+      long long offset = (long long)strings->getOffset(row);
+      if (offset == cursorBytePos)
+      {
+        Color selBg = theme.controlCheck;
+        selBg.a = 40;
+        drawRect(Rect(contentX, currentY, contentWidth, rowHeight), selBg, true);
+      }
+
+      strCopy(buf, "0x");
+      itoaHex(offset, buf + 2, 254);
+      drawText(buf, contentX, currentY, offsetColor);
+
+      StringEncoding encoding = strings->getEncoding(row);
+      drawText(encoding == STRING_ASCII ? "A" : (encoding == STRING_UTF16LE ? "LE" : "BE"), encodingX, currentY, halfText);
+
+      strings->format(row, buf, previewChars + 1);
+      drawText(buf, textX, currentY, theme.textColor);
+
+      currentY += rowHeight + itemSpacing;
+    }
+
+    if (lastRow < count)
+    {
+      itoaDec((long long)(count - lastRow), buf, 256);
+      strCat(buf, " rows below");
+      drawText(buf, contentX, currentY, halfText);
+      currentY += rowHeight + itemSpacing;
+    }
+  }
+
   if (state.dockPosition == PanelDockPosition::Floating)
   {
     Rect resizeHandle(
@@ -1818,20 +2185,22 @@ void RenderManager::drawBottomPanel(
       isVertical ? "Entropy" : "Entropy Analysis",
       isVertical ? "Search" : "Hex Pattern Search",
       "Checksum",
-      "Compare"};
+      "Compare",
+      "Byte Map"};
 
   BottomPanelState::Tab tabs[] = {
       BottomPanelState::Tab::EntropyAnalysis,
       BottomPanelState::Tab::PatternSearch,
       BottomPanelState::Tab::Checksum,
-      BottomPanelState::Tab::Compare};
+      BottomPanelState::Tab::Compare,
+      BottomPanelState::Tab::ByteMap};
 
   if (isVertical)
   {
     int y = panelBounds.y + PANEL_TITLE_HEIGHT + 5;
     int w = panelBounds.width - 10;
 
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; i < 5; i++)
     {
       Rect r(panelBounds.x + 5, y, w, tabHeight - 5);
 
@@ -1867,7 +2236,7 @@ void RenderManager::drawBottomPanel(
     int y = panelBounds.y + PANEL_TITLE_HEIGHT + 5;
     int x = panelBounds.x + 10;
 
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; i < 5; i++)
     {
       int w = strLen(tabLabels[i]) * 8 + 20;
       Rect r(x, y, w, tabHeight - 5);
@@ -1902,7 +2271,7 @@ void RenderManager::drawBottomPanel(
 
   int contentX = panelBounds.x + 15;
   int contentY = panelBounds.y + PANEL_TITLE_HEIGHT +
-                 (isVertical ? (tabHeight * 4) : tabHeight) + 10;
+                 (isVertical ? (tabHeight * 5) : tabHeight) + 10;
 
   int contentWidth = panelBounds.width - 30;
   int contentHeight = panelBounds.height - (contentY - panelBounds.y) - 10;
@@ -1920,19 +2289,30 @@ void RenderManager::drawBottomPanel(
     drawRect(graph, graphBg, true);
     drawRect(graph, theme.controlBorder, false);
 
-    int barCount = 50;
-    int barWidth = graph.width / barCount;
+    Color halfText = theme.textColor;
+    halfText.a = 150;
 
+    const float *profile = nullptr;
+    int barCount = Entropy_GetProfile(graph.width / 4, &profile);
+    if (barCount <= 0)
+    {
+      drawText(g_HexData.isEmpty() ? "No data" : "Indexing block statistics...",
+               graph.x + 10, graph.y + 10, halfText);
+      break;
+    }
+
+    int barWidth = graph.width / barCount;
+    int usable = graph.height - 10;
     Color barColor = isDarkTheme ? Color(70, 130, 180) : Color(50, 100, 150);
 
     for (int i = 0; i < barCount; i++)
     {
-      int h = (i * 7 + (i * i) % 31) % (graph.height - 10);
+      int h = (int)(profile[i] * usable / 8.0f);
       Rect bar(graph.x + i * barWidth,
                graph.y + graph.height - h - 5,
-               barWidth - 2,
+               barWidth > 2 ? barWidth - 1 : barWidth,
                h);
-      drawRect(bar, barColor, true);
+      drawRect(bar, profile[i] > 7.5f ? Color(220, 90, 90) : barColor, true);
     }
     break;
   }
@@ -2005,6 +2385,14 @@ void RenderManager::drawBottomPanel(
     drawModernCheckbox(chk, theme, g_Checksum.crc32);
     drawText("CRC32", contentX + 352, y, theme.textColor);
 
+    chk.rect = Rect(contentX + 430, y, 16, 16);
+    drawModernCheckbox(chk, theme, g_Checksum.ssdeep);
+    drawText("ssdeep", contentX + 452, y, theme.textColor);
+
+    chk.rect = Rect(contentX + 530, y, 16, 16);
+    drawModernCheckbox(chk, theme, g_Checksum.tlsh);
+    drawText("TLSH", contentX + 552, y, theme.textColor);
+
     contentY += 35;
 
     WidgetState radio;
@@ -2029,6 +2417,152 @@ void RenderManager::drawBottomPanel(
     btn.rect = Rect(contentX + 110, contentY, 150, 28);
     drawModernButton(btn, theme, "Hash Calculator");
 
+    contentY += 38;
+    int bottom = panelBounds.y + panelBounds.height - 4;
+    Color halfText = theme.textColor;
+    halfText.a = 150;
+
+    if (checksums.fuzzyValid && g_Checksum.ssdeep && contentY + 18 < bottom)
+    {
+      drawText("ssdeep", contentX, contentY, halfText);
+      drawText(checksums.fuzzy.ssdeep, contentX + 60, contentY, theme.textColor);
+      contentY += 20;
+    }
+    if (checksums.fuzzyValid && g_Checksum.tlsh && contentY + 18 < bottom)
+    {
+      drawText("TLSH", contentX, contentY, halfText);
+      drawText(checksums.fuzzy.tlsh[0] ? checksums.fuzzy.tlsh : "Needs at least 50 bytes with some variety",
+               contentX + 60, contentY, checksums.fuzzy.tlsh[0] ? theme.textColor : halfText);
+      contentY += 20;
+    }
+
+    if (checksums.digestsScanned > 0 && contentY + 18 < bottom)
+    {
+      char buf[256];
+      strCopy(buf, "Matches: ");
+      itoaDec((long long)checksums.matches.size(), buf + strLen(buf), 24);
+      strCat(buf, " of ");
+      itoaDec((long long)checksums.digestsScanned, buf + strLen(buf), 24);
+      strCat(buf, " digests");
+      drawText(buf, contentX, contentY, theme.headerColor);
+      contentY += 20;
+
+      for (size_t i = 0; i < checksums.matches.size() && contentY + 18 < bottom; i++)
+      {
+        const FuzzyMatch& match = checksums.matches[i];
+        if (match.ssdeepScore >= 0)
+        {
+          strCopy(buf, "ssdeep ");
+          itoaDec(match.ssdeepScore, buf + strLen(buf), 8);
+        }
+        else
+        {
+          strCopy(buf, "TLSH ");
+          itoaDec(match.tlshDistance, buf + strLen(buf), 8);
+        }
+        drawText(buf, contentX, contentY, halfText);
+        drawText(match.name, contentX + 100, contentY, theme.textColor);
+        contentY += 20;
+      }
+    }
+
+    break;
+  }
+
+  case BottomPanelState::Tab::ByteMap:
+  {
+    drawText("Byte Map", contentX, contentY, theme.headerColor);
+    contentY += 25;
+
+    Rect imageRect = ByteMap_GetImageRect(contentX, contentY, contentWidth, contentHeight - 25);
+    Color graphBg = isDarkTheme ? Color(20, 20, 25) : Color(240, 240, 245);
+    drawRect(imageRect, graphBg, true);
+
+    ByteMap *map = g_HexData.getByteMap();
+    if (map)
+    {
+      int imageWidth;
+      int imageHeight;
+      uint32_t version;
+      const uint32_t *pixels = map->getImage(g_ByteMapPanel.view, &imageWidth, &imageHeight, &version);
+      drawPixelImage(pixels, imageWidth, imageHeight, version, imageRect);
+    }
+    drawRect(imageRect, theme.controlBorder, false);
+
+    int cx = contentX + imageRect.width + 20;
+    int y = contentY;
+
+    WidgetState radio;
+    radio.enabled = true;
+
+    radio.rect = Rect(cx, y, 16, 16);
+    drawModernRadioButton(radio, theme, g_ByteMapPanel.view == BYTEMAP_DIGRAPH);
+    drawText("Digraph", cx + 22, y, theme.textColor);
+
+    radio.rect = Rect(cx + 130, y, 16, 16);
+    drawModernRadioButton(radio, theme, g_ByteMapPanel.view == BYTEMAP_HILBERT);
+    drawText("Hilbert", cx + 152, y, theme.textColor);
+
+    y += 26;
+
+    radio.rect = Rect(cx, y, 16, 16);
+    drawModernRadioButton(radio, theme, g_ByteMapPanel.entireFile);
+    drawText("Entire File", cx + 22, y, theme.textColor);
+
+    radio.rect = Rect(cx + 130, y, 16, 16);
+    drawModernRadioButton(radio, theme, !g_ByteMapPanel.entireFile);
+    drawText("Selection", cx + 152, y, theme.textColor);
+
+    y += 26;
+
+    WidgetState btn;
+    btn.enabled = true;
+    btn.rect = Rect(cx, y, 100, 28);
+    drawModernButton(btn, theme, "Compute");
+
+    y += 38;
+    int bottom = panelBounds.y + panelBounds.height - 4;
+    Color halfText = theme.textColor;
+    halfText.a = 150;
+
+    if (!map)
+    {
+      if (y + 18 < bottom)
+        drawText("Compute to map the file or selection", cx, y, halfText);
+      break;
+    }
+
+    if (y + 18 < bottom)
+    {
+      char info[128];
+      itoaDec((long long)map->getLength(), info, 24);
+      strCat(info, " bytes at 0x");
+      itoaHex(map->getStart(), info + strLen(info), 24);
+      if (map->isTruncated())
+        strCat(info, " (truncated)");
+      drawText(info, cx, y, theme.textColor);
+      y += 20;
+    }
+
+    if (y + 18 < bottom)
+    {
+      if (g_ByteMapPanel.view == BYTEMAP_DIGRAPH)
+      {
+        drawText("Rows: first byte, columns: next byte", cx, y, halfText);
+      }
+      else
+      {
+        char info[64];
+        itoaDec((long long)map->getBytesPerPixel(), info, 24);
+        strCat(info, " bytes per pixel");
+        drawText(info, cx, y, halfText);
+      }
+      y += 20;
+    }
+
+    if (g_ByteMapPanel.view == BYTEMAP_HILBERT && y + 18 < bottom)
+      drawText("00 black, FF white, text blue, control green, high red", cx, y, halfText);
+
     break;
   }
 
@@ -2708,7 +3242,7 @@ void RenderManager::drawByteStatsContent(
   Color labelColor = Color(theme.textColor.r - 40, theme.textColor.g - 40, theme.textColor.b - 40);
 
   drawText("Entropy:", contentX, contentY, labelColor);
-  strCopy(buf, "<entropy> bits");
+  FormatEntropy(g_ByteStats.entropy, buf);
 
   Color entropyColor = theme.textColor;
   if (g_ByteStats.entropy > 7.5)
@@ -2910,6 +3444,7 @@ void RenderManager::renderHexViewer(
 
   layout.charWidth = (float)_charWidth;
   layout.lineHeight = (float)_charHeight;
+  _hexAreaX = leftPanelWidth + (int)(layout.margin + ((g_HexData.getOffsetDigits() + 2) * layout.charWidth));
 
   int workingHeight = (effectiveWindowHeight > 0) ? effectiveWindowHeight : windowHeight;
 
@@ -2969,7 +3504,6 @@ void RenderManager::renderHexViewer(
   size_t actualEndLine = actualStartLine + hexLines.size();
 
   extern HexData g_HexData;
-  const LineArray& disasmLines = g_HexData.getDisassemblyLines();
 
   extern SelectionState g_Selection;
   if (g_Selection.active)
@@ -3019,13 +3553,16 @@ void RenderManager::renderHexViewer(
 
   if (g_Options.bookmarkHighlights && !g_Bookmarks.bookmarks.empty())
   {
-    for (size_t i = 0; i < g_Bookmarks.bookmarks.size(); i++)
+    long long pageStart = (long long)actualStartLine * _bytesPerLine;
+    long long pageEnd = (long long)actualEndLine * _bytesPerLine;
+
+    for (size_t i = Bookmarks_LowerBound(pageStart); i < g_Bookmarks.bookmarks.size(); i++)
     {
       const Bookmark& bm = g_Bookmarks.bookmarks[i];
-      long long bmLine = bm.byteOffset / _bytesPerLine;
+      if (bm.byteOffset >= pageEnd)
+        break;
 
-      if (bmLine < (long long)actualStartLine || bmLine >= (long long)actualEndLine)
-        continue;
+      long long bmLine = bm.byteOffset / _bytesPerLine;
 
       int displayLine = (int)(bmLine - actualStartLine);
       int yPos = contentY + displayLine * _charHeight;
@@ -3049,6 +3586,199 @@ void RenderManager::renderHexViewer(
     }
   }
 
+  TemplateEngine* templateEngine = g_HexData.getTemplate();
+  if (templateEngine)
+  {
+    uint64_t pageStart = (uint64_t)actualStartLine * _bytesPerLine;
+    uint64_t pageEnd = (uint64_t)actualEndLine * _bytesPerLine;
+    int asciiAreaX = _hexAreaX + (16 * 3 * _charWidth) + (1 * _charWidth);
+
+    Vector<TemplateSpan> spans;
+    templateEngine->getSpans(pageStart, pageEnd, &spans);
+
+    for (size_t i = 0; i < spans.size(); i++)
+    {
+      uint64_t drawStart = spans[i].offset > pageStart ? spans[i].offset : pageStart;
+      uint64_t spanEnd = spans[i].offset + spans[i].size;
+      uint64_t drawEnd = spanEnd < pageEnd ? spanEnd : pageEnd;
+
+      Color spanColor = TemplateColor(spans[i].color);
+      spanColor.a = 60;
+
+      while (drawStart < drawEnd)
+      {
+        uint64_t line = drawStart / _bytesPerLine;
+        uint64_t lineEnd = (line + 1) * _bytesPerLine;
+        if (lineEnd > drawEnd)
+          lineEnd = drawEnd;
+
+        int yPos = contentY + (int)(line - actualStartLine) * _charHeight;
+        int startCol = (int)(drawStart % _bytesPerLine);
+        int endCol = startCol + (int)(lineEnd - drawStart);
+
+        int xStart = _hexAreaX + (startCol * 3 * _charWidth);
+        int xEnd = _hexAreaX + (endCol * 3 * _charWidth) - _charWidth;
+        drawRect(Rect(xStart, yPos, xEnd - xStart, _charHeight), spanColor, true);
+        drawRect(Rect(asciiAreaX + startCol * _charWidth, yPos, (endCol - startCol) * _charWidth, _charHeight),
+                 spanColor, true);
+
+        drawStart = lineEnd;
+      }
+    }
+  }
+
+  TransformPipeline* transform = g_HexData.getTransform();
+  if (transform)
+  {
+    uint64_t pageStart = (uint64_t)actualStartLine * _bytesPerLine;
+    uint64_t pageEnd = (uint64_t)actualEndLine * _bytesPerLine;
+    uint64_t shown = transform->getOutputLength() < transform->getInputLength()
+      ? transform->getOutputLength() : transform->getInputLength();
+    uint64_t drawStart = transform->getStart() > pageStart ? transform->getStart() : pageStart;
+    uint64_t drawEnd = transform->getStart() + shown < pageEnd ? transform->getStart() + shown : pageEnd;
+    int asciiAreaX = _hexAreaX + (16 * 3 * _charWidth) + (1 * _charWidth);
+    Color previewColor(230, 150, 40, 50);
+
+    while (drawStart < drawEnd)
+    {
+      uint64_t line = drawStart / _bytesPerLine;
+      uint64_t lineEnd = (line + 1) * _bytesPerLine;
+      if (lineEnd > drawEnd)
+        lineEnd = drawEnd;
+
+      int yPos = contentY + (int)(line - actualStartLine) * _charHeight;
+      int startCol = (int)(drawStart % _bytesPerLine);
+      int endCol = startCol + (int)(lineEnd - drawStart);
+
+      int xStart = _hexAreaX + (startCol * 3 * _charWidth);
+      int xEnd = _hexAreaX + (endCol * 3 * _charWidth) - _charWidth;
+      drawRect(Rect(xStart, yPos, xEnd - xStart, _charHeight), previewColor, true);
+      drawRect(Rect(asciiAreaX + startCol * _charWidth, yPos, (endCol - startCol) * _charWidth, _charHeight),
+               previewColor, true);
+
+      drawStart = lineEnd;
+    }
+  }
+
+  const PluginBookmarkArray* pluginAnnotations = g_HexData.getPluginAnnotations();
+  if (g_Options.bookmarkHighlights && pluginAnnotations->count > 0)
+  {
+    uint64_t pageStart = (uint64_t)actualStartLine * _bytesPerLine;
+    uint64_t pageEnd = (uint64_t)actualEndLine * _bytesPerLine;
+
+    for (size_t i = pba_lower_bound(pluginAnnotations, pageStart); i < pluginAnnotations->count; i++)
+    {
+      const PluginBookmark& annotation = pluginAnnotations->bookmarks[i];
+      if (annotation.offset >= pageEnd)
+        break;
+
+      int displayLine = (int)(annotation.offset / _bytesPerLine - actualStartLine);
+      int yPos = contentY + displayLine * _charHeight + _charHeight - 2;
+
+      int col = (int)(annotation.offset % _bytesPerLine);
+      int xStart = _hexAreaX + (col * 3 * _charWidth);
+
+      Color underlineColor(annotation.color.r, annotation.color.g, annotation.color.b);
+
+      Rect underline(xStart, yPos, 2 * _charWidth, 2);
+      drawRect(underline, underlineColor, true);
+    }
+
+    if (g_PluginAnnotationHoveredIndex >= 0 &&
+        (size_t)g_PluginAnnotationHoveredIndex < pluginAnnotations->count)
+    {
+      const PluginBookmark& annotation = pluginAnnotations->bookmarks[g_PluginAnnotationHoveredIndex];
+      if (annotation.offset >= pageStart && annotation.offset < pageEnd && annotation.label[0])
+      {
+        int displayLine = (int)(annotation.offset / _bytesPerLine - actualStartLine);
+        int col = (int)(annotation.offset % _bytesPerLine);
+        int labelX = _hexAreaX + (col * 3 * _charWidth);
+        int labelY = contentY + (displayLine + 1) * _charHeight;
+        int labelWidth = measureTextWidth(annotation.label) + 8;
+
+        Color borderColor(annotation.color.r, annotation.color.g, annotation.color.b);
+        drawRect(Rect(labelX, labelY, labelWidth, _charHeight + 4), currentTheme.menuBackground, true);
+        drawRect(Rect(labelX, labelY, labelWidth, _charHeight + 4), borderColor, false);
+        drawText(annotation.label, labelX + 4, labelY + 2, currentTheme.textColor);
+      }
+    }
+  }
+
+  MemoryWatch* memoryWatch = g_HexData.getMemoryWatch();
+  if (memoryWatch && memoryWatch->getGenerationCount() > 0)
+  {
+    Color changeColor = memoryWatch->isLive() ? Color(255, 140, 0) : Color(80, 160, 255);
+    changeColor.a = 90;
+
+    int asciiAreaX = _hexAreaX + (16 * 3 * _charWidth) + (1 * _charWidth);
+    uint8_t changed[64];
+
+    for (size_t line = actualStartLine; line < actualEndLine; line++)
+    {
+      uint64_t lineStart = (uint64_t)line * _bytesPerLine;
+      if (memoryWatch->getChangeFlags(lineStart, (size_t)_bytesPerLine, changed) == 0)
+        continue;
+
+      int yPos = contentY + (int)(line - actualStartLine) * _charHeight;
+
+      int col = 0;
+      while (col < _bytesPerLine)
+      {
+        if (!changed[col])
+        {
+          col++;
+          continue;
+        }
+
+        int runStart = col;
+        while (col < _bytesPerLine && changed[col])
+          col++;
+
+        int xStart = _hexAreaX + (runStart * 3 * _charWidth);
+        int xEnd = _hexAreaX + (col * 3 * _charWidth) - _charWidth;
+        drawRect(Rect(xStart, yPos, xEnd - xStart, _charHeight), changeColor, true);
+        drawRect(Rect(asciiAreaX + runStart * _charWidth, yPos, (col - runStart) * _charWidth, _charHeight),
+                 changeColor, true);
+      }
+    }
+  }
+
+  const ValueScanner& scanner = g_HexData.getValueScanner();
+  if (scanner.hasResults() && scanner.getCandidateCount() > 0)
+  {
+    int asciiAreaX = _hexAreaX + (16 * 3 * _charWidth) + (1 * _charWidth);
+    uint8_t candidate[64];
+
+    for (size_t line = actualStartLine; line < actualEndLine; line++)
+    {
+      uint64_t lineStart = (uint64_t)line * _bytesPerLine;
+      if (scanner.getCandidateFlags(lineStart, (size_t)_bytesPerLine, candidate) == 0)
+        continue;
+
+      int yPos = contentY + (int)(line - actualStartLine) * _charHeight + _charHeight - 2;
+
+      int col = 0;
+      while (col < _bytesPerLine)
+      {
+        if (!candidate[col])
+        {
+          col++;
+          continue;
+        }
+
+        int runStart = col;
+        while (col < _bytesPerLine && candidate[col])
+          col++;
+
+        int xStart = _hexAreaX + (runStart * 3 * _charWidth);
+        int xEnd = _hexAreaX + (col * 3 * _charWidth) - _charWidth;
+        drawRect(Rect(xStart, yPos, xEnd - xStart, 2), Color(80, 200, 120), true);
+        drawRect(Rect(asciiAreaX + runStart * _charWidth, yPos, (col - runStart) * _charWidth, 2),
+                 Color(80, 200, 120), true);
+      }
+    }
+  }
+
   for (size_t i = 0; i < hexLines.size(); i++)
   {
     int y = contentY + (int)(i * layout.lineHeight);
@@ -3060,13 +3790,11 @@ void RenderManager::renderHexViewer(
       currentTheme.textColor);
 
     size_t actualLineIndex = actualStartLine + i;
-    if (actualLineIndex < disasmLines.count && disasmLines.lines[actualLineIndex].data != nullptr)
+    const char* disasmText = g_HexData.getDisassemblyLine(actualLineIndex);
+    if (disasmText)
     {
-      if (disasmLines.lines[actualLineIndex].length > 0)
-      {
-        int disasmX = separatorX + 10;
-        drawText(disasmLines.lines[actualLineIndex].data, disasmX, y, currentTheme.disassemblyColor);
-      }
+      int disasmX = separatorX + 10;
+      drawText(disasmText, disasmX, y, currentTheme.disassemblyColor);
     }
   }
 
@@ -0,0 +1,551 @@
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STRING_HAVE_SSE2 1
+#endif
+
+#include "stringindex.h"
+
+#define STRING_CLASS_PRINTABLE 1
+#define STRING_CLASS_ZERO 2
+#define STRING_BLOCK_SIZE 64
+#define STRING_STREAM_COUNT 5
+#define STRING_REMOVED (~0ull)
+
+struct StringStream
+{
+  Vector<uint64_t> found;
+  uint64_t start;
+  StringEncoding encoding;
+  int stride;
+  bool running;
+  bool skip;
+};
+
+struct StringJob
+{
+  const uint8_t* data;
+  uint64_t size;
+  uint32_t minLength;
+  Vector<uint64_t>* chunks;
+  size_t chunkCount;
+  volatile long nextChunk;
+};
+
+struct StringWorker
+{
+  StringJob* job;
+#ifdef _WIN32
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+  bool started;
+};
+
+static uint8_t g_StringClass[256];
+static bool g_StringClassBuilt = false;
+
+const char* StringEncodingName(StringEncoding encoding)
+{
+  switch (encoding)
+  {
+  case STRING_ASCII: return "ASCII";
+  case STRING_UTF16LE: return "UTF-16LE";
+  case STRING_UTF16BE: return "UTF-16BE";
+  }
+  return "?";
+}
+
+static void StringBuildClassTable()
+{
+  if (g_StringClassBuilt)
+    return;
+  for (int c = 0; c < 256; c++)
+  {
+    uint8_t cls = 0;
+    if ((c >= 0x20 && c < 0x7F) || c == '\t')
+      cls |= STRING_CLASS_PRINTABLE;
+    if (c == 0)
+      cls |= STRING_CLASS_ZERO;
+    g_StringClass[c] = cls;
+  }
+  g_StringClassBuilt = true;
+}
+
+static inline unsigned StringCtz(uint64_t mask)
+{
+#ifdef _MSC_VER
+  unsigned long bit;
+  if (_BitScanForward(&bit, (unsigned long)mask))
+    return (unsigned)bit;
+  _BitScanForward(&bit, (unsigned long)(mask >> 32));
+  return (unsigned)bit + 32;
+#else
+  return (unsigned)__builtin_ctzll(mask);
+#endif
+}
+
+// Gathers bits 0, 2, 4, ... 62 into the low 32 bits, so each UTF-16 parity
+// becomes a dense mask with one bit per code unit.
+static inline uint64_t StringEvenBits(uint64_t x)
+{
+  x &= 0x5555555555555555ull;
+  x = (x | (x >> 1)) & 0x3333333333333333ull;
+  x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+  x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+  x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+  x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+  return x;
+}
+
+static void StringClassifyBlock(const uint8_t* p, size_t avail, uint64_t* outPrintable, uint64_t* outZero)
+{
+#ifdef STRING_HAVE_SSE2
+  if (avail >= STRING_BLOCK_SIZE)
+  {
+    const __m128i below = _mm_set1_epi8(0x1F);
+    const __m128i above = _mm_set1_epi8(0x7F);
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t printable = 0;
+    uint64_t zeros = 0;
+    for (int i = 0; i < 4; i++)
+    {
+      __m128i v = _mm_loadu_si128((const __m128i*)(p + i * 16));
+      // Signed compares: bytes from 0x80 up are negative and fall outside.
+      __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above));
+      inRange = _mm_or_si128(inRange, _mm_cmpeq_epi8(v, tab));
+      printable |= (uint64_t)(uint32_t)_mm_movemask_epi8(inRange) << (i * 16);
+      zeros |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) << (i * 16);
+    }
+    *outPrintable = printable;
+    *outZero = zeros;
+    return;
+  }
+#endif
+
+  uint64_t printable = 0;
+  uint64_t zeros = 0;
+  size_t n = avail < STRING_BLOCK_SIZE ? avail : STRING_BLOCK_SIZE;
+  for (size_t i = 0; i < n; i++)
+  {
+    uint8_t cls = g_StringClass[p[i]];
+    if (cls & STRING_CLASS_PRINTABLE)
+      printable |= 1ull << i;
+    if (cls & STRING_CLASS_ZERO)
+      zeros |= 1ull << i;
+  }
+  *outPrintable = printable;
+  *outZero = zeros;
+}
+
+static void StringClose(StringStream* stream, uint64_t end, uint32_t minLength)
+{
+  stream->running = false;
+  if (stream->skip)
+    return;
+
+  uint64_t chars = (end - stream->start) / (uint64_t)stream->stride;
+  if (chars < minLength)
+    return;
+
+  uint64_t offset = stream->start;
+  while (chars > 0 && stream->found.size() < STRING_MAX_RESULTS)
+  {
+    uint64_t piece = chars > STRING_MAX_LENGTH ? STRING_MAX_LENGTH : chars;
+    stream->found.push_back(offset | (piece << STRING_OFFSET_BITS) |
+                            ((uint64_t)stream->encoding << (STRING_OFFSET_BITS + STRING_LENGTH_BITS)));
+    offset += piece * (uint64_t)stream->stride;
+    chars -= piece;
+  }
+}
+
+// Bit i of mask says whether the code unit at base + i * stride belongs to a
+// string. Runs are opened only below limit, but an open run is followed to
+// its end wherever that is.
+static void StringFeed(StringStream* stream, uint64_t mask, int width, uint64_t base, uint64_t limit, uint32_t minLength)
+{
+  uint64_t full = width == 64 ? ~0ull : ((1ull << width) - 1);
+  int bit = 0;
+  while (bit < width)
+  {
+    if (stream->running)
+    {
+      uint64_t gaps = ~mask & full & (~0ull << bit);
+      if (!gaps)
+        return;
+      bit = (int)StringCtz(gaps);
+      StringClose(stream, base + (uint64_t)bit * stream->stride, minLength);
+    }
+    else
+    {
+      uint64_t ones = mask & (~0ull << bit);
+      if (!ones)
+        return;
+      bit = (int)StringCtz(ones);
+      uint64_t position = base + (uint64_t)bit * stream->stride;
+      if (position >= limit)
+        return;
+      stream->running = true;
+      stream->skip = false;
+      stream->start = position;
+    }
+  }
+}
+
+static void StringScanChunk(StringJob* job, size_t chunkIndex)
+{
+  const uint8_t* data = job->data;
+  uint64_t size = job->size;
+  uint64_t start = (uint64_t)chunkIndex * STRING_CHUNK_SIZE;
+  uint64_t end = start + STRING_CHUNK_SIZE < size ? start + STRING_CHUNK_SIZE : size;
+
+  StringStream streams[STRING_STREAM_COUNT];
+  const StringEncoding encodings[STRING_STREAM_COUNT] = {
+    STRING_ASCII, STRING_UTF16LE, STRING_UTF16LE, STRING_UTF16BE, STRING_UTF16BE
+  };
+  for (int i = 0; i < STRING_STREAM_COUNT; i++)
+  {
+    streams[i].start = 0;
+    streams[i].encoding = encodings[i];
+    streams[i].stride = i == 0 ? 1 : 2;
+    streams[i].running = false;
+    streams[i].skip = false;
+  }
+
+  // A run still open at the chunk boundary belongs to the previous chunk,
+  // whose worker follows it past its own end; swallow it here.
+  if (start > 0)
+  {
+    uint8_t before2 = g_StringClass[data[start - 2]];
+    uint8_t before1 = g_StringClass[data[start - 1]];
+    uint8_t first = g_StringClass[data[start]];
+    streams[0].running = (before1 & STRING_CLASS_PRINTABLE) != 0;
+    streams[1].running = (before2 & STRING_CLASS_PRINTABLE) && (before1 & STRING_CLASS_ZERO);
+    streams[2].running = (before1 & STRING_CLASS_PRINTABLE) && (first & STRING_CLASS_ZERO);
+    streams[3].running = (before2 & STRING_CLASS_ZERO) && (before1 & STRING_CLASS_PRINTABLE);
+    streams[4].running = (before1 & STRING_CLASS_ZERO) && (first & STRING_CLASS_PRINTABLE);
+    for (int i = 0; i < STRING_STREAM_COUNT; i++)
+      streams[i].skip = streams[i].running;
+  }
+
+  uint32_t minLength = job->minLength;
+  for (uint64_t block = start;; block += STRING_BLOCK_SIZE)
+  {
+    bool open = false;
+    for (int i = 0; i < STRING_STREAM_COUNT; i++)
+      open = open || streams[i].running;
+    if (block >= end && !open)
+      break;
+
+    if (block >= size)
+    {
+      for (int i = 0; i < STRING_STREAM_COUNT; i++)
+        StringFeed(&streams[i], 0, 1, block + (i == 2 || i == 4 ? 1 : 0), end, minLength);
+      break;
+    }
+
+    uint64_t avail = size - block;
+    uint64_t printable, zeros;
+    StringClassifyBlock(data + block, avail < STRING_BLOCK_SIZE ? (size_t)avail : STRING_BLOCK_SIZE, &printable, &zeros);
+
+    // A UTF-16 code unit at byte i also needs byte i + 1, which for the last
+    // one lives in the next block.
+    uint8_t next = avail > STRING_BLOCK_SIZE ? g_StringClass[data[block + STRING_BLOCK_SIZE]] : 0;
+    uint64_t little = printable & ((zeros >> 1) | ((uint64_t)((next & STRING_CLASS_ZERO) != 0) << 63));
+    uint64_t big = zeros & ((printable >> 1) | ((uint64_t)((next & STRING_CLASS_PRINTABLE) != 0) << 63));
+
+    StringFeed(&streams[0], printable, 64, block, end, minLength);
+    StringFeed(&streams[1], StringEvenBits(little), 32, block, end, minLength);
+    StringFeed(&streams[2], StringEvenBits(little >> 1), 32, block + 1, end, minLength);
+    StringFeed(&streams[3], StringEvenBits(big), 32, block, end, minLength);
+    StringFeed(&streams[4], StringEvenBits(big >> 1), 32, block + 1, end, minLength);
+  }
+
+  // Each stream is already in offset order; merge them for the chunk.
+  Vector<uint64_t>& out = job->chunks[chunkIndex];
+  size_t heads[STRING_STREAM_COUNT] = { 0, 0, 0, 0, 0 };
+  for (;;)
+  {
+    int best = -1;
+    uint64_t bestOffset = 0;
+    for (int i = 0; i < STRING_STREAM_COUNT; i++)
+    {
+      if (heads[i] >= streams[i].found.size())
+        continue;
+      uint64_t offset = streams[i].found[heads[i]] & (STRING_MAX_OFFSET - 1);
+      if (best < 0 || offset < bestOffset)
+      {
+        best = i;
+        bestOffset = offset;
+      }
+    }
+    if (best < 0 || out.size() >= STRING_MAX_RESULTS)
+      break;
+    out.push_back(streams[best].found[heads[best]++]);
+  }
+}
+
+static void RunStringJob(StringWorker* worker)
+{
+  StringJob* job = worker->job;
+  for (;;)
+  {
+#ifdef _WIN32
+    size_t index = (size_t)(InterlockedIncrement(&job->nextChunk) - 1);
+#else
+    size_t index = (size_t)__atomic_fetch_add(&job->nextChunk, 1, __ATOMIC_RELAXED);
+#endif
+    if (index >= job->chunkCount)
+      break;
+    StringScanChunk(job, index);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI RunStringWorker(LPVOID param)
+{
+  RunStringJob((StringWorker*)param);
+  return 0;
+}
+#else
+static void* RunStringWorker(void* param)
+{
+  RunStringJob((StringWorker*)param);
+  return nullptr;
+}
+#endif
+
+static size_t StringWorkerCount(size_t chunkCount)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t cpuCount = info.dwNumberOfProcessors;
+#else
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t cpuCount = online > 0 ? (size_t)online : 1;
+#endif
+  if (cpuCount > STRING_MAX_THREADS)
+    cpuCount = STRING_MAX_THREADS;
+  if (cpuCount > chunkCount)
+    cpuCount = chunkCount;
+  return cpuCount > 0 ? cpuCount : 1;
+}
+
+StringIndex::StringIndex()
+  : entries(nullptr), count(0), data(nullptr), size(0), minLength(STRING_MIN_LENGTH), built(false), truncated(false)
+{
+}
+
+StringIndex::~StringIndex()
+{
+  clear();
+}
+
+void StringIndex::clear()
+{
+  if (entries)
+    platformFree(entries, count * sizeof(uint64_t));
+  entries = nullptr;
+  count = 0;
+  data = nullptr;
+  size = 0;
+  built = false;
+  truncated = false;
+}
+
+bool StringIndex::build(const uint8_t* buffer, uint64_t length, uint32_t minimumLength)
+{
+  clear();
+  if (!buffer)
+    return false;
+
+  StringBuildClassTable();
+
+  data = buffer;
+  size = length;
+  minLength = minimumLength > 0 ? minimumLength : 1;
+  uint64_t scanSize = length;
+  if (scanSize > STRING_MAX_OFFSET)
+  {
+    scanSize = STRING_MAX_OFFSET;
+    truncated = true;
+  }
+  if (scanSize == 0)
+  {
+    built = true;
+    return true;
+  }
+
+  StringJob job;
+  job.data = buffer;
+  job.size = scanSize;
+  job.minLength = minLength;
+  job.chunkCount = (size_t)((scanSize + STRING_CHUNK_SIZE - 1) / STRING_CHUNK_SIZE);
+  job.nextChunk = 0;
+  job.chunks = new Vector<uint64_t>[job.chunkCount];
+  if (!job.chunks)
+    return false;
+
+  size_t workerCount = StringWorkerCount(job.chunkCount);
+  StringWorker workers[STRING_MAX_THREADS];
+  for (size_t i = 0; i < workerCount; i++)
+  {
+    workers[i].job = &job;
+    workers[i].started = false;
+  }
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+#ifdef _WIN32
+    workers[i].thread = CreateThread(nullptr, 0, RunStringWorker, &workers[i], 0, nullptr);
+    workers[i].started = workers[i].thread != nullptr;
+#else
+    workers[i].started = pthread_create(&workers[i].thread, nullptr, RunStringWorker, &workers[i]) == 0;
+#endif
+  }
+
+  RunStringJob(&workers[0]);
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+    if (!workers[i].started)
+      continue;
+#ifdef _WIN32
+    WaitForSingleObject(workers[i].thread, INFINITE);
+    CloseHandle(workers[i].thread);
+#else
+    pthread_join(workers[i].thread, nullptr);
+#endif
+  }
+
+  // Every run is owned by the chunk it starts in, so concatenating the
+  // chunks keeps the index sorted by offset.
+  size_t total = 0;
+  for (size_t c = 0; c < job.chunkCount; c++)
+    total += job.chunks[c].size();
+  if (total > STRING_MAX_RESULTS)
+  {
+    total = STRING_MAX_RESULTS;
+    truncated = true;
+  }
+
+  if (total > 0)
+  {
+    entries = (uint64_t*)platformAlloc(total * sizeof(uint64_t));
+    if (!entries)
+    {
+      delete[] job.chunks;
+      clear();
+      return false;
+    }
+  }
+
+  for (size_t c = 0; c < job.chunkCount && count < total; c++)
+  {
+    Vector<uint64_t>& chunk = job.chunks[c];
+    for (size_t i = 0; i < chunk.size() && count < total; i++)
+      entries[count++] = chunk[i];
+  }
+  delete[] job.chunks;
+
+  // UTF-16 text read with the wrong byte order leaves a shadow run one byte
+  // away; keep the longer reading, and little-endian on a tie.
+  size_t lastWide = (size_t)-1;
+  for (size_t i = 0; i < count; i++)
+  {
+    StringEncoding encoding = getEncoding(i);
+    if (encoding == STRING_ASCII)
+      continue;
+    if (lastWide != (size_t)-1 && getEncoding(lastWide) != encoding &&
+        getOffset(lastWide) + getByteLength(lastWide) > getOffset(i))
+    {
+      uint32_t previous = getLength(lastWide);
+      uint32_t current = getLength(i);
+      if (current > previous || (current == previous && encoding == STRING_UTF16LE))
+      {
+        entries[lastWide] = STRING_REMOVED;
+        lastWide = i;
+      }
+      else
+      {
+        entries[i] = STRING_REMOVED;
+      }
+      continue;
+    }
+    lastWide = i;
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (entries[i] != STRING_REMOVED)
+      entries[kept++] = entries[i];
+  }
+  count = kept;
+
+  built = true;
+  return true;
+}
+
+size_t StringIndex::findOffset(uint64_t offset) const
+{
+  size_t low = 0;
+  size_t high = count;
+  while (low < high)
+  {
+    size_t mid = low + (high - low) / 2;
+    if (getOffset(mid) < offset)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+size_t StringIndex::format(size_t index, char* out, size_t outSize) const
+{
+  if (!out || outSize == 0)
+    return 0;
+  out[0] = '\0';
+  if (index >= count || !data)
+    return 0;
+
+  uint64_t offset = getOffset(index);
+  uint64_t chars = getLength(index);
+  StringEncoding encoding = getEncoding(index);
+  size_t room = outSize - 1;
+  bool ellipsis = chars > room && room > 3;
+  size_t shown = (size_t)(chars < room ? chars : room);
+  if (ellipsis)
+    shown = room - 3;
+
+  size_t written = 0;
+  for (size_t i = 0; i < shown; i++)
+  {
+    uint64_t at = encoding == STRING_ASCII ? offset + i : offset + i * 2 + (encoding == STRING_UTF16BE ? 1 : 0);
+    if (at >= size)
+      break;
+    uint8_t c = data[at];
+    if (c == '\t')
+      c = ' ';
+    out[written++] = c >= 0x20 && c < 0x7F ? (char)c : '.';
+  }
+  if (ellipsis)
+  {
+    out[written++] = '.';
+    out[written++] = '.';
+    out[written++] = '.';
+  }
+  out[written] = '\0';
+  return written;
+}
@@ -0,0 +1,1409 @@
+#include "structure.h"
+
+struct StructureName
+{
+  uint32_t id;
+  const char* name;
+};
+
+static const StructureName g_ELFMachines[] = {
+  {3, "x86"}, {8, "MIPS"}, {0x14, "PowerPC"}, {0x15, "PowerPC64"}, {0x28, "ARM"},
+  {0x3E, "x86-64"}, {0xB7, "AArch64"}, {0xF3, "RISC-V"}
+};
+
+static const StructureName g_ELFTypes[] = {
+  {1, "relocatable"}, {2, "executable"}, {3, "shared object"}, {4, "core"}
+};
+
+static const StructureName g_ELFSectionTypes[] = {
+  {0, "NULL"}, {1, "PROGBITS"}, {2, "SYMTAB"}, {3, "STRTAB"}, {4, "RELA"}, {5, "HASH"},
+  {6, "DYNAMIC"}, {7, "NOTE"}, {8, "NOBITS"}, {9, "REL"}, {11, "DYNSYM"}, {14, "INIT_ARRAY"},
+  {15, "FINI_ARRAY"}, {16, "PREINIT_ARRAY"}, {17, "GROUP"}, {18, "SYMTAB_SHNDX"},
+  {0x6FFFFFF6, "GNU_HASH"}, {0x6FFFFFFD, "VERDEF"}, {0x6FFFFFFE, "VERNEED"}, {0x6FFFFFFF, "VERSYM"}
+};
+
+static const StructureName g_ELFSegmentTypes[] = {
+  {0, "PT_NULL"}, {1, "PT_LOAD"}, {2, "PT_DYNAMIC"}, {3, "PT_INTERP"}, {4, "PT_NOTE"},
+  {5, "PT_SHLIB"}, {6, "PT_PHDR"}, {7, "PT_TLS"}, {0x6474E550, "PT_GNU_EH_FRAME"},
+  {0x6474E551, "PT_GNU_STACK"}, {0x6474E552, "PT_GNU_RELRO"}, {0x6474E553, "PT_GNU_PROPERTY"}
+};
+
+static const StructureName g_ELFSymbolTypes[] = {
+  {0, "NOTYPE"}, {1, "OBJECT"}, {2, "FUNC"}, {3, "SECTION"}, {4, "FILE"}, {5, "COMMON"}, {6, "TLS"},
+  {10, "IFUNC"}
+};
+
+static const StructureName g_PEMachines[] = {
+  {0x14C, "x86"}, {0x8664, "x86-64"}, {0x1C0, "ARM"}, {0x1C4, "ARMv7"}, {0xAA64, "ARM64"},
+  {0x200, "IA-64"}
+};
+
+static const StructureName g_MachCPUs[] = {
+  {7, "x86"}, {0x01000007, "x86-64"}, {12, "ARM"}, {0x0100000C, "ARM64"}, {0x0200000C, "ARM64_32"},
+  {18, "PowerPC"}, {0x01000012, "PowerPC64"}
+};
+
+static const StructureName g_MachFileTypes[] = {
+  {1, "object"}, {2, "executable"}, {4, "core"}, {6, "dylib"}, {7, "dylinker"}, {8, "bundle"},
+  {9, "dylib stub"}, {10, "dSYM"}, {11, "kext"}
+};
+
+static const StructureName g_MachCommands[] = {
+  {0x1, "LC_SEGMENT"}, {0x2, "LC_SYMTAB"}, {0x4, "LC_THREAD"}, {0x5, "LC_UNIXTHREAD"},
+  {0xB, "LC_DYSYMTAB"}, {0xC, "LC_LOAD_DYLIB"}, {0xD, "LC_ID_DYLIB"}, {0xE, "LC_LOAD_DYLINKER"},
+  {0xF, "LC_ID_DYLINKER"}, {0x19, "LC_SEGMENT_64"}, {0x1B, "LC_UUID"}, {0x1D, "LC_CODE_SIGNATURE"},
+  {0x1E, "LC_SEGMENT_SPLIT_INFO"}, {0x20, "LC_LAZY_LOAD_DYLIB"}, {0x21, "LC_ENCRYPTION_INFO"},
+  {0x22, "LC_DYLD_INFO"}, {0x24, "LC_VERSION_MIN_MACOSX"}, {0x25, "LC_VERSION_MIN_IPHONEOS"},
+  {0x26, "LC_FUNCTION_STARTS"}, {0x29, "LC_DATA_IN_CODE"}, {0x2A, "LC_SOURCE_VERSION"},
+  {0x2C, "LC_ENCRYPTION_INFO_64"}, {0x32, "LC_BUILD_VERSION"}, {0x80000018, "LC_LOAD_WEAK_DYLIB"},
+  {0x8000001C, "LC_RPATH"}, {0x8000001F, "LC_REEXPORT_DYLIB"}, {0x80000022, "LC_DYLD_INFO_ONLY"},
+  {0x80000023, "LC_LOAD_UPWARD_DYLIB"}, {0x80000028, "LC_MAIN"}, {0x80000033, "LC_DYLD_EXPORTS_TRIE"},
+  {0x80000034, "LC_DYLD_CHAINED_FIXUPS"}
+};
+
+static const char* g_PEDirectoryNames[16] = {
+  "Export", "Import", "Resource", "Exception", "Security", "Base Relocation", "Debug", "Architecture",
+  "Global Pointer", "TLS", "Load Config", "Bound Import", "IAT", "Delay Import", "CLR Runtime", "Reserved"
+};
+
+static const StructureFieldDef g_ELFHeader64[] = {
+  {"Type", 16, 2, false}, {"Machine", 18, 2, true}, {"Version", 20, 4, false}, {"Entry", 24, 8, true},
+  {"PH Offset", 32, 8, true}, {"SH Offset", 40, 8, true}, {"Flags", 48, 4, true},
+  {"Header Size", 52, 2, false}, {"PH Entry Size", 54, 2, false}, {"PH Count", 56, 2, false},
+  {"SH Entry Size", 58, 2, false}, {"SH Count", 60, 2, false}, {"SH String Index", 62, 2, false}
+};
+
+static const StructureFieldDef g_ELFHeader32[] = {
+  {"Type", 16, 2, false}, {"Machine", 18, 2, true}, {"Version", 20, 4, false}, {"Entry", 24, 4, true},
+  {"PH Offset", 28, 4, true}, {"SH Offset", 32, 4, true}, {"Flags", 36, 4, true},
+  {"Header Size", 40, 2, false}, {"PH Entry Size", 42, 2, false}, {"PH Count", 44, 2, false},
+  {"SH Entry Size", 46, 2, false}, {"SH Count", 48, 2, false}, {"SH String Index", 50, 2, false}
+};
+
+static const StructureFieldDef g_ELFSection64[] = {
+  {"Name", 0, 4, true}, {"Type", 4, 4, true}, {"Flags", 8, 8, true}, {"Address", 16, 8, true},
+  {"Offset", 24, 8, true}, {"Size", 32, 8, true}, {"Link", 40, 4, false}, {"Info", 44, 4, false},
+  {"Alignment", 48, 8, false}, {"Entry Size", 56, 8, false}
+};
+
+static const StructureFieldDef g_ELFSection32[] = {
+  {"Name", 0, 4, true}, {"Type", 4, 4, true}, {"Flags", 8, 4, true}, {"Address", 12, 4, true},
+  {"Offset", 16, 4, true}, {"Size", 20, 4, true}, {"Link", 24, 4, false}, {"Info", 28, 4, false},
+  {"Alignment", 32, 4, false}, {"Entry Size", 36, 4, false}
+};
+
+static const StructureFieldDef g_ELFSegment64[] = {
+  {"Type", 0, 4, true}, {"Flags", 4, 4, true}, {"Offset", 8, 8, true}, {"Virtual Address", 16, 8, true},
+  {"Physical Address", 24, 8, true}, {"File Size", 32, 8, true}, {"Memory Size", 40, 8, true},
+  {"Alignment", 48, 8, true}
+};
+
+static const StructureFieldDef g_ELFSegment32[] = {
+  {"Type", 0, 4, true}, {"Offset", 4, 4, true}, {"Virtual Address", 8, 4, true},
+  {"Physical Address", 12, 4, true}, {"File Size", 16, 4, true}, {"Memory Size", 20, 4, true},
+  {"Flags", 24, 4, true}, {"Alignment", 28, 4, true}
+};
+
+static const StructureFieldDef g_PEDosHeader[] = {
+  {"e_magic", 0, 2, true}, {"e_cblp", 2, 2, false}, {"e_cp", 4, 2, false}, {"e_crlc", 6, 2, false},
+  {"e_cparhdr", 8, 2, false}, {"e_minalloc", 10, 2, true}, {"e_maxalloc", 12, 2, true},
+  {"e_ss", 14, 2, true}, {"e_sp", 16, 2, true}, {"e_csum", 18, 2, true}, {"e_ip", 20, 2, true},
+  {"e_cs", 22, 2, true}, {"e_lfarlc", 24, 2, true}, {"e_ovno", 26, 2, false}, {"e_oemid", 36, 2, true},
+  {"e_oeminfo", 38, 2, true}, {"e_lfanew", 60, 4, true}
+};
+
+static const StructureFieldDef g_PEFileHeader[] = {
+  {"Signature", 0, 4, true}, {"Machine", 4, 2, true}, {"NumberOfSections", 6, 2, false},
+  {"TimeDateStamp", 8, 4, true}, {"PointerToSymbolTable", 12, 4, true}, {"NumberOfSymbols", 16, 4, false},
+  {"SizeOfOptionalHeader", 20, 2, false}, {"Characteristics", 22, 2, true}
+};
+
+static const StructureFieldDef g_PEOptional32[] = {
+  {"Magic", 0, 2, true}, {"MajorLinkerVersion", 2, 1, false}, {"MinorLinkerVersion", 3, 1, false},
+  {"SizeOfCode", 4, 4, true}, {"SizeOfInitializedData", 8, 4, true}, {"SizeOfUninitializedData", 12, 4, true},
+  {"AddressOfEntryPoint", 16, 4, true}, {"BaseOfCode", 20, 4, true}, {"BaseOfData", 24, 4, true},
+  {"ImageBase", 28, 4, true}, {"SectionAlignment", 32, 4, true}, {"FileAlignment", 36, 4, true},
+  {"MajorOperatingSystemVersion", 40, 2, false}, {"MinorOperatingSystemVersion", 42, 2, false},
+  {"MajorImageVersion", 44, 2, false}, {"MinorImageVersion", 46, 2, false},
+  {"MajorSubsystemVersion", 48, 2, false}, {"MinorSubsystemVersion", 50, 2, false},
+  {"Win32VersionValue", 52, 4, true}, {"SizeOfImage", 56, 4, true}, {"SizeOfHeaders", 60, 4, true},
+  {"CheckSum", 64, 4, true}, {"Subsystem", 68, 2, false}, {"DllCharacteristics", 70, 2, true},
+  {"SizeOfStackReserve", 72, 4, true}, {"SizeOfStackCommit", 76, 4, true},
+  {"SizeOfHeapReserve", 80, 4, true}, {"SizeOfHeapCommit", 84, 4, true}, {"LoaderFlags", 88, 4, true},
+  {"NumberOfRvaAndSizes", 92, 4, false}
+};
+
+static const StructureFieldDef g_PEOptional64[] = {
+  {"Magic", 0, 2, true}, {"MajorLinkerVersion", 2, 1, false}, {"MinorLinkerVersion", 3, 1, false},
+  {"SizeOfCode", 4, 4, true}, {"SizeOfInitializedData", 8, 4, true}, {"SizeOfUninitializedData", 12, 4, true},
+  {"AddressOfEntryPoint", 16, 4, true}, {"BaseOfCode", 20, 4, true}, {"ImageBase", 24, 8, true},
+  {"SectionAlignment", 32, 4, true}, {"FileAlignment", 36, 4, true},
+  {"MajorOperatingSystemVersion", 40, 2, false}, {"MinorOperatingSystemVersion", 42, 2, false},
+  {"MajorImageVersion", 44, 2, false}, {"MinorImageVersion", 46, 2, false},
+  {"MajorSubsystemVersion", 48, 2, false}, {"MinorSubsystemVersion", 50, 2, false},
+  {"Win32VersionValue", 52, 4, true}, {"SizeOfImage", 56, 4, true}, {"SizeOfHeaders", 60, 4, true},
+  {"CheckSum", 64, 4, true}, {"Subsystem", 68, 2, false}, {"DllCharacteristics", 70, 2, true},
+  {"SizeOfStackReserve", 72, 8, true}, {"SizeOfStackCommit", 80, 8, true},
+  {"SizeOfHeapReserve", 88, 8, true}, {"SizeOfHeapCommit", 96, 8, true}, {"LoaderFlags", 104, 4, true},
+  {"NumberOfRvaAndSizes", 108, 4, false}
+};
+
+static const StructureFieldDef g_PESection[] = {
+  {"VirtualSize", 8, 4, true}, {"VirtualAddress", 12, 4, true}, {"SizeOfRawData", 16, 4, true},
+  {"PointerToRawData", 20, 4, true}, {"PointerToRelocations", 24, 4, true},
+  {"PointerToLinenumbers", 28, 4, true}, {"NumberOfRelocations", 32, 2, false},
+  {"NumberOfLinenumbers", 34, 2, false}, {"Characteristics", 36, 4, true}
+};
+
+static const StructureFieldDef g_MachHeader[] = {
+  {"Magic", 0, 4, true}, {"CPU Type", 4, 4, true}, {"CPU Subtype", 8, 4, true}, {"File Type", 12, 4, false},
+  {"Command Count", 16, 4, false}, {"Commands Size", 20, 4, true}, {"Flags", 24, 4, true}
+};
+
+static const StructureFieldDef g_MachSegment64[] = {
+  {"VM Address", 24, 8, true}, {"VM Size", 32, 8, true}, {"File Offset", 40, 8, true},
+  {"File Size", 48, 8, true}, {"Max Protection", 56, 4, true}, {"Initial Protection", 60, 4, true},
+  {"Section Count", 64, 4, false}, {"Flags", 68, 4, true}
+};
+
+static const StructureFieldDef g_MachSegment32[] = {
+  {"VM Address", 24, 4, true}, {"VM Size", 28, 4, true}, {"File Offset", 32, 4, true},
+  {"File Size", 36, 4, true}, {"Max Protection", 40, 4, true}, {"Initial Protection", 44, 4, true},
+  {"Section Count", 48, 4, false}, {"Flags", 52, 4, true}
+};
+
+#define STRUCT_COUNT(table) (sizeof(table) / sizeof(table[0]))
+
+static const char* StructureLookup(const StructureName* names, size_t count, uint32_t id)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    if (names[i].id == id)
+      return names[i].name;
+  }
+  return nullptr;
+}
+
+static void StructureFormatHex(const char* prefix, uint64_t value, char* out, int max)
+{
+  stringCopy(out, prefix, max);
+  size_t used = strLen(out);
+  if ((int)used + 3 >= max)
+    return;
+  out[used] = '0';
+  out[used + 1] = 'x';
+  itoaHex(value, out + used + 2, max - (int)used - 2);
+}
+
+static void StructureAppend(char* out, const char* text, size_t max)
+{
+  size_t used = strLen(out);
+  for (size_t i = 0; text[i] && used + 1 < max; i++)
+    out[used++] = text[i];
+  out[used] = '\0';
+}
+
+StructureDecoder::StructureDecoder()
+  : data(nullptr),
+    size(0),
+    format(STRUCT_FORMAT_NONE),
+    is64(false),
+    bigEndian(false),
+    imageBase(0),
+    sizeOfHeaders(0),
+    sectionStrings(0),
+    machBase(0),
+    machCommands(0),
+    machCommandCount(0)
+{
+}
+
+StructureDecoder::~StructureDecoder()
+{
+  close();
+}
+
+void StructureDecoder::close()
+{
+  nodes.clear();
+  regions.clear();
+  data = nullptr;
+  size = 0;
+  format = STRUCT_FORMAT_NONE;
+  is64 = false;
+  bigEndian = false;
+  imageBase = 0;
+  sizeOfHeaders = 0;
+  sectionStrings = 0;
+  machBase = 0;
+  machCommands = 0;
+  machCommandCount = 0;
+}
+
+bool StructureDecoder::open(const uint8_t* buffer, uint64_t length)
+{
+  close();
+  if (!buffer || length < 4)
+    return false;
+
+  data = buffer;
+  size = length;
+  addNode(-1, STRUCT_NODE_ROOT, "", 0, 0);
+
+  bool opened = false;
+  if (data[0] == 0x7F && data[1] == 'E' && data[2] == 'L' && data[3] == 'F')
+  {
+    format = STRUCT_FORMAT_ELF;
+    opened = openELF();
+  }
+  else if (data[0] == 'M' && data[1] == 'Z')
+  {
+    format = STRUCT_FORMAT_PE;
+    opened = openPE();
+  }
+  else
+  {
+    format = STRUCT_FORMAT_MACHO;
+    opened = openMachO();
+  }
+
+  if (!opened)
+  {
+    close();
+    return false;
+  }
+
+  SortMemoryRegions(regions);
+  nodes[0].decoded = true;
+  nodes[0].expanded = true;
+  return true;
+}
+
+const char* StructureDecoder::getFormatName() const
+{
+  switch (format)
+  {
+  case STRUCT_FORMAT_ELF:
+    return is64 ? "ELF64" : "ELF32";
+  case STRUCT_FORMAT_PE:
+    return is64 ? "PE32+" : "PE32";
+  case STRUCT_FORMAT_MACHO:
+    return is64 ? "Mach-O 64" : "Mach-O";
+  default:
+    return "";
+  }
+}
+
+const StructureNode* StructureDecoder::getNode(int index) const
+{
+  if (index < 0 || (size_t)index >= nodes.size())
+    return nullptr;
+  return &nodes[index];
+}
+
+bool StructureDecoder::expand(int index)
+{
+  if (index <= 0 || (size_t)index >= nodes.size() || !nodes[index].expandable)
+    return false;
+
+  if (nodes[index].kind == STRUCT_NODE_MORE)
+  {
+    decodeMore(index);
+    return true;
+  }
+
+  if (!nodes[index].decoded)
+  {
+    nodes[index].decoded = true;
+    decodeChildren(index);
+  }
+  nodes[index].expanded = true;
+  return true;
+}
+
+void StructureDecoder::collapse(int index)
+{
+  if (index > 0 && (size_t)index < nodes.size())
+    nodes[index].expanded = false;
+}
+
+bool StructureDecoder::toggle(int index)
+{
+  if (index <= 0 || (size_t)index >= nodes.size() || !nodes[index].expandable)
+    return false;
+  if (nodes[index].expanded)
+  {
+    collapse(index);
+    return true;
+  }
+  return expand(index);
+}
+
+void StructureDecoder::getVisibleNodes(Vector<int>* outNodes) const
+{
+  outNodes->clear();
+  if (nodes.empty())
+    return;
+
+  int current = nodes[0].firstChild;
+  while (current >= 0)
+  {
+    outNodes->push_back(current);
+    const StructureNode& node = nodes[current];
+    if (node.expanded && node.firstChild >= 0)
+    {
+      current = node.firstChild;
+      continue;
+    }
+
+    while (current >= 0 && nodes[current].nextSibling < 0)
+      current = nodes[current].parent;
+    if (current <= 0)
+      break;
+    current = nodes[current].nextSibling;
+  }
+}
+
+bool StructureDecoder::virtualAddressToOffset(uint64_t virtualAddress, uint64_t* outOffset) const
+{
+  size_t lo = 0;
+  size_t hi = regions.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (regions[mid].virtualAddress + regions[mid].size <= virtualAddress)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  // Regions may overlap (ELF segments commonly do), so fall back to a scan
+  // when the nearest region by end address does not contain the address.
+  if (lo < regions.size() && virtualAddress >= regions[lo].virtualAddress)
+  {
+    *outOffset = regions[lo].bufferOffset + (virtualAddress - regions[lo].virtualAddress);
+    return true;
+  }
+  for (size_t i = 0; i < regions.size(); i++)
+  {
+    if (virtualAddress >= regions[i].virtualAddress && virtualAddress - regions[i].virtualAddress < regions[i].size)
+    {
+      *outOffset = regions[i].bufferOffset + (virtualAddress - regions[i].virtualAddress);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool StructureDecoder::offsetToVirtualAddress(uint64_t offset, uint64_t* outVirtualAddress) const
+{
+  for (size_t i = 0; i < regions.size(); i++)
+  {
+    if (offset >= regions[i].bufferOffset && offset - regions[i].bufferOffset < regions[i].size)
+    {
+      *outVirtualAddress = regions[i].virtualAddress + (offset - regions[i].bufferOffset);
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t StructureDecoder::readField(uint64_t offset, size_t width) const
+{
+  if (!inRange(offset, width))
+    return 0;
+
+  uint64_t value = 0;
+  const uint8_t* p = data + offset;
+  for (size_t i = 0; i < width; i++)
+  {
+    size_t shift = bigEndian ? (width - 1 - i) * 8 : i * 8;
+    value |= (uint64_t)p[i] << shift;
+  }
+  return value;
+}
+
+void StructureDecoder::readString(uint64_t offset, char* out, size_t max) const
+{
+  size_t length = 0;
+  while (length + 1 < max && offset + length < size)
+  {
+    uint8_t c = data[offset + length];
+    if (c == 0)
+      break;
+    out[length++] = (c >= 0x20 && c < 0x7F) ? (char)c : '?';
+  }
+  out[length] = '\0';
+}
+
+bool StructureDecoder::rvaToOffset(uint64_t rva, uint64_t* outOffset) const
+{
+  if (rva < sizeOfHeaders && rva < size)
+  {
+    *outOffset = rva;
+    return true;
+  }
+  return virtualAddressToOffset(imageBase + rva, outOffset);
+}
+
+int StructureDecoder::addNode(int parent, StructureNodeKind kind, const char* label, uint64_t offset, uint64_t length)
+{
+  StructureNode node;
+  stringCopy(node.label, label, STRUCT_LABEL_LEN);
+  node.value[0] = '\0';
+  node.offset = offset;
+  node.size = length;
+  node.tableOffset = 0;
+  node.stringOffset = 0;
+  node.entryCount = 0;
+  node.entrySize = 0;
+  node.firstEntry = 0;
+  node.parent = parent;
+  node.firstChild = -1;
+  node.lastChild = -1;
+  node.nextSibling = -1;
+  node.depth = parent > 0 ? nodes[parent].depth + 1 : 0;
+  node.kind = kind;
+  node.expandable = false;
+  node.expanded = false;
+  node.decoded = false;
+
+  int index = (int)nodes.size();
+  nodes.push_back(node);
+  if (parent >= 0)
+  {
+    if (nodes[parent].lastChild >= 0)
+      nodes[nodes[parent].lastChild].nextSibling = index;
+    else
+      nodes[parent].firstChild = index;
+    nodes[parent].lastChild = index;
+  }
+  return index;
+}
+
+int StructureDecoder::addList(int parent, StructureNodeKind kind, const char* label, uint64_t table, uint32_t count, uint32_t entrySize)
+{
+  if (count > STRUCT_MAX_LIST)
+    count = STRUCT_MAX_LIST;
+  uint64_t tableSize = (uint64_t)count * entrySize;
+  if (!inRange(table, tableSize))
+    count = table < size && entrySize > 0 ? (uint32_t)((size - table) / entrySize) : 0;
+
+  int index = addNode(parent, kind, label, table, (uint64_t)count * entrySize);
+  nodes[index].tableOffset = table;
+  nodes[index].entryCount = count;
+  nodes[index].entrySize = entrySize;
+  nodes[index].expandable = count > 0;
+
+  char text[16];
+  itoaDec(count, text, sizeof(text));
+  setValue(index, text);
+  return index;
+}
+
+void StructureDecoder::setValue(int index, const char* value)
+{
+  stringCopy(nodes[index].value, value, STRUCT_VALUE_LEN);
+}
+
+void StructureDecoder::setHexValue(int index, const char* prefix, uint64_t value)
+{
+  StructureFormatHex(prefix, value, nodes[index].value, STRUCT_VALUE_LEN);
+}
+
+void StructureDecoder::addRegion(uint64_t virtualAddress, uint64_t offset, uint64_t length, uint32_t protection, const char* name)
+{
+  if (length == 0 || offset >= size)
+    return;
+  if (length > size - offset)
+    length = size - offset;
+
+  MemoryRegion region;
+  region.virtualAddress = virtualAddress;
+  region.bufferOffset = (size_t)offset;
+  region.size = (size_t)length;
+  region.protection = protection;
+  region.fileOffset = offset;
+  stringCopy(region.name, name, MEMORY_REGION_NAME_LEN);
+  regions.push_back(region);
+}
+
+void StructureDecoder::addFields(int parent, uint64_t base, const StructureFieldDef* fields, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    uint64_t offset = base + fields[i].offset;
+    if (!inRange(offset, fields[i].size))
+      continue;
+
+    uint64_t value = readField(offset, fields[i].size);
+    int index = addNode(parent, STRUCT_NODE_FIELD, fields[i].name, offset, fields[i].size);
+    if (fields[i].hex)
+    {
+      setHexValue(index, "", value);
+    }
+    else
+    {
+      char text[24];
+      itoaDec((long long)value, text, sizeof(text));
+      setValue(index, text);
+    }
+  }
+}
+
+bool StructureDecoder::openELF()
+{
+  if (!inRange(0, 52))
+    return false;
+  if ((data[4] != 1 && data[4] != 2) || (data[5] != 1 && data[5] != 2) || data[6] != 1)
+    return false;
+
+  is64 = data[4] == 2;
+  bigEndian = data[5] == 2;
+  uint64_t headerSize = is64 ? 64 : 52;
+  if (!inRange(0, headerSize) || read16(is64 ? 52 : 40) != headerSize)
+    return false;
+
+  uint16_t type = read16(16);
+  uint16_t machine = read16(18);
+  uint64_t phOffset = is64 ? read64(32) : read32(28);
+  uint64_t shOffset = is64 ? read64(40) : read32(32);
+  uint16_t phEntrySize = read16(is64 ? 54 : 42);
+  uint16_t phCount = read16(is64 ? 56 : 44);
+  uint16_t shEntrySize = read16(is64 ? 58 : 46);
+  uint16_t shCount = read16(is64 ? 60 : 48);
+  uint16_t shStringIndex = read16(is64 ? 62 : 50);
+
+  int header = addNode(0, STRUCT_NODE_FILE_HEADER, "ELF Header", 0, headerSize);
+  nodes[header].expandable = true;
+  const char* machineName = StructureLookup(g_ELFMachines, STRUCT_COUNT(g_ELFMachines), machine);
+  const char* typeName = StructureLookup(g_ELFTypes, STRUCT_COUNT(g_ELFTypes), type);
+  char text[STRUCT_VALUE_LEN];
+  stringCopy(text, machineName ? machineName : "unknown", STRUCT_VALUE_LEN);
+  StructureAppend(text, " ", STRUCT_VALUE_LEN);
+  StructureAppend(text, typeName ? typeName : "file", STRUCT_VALUE_LEN);
+  setValue(header, text);
+
+  uint64_t dynamicOffset = 0;
+  uint64_t dynamicSize = 0;
+  uint32_t phStride = is64 ? 56 : 32;
+  if (phCount > 0 && phEntrySize == phStride)
+  {
+    addList(0, STRUCT_NODE_SEGMENTS, "Program Headers", phOffset, phCount, phEntrySize);
+    for (uint16_t i = 0; i < phCount && inRange(phOffset + (uint64_t)i * phStride, phStride); i++)
+    {
+      uint64_t entry = phOffset + (uint64_t)i * phStride;
+      uint32_t segmentType = read32(entry);
+      uint32_t flags = read32(entry + (is64 ? 4 : 24));
+      uint64_t offset = is64 ? read64(entry + 8) : read32(entry + 4);
+      uint64_t virtualAddress = is64 ? read64(entry + 16) : read32(entry + 8);
+      uint64_t fileSize = is64 ? read64(entry + 32) : read32(entry + 16);
+
+      if (segmentType == 1)
+      {
+        uint32_t protection = 0;
+        if (flags & 4)
+          protection |= MEMORY_PROT_READ;
+        if (flags & 2)
+          protection |= MEMORY_PROT_WRITE;
+        if (flags & 1)
+          protection |= MEMORY_PROT_EXEC;
+        addRegion(virtualAddress, offset, fileSize, protection, "LOAD");
+      }
+      else if (segmentType == 2)
+      {
+        dynamicOffset = offset;
+        dynamicSize = fileSize;
+      }
+    }
+  }
+
+  uint32_t shStride = is64 ? 64 : 40;
+  if (shCount > 0 && shEntrySize == shStride && inRange(shOffset, (uint64_t)shCount * shStride))
+  {
+    addList(0, STRUCT_NODE_SECTIONS, "Section Headers", shOffset, shCount, shEntrySize);
+    if (shStringIndex < shCount)
+      sectionStrings = is64 ? read64(shOffset + (uint64_t)shStringIndex * shStride + 24)
+                            : read32(shOffset + (uint64_t)shStringIndex * shStride + 16);
+
+    for (uint16_t i = 0; i < shCount; i++)
+    {
+      uint64_t entry = shOffset + (uint64_t)i * shStride;
+      uint32_t sectionType = read32(entry + 4);
+      if (sectionType != 2 && sectionType != 11 && sectionType != 6)
+        continue;
+
+      uint64_t offset = is64 ? read64(entry + 24) : read32(entry + 16);
+      uint64_t length = is64 ? read64(entry + 32) : read32(entry + 20);
+      uint32_t link = read32(entry + (is64 ? 40 : 24));
+      uint64_t entrySize = is64 ? read64(entry + 56) : read32(entry + 36);
+      if (sectionType == 6)
+      {
+        dynamicOffset = offset;
+        dynamicSize = length;
+        continue;
+      }
+
+      uint32_t symbolSize = is64 ? 24 : 16;
+      if (entrySize != symbolSize)
+        continue;
+
+      char label[STRUCT_LABEL_LEN];
+      char name[32];
+      name[0] = '\0';
+      if (sectionStrings != 0)
+        readString(sectionStrings + read32(entry), name, sizeof(name));
+      stringCopy(label, "Symbols (", STRUCT_LABEL_LEN);
+      StructureAppend(label, name[0] ? name : (sectionType == 2 ? ".symtab" : ".dynsym"), STRUCT_LABEL_LEN);
+      StructureAppend(label, ")", STRUCT_LABEL_LEN);
+      uint64_t count = length / symbolSize;
+      int symbols = addList(0, STRUCT_NODE_SYMBOLS, label, offset, (uint32_t)(count < STRUCT_MAX_LIST ? count : STRUCT_MAX_LIST), symbolSize);
+      if (link < shCount)
+        nodes[symbols].stringOffset = is64 ? read64(shOffset + (uint64_t)link * shStride + 24)
+                                           : read32(shOffset + (uint64_t)link * shStride + 16);
+    }
+  }
+
+  uint32_t dynamicStride = is64 ? 16 : 8;
+  if (dynamicSize >= dynamicStride && inRange(dynamicOffset, dynamicStride))
+  {
+    int imports = addNode(0, STRUCT_NODE_IMPORTS, "Imports", dynamicOffset, dynamicSize);
+    nodes[imports].tableOffset = dynamicOffset;
+    nodes[imports].entryCount = (uint32_t)(dynamicSize / dynamicStride < STRUCT_MAX_LIST ? dynamicSize / dynamicStride : STRUCT_MAX_LIST);
+    nodes[imports].entrySize = dynamicStride;
+    nodes[imports].expandable = true;
+  }
+  return true;
+}
+
+bool StructureDecoder::openPE()
+{
+  if (!inRange(0, 64))
+    return false;
+  uint32_t peOffset = read32(0x3C);
+  if (!inRange(peOffset, 24) || read32(peOffset) != 0x00004550)
+    return false;
+
+  uint16_t machine = read16(peOffset + 4);
+  uint16_t sectionCount = read16(peOffset + 6);
+  uint16_t optionalSize = read16(peOffset + 20);
+  uint16_t characteristics = read16(peOffset + 22);
+  uint64_t optional = (uint64_t)peOffset + 24;
+  if (optionalSize < 2 || !inRange(optional, optionalSize))
+    return false;
+
+  uint16_t magic = read16(optional);
+  if (magic != 0x10B && magic != 0x20B)
+    return false;
+  is64 = magic == 0x20B;
+  imageBase = is64 ? read64(optional + 24) : read32(optional + 28);
+  sizeOfHeaders = read32(optional + 60);
+
+  int dosHeader = addNode(0, STRUCT_NODE_DOS_HEADER, "DOS Header", 0, 64);
+  nodes[dosHeader].expandable = true;
+  setValue(dosHeader, "MZ");
+
+  int fileHeader = addNode(0, STRUCT_NODE_FILE_HEADER, "File Header", peOffset, 24);
+  nodes[fileHeader].expandable = true;
+  nodes[fileHeader].tableOffset = peOffset;
+  const char* machineName = StructureLookup(g_PEMachines, STRUCT_COUNT(g_PEMachines), machine);
+  char text[STRUCT_VALUE_LEN];
+  stringCopy(text, machineName ? machineName : "unknown", STRUCT_VALUE_LEN);
+  StructureAppend(text, (characteristics & 0x2000) ? " DLL" : " executable", STRUCT_VALUE_LEN);
+  setValue(fileHeader, text);
+
+  int optionalHeader = addNode(0, STRUCT_NODE_OPTIONAL_HEADER, "Optional Header", optional, optionalSize);
+  nodes[optionalHeader].expandable = true;
+  nodes[optionalHeader].tableOffset = optional;
+  setValue(optionalHeader, is64 ? "PE32+" : "PE32");
+
+  uint64_t directories = optional + (is64 ? 112 : 96);
+  uint32_t directoryCount = read32(optional + (is64 ? 108 : 92));
+  if (directoryCount > 16)
+    directoryCount = 16;
+  while (directoryCount > 0 && directories + (uint64_t)directoryCount * 8 > optional + optionalSize)
+    directoryCount--;
+  if (directoryCount > 0)
+    addList(0, STRUCT_NODE_DIRECTORIES, "Data Directories", directories, directoryCount, 8);
+
+  uint64_t sectionTable = optional + optionalSize;
+  int sections = addList(0, STRUCT_NODE_SECTIONS, "Section Headers", sectionTable, sectionCount, 40);
+  sectionCount = (uint16_t)nodes[sections].entryCount;
+
+  addRegion(imageBase, 0, sizeOfHeaders ? sizeOfHeaders : 0x1000, MEMORY_PROT_READ, "headers");
+  for (uint16_t i = 0; i < sectionCount; i++)
+  {
+    uint64_t entry = sectionTable + (uint64_t)i * 40;
+    uint32_t virtualSize = read32(entry + 8);
+    uint32_t virtualAddress = read32(entry + 12);
+    uint32_t rawSize = read32(entry + 16);
+    uint32_t rawOffset = read32(entry + 20);
+    uint32_t flags = read32(entry + 36);
+
+    uint32_t protection = 0;
+    if (flags & 0x40000000)
+      protection |= MEMORY_PROT_READ;
+    if (flags & 0x80000000)
+      protection |= MEMORY_PROT_WRITE;
+    if (flags & 0x20000000)
+      protection |= MEMORY_PROT_EXEC;
+
+    char name[9];
+    readString(entry, name, sizeof(name));
+    addRegion(imageBase + virtualAddress, rawOffset,
+              virtualSize != 0 && virtualSize < rawSize ? virtualSize : rawSize, protection, name);
+  }
+
+  // The directory entries are RVAs, so they can only be resolved once the
+  // section regions exist.
+  SortMemoryRegions(regions);
+  if (directoryCount > 1 && read32(directories + 8) != 0)
+  {
+    uint64_t importOffset;
+    if (rvaToOffset(read32(directories + 8), &importOffset))
+    {
+      int imports = addNode(0, STRUCT_NODE_IMPORTS, "Imports", importOffset, read32(directories + 12));
+      nodes[imports].tableOffset = importOffset;
+      nodes[imports].expandable = true;
+    }
+  }
+
+  uint64_t exportOffset;
+  if (directoryCount > 0 && read32(directories) != 0 && rvaToOffset(read32(directories), &exportOffset) &&
+      inRange(exportOffset, 40))
+  {
+    char label[STRUCT_LABEL_LEN];
+    char name[40];
+    uint64_t nameOffset;
+    name[0] = '\0';
+    if (rvaToOffset(read32(exportOffset + 12), &nameOffset))
+      readString(nameOffset, name, sizeof(name));
+    stringCopy(label, "Exports", STRUCT_LABEL_LEN);
+    if (name[0])
+    {
+      StructureAppend(label, " (", STRUCT_LABEL_LEN);
+      StructureAppend(label, name, STRUCT_LABEL_LEN);
+      StructureAppend(label, ")", STRUCT_LABEL_LEN);
+    }
+
+    uint32_t nameCount = read32(exportOffset + 24);
+    int exports = addNode(0, STRUCT_NODE_EXPORTS, label, exportOffset, 40);
+    nodes[exports].tableOffset = exportOffset;
+    nodes[exports].entryCount = nameCount < STRUCT_MAX_LIST ? nameCount : STRUCT_MAX_LIST;
+    nodes[exports].expandable = nodes[exports].entryCount > 0;
+    itoaDec(nodes[exports].entryCount, text, sizeof(text));
+    setValue(exports, text);
+  }
+  return true;
+}
+
+bool StructureDecoder::openMachO()
+{
+  if (!inRange(0, 8))
+    return false;
+
+  uint32_t magic = (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | data[3];
+  if (magic != 0xCAFEBABE)
+    return openMachSlice(0);
+
+  // Java class files share the fat magic; their version field is far larger
+  // than any real architecture count.
+  bigEndian = true;
+  uint32_t archCount = read32(4);
+  if (archCount == 0 || archCount > 30 || !inRange(8, (uint64_t)archCount * 20))
+    return false;
+
+  addList(0, STRUCT_NODE_ARCHITECTURES, "Fat Architectures", 8, archCount, 20);
+  uint32_t firstSlice = read32(16);
+  if (openMachSlice(firstSlice))
+    return true;
+
+  bigEndian = true;
+  return true;
+}
+
+bool StructureDecoder::openMachSlice(uint64_t base)
+{
+  if (!inRange(base, 28))
+    return false;
+
+  uint32_t magic = (uint32_t)data[base] | (uint32_t)data[base + 1] << 8 | (uint32_t)data[base + 2] << 16 | (uint32_t)data[base + 3] << 24;
+  if (magic == 0xFEEDFACE || magic == 0xFEEDFACF)
+    bigEndian = false;
+  else if (magic == 0xCEFAEDFE || magic == 0xCFFAEDFE)
+    bigEndian = true;
+  else
+    return false;
+  is64 = magic == 0xFEEDFACF || magic == 0xCFFAEDFE;
+
+  uint64_t headerSize = is64 ? 32 : 28;
+  if (!inRange(base, headerSize))
+    return false;
+
+  uint32_t cpu = read32(base + 4);
+  uint32_t fileType = read32(base + 12);
+  uint32_t commandCount = read32(base + 16);
+  uint32_t commandsSize = read32(base + 20);
+  machBase = base;
+  machCommands = base + headerSize;
+  machCommandCount = commandCount < 4096 ? commandCount : 4096;
+
+  int header = addNode(0, STRUCT_NODE_FILE_HEADER, "Mach Header", base, headerSize);
+  nodes[header].expandable = true;
+  nodes[header].tableOffset = base;
+  const char* cpuName = StructureLookup(g_MachCPUs, STRUCT_COUNT(g_MachCPUs), cpu);
+  const char* typeName = StructureLookup(g_MachFileTypes, STRUCT_COUNT(g_MachFileTypes), fileType);
+  char text[STRUCT_VALUE_LEN];
+  stringCopy(text, cpuName ? cpuName : "unknown", STRUCT_VALUE_LEN);
+  StructureAppend(text, " ", STRUCT_VALUE_LEN);
+  StructureAppend(text, typeName ? typeName : "file", STRUCT_VALUE_LEN);
+  setValue(header, text);
+
+  int commands = addNode(0, STRUCT_NODE_LOAD_COMMANDS, "Load Commands", machCommands, commandsSize);
+  nodes[commands].expandable = machCommandCount > 0;
+  itoaDec(commandCount, text, sizeof(text));
+  setValue(commands, text);
+
+  bool hasImports = false;
+  uint64_t symbolOffset = 0;
+  uint32_t symbolCount = 0;
+  uint64_t stringOffset = 0;
+  uint64_t cursor = machCommands;
+  for (uint32_t i = 0; i < machCommandCount && inRange(cursor, 8); i++)
+  {
+    uint32_t command = read32(cursor);
+    uint32_t commandSize = read32(cursor + 4);
+    if (commandSize < 8 || !inRange(cursor, commandSize))
+      break;
+
+    if (command == 0x19 || command == 0x1)
+    {
+      bool segment64 = command == 0x19;
+      uint64_t virtualAddress = segment64 ? read64(cursor + 24) : read32(cursor + 24);
+      uint64_t fileOffset = segment64 ? read64(cursor + 40) : read32(cursor + 32);
+      uint64_t fileSize = segment64 ? read64(cursor + 48) : read32(cursor + 36);
+      uint32_t protection = read32(cursor + (segment64 ? 60 : 44)) & (MEMORY_PROT_READ | MEMORY_PROT_WRITE | MEMORY_PROT_EXEC);
+      char name[17];
+      readString(cursor + 8, name, sizeof(name));
+      addRegion(virtualAddress, base + fileOffset, fileSize, protection, name);
+    }
+    else if (command == 0x2 && commandSize >= 24)
+    {
+      symbolOffset = base + read32(cursor + 8);
+      symbolCount = read32(cursor + 12);
+      stringOffset = base + read32(cursor + 16);
+    }
+    else if (command == 0xC || command == 0x20 || command == 0x80000018 || command == 0x8000001F || command == 0x80000023)
+    {
+      hasImports = true;
+    }
+    cursor += commandSize;
+  }
+
+  if (symbolCount > 0)
+  {
+    int symbols = addList(0, STRUCT_NODE_SYMBOLS, "Symbols", symbolOffset, symbolCount, is64 ? 16 : 12);
+    nodes[symbols].stringOffset = stringOffset;
+  }
+  if (hasImports)
+  {
+    int imports = addNode(0, STRUCT_NODE_IMPORTS, "Imports", machCommands, commandsSize);
+    nodes[imports].expandable = true;
+  }
+  return true;
+}
+
+void StructureDecoder::decodeChildren(int index)
+{
+  switch (nodes[index].kind)
+  {
+  case STRUCT_NODE_DOS_HEADER:
+    addFields(index, 0, g_PEDosHeader, STRUCT_COUNT(g_PEDosHeader));
+    break;
+
+  case STRUCT_NODE_FILE_HEADER:
+    if (format == STRUCT_FORMAT_ELF)
+    {
+      if (is64)
+        addFields(index, 0, g_ELFHeader64, STRUCT_COUNT(g_ELFHeader64));
+      else
+        addFields(index, 0, g_ELFHeader32, STRUCT_COUNT(g_ELFHeader32));
+    }
+    else if (format == STRUCT_FORMAT_PE)
+    {
+      addFields(index, nodes[index].tableOffset, g_PEFileHeader, STRUCT_COUNT(g_PEFileHeader));
+    }
+    else
+    {
+      addFields(index, nodes[index].tableOffset, g_MachHeader, STRUCT_COUNT(g_MachHeader));
+    }
+    break;
+
+  case STRUCT_NODE_OPTIONAL_HEADER:
+    if (is64)
+      addFields(index, nodes[index].tableOffset, g_PEOptional64, STRUCT_COUNT(g_PEOptional64));
+    else
+      addFields(index, nodes[index].tableOffset, g_PEOptional32, STRUCT_COUNT(g_PEOptional32));
+    break;
+
+  case STRUCT_NODE_SEGMENT:
+    if (is64)
+      addFields(index, nodes[index].tableOffset, g_ELFSegment64, STRUCT_COUNT(g_ELFSegment64));
+    else
+      addFields(index, nodes[index].tableOffset, g_ELFSegment32, STRUCT_COUNT(g_ELFSegment32));
+    break;
+
+  case STRUCT_NODE_SECTION:
+    if (format == STRUCT_FORMAT_PE)
+      addFields(index, nodes[index].tableOffset, g_PESection, STRUCT_COUNT(g_PESection));
+    else if (is64)
+      addFields(index, nodes[index].tableOffset, g_ELFSection64, STRUCT_COUNT(g_ELFSection64));
+    else
+      addFields(index, nodes[index].tableOffset, g_ELFSection32, STRUCT_COUNT(g_ELFSection32));
+    break;
+
+  case STRUCT_NODE_DIRECTORIES:
+  case STRUCT_NODE_SEGMENTS:
+  case STRUCT_NODE_SECTIONS:
+  case STRUCT_NODE_SYMBOLS:
+  case STRUCT_NODE_EXPORTS:
+  case STRUCT_NODE_IMPORT_MODULE:
+  case STRUCT_NODE_ARCHITECTURES:
+    decodeList(index, 0);
+    break;
+
+  case STRUCT_NODE_IMPORTS:
+    if (format == STRUCT_FORMAT_ELF)
+      decodeELFImports(index);
+    else if (format == STRUCT_FORMAT_PE)
+      decodePEImports(index);
+    else
+      decodeMachImports(index);
+    break;
+
+  case STRUCT_NODE_LOAD_COMMANDS:
+    decodeMachCommands(index);
+    break;
+
+  case STRUCT_NODE_LOAD_COMMAND:
+    decodeMachSegment(index);
+    break;
+
+  default:
+    break;
+  }
+}
+
+void StructureDecoder::decodeList(int parent, uint32_t start)
+{
+  uint32_t count = nodes[parent].entryCount;
+  uint32_t end = count - start > STRUCT_PAGE_SIZE ? start + STRUCT_PAGE_SIZE : count;
+  for (uint32_t i = start; i < end; i++)
+    decodeEntry(parent, i);
+
+  if (end < count)
+  {
+    char label[STRUCT_LABEL_LEN];
+    char text[16];
+    stringCopy(label, "... ", STRUCT_LABEL_LEN);
+    itoaDec(count - end, text, sizeof(text));
+    StructureAppend(label, text, STRUCT_LABEL_LEN);
+    StructureAppend(label, " more", STRUCT_LABEL_LEN);
+    int more = addNode(parent, STRUCT_NODE_MORE, label, nodes[parent].offset, 0);
+    nodes[more].firstEntry = end;
+    nodes[more].expandable = true;
+  }
+}
+
+void StructureDecoder::decodeMore(int index)
+{
+  int parent = nodes[index].parent;
+  uint32_t start = nodes[index].firstEntry;
+
+  // Unlink the placeholder; the next page is appended in its place and gets
+  // its own placeholder if entries remain.
+  int previous = -1;
+  for (int child = nodes[parent].firstChild; child >= 0 && child != index; child = nodes[child].nextSibling)
+    previous = child;
+  if (previous >= 0)
+    nodes[previous].nextSibling = -1;
+  else
+    nodes[parent].firstChild = -1;
+  nodes[parent].lastChild = previous;
+  nodes[index].expandable = false;
+
+  decodeList(parent, start);
+}
+
+void StructureDecoder::decodeEntry(int parent, uint32_t entry)
+{
+  StructureNodeKind kind = nodes[parent].kind;
+  uint64_t table = nodes[parent].tableOffset;
+  uint64_t record = table + (uint64_t)entry * nodes[parent].entrySize;
+  char label[STRUCT_LABEL_LEN];
+  char text[STRUCT_VALUE_LEN];
+
+  if (kind == STRUCT_NODE_DIRECTORIES)
+  {
+    uint32_t rva = read32(record);
+    uint32_t length = read32(record + 4);
+    uint64_t offset = record;
+    uint64_t span = 8;
+    // The security directory holds a file offset rather than an RVA.
+    if (entry == 4 && length > 0 && inRange(rva, 1))
+    {
+      offset = rva;
+      span = length;
+    }
+    else if (rva != 0 && rvaToOffset(rva, &offset))
+    {
+      span = length;
+    }
+    int index = addNode(parent, STRUCT_NODE_DIRECTORY, g_PEDirectoryNames[entry < 16 ? entry : 15], offset, span);
+    StructureFormatHex("", rva, text, STRUCT_VALUE_LEN);
+    StructureAppend(text, ", ", STRUCT_VALUE_LEN);
+    char sizeText[16];
+    itoaDec(length, sizeText, sizeof(sizeText));
+    StructureAppend(text, sizeText, STRUCT_VALUE_LEN);
+    StructureAppend(text, " bytes", STRUCT_VALUE_LEN);
+    setValue(index, text);
+    return;
+  }
+
+  if (kind == STRUCT_NODE_SEGMENTS)
+  {
+    uint32_t segmentType = read32(record);
+    uint64_t offset = is64 ? read64(record + 8) : read32(record + 4);
+    uint64_t virtualAddress = is64 ? read64(record + 16) : read32(record + 8);
+    uint64_t fileSize = is64 ? read64(record + 32) : read32(record + 16);
+    const char* name = StructureLookup(g_ELFSegmentTypes, STRUCT_COUNT(g_ELFSegmentTypes), segmentType);
+    if (!name)
+    {
+      StructureFormatHex("PT_", segmentType, label, STRUCT_LABEL_LEN);
+      name = label;
+    }
+    bool mapped = fileSize > 0 && inRange(offset, fileSize);
+    int index = addNode(parent, STRUCT_NODE_SEGMENT, name, mapped ? offset : record, mapped ? fileSize : nodes[parent].entrySize);
+    nodes[index].tableOffset = record;
+    nodes[index].expandable = true;
+    setHexValue(index, "", virtualAddress);
+    return;
+  }
+
+  if (kind == STRUCT_NODE_SECTIONS && format == STRUCT_FORMAT_PE)
+  {
+    char name[9];
+    readString(record, name, sizeof(name));
+    uint32_t rawSize = read32(record + 16);
+    uint32_t rawOffset = read32(record + 20);
+    bool mapped = rawSize > 0 && inRange(rawOffset, 1);
+    int index = addNode(parent, STRUCT_NODE_SECTION, name[0] ? name : "(unnamed)", mapped ? rawOffset : record, mapped ? rawSize : 40);
+    nodes[index].tableOffset = record;
+    nodes[index].expandable = true;
+    setHexValue(index, "", imageBase + read32(record + 12));
+    return;
+  }
+
+  if (kind == STRUCT_NODE_SECTIONS)
+  {
+    char name[STRUCT_LABEL_LEN];
+    name[0] = '\0';
+    if (sectionStrings != 0)
+      readString(sectionStrings + read32(record), name, sizeof(name));
+    uint32_t sectionType = read32(record + 4);
+    uint64_t offset = is64 ? read64(record + 24) : read32(record + 16);
+    uint64_t length = is64 ? read64(record + 32) : read32(record + 20);
+    bool mapped = sectionType != 8 && length > 0 && inRange(offset, 1);
+    if (!name[0])
+    {
+      stringCopy(name, "[", STRUCT_LABEL_LEN);
+      itoaDec(entry, text, sizeof(text));
+      StructureAppend(name, text, STRUCT_LABEL_LEN);
+      StructureAppend(name, "]", STRUCT_LABEL_LEN);
+    }
+    int index = addNode(parent, STRUCT_NODE_SECTION, name, mapped ? offset : record, mapped ? length : nodes[parent].entrySize);
+    nodes[index].tableOffset = record;
+    nodes[index].expandable = true;
+    const char* typeName = StructureLookup(g_ELFSectionTypes, STRUCT_COUNT(g_ELFSectionTypes), sectionType);
+    if (typeName)
+      setValue(index, typeName);
+    else
+      setHexValue(index, "", sectionType);
+    return;
+  }
+
+  if (kind == STRUCT_NODE_SYMBOLS)
+  {
+    uint32_t nameIndex = read32(record);
+    uint64_t value;
+    uint64_t length;
+    uint8_t type;
+    bool defined;
+    if (format == STRUCT_FORMAT_ELF)
+    {
+      uint8_t info = (uint8_t)readField(record + (is64 ? 4 : 12), 1);
+      uint16_t sectionIndex = read16(record + (is64 ? 6 : 14));
+      value = is64 ? read64(record + 8) : read32(record + 4);
+      length = is64 ? read64(record + 16) : read32(record + 8);
+      type = info & 0xF;
+      defined = sectionIndex != 0 && sectionIndex < 0xFF00;
+    }
+    else
+    {
+      type = (uint8_t)readField(record + 4, 1);
+      value = is64 ? read64(record + 8) : read32(record + 8);
+      length = 0;
+      defined = readField(record + 5, 1) != 0;
+    }
+
+    readString(nodes[parent].stringOffset + nameIndex, label, sizeof(label));
+    uint64_t offset = record;
+    uint64_t span = nodes[parent].entrySize;
+    uint64_t target;
+    if (defined && virtualAddressToOffset(value, &target))
+    {
+      offset = target;
+      span = length > 0 ? length : 1;
+    }
+    int index = addNode(parent, STRUCT_NODE_SYMBOL, label[0] ? label : "(unnamed)", offset, span);
+    const char* typeName = format == STRUCT_FORMAT_ELF ? StructureLookup(g_ELFSymbolTypes, STRUCT_COUNT(g_ELFSymbolTypes), type) : nullptr;
+    if (!defined)
+      stringCopy(text, "UNDEF ", STRUCT_VALUE_LEN);
+    else if (typeName)
+    {
+      stringCopy(text, typeName, STRUCT_VALUE_LEN);
+      StructureAppend(text, " ", STRUCT_VALUE_LEN);
+    }
+    else
+      text[0] = '\0';
+    StructureFormatHex(text, value, nodes[index].value, STRUCT_VALUE_LEN);
+    return;
+  }
+
+  if (kind == STRUCT_NODE_IMPORT_MODULE)
+  {
+    uint64_t thunk = readWord(record);
+    uint64_t ordinalFlag = is64 ? 0x8000000000000000ull : 0x80000000ull;
+    if (thunk & ordinalFlag)
+    {
+      stringCopy(label, "Ordinal ", STRUCT_LABEL_LEN);
+      itoaDec((long long)(thunk & 0xFFFF), text, sizeof(text));
+      StructureAppend(label, text, STRUCT_LABEL_LEN);
+    }
+    else
+    {
+      uint64_t nameOffset;
+      label[0] = '\0';
+      if (rvaToOffset(thunk & 0x7FFFFFFF, &nameOffset))
+        readString(nameOffset + 2, label, sizeof(label));
+    }
+    int index = addNode(parent, STRUCT_NODE_IMPORT, label[0] ? label : "(unnamed)", record, nodes[parent].entrySize);
+    setHexValue(index, "IAT ", imageBase + nodes[parent].stringOffset + (uint64_t)entry * nodes[parent].entrySize);
+    return;
+  }
+
+  if (kind == STRUCT_NODE_EXPORTS)
+  {
+    uint64_t functions, names, ordinals, nameOffset;
+    if (!rvaToOffset(read32(table + 28), &functions) || !rvaToOffset(read32(table + 32), &names) ||
+        !rvaToOffset(read32(table + 36), &ordinals))
+      return;
+
+    label[0] = '\0';
+    if (rvaToOffset(read32(names + (uint64_t)entry * 4), &nameOffset))
+      readString(nameOffset, label, sizeof(label));
+    uint16_t ordinal = read16(ordinals + (uint64_t)entry * 2);
+    uint32_t functionRva = read32(functions + (uint64_t)ordinal * 4);
+
+    uint64_t offset = names + (uint64_t)entry * 4;
+    uint64_t span = 4;
+    uint64_t target;
+    if (rvaToOffset(functionRva, &target))
+    {
+      offset = target;
+      span = 1;
+    }
+    int index = addNode(parent, STRUCT_NODE_EXPORT, label[0] ? label : "(unnamed)", offset, span);
+    stringCopy(text, "#", STRUCT_VALUE_LEN);
+    char ordinalText[16];
+    itoaDec((long long)ordinal + read32(table + 16), ordinalText, sizeof(ordinalText));
+    StructureAppend(text, ordinalText, STRUCT_VALUE_LEN);
+    StructureAppend(text, " ", STRUCT_VALUE_LEN);
+    StructureFormatHex(text, imageBase + functionRva, nodes[index].value, STRUCT_VALUE_LEN);
+    return;
+  }
+
+  if (kind == STRUCT_NODE_ARCHITECTURES)
+  {
+    bool wasBigEndian = bigEndian;
+    bigEndian = true;
+    uint32_t cpu = read32(record);
+    uint32_t offset = read32(record + 8);
+    uint32_t length = read32(record + 12);
+    bigEndian = wasBigEndian;
+
+    const char* cpuName = StructureLookup(g_MachCPUs, STRUCT_COUNT(g_MachCPUs), cpu);
+    bool mapped = inRange(offset, 1);
+    int index = addNode(parent, STRUCT_NODE_ARCHITECTURE, cpuName ? cpuName : "unknown", mapped ? offset : record, mapped ? length : 20);
+    setHexValue(index, "", offset);
+  }
+}
+
+void StructureDecoder::decodeELFImports(int parent)
+{
+  uint64_t table = nodes[parent].tableOffset;
+  uint32_t count = nodes[parent].entryCount;
+  uint32_t stride = nodes[parent].entrySize;
+
+  uint64_t strings = 0;
+  bool haveStrings = false;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint64_t record = table + (uint64_t)i * stride;
+    uint64_t tag = readWord(record);
+    if (tag == 0)
+      break;
+    if (tag == 5)
+      haveStrings = virtualAddressToOffset(readWord(record + stride / 2), &strings);
+  }
+  if (!haveStrings)
+    return;
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint64_t record = table + (uint64_t)i * stride;
+    uint64_t tag = readWord(record);
+    if (tag == 0)
+      break;
+    if (tag != 1)
+      continue;
+
+    char name[STRUCT_LABEL_LEN];
+    uint64_t nameOffset = strings + readWord(record + stride / 2);
+    readString(nameOffset, name, sizeof(name));
+    int index = addNode(parent, STRUCT_NODE_IMPORT_MODULE, name, nameOffset, strLen(name) + 1);
+    setValue(index, "DT_NEEDED");
+  }
+}
+
+void StructureDecoder::decodePEImports(int parent)
+{
+  uint32_t entrySize = is64 ? 8 : 4;
+  uint64_t descriptor = nodes[parent].tableOffset;
+  for (uint32_t i = 0; i < 4096 && inRange(descriptor, 20); i++, descriptor += 20)
+  {
+    uint32_t lookupRva = read32(descriptor);
+    uint32_t nameRva = read32(descriptor + 12);
+    uint32_t addressRva = read32(descriptor + 16);
+    if (nameRva == 0 && addressRva == 0)
+      break;
+
+    char name[STRUCT_LABEL_LEN];
+    uint64_t nameOffset;
+    name[0] = '\0';
+    if (rvaToOffset(nameRva, &nameOffset))
+      readString(nameOffset, name, sizeof(name));
+
+    uint64_t thunks = 0;
+    uint32_t count = 0;
+    if (rvaToOffset(lookupRva ? lookupRva : addressRva, &thunks))
+    {
+      while (count < STRUCT_MAX_LIST && inRange(thunks + (uint64_t)count * entrySize, entrySize) &&
+             readWord(thunks + (uint64_t)count * entrySize) != 0)
+        count++;
+    }
+
+    int index = addNode(parent, STRUCT_NODE_IMPORT_MODULE, name[0] ? name : "(unnamed)", descriptor, 20);
+    nodes[index].tableOffset = thunks;
+    nodes[index].stringOffset = addressRva;
+    nodes[index].entryCount = count;
+    nodes[index].entrySize = entrySize;
+    nodes[index].expandable = count > 0;
+    char text[16];
+    itoaDec(count, text, sizeof(text));
+    setValue(index, text);
+  }
+}
+
+void StructureDecoder::decodeMachCommands(int parent)
+{
+  uint64_t cursor = machCommands;
+  for (uint32_t i = 0; i < machCommandCount && inRange(cursor, 8); i++)
+  {
+    uint32_t command = read32(cursor);
+    uint32_t commandSize = read32(cursor + 4);
+    if (commandSize < 8 || !inRange(cursor, commandSize))
+      break;
+
+    char label[STRUCT_LABEL_LEN];
+    const char* name = StructureLookup(g_MachCommands, STRUCT_COUNT(g_MachCommands), command);
+    if (name)
+      stringCopy(label, name, STRUCT_LABEL_LEN);
+    else
+      StructureFormatHex("LC_", command, label, STRUCT_LABEL_LEN);
+
+    int index = addNode(parent, STRUCT_NODE_LOAD_COMMAND, label, cursor, commandSize);
+    nodes[index].tableOffset = cursor;
+    nodes[index].entrySize = command;
+    if (command == 0x19 || command == 0x1)
+    {
+      char segment[17];
+      readString(cursor + 8, segment, sizeof(segment));
+      setValue(index, segment);
+      nodes[index].expandable = true;
+    }
+    cursor += commandSize;
+  }
+}
+
+void StructureDecoder::decodeMachSegment(int parent)
+{
+  uint64_t command = nodes[parent].tableOffset;
+  bool segment64 = nodes[parent].entrySize == 0x19;
+  if (segment64)
+    addFields(parent, command, g_MachSegment64, STRUCT_COUNT(g_MachSegment64));
+  else
+    addFields(parent, command, g_MachSegment32, STRUCT_COUNT(g_MachSegment32));
+
+  uint32_t sectionCount = read32(command + (segment64 ? 64 : 48));
+  uint64_t section = command + (segment64 ? 72 : 56);
+  uint32_t stride = segment64 ? 80 : 68;
+  uint64_t end = command + nodes[parent].size;
+  for (uint32_t i = 0; i < sectionCount && section + stride <= end; i++, section += stride)
+  {
+    char name[17];
+    readString(section, name, sizeof(name));
+    uint64_t address = segment64 ? read64(section + 32) : read32(section + 32);
+    uint64_t length = segment64 ? read64(section + 40) : read32(section + 36);
+    uint64_t offset = machBase + read32(section + (segment64 ? 48 : 40));
+    bool mapped = offset > machBase && length > 0 && inRange(offset, 1);
+    int index = addNode(parent, STRUCT_NODE_SECTION, name, mapped ? offset : section, mapped ? length : stride);
+    setHexValue(index, "", address);
+  }
+}
+
+void StructureDecoder::decodeMachImports(int parent)
+{
+  uint64_t cursor = machCommands;
+  for (uint32_t i = 0; i < machCommandCount && inRange(cursor, 8); i++)
+  {
+    uint32_t command = read32(cursor);
+    uint32_t commandSize = read32(cursor + 4);
+    if (commandSize < 8 || !inRange(cursor, commandSize))
+      break;
+
+    if ((command == 0xC || command == 0x20 || command == 0x80000018 || command == 0x8000001F || command == 0x80000023) &&
+        commandSize > 24)
+    {
+      uint32_t nameOffset = read32(cursor + 8);
+      char name[STRUCT_LABEL_LEN];
+      name[0] = '\0';
+      if (nameOffset < commandSize)
+        readString(cursor + nameOffset, name, sizeof(name));
+      int index = addNode(parent, STRUCT_NODE_IMPORT_MODULE, name[0] ? name : "(unnamed)", cursor, commandSize);
+      const char* kind = StructureLookup(g_MachCommands, STRUCT_COUNT(g_MachCommands), command);
+      setValue(index, kind ? kind + 3 : "");
+    }
+    cursor += commandSize;
+  }
+}
@@ -0,0 +1,1778 @@
+#include "template.h"
+
+struct TemplateTypeName
+{
+  const char* name;
+  TemplatePrimitive primitive;
+};
+
+static const TemplateTypeName g_TemplateTypes[] = {
+    {"u8", TPL_U8}, {"u16", TPL_U16}, {"u32", TPL_U32}, {"u64", TPL_U64},
+    {"i8", TPL_I8}, {"i16", TPL_I16}, {"i32", TPL_I32}, {"i64", TPL_I64},
+    {"f32", TPL_F32}, {"f64", TPL_F64}, {"char", TPL_CHAR},
+    {"byte", TPL_U8}, {"float", TPL_F32}, {"double", TPL_F64}};
+
+static const uint8_t g_TemplateWidths[] = {1, 2, 4, 8, 1, 2, 4, 8, 4, 8, 1, 0};
+
+static const char* g_TemplateTypeNames[] = {"u8", "u16", "u32", "u64", "i8", "i16", "i32", "i64", "f32", "f64", "char", ""};
+
+enum TemplateTokenType
+{
+  TPL_TOKEN_END,
+  TPL_TOKEN_IDENT,
+  TPL_TOKEN_NUMBER,
+  TPL_TOKEN_PUNCT
+};
+
+struct TemplateToken
+{
+  TemplateTokenType type;
+  char text[TEMPLATE_NAME_LEN];
+  int64_t number;
+  int line;
+};
+
+struct TemplatePending
+{
+  int owner;
+  int op;
+  int line;
+  char typeName[TEMPLATE_NAME_LEN];
+};
+
+struct TemplateParser
+{
+  const char* text;
+  size_t length;
+  size_t pos;
+  int line;
+  TemplateToken token;
+  TemplateProgram* program;
+  Vector<TemplateOp>* ops;
+  Vector<TemplatePending> pending;
+  int owner;
+  bool bigEndian;
+  bool failed;
+  char* error;
+  size_t errorMax;
+};
+
+static void TemplateAppend(char* out, const char* text, size_t max)
+{
+  size_t used = strLen(out);
+  for (size_t i = 0; text[i] && used + 1 < max; i++)
+    out[used++] = text[i];
+  out[used] = '\0';
+}
+
+static bool TemplateIsIdentChar(char c, bool first)
+{
+  if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+    return true;
+  return !first && c >= '0' && c <= '9';
+}
+
+static void TemplateFail(TemplateParser* p, const char* message)
+{
+  if (p->failed)
+    return;
+  p->failed = true;
+
+  char number[16];
+  itoaDec(p->token.line, number, sizeof(number));
+  stringCopy(p->error, "line ", (int)p->errorMax);
+  TemplateAppend(p->error, number, p->errorMax);
+  TemplateAppend(p->error, ": ", p->errorMax);
+  TemplateAppend(p->error, message, p->errorMax);
+}
+
+static void TemplateNext(TemplateParser* p)
+{
+  TemplateToken& token = p->token;
+  token.text[0] = '\0';
+  token.number = 0;
+
+  while (p->pos < p->length)
+  {
+    char c = p->text[p->pos];
+    if (c == '\n')
+    {
+      p->line++;
+      p->pos++;
+    }
+    else if (c == ' ' || c == '\t' || c == '\r')
+    {
+      p->pos++;
+    }
+    else if (c == '/' && p->pos + 1 < p->length && p->text[p->pos + 1] == '/')
+    {
+      while (p->pos < p->length && p->text[p->pos] != '\n')
+        p->pos++;
+    }
+    else if (c == '/' && p->pos + 1 < p->length && p->text[p->pos + 1] == '*')
+    {
+      p->pos += 2;
+      while (p->pos + 1 < p->length && !(p->text[p->pos] == '*' && p->text[p->pos + 1] == '/'))
+      {
+        if (p->text[p->pos] == '\n')
+          p->line++;
+        p->pos++;
+      }
+      p->pos += 2;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  token.line = p->line;
+  if (p->pos >= p->length)
+  {
+    token.type = TPL_TOKEN_END;
+    return;
+  }
+
+  const char* s = p->text + p->pos;
+  size_t left = p->length - p->pos;
+
+  if (TemplateIsIdentChar(s[0], true))
+  {
+    size_t n = 0;
+    while (n < left && TemplateIsIdentChar(s[n], false))
+      n++;
+    if (n >= TEMPLATE_NAME_LEN)
+    {
+      TemplateFail(p, "name too long");
+      n = TEMPLATE_NAME_LEN - 1;
+    }
+    memCopy(token.text, s, n);
+    token.text[n] = '\0';
+    while (p->pos < p->length && TemplateIsIdentChar(p->text[p->pos], false))
+      p->pos++;
+    token.type = TPL_TOKEN_IDENT;
+    return;
+  }
+
+  if (s[0] >= '0' && s[0] <= '9')
+  {
+    uint64_t value = 0;
+    size_t n = 0;
+    if (left > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    {
+      n = 2;
+      while (n < left && isXDigit(s[n]))
+        value = (value << 4) | (uint64_t)hexDigitToInt(s[n++]);
+    }
+    else
+    {
+      while (n < left && s[n] >= '0' && s[n] <= '9')
+        value = value * 10 + (uint64_t)(s[n++] - '0');
+    }
+    if (n < left && TemplateIsIdentChar(s[n], false))
+      TemplateFail(p, "malformed number");
+    p->pos += n;
+    token.type = TPL_TOKEN_NUMBER;
+    token.number = (int64_t)value;
+    return;
+  }
+
+  if (s[0] == '\'' && left >= 3 && s[2] == '\'')
+  {
+    p->pos += 3;
+    token.type = TPL_TOKEN_NUMBER;
+    token.number = (uint8_t)s[1];
+    return;
+  }
+
+  static const char* twoChar[] = {"==", "!=", "<=", ">=", "&&", "||", "<<", ">>"};
+  size_t n = 1;
+  for (size_t i = 0; i < sizeof(twoChar) / sizeof(twoChar[0]); i++)
+  {
+    if (left >= 2 && s[0] == twoChar[i][0] && s[1] == twoChar[i][1])
+      n = 2;
+  }
+  memCopy(token.text, s, n);
+  token.text[n] = '\0';
+  p->pos += n;
+  token.type = TPL_TOKEN_PUNCT;
+}
+
+static bool TemplateIs(TemplateParser* p, const char* text)
+{
+  return p->token.type != TPL_TOKEN_END && p->token.type != TPL_TOKEN_NUMBER && strEquals(p->token.text, text);
+}
+
+static bool TemplateAccept(TemplateParser* p, const char* text)
+{
+  if (!TemplateIs(p, text))
+    return false;
+  TemplateNext(p);
+  return true;
+}
+
+static void TemplateExpect(TemplateParser* p, const char* text)
+{
+  if (TemplateAccept(p, text))
+    return;
+
+  char message[64];
+  stringCopy(message, "expected '", sizeof(message));
+  TemplateAppend(message, text, sizeof(message));
+  TemplateAppend(message, "'", sizeof(message));
+  TemplateFail(p, message);
+}
+
+static void TemplateExpectName(TemplateParser* p, char* outName)
+{
+  if (p->token.type != TPL_TOKEN_IDENT)
+  {
+    TemplateFail(p, "expected a name");
+    outName[0] = '\0';
+    return;
+  }
+  stringCopy(outName, p->token.text, TEMPLATE_NAME_LEN);
+  TemplateNext(p);
+}
+
+static void TemplateEmit(TemplateParser* p, TemplateInstrCode code, int64_t value, TemplateOperator op, const char* name)
+{
+  TemplateInstr instr;
+  instr.code = code;
+  instr.op = op;
+  instr.value = value;
+  stringCopy(instr.name, name ? name : "", TEMPLATE_NAME_LEN);
+  p->program->code.push_back(instr);
+}
+
+static int TemplateFindEnum(const TemplateProgram* program, const char* name)
+{
+  for (size_t i = 0; i < program->enums.size(); i++)
+  {
+    if (strEquals(program->enums[i].name, name))
+      return (int)i;
+  }
+  return -1;
+}
+
+static int TemplateFindStruct(const TemplateProgram* program, const char* name)
+{
+  for (size_t i = 1; i < program->structs.size(); i++)
+  {
+    if (strEquals(program->structs[i].name, name))
+      return (int)i;
+  }
+  return -1;
+}
+
+static bool TemplateFindPrimitive(const char* name, TemplatePrimitive* outPrimitive)
+{
+  for (size_t i = 0; i < sizeof(g_TemplateTypes) / sizeof(g_TemplateTypes[0]); i++)
+  {
+    if (strEquals(g_TemplateTypes[i].name, name))
+    {
+      *outPrimitive = g_TemplateTypes[i].primitive;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool TemplateIsReserved(const TemplateProgram* program, const char* name)
+{
+  TemplatePrimitive primitive;
+  return TemplateFindPrimitive(name, &primitive) || TemplateFindEnum(program, name) >= 0 ||
+         TemplateFindStruct(program, name) >= 0 || strEquals(name, "struct") || strEquals(name, "enum") ||
+         strEquals(name, "if") || strEquals(name, "else") || strEquals(name, "endian");
+}
+
+static void TemplateParseExpr(TemplateParser* p, int minPrecedence);
+
+static void TemplateParseUnary(TemplateParser* p)
+{
+  if (p->failed)
+    return;
+
+  bool unary = true;
+  TemplateOperator op = TPL_OPERATOR_NEGATE;
+  if (TemplateAccept(p, "!"))
+    op = TPL_OPERATOR_NOT;
+  else if (TemplateAccept(p, "~"))
+    op = TPL_OPERATOR_COMPLEMENT;
+  else if (!TemplateAccept(p, "-"))
+    unary = false;
+
+  if (unary)
+  {
+    TemplateParseUnary(p);
+    TemplateEmit(p, TPL_INSTR_UNARY, 0, op, nullptr);
+    return;
+  }
+
+  if (TemplateAccept(p, "+"))
+  {
+    TemplateParseUnary(p);
+    return;
+  }
+
+  if (TemplateAccept(p, "("))
+  {
+    TemplateParseExpr(p, 1);
+    TemplateExpect(p, ")");
+    return;
+  }
+
+  if (p->token.type == TPL_TOKEN_NUMBER)
+  {
+    TemplateEmit(p, TPL_INSTR_CONST, p->token.number, TPL_OPERATOR_ADD, nullptr);
+    TemplateNext(p);
+    return;
+  }
+
+  if (TemplateAccept(p, "$"))
+  {
+    TemplateEmit(p, TPL_INSTR_POSITION, 0, TPL_OPERATOR_ADD, nullptr);
+    return;
+  }
+
+  if (p->token.type != TPL_TOKEN_IDENT)
+  {
+    TemplateFail(p, "expected an expression");
+    return;
+  }
+
+  char first[TEMPLATE_NAME_LEN];
+  TemplateExpectName(p, first);
+
+  int enumIndex = TemplateFindEnum(p->program, first);
+  if (enumIndex >= 0)
+  {
+    char member[TEMPLATE_NAME_LEN];
+    TemplateExpect(p, ".");
+    TemplateExpectName(p, member);
+
+    const TemplateEnum& e = p->program->enums[enumIndex];
+    for (int i = 0; i < e.valueCount; i++)
+    {
+      const TemplateEnumValue& value = p->program->enumValues[e.firstValue + i];
+      if (strEquals(value.name, member))
+      {
+        TemplateEmit(p, TPL_INSTR_CONST, value.value, TPL_OPERATOR_ADD, nullptr);
+        return;
+      }
+    }
+    TemplateFail(p, "unknown enum value");
+    return;
+  }
+
+  TemplateEmit(p, TPL_INSTR_FIELD, 0, TPL_OPERATOR_ADD, first);
+  while (TemplateAccept(p, "."))
+  {
+    char member[TEMPLATE_NAME_LEN];
+    TemplateExpectName(p, member);
+    TemplateEmit(p, TPL_INSTR_MEMBER, 0, TPL_OPERATOR_ADD, member);
+  }
+}
+
+static int TemplateBinaryPrecedence(const TemplateToken& token, TemplateOperator* outOp)
+{
+  struct BinaryOperator
+  {
+    const char* text;
+    TemplateOperator op;
+    int precedence;
+  };
+  static const BinaryOperator operators[] = {
+      {"*", TPL_OPERATOR_MUL, 10}, {"/", TPL_OPERATOR_DIV, 10}, {"%", TPL_OPERATOR_MOD, 10},
+      {"+", TPL_OPERATOR_ADD, 9}, {"-", TPL_OPERATOR_SUB, 9},
+      {"<<", TPL_OPERATOR_SHL, 8}, {">>", TPL_OPERATOR_SHR, 8},
+      {"<", TPL_OPERATOR_LT, 7}, {"<=", TPL_OPERATOR_LE, 7}, {">", TPL_OPERATOR_GT, 7}, {">=", TPL_OPERATOR_GE, 7},
+      {"==", TPL_OPERATOR_EQ, 6}, {"!=", TPL_OPERATOR_NE, 6},
+      {"&", TPL_OPERATOR_AND, 5}, {"^", TPL_OPERATOR_XOR, 4}, {"|", TPL_OPERATOR_OR, 3},
+      {"&&", TPL_OPERATOR_LOGICAL_AND, 2}, {"||", TPL_OPERATOR_LOGICAL_OR, 1}};
+
+  if (token.type != TPL_TOKEN_PUNCT)
+    return 0;
+  for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); i++)
+  {
+    if (strEquals(token.text, operators[i].text))
+    {
+      *outOp = operators[i].op;
+      return operators[i].precedence;
+    }
+  }
+  return 0;
+}
+
+static void TemplateParseExpr(TemplateParser* p, int minPrecedence)
+{
+  TemplateParseUnary(p);
+  while (!p->failed)
+  {
+    TemplateOperator op;
+    int precedence = TemplateBinaryPrecedence(p->token, &op);
+    if (precedence == 0 || precedence < minPrecedence)
+      break;
+    TemplateNext(p);
+    TemplateParseExpr(p, precedence + 1);
+    TemplateEmit(p, TPL_INSTR_BINARY, 0, op, nullptr);
+  }
+}
+
+static int TemplateCompileExpr(TemplateParser* p)
+{
+  TemplateExpr expr;
+  expr.first = (int)p->program->code.size();
+  TemplateParseExpr(p, 1);
+  expr.count = (int)p->program->code.size() - expr.first;
+  p->program->exprs.push_back(expr);
+  return (int)p->program->exprs.size() - 1;
+}
+
+static TemplateOp TemplateMakeOp(TemplateOpCode code)
+{
+  TemplateOp op;
+  op.code = code;
+  op.name[0] = '\0';
+  op.primitive = TPL_U8;
+  op.structIndex = -1;
+  op.enumIndex = -1;
+  op.countExpr = -1;
+  op.atExpr = -1;
+  op.condExpr = -1;
+  op.target = 0;
+  op.isArray = false;
+  op.bigEndian = false;
+  return op;
+}
+
+static void TemplateParseStatement(TemplateParser* p, bool topLevel);
+
+static void TemplateParseBlock(TemplateParser* p, bool topLevel)
+{
+  while (!p->failed && p->token.type != TPL_TOKEN_END && !TemplateIs(p, "}"))
+    TemplateParseStatement(p, topLevel);
+}
+
+static void TemplateParseBody(TemplateParser* p)
+{
+  if (TemplateAccept(p, "{"))
+  {
+    TemplateParseBlock(p, false);
+    TemplateExpect(p, "}");
+  }
+  else
+  {
+    TemplateParseStatement(p, false);
+  }
+}
+
+static void TemplateParseStruct(TemplateParser* p)
+{
+  TemplateStruct definition;
+  TemplateExpectName(p, definition.name);
+  if (!p->failed && TemplateIsReserved(p->program, definition.name))
+    TemplateFail(p, "type name already defined");
+  TemplateExpect(p, "{");
+  if (p->failed)
+    return;
+
+  definition.firstOp = 0;
+  definition.opCount = 0;
+  definition.size = 0;
+  definition.fixedSize = false;
+  definition.contained = false;
+  int index = (int)p->program->structs.size();
+  p->program->structs.push_back(definition);
+
+  Vector<TemplateOp> body;
+  Vector<TemplateOp>* outerOps = p->ops;
+  int outerOwner = p->owner;
+  p->ops = &body;
+  p->owner = index;
+
+  TemplateParseBlock(p, false);
+  TemplateExpect(p, "}");
+  TemplateAccept(p, ";");
+
+  p->ops = outerOps;
+  p->owner = outerOwner;
+
+  TemplateStruct& placed = p->program->structs[index];
+  placed.firstOp = (int)p->program->ops.size();
+  placed.opCount = (int)body.size();
+  for (size_t i = 0; i < body.size(); i++)
+    p->program->ops.push_back(body[i]);
+}
+
+static void TemplateParseEnum(TemplateParser* p)
+{
+  TemplateEnum definition;
+  TemplateExpectName(p, definition.name);
+  if (!p->failed && TemplateIsReserved(p->program, definition.name))
+    TemplateFail(p, "type name already defined");
+
+  definition.primitive = TPL_U32;
+  if (TemplateAccept(p, ":"))
+  {
+    char typeName[TEMPLATE_NAME_LEN];
+    TemplateExpectName(p, typeName);
+    if (!p->failed && (!TemplateFindPrimitive(typeName, &definition.primitive) ||
+                       definition.primitive == TPL_F32 || definition.primitive == TPL_F64))
+      TemplateFail(p, "enum base must be an integer type");
+  }
+  TemplateExpect(p, "{");
+
+  definition.firstValue = (int)p->program->enumValues.size();
+  definition.valueCount = 0;
+  int64_t next = 0;
+  while (!p->failed && !TemplateIs(p, "}"))
+  {
+    TemplateEnumValue value;
+    TemplateExpectName(p, value.name);
+    value.value = next;
+    if (TemplateAccept(p, "="))
+    {
+      bool negative = TemplateAccept(p, "-");
+      if (p->token.type != TPL_TOKEN_NUMBER)
+      {
+        TemplateFail(p, "expected a number");
+        break;
+      }
+      value.value = negative ? -p->token.number : p->token.number;
+      TemplateNext(p);
+    }
+    next = value.value + 1;
+    p->program->enumValues.push_back(value);
+    definition.valueCount++;
+    if (!TemplateAccept(p, ","))
+      break;
+  }
+  TemplateExpect(p, "}");
+  TemplateAccept(p, ";");
+
+  if (!p->failed)
+    p->program->enums.push_back(definition);
+}
+
+static void TemplateParseField(TemplateParser* p)
+{
+  TemplateOp op = TemplateMakeOp(TPL_OP_FIELD);
+  op.bigEndian = p->bigEndian;
+
+  char typeName[TEMPLATE_NAME_LEN];
+  int typeLine = p->token.line;
+  TemplateExpectName(p, typeName);
+  TemplateExpectName(p, op.name);
+  if (p->failed)
+    return;
+
+  bool pending = false;
+  if (!TemplateFindPrimitive(typeName, &op.primitive))
+  {
+    op.enumIndex = TemplateFindEnum(p->program, typeName);
+    if (op.enumIndex >= 0)
+    {
+      op.primitive = p->program->enums[op.enumIndex].primitive;
+    }
+    else
+    {
+      op.primitive = TPL_STRUCT;
+      op.structIndex = TemplateFindStruct(p->program, typeName);
+      pending = op.structIndex < 0;
+    }
+  }
+
+  if (TemplateAccept(p, "["))
+  {
+    op.isArray = true;
+    op.countExpr = TemplateCompileExpr(p);
+    TemplateExpect(p, "]");
+  }
+  if (TemplateAccept(p, "@"))
+    op.atExpr = TemplateCompileExpr(p);
+  TemplateExpect(p, ";");
+
+  if (pending)
+  {
+    TemplatePending entry;
+    entry.owner = p->owner;
+    entry.op = (int)p->ops->size();
+    entry.line = typeLine;
+    stringCopy(entry.typeName, typeName, TEMPLATE_NAME_LEN);
+    p->pending.push_back(entry);
+  }
+  p->ops->push_back(op);
+}
+
+static void TemplateParseStatement(TemplateParser* p, bool topLevel)
+{
+  if (TemplateAccept(p, ";"))
+    return;
+
+  if (p->token.type != TPL_TOKEN_IDENT)
+  {
+    TemplateFail(p, "expected a declaration");
+    return;
+  }
+
+  if (TemplateAccept(p, "endian"))
+  {
+    if (TemplateAccept(p, "big"))
+      p->bigEndian = true;
+    else if (TemplateAccept(p, "little"))
+      p->bigEndian = false;
+    else
+      TemplateFail(p, "expected 'little' or 'big'");
+    TemplateExpect(p, ";");
+    return;
+  }
+
+  if (TemplateIs(p, "struct") || TemplateIs(p, "enum"))
+  {
+    if (!topLevel)
+    {
+      TemplateFail(p, "types must be defined at the top level");
+      return;
+    }
+    bool isStruct = TemplateIs(p, "struct");
+    TemplateNext(p);
+    if (isStruct)
+      TemplateParseStruct(p);
+    else
+      TemplateParseEnum(p);
+    return;
+  }
+
+  if (TemplateAccept(p, "if"))
+  {
+    TemplateOp branch = TemplateMakeOp(TPL_OP_IF);
+    TemplateExpect(p, "(");
+    branch.condExpr = TemplateCompileExpr(p);
+    TemplateExpect(p, ")");
+    int branchIndex = (int)p->ops->size();
+    p->ops->push_back(branch);
+
+    TemplateParseBody(p);
+    if (TemplateAccept(p, "else"))
+    {
+      int jumpIndex = (int)p->ops->size();
+      p->ops->push_back(TemplateMakeOp(TPL_OP_JUMP));
+      (*p->ops)[branchIndex].target = (int)p->ops->size();
+      TemplateParseBody(p);
+      (*p->ops)[jumpIndex].target = (int)p->ops->size();
+    }
+    else
+    {
+      (*p->ops)[branchIndex].target = (int)p->ops->size();
+    }
+    return;
+  }
+
+  TemplateParseField(p);
+}
+
+static bool TemplateConstant(const TemplateProgram* program, int expr, int64_t* outValue)
+{
+  const TemplateExpr& e = program->exprs[expr];
+  if (e.count != 1 || program->code[e.first].code != TPL_INSTR_CONST)
+    return false;
+  *outValue = program->code[e.first].value;
+  return true;
+}
+
+static void TemplateMeasure(TemplateProgram* program, int index, uint8_t* state)
+{
+  if (state[index] != 0)
+    return;
+  state[index] = 1;
+
+  TemplateStruct& s = program->structs[index];
+  bool fixedSize = true;
+  bool contained = true;
+  uint64_t size = 0;
+
+  for (int i = 0; i < s.opCount; i++)
+  {
+    const TemplateOp& op = program->ops[s.firstOp + i];
+    if (op.code != TPL_OP_FIELD)
+    {
+      fixedSize = false;
+      continue;
+    }
+
+    uint64_t elementSize = g_TemplateWidths[op.primitive];
+    bool elementFixed = true;
+    if (op.primitive == TPL_STRUCT)
+    {
+      TemplateMeasure(program, op.structIndex, state);
+      if (state[op.structIndex] != 2)
+      {
+        elementFixed = false;
+        contained = false;
+      }
+      else
+      {
+        elementFixed = program->structs[op.structIndex].fixedSize;
+        elementSize = program->structs[op.structIndex].size;
+        contained = contained && program->structs[op.structIndex].contained;
+      }
+    }
+
+    if (op.atExpr >= 0)
+    {
+      contained = false;
+      continue;
+    }
+
+    int64_t count = 1;
+    if (op.isArray && !TemplateConstant(program, op.countExpr, &count))
+      fixedSize = false;
+    if (!elementFixed)
+      fixedSize = false;
+    if (fixedSize)
+      size += (uint64_t)(count > 0 ? count : 0) * elementSize;
+  }
+
+  s.fixedSize = fixedSize;
+  s.size = fixedSize ? size : 0;
+  s.contained = contained;
+  state[index] = 2;
+}
+
+void TemplateProgram::clear()
+{
+  structs.clear();
+  enums.clear();
+  enumValues.clear();
+  ops.clear();
+  code.clear();
+  exprs.clear();
+}
+
+bool TemplateCompile(const char* text, size_t length, TemplateProgram* outProgram, char* outError, size_t errorMax)
+{
+  outProgram->clear();
+  outError[0] = '\0';
+
+  TemplateParser p;
+  p.text = text;
+  p.length = length;
+  p.pos = 0;
+  p.line = 1;
+  p.program = outProgram;
+  p.owner = 0;
+  p.bigEndian = false;
+  p.failed = false;
+  p.error = outError;
+  p.errorMax = errorMax;
+
+  TemplateStruct root;
+  root.name[0] = '\0';
+  root.firstOp = 0;
+  root.opCount = 0;
+  root.size = 0;
+  root.fixedSize = false;
+  root.contained = false;
+  outProgram->structs.push_back(root);
+
+  Vector<TemplateOp> rootOps;
+  p.ops = &rootOps;
+  TemplateNext(&p);
+  TemplateParseBlock(&p, true);
+  if (!p.failed && p.token.type != TPL_TOKEN_END)
+    TemplateFail(&p, "unexpected '}'");
+
+  outProgram->structs[0].firstOp = (int)outProgram->ops.size();
+  outProgram->structs[0].opCount = (int)rootOps.size();
+  for (size_t i = 0; i < rootOps.size(); i++)
+    outProgram->ops.push_back(rootOps[i]);
+
+  for (size_t i = 0; i < p.pending.size() && !p.failed; i++)
+  {
+    const TemplatePending& entry = p.pending[i];
+    int structIndex = TemplateFindStruct(outProgram, entry.typeName);
+    if (structIndex < 0)
+    {
+      p.token.line = entry.line;
+      char message[64];
+      stringCopy(message, "unknown type '", sizeof(message));
+      TemplateAppend(message, entry.typeName, sizeof(message));
+      TemplateAppend(message, "'", sizeof(message));
+      TemplateFail(&p, message);
+      break;
+    }
+    outProgram->ops[outProgram->structs[entry.owner].firstOp + entry.op].structIndex = structIndex;
+  }
+
+  if (!p.failed && rootOps.empty())
+  {
+    p.token.line = p.line;
+    TemplateFail(&p, "template declares no top-level fields");
+  }
+
+  if (p.failed)
+  {
+    outProgram->clear();
+    return false;
+  }
+
+  uint8_t* state = (uint8_t*)platformAlloc(outProgram->structs.size());
+  memSet(state, 0, outProgram->structs.size());
+  for (size_t i = 0; i < outProgram->structs.size(); i++)
+    TemplateMeasure(outProgram, (int)i, state);
+  platformFree(state, outProgram->structs.size());
+  return true;
+}
+
+static void TemplateFormatDouble(double value, char* out, int max)
+{
+  if (value != value)
+  {
+    stringCopy(out, "NaN", max);
+    return;
+  }
+
+  char buf[48];
+  int used = 0;
+  if (value < 0)
+  {
+    buf[used++] = '-';
+    value = -value;
+  }
+  if (value - value != 0)
+  {
+    buf[used] = '\0';
+    stringCopy(out, buf, max);
+    TemplateAppend(out, "Inf", (size_t)max);
+    return;
+  }
+
+  int exponent = 0;
+  if (value != 0 && (value >= 1e15 || value < 1e-4))
+  {
+    while (value >= 10)
+    {
+      value /= 10;
+      exponent++;
+    }
+    while (value < 1)
+    {
+      value *= 10;
+      exponent--;
+    }
+  }
+
+  uint64_t whole = (uint64_t)value;
+  double fraction = value - (double)whole;
+  itoaDec((long long)whole, buf + used, (int)sizeof(buf) - used);
+  used = (int)strLen(buf);
+
+  uint64_t digits = (uint64_t)(fraction * 1000000.0 + 0.5);
+  if (digits >= 1000000)
+    digits = 999999;
+  if (digits > 0)
+  {
+    buf[used++] = '.';
+    for (int i = 5; i >= 0; i--)
+    {
+      buf[used + i] = (char)('0' + digits % 10);
+      digits /= 10;
+    }
+    used += 6;
+    while (buf[used - 1] == '0')
+      used--;
+  }
+  buf[used] = '\0';
+
+  if (exponent != 0)
+  {
+    buf[used++] = 'e';
+    itoaDec(exponent, buf + used, (int)sizeof(buf) - used);
+  }
+  stringCopy(out, buf, max);
+}
+
+TemplateEngine::TemplateEngine()
+  : read(nullptr),
+    readContext(nullptr),
+    dataSize(0),
+    loaded(false),
+    depth(0),
+    lowestDecoded(0x7FFFFFFF),
+    budget(0)
+{
+  name[0] = '\0';
+}
+
+TemplateEngine::~TemplateEngine()
+{
+  unload();
+}
+
+bool TemplateEngine::load(const char* templateName, const char* text, size_t length, char* outError, size_t errorMax)
+{
+  TemplateProgram compiled;
+  if (!TemplateCompile(text, length, &compiled, outError, errorMax))
+    return false;
+
+  unload();
+  program = compiled;
+  stringCopy(name, templateName, TEMPLATE_LABEL_LEN);
+  loaded = true;
+  bind(read, readContext, dataSize);
+  return true;
+}
+
+void TemplateEngine::unload()
+{
+  program.clear();
+  nodes.clear();
+  checkpoints.clear();
+  name[0] = '\0';
+  loaded = false;
+}
+
+void TemplateEngine::bind(TemplateReadFn readFn, void* context, uint64_t length)
+{
+  nodes.clear();
+  checkpoints.clear();
+  read = readFn;
+  readContext = context;
+  dataSize = readFn ? length : 0;
+  depth = 0;
+  lowestDecoded = 0x7FFFFFFF;
+
+  if (!loaded || dataSize == 0)
+    return;
+
+  int root = addNode(-1, TPL_NODE_STRUCT, "", -1, 0, true);
+  nodes[root].structIndex = 0;
+  decodeStruct(root);
+  nodes[root].expanded = true;
+}
+
+void TemplateEngine::refreshValues()
+{
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    TemplateNode& node = nodes[i];
+    if (node.kind == TPL_NODE_VALUE)
+    {
+      node.raw = readValue(node.offset, node.primitive, program.ops[node.op].bigEndian);
+      formatValue((int)i);
+    }
+    else if (node.kind == TPL_NODE_ARRAY && node.primitive == TPL_CHAR)
+    {
+      formatValue((int)i);
+    }
+  }
+}
+
+const TemplateNode* TemplateEngine::getNode(int index) const
+{
+  if (index < 0 || (size_t)index >= nodes.size())
+    return nullptr;
+  return &nodes[index];
+}
+
+bool TemplateEngine::expand(int index)
+{
+  if (index <= 0 || (size_t)index >= nodes.size() || !nodes[index].expandable)
+    return false;
+
+  if (nodes[index].kind == TPL_NODE_MORE)
+  {
+    decodeMore(index);
+    return true;
+  }
+
+  if (nodes[index].kind == TPL_NODE_STRUCT)
+  {
+    decodeStruct(index);
+  }
+  else if (!nodes[index].decoded)
+  {
+    nodes[index].decoded = true;
+    decodeArray(index, 0);
+  }
+  nodes[index].expanded = true;
+  return true;
+}
+
+void TemplateEngine::collapse(int index)
+{
+  if (index > 0 && (size_t)index < nodes.size())
+    nodes[index].expanded = false;
+}
+
+bool TemplateEngine::toggle(int index)
+{
+  if (index <= 0 || (size_t)index >= nodes.size() || !nodes[index].expandable)
+    return false;
+  if (nodes[index].expanded)
+  {
+    collapse(index);
+    return true;
+  }
+  return expand(index);
+}
+
+void TemplateEngine::getVisibleNodes(Vector<int>* outNodes) const
+{
+  outNodes->clear();
+  if (nodes.empty())
+    return;
+
+  int current = nodes[0].firstChild;
+  while (current >= 0)
+  {
+    outNodes->push_back(current);
+    const TemplateNode& node = nodes[current];
+    if (node.expanded && node.firstChild >= 0)
+    {
+      current = node.firstChild;
+      continue;
+    }
+
+    while (current >= 0 && nodes[current].nextSibling < 0)
+      current = nodes[current].parent;
+    if (current <= 0)
+      break;
+    current = nodes[current].nextSibling;
+  }
+}
+
+void TemplateEngine::getSpans(uint64_t start, uint64_t end, Vector<TemplateSpan>* outSpans)
+{
+  outSpans->clear();
+  if (nodes.empty() || start >= end)
+    return;
+  budget = TEMPLATE_SPAN_BUDGET;
+  collectSpans(0, start, end, outSpans, 0);
+}
+
+uint64_t TemplateEngine::readValue(uint64_t offset, TemplatePrimitive primitive, bool bigEndian) const
+{
+  size_t width = g_TemplateWidths[primitive];
+  uint8_t bytes[8];
+  if (width == 0 || offset >= dataSize || width > dataSize - offset ||
+      read(readContext, offset, bytes, width) != width)
+    return 0;
+
+  uint64_t value = 0;
+  for (size_t i = 0; i < width; i++)
+  {
+    size_t shift = bigEndian ? (width - 1 - i) * 8 : i * 8;
+    value |= (uint64_t)bytes[i] << shift;
+  }
+  return value;
+}
+
+int64_t TemplateEngine::nodeNumber(int index) const
+{
+  if (index < 0)
+    return 0;
+
+  const TemplateNode& node = nodes[index];
+  if (node.kind == TPL_NODE_ARRAY)
+    return (int64_t)node.count;
+  if (node.kind != TPL_NODE_VALUE)
+    return 0;
+
+  switch (node.primitive)
+  {
+  case TPL_I8:
+    return (int8_t)node.raw;
+  case TPL_I16:
+    return (int16_t)node.raw;
+  case TPL_I32:
+    return (int32_t)node.raw;
+  case TPL_F32:
+  {
+    uint32_t bits = (uint32_t)node.raw;
+    float value;
+    memCopy(&value, &bits, sizeof(value));
+    return (int64_t)value;
+  }
+  case TPL_F64:
+  {
+    double value;
+    memCopy(&value, &node.raw, sizeof(value));
+    return (int64_t)value;
+  }
+  default:
+    return (int64_t)node.raw;
+  }
+}
+
+void TemplateEngine::formatValue(int index)
+{
+  TemplateNode& node = nodes[index];
+  const TemplateOp& op = program.ops[node.op];
+  char* out = node.value;
+  out[0] = '\0';
+
+  uint64_t width = g_TemplateWidths[node.primitive];
+  if (node.kind == TPL_NODE_ARRAY)
+  {
+    if (node.primitive == TPL_CHAR)
+    {
+      size_t length = node.count < TEMPLATE_VALUE_LEN - 3 ? (size_t)node.count : TEMPLATE_VALUE_LEN - 3;
+      uint8_t text[TEMPLATE_VALUE_LEN];
+      length = length > 0 ? read(readContext, node.offset, text, length) : 0;
+
+      size_t used = 0;
+      out[used++] = '"';
+      for (size_t i = 0; i < length && text[i] != 0; i++)
+        out[used++] = (text[i] >= 0x20 && text[i] < 0x7F) ? (char)text[i] : '.';
+      out[used++] = '"';
+      out[used] = '\0';
+      return;
+    }
+
+    const char* typeName = node.primitive == TPL_STRUCT ? program.structs[node.structIndex].name
+                           : op.enumIndex >= 0         ? program.enums[op.enumIndex].name
+                                                       : g_TemplateTypeNames[node.primitive];
+    char count[24];
+    itoaDec((long long)node.count, count, sizeof(count));
+    stringCopy(out, typeName, TEMPLATE_VALUE_LEN);
+    TemplateAppend(out, "[", TEMPLATE_VALUE_LEN);
+    TemplateAppend(out, count, TEMPLATE_VALUE_LEN);
+    TemplateAppend(out, "]", TEMPLATE_VALUE_LEN);
+    return;
+  }
+
+  if (node.kind != TPL_NODE_VALUE)
+    return;
+
+  if (node.offset >= dataSize || width > dataSize - node.offset)
+  {
+    stringCopy(out, "<end of data>", TEMPLATE_VALUE_LEN);
+    return;
+  }
+
+  char number[24];
+  if (op.enumIndex >= 0)
+  {
+    const TemplateEnum& e = program.enums[op.enumIndex];
+    int64_t value = nodeNumber(index);
+    itoaDec((long long)value, number, sizeof(number));
+    for (int i = 0; i < e.valueCount; i++)
+    {
+      const TemplateEnumValue& entry = program.enumValues[e.firstValue + i];
+      if (entry.value == value || (uint64_t)entry.value == node.raw)
+      {
+        stringCopy(out, entry.name, TEMPLATE_VALUE_LEN);
+        TemplateAppend(out, " (", TEMPLATE_VALUE_LEN);
+        TemplateAppend(out, number, TEMPLATE_VALUE_LEN);
+        TemplateAppend(out, ")", TEMPLATE_VALUE_LEN);
+        return;
+      }
+    }
+    stringCopy(out, number, TEMPLATE_VALUE_LEN);
+    return;
+  }
+
+  switch (node.primitive)
+  {
+  case TPL_F32:
+  {
+    uint32_t bits = (uint32_t)node.raw;
+    float value;
+    memCopy(&value, &bits, sizeof(value));
+    TemplateFormatDouble(value, out, TEMPLATE_VALUE_LEN);
+    return;
+  }
+  case TPL_F64:
+  {
+    double value;
+    memCopy(&value, &node.raw, sizeof(value));
+    TemplateFormatDouble(value, out, TEMPLATE_VALUE_LEN);
+    return;
+  }
+  case TPL_CHAR:
+    if (node.raw >= 0x20 && node.raw < 0x7F)
+    {
+      out[0] = '\'';
+      out[1] = (char)node.raw;
+      out[2] = '\'';
+      out[3] = '\0';
+      return;
+    }
+    break;
+  default:
+    break;
+  }
+
+  if (node.primitive == TPL_U64 && nodeNumber(index) < 0)
+    stringCopy(out, "", TEMPLATE_VALUE_LEN);
+  else
+    itoaDec((long long)nodeNumber(index), out, TEMPLATE_VALUE_LEN);
+  if (!out[0])
+  {
+    stringCopy(out, "0x", TEMPLATE_VALUE_LEN);
+    itoaHex(node.raw, number, sizeof(number));
+    TemplateAppend(out, number, TEMPLATE_VALUE_LEN);
+  }
+  else if (width > 1 || node.primitive == TPL_CHAR)
+  {
+    uint64_t mask = width >= 8 ? ~0ull : ((1ull << (width * 8)) - 1);
+    TemplateAppend(out, " (0x", TEMPLATE_VALUE_LEN);
+    itoaHex(node.raw & mask, number, sizeof(number));
+    TemplateAppend(out, number, TEMPLATE_VALUE_LEN);
+    TemplateAppend(out, ")", TEMPLATE_VALUE_LEN);
+  }
+}
+
+int TemplateEngine::addNode(int parent, TemplateNodeKind kind, const char* label, int op, uint64_t offset, bool linked)
+{
+  TemplateNode node;
+  stringCopy(node.label, label, TEMPLATE_LABEL_LEN);
+  node.value[0] = '\0';
+  node.offset = offset;
+  node.size = 0;
+  node.count = 0;
+  node.firstElement = 0;
+  node.raw = 0;
+  node.op = op;
+  node.structIndex = -1;
+  node.checkpoints = -1;
+  node.parent = parent;
+  node.firstChild = -1;
+  node.lastChild = -1;
+  node.nextSibling = -1;
+  node.depth = parent > 0 ? nodes[parent].depth + 1 : 0;
+  node.kind = kind;
+  node.primitive = op >= 0 ? program.ops[op].primitive : TPL_STRUCT;
+  node.expandable = false;
+  node.expanded = false;
+  node.decoded = false;
+  node.sized = true;
+  if (op >= 0 && program.ops[op].primitive == TPL_STRUCT)
+    node.structIndex = program.ops[op].structIndex;
+
+  int index = (int)nodes.size();
+  nodes.push_back(node);
+  if (parent >= 0 && linked)
+  {
+    if (nodes[parent].lastChild >= 0)
+      nodes[nodes[parent].lastChild].nextSibling = index;
+    else
+      nodes[parent].firstChild = index;
+    nodes[parent].lastChild = index;
+  }
+  return index;
+}
+
+int TemplateEngine::addField(int frame, int op, uint64_t offset)
+{
+  const TemplateOp& def = program.ops[op];
+
+  if (!def.isArray)
+  {
+    if (def.primitive != TPL_STRUCT)
+    {
+      int child = addNode(frame, TPL_NODE_VALUE, def.name, op, offset, true);
+      nodes[child].size = g_TemplateWidths[def.primitive];
+      nodes[child].raw = readValue(offset, def.primitive, def.bigEndian);
+      formatValue(child);
+      return child;
+    }
+
+    const TemplateStruct& type = program.structs[def.structIndex];
+    int child = addNode(frame, TPL_NODE_STRUCT, def.name, op, offset, true);
+    nodes[child].expandable = true;
+    stringCopy(nodes[child].value, type.name, TEMPLATE_VALUE_LEN);
+    if (type.fixedSize)
+      nodes[child].size = type.size;
+    else if (def.atExpr >= 0)
+      nodes[child].sized = false;
+    else
+      decodeStruct(child);
+    return child;
+  }
+
+  int64_t requested = 0;
+  evaluate(def.countExpr, frame, offset, &requested);
+  uint64_t count = requested > 0 ? (uint64_t)requested : 0;
+
+  int child = addNode(frame, TPL_NODE_ARRAY, def.name, op, offset, true);
+  uint64_t available = offset < dataSize ? dataSize - offset : 0;
+
+  if (def.primitive != TPL_STRUCT || program.structs[def.structIndex].fixedSize)
+  {
+    uint64_t elementSize = def.primitive != TPL_STRUCT ? g_TemplateWidths[def.primitive]
+                                                       : program.structs[def.structIndex].size;
+    if (elementSize > 0 && count > available / elementSize)
+      count = available / elementSize;
+    nodes[child].count = count;
+    nodes[child].size = count * elementSize;
+  }
+  else
+  {
+    nodes[child].checkpoints = (int)checkpoints.size();
+    Vector<uint64_t> marks;
+    marks.push_back(offset);
+    checkpoints.push_back(marks);
+
+    nodes[child].count = count;
+    if (def.atExpr >= 0)
+    {
+      // A placed array does not move the cursor, so its extent is only
+      // walked as far as a view or an expanded page needs it.
+      nodes[child].sized = false;
+    }
+    else
+    {
+      uint64_t reached = 0;
+      uint64_t end = elementOffset(child, count, &reached);
+      nodes[child].count = reached;
+      nodes[child].size = end - offset;
+    }
+  }
+
+  nodes[child].expandable = nodes[child].count > 0;
+  formatValue(child);
+  return child;
+}
+
+int TemplateEngine::addElement(int parent, uint64_t element, uint64_t offset, bool linked)
+{
+  char label[TEMPLATE_LABEL_LEN];
+  char number[24];
+  itoaDec((long long)element, number, sizeof(number));
+  stringCopy(label, "[", TEMPLATE_LABEL_LEN);
+  TemplateAppend(label, number, TEMPLATE_LABEL_LEN);
+  TemplateAppend(label, "]", TEMPLATE_LABEL_LEN);
+
+  int op = nodes[parent].op;
+  const TemplateOp& def = program.ops[op];
+  if (def.primitive != TPL_STRUCT)
+  {
+    int child = addNode(parent, TPL_NODE_VALUE, label, op, offset, linked);
+    nodes[child].size = g_TemplateWidths[def.primitive];
+    nodes[child].raw = readValue(offset, def.primitive, def.bigEndian);
+    nodes[child].firstElement = element;
+    formatValue(child);
+    return child;
+  }
+
+  const TemplateStruct& type = program.structs[def.structIndex];
+  int child = addNode(parent, TPL_NODE_STRUCT, label, op, offset, linked);
+  nodes[child].size = type.fixedSize ? type.size : 0;
+  nodes[child].firstElement = element;
+  nodes[child].expandable = true;
+  stringCopy(nodes[child].value, type.name, TEMPLATE_VALUE_LEN);
+  return child;
+}
+
+void TemplateEngine::discardFrom(size_t nodeMark, size_t checkpointMark)
+{
+  while (nodes.size() > nodeMark)
+    nodes.remove(nodes.size() - 1);
+  while (checkpoints.size() > checkpointMark)
+    checkpoints.remove(checkpoints.size() - 1);
+}
+
+bool TemplateEngine::evaluate(int expr, int frame, uint64_t cursor, int64_t* outValue)
+{
+  *outValue = 0;
+  if (expr < 0)
+    return false;
+
+  int64_t values[TEMPLATE_MAX_STACK];
+  int refs[TEMPLATE_MAX_STACK];
+  int top = 0;
+
+  const TemplateExpr& e = program.exprs[expr];
+  for (int i = 0; i < e.count; i++)
+  {
+    const TemplateInstr& instr = program.code[e.first + i];
+    switch (instr.code)
+    {
+    case TPL_INSTR_CONST:
+    case TPL_INSTR_POSITION:
+    case TPL_INSTR_FIELD:
+      if (top >= TEMPLATE_MAX_STACK)
+        return false;
+      refs[top] = instr.code == TPL_INSTR_FIELD ? findField(frame, instr.name) : -1;
+      values[top] = instr.code == TPL_INSTR_CONST      ? instr.value
+                    : instr.code == TPL_INSTR_POSITION ? (int64_t)cursor
+                                                       : nodeNumber(refs[top]);
+      top++;
+      break;
+
+    case TPL_INSTR_MEMBER:
+      if (top < 1)
+        return false;
+      refs[top - 1] = refs[top - 1] >= 0 ? findMember(refs[top - 1], instr.name) : -1;
+      values[top - 1] = nodeNumber(refs[top - 1]);
+      break;
+
+    case TPL_INSTR_UNARY:
+      if (top < 1)
+        return false;
+      if (instr.op == TPL_OPERATOR_NEGATE)
+        values[top - 1] = (int64_t)(0 - (uint64_t)values[top - 1]);
+      else if (instr.op == TPL_OPERATOR_NOT)
+        values[top - 1] = !values[top - 1];
+      else
+        values[top - 1] = ~values[top - 1];
+      refs[top - 1] = -1;
+      break;
+
+    case TPL_INSTR_BINARY:
+    {
+      if (top < 2)
+        return false;
+      int64_t a = values[top - 2];
+      int64_t b = values[top - 1];
+      int64_t r = 0;
+      switch (instr.op)
+      {
+      case TPL_OPERATOR_MUL: r = (int64_t)((uint64_t)a * (uint64_t)b); break;
+      // INT64_MIN / -1 traps, so -1 is handled as a wrapping negate.
+      case TPL_OPERATOR_DIV: r = b == -1 ? (int64_t)(0 - (uint64_t)a) : b != 0 ? a / b : 0; break;
+      case TPL_OPERATOR_MOD: r = b != 0 && b != -1 ? a % b : 0; break;
+      case TPL_OPERATOR_ADD: r = (int64_t)((uint64_t)a + (uint64_t)b); break;
+      case TPL_OPERATOR_SUB: r = (int64_t)((uint64_t)a - (uint64_t)b); break;
+      case TPL_OPERATOR_SHL: r = b >= 0 && b < 64 ? (int64_t)((uint64_t)a << b) : 0; break;
+      case TPL_OPERATOR_SHR: r = b >= 0 && b < 64 ? (int64_t)((uint64_t)a >> b) : 0; break;
+      case TPL_OPERATOR_LT: r = a < b; break;
+      case TPL_OPERATOR_LE: r = a <= b; break;
+      case TPL_OPERATOR_GT: r = a > b; break;
+      case TPL_OPERATOR_GE: r = a >= b; break;
+      case TPL_OPERATOR_EQ: r = a == b; break;
+      case TPL_OPERATOR_NE: r = a != b; break;
+      case TPL_OPERATOR_AND: r = a & b; break;
+      case TPL_OPERATOR_XOR: r = a ^ b; break;
+      case TPL_OPERATOR_OR: r = a | b; break;
+      case TPL_OPERATOR_LOGICAL_AND: r = a && b; break;
+      case TPL_OPERATOR_LOGICAL_OR: r = a || b; break;
+      default: break;
+      }
+      top--;
+      values[top - 1] = r;
+      refs[top - 1] = -1;
+      break;
+    }
+    }
+  }
+
+  if (top != 1)
+    return false;
+  *outValue = values[0];
+  return true;
+}
+
+int TemplateEngine::enclosingFrame(int index) const
+{
+  int parent = nodes[index].parent;
+  while (parent >= 0 && nodes[parent].kind != TPL_NODE_STRUCT)
+    parent = nodes[parent].parent;
+  return parent;
+}
+
+int TemplateEngine::findField(int frame, const char* fieldName)
+{
+  for (int current = frame; current >= 0; current = enclosingFrame(current))
+  {
+    int found = -1;
+    for (int child = nodes[current].firstChild; child >= 0; child = nodes[child].nextSibling)
+    {
+      if (strEquals(nodes[child].label, fieldName))
+        found = child;
+    }
+    if (found >= 0)
+      return found;
+  }
+  return -1;
+}
+
+int TemplateEngine::findMember(int index, const char* fieldName)
+{
+  if (nodes[index].kind != TPL_NODE_STRUCT)
+    return -1;
+
+  decodeStruct(index);
+  int found = -1;
+  for (int child = nodes[index].firstChild; child >= 0; child = nodes[child].nextSibling)
+  {
+    if (strEquals(nodes[child].label, fieldName))
+      found = child;
+  }
+  return found;
+}
+
+void TemplateEngine::decodeStruct(int index)
+{
+  if (nodes[index].decoded)
+    return;
+  nodes[index].decoded = true;
+  if (index < lowestDecoded)
+    lowestDecoded = index;
+  if (depth >= TEMPLATE_MAX_DEPTH)
+    return;
+  depth++;
+
+  const TemplateStruct& type = program.structs[nodes[index].structIndex];
+  uint64_t start = nodes[index].offset;
+  uint64_t cursor = start;
+  int pc = 0;
+
+  while (pc < type.opCount && nodes.size() < TEMPLATE_MAX_NODES)
+  {
+    const TemplateOp& op = program.ops[type.firstOp + pc];
+    if (op.code == TPL_OP_IF)
+    {
+      int64_t condition = 0;
+      evaluate(op.condExpr, index, cursor, &condition);
+      pc = condition ? pc + 1 : op.target;
+      continue;
+    }
+    if (op.code == TPL_OP_JUMP)
+    {
+      pc = op.target;
+      continue;
+    }
+
+    uint64_t offset = cursor;
+    if (op.atExpr >= 0)
+    {
+      int64_t at = 0;
+      evaluate(op.atExpr, index, cursor, &at);
+      offset = (uint64_t)at;
+    }
+
+    int child = addField(index, type.firstOp + pc, offset);
+    pc++;
+    if (op.atExpr < 0)
+    {
+      cursor = offset + nodes[child].size;
+      if (cursor > dataSize)
+        break;
+    }
+  }
+
+  nodes[index].size = cursor - start;
+  nodes[index].sized = true;
+  depth--;
+}
+
+void TemplateEngine::decodeArray(int index, uint64_t start)
+{
+  uint64_t count = nodes[index].count;
+  uint64_t end = count - start > TEMPLATE_PAGE_SIZE ? start + TEMPLATE_PAGE_SIZE : count;
+  uint64_t reached = 0;
+  uint64_t offset = elementOffset(index, start, &reached);
+
+  for (uint64_t i = start; i < end && nodes.size() < TEMPLATE_MAX_NODES; i++)
+  {
+    int child = addElement(index, i, offset, true);
+    if (nodes[child].kind == TPL_NODE_STRUCT && !program.structs[nodes[child].structIndex].fixedSize)
+      decodeStruct(child);
+    offset += nodes[child].size;
+  }
+
+  if (end < count)
+  {
+    char label[TEMPLATE_LABEL_LEN];
+    char text[24];
+    stringCopy(label, "... ", TEMPLATE_LABEL_LEN);
+    itoaDec((long long)(count - end), text, sizeof(text));
+    TemplateAppend(label, text, TEMPLATE_LABEL_LEN);
+    TemplateAppend(label, " more", TEMPLATE_LABEL_LEN);
+    int more = addNode(index, TPL_NODE_MORE, label, nodes[index].op, offset, true);
+    nodes[more].firstElement = end;
+    nodes[more].expandable = true;
+  }
+}
+
+void TemplateEngine::decodeMore(int index)
+{
+  int parent = nodes[index].parent;
+  uint64_t start = nodes[index].firstElement;
+
+  int previous = -1;
+  for (int child = nodes[parent].firstChild; child >= 0 && child != index; child = nodes[child].nextSibling)
+    previous = child;
+  if (previous >= 0)
+    nodes[previous].nextSibling = -1;
+  else
+    nodes[parent].firstChild = -1;
+  nodes[parent].lastChild = previous;
+  nodes[index].expandable = false;
+
+  decodeArray(parent, start);
+}
+
+uint64_t TemplateEngine::elementOffset(int index, uint64_t element, uint64_t* outReached)
+{
+  uint64_t start = nodes[index].offset;
+  const TemplateOp& def = program.ops[nodes[index].op];
+  if (def.primitive != TPL_STRUCT || program.structs[def.structIndex].fixedSize)
+  {
+    uint64_t elementSize = def.primitive != TPL_STRUCT ? g_TemplateWidths[def.primitive]
+                                                       : program.structs[def.structIndex].size;
+    *outReached = element;
+    return start + element * elementSize;
+  }
+
+  // Variable-size elements are walked from the nearest checkpoint; a
+  // checkpoint is recorded every TEMPLATE_CHECKPOINT elements so later
+  // lookups into the same region stay cheap.
+  int slot = nodes[index].checkpoints;
+  size_t known = checkpoints[slot].size();
+  size_t mark = (size_t)(element / TEMPLATE_CHECKPOINT);
+  if (mark >= known)
+    mark = known - 1;
+
+  uint64_t i = (uint64_t)mark * TEMPLATE_CHECKPOINT;
+  uint64_t position = checkpoints[slot][mark];
+  while (i < element && position < dataSize)
+  {
+    uint64_t size = measureElement(index, i, position);
+    if (size == 0)
+    {
+      i = element;
+      break;
+    }
+    position += size;
+    i++;
+    if (i % TEMPLATE_CHECKPOINT == 0 && i / TEMPLATE_CHECKPOINT == checkpoints[slot].size())
+      checkpoints[slot].push_back(position);
+  }
+
+  *outReached = i;
+  return position;
+}
+
+uint64_t TemplateEngine::measureElement(int index, uint64_t element, uint64_t offset)
+{
+  size_t nodeMark = nodes.size();
+  size_t checkpointMark = checkpoints.size();
+  int outerLowest = lowestDecoded;
+  lowestDecoded = 0x7FFFFFFF;
+
+  int temp = addElement(index, element, offset, false);
+  decodeStruct(temp);
+  uint64_t size = nodes[temp].size;
+
+  if (lowestDecoded >= (int)nodeMark)
+    discardFrom(nodeMark, checkpointMark);
+  if (outerLowest < lowestDecoded)
+    lowestDecoded = outerLowest;
+  return size;
+}
+
+void TemplateEngine::collectElement(int index, uint64_t element, uint64_t offset, uint64_t start, uint64_t end,
+                                    Vector<TemplateSpan>* outSpans, int level)
+{
+  size_t nodeMark = nodes.size();
+  size_t checkpointMark = checkpoints.size();
+  int outerLowest = lowestDecoded;
+  lowestDecoded = 0x7FFFFFFF;
+
+  int temp = addElement(index, element, offset, false);
+  collectSpans(temp, start, end, outSpans, level + 1);
+
+  if (lowestDecoded >= (int)nodeMark)
+    discardFrom(nodeMark, checkpointMark);
+  if (outerLowest < lowestDecoded)
+    lowestDecoded = outerLowest;
+}
+
+void TemplateEngine::collectSpans(int index, uint64_t start, uint64_t end, Vector<TemplateSpan>* outSpans, int level)
+{
+  if (level > TEMPLATE_MAX_DEPTH || budget <= 0)
+    return;
+  budget--;
+
+  TemplateNodeKind kind = nodes[index].kind;
+  uint64_t offset = nodes[index].offset;
+  uint64_t size = nodes[index].size;
+  bool overlaps = offset < end && (offset + size > start || !nodes[index].sized);
+
+  if (kind == TPL_NODE_MORE)
+    return;
+
+  if (kind == TPL_NODE_VALUE || (kind == TPL_NODE_ARRAY && nodes[index].primitive != TPL_STRUCT))
+  {
+    if (overlaps && size > 0)
+    {
+      TemplateSpan span;
+      span.offset = offset;
+      span.size = size;
+      span.color = nodes[index].op % TEMPLATE_PALETTE_SIZE;
+      outSpans->push_back(span);
+    }
+    return;
+  }
+
+  const TemplateStruct& type = program.structs[nodes[index].structIndex];
+  if (kind == TPL_NODE_STRUCT)
+  {
+    if (!overlaps && type.contained && (nodes[index].decoded || type.fixedSize))
+      return;
+    decodeStruct(index);
+    for (int child = nodes[index].firstChild; child >= 0; child = nodes[child].nextSibling)
+      collectSpans(child, start, end, outSpans, level + 1);
+    return;
+  }
+
+  if (!overlaps)
+    return;
+
+  uint64_t count = nodes[index].count;
+  if (type.fixedSize)
+  {
+    if (type.size == 0)
+      return;
+    uint64_t first = start > offset ? (start - offset) / type.size : 0;
+    uint64_t last = (end - offset + type.size - 1) / type.size;
+    if (last > count)
+      last = count;
+    for (uint64_t i = first; i < last; i++)
+      collectElement(index, i, offset + i * type.size, start, end, outSpans, level);
+    return;
+  }
+
+  int slot = nodes[index].checkpoints;
+  size_t lo = 0;
+  size_t hi = checkpoints[slot].size();
+  while (hi - lo > 1)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (checkpoints[slot][mid] <= start)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  uint64_t i = (uint64_t)lo * TEMPLATE_CHECKPOINT;
+  uint64_t position = checkpoints[slot][lo];
+  while (i < count && position < end && position < dataSize && budget > 0)
+  {
+    uint64_t elementSize = measureElement(index, i, position);
+    if (elementSize == 0)
+    {
+      i = count;
+      break;
+    }
+    if (position + elementSize > start)
+      collectElement(index, i, position, start, end, outSpans, level);
+    position += elementSize;
+    i++;
+    if (i % TEMPLATE_CHECKPOINT == 0 && i / TEMPLATE_CHECKPOINT == checkpoints[slot].size())
+      checkpoints[slot].push_back(position);
+  }
+
+  if (!nodes[index].sized && (i >= count || position >= dataSize))
+  {
+    nodes[index].sized = true;
+    nodes[index].count = i;
+    nodes[index].size = position - offset;
+    formatValue(index);
+  }
+}
@@ -0,0 +1,662 @@
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_HAVE_SSE2 1
+#endif
+
+#include "transform.h"
+#include "pluginexecutor.h"
+
+static const char g_HexDigits[] = "0123456789abcdef";
+static const char g_Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+const char* TransformKindName(TransformKind kind)
+{
+  switch (kind)
+  {
+  case TRANSFORM_XOR: return "XOR";
+  case TRANSFORM_ADD: return "Add";
+  case TRANSFORM_SUB: return "Subtract";
+  case TRANSFORM_ROTATE_LEFT: return "Rotate Left";
+  case TRANSFORM_ROTATE_RIGHT: return "Rotate Right";
+  case TRANSFORM_SWAP16: return "Swap 16";
+  case TRANSFORM_SWAP32: return "Swap 32";
+  case TRANSFORM_SWAP64: return "Swap 64";
+  case TRANSFORM_BASE64_DECODE: return "Base64 Decode";
+  case TRANSFORM_BASE64_ENCODE: return "Base64 Encode";
+  case TRANSFORM_HEX_DECODE: return "Hex Decode";
+  case TRANSFORM_HEX_ENCODE: return "Hex Encode";
+  case TRANSFORM_PLUGIN: return "Plugin";
+  }
+  return "?";
+}
+
+static void TransformError(char* outError, size_t errorMax, const char* message, uint64_t position)
+{
+  if (!outError || errorMax == 0)
+    return;
+
+  char text[TRANSFORM_ERROR_LEN];
+  stringCopy(text, message, sizeof(text));
+  if (position != (uint64_t)-1)
+  {
+    char number[24];
+    itoaHex(position, number, sizeof(number));
+    strCat(text, " at +0x");
+    strCat(text, number);
+  }
+  stringCopy(outError, text, (int)errorMax);
+}
+
+static size_t TransformWordSize(TransformKind kind)
+{
+  switch (kind)
+  {
+  case TRANSFORM_SWAP16: return 2;
+  case TRANSFORM_SWAP32: return 4;
+  case TRANSFORM_SWAP64: return 8;
+  default: return 1;
+  }
+}
+
+static int Base64Value(uint8_t c)
+{
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return -1;
+}
+
+bool TransformParseStep(TransformKind kind, const char* argument, TransformStep* outStep, char* outError, size_t errorMax)
+{
+  memSet(outStep, 0, sizeof(TransformStep));
+  outStep->kind = kind;
+  if (!argument)
+    argument = "";
+
+  switch (kind)
+  {
+  case TRANSFORM_XOR:
+  case TRANSFORM_ADD:
+  case TRANSFORM_SUB:
+  {
+    const char* p = argument;
+    while (*p)
+    {
+      if (*p == ' ' || *p == ',' || *p == '\t')
+      {
+        p++;
+        continue;
+      }
+      if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+      {
+        p += 2;
+        continue;
+      }
+      if (!isXDigit(p[0]) || !isXDigit(p[1]))
+      {
+        TransformError(outError, errorMax, "Key must be hex bytes, e.g. 5A or DE AD BE EF", (uint64_t)-1);
+        return false;
+      }
+      if (outStep->keyLength >= TRANSFORM_MAX_KEY)
+      {
+        TransformError(outError, errorMax, "Key is longer than 64 bytes", (uint64_t)-1);
+        return false;
+      }
+      outStep->key[outStep->keyLength++] = (uint8_t)((hexDigitToInt(p[0]) << 4) | hexDigitToInt(p[1]));
+      p += 2;
+    }
+    if (outStep->keyLength == 0)
+    {
+      TransformError(outError, errorMax, "Key is empty", (uint64_t)-1);
+      return false;
+    }
+    return true;
+  }
+
+  case TRANSFORM_ROTATE_LEFT:
+  case TRANSFORM_ROTATE_RIGHT:
+  {
+    const char* p = argument;
+    while (*p == ' ')
+      p++;
+    uint32_t bits = 0;
+    while (*p >= '0' && *p <= '9' && bits < 100)
+      bits = bits * 10 + (uint32_t)(*p++ - '0');
+    while (*p == ' ')
+      p++;
+    if (*p || bits < 1 || bits > 7)
+    {
+      TransformError(outError, errorMax, "Rotate count must be 1 to 7 bits", (uint64_t)-1);
+      return false;
+    }
+    outStep->bits = bits;
+    return true;
+  }
+
+  case TRANSFORM_PLUGIN:
+    if (!argument[0])
+    {
+      TransformError(outError, errorMax, "No plugin given", (uint64_t)-1);
+      return false;
+    }
+    stringCopy(outStep->pluginPath, argument, sizeof(outStep->pluginPath));
+    return true;
+
+  default:
+    return true;
+  }
+}
+
+#ifdef TRANSFORM_HAVE_SSE2
+static inline __m128i TransformSwap16(__m128i v)
+{
+  return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+#endif
+
+static void TransformSwapWords(uint8_t* data, size_t length, size_t wordSize)
+{
+  size_t i = 0;
+#ifdef TRANSFORM_HAVE_SSE2
+  for (; i + 16 <= length; i += 16)
+  {
+    __m128i v = TransformSwap16(_mm_loadu_si128((const __m128i*)(data + i)));
+    if (wordSize == 4)
+    {
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+    else if (wordSize == 8)
+    {
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+    _mm_storeu_si128((__m128i*)(data + i), v);
+  }
+#endif
+  for (; i + wordSize <= length; i += wordSize)
+  {
+    for (size_t a = i, b = i + wordSize - 1; a < b; a++, b--)
+    {
+      uint8_t t = data[a];
+      data[a] = data[b];
+      data[b] = t;
+    }
+  }
+}
+
+void TransformApplyBytes(const TransformStep& step, uint8_t* data, size_t length, uint64_t position)
+{
+  if (step.kind == TRANSFORM_ROTATE_LEFT || step.kind == TRANSFORM_ROTATE_RIGHT)
+  {
+    int left = (int)(step.kind == TRANSFORM_ROTATE_LEFT ? step.bits : 8 - step.bits) & 7;
+    if (left == 0)
+      return;
+
+    size_t i = 0;
+#ifdef TRANSFORM_HAVE_SSE2
+    // SSE2 has no byte shifts; shift 16-bit lanes and mask off what crossed
+    // into the neighbouring byte.
+    const __m128i highMask = _mm_set1_epi8((char)((0xFF << left) & 0xFF));
+    const __m128i lowMask = _mm_set1_epi8((char)(0xFF >> (8 - left)));
+    const __m128i leftCount = _mm_cvtsi32_si128(left);
+    const __m128i rightCount = _mm_cvtsi32_si128(8 - left);
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+      __m128i high = _mm_and_si128(_mm_sll_epi16(v, leftCount), highMask);
+      __m128i low = _mm_and_si128(_mm_srl_epi16(v, rightCount), lowMask);
+      _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(high, low));
+    }
+#endif
+    for (; i < length; i++)
+      data[i] = (uint8_t)((data[i] << left) | (data[i] >> (8 - left)));
+    return;
+  }
+
+  if (step.kind != TRANSFORM_XOR && step.kind != TRANSFORM_ADD && step.kind != TRANSFORM_SUB)
+    return;
+  if (step.keyLength == 0)
+    return;
+
+  // Repeat the key, starting at this block's phase, until the pattern is a
+  // multiple of 16 bytes long; every vector then reads one aligned slice.
+  uint8_t pattern[TRANSFORM_MAX_KEY * 16];
+  size_t patternLength = step.keyLength * 16;
+  size_t phase = (size_t)(position % step.keyLength);
+  for (size_t j = 0; j < patternLength; j++)
+    pattern[j] = step.key[(phase + j) % step.keyLength];
+
+  size_t i = 0;
+#ifdef TRANSFORM_HAVE_SSE2
+  for (; i + 16 <= length; i += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+    __m128i k = _mm_loadu_si128((const __m128i*)(pattern + i % patternLength));
+    if (step.kind == TRANSFORM_XOR)
+      v = _mm_xor_si128(v, k);
+    else if (step.kind == TRANSFORM_ADD)
+      v = _mm_add_epi8(v, k);
+    else
+      v = _mm_sub_epi8(v, k);
+    _mm_storeu_si128((__m128i*)(data + i), v);
+  }
+#endif
+  for (; i < length; i++)
+  {
+    uint8_t k = pattern[i % patternLength];
+    if (step.kind == TRANSFORM_XOR)
+      data[i] ^= k;
+    else if (step.kind == TRANSFORM_ADD)
+      data[i] = (uint8_t)(data[i] + k);
+    else
+      data[i] = (uint8_t)(data[i] - k);
+  }
+}
+
+TransformPipeline::TransformPipeline(TransformReadFn readFn, void* context, uint64_t rangeStart, uint64_t rangeLength)
+  : source(readFn), sourceContext(context), start(rangeStart), inputLength(rangeLength), useCounter(0)
+{
+  for (int i = 0; i < TRANSFORM_PAGE_CACHE; i++)
+  {
+    pages[i].index = 0;
+    pages[i].lastUsed = 0;
+    pages[i].data = nullptr;
+    pages[i].length = 0;
+    pages[i].valid = false;
+  }
+}
+
+TransformPipeline::~TransformPipeline()
+{
+  for (int i = 0; i < TRANSFORM_PAGE_CACHE; i++)
+    platformFree(pages[i].data, TRANSFORM_PAGE_SIZE);
+}
+
+void TransformPipeline::invalidate()
+{
+  for (int i = 0; i < TRANSFORM_PAGE_CACHE; i++)
+    pages[i].valid = false;
+}
+
+bool TransformPipeline::isInPlace() const
+{
+  for (size_t i = 0; i < steps.size(); i++)
+  {
+    TransformKind kind = steps[i].kind;
+    if (kind == TRANSFORM_BASE64_DECODE || kind == TRANSFORM_BASE64_ENCODE ||
+        kind == TRANSFORM_HEX_DECODE || kind == TRANSFORM_HEX_ENCODE)
+      return false;
+  }
+  return true;
+}
+
+void TransformPipeline::describe(char* out, size_t max) const
+{
+  if (!out || max == 0)
+    return;
+  out[0] = '\0';
+
+  char text[256];
+  text[0] = '\0';
+  for (size_t i = 0; i < steps.size(); i++)
+  {
+    const TransformStep& step = steps[i];
+    if (i > 0)
+      strCat(text, ", ");
+
+    if (step.kind == TRANSFORM_PLUGIN)
+    {
+      const char* name = step.pluginPath;
+      for (const char* p = step.pluginPath; *p; p++)
+      {
+        if (*p == '/' || *p == '\\')
+          name = p + 1;
+      }
+      if (strLen(text) + strLen(name) + 8 < sizeof(text))
+        strCat(text, name);
+      continue;
+    }
+
+    strCat(text, TransformKindName(step.kind));
+    if (step.keyLength > 0)
+    {
+      strCat(text, " ");
+      for (uint32_t k = 0; k < step.keyLength && k < 8; k++)
+      {
+        char digits[3] = { g_HexDigits[step.key[k] >> 4], g_HexDigits[step.key[k] & 15], '\0' };
+        strCat(text, digits);
+      }
+      if (step.keyLength > 8)
+        strCat(text, "..");
+    }
+    else if (step.bits > 0)
+    {
+      char digits[4];
+      itoaDec(step.bits, digits, sizeof(digits));
+      strCat(text, " ");
+      strCat(text, digits);
+    }
+
+    if (strLen(text) > sizeof(text) - 40)
+      break;
+  }
+  stringCopy(out, text, (int)max);
+}
+
+bool TransformPipeline::addStep(const TransformStep& step, char* outError, size_t errorMax)
+{
+  if (steps.size() >= TRANSFORM_MAX_STEPS)
+  {
+    TransformError(outError, errorMax, "Too many transform steps", (uint64_t)-1);
+    return false;
+  }
+
+  uint64_t in = getOutputLength();
+  uint64_t out = in;
+  switch (step.kind)
+  {
+  case TRANSFORM_HEX_DECODE:
+    if (in % 2 != 0)
+    {
+      TransformError(outError, errorMax, "Hex input has an odd number of digits", (uint64_t)-1);
+      return false;
+    }
+    out = in / 2;
+    break;
+
+  case TRANSFORM_HEX_ENCODE:
+    out = in * 2;
+    break;
+
+  case TRANSFORM_BASE64_ENCODE:
+    out = (in + 2) / 3 * 4;
+    break;
+
+  case TRANSFORM_BASE64_DECODE:
+  {
+    if (in % 4 != 0)
+    {
+      TransformError(outError, errorMax, "Base64 input length is not a multiple of 4", (uint64_t)-1);
+      return false;
+    }
+    out = in / 4 * 3;
+    if (in >= 4)
+    {
+      uint8_t tail[2];
+      if (!readStep((int)steps.size() - 1, in - 2, tail, 2, outError, errorMax))
+        return false;
+      if (tail[1] == '=')
+        out -= tail[0] == '=' ? 2 : 1;
+    }
+    break;
+  }
+
+  default:
+    break;
+  }
+
+  steps.push_back(step);
+  lengths.push_back(out);
+  invalidate();
+  return true;
+}
+
+bool TransformPipeline::readStep(int step, uint64_t position, uint8_t* out, size_t length, char* outError, size_t errorMax)
+{
+  if (length == 0)
+    return true;
+
+  if (step < 0)
+  {
+    if (!source || source(sourceContext, start + position, out, length) != length)
+    {
+      TransformError(outError, errorMax, "Failed to read source bytes", position);
+      return false;
+    }
+    return true;
+  }
+
+  const TransformStep& current = steps[step];
+  uint64_t in = step > 0 ? lengths[step - 1] : inputLength;
+
+  switch (current.kind)
+  {
+  case TRANSFORM_XOR:
+  case TRANSFORM_ADD:
+  case TRANSFORM_SUB:
+  case TRANSFORM_ROTATE_LEFT:
+  case TRANSFORM_ROTATE_RIGHT:
+    if (!readStep(step - 1, position, out, length, outError, errorMax))
+      return false;
+    TransformApplyBytes(current, out, length, position);
+    return true;
+
+  case TRANSFORM_PLUGIN:
+  {
+    if (!readStep(step - 1, position, out, length, outError, errorMax))
+      return false;
+
+    ByteBuffer result;
+    bb_init(&result);
+    char error[TRANSFORM_ERROR_LEN];
+    error[0] = '\0';
+    bool ok = ExecutePluginTransform(current.pluginPath, out, length, position, &result, error, sizeof(error));
+    if (ok && result.size != length)
+    {
+      stringCopy(error, "Plugin transform must return as many bytes as it was given", sizeof(error));
+      ok = false;
+    }
+    if (ok)
+      memCopy(out, result.data, length);
+    else
+      TransformError(outError, errorMax, error[0] ? error : "Plugin transform failed", position);
+    bb_free(&result);
+    return ok;
+  }
+
+  default:
+    break;
+  }
+
+  // The remaining steps work on whole units (words, digit pairs, base64
+  // quads); read the units that cover the request and cut the slice out.
+  uint64_t unitIn = 1;
+  uint64_t unitOut = 1;
+  switch (current.kind)
+  {
+  case TRANSFORM_SWAP16:
+  case TRANSFORM_SWAP32:
+  case TRANSFORM_SWAP64:
+    unitIn = unitOut = TransformWordSize(current.kind);
+    break;
+  case TRANSFORM_HEX_DECODE: unitIn = 2; unitOut = 1; break;
+  case TRANSFORM_HEX_ENCODE: unitIn = 1; unitOut = 2; break;
+  case TRANSFORM_BASE64_DECODE: unitIn = 4; unitOut = 3; break;
+  case TRANSFORM_BASE64_ENCODE: unitIn = 3; unitOut = 4; break;
+  default: break;
+  }
+
+  uint64_t firstUnit = position / unitOut;
+  uint64_t lastUnit = (position + length + unitOut - 1) / unitOut;
+  uint64_t inStart = firstUnit * unitIn;
+  uint64_t inEnd = lastUnit * unitIn;
+  if (inEnd > in)
+    inEnd = in;
+
+  size_t inSize = (size_t)(inEnd - inStart);
+  size_t outSize = (size_t)((lastUnit - firstUnit) * unitOut);
+  uint8_t* input = (uint8_t*)platformAlloc(inSize + outSize + 1);
+  if (!input)
+  {
+    TransformError(outError, errorMax, "Out of memory", (uint64_t)-1);
+    return false;
+  }
+  uint8_t* output = input + inSize;
+
+  bool ok = readStep(step - 1, inStart, input, inSize, outError, errorMax);
+  if (ok)
+  {
+    switch (current.kind)
+    {
+    case TRANSFORM_SWAP16:
+    case TRANSFORM_SWAP32:
+    case TRANSFORM_SWAP64:
+      // A trailing partial word is left as it is.
+      memCopy(output, input, inSize);
+      TransformSwapWords(output, inSize - inSize % unitIn, (size_t)unitIn);
+      break;
+
+    case TRANSFORM_HEX_DECODE:
+      for (size_t i = 0; i + 1 < inSize; i += 2)
+      {
+        if (!isXDigit((char)input[i]) || !isXDigit((char)input[i + 1]))
+        {
+          TransformError(outError, errorMax, "Invalid hex digit", inStart + i);
+          ok = false;
+          break;
+        }
+        output[i / 2] = (uint8_t)((hexDigitToInt((char)input[i]) << 4) | hexDigitToInt((char)input[i + 1]));
+      }
+      break;
+
+    case TRANSFORM_HEX_ENCODE:
+      for (size_t i = 0; i < inSize; i++)
+      {
+        output[i * 2] = (uint8_t)g_HexDigits[input[i] >> 4];
+        output[i * 2 + 1] = (uint8_t)g_HexDigits[input[i] & 15];
+      }
+      break;
+
+    case TRANSFORM_BASE64_DECODE:
+      for (size_t i = 0; i + 3 < inSize; i += 4)
+      {
+        uint32_t group = 0;
+        for (int j = 0; j < 4; j++)
+        {
+          uint8_t c = input[i + j];
+          int value = Base64Value(c);
+          // Padding may only close the final quad.
+          if (value < 0 && !(c == '=' && inStart + i + 4 == in && j >= 2 && (j == 3 || input[i + 3] == '=')))
+          {
+            TransformError(outError, errorMax, "Invalid base64 character", inStart + i + j);
+            ok = false;
+            break;
+          }
+          group = (group << 6) | (uint32_t)(value < 0 ? 0 : value);
+        }
+        if (!ok)
+          break;
+        output[i / 4 * 3] = (uint8_t)(group >> 16);
+        output[i / 4 * 3 + 1] = (uint8_t)(group >> 8);
+        output[i / 4 * 3 + 2] = (uint8_t)group;
+      }
+      break;
+
+    case TRANSFORM_BASE64_ENCODE:
+      for (size_t i = 0; i < inSize; i += 3)
+      {
+        size_t avail = inSize - i < 3 ? inSize - i : 3;
+        uint32_t group = (uint32_t)input[i] << 16;
+        if (avail > 1)
+          group |= (uint32_t)input[i + 1] << 8;
+        if (avail > 2)
+          group |= input[i + 2];
+        uint8_t* quad = output + i / 3 * 4;
+        quad[0] = (uint8_t)g_Base64Alphabet[(group >> 18) & 63];
+        quad[1] = (uint8_t)g_Base64Alphabet[(group >> 12) & 63];
+        quad[2] = avail > 1 ? (uint8_t)g_Base64Alphabet[(group >> 6) & 63] : '=';
+        quad[3] = avail > 2 ? (uint8_t)g_Base64Alphabet[group & 63] : '=';
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  if (ok)
+    memCopy(out, output + (position - firstUnit * unitOut), length);
+  platformFree(input, inSize + outSize + 1);
+  return ok;
+}
+
+bool TransformPipeline::read(uint64_t position, uint8_t* out, size_t length, char* outError, size_t errorMax)
+{
+  uint64_t total = getOutputLength();
+  if (position > total || length > total - position)
+  {
+    TransformError(outError, errorMax, "Read past the end of the transform", position);
+    return false;
+  }
+  return readStep((int)steps.size() - 1, position, out, length, outError, errorMax);
+}
+
+const TransformPipeline::Page* TransformPipeline::fetchPage(uint64_t index)
+{
+  Page* victim = &pages[0];
+  for (int i = 0; i < TRANSFORM_PAGE_CACHE; i++)
+  {
+    if (pages[i].valid && pages[i].index == index)
+    {
+      pages[i].lastUsed = ++useCounter;
+      return &pages[i];
+    }
+    if (!pages[i].valid)
+    {
+      if (victim->valid)
+        victim = &pages[i];
+    }
+    else if (victim->valid && pages[i].lastUsed < victim->lastUsed)
+    {
+      victim = &pages[i];
+    }
+  }
+
+  if (!victim->data)
+  {
+    victim->data = (uint8_t*)platformAlloc(TRANSFORM_PAGE_SIZE);
+    if (!victim->data)
+      return nullptr;
+  }
+
+  uint64_t position = index * TRANSFORM_PAGE_SIZE;
+  uint64_t total = getOutputLength();
+  size_t length = (size_t)(total - position < TRANSFORM_PAGE_SIZE ? total - position : TRANSFORM_PAGE_SIZE);
+  victim->valid = false;
+  if (!read(position, victim->data, length, nullptr, 0))
+    return nullptr;
+
+  victim->index = index;
+  victim->length = length;
+  victim->lastUsed = ++useCounter;
+  victim->valid = true;
+  return victim;
+}
+
+void TransformPipeline::overlay(uint64_t offset, uint8_t* data, size_t length)
+{
+  // Only the part of the output that lines up with the source range can be
+  // shown in place; a longer output is cut off and a shorter one leaves the
+  // rest of the range as it is.
+  uint64_t shown = getOutputLength() < inputLength ? getOutputLength() : inputLength;
+  uint64_t from = offset > start ? offset : start;
+  uint64_t to = offset + length < start + shown ? offset + length : start + shown;
+
+  while (from < to)
+  {
+    uint64_t position = from - start;
+    const Page* page = fetchPage(position / TRANSFORM_PAGE_SIZE);
+    if (!page)
+      return;
+
+    size_t within = (size_t)(position % TRANSFORM_PAGE_SIZE);
+    size_t count = page->length - within;
+    if (count > to - from)
+      count = (size_t)(to - from);
+    memCopy(data + (from - offset), page->data + within, count);
+    from += count;
+  }
+}
@@ -0,0 +1,1147 @@
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCAN_HAVE_SSE2 1
+#endif
+
+#include "valuescanner.h"
+
+struct ScanJob
+{
+  const ScanTarget* target;
+  const ScanBlock* input;
+  ScanBlock* output;
+  size_t blockCount;
+  volatile long nextBlock;
+  ScanCompare compare;
+  const ScanValue* value;
+  ScanValueType type;
+  size_t valueSize;
+  size_t alignment;
+  const uint8_t* uniformPrevious;
+  bool storeValues;
+  bool first;
+  volatile long failed;
+};
+
+struct ScanWorker
+{
+  ScanJob* job;
+  uint8_t* buffer;
+  uint32_t* indices;
+#ifdef _WIN32
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+  bool started;
+};
+
+struct ScanIterator
+{
+  const ScanBlock* block;
+  size_t position;
+  size_t ordinal;
+  uint32_t index;
+};
+
+static inline unsigned ScanCtz(uint32_t mask)
+{
+#ifdef _MSC_VER
+  unsigned long bit;
+  _BitScanForward(&bit, mask);
+  return (unsigned)bit;
+#else
+  return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static inline bool ScanBytesEqual(const uint8_t* a, const uint8_t* b, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    if (a[i] != b[i])
+      return false;
+  }
+  return true;
+}
+
+static inline uint64_t ScanLoadUnsigned(const uint8_t* p, size_t size)
+{
+  uint64_t v = 0;
+  for (size_t i = 0; i < size; i++)
+    v |= (uint64_t)p[i] << (i * 8);
+  return v;
+}
+
+static inline int64_t ScanLoadSigned(const uint8_t* p, size_t size)
+{
+  unsigned shift = (unsigned)(64 - size * 8);
+  return (int64_t)(ScanLoadUnsigned(p, size) << shift) >> shift;
+}
+
+static inline double ScanLoadReal(ScanValueType type, const uint8_t* p)
+{
+  if (type == SCAN_TYPE_FLOAT)
+  {
+    uint32_t bits = (uint32_t)ScanLoadUnsigned(p, 4);
+    float f;
+    memCopy(&f, &bits, 4);
+    return f;
+  }
+
+  uint64_t bits = ScanLoadUnsigned(p, 8);
+  double d;
+  memCopy(&d, &bits, 8);
+  return d;
+}
+
+static inline bool ScanIsReal(ScanValueType type)
+{
+  return type == SCAN_TYPE_FLOAT || type == SCAN_TYPE_DOUBLE;
+}
+
+static inline bool ScanIsSigned(ScanValueType type)
+{
+  return type >= SCAN_TYPE_I8 && type <= SCAN_TYPE_I64;
+}
+
+static int ScanOrder(ScanValueType type, size_t size, const uint8_t* a, const uint8_t* b)
+{
+  if (ScanIsReal(type))
+  {
+    double x = ScanLoadReal(type, a);
+    double y = ScanLoadReal(type, b);
+    return x > y ? 1 : (x < y ? -1 : 0);
+  }
+
+  if (ScanIsSigned(type))
+  {
+    int64_t x = ScanLoadSigned(a, size);
+    int64_t y = ScanLoadSigned(b, size);
+    return x > y ? 1 : (x < y ? -1 : 0);
+  }
+
+  if (type == SCAN_TYPE_STRING)
+    return 0;
+
+  uint64_t x = ScanLoadUnsigned(a, size);
+  uint64_t y = ScanLoadUnsigned(b, size);
+  return x > y ? 1 : (x < y ? -1 : 0);
+}
+
+static inline bool ScanEquals(const ScanValue* value, size_t size, const uint8_t* p)
+{
+  if (ScanIsReal(value->type))
+  {
+    double diff = ScanLoadReal(value->type, p) - value->real;
+    if (diff < 0)
+      diff = -diff;
+    return diff <= value->tolerance;
+  }
+  return ScanBytesEqual(p, value->bytes, size);
+}
+
+size_t ScanTypeSize(ScanValueType type)
+{
+  switch (type)
+  {
+  case SCAN_TYPE_U8:
+  case SCAN_TYPE_I8:
+    return 1;
+  case SCAN_TYPE_U16:
+  case SCAN_TYPE_I16:
+    return 2;
+  case SCAN_TYPE_U32:
+  case SCAN_TYPE_I32:
+  case SCAN_TYPE_FLOAT:
+    return 4;
+  case SCAN_TYPE_U64:
+  case SCAN_TYPE_I64:
+  case SCAN_TYPE_DOUBLE:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+static const char* ScanSkipSpaces(const char* p)
+{
+  while (*p == ' ' || *p == '\t')
+    p++;
+  return p;
+}
+
+static bool ScanParseInteger(const char* p, uint64_t* outMagnitude, bool* outNegative)
+{
+  p = ScanSkipSpaces(p);
+  bool negative = false;
+  if (*p == '-' || *p == '+')
+  {
+    negative = (*p == '-');
+    p++;
+  }
+
+  int base = 10;
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+  {
+    base = 16;
+    p += 2;
+  }
+
+  uint64_t magnitude = 0;
+  int digits = 0;
+  for (;; p++)
+  {
+    int digit;
+    if (*p >= '0' && *p <= '9')
+      digit = *p - '0';
+    else if (base == 16 && *p >= 'a' && *p <= 'f')
+      digit = *p - 'a' + 10;
+    else if (base == 16 && *p >= 'A' && *p <= 'F')
+      digit = *p - 'A' + 10;
+    else
+      break;
+
+    if (magnitude > (~0ULL - (uint64_t)digit) / (uint64_t)base)
+      return false;
+    magnitude = magnitude * base + digit;
+    digits++;
+  }
+
+  if (digits == 0 || *ScanSkipSpaces(p) != 0)
+    return false;
+
+  *outMagnitude = magnitude;
+  *outNegative = negative;
+  return true;
+}
+
+static bool ScanParseReal(const char* p, double* outValue, double* outTolerance)
+{
+  p = ScanSkipSpaces(p);
+  bool negative = false;
+  if (*p == '-' || *p == '+')
+  {
+    negative = (*p == '-');
+    p++;
+  }
+
+  double value = 0;
+  int digits = 0;
+  int fraction = 0;
+  while (*p >= '0' && *p <= '9')
+  {
+    value = value * 10 + (*p++ - '0');
+    digits++;
+  }
+
+  if (*p == '.' || *p == ',')
+  {
+    p++;
+    while (*p >= '0' && *p <= '9')
+    {
+      value = value * 10 + (*p++ - '0');
+      digits++;
+      fraction++;
+    }
+  }
+
+  if (digits == 0)
+    return false;
+
+  int exponent = 0;
+  if (*p == 'e' || *p == 'E')
+  {
+    p++;
+    bool negativeExponent = false;
+    if (*p == '-' || *p == '+')
+      negativeExponent = (*p++ == '-');
+    if (*p < '0' || *p > '9')
+      return false;
+    while (*p >= '0' && *p <= '9' && exponent < 400)
+      exponent = exponent * 10 + (*p++ - '0');
+    if (negativeExponent)
+      exponent = -exponent;
+  }
+
+  if (*ScanSkipSpaces(p) != 0)
+    return false;
+
+  // Like a typed-in search, "1.5" matches anything that rounds to 1.5.
+  int scale = exponent - fraction;
+  double tolerance = 0.5;
+  for (int i = 0; i < scale; i++)
+  {
+    value *= 10;
+    tolerance *= 10;
+  }
+  for (int i = 0; i > scale; i--)
+  {
+    value /= 10;
+    tolerance /= 10;
+  }
+
+  *outValue = negative ? -value : value;
+  *outTolerance = tolerance;
+  return true;
+}
+
+bool ParseScanValue(ScanValueType type, const char* text, ScanValue* outValue)
+{
+  if (!text || !outValue)
+    return false;
+
+  memSet(outValue, 0, sizeof(ScanValue));
+  outValue->type = type;
+
+  if (type == SCAN_TYPE_STRING)
+  {
+    size_t length = strLen(text);
+    if (length == 0 || length > SCAN_MAX_STRING)
+      return false;
+    memCopy(outValue->bytes, text, length);
+    outValue->size = length;
+    return true;
+  }
+
+  size_t size = ScanTypeSize(type);
+  outValue->size = size;
+
+  if (ScanIsReal(type))
+  {
+    double real;
+    double tolerance;
+    if (!ScanParseReal(text, &real, &tolerance))
+      return false;
+
+    outValue->real = real;
+    outValue->tolerance = tolerance;
+    if (type == SCAN_TYPE_FLOAT)
+    {
+      float f = (float)real;
+      memCopy(outValue->bytes, &f, 4);
+    }
+    else
+    {
+      memCopy(outValue->bytes, &real, 8);
+    }
+    return true;
+  }
+
+  uint64_t magnitude;
+  bool negative;
+  if (!ScanParseInteger(text, &magnitude, &negative))
+    return false;
+
+  unsigned bits = (unsigned)(size * 8);
+  uint64_t raw;
+  if (ScanIsSigned(type))
+  {
+    uint64_t limit = 1ULL << (bits - 1);
+    if (negative ? magnitude > limit : magnitude >= limit)
+      return false;
+    raw = negative ? (uint64_t)0 - magnitude : magnitude;
+  }
+  else
+  {
+    if (negative && magnitude != 0)
+      return false;
+    if (bits < 64 && magnitude >> bits)
+      return false;
+    raw = magnitude;
+  }
+
+  for (size_t i = 0; i < size; i++)
+    outValue->bytes[i] = (uint8_t)(raw >> (i * 8));
+  outValue->real = negative ? -(double)magnitude : (double)magnitude;
+  return true;
+}
+
+bool ParseScanQuery(const char* text, ScanValue* outValue, bool* outUnknown)
+{
+  static const struct
+  {
+    const char* name;
+    ScanValueType type;
+  } names[] = {
+    {"u8", SCAN_TYPE_U8}, {"u16", SCAN_TYPE_U16}, {"u32", SCAN_TYPE_U32}, {"u64", SCAN_TYPE_U64},
+    {"i8", SCAN_TYPE_I8}, {"i16", SCAN_TYPE_I16}, {"i32", SCAN_TYPE_I32}, {"i64", SCAN_TYPE_I64},
+    {"f32", SCAN_TYPE_FLOAT}, {"float", SCAN_TYPE_FLOAT},
+    {"f64", SCAN_TYPE_DOUBLE}, {"double", SCAN_TYPE_DOUBLE},
+    {"str", SCAN_TYPE_STRING}, {"string", SCAN_TYPE_STRING},
+  };
+
+  if (!text || !outValue || !outUnknown)
+    return false;
+
+  const char* p = ScanSkipSpaces(text);
+  ScanValueType type = SCAN_TYPE_I32;
+
+  char word[8];
+  size_t length = 0;
+  while (p[length] && p[length] != ' ' && p[length] != '\t' && length < sizeof(word) - 1)
+  {
+    char c = p[length];
+    word[length++] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+  }
+  word[length] = 0;
+
+  if (p[length] == 0 || p[length] == ' ' || p[length] == '\t')
+  {
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+      if (strEquals(word, names[i].name))
+      {
+        type = names[i].type;
+        p = ScanSkipSpaces(p + length);
+        if (type == SCAN_TYPE_STRING && *p == 0)
+          return false;
+        break;
+      }
+    }
+  }
+
+  *outUnknown = false;
+  if (type != SCAN_TYPE_STRING && (*p == 0 || (p[0] == '?' && *ScanSkipSpaces(p + 1) == 0)))
+  {
+    memSet(outValue, 0, sizeof(ScanValue));
+    outValue->type = type;
+    outValue->size = ScanTypeSize(type);
+    *outUnknown = true;
+    return true;
+  }
+
+  return ParseScanValue(type, p, outValue);
+}
+
+static size_t ScanFindPattern(const uint8_t* data, size_t avail, size_t slots, size_t align,
+                              const uint8_t* pattern, size_t size, uint32_t* out)
+{
+  size_t found = 0;
+  size_t limit = slots * align;
+  size_t i = 0;
+
+#ifdef SCAN_HAVE_SSE2
+  if (align <= 16 && (align & (align - 1)) == 0)
+  {
+    // Aligned searches compare whole lanes at once: a lane matches when all
+    // of its bytes matched. Everything else filters on the first byte.
+    bool wholeLanes = (align == size && size <= 8);
+    uint32_t laneMask = align == 1 ? 0xFFFF : align == 2 ? 0x5555 : align == 4 ? 0x1111 : align == 8 ? 0x0101 : 0x0001;
+
+    uint8_t lanes[16];
+    for (size_t k = 0; k < 16; k++)
+      lanes[k] = wholeLanes ? pattern[k % size] : pattern[0];
+    __m128i needle = _mm_loadu_si128((const __m128i*)lanes);
+
+    for (; i < limit && i + 16 <= avail; i += 16)
+    {
+      uint32_t mask = (uint32_t)_mm_movemask_epi8(
+          _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), needle));
+      if (!mask)
+        continue;
+
+      if (wholeLanes)
+      {
+        if (size >= 2)
+          mask &= mask >> 1;
+        if (size >= 4)
+          mask &= mask >> 2;
+        if (size >= 8)
+          mask &= mask >> 4;
+      }
+      mask &= laneMask;
+
+      while (mask)
+      {
+        size_t pos = i + ScanCtz(mask);
+        mask &= mask - 1;
+        if (pos >= limit)
+          break;
+        if (wholeLanes || ScanBytesEqual(data + pos, pattern, size))
+          out[found++] = (uint32_t)(pos / align);
+      }
+    }
+  }
+#endif
+
+  i = (i + align - 1) / align * align;
+  for (; i < limit; i += align)
+  {
+    if (data[i] == pattern[0] && ScanBytesEqual(data + i, pattern, size))
+      out[found++] = (uint32_t)(i / align);
+  }
+  return found;
+}
+
+static size_t ScanNextDifference(const uint8_t* a, const uint8_t* b, size_t from, size_t end)
+{
+  size_t i = from;
+#ifdef SCAN_HAVE_SSE2
+  for (; i + 16 <= end; i += 16)
+  {
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i))));
+    if (mask != 0xFFFF)
+      return i + ScanCtz(~mask & 0xFFFF);
+  }
+#endif
+  for (; i < end; i++)
+  {
+    if (a[i] != b[i])
+      return i;
+  }
+  return end;
+}
+
+static bool ScanIteratorNext(ScanIterator* it, const ScanJob* job, uint32_t* outIndex,
+                             const uint8_t** outPrevious)
+{
+  const ScanBlock* block = it->block;
+  if (it->ordinal >= block->count)
+    return false;
+
+  uint32_t index;
+  if (block->encoding == SCAN_BLOCK_ALL)
+  {
+    index = (uint32_t)it->ordinal;
+  }
+  else if (block->encoding == SCAN_BLOCK_BITMAP)
+  {
+    size_t bit = it->position;
+    while (!(block->encoded[bit >> 3] & (1 << (bit & 7))))
+    {
+      if ((bit & 7) == 0 && block->encoded[bit >> 3] == 0)
+        bit += 8;
+      else
+        bit++;
+    }
+    index = (uint32_t)bit;
+    it->position = bit + 1;
+  }
+  else
+  {
+    uint32_t gap = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+    do
+    {
+      byte = block->encoded[it->position++];
+      gap |= (uint32_t)(byte & 0x7F) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    index = it->index + gap;
+    it->index = index;
+  }
+
+  if (outPrevious && job)
+  {
+    if (block->encoding == SCAN_BLOCK_ALL)
+      *outPrevious = block->values + (size_t)index * job->alignment;
+    else if (block->values)
+      *outPrevious = block->values + it->ordinal * job->valueSize;
+    else
+      *outPrevious = job->uniformPrevious;
+  }
+
+  it->ordinal++;
+  *outIndex = index;
+  return true;
+}
+
+static bool ScanEncodeBlock(const ScanJob* job, ScanBlock& out, const uint32_t* indices,
+                            size_t found, const uint8_t* current)
+{
+  if (found == 0)
+    return true;
+
+  size_t bitmapSize = indices[found - 1] / 8 + 1;
+  size_t deltaSize = 0;
+  uint32_t last = 0;
+  for (size_t i = 0; i < found; i++)
+  {
+    uint32_t gap = indices[i] - last;
+    last = indices[i];
+    do
+    {
+      deltaSize++;
+      gap >>= 7;
+    } while (gap);
+  }
+
+  out.count = (uint32_t)found;
+  if (deltaSize < bitmapSize)
+  {
+    out.encoding = SCAN_BLOCK_DELTA;
+    out.encodedSize = deltaSize;
+    out.encoded = (uint8_t*)platformAlloc(deltaSize);
+    if (!out.encoded)
+      return false;
+
+    uint8_t* p = out.encoded;
+    last = 0;
+    for (size_t i = 0; i < found; i++)
+    {
+      uint32_t gap = indices[i] - last;
+      last = indices[i];
+      while (gap >= 0x80)
+      {
+        *p++ = (uint8_t)(gap | 0x80);
+        gap >>= 7;
+      }
+      *p++ = (uint8_t)gap;
+    }
+  }
+  else
+  {
+    out.encoding = SCAN_BLOCK_BITMAP;
+    out.encodedSize = bitmapSize;
+    out.encoded = (uint8_t*)platformAlloc(bitmapSize);
+    if (!out.encoded)
+      return false;
+    memSet(out.encoded, 0, bitmapSize);
+    for (size_t i = 0; i < found; i++)
+      out.encoded[indices[i] >> 3] |= (uint8_t)(1 << (indices[i] & 7));
+  }
+
+  if (job->storeValues)
+  {
+    out.valuesSize = found * job->valueSize;
+    out.values = (uint8_t*)platformAlloc(out.valuesSize);
+    if (!out.values)
+      return false;
+    for (size_t i = 0; i < found; i++)
+      memCopy(out.values + i * job->valueSize, current + (size_t)indices[i] * job->alignment, job->valueSize);
+  }
+  return true;
+}
+
+static bool ScanMatches(const ScanJob* job, const uint8_t* current, const uint8_t* previous)
+{
+  switch (job->compare)
+  {
+  case SCAN_EXACT:
+    return ScanEquals(job->value, job->valueSize, current);
+  case SCAN_CHANGED:
+    return !ScanBytesEqual(current, previous, job->valueSize);
+  case SCAN_UNCHANGED:
+    return ScanBytesEqual(current, previous, job->valueSize);
+  case SCAN_INCREASED:
+    return ScanOrder(job->type, job->valueSize, current, previous) > 0;
+  case SCAN_DECREASED:
+    return ScanOrder(job->type, job->valueSize, current, previous) < 0;
+  default:
+    return true;
+  }
+}
+
+static void ScanProcessBlock(ScanJob* job, ScanWorker* worker, size_t blockIndex)
+{
+  const ScanBlock& in = job->input[blockIndex];
+  ScanBlock& out = job->output[blockIndex];
+  memSet(&out, 0, sizeof(ScanBlock));
+  out.base = in.base;
+  out.length = in.length;
+  out.tail = in.tail;
+
+  size_t avail = (size_t)in.length + in.tail;
+  const uint8_t* current;
+  if (job->target->data)
+  {
+    current = job->target->data + in.base;
+  }
+  else
+  {
+    job->target->process->snapshot(in.base, worker->buffer, avail);
+    current = worker->buffer;
+  }
+
+  size_t align = job->alignment;
+  size_t size = job->valueSize;
+  size_t slots = avail >= size ? (avail - size) / align + 1 : 0;
+  size_t startLimit = (in.length + align - 1) / align;
+  if (slots > startLimit)
+    slots = startLimit;
+
+  uint32_t* indices = worker->indices;
+  size_t found = 0;
+
+  if (job->first)
+  {
+    if (job->compare == SCAN_UNKNOWN)
+    {
+      if (slots == 0)
+        return;
+      out.encoding = SCAN_BLOCK_ALL;
+      out.count = (uint32_t)slots;
+      out.valuesSize = avail;
+      out.values = (uint8_t*)platformAlloc(avail);
+      if (!out.values)
+      {
+        job->failed = 1;
+        return;
+      }
+      memCopy(out.values, current, avail);
+      return;
+    }
+
+    if (ScanIsReal(job->type))
+    {
+      for (size_t s = 0; s < slots; s++)
+      {
+        if (ScanEquals(job->value, size, current + s * align))
+          indices[found++] = (uint32_t)s;
+      }
+    }
+    else
+    {
+      found = ScanFindPattern(current, avail, slots, align, job->value->bytes, size, indices);
+    }
+  }
+  else if (in.encoding == SCAN_BLOCK_ALL &&
+           (job->compare == SCAN_CHANGED || job->compare == SCAN_UNCHANGED))
+  {
+    // After an unknown first scan most of memory is unchanged, so walk the
+    // differences between the two snapshots instead of every slot.
+    bool wantChanged = (job->compare == SCAN_CHANGED);
+    size_t nextDiff = ScanNextDifference(current, in.values, 0, avail);
+    size_t s = 0;
+    while (s < in.count)
+    {
+      size_t start = s * align;
+      if (nextDiff < start)
+        nextDiff = ScanNextDifference(current, in.values, start, avail);
+
+      bool changed = nextDiff < start + size;
+      if (changed == wantChanged)
+        indices[found++] = (uint32_t)s;
+
+      if (wantChanged && !changed)
+      {
+        if (nextDiff >= avail)
+          break;
+        size_t first = nextDiff + 1 > size ? nextDiff + 1 - size : 0;
+        size_t jump = (first + align - 1) / align;
+        if (jump > s + 1)
+        {
+          s = jump;
+          continue;
+        }
+      }
+      s++;
+    }
+  }
+  else
+  {
+    ScanIterator it;
+    it.block = &in;
+    it.position = 0;
+    it.ordinal = 0;
+    it.index = 0;
+
+    uint32_t index;
+    const uint8_t* previous = nullptr;
+    while (ScanIteratorNext(&it, job, &index, &previous))
+    {
+      if (ScanMatches(job, current + (size_t)index * align, previous))
+        indices[found++] = index;
+    }
+  }
+
+  if (!ScanEncodeBlock(job, out, indices, found, current))
+    job->failed = 1;
+}
+
+static void RunScanJob(ScanWorker* worker)
+{
+  ScanJob* job = worker->job;
+  for (;;)
+  {
+#ifdef _WIN32
+    size_t index = (size_t)(InterlockedIncrement(&job->nextBlock) - 1);
+#else
+    size_t index = (size_t)__atomic_fetch_add(&job->nextBlock, 1, __ATOMIC_RELAXED);
+#endif
+    if (index >= job->blockCount)
+      break;
+    ScanProcessBlock(job, worker, index);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI RunScanWorker(LPVOID param)
+{
+  RunScanJob((ScanWorker*)param);
+  return 0;
+}
+#else
+static void* RunScanWorker(void* param)
+{
+  RunScanJob((ScanWorker*)param);
+  return nullptr;
+}
+#endif
+
+static size_t ScanWorkerCount(size_t blockCount)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t cpuCount = info.dwNumberOfProcessors;
+#else
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t cpuCount = online > 0 ? (size_t)online : 1;
+#endif
+  if (cpuCount > SCAN_MAX_THREADS)
+    cpuCount = SCAN_MAX_THREADS;
+  if (cpuCount > blockCount)
+    cpuCount = blockCount;
+  return cpuCount > 0 ? cpuCount : 1;
+}
+
+ValueScanner::ValueScanner()
+  : valueSize(0),
+    alignment(1),
+    candidateCount(0),
+    scanCount(0),
+    uniformValues(false)
+{
+  memSet(&value, 0, sizeof(value));
+  memSet(uniformValue, 0, sizeof(uniformValue));
+}
+
+ValueScanner::~ValueScanner()
+{
+  reset();
+}
+
+void ValueScanner::freeBlock(ScanBlock& block)
+{
+  if (block.encoded)
+    platformFree(block.encoded, block.encodedSize);
+  if (block.values)
+    platformFree(block.values, block.valuesSize);
+  block.encoded = nullptr;
+  block.values = nullptr;
+}
+
+void ValueScanner::reset()
+{
+  for (size_t i = 0; i < blocks.size(); i++)
+    freeBlock(blocks[i]);
+  blocks.clear();
+  candidateCount = 0;
+  scanCount = 0;
+  uniformValues = false;
+}
+
+size_t ValueScanner::getMemoryUsage() const
+{
+  size_t total = blocks.size() * sizeof(ScanBlock);
+  for (size_t i = 0; i < blocks.size(); i++)
+    total += blocks[i].encodedSize + blocks[i].valuesSize;
+  return total;
+}
+
+bool ValueScanner::firstScan(const ScanTarget& target, const ScanValue& scanValue, ScanCompare compare,
+                             size_t requestedAlignment)
+{
+  reset();
+
+  if (compare != SCAN_EXACT && compare != SCAN_UNKNOWN)
+    return false;
+  if (compare == SCAN_UNKNOWN && scanValue.type == SCAN_TYPE_STRING)
+    return false;
+
+  size_t size = scanValue.type == SCAN_TYPE_STRING ? scanValue.size : ScanTypeSize(scanValue.type);
+  if (size == 0 || size > SCAN_MAX_STRING)
+    return false;
+
+  size_t align = requestedAlignment ? requestedAlignment
+                                    : (scanValue.type == SCAN_TYPE_STRING ? 1 : size);
+  if (align > 16 || (align & (align - 1)) != 0)
+    align = 1;
+
+  value = scanValue;
+  valueSize = size;
+  alignment = align;
+
+  Vector<ScanBlock> ranges;
+  Vector<MemoryRegion> fileRegion;
+  const Vector<MemoryRegion>* regions = &fileRegion;
+  if (target.process)
+  {
+    regions = &target.process->getRegions();
+  }
+  else
+  {
+    MemoryRegion whole;
+    memSet(&whole, 0, sizeof(whole));
+    whole.size = (size_t)target.size;
+    whole.protection = MEMORY_PROT_READ | MEMORY_PROT_WRITE;
+    fileRegion.push_back(whole);
+  }
+
+  for (size_t r = 0; r < regions->size(); r++)
+  {
+    const MemoryRegion& region = (*regions)[r];
+    if (target.writableOnly && region.protection != 0 && !(region.protection & MEMORY_PROT_WRITE))
+      continue;
+
+    uint64_t start = (region.bufferOffset + align - 1) / align * align;
+    uint64_t end = region.bufferOffset + region.size;
+    for (uint64_t base = start; base + size <= end; base += SCAN_BLOCK_SIZE)
+    {
+      ScanBlock block;
+      memSet(&block, 0, sizeof(block));
+      block.base = base;
+      block.length = (uint32_t)(end - base < SCAN_BLOCK_SIZE ? end - base : SCAN_BLOCK_SIZE);
+      uint64_t rest = end - (base + block.length);
+      block.tail = (uint32_t)(rest < size - 1 ? rest : size - 1);
+      ranges.push_back(block);
+    }
+  }
+
+  if (ranges.empty())
+    return false;
+
+  return run(target, &ranges[0], ranges.size(), compare, &value, true);
+}
+
+bool ValueScanner::nextScan(const ScanTarget& target, ScanCompare compare, const ScanValue* compareValue)
+{
+  if (scanCount == 0 || compare == SCAN_UNKNOWN)
+    return false;
+
+  if (compare == SCAN_EXACT)
+  {
+    if (!compareValue || compareValue->type != value.type)
+      return false;
+    if (value.type == SCAN_TYPE_STRING && compareValue->size != valueSize)
+      return false;
+  }
+
+  if (value.type == SCAN_TYPE_STRING && (compare == SCAN_INCREASED || compare == SCAN_DECREASED))
+    return false;
+
+  if (blocks.empty())
+  {
+    scanCount++;
+    return true;
+  }
+
+  return run(target, &blocks[0], blocks.size(), compare, compareValue, false);
+}
+
+bool ValueScanner::run(const ScanTarget& target, ScanBlock* input, size_t count, ScanCompare compare,
+                       const ScanValue* compareValue, bool first)
+{
+  ScanBlock* output = (ScanBlock*)platformAlloc(count * sizeof(ScanBlock));
+  if (!output)
+    return false;
+
+  ScanJob job;
+  job.target = &target;
+  job.input = input;
+  job.output = output;
+  job.blockCount = count;
+  job.nextBlock = 0;
+  job.compare = compare;
+  job.value = compareValue;
+  job.type = value.type;
+  job.valueSize = valueSize;
+  job.alignment = alignment;
+  job.uniformPrevious = uniformValues ? uniformValue : nullptr;
+  job.first = first;
+  job.failed = 0;
+
+  // A candidate that matched an exact integer or string value holds exactly
+  // that value, so there is nothing to remember per candidate.
+  bool exactBytes = compare == SCAN_EXACT && !ScanIsReal(value.type);
+  bool keepsUniform = compare == SCAN_UNCHANGED && !first && uniformValues;
+  job.storeValues = !(exactBytes || keepsUniform);
+
+  size_t workerCount = ScanWorkerCount(count);
+  ScanWorker workers[SCAN_MAX_THREADS];
+  bool ok = true;
+  for (size_t i = 0; i < workerCount; i++)
+  {
+    workers[i].job = &job;
+    workers[i].started = false;
+    workers[i].buffer = (uint8_t*)platformAlloc(SCAN_BLOCK_SIZE + SCAN_MAX_STRING);
+    workers[i].indices = (uint32_t*)platformAlloc(SCAN_BLOCK_SIZE * sizeof(uint32_t));
+    if (!workers[i].buffer || !workers[i].indices)
+      ok = false;
+  }
+
+  if (ok)
+  {
+    for (size_t i = 1; i < workerCount; i++)
+    {
+#ifdef _WIN32
+      workers[i].thread = CreateThread(nullptr, 0, RunScanWorker, &workers[i], 0, nullptr);
+      workers[i].started = workers[i].thread != nullptr;
+#else
+      workers[i].started = pthread_create(&workers[i].thread, nullptr, RunScanWorker, &workers[i]) == 0;
+#endif
+    }
+
+    RunScanJob(&workers[0]);
+
+    for (size_t i = 1; i < workerCount; i++)
+    {
+      if (!workers[i].started)
+        continue;
+#ifdef _WIN32
+      WaitForSingleObject(workers[i].thread, INFINITE);
+      CloseHandle(workers[i].thread);
+#else
+      pthread_join(workers[i].thread, nullptr);
+#endif
+    }
+  }
+
+  for (size_t i = 0; i < workerCount; i++)
+  {
+    platformFree(workers[i].buffer, SCAN_BLOCK_SIZE + SCAN_MAX_STRING);
+    platformFree(workers[i].indices, SCAN_BLOCK_SIZE * sizeof(uint32_t));
+  }
+
+  // An allocation failure in any block fails the whole scan and leaves the
+  // previous candidates untouched.
+  if (ok && job.failed)
+  {
+    for (size_t i = 0; i < count; i++)
+      freeBlock(output[i]);
+    ok = false;
+  }
+
+  if (!ok)
+  {
+    platformFree(output, count * sizeof(ScanBlock));
+    return false;
+  }
+
+  if (!first)
+  {
+    for (size_t i = 0; i < blocks.size(); i++)
+      freeBlock(blocks[i]);
+    blocks.clear();
+  }
+
+  candidateCount = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (output[i].count == 0)
+    {
+      freeBlock(output[i]);
+      continue;
+    }
+    candidateCount += output[i].count;
+    blocks.push_back(output[i]);
+  }
+  platformFree(output, count * sizeof(ScanBlock));
+
+  if (exactBytes)
+  {
+    memCopy(uniformValue, compareValue->bytes, valueSize);
+    uniformValues = true;
+  }
+  else if (!keepsUniform)
+  {
+    uniformValues = false;
+  }
+
+  if (compare == SCAN_EXACT)
+    value = *compareValue;
+
+  scanCount++;
+  return true;
+}
+
+size_t ValueScanner::findBlock(uint64_t offset) const
+{
+  size_t lo = 0;
+  size_t hi = blocks.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (blocks[mid].base + blocks[mid].length <= offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+bool ValueScanner::findNextCandidate(uint64_t from, uint64_t* outOffset) const
+{
+  for (size_t b = findBlock(from); b < blocks.size(); b++)
+  {
+    const ScanBlock& block = blocks[b];
+    ScanIterator it;
+    it.block = &block;
+    it.position = 0;
+    it.ordinal = 0;
+    it.index = 0;
+
+    uint32_t index;
+    while (ScanIteratorNext(&it, nullptr, &index, nullptr))
+    {
+      uint64_t offset = block.base + (uint64_t)index * alignment;
+      if (offset >= from)
+      {
+        *outOffset = offset;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+size_t ValueScanner::getCandidateFlags(uint64_t offset, size_t length, uint8_t* outFlags) const
+{
+  memSet(outFlags, 0, length);
+
+  uint64_t end = offset + length;
+  uint64_t from = offset >= valueSize ? offset - (valueSize - 1) : 0;
+  size_t flagged = 0;
+
+  for (size_t b = findBlock(from); b < blocks.size() && blocks[b].base < end; b++)
+  {
+    const ScanBlock& block = blocks[b];
+    if (block.encoding == SCAN_BLOCK_ALL)
+      continue;
+
+    ScanIterator it;
+    it.block = &block;
+    it.position = 0;
+    it.ordinal = 0;
+    it.index = 0;
+
+    uint32_t index;
+    while (ScanIteratorNext(&it, nullptr, &index, nullptr))
+    {
+      uint64_t start = block.base + (uint64_t)index * alignment;
+      if (start >= end)
+        break;
+      if (start + valueSize <= offset)
+        continue;
+
+      uint64_t a = start > offset ? start : offset;
+      uint64_t z = start + valueSize < end ? start + valueSize : end;
+      for (uint64_t pos = a; pos < z; pos++)
+        outFlags[pos - offset] = 1;
+      flagged++;
+    }
+  }
+  return flagged;
+}
@@ -0,0 +1,1109 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#include "x86decoder.h"
+
+#define X86_F_MODRM 0x0001
+#define X86_F_IMM8 0x0002
+#define X86_F_IMM16 0x0004
+#define X86_F_IMMZ 0x0008
+#define X86_F_IMMV 0x0010
+#define X86_F_MOFFS 0x0020
+#define X86_F_REL 0x0040
+#define X86_F_FAR 0x0080
+#define X86_F_TEST 0x0100
+#define X86_F_INV64 0x0200
+#define X86_F_PREFIX 0x0400
+#define X86_F_INVALID 0x0800
+
+#define X86_FAST_SLOW 0xFF
+#define X86_FAST_MODRM 0x80
+#define X86_FAST_SIB 0x40
+#define X86_FAST_SIB_DISP 0x20
+
+struct X86NameEntry
+{
+  uint8_t opcode;
+  const char* names[4];
+};
+
+struct X86SweepJob
+{
+  const uint8_t* code;
+  size_t length;
+  X86Mode mode;
+  uint8_t* bits;
+  size_t* exits;
+  size_t chunkCount;
+  volatile long nextChunk;
+};
+
+struct X86SweepWorker
+{
+  X86SweepJob* job;
+#ifdef _WIN32
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+  bool started;
+};
+
+#define X86_SSE(op, name) { op, { name "ps", name "pd", name "ss", name "sd" } }
+#define X86_PACKED(op, name) { op, { name "ps", name "pd", nullptr, nullptr } }
+#define X86_SIMD(op, name) { op, { name, name, nullptr, nullptr } }
+
+static const char* const g_X86PrimaryNames[256] = {
+  "add", "add", "add", "add", "add", "add", "push", "pop",
+  "or", "or", "or", "or", "or", "or", "push", nullptr,
+  "adc", "adc", "adc", "adc", "adc", "adc", "push", "pop",
+  "sbb", "sbb", "sbb", "sbb", "sbb", "sbb", "push", "pop",
+  "and", "and", "and", "and", "and", "and", nullptr, "daa",
+  "sub", "sub", "sub", "sub", "sub", "sub", nullptr, "das",
+  "xor", "xor", "xor", "xor", "xor", "xor", nullptr, "aaa",
+  "cmp", "cmp", "cmp", "cmp", "cmp", "cmp", nullptr, "aas",
+  "inc", "inc", "inc", "inc", "inc", "inc", "inc", "inc",
+  "dec", "dec", "dec", "dec", "dec", "dec", "dec", "dec",
+  "push", "push", "push", "push", "push", "push", "push", "push",
+  "pop", "pop", "pop", "pop", "pop", "pop", "pop", "pop",
+  "pusha", "popa", "bound", "arpl", nullptr, nullptr, nullptr, nullptr,
+  "push", "imul", "push", "imul", "insb", "ins", "outsb", "outs",
+  "jo", "jno", "jb", "jae", "je", "jne", "jbe", "ja",
+  "js", "jns", "jp", "jnp", "jl", "jge", "jle", "jg",
+  nullptr, nullptr, nullptr, nullptr, "test", "test", "xchg", "xchg",
+  "mov", "mov", "mov", "mov", "mov", "lea", "mov", "pop",
+  "nop", "xchg", "xchg", "xchg", "xchg", "xchg", "xchg", "xchg",
+  "cwde", "cdq", "call far", "wait", "pushf", "popf", "sahf", "lahf",
+  "mov", "mov", "mov", "mov", "movsb", "movs", "cmpsb", "cmps",
+  "test", "test", "stosb", "stos", "lodsb", "lods", "scasb", "scas",
+  "mov", "mov", "mov", "mov", "mov", "mov", "mov", "mov",
+  "mov", "mov", "mov", "mov", "mov", "mov", "mov", "mov",
+  nullptr, nullptr, "ret", "ret", "les", "lds", "mov", "mov",
+  "enter", "leave", "retf", "retf", "int3", "int", "into", "iret",
+  nullptr, nullptr, nullptr, nullptr, "aam", "aad", "salc", "xlat",
+  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  "loopne", "loope", "loop", "jecxz", "in", "in", "out", "out",
+  "call", "jmp", "jmp far", "jmp", "in", "in", "out", "out",
+  nullptr, "int1", nullptr, nullptr, "hlt", "cmc", nullptr, nullptr,
+  "clc", "stc", "cli", "sti", "cld", "std", nullptr, nullptr };
+
+static const char* const g_X86Group1[8] = { "add", "or", "adc", "sbb", "and", "sub", "xor", "cmp" };
+static const char* const g_X86Group2[8] = { "rol", "ror", "rcl", "rcr", "shl", "shr", "sal", "sar" };
+static const char* const g_X86Group3[8] = { "test", "test", "not", "neg", "mul", "imul", "div", "idiv" };
+static const char* const g_X86Group5[8] = { "inc", "dec", "call", "call far", "jmp", "jmp far", "push", nullptr };
+static const char* const g_X86Group6[8] = { "sldt", "str", "lldt", "ltr", "verr", "verw", nullptr, nullptr };
+static const char* const g_X86Group7[8] = { "sgdt", "sidt", "lgdt", "lidt", "smsw", nullptr, "lmsw", "invlpg" };
+static const char* const g_X86Group15[8] = { "fxsave", "fxrstor", "ldmxcsr", "stmxcsr", "xsave", "xrstor", "xsaveopt", "clflush" };
+static const char* const g_X86Conditions[16] = { "o", "no", "b", "ae", "e", "ne", "be", "a", "s", "ns", "p", "np", "l", "ge", "le", "g" };
+
+static const char* const g_X86Float[8][8] = {
+  { "fadd", "fmul", "fcom", "fcomp", "fsub", "fsubr", "fdiv", "fdivr" },
+  { "fld", nullptr, "fst", "fstp", "fldenv", "fldcw", "fnstenv", "fnstcw" },
+  { "fiadd", "fimul", "ficom", "ficomp", "fisub", "fisubr", "fidiv", "fidivr" },
+  { "fild", "fisttp", "fist", "fistp", nullptr, "fld", nullptr, "fstp" },
+  { "fadd", "fmul", "fcom", "fcomp", "fsub", "fsubr", "fdiv", "fdivr" },
+  { "fld", "fisttp", "fst", "fstp", "frstor", nullptr, "fnsave", "fnstsw" },
+  { "fiadd", "fimul", "ficom", "ficomp", "fisub", "fisubr", "fidiv", "fidivr" },
+  { "fild", "fisttp", "fist", "fistp", "fbld", "fild", "fbstp", "fistp" } };
+
+static const X86NameEntry g_X86SecondaryEntries[] = {
+  { 0x05, { "syscall" } }, { 0x06, { "clts" } }, { 0x07, { "sysret" } }, { 0x08, { "invd" } },
+  { 0x09, { "wbinvd" } }, { 0x0B, { "ud2" } }, { 0x0D, { "prefetchw" } }, { 0x0E, { "femms" } },
+  { 0x10, { "movups", "movupd", "movss", "movsd" } }, { 0x11, { "movups", "movupd", "movss", "movsd" } },
+  { 0x12, { "movlps", "movlpd", "movsldup", "movddup" } }, X86_PACKED(0x13, "movl"),
+  X86_PACKED(0x14, "unpckl"), X86_PACKED(0x15, "unpckh"),
+  { 0x16, { "movhps", "movhpd", "movshdup", nullptr } }, X86_PACKED(0x17, "movh"),
+  { 0x18, { "prefetch" } }, { 0x19, { "nop" } }, { 0x1A, { "nop" } }, { 0x1B, { "nop" } },
+  { 0x1C, { "nop" } }, { 0x1D, { "nop" } }, { 0x1E, { "nop" } }, { 0x1F, { "nop" } },
+  { 0x20, { "mov" } }, { 0x21, { "mov" } }, { 0x22, { "mov" } }, { 0x23, { "mov" } },
+  X86_PACKED(0x28, "mova"), X86_PACKED(0x29, "mova"),
+  { 0x2A, { "cvtpi2ps", "cvtpi2pd", "cvtsi2ss", "cvtsi2sd" } }, X86_PACKED(0x2B, "movnt"),
+  { 0x2C, { "cvttps2pi", "cvttpd2pi", "cvttss2si", "cvttsd2si" } },
+  { 0x2D, { "cvtps2pi", "cvtpd2pi", "cvtss2si", "cvtsd2si" } },
+  { 0x2E, { "ucomiss", "ucomisd" } }, { 0x2F, { "comiss", "comisd" } },
+  { 0x30, { "wrmsr" } }, { 0x31, { "rdtsc" } }, { 0x32, { "rdmsr" } }, { 0x33, { "rdpmc" } },
+  { 0x34, { "sysenter" } }, { 0x35, { "sysexit" } }, { 0x37, { "getsec" } },
+  { 0x50, { "movmskps", "movmskpd" } }, X86_SSE(0x51, "sqrt"),
+  { 0x52, { "rsqrtps", nullptr, "rsqrtss" } }, { 0x53, { "rcpps", nullptr, "rcpss" } },
+  X86_PACKED(0x54, "and"), X86_PACKED(0x55, "andn"), X86_PACKED(0x56, "or"), X86_PACKED(0x57, "xor"),
+  X86_SSE(0x58, "add"), X86_SSE(0x59, "mul"),
+  { 0x5A, { "cvtps2pd", "cvtpd2ps", "cvtss2sd", "cvtsd2ss" } },
+  { 0x5B, { "cvtdq2ps", "cvtps2dq", "cvttps2dq" } },
+  X86_SSE(0x5C, "sub"), X86_SSE(0x5D, "min"), X86_SSE(0x5E, "div"), X86_SSE(0x5F, "max"),
+  X86_SIMD(0x60, "punpcklbw"), X86_SIMD(0x61, "punpcklwd"), X86_SIMD(0x62, "punpckldq"), X86_SIMD(0x63, "packsswb"),
+  X86_SIMD(0x64, "pcmpgtb"), X86_SIMD(0x65, "pcmpgtw"), X86_SIMD(0x66, "pcmpgtd"), X86_SIMD(0x67, "packuswb"),
+  X86_SIMD(0x68, "punpckhbw"), X86_SIMD(0x69, "punpckhwd"), X86_SIMD(0x6A, "punpckhdq"), X86_SIMD(0x6B, "packssdw"),
+  { 0x6C, { nullptr, "punpcklqdq" } }, { 0x6D, { nullptr, "punpckhqdq" } },
+  X86_SIMD(0x6E, "movd"), { 0x6F, { "movq", "movdqa", "movdqu" } },
+  { 0x70, { "pshufw", "pshufd", "pshufhw", "pshuflw" } },
+  X86_SIMD(0x74, "pcmpeqb"), X86_SIMD(0x75, "pcmpeqw"), X86_SIMD(0x76, "pcmpeqd"), { 0x77, { "emms" } },
+  { 0x7C, { nullptr, "haddpd", nullptr, "haddps" } }, { 0x7D, { nullptr, "hsubpd", nullptr, "hsubps" } },
+  { 0x7E, { "movd", "movd", "movq" } }, { 0x7F, { "movq", "movdqa", "movdqu" } },
+  { 0xA2, { "cpuid" } }, { 0xA3, { "bt" } }, { 0xA4, { "shld" } }, { 0xA5, { "shld" } },
+  { 0xAA, { "rsm" } }, { 0xAB, { "bts" } }, { 0xAC, { "shrd" } }, { 0xAD, { "shrd" } }, { 0xAF, { "imul" } },
+  { 0xB0, { "cmpxchg" } }, { 0xB1, { "cmpxchg" } }, { 0xB2, { "lss" } }, { 0xB3, { "btr" } },
+  { 0xB4, { "lfs" } }, { 0xB5, { "lgs" } }, { 0xB6, { "movzx" } }, { 0xB7, { "movzx" } },
+  { 0xB8, { nullptr, nullptr, "popcnt" } }, { 0xB9, { "ud1" } }, { 0xBB, { "btc" } },
+  { 0xBC, { "bsf", nullptr, "tzcnt" } }, { 0xBD, { "bsr", nullptr, "lzcnt" } },
+  { 0xBE, { "movsx" } }, { 0xBF, { "movsx" } }, { 0xC0, { "xadd" } }, { 0xC1, { "xadd" } },
+  { 0xC2, { "cmpps", "cmppd", "cmpss", "cmpsd" } }, { 0xC3, { "movnti" } },
+  X86_SIMD(0xC4, "pinsrw"), X86_SIMD(0xC5, "pextrw"), X86_PACKED(0xC6, "shuf"),
+  X86_SIMD(0xD1, "psrlw"), X86_SIMD(0xD2, "psrld"), X86_SIMD(0xD3, "psrlq"), X86_SIMD(0xD4, "paddq"),
+  X86_SIMD(0xD5, "pmullw"), { 0xD6, { nullptr, "movq" } }, X86_SIMD(0xD7, "pmovmskb"),
+  X86_SIMD(0xD8, "psubusb"), X86_SIMD(0xD9, "psubusw"), X86_SIMD(0xDA, "pminub"), X86_SIMD(0xDB, "pand"),
+  X86_SIMD(0xDC, "paddusb"), X86_SIMD(0xDD, "paddusw"), X86_SIMD(0xDE, "pmaxub"), X86_SIMD(0xDF, "pandn"),
+  X86_SIMD(0xE0, "pavgb"), X86_SIMD(0xE1, "psraw"), X86_SIMD(0xE2, "psrad"), X86_SIMD(0xE3, "pavgw"),
+  X86_SIMD(0xE4, "pmulhuw"), X86_SIMD(0xE5, "pmulhw"),
+  { 0xE6, { nullptr, "cvttpd2dq", "cvtdq2pd", "cvtpd2dq" } }, { 0xE7, { "movntq", "movntdq" } },
+  X86_SIMD(0xE8, "psubsb"), X86_SIMD(0xE9, "psubsw"), X86_SIMD(0xEA, "pminsw"), X86_SIMD(0xEB, "por"),
+  X86_SIMD(0xEC, "paddsb"), X86_SIMD(0xED, "paddsw"), X86_SIMD(0xEE, "pmaxsw"), X86_SIMD(0xEF, "pxor"),
+  { 0xF0, { nullptr, nullptr, nullptr, "lddqu" } }, X86_SIMD(0xF1, "psllw"), X86_SIMD(0xF2, "pslld"),
+  X86_SIMD(0xF3, "psllq"), X86_SIMD(0xF4, "pmuludq"), X86_SIMD(0xF5, "pmaddwd"), X86_SIMD(0xF6, "psadbw"),
+  { 0xF7, { "maskmovq", "maskmovdqu" } }, X86_SIMD(0xF8, "psubb"), X86_SIMD(0xF9, "psubw"),
+  X86_SIMD(0xFA, "psubd"), X86_SIMD(0xFB, "psubq"), X86_SIMD(0xFC, "paddb"), X86_SIMD(0xFD, "paddw"),
+  X86_SIMD(0xFE, "paddd"), { 0xFF, { "ud0" } } };
+
+static const X86NameEntry g_X86Map38Entries[] = {
+  X86_SIMD(0x00, "pshufb"), X86_SIMD(0x04, "pmaddubsw"), X86_SIMD(0x0B, "pmulhrsw"),
+  { 0x17, { nullptr, "ptest" } }, { 0x29, { nullptr, "pcmpeqq" } }, { 0x37, { nullptr, "pcmpgtq" } },
+  { 0xDB, { nullptr, "aesimc" } }, { 0xDC, { nullptr, "aesenc" } }, { 0xDD, { nullptr, "aesenclast" } },
+  { 0xDE, { nullptr, "aesdec" } }, { 0xDF, { nullptr, "aesdeclast" } },
+  { 0xF0, { "movbe", "movbe", nullptr, "crc32" } }, { 0xF1, { "movbe", "movbe", nullptr, "crc32" } } };
+
+static const X86NameEntry g_X86Map3AEntries[] = {
+  { 0x08, { nullptr, "roundps" } }, { 0x09, { nullptr, "roundpd" } }, { 0x0A, { nullptr, "roundss" } },
+  { 0x0B, { nullptr, "roundsd" } }, X86_SIMD(0x0F, "palignr"), { 0x16, { nullptr, "pextrd" } },
+  { 0x22, { nullptr, "pinsrd" } }, { 0x44, { nullptr, "pclmulqdq" } }, { 0x63, { nullptr, "pcmpistri" } },
+  { 0xDF, { nullptr, "aeskeygenassist" } } };
+
+static const char* const g_X86Reg64[16] = {
+  "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15" };
+static const char* const g_X86Reg32[16] = {
+  "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d" };
+static const char* const g_X86Reg16[16] = {
+  "ax", "cx", "dx", "bx", "sp", "bp", "si", "di", "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w" };
+static const char* const g_X86Reg8[16] = {
+  "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil", "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b" };
+static const char* const g_X86Reg8Legacy[8] = { "al", "cl", "dl", "bl", "ah", "ch", "dh", "bh" };
+
+static uint16_t g_X86Primary[256];
+static uint16_t g_X86Secondary[256];
+static uint8_t g_X86FastShape[256];
+static uint8_t g_X86ModrmExtra[256];
+static const char* g_X86SecondaryNames[256][4];
+static const char* g_X86Map38Names[256][4];
+static const char* g_X86Map3ANames[256][4];
+static bool g_X86TablesBuilt = false;
+
+static void X86SetRange(uint16_t* table, int first, int last, uint16_t flags)
+{
+  for (int op = first; op <= last; op++)
+    table[op] = flags;
+}
+
+static void X86LoadNames(const char* (*names)[4], const X86NameEntry* entries, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    for (int slot = 0; slot < 4; slot++)
+      names[entries[i].opcode][slot] = entries[i].names[slot];
+  }
+}
+
+// The opcode tables only need the operand shapes that change the length:
+// whether a ModRM byte follows and which immediate is attached.
+static void X86BuildTables()
+{
+  if (g_X86TablesBuilt)
+    return;
+
+  uint16_t* t = g_X86Primary;
+  memSet(t, 0, sizeof(g_X86Primary));
+  for (int base = 0; base < 0x40; base += 8)
+  {
+    X86SetRange(t, base, base + 3, X86_F_MODRM);
+    t[base + 4] = X86_F_IMM8;
+    t[base + 5] = X86_F_IMMZ;
+  }
+  t[0x06] = t[0x07] = t[0x0E] = t[0x16] = t[0x17] = t[0x1E] = t[0x1F] = X86_F_INV64;
+  t[0x27] = t[0x2F] = t[0x37] = t[0x3F] = X86_F_INV64;
+  t[0x26] = t[0x2E] = t[0x36] = t[0x3E] = X86_F_PREFIX;
+  t[0x60] = t[0x61] = X86_F_INV64;
+  t[0x62] = X86_F_MODRM | X86_F_INV64;
+  t[0x63] = X86_F_MODRM;
+  X86SetRange(t, 0x64, 0x67, X86_F_PREFIX);
+  t[0x68] = X86_F_IMMZ;
+  t[0x69] = X86_F_MODRM | X86_F_IMMZ;
+  t[0x6A] = X86_F_IMM8;
+  t[0x6B] = X86_F_MODRM | X86_F_IMM8;
+  X86SetRange(t, 0x70, 0x7F, X86_F_IMM8 | X86_F_REL);
+  t[0x80] = X86_F_MODRM | X86_F_IMM8;
+  t[0x81] = X86_F_MODRM | X86_F_IMMZ;
+  t[0x82] = X86_F_MODRM | X86_F_IMM8 | X86_F_INV64;
+  t[0x83] = X86_F_MODRM | X86_F_IMM8;
+  X86SetRange(t, 0x84, 0x8F, X86_F_MODRM);
+  t[0x9A] = X86_F_FAR | X86_F_INV64;
+  X86SetRange(t, 0xA0, 0xA3, X86_F_MOFFS);
+  t[0xA8] = X86_F_IMM8;
+  t[0xA9] = X86_F_IMMZ;
+  X86SetRange(t, 0xB0, 0xB7, X86_F_IMM8);
+  X86SetRange(t, 0xB8, 0xBF, X86_F_IMMV);
+  t[0xC0] = t[0xC1] = X86_F_MODRM | X86_F_IMM8;
+  t[0xC2] = t[0xCA] = X86_F_IMM16;
+  t[0xC4] = t[0xC5] = X86_F_MODRM | X86_F_INV64;
+  t[0xC6] = X86_F_MODRM | X86_F_IMM8;
+  t[0xC7] = X86_F_MODRM | X86_F_IMMZ;
+  t[0xC8] = X86_F_IMM16 | X86_F_IMM8;
+  t[0xCD] = X86_F_IMM8;
+  t[0xCE] = X86_F_INV64;
+  X86SetRange(t, 0xD0, 0xD3, X86_F_MODRM);
+  t[0xD4] = t[0xD5] = X86_F_IMM8 | X86_F_INV64;
+  t[0xD6] = X86_F_INV64;
+  X86SetRange(t, 0xD8, 0xDF, X86_F_MODRM);
+  X86SetRange(t, 0xE0, 0xE3, X86_F_IMM8 | X86_F_REL);
+  X86SetRange(t, 0xE4, 0xE7, X86_F_IMM8);
+  t[0xE8] = t[0xE9] = X86_F_IMMZ | X86_F_REL;
+  t[0xEA] = X86_F_FAR | X86_F_INV64;
+  t[0xEB] = X86_F_IMM8 | X86_F_REL;
+  t[0xF0] = t[0xF2] = t[0xF3] = X86_F_PREFIX;
+  t[0xF6] = t[0xF7] = X86_F_MODRM | X86_F_TEST;
+  t[0xFE] = t[0xFF] = X86_F_MODRM;
+
+  t = g_X86Secondary;
+  X86SetRange(t, 0x00, 0xFF, X86_F_MODRM);
+  X86SetRange(t, 0x05, 0x09, 0);
+  t[0x0B] = t[0x0E] = 0;
+  X86SetRange(t, 0x30, 0x35, 0);
+  t[0x37] = t[0x77] = 0;
+  t[0xA0] = t[0xA1] = t[0xA2] = t[0xA8] = t[0xA9] = t[0xAA] = 0;
+  X86SetRange(t, 0xC8, 0xCF, 0);
+  t[0x04] = t[0x0A] = t[0x0C] = t[0x36] = t[0x39] = t[0xA6] = t[0xA7] = X86_F_INVALID;
+  X86SetRange(t, 0x24, 0x27, X86_F_INVALID);
+  X86SetRange(t, 0x3B, 0x3F, X86_F_INVALID);
+  t[0x7A] = t[0x7B] = X86_F_INVALID;
+  X86SetRange(t, 0x70, 0x73, X86_F_MODRM | X86_F_IMM8);
+  t[0xA4] = t[0xAC] = t[0xBA] = t[0xC2] = t[0xC4] = t[0xC5] = t[0xC6] = X86_F_MODRM | X86_F_IMM8;
+  X86SetRange(t, 0x80, 0x8F, X86_F_IMMZ | X86_F_REL);
+
+  // One-byte opcodes whose length in 32/64-bit mode is fixed by the opcode
+  // and ModRM alone; everything else takes the full decoder.
+  for (int op = 0; op < 256; op++)
+  {
+    uint16_t flags = g_X86Primary[op];
+    bool slow = (flags & (X86_F_PREFIX | X86_F_INV64 | X86_F_INVALID | X86_F_IMMV | X86_F_MOFFS | X86_F_FAR | X86_F_TEST)) ||
+                (op >= 0x40 && op <= 0x4F) || op == 0x0F || op == 0x62 || op == 0x8F || op == 0xC4 || op == 0xC5;
+    uint8_t immediate = (uint8_t)(((flags & X86_F_IMM8) ? 1 : 0) + ((flags & X86_F_IMM16) ? 2 : 0) + ((flags & X86_F_IMMZ) ? 4 : 0));
+    g_X86FastShape[op] = slow ? X86_FAST_SLOW : (uint8_t)(((flags & X86_F_MODRM) ? X86_FAST_MODRM : 0) | immediate);
+  }
+  for (int modrm = 0; modrm < 256; modrm++)
+  {
+    int mod = modrm >> 6;
+    int rm = modrm & 7;
+    uint8_t extra = mod == 1 ? 1 : mod == 2 ? 4 : (mod == 0 && rm == 5) ? 4 : 0;
+    if (mod != 3 && rm == 4)
+      extra = (uint8_t)(X86_FAST_SIB | (mod == 0 ? X86_FAST_SIB_DISP : extra));
+    g_X86ModrmExtra[modrm] = mod == 3 ? 0 : extra;
+  }
+
+  memSet(g_X86SecondaryNames, 0, sizeof(g_X86SecondaryNames));
+  memSet(g_X86Map38Names, 0, sizeof(g_X86Map38Names));
+  memSet(g_X86Map3ANames, 0, sizeof(g_X86Map3ANames));
+  X86LoadNames(g_X86SecondaryNames, g_X86SecondaryEntries, sizeof(g_X86SecondaryEntries) / sizeof(g_X86SecondaryEntries[0]));
+  X86LoadNames(g_X86Map38Names, g_X86Map38Entries, sizeof(g_X86Map38Entries) / sizeof(g_X86Map38Entries[0]));
+  X86LoadNames(g_X86Map3ANames, g_X86Map3AEntries, sizeof(g_X86Map3AEntries) / sizeof(g_X86Map3AEntries[0]));
+
+  g_X86TablesBuilt = true;
+}
+
+static uint8_t X86PrefixFromPp(uint8_t pp)
+{
+  static const uint8_t prefixes[4] = { 0, 0x66, 0xF3, 0xF2 };
+  return prefixes[pp & 3];
+}
+
+static X86Map X86MapFromSelect(uint8_t select)
+{
+  if (select == 1)
+    return X86_MAP_0F;
+  if (select == 2)
+    return X86_MAP_0F38;
+  if (select == 3)
+    return X86_MAP_0F3A;
+  return X86_MAP_OTHER;
+}
+
+// Decodes one instruction and returns its length, or 0 when the bytes are
+// not a valid encoding or run past available. The length-only instantiation
+// keeps everything in registers for the sweep; Detail also fills out.
+template <bool Detail>
+static size_t X86DecodeCore(const uint8_t* code, size_t available, uint64_t address, X86Mode mode, X86Instruction* out)
+{
+  size_t limit = available < X86_MAX_INSTRUCTION ? available : X86_MAX_INSTRUCTION;
+  bool is64 = mode == X86_MODE_64;
+  bool operandPrefix = false;
+  bool addressPrefix = false;
+  bool lock = false;
+  bool rep = false;
+  bool repne = false;
+  uint8_t rex = 0;
+  size_t p = 0;
+  uint8_t op = 0;
+
+  for (;;)
+  {
+    if (p >= limit)
+      return 0;
+    op = code[p];
+    if (g_X86Primary[op] & X86_F_PREFIX)
+    {
+      if (op == 0x66)
+        operandPrefix = true;
+      else if (op == 0x67)
+        addressPrefix = true;
+      else if (op == 0xF0)
+        lock = true;
+      else if (op == 0xF2)
+      {
+        repne = true;
+        rep = false;
+      }
+      else if (op == 0xF3)
+      {
+        rep = true;
+        repne = false;
+      }
+      // A REX byte only counts when it is the last prefix.
+      rex = 0;
+      p++;
+      continue;
+    }
+    if (is64 && (op & 0xF0) == 0x40)
+    {
+      rex = op;
+      p++;
+      continue;
+    }
+    break;
+  }
+
+  uint8_t mandatoryPrefix = rep ? 0xF3 : repne ? 0xF2 : operandPrefix ? 0x66 : 0;
+
+  int operandBits;
+  if (is64)
+    operandBits = (rex & 0x08) ? 64 : operandPrefix ? 16 : 32;
+  else
+    operandBits = (mode == X86_MODE_16) != operandPrefix ? 16 : 32;
+  int addressBits = is64 ? (addressPrefix ? 32 : 64) : ((mode == X86_MODE_16) != addressPrefix ? 16 : 32);
+
+  uint16_t flags = 0;
+  size_t immediateBytes = 0;
+  X86Encoding encoding = X86_ENCODING_LEGACY;
+  X86Map map = X86_MAP_PRIMARY;
+  uint8_t opcode = op;
+  p++;
+
+  // Outside 64-bit mode C4/C5/62 are LES/LDS/BOUND unless the next byte
+  // would be a register-form ModRM, which those instructions cannot take.
+  bool vexLike = (op == 0xC4 || op == 0xC5 || op == 0x62) && p < limit && (is64 || (code[p] & 0xC0) == 0xC0);
+  bool xop = op == 0x8F && p < limit && (code[p] & 0x1F) >= 8;
+
+  if (op == 0x0F)
+  {
+    if (p >= limit)
+      return 0;
+    uint8_t second = code[p++];
+    if (second == 0x38 || second == 0x3A)
+    {
+      if (p >= limit)
+        return 0;
+      map = second == 0x38 ? X86_MAP_0F38 : X86_MAP_0F3A;
+      opcode = code[p++];
+      flags = X86_F_MODRM | (second == 0x3A ? X86_F_IMM8 : 0);
+    }
+    else if (second == 0x0F)
+    {
+      map = X86_MAP_3DNOW;
+      flags = X86_F_MODRM | X86_F_IMM8;
+    }
+    else
+    {
+      map = X86_MAP_0F;
+      opcode = second;
+      flags = g_X86Secondary[second];
+      if (second == 0x78 && (mandatoryPrefix == 0x66 || mandatoryPrefix == 0xF2))
+        flags |= X86_F_IMM16;
+    }
+  }
+  else if (vexLike)
+  {
+    uint8_t select;
+    size_t payload;
+    if (op == 0xC5)
+    {
+      payload = 1;
+      select = 1;
+      encoding = X86_ENCODING_VEX;
+      mandatoryPrefix = X86PrefixFromPp(code[p]);
+    }
+    else
+    {
+      payload = op == 0xC4 ? 2 : 3;
+      if (p + payload > limit)
+        return 0;
+      select = code[p] & (op == 0xC4 ? 0x1F : 0x07);
+      encoding = op == 0xC4 ? X86_ENCODING_VEX : X86_ENCODING_EVEX;
+      mandatoryPrefix = X86PrefixFromPp(code[p + 1]);
+      if (op == 0x62 && ((code[p + 1] & 0x04) == 0 || select == 0 || select == 4 || select == 7))
+        return 0;
+      if (op == 0xC4 && (select == 0 || select > 3))
+        return 0;
+    }
+    p += payload;
+    if (p >= limit)
+      return 0;
+    map = X86MapFromSelect(select);
+    opcode = code[p++];
+    flags = X86_F_MODRM;
+    if (select == 1 && opcode == 0x77 && encoding == X86_ENCODING_VEX)
+      flags = 0;
+    if (select == 3 || (select == 1 && (g_X86Secondary[opcode] & X86_F_IMM8)))
+      flags |= X86_F_IMM8;
+  }
+  else if (xop)
+  {
+    uint8_t select = code[p] & 0x1F;
+    if (select > 0x0A || p + 2 > limit)
+      return 0;
+    encoding = X86_ENCODING_XOP;
+    map = X86_MAP_OTHER;
+    mandatoryPrefix = X86PrefixFromPp(code[p + 1]);
+    p += 2;
+    if (p >= limit)
+      return 0;
+    opcode = code[p++];
+    flags = X86_F_MODRM;
+    immediateBytes = select == 0x08 ? 1 : select == 0x0A ? 4 : 0;
+  }
+  else
+  {
+    flags = g_X86Primary[op];
+    if (is64 && (flags & X86_F_INV64))
+      return 0;
+  }
+
+  if (flags & X86_F_INVALID)
+    return 0;
+
+  uint8_t modrm = 0;
+  if (flags & X86_F_MODRM)
+  {
+    if (p >= limit)
+      return 0;
+    modrm = code[p++];
+
+    // MOV to and from control/debug registers ignores mod: always a register.
+    uint8_t mod = (map == X86_MAP_0F && opcode >= 0x20 && opcode <= 0x23) ? 3 : modrm >> 6;
+    uint8_t rm = modrm & 7;
+    size_t displacement = 0;
+    if (addressBits == 16)
+    {
+      if ((mod == 0 && rm == 6) || mod == 2)
+        displacement = 2;
+      else if (mod == 1)
+        displacement = 1;
+    }
+    else if (mod != 3)
+    {
+      if (rm == 4)
+      {
+        if (p >= limit)
+          return 0;
+        uint8_t sib = code[p++];
+        if (mod == 0 && (sib & 7) == 5)
+          displacement = 4;
+      }
+      if ((mod == 0 && rm == 5) || mod == 2)
+        displacement = 4;
+      else if (mod == 1)
+        displacement = 1;
+    }
+    p += displacement;
+  }
+
+  if (flags & (X86_F_IMM8 | X86_F_IMM16 | X86_F_IMMZ | X86_F_IMMV | X86_F_MOFFS | X86_F_FAR | X86_F_TEST))
+  {
+    if (flags & X86_F_IMM8)
+      immediateBytes += 1;
+    if (flags & X86_F_IMM16)
+      immediateBytes += 2;
+    if (flags & X86_F_IMMZ)
+      immediateBytes += (operandBits == 16 && !(is64 && (flags & X86_F_REL))) ? 2 : 4;
+    if (flags & X86_F_IMMV)
+      immediateBytes += operandBits / 8;
+    if (flags & X86_F_MOFFS)
+      immediateBytes += addressBits / 8;
+    if (flags & X86_F_FAR)
+      immediateBytes += operandBits == 16 ? 4 : 6;
+    if ((flags & X86_F_TEST) && ((modrm >> 3) & 7) < 2)
+      immediateBytes += op == 0xF6 ? 1 : operandBits == 16 ? 2 : 4;
+  }
+
+  if (p + immediateBytes > limit)
+    return 0;
+
+  if (Detail)
+  {
+    *out = X86Instruction();
+    out->address = address;
+    out->length = (uint8_t)(p + immediateBytes);
+    out->opcode = opcode;
+    out->modrm = modrm;
+    out->rex = rex;
+    out->mandatoryPrefix = mandatoryPrefix;
+    out->operandBits = (uint8_t)operandBits;
+    out->encoding = encoding;
+    out->map = map;
+    out->hasModrm = (flags & X86_F_MODRM) != 0;
+    out->lock = lock;
+    out->rep = rep;
+    out->repne = repne;
+    out->valid = true;
+
+    uint64_t value = 0;
+    size_t valueBytes = immediateBytes > 8 ? 8 : immediateBytes;
+    for (size_t i = 0; i < valueBytes; i++)
+      value |= (uint64_t)code[p + i] << (i * 8);
+    out->immediate = value;
+    out->hasImmediate = immediateBytes > 0;
+
+    if (map == X86_MAP_3DNOW)
+    {
+      out->opcode = (uint8_t)value;
+      out->hasImmediate = false;
+    }
+
+    if (flags & X86_F_REL)
+    {
+      uint64_t sign = (uint64_t)1 << (immediateBytes * 8 - 1);
+      uint64_t target = address + out->length + ((value ^ sign) - sign);
+      if (!is64)
+        target &= operandBits == 16 ? 0xFFFFull : 0xFFFFFFFFull;
+      out->target = target;
+      out->hasTarget = true;
+      out->hasImmediate = false;
+    }
+  }
+
+  return p + immediateBytes;
+}
+
+bool X86Decode(const uint8_t* code, size_t available, uint64_t address, X86Mode mode, X86Instruction* outInstruction)
+{
+  X86BuildTables();
+  if (X86DecodeCore<true>(code, available, address, mode, outInstruction) > 0)
+    return true;
+  *outInstruction = X86Instruction();
+  outInstruction->address = address;
+  return false;
+}
+
+size_t X86InstructionLength(const uint8_t* code, size_t available, X86Mode mode)
+{
+  X86BuildTables();
+  if (available >= X86_MAX_INSTRUCTION && mode != X86_MODE_16)
+  {
+    // Branch-free apart from the slow-path test: the sweep's next position
+    // depends on this result, so mispredicts cost more than the arithmetic.
+    size_t p = (mode == X86_MODE_64 && (code[0] & 0xF0) == 0x40) ? 1 : 0;
+    uint8_t shape = g_X86FastShape[code[p]];
+    if (shape != X86_FAST_SLOW)
+    {
+      size_t hasModrm = shape >> 7;
+      uint8_t extra = g_X86ModrmExtra[code[p + 1]] & (uint8_t)(0 - hasModrm);
+      size_t hasSib = (extra >> 6) & 1;
+      size_t sibDisp = ((code[p + 2] & 7) == 5) ? 4 : 0;
+      size_t displacement = (extra & X86_FAST_SIB_DISP) ? sibDisp : (size_t)(extra & 0x0F);
+      return p + 1 + hasModrm + hasSib + displacement + (shape & 0x0F);
+    }
+  }
+  return X86DecodeCore<false>(code, available, 0, mode, nullptr);
+}
+
+static size_t X86Append(char* out, size_t pos, size_t max, const char* text)
+{
+  while (*text && pos + 1 < max)
+    out[pos++] = *text++;
+  out[pos] = 0;
+  return pos;
+}
+
+static size_t X86AppendHex(char* out, size_t pos, size_t max, uint64_t value)
+{
+  char digits[20];
+  itoaHex(value, digits, sizeof(digits));
+  pos = X86Append(out, pos, max, "0x");
+  return X86Append(out, pos, max, digits);
+}
+
+static size_t X86AppendByte(char* out, size_t pos, size_t max, uint8_t value)
+{
+  static const char* hex = "0123456789abcdef";
+  char digits[3] = { hex[value >> 4], hex[value & 0x0F], 0 };
+  return X86Append(out, pos, max, digits);
+}
+
+static const char* X86RegisterName(int index, int bits, bool rex)
+{
+  if (bits == 64)
+    return g_X86Reg64[index];
+  if (bits == 32)
+    return g_X86Reg32[index];
+  if (bits == 16)
+    return g_X86Reg16[index];
+  return rex ? g_X86Reg8[index] : g_X86Reg8Legacy[index & 7];
+}
+
+static const char* X86PickName(const char* const* names, uint8_t mandatoryPrefix)
+{
+  int slot = mandatoryPrefix == 0x66 ? 1 : mandatoryPrefix == 0xF3 ? 2 : mandatoryPrefix == 0xF2 ? 3 : 0;
+  return names[slot] ? names[slot] : names[0];
+}
+
+static const char* X86SecondaryName(const X86Instruction& ins, int reg, int mod)
+{
+  uint8_t op = ins.opcode;
+  if (op >= 0x40 && op <= 0x4F)
+    return nullptr;
+  if (op == 0x00)
+    return g_X86Group6[reg];
+  if (op == 0x01)
+  {
+    if (mod == 3)
+    {
+      switch (ins.modrm)
+      {
+      case 0xC8: return "monitor";
+      case 0xC9: return "mwait";
+      case 0xCA: return "clac";
+      case 0xCB: return "stac";
+      case 0xD0: return "xgetbv";
+      case 0xD1: return "xsetbv";
+      case 0xD5: return "xend";
+      case 0xD6: return "xtest";
+      case 0xF8: return "swapgs";
+      case 0xF9: return "rdtscp";
+      }
+    }
+    return g_X86Group7[reg];
+  }
+  if (op == 0x1E && ins.rep && (ins.modrm == 0xFA || ins.modrm == 0xFB))
+    return ins.modrm == 0xFA ? "endbr64" : "endbr32";
+  if (op >= 0x71 && op <= 0x73)
+  {
+    static const char* const shifts[3][8] = {
+      { nullptr, nullptr, "psrlw", nullptr, "psraw", nullptr, "psllw", nullptr },
+      { nullptr, nullptr, "psrld", nullptr, "psrad", nullptr, "pslld", nullptr },
+      { nullptr, nullptr, "psrlq", "psrldq", nullptr, nullptr, "psllq", "pslldq" } };
+    return shifts[op - 0x71][reg];
+  }
+  if (op == 0xA0 || op == 0xA8)
+    return "push";
+  if (op == 0xA1 || op == 0xA9)
+    return "pop";
+  if (op == 0xAE)
+  {
+    if (mod == 3 && reg >= 5)
+      return reg == 5 ? "lfence" : reg == 6 ? "mfence" : "sfence";
+    return g_X86Group15[reg];
+  }
+  if (op == 0xBA)
+  {
+    static const char* const bits[8] = { nullptr, nullptr, nullptr, nullptr, "bt", "bts", "btr", "btc" };
+    return bits[reg];
+  }
+  if (op == 0xC7)
+  {
+    if (mod == 3)
+      return reg == 6 ? "rdrand" : reg == 7 ? "rdseed" : nullptr;
+    if (reg == 1)
+      return (ins.rex & 0x08) ? "cmpxchg16b" : "cmpxchg8b";
+    return nullptr;
+  }
+  if (op >= 0xC8 && op <= 0xCF)
+    return "bswap";
+  return X86PickName(g_X86SecondaryNames[op], ins.mandatoryPrefix);
+}
+
+static const char* X86PrimaryName(const X86Instruction& ins, X86Mode mode, int reg)
+{
+  uint8_t op = ins.opcode;
+  int bits = ins.operandBits;
+  switch (op)
+  {
+  case 0x63:
+    return mode == X86_MODE_64 ? "movsxd" : "arpl";
+  case 0x80: case 0x81: case 0x82: case 0x83:
+    return g_X86Group1[reg];
+  case 0x8F:
+    return reg == 0 ? "pop" : nullptr;
+  case 0x90:
+    return ins.rep ? "pause" : ((ins.rex & 0x01) ? "xchg" : "nop");
+  case 0x98:
+    return bits == 16 ? "cbw" : bits == 64 ? "cdqe" : "cwde";
+  case 0x99:
+    return bits == 16 ? "cwd" : bits == 64 ? "cqo" : "cdq";
+  case 0xC0: case 0xC1: case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+    return g_X86Group2[reg];
+  case 0xC6:
+    return ins.modrm == 0xF8 ? "xabort" : reg == 0 ? "mov" : nullptr;
+  case 0xC7:
+    return ins.modrm == 0xF8 ? "xbegin" : reg == 0 ? "mov" : nullptr;
+  case 0xE3:
+    return mode == X86_MODE_64 ? "jrcxz" : "jecxz";
+  case 0xF6: case 0xF7:
+    return g_X86Group3[reg];
+  case 0xFE:
+    return reg < 2 ? g_X86Group5[reg] : nullptr;
+  case 0xFF:
+    return g_X86Group5[reg];
+  }
+  if (op >= 0xD8 && op <= 0xDF)
+    return g_X86Float[op - 0xD8][reg];
+  return g_X86PrimaryNames[op];
+}
+
+static bool X86IsStringOp(uint8_t op)
+{
+  return (op >= 0x6C && op <= 0x6F) || (op >= 0xA4 && op <= 0xA7) || (op >= 0xAA && op <= 0xAF);
+}
+
+// Produces "mnemonic" plus the operands that are cheap to render without a
+// full operand decoder: branch targets, opcode-embedded registers and
+// accumulator/immediate forms. ModRM operands are left to plugins.
+size_t X86Format(const X86Instruction& ins, X86Mode mode, char* out, size_t max)
+{
+  if (max == 0)
+    return 0;
+  out[0] = 0;
+  X86BuildTables();
+
+  int reg = (ins.modrm >> 3) & 7;
+  int mod = ins.modrm >> 6;
+  int bits = ins.operandBits;
+  bool rex = ins.rex != 0;
+  int rexB = (ins.rex & 0x01) ? 8 : 0;
+  uint8_t op = ins.opcode;
+  size_t pos = 0;
+
+  if (!ins.valid)
+    return X86Append(out, pos, max, "(bad)");
+
+  if (ins.lock)
+    pos = X86Append(out, pos, max, "lock ");
+
+  if (ins.encoding == X86_ENCODING_XOP || ins.map == X86_MAP_OTHER || ins.map == X86_MAP_3DNOW)
+  {
+    pos = X86Append(out, pos, max, ins.encoding == X86_ENCODING_XOP ? "xop " : ins.map == X86_MAP_3DNOW ? "3dnow " : "evex ");
+    return X86AppendByte(out, pos, max, op);
+  }
+
+  if (ins.encoding == X86_ENCODING_VEX && ins.map == X86_MAP_0F && op == 0x77)
+    return X86Append(out, pos, max, "vzeroupper");
+
+  const char* name = nullptr;
+  const char* mapLabel = "";
+  if (ins.map == X86_MAP_PRIMARY)
+    name = X86PrimaryName(ins, mode, reg);
+  else if (ins.map == X86_MAP_0F)
+  {
+    mapLabel = "0f ";
+    if (op >= 0x40 && op <= 0x4F)
+      name = "cmov";
+    else if (op >= 0x80 && op <= 0x8F)
+      name = "j";
+    else if (op >= 0x90 && op <= 0x9F)
+      name = "set";
+    else
+      name = X86SecondaryName(ins, reg, mod);
+  }
+  else if (ins.map == X86_MAP_0F38)
+  {
+    mapLabel = "0f38 ";
+    name = X86PickName(g_X86Map38Names[op], ins.mandatoryPrefix);
+  }
+  else if (ins.map == X86_MAP_0F3A)
+  {
+    mapLabel = "0f3a ";
+    name = X86PickName(g_X86Map3ANames[op], ins.mandatoryPrefix);
+  }
+
+  if (!name)
+  {
+    pos = X86Append(out, pos, max, ins.encoding == X86_ENCODING_LEGACY ? "op " : ins.encoding == X86_ENCODING_VEX ? "vex " : "evex ");
+    pos = X86Append(out, pos, max, mapLabel);
+    return X86AppendByte(out, pos, max, op);
+  }
+
+  if (ins.encoding != X86_ENCODING_LEGACY)
+    pos = X86Append(out, pos, max, "v");
+
+  if (ins.map == X86_MAP_PRIMARY && X86IsStringOp(op) && (ins.rep || ins.repne))
+    pos = X86Append(out, pos, max, ins.repne ? "repne " : "rep ");
+
+  pos = X86Append(out, pos, max, name);
+  if (ins.map == X86_MAP_0F && ((op >= 0x40 && op <= 0x4F) || (op >= 0x80 && op <= 0x9F)))
+    pos = X86Append(out, pos, max, g_X86Conditions[op & 0x0F]);
+  if (ins.map == X86_MAP_PRIMARY && X86IsStringOp(op) && (op & 1))
+    pos = X86Append(out, pos, max, bits == 16 ? "w" : bits == 64 ? "q" : "d");
+
+  if (ins.hasTarget)
+  {
+    pos = X86Append(out, pos, max, " ");
+    return X86AppendHex(out, pos, max, ins.target);
+  }
+
+  if (ins.map == X86_MAP_0F && op >= 0xC8 && op <= 0xCF)
+  {
+    pos = X86Append(out, pos, max, " ");
+    return X86Append(out, pos, max, X86RegisterName((op & 7) | rexB, bits == 64 ? 64 : 32, rex));
+  }
+
+  if (ins.map != X86_MAP_PRIMARY || ins.encoding != X86_ENCODING_LEGACY)
+    return pos;
+
+  if ((op >= 0x40 && op <= 0x5F) && !(mode == X86_MODE_64 && op < 0x50))
+  {
+    int stackBits = mode == X86_MODE_64 ? (bits == 16 ? 16 : 64) : bits;
+    pos = X86Append(out, pos, max, " ");
+    return X86Append(out, pos, max, X86RegisterName((op & 7) | rexB, op >= 0x50 ? stackBits : bits, rex));
+  }
+
+  if (op >= 0x91 && op <= 0x97)
+  {
+    pos = X86Append(out, pos, max, " ");
+    pos = X86Append(out, pos, max, X86RegisterName(0, bits, rex));
+    pos = X86Append(out, pos, max, ", ");
+    return X86Append(out, pos, max, X86RegisterName((op & 7) | rexB, bits, rex));
+  }
+
+  if (!ins.hasImmediate || ins.hasModrm)
+    return pos;
+
+  pos = X86Append(out, pos, max, " ");
+  if (op >= 0xB0 && op <= 0xBF)
+  {
+    pos = X86Append(out, pos, max, X86RegisterName((op & 7) | rexB, op < 0xB8 ? 8 : bits, rex));
+    pos = X86Append(out, pos, max, ", ");
+  }
+  else if ((op < 0x40 && (op & 7) >= 4) || op == 0xA8 || op == 0xA9)
+  {
+    pos = X86Append(out, pos, max, X86RegisterName(0, (op & 1) ? bits : 8, rex));
+    pos = X86Append(out, pos, max, ", ");
+  }
+  else if (op == 0xA0 || op == 0xA1)
+  {
+    pos = X86Append(out, pos, max, X86RegisterName(0, op == 0xA0 ? 8 : bits, rex));
+    pos = X86Append(out, pos, max, ", [");
+    pos = X86AppendHex(out, pos, max, ins.immediate);
+    return X86Append(out, pos, max, "]");
+  }
+  else if (op == 0xA2 || op == 0xA3)
+  {
+    pos = X86Append(out, pos, max, "[");
+    pos = X86AppendHex(out, pos, max, ins.immediate);
+    pos = X86Append(out, pos, max, "], ");
+    return X86Append(out, pos, max, X86RegisterName(0, op == 0xA2 ? 8 : bits, rex));
+  }
+  return X86AppendHex(out, pos, max, ins.immediate);
+}
+
+static size_t X86Advance(const uint8_t* code, size_t length, size_t pos, X86Mode mode)
+{
+  size_t step = X86InstructionLength(code + pos, length - pos, mode);
+  return pos + (step > 0 ? step : 1);
+}
+
+static bool X86TestBit(const uint8_t* bits, size_t pos)
+{
+  return (bits[pos >> 3] >> (pos & 7)) & 1;
+}
+
+static void X86SetBit(uint8_t* bits, size_t pos)
+{
+  bits[pos >> 3] |= (uint8_t)(1u << (pos & 7));
+}
+
+static void X86ClearBit(uint8_t* bits, size_t pos)
+{
+  bits[pos >> 3] &= (uint8_t)~(1u << (pos & 7));
+}
+
+static void X86SweepChunk(X86SweepJob* job, size_t index)
+{
+  size_t pos = index * X86_SWEEP_CHUNK;
+  size_t end = pos + X86_SWEEP_CHUNK;
+  if (end > job->length)
+    end = job->length;
+  while (pos < end)
+  {
+    X86SetBit(job->bits, pos);
+    pos = X86Advance(job->code, job->length, pos, job->mode);
+  }
+  job->exits[index] = pos;
+}
+
+static void RunX86SweepJob(X86SweepWorker* worker)
+{
+  X86SweepJob* job = worker->job;
+  for (;;)
+  {
+#ifdef _WIN32
+    size_t index = (size_t)(InterlockedIncrement(&job->nextChunk) - 1);
+#else
+    size_t index = (size_t)__atomic_fetch_add(&job->nextChunk, 1, __ATOMIC_RELAXED);
+#endif
+    if (index >= job->chunkCount)
+      break;
+    X86SweepChunk(job, index);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI RunX86SweepWorker(LPVOID param)
+{
+  RunX86SweepJob((X86SweepWorker*)param);
+  return 0;
+}
+#else
+static void* RunX86SweepWorker(void* param)
+{
+  RunX86SweepJob((X86SweepWorker*)param);
+  return nullptr;
+}
+#endif
+
+static size_t X86WorkerCount(size_t chunkCount)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t cpuCount = info.dwNumberOfProcessors;
+#else
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t cpuCount = online > 0 ? (size_t)online : 1;
+#endif
+  if (cpuCount > X86_MAX_THREADS)
+    cpuCount = X86_MAX_THREADS;
+  if (cpuCount > chunkCount)
+    cpuCount = chunkCount;
+  return cpuCount > 0 ? cpuCount : 1;
+}
+
+// Linear sweep from offset 0, recording every instruction start in
+// outStartBits (one bit per byte, (length + 7) / 8 bytes). Undecodable bytes
+// are stepped over one at a time. Chunks are swept in parallel from their
+// own first byte; a sequential pass then re-sweeps each chunk from where the
+// previous one really ended until the two sweeps meet, which on x86 code
+// takes a handful of instructions. Returns the number of starts.
+uint64_t X86SweepBoundaries(const uint8_t* code, size_t length, X86Mode mode, uint8_t* outStartBits)
+{
+  X86BuildTables();
+  size_t bitBytes = (length + 7) / 8;
+  memSet(outStartBits, 0, bitBytes);
+  if (length == 0)
+    return 0;
+
+  X86SweepJob job;
+  job.code = code;
+  job.length = length;
+  job.mode = mode;
+  job.bits = outStartBits;
+  job.chunkCount = (length + X86_SWEEP_CHUNK - 1) / X86_SWEEP_CHUNK;
+  job.nextChunk = 0;
+  job.exits = (size_t*)platformAlloc(job.chunkCount * sizeof(size_t));
+  if (!job.exits)
+    return 0;
+
+  size_t workerCount = X86WorkerCount(job.chunkCount);
+  X86SweepWorker workers[X86_MAX_THREADS];
+  for (size_t i = 0; i < workerCount; i++)
+  {
+    workers[i].job = &job;
+    workers[i].started = false;
+  }
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+#ifdef _WIN32
+    workers[i].thread = CreateThread(nullptr, 0, RunX86SweepWorker, &workers[i], 0, nullptr);
+    workers[i].started = workers[i].thread != nullptr;
+#else
+    workers[i].started = pthread_create(&workers[i].thread, nullptr, RunX86SweepWorker, &workers[i]) == 0;
+#endif
+  }
+
+  RunX86SweepJob(&workers[0]);
+
+  for (size_t i = 1; i < workerCount; i++)
+  {
+    if (workers[i].started)
+    {
+#ifdef _WIN32
+      WaitForSingleObject(workers[i].thread, INFINITE);
+      CloseHandle(workers[i].thread);
+#else
+      pthread_join(workers[i].thread, nullptr);
+#endif
+    }
+  }
+
+  for (size_t k = 1; k < job.chunkCount; k++)
+  {
+    size_t chunkStart = k * X86_SWEEP_CHUNK;
+    size_t chunkEnd = chunkStart + X86_SWEEP_CHUNK;
+    if (chunkEnd > length)
+      chunkEnd = length;
+
+    size_t pos = job.exits[k - 1];
+    if (pos == chunkStart)
+      continue;
+
+    for (size_t i = chunkStart; i < pos && i < chunkEnd; i++)
+      X86ClearBit(outStartBits, i);
+
+    bool synced = false;
+    while (pos < chunkEnd)
+    {
+      if (X86TestBit(outStartBits, pos))
+      {
+        synced = true;
+        break;
+      }
+      X86SetBit(outStartBits, pos);
+      size_t next = X86Advance(code, length, pos, mode);
+      for (size_t i = pos + 1; i < next && i < chunkEnd; i++)
+        X86ClearBit(outStartBits, i);
+      pos = next;
+    }
+    if (!synced)
+      job.exits[k] = pos;
+  }
+
+  platformFree(job.exits, job.chunkCount * sizeof(size_t));
+
+  uint64_t count = 0;
+  for (size_t i = 0; i < bitBytes; i++)
+  {
+    uint8_t b = outStartBits[i];
+    while (b)
+    {
+      b &= (uint8_t)(b - 1);
+      count++;
+    }
+  }
+  return count;
+}
@@ -10,6 +10,7 @@
 #include <X11/Xutil.h>
 #include <X11/keysym.h>
 #include <unistd.h>
+#include <time.h>
 #else
 #error "Unsupported platform"
 #endif
@@ -300,6 +301,58 @@ void CopyString(char *dest, const char *src, int maxLen)
 	dest[i] = '\0';
 }
 
+#if defined(__linux__)
+extern Display* g_display;
+extern Window g_window;
+
+static Bool IsEscapeKeyPress(Display* display, XEvent* event, XPointer arg)
+{
+	(void)display;
+	(void)arg;
+	return event->type == KeyPress && event->xkey.window == g_window &&
+		XLookupKeysym(&event->xkey, 0) == XK_Escape;
+}
+#endif
+
+static bool BookmarkPluginProgress(void* userData, size_t bookmarkCount,
+	uint64_t bytesProcessed, uint64_t bytesTotal)
+{
+	(void)bookmarkCount;
+	(void)bytesProcessed;
+	(void)bytesTotal;
+
+	uint64_t* lastRedraw = (uint64_t*)userData;
+
+#if defined(_WIN32)
+	uint64_t now = GetTickCount64();
+	if (now - *lastRedraw >= 50)
+	{
+		*lastRedraw = now;
+		InvalidateRect(g_Hwnd, nullptr, FALSE);
+		UpdateWindow(g_Hwnd);
+	}
+	return (GetAsyncKeyState(VK_ESCAPE) & 0x8000) == 0;
+#elif defined(__linux__)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64_t now = (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+	if (now - *lastRedraw >= 50)
+	{
+		*lastRedraw = now;
+		LinuxRedraw();
+	}
+
+	if (!g_display)
+		return true;
+
+	XEvent event;
+	return !XCheckIfEvent(g_display, &event, IsEscapeKeyPress, nullptr);
+#else
+	(void)lastRedraw;
+	return true;
+#endif
+}
+
 void ApplyEnabledPlugins()
 {
 	if (g_HexData.getFileSize() == 0)
@@ -331,12 +384,15 @@ void ApplyEnabledPlugins()
 		}
 	}
 
-	g_HexData.executeBookmarkPlugins();
+	uint64_t lastRedraw = 0;
+	g_HexData.executeBookmarkPlugins(BookmarkPluginProgress, &lastRedraw);
 }
 
 void OnNew()
 {
+	Project_Save(g_CurrentFilePath);
 	g_HexData.clear();
+	Bookmarks_clear();
 	g_CurrentFilePath[0] = '\0';
 	g_ScrollY = 0;
 	g_TotalLines = 0;
@@ -381,6 +437,7 @@ void OnFileOpen()
 
 	if (GetOpenFileNameA(&ofn))
 	{
+		Project_Save(g_CurrentFilePath);
 		if (g_HexData.loadFile(ofn.lpstrFile))
 		{
 			strCopy(g_CurrentFilePath, ofn.lpstrFile);
@@ -392,6 +449,7 @@ void OnFileOpen()
 
 			g_TotalLines = (int)g_HexData.getHexLines().count;
 			g_ScrollY = 0;
+			Project_Load(g_CurrentFilePath);
 
 			RECT rc;
 			GetClientRect(g_Hwnd, &rc);
@@ -422,6 +480,7 @@ void OnFileOpen()
 		NSURL* url = [[panel URLs]objectAtIndex:0];
 		const char* path = [[url path]UTF8String];
 
+		Project_Save(g_CurrentFilePath);
 		if (g_HexData.loadFile(path))
 		{
 			strCopy(g_CurrentFilePath, path);
@@ -433,6 +492,7 @@ void OnFileOpen()
 
 			g_TotalLines = (int)g_HexData.getHexLines().count;
 			g_ScrollY = 0;
+			Project_Load(g_CurrentFilePath);
 
 			if (g_Hwnd) {
 				NSWindow* window = (__bridge NSWindow*)g_Hwnd;
@@ -469,6 +529,7 @@ void OnFileOpen()
 	if (len > 0 && path[len - 1] == '\n')
 		path[len - 1] = 0;
 
+	Project_Save(g_CurrentFilePath);
 	if (g_HexData.loadFile(path))
 	{
 		strCopy(g_CurrentFilePath, path);
@@ -480,6 +541,7 @@ void OnFileOpen()
 
 		g_TotalLines = (int)g_HexData.getHexLines().count;
 		g_ScrollY = 0;
+		Project_Load(g_CurrentFilePath);
 		LinuxRedraw();
 	}
 	else
@@ -489,9 +551,180 @@ void OnFileOpen()
 #endif
 }
 
+void OnTemplateOpen()
+{
+	char error[TEMPLATE_ERROR_LEN];
+#if defined(_WIN32)
+	if (!g_Hwnd)
+		return;
+
+	OPENFILENAMEA ofn;
+	char szFile[260];
+	memset(&ofn, 0, sizeof(ofn));
+	memset(szFile, 0, sizeof(szFile));
+
+	ofn.lStructSize = sizeof(ofn);
+	ofn.hwndOwner = g_Hwnd;
+	ofn.lpstrFile = szFile;
+	ofn.nMaxFile = sizeof(szFile);
+	ofn.lpstrFilter =
+		"Templates (*.tpl)\0*.TPL\0"
+		"All Files (*.*)\0*.*\0";
+	ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
+
+	if (!GetOpenFileNameA(&ofn))
+		return;
+
+	if (!g_HexData.loadTemplate(ofn.lpstrFile, error, sizeof(error)))
+	{
+		MessageBoxA(g_Hwnd, error, "Template Error", MB_OK | MB_ICONERROR);
+		return;
+	}
+
+	g_TemplatePanel.firstRow = 0;
+	InvalidateRect(g_Hwnd, 0, FALSE);
+#elif defined(__APPLE__)
+	NSOpenPanel* panel = [NSOpenPanel openPanel];
+	[panel setCanChooseFiles : YES] ;
+	[panel setCanChooseDirectories : NO] ;
+	[panel setAllowsMultipleSelection : NO] ;
+
+	if ([panel runModal] != NSModalResponseOK)
+		return;
+
+	NSURL* url = [[panel URLs]objectAtIndex:0];
+	const char* path = [[url path]UTF8String];
+
+	if (!g_HexData.loadTemplate(path, error, sizeof(error)))
+	{
+		NSAlert* alert = [[NSAlert alloc]init];
+		[alert setMessageText:@"Template Error"] ;
+		[alert setInformativeText:[NSString stringWithUTF8String:error]] ;
+		[alert setAlertStyle:NSAlertStyleCritical] ;
+		[alert runModal] ;
+		return;
+	}
+
+	g_TemplatePanel.firstRow = 0;
+	if (g_Hwnd) {
+		NSWindow* window = (__bridge NSWindow*)g_Hwnd;
+		[[window contentView]setNeedsDisplay:YES];
+	}
+#elif defined(__linux__)
+	FILE* fp = popen("zenity --file-selection --title='Apply Template' 2>/dev/null", "r");
+	if (!fp)
+	{
+		printf("Failed to open file dialog.\n");
+		return;
+	}
+
+	char path[512] = { 0 };
+	if (!fgets(path, sizeof(path), fp))
+	{
+		pclose(fp);
+		return;
+	}
+	pclose(fp);
+
+	size_t len = strLen(path);
+	if (len > 0 && path[len - 1] == '\n')
+		path[len - 1] = 0;
+
+	if (!g_HexData.loadTemplate(path, error, sizeof(error)))
+	{
+		printf("Template error: %s\n", error);
+		return;
+	}
+
+	g_TemplatePanel.firstRow = 0;
+	LinuxRedraw();
+#endif
+}
+
+void OnDigestListOpen()
+{
+	char error[FUZZY_ERROR_LEN];
+#if defined(_WIN32)
+	if (!g_Hwnd)
+		return;
+
+	OPENFILENAMEA ofn;
+	char szFile[260];
+	memset(&ofn, 0, sizeof(ofn));
+	memset(szFile, 0, sizeof(szFile));
+
+	ofn.lStructSize = sizeof(ofn);
+	ofn.hwndOwner = g_Hwnd;
+	ofn.lpstrFile = szFile;
+	ofn.nMaxFile = sizeof(szFile);
+	ofn.lpstrFilter =
+		"Digest Lists (*.txt;*.csv)\0*.TXT;*.CSV\0"
+		"All Files (*.*)\0*.*\0";
+	ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
+
+	if (!GetOpenFileNameA(&ofn))
+		return;
+
+	if (!Checksum_CompareList(ofn.lpstrFile, error, sizeof(error)))
+		MessageBoxA(g_Hwnd, error, "Digest Compare", MB_OK | MB_ICONERROR);
+
+	InvalidateRect(g_Hwnd, 0, FALSE);
+#elif defined(__APPLE__)
+	NSOpenPanel* panel = [NSOpenPanel openPanel];
+	[panel setCanChooseFiles : YES] ;
+	[panel setCanChooseDirectories : NO] ;
+	[panel setAllowsMultipleSelection : NO] ;
+
+	if ([panel runModal] != NSModalResponseOK)
+		return;
+
+	NSURL* url = [[panel URLs]objectAtIndex:0];
+	const char* path = [[url path]UTF8String];
+
+	if (!Checksum_CompareList(path, error, sizeof(error)))
+	{
+		NSAlert* alert = [[NSAlert alloc]init];
+		[alert setMessageText:@"Digest Compare"] ;
+		[alert setInformativeText:[NSString stringWithUTF8String:error]] ;
+		[alert setAlertStyle:NSAlertStyleCritical] ;
+		[alert runModal] ;
+	}
+
+	if (g_Hwnd) {
+		NSWindow* window = (__bridge NSWindow*)g_Hwnd;
+		[[window contentView]setNeedsDisplay:YES];
+	}
+#elif defined(__linux__)
+	FILE* fp = popen("zenity --file-selection --title='Compare Digests' 2>/dev/null", "r");
+	if (!fp)
+	{
+		printf("Failed to open file dialog.\n");
+		return;
+	}
+
+	char path[512] = { 0 };
+	if (!fgets(path, sizeof(path), fp))
+	{
+		pclose(fp);
+		return;
+	}
+	pclose(fp);
+
+	size_t len = strLen(path);
+	if (len > 0 && path[len - 1] == '\n')
+		path[len - 1] = 0;
+
+	if (!Checksum_CompareList(path, error, sizeof(error)))
+		printf("Digest compare error: %s\n", error);
+
+	LinuxRedraw();
+#endif
+}
+
 void OnFileSave()
 {
-	if (g_CurrentFilePath[0] == '\0')
+	ProcessMemorySource* source = g_HexData.getProcessSource();
+	if (g_CurrentFilePath[0] == '\0' || (source && source->isDump()))
 	{
 		OnFileSaveAs();
 		return;
@@ -499,6 +732,7 @@ void OnFileSave()
 
 	if (g_HexData.saveFile(g_CurrentFilePath))
 	{
+		Project_Save(g_CurrentFilePath);
 #if defined(_WIN32)
 		MessageBoxA(g_Hwnd, "File saved successfully.", "Info", MB_OK | MB_ICONINFORMATION);
 #elif defined(__APPLE__)
@@ -549,6 +783,7 @@ void OnFileSaveAs()
 		if (g_HexData.saveFile(ofn.lpstrFile))
 		{
 			CopyString(g_CurrentFilePath, ofn.lpstrFile, MAX_PATH_LEN);
+			Project_Save(g_CurrentFilePath);
 			MessageBoxA(g_Hwnd, "File saved successfully.", "Info", MB_OK | MB_ICONINFORMATION);
 		}
 		else
@@ -568,6 +803,7 @@ void OnFileSaveAs()
 		if (g_HexData.saveFile(path))
 		{
 			CopyString(g_CurrentFilePath, path, MAX_PATH_LEN);
+			Project_Save(g_CurrentFilePath);
 			NSAlert* alert = [[NSAlert alloc]init];
 			[alert setMessageText:@"Success"] ;
 			[alert setInformativeText:@"File saved successfully."] ;
@@ -746,6 +982,7 @@ void OpenRecentFile(int index)
 	if (index < 0 || index >= g_RecentFileCount)
 		return;
 
+	Project_Save(g_CurrentFilePath);
 	if (g_HexData.loadFile(g_RecentFiles[index]))
 	{
 		strCopy(g_CurrentFilePath, g_RecentFiles[index]);
@@ -757,6 +994,7 @@ void OpenRecentFile(int index)
 
 		g_TotalLines = (int)g_HexData.getHexLines().count;
 		g_ScrollY = 0;
+		Project_Load(g_CurrentFilePath);
 
 #if defined(_WIN32)
 		InvalidateRect(g_Hwnd, NULL, FALSE);
@@ -823,19 +1061,24 @@ void OnfindReplace()
 void OnGoTo()
 {
 #if defined(_WIN32)
-	static int resultOffset = -1;
-	resultOffset = -1;
+	static long long resultValue = -1;
+	resultValue = -1;
 
 	SearchDialogs::ShowGoToDialog(
 		g_Hwnd,
 		g_Options.darkMode,
-		[](int offset)
+		[](long long value)
 		{
-			resultOffset = offset;
+			resultValue = value;
 		},
 		nullptr);
 
-	if (resultOffset >= 0 && resultOffset < (long long)g_HexData.getFileSize())
+	size_t targetOffset = 0;
+	long long resultOffset = -1;
+	if (resultValue >= 0 && g_HexData.resolveGoToTarget((uint64_t)resultValue, &targetOffset))
+		resultOffset = (long long)targetOffset;
+
+	if (resultOffset >= 0)
 	{
 		cursorBytePos = resultOffset;
 		cursorNibblePos = 0;
@@ -886,23 +1129,28 @@ void OnGoTo()
 		InvalidateRect(g_Hwnd, NULL, TRUE);
 		UpdateWindow(g_Hwnd);
 	}
-	else if (resultOffset >= (long long)g_HexData.getFileSize())
+	else if (resultValue >= 0)
 	{
 		MessageBoxA(g_Hwnd, "Offset out of range.", "Error", MB_OK | MB_ICONERROR);
 	}
 #elif defined(__APPLE__)
-	static int resultOffset = -1;
-	resultOffset = -1;
+	static long long resultValue = -1;
+	resultValue = -1;
 
 	SearchDialogs::ShowGoToDialog(
 		g_Hwnd,
 		g_Options.darkMode,
-		[](int offset)
+		[](long long value)
 		{
-			resultOffset = offset;
+			resultValue = value;
 		});
 
-	if (resultOffset >= 0 && resultOffset < (long long)g_HexData.getFileSize())
+	size_t targetOffset = 0;
+	long long resultOffset = -1;
+	if (resultValue >= 0 && g_HexData.resolveGoToTarget((uint64_t)resultValue, &targetOffset))
+		resultOffset = (long long)targetOffset;
+
+	if (resultOffset >= 0)
 	{
 		cursorBytePos = resultOffset;
 		cursorNibblePos = 0;
@@ -942,23 +1190,28 @@ void OnGoTo()
 			[[window contentView]setNeedsDisplay:YES];
 		}
 	}
-	else if (resultOffset >= (long long)g_HexData.getFileSize())
+	else if (resultValue >= 0)
 	{
-		printf("Offset out of range: 0x%X\n", resultOffset);
+		printf("Offset out of range: 0x%llX\n", resultValue);
 	}
 #else
-	static int resultOffset = -1;
-	resultOffset = -1;
+	static long long resultValue = -1;
+	resultValue = -1;
 
 	SearchDialogs::ShowGoToDialog(
 		g_Hwnd,
 		g_Options.darkMode,
-		[](int offset)
+		[](long long value)
 		{
-			resultOffset = offset;
+			resultValue = value;
 		});
 
-	if (resultOffset >= 0 && resultOffset < (long long)g_HexData.getFileSize())
+	size_t targetOffset = 0;
+	long long resultOffset = -1;
+	if (resultValue >= 0 && g_HexData.resolveGoToTarget((uint64_t)resultValue, &targetOffset))
+		resultOffset = (long long)targetOffset;
+
+	if (resultOffset >= 0)
 	{
 		cursorBytePos = resultOffset;
 		cursorNibblePos = 0;
@@ -995,9 +1248,9 @@ void OnGoTo()
 
 		LinuxRedraw();
 	}
-	else if (resultOffset >= (long long)g_HexData.getFileSize())
+	else if (resultValue >= 0)
 	{
-		printf("Offset out of range: 0x%X\n", resultOffset);
+		printf("Offset out of range: 0x%llX\n", resultValue);
 	}
 #endif
 }
@@ -1049,7 +1302,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 		if (wParam == 1)
 		{
 			caretVisible = !caretVisible;
-			if (g_PatternSearch.hasFocus || cursorBytePos >= 0)
+			if (g_HexData.pollMemoryWatch() || g_PatternSearch.hasFocus || cursorBytePos >= 0)
 			{
 				InvalidateRect(hwnd, NULL, FALSE);
 			}
@@ -1099,6 +1352,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 		char path[MAX_PATH];
 		if (DragQueryFileA(hDrop, 0, path, MAX_PATH))
 		{
+			Project_Save(g_CurrentFilePath);
 			if (g_HexData.loadFile(path))
 			{
 				strCopy(g_CurrentFilePath, path);
@@ -1109,6 +1363,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
 				g_TotalLines = (int)g_HexData.getHexLines().count;
 				g_ScrollY = 0;
+				Project_Load(g_CurrentFilePath);
 
 				InvalidateRect(hwnd, NULL, FALSE);
 			}
@@ -1462,6 +1717,18 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			SetCursor(LoadCursor(NULL, IDC_ARROW));
 		}
 
+		long long hoverByte = -1;
+		if (g_Renderer.IsPointInHexArea(x, y, g_LeftPanel.visible ? g_LeftPanel.width : 0,
+			g_MenuBar.getHeight(), windowWidth, windowHeight))
+		{
+			hoverByte = g_Renderer.GetHexBytePositionInfo(Point(x, y)).Index;
+		}
+
+		if (PluginAnnotations_UpdateHover(hoverByte))
+		{
+			InvalidateRect(hwnd, NULL, FALSE);
+		}
+
 		if (g_MenuBar.handleMouseMove(x, y))
 		{
 			InvalidateRect(hwnd, NULL, FALSE);
@@ -1652,14 +1919,15 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 				BottomPanelState::Tab::EntropyAnalysis,
 				BottomPanelState::Tab::PatternSearch,
 				BottomPanelState::Tab::Checksum,
-				BottomPanelState::Tab::Compare};
+				BottomPanelState::Tab::Compare,
+				BottomPanelState::Tab::ByteMap};
 
 			if (isVertical)
 			{
 				int tabY = tabStartY;
 				int tabWidth = bottomBounds.width - 10;
 
-				for (int i = 0; i < 4; i++)
+				for (int i = 0; i < 5; i++)
 				{
 					if (x >= bottomBounds.x + 5 &&
 						x <= bottomBounds.x + 5 + tabWidth &&
@@ -1685,11 +1953,12 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 						"Entropy Analysis",
 						"Hex Pattern Search",
 						"Checksum",
-						"Compare"};
+						"Compare",
+						"Byte Map"};
 
 					int tabX = bottomBounds.x + 10;
 
-					for (int i = 0; i < 4; i++)
+					for (int i = 0; i < 5; i++)
 					{
 						int tabWidth = strLen(tabLabels[i]) * 8 + 20;
 
@@ -2422,7 +2691,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 		const LineArray& allLines = g_HexData.getHexLines();
 		g_TotalLines = (int)allLines.count;
 
-		if (g_HexData.hasDisassemblyPlugin() && g_HexData.getFileSize() > 0)
+		if (g_HexData.getFileSize() > 0)
 		{
 			int startLine = g_ScrollY;
 			int endLine = g_ScrollY + g_LinesPerPage + 1;
@@ -2433,7 +2702,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			if (endOffset > g_HexData.getFileSize())
 				endOffset = g_HexData.getFileSize();
 
-			size_t chunkSize = endOffset - startOffset;
+			size_t chunkSize = endOffset > startOffset ? endOffset - startOffset : 0;
 
 			if (chunkSize > 0 && !g_HexData.isRangeDisassembled(startOffset, endOffset))
 			{
@@ -2674,6 +2943,7 @@ extern "C" void entry()
 			ApplyEnabledPlugins();
 
 			g_TotalLines = (int)g_HexData.getHexLines().count;
+			Project_Load(g_CurrentFilePath);
 		}
 	}
 
@@ -2731,6 +3001,7 @@ extern "C" void entry()
 		DispatchMessageA(&msg);
 	}
 
+	Project_Save(g_CurrentFilePath);
 	SaveOptionsToFile(g_Options);
 	ExitProcess(0);
 }
@@ -2827,7 +3098,7 @@ extern "C" void entry()
 	if (g_LinesPerPage < 1)
 		g_LinesPerPage = 1;
 
-	if (g_HexData.hasDisassemblyPlugin() && g_HexData.getFileSize() > 0)
+	if (g_HexData.getFileSize() > 0)
 	{
 		int startLine = g_ScrollY;
 		int endLine = g_ScrollY + g_LinesPerPage + 1;
@@ -2837,7 +3108,7 @@ extern "C" void entry()
 		if (endOffset > g_HexData.getFileSize())
 			endOffset = g_HexData.getFileSize();
 
-		size_t chunkSize = endOffset - startOffset;
+		size_t chunkSize = endOffset > startOffset ? endOffset - startOffset : 0;
 
 		if (chunkSize > 0 && !g_HexData.isRangeDisassembled(startOffset, endOffset))
 		{
@@ -2982,7 +3253,8 @@ extern "C" void entry()
 				BottomPanelState::Tab::EntropyAnalysis,
 				BottomPanelState::Tab::PatternSearch,
 				BottomPanelState::Tab::Checksum,
-				BottomPanelState::Tab::Compare
+				BottomPanelState::Tab::Compare,
+				BottomPanelState::Tab::ByteMap
 		};
 
 		if (isVertical)
@@ -2990,7 +3262,7 @@ extern "C" void entry()
 			int tabY = tabStartY;
 			int tabWidth = bottomBounds.width - 10;
 
-			for (int i = 0; i < 4; i++)
+			for (int i = 0; i < 5; i++)
 			{
 				if (x >= bottomBounds.x + 5 &&
 					x <= bottomBounds.x + 5 + tabWidth &&
@@ -3012,12 +3284,13 @@ extern "C" void entry()
 						"Entropy Analysis",
 						"Hex Pattern Search",
 						"Checksum",
-						"Compare"
+						"Compare",
+						"Byte Map"
 				};
 
 				int tabX = bottomBounds.x + 10;
 
-				for (int i = 0; i < 4; i++)
+				for (int i = 0; i < 5; i++)
 				{
 					int tabWidth = strLen(tabLabels[i]) * 8 + 20;
 
@@ -3445,6 +3718,19 @@ extern "C" void entry()
 		}
 	}
 
+	NSRect bounds = [self bounds];
+	long long hoverByte = -1;
+	if (g_Renderer.IsPointInHexArea(x, y, g_LeftPanel.visible ? g_LeftPanel.width : 0,
+		g_MenuBar.getHeight(), (int)bounds.size.width, (int)bounds.size.height))
+	{
+		hoverByte = g_Renderer.GetHexBytePositionInfo(Point(x, y)).Index;
+	}
+
+	if (PluginAnnotations_UpdateHover(hoverByte))
+	{
+		[self setNeedsDisplay:YES] ;
+	}
+
 	if (g_MenuBar.handleMouseMove(x, y))
 	{
 		[self setNeedsDisplay:YES] ;
@@ -3726,6 +4012,7 @@ extern "C" void entry()
 			strCopy(g_CurrentFilePath, filename);
 			ApplyEnabledPlugins();
 			g_TotalLines = (int)g_HexData.getHexLines().count;
+			Project_Load(g_CurrentFilePath);
 		}
 	}
 
@@ -3764,6 +4051,7 @@ extern "C" void entry()
 
 - (void)applicationWillTerminate : (NSNotification*)notification
 {
+	Project_Save(g_CurrentFilePath);
 	SaveOptionsToFile(g_Options);
 	g_Renderer.cleanup();
 }
@@ -4136,14 +4424,15 @@ void HandleLinuxMouseButton(XButtonEvent* event, bool pressed)
 					BottomPanelState::Tab::EntropyAnalysis,
 					BottomPanelState::Tab::PatternSearch,
 					BottomPanelState::Tab::Checksum,
-					BottomPanelState::Tab::Compare };
+					BottomPanelState::Tab::Compare,
+					BottomPanelState::Tab::ByteMap };
 
 				if (isVertical)
 				{
 					int tabY = tabStartY;
 					int tabWidth = bottomBounds.width - 10;
 
-					for (int i = 0; i < 4; i++)
+					for (int i = 0; i < 5; i++)
 					{
 						if (x >= bottomBounds.x + 5 && x <= bottomBounds.x + 5 + tabWidth &&
 							y >= tabY && y <= tabY + tabHeight - 5)
@@ -4163,11 +4452,12 @@ void HandleLinuxMouseButton(XButtonEvent* event, bool pressed)
 							"Entropy Analysis",
 							"Hex Pattern Search",
 							"Checksum",
-							"Compare" };
+							"Compare",
+							"Byte Map" };
 
 						int tabX = bottomBounds.x + 10;
 
-						for (int i = 0; i < 4; i++)
+						for (int i = 0; i < 5; i++)
 						{
 							int tabWidth = strLen(tabLabels[i]) * 8 + 20;
 
@@ -4447,7 +4737,21 @@ void HandleLinuxMouseMotion(XMotionEvent* event)
 		return;
 	}
 
+	long long hoverByte = -1;
+	if (g_Renderer.IsPointInHexArea(x, y, g_LeftPanel.visible ? g_LeftPanel.width : 0,
+		g_MenuBar.getHeight(), windowWidth, windowHeight))
+	{
+		hoverByte = g_Renderer.GetHexBytePositionInfo(Point(x, y)).Index;
+	}
+
+	bool redraw = PluginAnnotations_UpdateHover(hoverByte);
+
 	if (g_MenuBar.handleMouseMove(x, y))
+	{
+		redraw = true;
+	}
+
+	if (redraw)
 	{
 		LinuxRedraw();
 	}
@@ -4475,6 +4779,24 @@ void LinuxRedraw()
 		g_BottomPanel, windowWidth, windowHeight,
 		menuBarHeight, g_LeftPanel);
 
+	if (g_HexData.getFileSize() > 0)
+	{
+		int startLine = g_ScrollY;
+		int endLine = g_ScrollY + g_LinesPerPage + 1;
+		size_t startOffset = (size_t)startLine * 16;
+		size_t endOffset = (size_t)endLine * 16;
+
+		if (endOffset > g_HexData.getFileSize())
+			endOffset = g_HexData.getFileSize();
+
+		size_t chunkSize = endOffset > startOffset ? endOffset - startOffset : 0;
+
+		if (chunkSize > 0 && !g_HexData.isRangeDisassembled(startOffset, endOffset))
+		{
+			g_HexData.disassembleRange(startOffset, chunkSize);
+		}
+	}
+
 	Vector<char*> hexLines;
 	const LineArray& lines = g_HexData.getHexLines();
 
@@ -4620,6 +4942,7 @@ int main(int argc, char** argv)
 		{
 			CopyString(g_CurrentFilePath, filename, MAX_PATH_LEN);
 			g_TotalLines = (int)g_HexData.getHexLines().count;
+			Project_Load(g_CurrentFilePath);
 		}
 	}
 
@@ -4708,10 +5031,14 @@ int main(int argc, char** argv)
 			}
 		}
 
+		if (g_HexData.pollMemoryWatch())
+			LinuxRedraw();
+
 		usleep(1000);
 	}
 
 
+	Project_Save(g_CurrentFilePath);
 	SaveOptionsToFile(g_Options);
 	XFreeGC(g_display, g_GC);
 	XDestroyWindow(g_display, g_window);
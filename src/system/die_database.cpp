@@ -6,6 +6,7 @@
 #include <windows.h>
 #else
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
 #endif
@@ -109,40 +110,25 @@ bool DIEDatabaseManager::DownloadFile(const char* url, const char* destPath)
 #endif
 
 DIEDatabaseManager::DIEDatabaseManager()
+  : cacheBase(nullptr),
+  cacheSize(0),
+  cacheMapped(false),
+  cacheMapping(nullptr),
+  rebuiltCache(nullptr),
+  rebuiltCacheSize(0),
+  rebuildState(DIE_REBUILD_IDLE)
 {
-  binaryDb.signatures = nullptr;
-  binaryDb.signatureCount = 0;
-  binaryDb.signatureCapacity = 0;
-  binaryDb.loaded = false;
-
-  peDb.signatures = nullptr;
-  peDb.signatureCount = 0;
-  peDb.signatureCapacity = 0;
-  peDb.loaded = false;
-
-  elfDb.signatures = nullptr;
-  elfDb.signatureCount = 0;
-  elfDb.signatureCapacity = 0;
-  elfDb.loaded = false;
-
-  machDb.signatures = nullptr;
-  machDb.signatureCount = 0;
-  machDb.signatureCapacity = 0;
-  machDb.loaded = false;
-
+  memSet(databases, 0, sizeof(databases));
   dbDirectory[0] = '\0';
+#ifndef _WIN32
+  rebuildThreadStarted = false;
+#endif
 }
 
 DIEDatabaseManager::~DIEDatabaseManager()
 {
-  if (binaryDb.signatures)
-    platformFree(binaryDb.signatures);
-  if (peDb.signatures)
-    platformFree(peDb.signatures);
-  if (elfDb.signatures)
-    platformFree(elfDb.signatures);
-  if (machDb.signatures)
-    platformFree(machDb.signatures);
+  FinishRebuild(true);
+  ReleaseCache();
 }
 
 bool DIEDatabaseManager::Initialize(const char* dieExecutablePath)
@@ -299,8 +285,372 @@ bool DIEDatabaseManager::DownloadDatabases(void (*progressCallback)(const char*,
   return true;
 }
 
-bool DIEDatabaseManager::ParseDatabase(const char* dbPath, DIEDatabase& db)
+static bool IsDIECompilerType(const char* type)
+{
+  static const char* const kinds[] = {
+    "compiler", "linker", "packer", "protector", "cryptor", "installer",
+    "sfx", "library", "tool", "joiner", "player", "virtual machine"
+  };
+
+  for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++)
+  {
+    if (strCompareIgnoreCase(type, kinds[i]) == 0)
+      return true;
+  }
+  return false;
+}
+
+static const char* SkipDIESpaces(const char* p)
+{
+  while (*p == ' ' || *p == '\t')
+    p++;
+  return p;
+}
+
+static const char* ReadDIEQuoted(const char* p, const char* end, char* out, int outSize)
 {
+  while (p < end && *p != '"')
+    p++;
+  if (p >= end)
+    return nullptr;
+  p++;
+
+  int count = 0;
+  while (p < end && *p != '"')
+  {
+    char c = *p;
+    if (c == '\\' && p + 1 < end)
+    {
+      p++;
+      c = *p == 'n' ? '\n' : *p == 'r' ? '\r' : *p == 't' ? '\t' : *p;
+    }
+    if (count < outSize - 1)
+      out[count++] = c;
+    p++;
+  }
+  out[count] = '\0';
+  return p < end ? p + 1 : nullptr;
+}
+
+static int ParseDIEOffset(const char* p, const char* end)
+{
+  p = SkipDIESpaces(p);
+  int base = 10;
+  if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+  {
+    base = 16;
+    p += 2;
+  }
+
+  int value = 0;
+  while (p < end && (base == 16 ? isXDigit(*p) : (*p >= '0' && *p <= '9')))
+  {
+    value = value * base + hexDigitToInt(*p);
+    if (value > 0x7FFFFFF)
+      return -1;
+    p++;
+  }
+  return value;
+}
+
+static int CompileDIEPattern(const char* text, uint8_t* pattern, uint8_t* mask)
+{
+  int length = 0;
+  const char* p = text;
+
+  while (*p && length < DIE_MAX_PATTERN)
+  {
+    if (*p == ' ' || *p == '\t')
+    {
+      p++;
+      continue;
+    }
+
+    if (*p == '\'')
+    {
+      p++;
+      while (*p && *p != '\'' && length < DIE_MAX_PATTERN)
+      {
+        pattern[length] = (uint8_t)*p++;
+        mask[length] = 0xFF;
+        length++;
+      }
+      if (*p == '\'')
+        p++;
+      continue;
+    }
+
+    if (!p[1])
+      return -1;
+
+    uint8_t value = 0;
+    uint8_t bits = 0;
+    for (int nibble = 0; nibble < 2; nibble++)
+    {
+      char c = p[nibble];
+      value <<= 4;
+      bits <<= 4;
+      if (isXDigit(c))
+      {
+        value |= (uint8_t)hexDigitToInt(c);
+        bits |= 0x0F;
+      }
+      else if (c != '.' && c != '?' && c != '$' && c != '#')
+      {
+        return -1;
+      }
+    }
+
+    pattern[length] = value & bits;
+    mask[length] = bits;
+    length++;
+    p += 2;
+  }
+
+  return *p ? -1 : length;
+}
+
+struct DIEBuilder
+{
+  DIESignature* signatures;
+  int signatureCount;
+  int signatureCapacity;
+  Vector<DIEAnchorGroup> groups;
+  Vector<int> anchored;
+  Vector<int> unanchored;
+};
+
+static bool AddDIESignature(DIEBuilder& db, const char* type, const char* name,
+  const char* pattern, int offset)
+{
+  if (offset < 0 || !name[0])
+    return false;
+
+  if (db.signatureCount == db.signatureCapacity)
+  {
+    int capacity = db.signatureCapacity ? db.signatureCapacity * 2 : DIE_INITIAL_CAPACITY;
+    DIESignature* grown = (DIESignature*)platformAlloc(sizeof(DIESignature) * capacity);
+    if (!grown)
+      return false;
+    if (db.signatures)
+    {
+      memCopy(grown, db.signatures, sizeof(DIESignature) * db.signatureCount);
+      platformFree(db.signatures, sizeof(DIESignature) * db.signatureCapacity);
+    }
+    db.signatures = grown;
+    db.signatureCapacity = capacity;
+  }
+
+  DIESignature& sig = db.signatures[db.signatureCount];
+  sig.patternLength = CompileDIEPattern(pattern, sig.pattern, sig.mask);
+  if (sig.patternLength <= 0)
+    return false;
+
+  stringCopy(sig.type, type, sizeof(sig.type));
+  stringCopy(sig.name, name, sizeof(sig.name));
+  sig.offset = offset;
+  db.signatureCount++;
+  return true;
+}
+
+// Accepts plain "type;name;offset;pattern" lines as well as the
+// init("type","name") / Binary.compare("pattern",offset) calls of DIE
+// signature scripts. Checks that need the script engine are skipped.
+static bool ParseDIESignatures(const char* text, DIEBuilder& db)
+{
+  char type[64] = "";
+  char name[256] = "";
+  char pattern[DIE_MAX_PATTERN * 4];
+
+  const char* line = text;
+  while (*line)
+  {
+    const char* end = line;
+    while (*end && *end != '\n')
+      end++;
+    const char* next = *end ? end + 1 : end;
+    while (end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+      end--;
+
+    line = SkipDIESpaces(line);
+    if (line >= end || *line == '#' || (line[0] == '/' && line[1] == '/'))
+    {
+      line = next;
+      continue;
+    }
+
+    bool scripted = false;
+    for (const char* p = line; p < end; p++)
+    {
+      if (startsWith(p, "init(") && (p == line || p[-1] == ' ' || p[-1] == '\t' || p[-1] == ';'))
+      {
+        const char* q = ReadDIEQuoted(p + 5, end, type, sizeof(type));
+        if (q)
+          ReadDIEQuoted(q, end, name, sizeof(name));
+        scripted = true;
+      }
+      else if (startsWith(p, "compare(") && p > line && p[-1] == '.')
+      {
+        const char* q = ReadDIEQuoted(p + 8, end, pattern, sizeof(pattern));
+        scripted = true;
+        if (!q)
+          continue;
+
+        int offset = 0;
+        q = SkipDIESpaces(q);
+        if (q < end && *q == ',')
+          offset = ParseDIEOffset(q + 1, end);
+        AddDIESignature(db, type, name, pattern, offset);
+      }
+    }
+
+    if (!scripted)
+    {
+      const char* fields[4];
+      int lengths[4];
+      int count = 0;
+      const char* start = line;
+      for (const char* p = line; p <= end && count < 4; p++)
+      {
+        if (p == end || (*p == ';' && count < 3))
+        {
+          fields[count] = start;
+          lengths[count] = (int)(p - start);
+          count++;
+          start = p + 1;
+        }
+      }
+
+      if (count == 4)
+      {
+        char lineType[64];
+        char lineName[256];
+        int typeLength = lengths[0] < 63 ? lengths[0] : 63;
+        int nameLength = lengths[1] < 255 ? lengths[1] : 255;
+        int patternLength = lengths[3] < (int)sizeof(pattern) - 1 ? lengths[3] : (int)sizeof(pattern) - 1;
+
+        memCopy(lineType, fields[0], typeLength);
+        lineType[typeLength] = '\0';
+        memCopy(lineName, fields[1], nameLength);
+        lineName[nameLength] = '\0';
+        memCopy(pattern, fields[3], patternLength);
+        pattern[patternLength] = '\0';
+
+        AddDIESignature(db, lineType, lineName, pattern, ParseDIEOffset(fields[2], fields[2] + lengths[2]));
+      }
+    }
+
+    line = next;
+  }
+
+  return db.signatureCount > 0;
+}
+
+// Signatures are bucketed on one fixed byte ("anchor") at an absolute file
+// offset, so a lookup only verifies signatures whose anchor byte matches.
+static void CompileDIEBuilder(DIEBuilder& db)
+{
+  db.groups.clear();
+  db.anchored.clear();
+  db.unanchored.clear();
+
+  Vector<int> anchorOffsets;
+  Vector<int> anchorGroups;
+  for (int i = 0; i < db.signatureCount; i++)
+  {
+    const DIESignature& sig = db.signatures[i];
+    int anchor = -1;
+    for (int k = 0; k < sig.patternLength; k++)
+    {
+      if (sig.mask[k] != 0xFF)
+        continue;
+      if (anchor < 0)
+        anchor = k;
+      if (sig.pattern[k] != 0x00 && sig.pattern[k] != 0xFF)
+      {
+        anchor = k;
+        break;
+      }
+    }
+
+    if (anchor < 0)
+    {
+      db.unanchored.push_back(i);
+      anchorOffsets.push_back(-1);
+      anchorGroups.push_back(-1);
+      continue;
+    }
+
+    int offset = sig.offset + anchor;
+    int group = -1;
+    for (size_t g = 0; g < db.groups.size(); g++)
+    {
+      if (db.groups[g].offset == offset)
+      {
+        group = (int)g;
+        break;
+      }
+    }
+
+    if (group < 0)
+    {
+      DIEAnchorGroup created;
+      created.offset = offset;
+      memSet(created.first, 0, sizeof(created.first));
+      db.groups.push_back(created);
+      group = (int)db.groups.size() - 1;
+    }
+
+    db.groups[group].first[sig.pattern[anchor] + 1]++;
+    anchorOffsets.push_back(anchor);
+    anchorGroups.push_back(group);
+  }
+
+  int total = 0;
+  for (size_t g = 0; g < db.groups.size(); g++)
+  {
+    int* first = db.groups[g].first;
+    first[0] = total;
+    for (int b = 1; b <= 256; b++)
+      first[b] += first[b - 1];
+    total = first[256];
+  }
+
+  for (int i = 0; i < total; i++)
+    db.anchored.push_back(-1);
+
+  Vector<int> fill;
+  for (size_t g = 0; g < db.groups.size(); g++)
+  {
+    for (int b = 0; b < 256; b++)
+      fill.push_back(db.groups[g].first[b]);
+  }
+
+  for (int i = 0; i < db.signatureCount; i++)
+  {
+    if (anchorGroups[i] < 0)
+      continue;
+    uint8_t value = db.signatures[i].pattern[anchorOffsets[i]];
+    int& slot = fill[anchorGroups[i] * 256 + value];
+    db.anchored[slot++] = i;
+  }
+}
+
+static void FreeDIEBuilder(DIEBuilder& db)
+{
+  if (db.signatures)
+    platformFree(db.signatures, sizeof(DIESignature) * db.signatureCapacity);
+  db.signatures = nullptr;
+  db.signatureCount = 0;
+  db.signatureCapacity = 0;
+  db.groups.clear();
+  db.anchored.clear();
+  db.unanchored.clear();
+}
+
+static bool ParseDIEFile(const char* dbPath, DIEBuilder& db)
+{
+
 #ifdef _WIN32
   HANDLE hFile = CreateFileA(
     dbPath,
@@ -339,16 +689,6 @@ bool DIEDatabaseManager::ParseDatabase(const char* dbPath, DIEDatabase& db)
 
   fileData[fileSize] = '\0';
   CloseHandle(hFile);
-
-  db.signatureCapacity = 100;
-  db.signatures = (DIESignature*)platformAlloc(sizeof(DIESignature) * db.signatureCapacity);
-  db.signatureCount = 0;
-
-  db.loaded = true;
-
-  platformFree(fileData);
-  return true;
-
 #else
   int fd = open(dbPath, O_RDONLY);
   if (fd < 0)
@@ -356,6 +696,11 @@ bool DIEDatabaseManager::ParseDatabase(const char* dbPath, DIEDatabase& db)
 
   off_t fileSize = lseek(fd, 0, SEEK_END);
   lseek(fd, 0, SEEK_SET);
+  if (fileSize < 0)
+  {
+    close(fd);
+    return false;
+  }
 
   char* fileData = (char*)platformAlloc(fileSize + 1);
   if (!fileData)
@@ -364,138 +709,719 @@ bool DIEDatabaseManager::ParseDatabase(const char* dbPath, DIEDatabase& db)
     return false;
   }
 
-  read(fd, fileData, fileSize);
-  fileData[fileSize] = '\0';
+  off_t total = 0;
+  while (total < fileSize)
+  {
+    ssize_t got = read(fd, fileData + total, fileSize - total);
+    if (got <= 0)
+      break;
+    total += got;
+  }
+  fileData[total] = '\0';
   close(fd);
+#endif
 
-  db.signatureCapacity = 100;
-  db.signatures = (DIESignature*)platformAlloc(sizeof(DIESignature) * db.signatureCapacity);
-  db.signatureCount = 0;
-  db.loaded = true;
+  ParseDIESignatures(fileData, db);
+  CompileDIEBuilder(db);
 
   platformFree(fileData);
   return true;
+}
+
+struct DIECacheSource
+{
+  uint64_t size;
+  uint64_t modified;
+};
+
+struct DIECacheSection
+{
+  uint64_t signatures;
+  uint64_t groups;
+  uint64_t anchored;
+  uint64_t unanchored;
+  uint32_t signatureCount;
+  uint32_t groupCount;
+  uint32_t anchoredCount;
+  uint32_t unanchoredCount;
+};
+
+struct DIECacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t signatureSize;
+  uint32_t groupSize;
+  uint32_t databaseCount;
+  uint64_t totalSize;
+  DIECacheSource sources[DIE_DB_COUNT];
+  DIECacheSection sections[DIE_DB_COUNT];
+};
+
+static const char kDIECacheMagic[8] = { 'H', 'V', 'D', 'I', 'E', 'S', 'I', 'G' };
+
+static const char* const kDIEDatabaseFiles[DIE_DB_COUNT] = {
+  "binary.db", "pe.db", "elf.db", "mach.db"
+};
+
+static size_t AlignDIECache(size_t value)
+{
+  return (value + 7) & ~(size_t)7;
+}
+
+static void GetDIESourceStamp(const char* path, DIECacheSource* out)
+{
+  out->size = 0;
+  out->modified = 0;
+
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA info;
+  if (GetFileAttributesExA(path, GetFileExInfoStandard, &info))
+  {
+    out->size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    out->modified = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+  }
+#else
+  struct stat st;
+  if (stat(path, &st) == 0)
+  {
+    out->size = (uint64_t)st.st_size;
+    out->modified = (uint64_t)st.st_mtime;
+  }
 #endif
 }
 
-bool DIEDatabaseManager::LoadDatabases()
+// The cache is one position-independent blob: a header followed by the
+// signature, group and index arrays of each database, addressed by offset.
+static uint8_t* SerializeDIECache(const DIEBuilder* builders, const DIECacheSource* sources, size_t* outSize)
+{
+  DIECacheHeader header;
+  memSet(&header, 0, sizeof(header));
+  memCopy(header.magic, kDIECacheMagic, sizeof(header.magic));
+  header.version = DIE_CACHE_VERSION;
+  header.signatureSize = sizeof(DIESignature);
+  header.groupSize = sizeof(DIEAnchorGroup);
+  header.databaseCount = DIE_DB_COUNT;
+
+  size_t total = AlignDIECache(sizeof(DIECacheHeader));
+  for (int k = 0; k < DIE_DB_COUNT; k++)
+  {
+    const DIEBuilder& builder = builders[k];
+    DIECacheSection& section = header.sections[k];
+    header.sources[k] = sources[k];
+
+    section.signatureCount = (uint32_t)builder.signatureCount;
+    section.groupCount = (uint32_t)builder.groups.size();
+    section.anchoredCount = (uint32_t)builder.anchored.size();
+    section.unanchoredCount = (uint32_t)builder.unanchored.size();
+
+    section.signatures = total;
+    total = AlignDIECache(total + sizeof(DIESignature) * section.signatureCount);
+    section.groups = total;
+    total = AlignDIECache(total + sizeof(DIEAnchorGroup) * section.groupCount);
+    section.anchored = total;
+    total = AlignDIECache(total + sizeof(int) * section.anchoredCount);
+    section.unanchored = total;
+    total = AlignDIECache(total + sizeof(int) * section.unanchoredCount);
+  }
+  header.totalSize = total;
+
+  uint8_t* blob = (uint8_t*)platformAlloc(total);
+  if (!blob)
+    return nullptr;
+
+  memSet(blob, 0, total);
+  memCopy(blob, &header, sizeof(header));
+  for (int k = 0; k < DIE_DB_COUNT; k++)
+  {
+    const DIEBuilder& builder = builders[k];
+    const DIECacheSection& section = header.sections[k];
+    if (section.signatureCount)
+      memCopy(blob + section.signatures, builder.signatures, sizeof(DIESignature) * section.signatureCount);
+    for (uint32_t i = 0; i < section.groupCount; i++)
+      memCopy(blob + section.groups + i * sizeof(DIEAnchorGroup), &builder.groups[i], sizeof(DIEAnchorGroup));
+    for (uint32_t i = 0; i < section.anchoredCount; i++)
+      memCopy(blob + section.anchored + i * sizeof(int), &builder.anchored[i], sizeof(int));
+    for (uint32_t i = 0; i < section.unanchoredCount; i++)
+      memCopy(blob + section.unanchored + i * sizeof(int), &builder.unanchored[i], sizeof(int));
+  }
+
+  *outSize = total;
+  return blob;
+}
+
+static bool WriteDIECache(const char* path, const uint8_t* data, size_t size)
+{
+  char tempPath[520];
+  strCopy(tempPath, path);
+  strCat(tempPath, ".tmp");
+
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(tempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD written = 0;
+  bool ok = WriteFile(hFile, data, (DWORD)size, &written, NULL) && written == size;
+  CloseHandle(hFile);
+
+  if (!ok || !MoveFileExA(tempPath, path, MOVEFILE_REPLACE_EXISTING))
+  {
+    DeleteFileA(tempPath);
+    return false;
+  }
+  return true;
+#else
+  int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+
+  size_t done = 0;
+  while (done < size)
+  {
+    ssize_t w = write(fd, data + done, size - done);
+    if (w <= 0)
+      break;
+    done += (size_t)w;
+  }
+  close(fd);
+
+  if (done != size || rename(tempPath, path) != 0)
+  {
+    unlink(tempPath);
+    return false;
+  }
+  return true;
+#endif
+}
+
+static bool DIECacheRangeValid(const DIECacheHeader* header, uint64_t offset, uint64_t count, uint64_t itemSize)
 {
-  char dbPath[512];
+  return offset % 8 == 0 && offset <= header->totalSize &&
+    count <= (header->totalSize - offset) / itemSize;
+}
 
-  strCopy(dbPath, dbDirectory);
+void DIEDatabaseManager::GetDatabasePath(int kind, char* outPath) const
+{
+  strCopy(outPath, dbDirectory);
 #ifdef _WIN32
-  strCat(dbPath, "\\binary.db");
+  strCat(outPath, "\\");
 #else
-  strCat(dbPath, "/binary.db");
+  strCat(outPath, "/");
 #endif
-  ParseDatabase(dbPath, binaryDb);
+  strCat(outPath, kDIEDatabaseFiles[kind]);
+}
 
-  strCopy(dbPath, dbDirectory);
+void DIEDatabaseManager::GetCachePath(char* outPath) const
+{
+  strCopy(outPath, dbDirectory);
 #ifdef _WIN32
-  strCat(dbPath, "\\pe.db");
+  strCat(outPath, "\\" DIE_CACHE_FILE);
 #else
-  strCat(dbPath, "/pe.db");
+  strCat(outPath, "/" DIE_CACHE_FILE);
 #endif
-  ParseDatabase(dbPath, peDb);
+}
 
-  strCopy(dbPath, dbDirectory);
+bool DIEDatabaseManager::MapCache(const char* path)
+{
 #ifdef _WIN32
-  strCat(dbPath, "\\elf.db");
+  HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize;
+  HANDLE mapping = NULL;
+  if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart >= (LONGLONG)sizeof(DIECacheHeader))
+    mapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(hFile);
+  if (!mapping)
+    return false;
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view)
+  {
+    CloseHandle(mapping);
+    return false;
+  }
+
+  cacheMapping = mapping;
+  cacheSize = (size_t)fileSize.QuadPart;
 #else
-  strCat(dbPath, "/elf.db");
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  void* view = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(DIECacheHeader))
+    view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED)
+    return false;
+
+  cacheSize = (size_t)st.st_size;
 #endif
-  ParseDatabase(dbPath, elfDb);
 
-  strCopy(dbPath, dbDirectory);
+  cacheBase = (const uint8_t*)view;
+  cacheMapped = true;
+  return true;
+}
+
+bool DIEDatabaseManager::BindCache(const uint8_t* base, size_t size, bool* outStale)
+{
+  const DIECacheHeader* header = (const DIECacheHeader*)base;
+  if (size < sizeof(DIECacheHeader))
+    return false;
+
+  for (size_t i = 0; i < sizeof(kDIECacheMagic); i++)
+  {
+    if (header->magic[i] != kDIECacheMagic[i])
+      return false;
+  }
+
+  if (header->version != DIE_CACHE_VERSION ||
+    header->signatureSize != sizeof(DIESignature) ||
+    header->groupSize != sizeof(DIEAnchorGroup) ||
+    header->databaseCount != DIE_DB_COUNT ||
+    header->totalSize != size)
+  {
+    return false;
+  }
+
+  for (int k = 0; k < DIE_DB_COUNT; k++)
+  {
+    const DIECacheSection& section = header->sections[k];
+    if (!DIECacheRangeValid(header, section.signatures, section.signatureCount, sizeof(DIESignature)) ||
+      !DIECacheRangeValid(header, section.groups, section.groupCount, sizeof(DIEAnchorGroup)) ||
+      !DIECacheRangeValid(header, section.anchored, section.anchoredCount, sizeof(int)) ||
+      !DIECacheRangeValid(header, section.unanchored, section.unanchoredCount, sizeof(int)))
+    {
+      return false;
+    }
+
+    const DIESignature* signatures = (const DIESignature*)(base + section.signatures);
+    for (uint32_t i = 0; i < section.signatureCount; i++)
+    {
+      if (signatures[i].patternLength <= 0 || signatures[i].patternLength > DIE_MAX_PATTERN ||
+        signatures[i].offset < 0)
+      {
+        return false;
+      }
+    }
+
+    const DIEAnchorGroup* groups = (const DIEAnchorGroup*)(base + section.groups);
+    for (uint32_t g = 0; g < section.groupCount; g++)
+    {
+      if (groups[g].offset < 0 || groups[g].first[0] < 0 || groups[g].first[256] > (int)section.anchoredCount)
+        return false;
+      for (int b = 0; b < 256; b++)
+      {
+        if (groups[g].first[b] > groups[g].first[b + 1])
+          return false;
+      }
+    }
+
+    const int* anchored = (const int*)(base + section.anchored);
+    for (uint32_t i = 0; i < section.anchoredCount; i++)
+    {
+      if (anchored[i] < 0 || anchored[i] >= (int)section.signatureCount)
+        return false;
+    }
+
+    const int* unanchored = (const int*)(base + section.unanchored);
+    for (uint32_t i = 0; i < section.unanchoredCount; i++)
+    {
+      if (unanchored[i] < 0 || unanchored[i] >= (int)section.signatureCount)
+        return false;
+    }
+  }
+
+  bool stale = false;
+  for (int k = 0; k < DIE_DB_COUNT; k++)
+  {
+    const DIECacheSection& section = header->sections[k];
+    DIEDatabase& db = databases[k];
+    db.signatures = (const DIESignature*)(base + section.signatures);
+    db.signatureCount = (int)section.signatureCount;
+    db.groups = (const DIEAnchorGroup*)(base + section.groups);
+    db.groupCount = (int)section.groupCount;
+    db.anchored = (const int*)(base + section.anchored);
+    db.unanchored = (const int*)(base + section.unanchored);
+    db.unanchoredCount = (int)section.unanchoredCount;
+    db.loaded = header->sources[k].size > 0;
+
+    char path[512];
+    DIECacheSource current;
+    GetDatabasePath(k, path);
+    GetDIESourceStamp(path, &current);
+    if (current.size != header->sources[k].size || current.modified != header->sources[k].modified)
+      stale = true;
+  }
+
+  if (outStale)
+    *outStale = stale;
+  return true;
+}
+
+void DIEDatabaseManager::ReleaseCache()
+{
+  memSet(databases, 0, sizeof(databases));
+
+  if (!cacheBase)
+    return;
+
+  if (cacheMapped)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(cacheBase);
+    CloseHandle((HANDLE)cacheMapping);
+#else
+    munmap((void*)cacheBase, cacheSize);
+#endif
+  }
+  else
+  {
+    platformFree((void*)cacheBase, cacheSize);
+  }
+
+  cacheBase = nullptr;
+  cacheSize = 0;
+  cacheMapped = false;
+  cacheMapping = nullptr;
+}
+
+void DIEDatabaseManager::RunRebuild()
+{
+  DIEBuilder builders[DIE_DB_COUNT];
+  DIECacheSource sources[DIE_DB_COUNT];
+
+  for (int k = 0; k < DIE_DB_COUNT; k++)
+  {
+    builders[k].signatures = nullptr;
+    builders[k].signatureCount = 0;
+    builders[k].signatureCapacity = 0;
+
+    char path[512];
+    GetDatabasePath(k, path);
+    GetDIESourceStamp(path, &sources[k]);
+    if (sources[k].size > 0)
+      ParseDIEFile(path, builders[k]);
+  }
+
+  size_t size = 0;
+  uint8_t* blob = SerializeDIECache(builders, sources, &size);
+  for (int k = 0; k < DIE_DB_COUNT; k++)
+    FreeDIEBuilder(builders[k]);
+
+  if (blob)
+  {
+    char cachePath[512];
+    GetCachePath(cachePath);
+    WriteDIECache(cachePath, blob, size);
+  }
+
+  rebuiltCache = blob;
+  rebuiltCacheSize = size;
+
+#ifdef _WIN32
+  InterlockedExchange(&rebuildState, DIE_REBUILD_DONE);
+#else
+  __atomic_store_n(&rebuildState, DIE_REBUILD_DONE, __ATOMIC_RELEASE);
+#endif
+}
+
 #ifdef _WIN32
-  strCat(dbPath, "\\mach.db");
+DWORD WINAPI DIEDatabaseManager::RebuildThreadMain(LPVOID param)
+{
+  ((DIEDatabaseManager*)param)->RunRebuild();
+  return 0;
+}
 #else
-  strCat(dbPath, "/mach.db");
+void* DIEDatabaseManager::RebuildThreadMain(void* param)
+{
+  ((DIEDatabaseManager*)param)->RunRebuild();
+  return nullptr;
+}
 #endif
-  ParseDatabase(dbPath, machDb);
+
+bool DIEDatabaseManager::StartRebuild()
+{
+  if (rebuildState != DIE_REBUILD_IDLE)
+    return false;
+
+  rebuildState = DIE_REBUILD_RUNNING;
+
+#ifdef _WIN32
+  rebuildThread = CreateThread(NULL, 0, RebuildThreadMain, this, 0, NULL);
+  bool started = rebuildThread != NULL;
+#else
+  bool started = pthread_create(&rebuildThread, nullptr, RebuildThreadMain, this) == 0;
+  rebuildThreadStarted = started;
+#endif
+
+  if (!started)
+  {
+    RunRebuild();
+#ifdef _WIN32
+    rebuildThread = NULL;
+#endif
+  }
+
+  return started;
+}
+
+void DIEDatabaseManager::FinishRebuild(bool wait)
+{
+  if (rebuildState == DIE_REBUILD_IDLE)
+    return;
+
+#ifdef _WIN32
+  if (!wait && rebuildState != DIE_REBUILD_DONE)
+    return;
+
+  if (rebuildThread)
+  {
+    WaitForSingleObject(rebuildThread, INFINITE);
+    CloseHandle(rebuildThread);
+    rebuildThread = NULL;
+  }
+#else
+  if (!wait && __atomic_load_n(&rebuildState, __ATOMIC_ACQUIRE) != DIE_REBUILD_DONE)
+    return;
+
+  if (rebuildThreadStarted)
+  {
+    pthread_join(rebuildThread, nullptr);
+    rebuildThreadStarted = false;
+  }
+#endif
+
+  rebuildState = DIE_REBUILD_IDLE;
+
+  if (!rebuiltCache)
+    return;
+
+  ReleaseCache();
+  if (BindCache(rebuiltCache, rebuiltCacheSize, nullptr))
+  {
+    cacheBase = rebuiltCache;
+    cacheSize = rebuiltCacheSize;
+    cacheMapped = false;
+  }
+  else
+  {
+    platformFree(rebuiltCache, rebuiltCacheSize);
+  }
+
+  rebuiltCache = nullptr;
+  rebuiltCacheSize = 0;
+}
+
+// Startup maps the compiled cache and is ready immediately; when the cache
+// is missing or older than the .db sources it is rebuilt on a worker thread
+// and swapped in by the next AnalyzeFile call.
+bool DIEDatabaseManager::LoadDatabases()
+{
+  FinishRebuild(true);
+  ReleaseCache();
+
+  char cachePath[512];
+  GetCachePath(cachePath);
+
+  bool stale = true;
+  if (MapCache(cachePath) && !BindCache(cacheBase, cacheSize, &stale))
+  {
+    ReleaseCache();
+    stale = true;
+  }
+
+  if (stale)
+    StartRebuild();
 
   return true;
 }
 
-bool DIEDatabaseManager::MatchSignature(const uint8_t* data, size_t dataSize, const DIESignature& sig)
+int DIEDatabaseManager::GetSignatureCount() const
+{
+  int count = 0;
+  for (int k = 0; k < DIE_DB_COUNT; k++)
+    count += databases[k].signatureCount;
+  return count;
+}
+
+bool DIEDatabaseManager::MatchSignature(const uint8_t* data, size_t dataSize, const DIESignature& sig) const
 {
-  if (sig.offset + sig.patternLength > (int)dataSize)
+  if ((size_t)sig.offset + (size_t)sig.patternLength > dataSize)
     return false;
 
+  const uint8_t* p = data + sig.offset;
   for (int i = 0; i < sig.patternLength; i++)
   {
-    if (data[sig.offset + i] != sig.pattern[i])
+    if ((p[i] & sig.mask[i]) != sig.pattern[i])
       return false;
   }
 
   return true;
 }
 
-bool DIEDatabaseManager::AnalyzeFile(const uint8_t* data, size_t dataSize,
-  char* outType, char* outCompiler, char* outArch)
+void DIEDatabaseManager::MatchDatabase(const uint8_t* data, size_t dataSize, const DIEDatabase& db,
+  DIEMatch& match) const
 {
-  if (!data || dataSize < 4)
-    return false;
+  if (!db.loaded || db.signatureCount == 0)
+    return;
 
-  if (data[0] == 0x4D && data[1] == 0x5A)
+  int typeIndex = -1;
+  int compilerIndex = -1;
+
+  for (int g = 0; g < db.groupCount; g++)
   {
-    strCopy(outType, "PE Executable");
+    const DIEAnchorGroup& group = db.groups[g];
+    if ((size_t)group.offset >= dataSize)
+      continue;
 
-    if (dataSize > 0x3C + 4)
+    uint8_t value = data[group.offset];
+    for (int k = group.first[value]; k < group.first[value + 1]; k++)
     {
-      uint32_t peOffset = *(uint32_t*)(data + 0x3C);
-      if (peOffset < dataSize - 4 &&
-        data[peOffset] == 'P' && data[peOffset + 1] == 'E')
+      int index = db.anchored[k];
+      bool compiler = IsDIECompilerType(db.signatures[index].type);
+      int& best = compiler ? compilerIndex : typeIndex;
+      if ((best < 0 || index < best) && MatchSignature(data, dataSize, db.signatures[index]))
+        best = index;
+    }
+  }
+
+  for (int k = 0; k < db.unanchoredCount; k++)
+  {
+    int index = db.unanchored[k];
+    bool compiler = IsDIECompilerType(db.signatures[index].type);
+    int& best = compiler ? compilerIndex : typeIndex;
+    if ((best < 0 || index < best) && MatchSignature(data, dataSize, db.signatures[index]))
+      best = index;
+  }
+
+  if (!match.type && typeIndex >= 0)
+    match.type = &db.signatures[typeIndex];
+  if (!match.compiler && compilerIndex >= 0)
+    match.compiler = &db.signatures[compilerIndex];
+}
+
+static const char* DetectDIEArchitecture(const uint8_t* data, size_t dataSize)
+{
+  if (data[0] == 0x4D && data[1] == 0x5A && dataSize > 0x40)
+  {
+    uint32_t peOffset = *(uint32_t*)(data + 0x3C);
+    if (peOffset < dataSize - 6 && data[peOffset] == 'P' && data[peOffset + 1] == 'E')
+    {
+      switch (data[peOffset + 4] | (data[peOffset + 5] << 8))
       {
-        strCopy(outCompiler, "Microsoft Visual C++");
-        strCopy(outArch, "x86");
-        return true;
+      case 0x014C: return "x86";
+      case 0x8664: return "x86-64";
+      case 0x01C0:
+      case 0x01C4: return "ARM";
+      case 0xAA64: return "ARM64";
       }
     }
+    return "Unknown";
   }
-  else if (data[0] == 0x7F && data[1] == 'E' && data[2] == 'L' && data[3] == 'F')
+
+  if (data[0] == 0x7F && data[1] == 'E' && data[2] == 'L' && data[3] == 'F' && dataSize > 20)
   {
-    strCopy(outType, "ELF Executable");
-    strCopy(outCompiler, "GCC");
+    int machine = data[5] == 2 ? (data[18] << 8) | data[19] : data[18] | (data[19] << 8);
+    switch (machine)
+    {
+    case 3: return "x86";
+    case 62: return "x86-64";
+    case 40: return "ARM";
+    case 183: return "ARM64";
+    case 8: return "MIPS";
+    case 20: return "PowerPC";
+    case 21: return "PowerPC64";
+    case 243: return "RISC-V";
+    }
+    return data[4] == 2 ? "64-bit" : "32-bit";
+  }
 
-    if (dataSize > 4)
+  if (dataSize > 8 && ((data[0] == 0xCE || data[0] == 0xCF) && data[1] == 0xFA && data[2] == 0xED && data[3] == 0xFE))
+  {
+    uint32_t cpu = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+    switch (cpu)
     {
-      if (data[4] == 1)
-        strCopy(outArch, "x86");
-      else if (data[4] == 2)
-        strCopy(outArch, "x86-64");
-      else
-        strCopy(outArch, "Unknown");
+    case 7: return "x86";
+    case 0x01000007: return "x86-64";
+    case 12: return "ARM";
+    case 0x0100000C: return "ARM64";
     }
-    return true;
+    return "Unknown";
+  }
+
+  return "N/A";
+}
+
+bool DIEDatabaseManager::AnalyzeFile(const uint8_t* data, size_t dataSize,
+  char* outType, char* outCompiler, char* outArch)
+{
+  FinishRebuild(false);
+
+  if (!data || dataSize < 4)
+    return false;
+
+  const DIEDatabase* formatDb = nullptr;
+  const char* formatName = nullptr;
+  const char* defaultCompiler = "N/A";
+
+  if (data[0] == 0x4D && data[1] == 0x5A)
+  {
+    formatDb = &databases[DIE_DB_PE];
+    formatName = "PE Executable";
+    defaultCompiler = "Microsoft Visual C++";
   }
-  else if (data[0] == 0xCF && data[1] == 0xFA && data[2] == 0xED && data[3] == 0xFE)
+  else if (data[0] == 0x7F && data[1] == 'E' && data[2] == 'L' && data[3] == 'F')
   {
-    strCopy(outType, "Mach-O Executable");
-    strCopy(outCompiler, "Clang/LLVM");
-    strCopy(outArch, "x86-64");
-    return true;
+    formatDb = &databases[DIE_DB_ELF];
+    formatName = "ELF Executable";
+    defaultCompiler = "GCC";
+  }
+  else if ((data[0] == 0xCF || data[0] == 0xCE) && data[1] == 0xFA && data[2] == 0xED && data[3] == 0xFE)
+  {
+    formatDb = &databases[DIE_DB_MACH];
+    formatName = "Mach-O Executable";
+    defaultCompiler = "Clang/LLVM";
   }
   else if (data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G')
   {
-    strCopy(outType, "PNG Image");
-    strCopy(outCompiler, "N/A");
-    strCopy(outArch, "N/A");
-    return true;
+    formatName = "PNG Image";
   }
   else if (data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
   {
-    strCopy(outType, "JPEG Image");
-    strCopy(outCompiler, "N/A");
-    strCopy(outArch, "N/A");
-    return true;
+    formatName = "JPEG Image";
   }
 
-  strCopy(outType, "Unknown");
-  strCopy(outCompiler, "Unknown");
-  strCopy(outArch, "Unknown");
+  DIEMatch match;
+  match.type = nullptr;
+  match.compiler = nullptr;
 
-  return false;
+  if (formatDb)
+    MatchDatabase(data, dataSize, *formatDb, match);
+  MatchDatabase(data, dataSize, databases[DIE_DB_BINARY], match);
+
+  bool haveSignatures = GetSignatureCount() > 0;
+
+  if (match.type)
+    strCopy(outType, match.type->name);
+  else
+    strCopy(outType, formatName ? formatName : "Unknown");
+
+  if (match.compiler)
+    strCopy(outCompiler, match.compiler->name);
+  else if (formatName && !haveSignatures)
+    strCopy(outCompiler, defaultCompiler);
+  else
+    strCopy(outCompiler, "Unknown");
+
+  strCopy(outArch, formatName || match.type ? DetectDIEArchitecture(data, dataSize) : "Unknown");
+
+  return formatName || match.type || match.compiler;
 }
 
 bool InitializeDIEDatabase(const char* dieExecutablePath)
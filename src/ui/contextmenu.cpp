@@ -8,6 +8,8 @@ extern NSWindow* g_nsWindow;
 #else
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
+#include <stdio.h>
+#include <string.h>
 extern Display* g_display;
 extern Window g_window;
 #endif
@@ -31,6 +33,8 @@ extern long long selectionLength;
 extern size_t editingOffset;
 extern int maxScrolls;
 
+void OnTemplateOpen();
+
 #ifdef _WIN32
 
 HKEY ContextMenuRegistry::GetRootKey(UserRole role)
@@ -562,6 +566,294 @@ void AppContextMenu::show(int x, int y)
     item.id = ID_ADD_BOOKMARK;
     state.items.push_back(item);
   }
+
+  {
+    ContextMenuItem item;
+    item.text = allocString("Carve Embedded Files");
+    item.shortcut = nullptr;
+    item.enabled = hasData && !g_HexData.getProcessSource();
+    item.checked = false;
+    item.separator = false;
+    item.id = ID_CARVE_FILES;
+    state.items.push_back(item);
+  }
+
+  {
+    ContextMenuItem item;
+    item.text = allocString("Extract Strings");
+    item.shortcut = nullptr;
+    item.enabled = hasData && !g_HexData.getProcessSource();
+    item.checked = false;
+    item.separator = false;
+    item.id = ID_EXTRACT_STRINGS;
+    state.items.push_back(item);
+  }
+
+  if (g_HexData.getStrings())
+  {
+    ContextMenuItem item;
+    item.text = allocString("Strings Near Cursor");
+    item.shortcut = nullptr;
+    item.enabled = hasCursor;
+    item.checked = false;
+    item.separator = false;
+    item.id = ID_STRINGS_NEAR_CURSOR;
+    state.items.push_back(item);
+  }
+
+  if (hasData)
+  {
+    ContextMenuItem transformItem;
+    transformItem.text = allocString("Transform");
+    transformItem.shortcut = nullptr;
+    transformItem.enabled = true;
+    transformItem.checked = false;
+    transformItem.separator = false;
+    transformItem.id = ID_TRANSFORM;
+
+    bool fileView = !g_HexData.getProcessSource();
+    struct
+    {
+      const char* text;
+      int id;
+      bool enabled;
+    } entries[] = {
+      {"XOR with Key...", ID_TRANSFORM_XOR, true},
+      {"Add Key...", ID_TRANSFORM_ADD, true},
+      {"Subtract Key...", ID_TRANSFORM_SUB, true},
+      {"Rotate Left...", ID_TRANSFORM_ROTATE_LEFT, true},
+      {"Rotate Right...", ID_TRANSFORM_ROTATE_RIGHT, true},
+      {"Swap 16-bit", ID_TRANSFORM_SWAP16, true},
+      {"Swap 32-bit", ID_TRANSFORM_SWAP32, true},
+      {"Swap 64-bit", ID_TRANSFORM_SWAP64, true},
+      {"Base64 Decode", ID_TRANSFORM_BASE64_DECODE, fileView},
+      {"Base64 Encode", ID_TRANSFORM_BASE64_ENCODE, fileView},
+      {"Hex Decode", ID_TRANSFORM_HEX_DECODE, fileView},
+      {"Hex Encode", ID_TRANSFORM_HEX_ENCODE, fileView},
+    };
+
+    for (size_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+    {
+      ContextMenuItem sub;
+      sub.text = allocString(entries[i].text);
+      sub.shortcut = nullptr;
+      sub.enabled = entries[i].enabled;
+      sub.checked = false;
+      sub.separator = false;
+      sub.id = entries[i].id;
+      transformItem.submenu.push_back(sub);
+    }
+
+    for (int i = 0; i < g_HexData.getPluginCount(); i++)
+    {
+      const char* path = g_HexData.getPluginPath(i);
+      if (!CanPluginTransform(path))
+        continue;
+
+      const char* name = path;
+      for (const char* p = path; *p; p++)
+      {
+        if (*p == '/' || *p == '\\')
+          name = p + 1;
+      }
+
+      ContextMenuItem sub;
+      sub.text = allocString(name);
+      sub.shortcut = nullptr;
+      sub.enabled = true;
+      sub.checked = false;
+      sub.separator = false;
+      sub.id = ID_TRANSFORM_PLUGIN + i;
+      transformItem.submenu.push_back(sub);
+    }
+
+    state.items.push_back(transformItem);
+  }
+
+  if (g_HexData.getTransform())
+  {
+    char description[96];
+    char label[128];
+    g_HexData.getTransform()->describe(description, sizeof(description));
+    strCopy(label, "Commit Transform (");
+    strCat(label, description);
+    strCat(label, ")");
+
+    ContextMenuItem item;
+    item.text = allocString(label);
+    item.shortcut = nullptr;
+    item.enabled = true;
+    item.checked = false;
+    item.separator = false;
+    item.id = ID_COMMIT_TRANSFORM;
+    state.items.push_back(item);
+
+    item.text = allocString("Discard Transform");
+    item.id = ID_DISCARD_TRANSFORM;
+    state.items.push_back(item);
+  }
+
+  {
+    ContextMenuItem item;
+    item.text = allocString("Apply Template...");
+    item.shortcut = nullptr;
+    item.enabled = hasData;
+    item.checked = false;
+    item.separator = false;
+    item.id = ID_APPLY_TEMPLATE;
+    state.items.push_back(item);
+  }
+
+  if (g_HexData.getTemplate())
+  {
+    ContextMenuItem item;
+    item.text = allocString("Clear Template");
+    item.shortcut = nullptr;
+    item.enabled = true;
+    item.checked = false;
+    item.separator = false;
+    item.id = ID_CLEAR_TEMPLATE;
+    state.items.push_back(item);
+  }
+
+  if (g_HexData.getProcessSource() && !g_HexData.getProcessSource()->isDump())
+  {
+    ContextMenuItem commitItem;
+    commitItem.text = allocString("Commit Edits to Process");
+    commitItem.shortcut = nullptr;
+    commitItem.enabled = g_HexData.getProcessSource()->canCommitEdits();
+    commitItem.checked = false;
+    commitItem.separator = false;
+    commitItem.id = ID_COMMIT_PROCESS_EDITS;
+    state.items.push_back(commitItem);
+
+    MemoryWatch* watch = g_HexData.getMemoryWatch();
+    bool watching = g_HexData.isWatchingMemory();
+    int generationCount = watch ? (int)watch->getGenerationCount() : 0;
+    int selectedGeneration = watch ? watch->getSelectedGeneration() : -1;
+    bool live = !watch || watch->isLive();
+
+    ContextMenuItem watchItem;
+    watchItem.text = allocString("Memory Watch");
+    watchItem.shortcut = nullptr;
+    watchItem.enabled = true;
+    watchItem.checked = watching;
+    watchItem.separator = false;
+    watchItem.id = ID_WATCH_MEMORY;
+
+    {
+      ContextMenuItem sub;
+      sub.text = allocString("Watch for Changes");
+      sub.shortcut = nullptr;
+      sub.enabled = true;
+      sub.checked = watching;
+      sub.separator = false;
+      sub.id = ID_WATCH_TOGGLE;
+      watchItem.submenu.push_back(sub);
+    }
+    {
+      ContextMenuItem sub;
+      sub.text = allocString("Previous Generation");
+      sub.shortcut = nullptr;
+      sub.enabled = generationCount > 0 && (live || selectedGeneration > 0);
+      sub.checked = false;
+      sub.separator = false;
+      sub.id = ID_WATCH_PREVIOUS;
+      watchItem.submenu.push_back(sub);
+    }
+    {
+      ContextMenuItem sub;
+      sub.text = allocString("Next Generation");
+      sub.shortcut = nullptr;
+      sub.enabled = !live;
+      sub.checked = false;
+      sub.separator = false;
+      sub.id = ID_WATCH_NEXT;
+      watchItem.submenu.push_back(sub);
+    }
+    {
+      char label[64];
+      strCopy(label, "Live View");
+      if (!live)
+      {
+        char number[16];
+        strCat(label, " (viewing ");
+        itoaDec(selectedGeneration + 1, number, 16);
+        strCat(label, number);
+        strCat(label, "/");
+        itoaDec(generationCount, number, 16);
+        strCat(label, number);
+        strCat(label, ")");
+      }
+
+      ContextMenuItem sub;
+      sub.text = allocString(label);
+      sub.shortcut = nullptr;
+      sub.enabled = !live;
+      sub.checked = live;
+      sub.separator = false;
+      sub.id = ID_WATCH_LIVE;
+      watchItem.submenu.push_back(sub);
+    }
+
+    state.items.push_back(watchItem);
+  }
+
+  if (hasData)
+  {
+    const ValueScanner& scanner = g_HexData.getValueScanner();
+    bool scanned = scanner.hasResults();
+    bool ordered = scanned && scanner.getType() != SCAN_TYPE_STRING;
+
+    char label[64];
+    strCopy(label, "Value Scan");
+    if (scanned)
+    {
+      char number[24];
+      itoaDec((long long)scanner.getCandidateCount(), number, 24);
+      strCat(label, " (");
+      strCat(label, number);
+      strCat(label, " results)");
+    }
+
+    ContextMenuItem scanItem;
+    scanItem.text = allocString(label);
+    scanItem.shortcut = nullptr;
+    scanItem.enabled = true;
+    scanItem.checked = false;
+    scanItem.separator = false;
+    scanItem.id = ID_VALUE_SCAN;
+
+    struct
+    {
+      const char* text;
+      int id;
+      bool enabled;
+    } entries[] = {
+      {"First Scan...", ID_SCAN_FIRST, true},
+      {"Next Scan: Changed", ID_SCAN_CHANGED, scanned},
+      {"Next Scan: Unchanged", ID_SCAN_UNCHANGED, scanned},
+      {"Next Scan: Increased", ID_SCAN_INCREASED, ordered},
+      {"Next Scan: Decreased", ID_SCAN_DECREASED, ordered},
+      {"Next Scan: Equal To...", ID_SCAN_EQUAL, scanned},
+      {"Go to Next Result", ID_SCAN_NEXT_RESULT, scanned && scanner.getCandidateCount() > 0},
+      {"Reset Scan", ID_SCAN_RESET, scanned},
+    };
+
+    for (size_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+    {
+      ContextMenuItem sub;
+      sub.text = allocString(entries[i].text);
+      sub.shortcut = nullptr;
+      sub.enabled = entries[i].enabled;
+      sub.checked = false;
+      sub.separator = false;
+      sub.id = entries[i].id;
+      scanItem.submenu.push_back(sub);
+    }
+
+    state.items.push_back(scanItem);
+  }
 }
 
 void AppContextMenu::hide()
@@ -628,37 +920,158 @@ int AppContextMenu::handleClick(int x, int y, RenderManager *renderer)
   return -1;
 }
 
-static void GoToOffsetCallback(int offset)
+static void MoveCursorToOffset(size_t offset)
 {
-  if (offset >= 0 && offset < (int)g_HexData.getFileSize())
-  {
-    cursorBytePos = offset;
-    editingOffset = offset;
-    cursorNibblePos = 0;
+  cursorBytePos = offset;
+  editingOffset = offset;
+  cursorNibblePos = 0;
 
-    int bytesPerLine = g_HexData.getCurrentBytesPerLine();
-    long long targetLine = offset / bytesPerLine;
+  int bytesPerLine = g_HexData.getCurrentBytesPerLine();
+  long long targetLine = offset / bytesPerLine;
 
-    int maxScroll = g_TotalLines - g_LinesPerPage;
-    if (maxScroll < 0)
-      maxScroll = 0;
+  int maxScroll = g_TotalLines - g_LinesPerPage;
+  if (maxScroll < 0)
+    maxScroll = 0;
 
-    g_ScrollY = (int)(targetLine - g_LinesPerPage / 2);
-    if (g_ScrollY < 0)
-      g_ScrollY = 0;
-    if (g_ScrollY > maxScroll)
-      g_ScrollY = maxScroll;
+  g_ScrollY = (int)(targetLine - g_LinesPerPage / 2);
+  if (g_ScrollY < 0)
+    g_ScrollY = 0;
+  if (g_ScrollY > maxScroll)
+    g_ScrollY = maxScroll;
 
-    if (maxScroll > 0)
-      g_MainScrollbar.position = (float)g_ScrollY / (float)maxScroll;
-    else
-      g_MainScrollbar.position = 0.0f;
+  if (maxScroll > 0)
+    g_MainScrollbar.position = (float)g_ScrollY / (float)maxScroll;
+  else
+    g_MainScrollbar.position = 0.0f;
 
-    int leftPanelWidth = g_LeftPanel.visible ? g_LeftPanel.width : 0;
-    g_Renderer.UpdateHexMetrics(leftPanelWidth, g_MenuBar.getHeight());
+  int leftPanelWidth = g_LeftPanel.visible ? g_LeftPanel.width : 0;
+  g_Renderer.UpdateHexMetrics(leftPanelWidth, g_MenuBar.getHeight());
+
+  InvalidateWindow();
+}
 
+static void GoToOffsetCallback(long long value)
+{
+  size_t offset = 0;
+  if (value >= 0 && g_HexData.resolveGoToTarget((uint64_t)value, &offset))
+    MoveCursorToOffset(offset);
+}
+
+static void ShowScanResult(uint64_t from)
+{
+  if (g_HexData.getProcessSource())
+    g_HexData.getProcessSource()->invalidate();
+
+  uint64_t offset = 0;
+  ValueScanner& scanner = g_HexData.getValueScanner();
+  if (scanner.findNextCandidate(from, &offset) || scanner.findNextCandidate(0, &offset))
+    MoveCursorToOffset((size_t)offset);
+  else
     InvalidateWindow();
+}
+
+static void RunFirstScan(const char* query)
+{
+  ScanValue value;
+  bool unknown = false;
+  if (!query || !ParseScanQuery(query, &value, &unknown))
+    return;
+
+  ScanTarget target;
+  g_HexData.getScanTarget(&target);
+  if (g_HexData.getValueScanner().firstScan(target, value, unknown ? SCAN_UNKNOWN : SCAN_EXACT))
+    ShowScanResult(0);
+}
+
+static void RunNextScan(ScanCompare compare, const char* text)
+{
+  ValueScanner& scanner = g_HexData.getValueScanner();
+
+  ScanValue value;
+  if (compare == SCAN_EXACT && (!text || !ParseScanValue(scanner.getType(), text, &value)))
+    return;
+
+  ScanTarget target;
+  g_HexData.getScanTarget(&target);
+  if (scanner.nextScan(target, compare, compare == SCAN_EXACT ? &value : nullptr))
+    ShowScanResult(0);
+}
+
+static TransformKind g_PendingTransform = TRANSFORM_XOR;
+
+static void ReportTransformError(const char* error)
+{
+#ifdef _WIN32
+  MessageBoxA(g_Hwnd, error, "Transform Error", MB_OK | MB_ICONERROR);
+#elif defined(__APPLE__)
+  NSAlert* alert = [[NSAlert alloc] init];
+  [alert setMessageText:@"Transform Error"];
+  [alert setInformativeText:[NSString stringWithUTF8String:error]];
+  [alert setAlertStyle:NSAlertStyleCritical];
+  [alert runModal];
+#else
+  printf("Transform error: %s\n", error);
+#endif
+}
+
+static void AddTransformStep(TransformKind kind, const char* argument)
+{
+  char error[TRANSFORM_ERROR_LEN];
+  TransformStep step;
+  if (!TransformParseStep(kind, argument, &step, error, sizeof(error)))
+  {
+    ReportTransformError(error);
+    return;
   }
+
+  uint64_t start = selectionLength > 0 ? (uint64_t)cursorBytePos : 0;
+  uint64_t length = selectionLength > 0 ? (uint64_t)selectionLength : g_HexData.getFileSize();
+  TransformPipeline* transform = g_HexData.getTransform();
+  if (transform && selectionLength <= 0)
+  {
+    start = transform->getStart();
+    length = transform->getInputLength();
+  }
+
+  if (!g_HexData.addTransformStep(step, start, length, error, sizeof(error)))
+    ReportTransformError(error);
+  InvalidateWindow();
+}
+
+static void PromptTransformStep(TransformKind kind)
+{
+  const char* prompt = kind == TRANSFORM_ROTATE_LEFT || kind == TRANSFORM_ROTATE_RIGHT
+    ? "Bits to rotate each byte by (1-7):"
+    : "Key as hex bytes (up to 64, e.g. DE AD BE EF):";
+  const char* initial = kind == TRANSFORM_ROTATE_LEFT || kind == TRANSFORM_ROTATE_RIGHT ? "1" : "FF";
+
+  g_PendingTransform = kind;
+#ifdef _WIN32
+  SearchDialogs::ShowInputDialog(
+    g_Hwnd,
+    TransformKindName(kind),
+    prompt,
+    initial,
+    g_Options.darkMode,
+    [](const char* text) { AddTransformStep(g_PendingTransform, text); },
+    nullptr);
+#elif defined(__APPLE__)
+  SearchDialogs::ShowInputDialog(
+    (NativeWindow)g_nsWindow,
+    TransformKindName(kind),
+    prompt,
+    initial,
+    g_Options.darkMode,
+    [](const std::string& text) { AddTransformStep(g_PendingTransform, text.c_str()); });
+#else
+  SearchDialogs::ShowInputDialog(
+    (void*)g_window,
+    TransformKindName(kind),
+    prompt,
+    initial,
+    g_Options.darkMode,
+    [](const std::string& text) { AddTransformStep(g_PendingTransform, text.c_str()); });
+#endif
 }
 
 long long ParseNumber(const char *text, int numberFormat)
@@ -726,6 +1139,14 @@ long long ParseNumber(const char *text, int numberFormat)
 
 void AppContextMenu::executeAction(int actionId)
 {
+  if (actionId >= ID_TRANSFORM_PLUGIN && actionId < ID_TRANSFORM_PLUGIN + MAX_PLUGINS)
+  {
+    const char* path = g_HexData.getPluginPath(actionId - ID_TRANSFORM_PLUGIN);
+    if (path)
+      AddTransformStep(TRANSFORM_PLUGIN, path);
+    return;
+  }
+
   switch (actionId)
   {
   case ID_COPY:
@@ -914,9 +1335,10 @@ void AppContextMenu::executeAction(int actionId)
     SearchDialogs::ShowGoToDialog(
         (NativeWindow)g_nsWindow,
         g_Options.darkMode,
-        [](int offset)
+        [](long long value)
         {
-          if (offset >= 0 && offset < (int)g_HexData.getFileSize())
+          size_t offset = 0;
+          if (value >= 0 && g_HexData.resolveGoToTarget((uint64_t)value, &offset))
           {
             cursorBytePos = offset;
             editingOffset = offset;
@@ -933,9 +1355,10 @@ void AppContextMenu::executeAction(int actionId)
     SearchDialogs::ShowGoToDialog(
         (void *)g_window,
         g_Options.darkMode,
-        [](int offset)
+        [](long long value)
         {
-          if (offset >= 0 && offset < (int)g_HexData.getFileSize())
+          size_t offset = 0;
+          if (value >= 0 && g_HexData.resolveGoToTarget((uint64_t)value, &offset))
           {
             cursorBytePos = offset;
             editingOffset = offset;
@@ -1042,8 +1465,7 @@ void AppContextMenu::executeAction(int actionId)
             int colorIndex = g_Bookmarks.bookmarks.size() % 6;
             newBookmark.color = colors[colorIndex];
 
-            g_Bookmarks.bookmarks.push_back(newBookmark);
-            g_Bookmarks.selectedIndex = g_Bookmarks.bookmarks.size() - 1;
+            g_Bookmarks.selectedIndex = Bookmarks_Insert(newBookmark);
 
             InvalidateWindow();
           }
@@ -1075,8 +1497,7 @@ void AppContextMenu::executeAction(int actionId)
             int colorIndex = g_Bookmarks.bookmarks.size() % 6;
             newBookmark.color = colors[colorIndex];
 
-            g_Bookmarks.bookmarks.push_back(newBookmark);
-            g_Bookmarks.selectedIndex = g_Bookmarks.bookmarks.size() - 1;
+            g_Bookmarks.selectedIndex = Bookmarks_Insert(newBookmark);
 
             InvalidateWindow();
           }
@@ -1107,8 +1528,7 @@ void AppContextMenu::executeAction(int actionId)
             int colorIndex = g_Bookmarks.bookmarks.size() % 6;
             newBookmark.color = colors[colorIndex];
 
-            g_Bookmarks.bookmarks.push_back(newBookmark);
-            g_Bookmarks.selectedIndex = g_Bookmarks.bookmarks.size() - 1;
+            g_Bookmarks.selectedIndex = Bookmarks_Insert(newBookmark);
 
             InvalidateWindow();
           }
@@ -1259,5 +1679,269 @@ void AppContextMenu::executeAction(int actionId)
 
     break;
   }
+
+  case ID_COMMIT_PROCESS_EDITS:
+  {
+    Vector<ProcessWriteFailure> failures;
+    g_HexData.commitProcessEdits(&failures);
+#ifdef __linux__
+    for (size_t i = 0; i < failures.size(); i++)
+    {
+      printf("Failed to write %zu bytes at 0x%llx: %s\n", failures[i].size,
+             (unsigned long long)failures[i].virtualAddress, strerror(failures[i].error));
+    }
+#endif
+    InvalidateWindow();
+    break;
+  }
+
+  case ID_CARVE_FILES:
+  {
+    Vector<CarveResult> results;
+    if (!g_HexData.carveEmbeddedFiles(&results))
+      break;
+
+    Color colors[] = {
+        Color(255, 100, 100),
+        Color(100, 255, 100),
+        Color(100, 100, 255),
+        Color(255, 255, 100),
+        Color(255, 100, 255),
+        Color(100, 255, 255) };
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+      const CarveResult& result = results[i];
+      if (Bookmarks_findAtOffset((long long)result.offset) >= 0)
+        continue;
+
+      Bookmark bookmark;
+      bookmark.byteOffset = (long long)result.offset;
+      strCopy(bookmark.name, CarveFormatName(result.format));
+      char lengthStr[32];
+      itoaDec((long long)result.length, lengthStr, 32);
+      strCat(bookmark.name, result.lengthKnown ? " (" : " (~");
+      strCat(bookmark.name, lengthStr);
+      strCat(bookmark.name, " bytes)");
+      stringCopy(bookmark.description, result.description, sizeof(bookmark.description));
+      bookmark.color = colors[result.format % 6];
+      bookmark.byteValue = g_HexData.getByte((size_t)result.offset);
+      Bookmarks_Insert(bookmark);
+    }
+    InvalidateWindow();
+    break;
+  }
+
+  case ID_EXTRACT_STRINGS:
+    if (!g_HexData.extractStrings())
+      break;
+    Strings_ShowNear(cursorBytePos);
+    break;
+
+  case ID_STRINGS_NEAR_CURSOR:
+    Strings_ShowNear(cursorBytePos);
+    break;
+
+  case ID_TRANSFORM_XOR:
+    PromptTransformStep(TRANSFORM_XOR);
+    break;
+
+  case ID_TRANSFORM_ADD:
+    PromptTransformStep(TRANSFORM_ADD);
+    break;
+
+  case ID_TRANSFORM_SUB:
+    PromptTransformStep(TRANSFORM_SUB);
+    break;
+
+  case ID_TRANSFORM_ROTATE_LEFT:
+    PromptTransformStep(TRANSFORM_ROTATE_LEFT);
+    break;
+
+  case ID_TRANSFORM_ROTATE_RIGHT:
+    PromptTransformStep(TRANSFORM_ROTATE_RIGHT);
+    break;
+
+  case ID_TRANSFORM_SWAP16:
+    AddTransformStep(TRANSFORM_SWAP16, nullptr);
+    break;
+
+  case ID_TRANSFORM_SWAP32:
+    AddTransformStep(TRANSFORM_SWAP32, nullptr);
+    break;
+
+  case ID_TRANSFORM_SWAP64:
+    AddTransformStep(TRANSFORM_SWAP64, nullptr);
+    break;
+
+  case ID_TRANSFORM_BASE64_DECODE:
+    AddTransformStep(TRANSFORM_BASE64_DECODE, nullptr);
+    break;
+
+  case ID_TRANSFORM_BASE64_ENCODE:
+    AddTransformStep(TRANSFORM_BASE64_ENCODE, nullptr);
+    break;
+
+  case ID_TRANSFORM_HEX_DECODE:
+    AddTransformStep(TRANSFORM_HEX_DECODE, nullptr);
+    break;
+
+  case ID_TRANSFORM_HEX_ENCODE:
+    AddTransformStep(TRANSFORM_HEX_ENCODE, nullptr);
+    break;
+
+  case ID_COMMIT_TRANSFORM:
+  {
+    TransformPipeline* transform = g_HexData.getTransform();
+    if (!transform)
+      break;
+
+    long long start = (long long)transform->getStart();
+    long long length = (long long)transform->getOutputLength();
+    char error[TRANSFORM_ERROR_LEN];
+    if (!g_HexData.commitTransform(error, sizeof(error)))
+      ReportTransformError(error);
+
+    g_TotalLines = (int)g_HexData.getHexLines().count;
+    if (!g_HexData.getTransform())
+    {
+      cursorBytePos = start;
+      selectionLength = length > 1 ? length : 0;
+    }
+    InvalidateWindow();
+    break;
+  }
+
+  case ID_DISCARD_TRANSFORM:
+    g_HexData.discardTransform();
+    InvalidateWindow();
+    break;
+
+  case ID_APPLY_TEMPLATE:
+    OnTemplateOpen();
+    break;
+
+  case ID_CLEAR_TEMPLATE:
+    g_HexData.clearTemplate();
+    g_TemplatePanel.firstRow = 0;
+    InvalidateWindow();
+    break;
+
+  case ID_WATCH_TOGGLE:
+  {
+    if (g_HexData.isWatchingMemory())
+      g_HexData.stopMemoryWatch();
+    else
+      g_HexData.startMemoryWatch();
+    InvalidateWindow();
+    break;
+  }
+
+  case ID_WATCH_PREVIOUS:
+  case ID_WATCH_NEXT:
+  {
+    MemoryWatch* watch = g_HexData.getMemoryWatch();
+    if (watch && watch->stepGeneration(actionId == ID_WATCH_PREVIOUS ? -1 : 1))
+      InvalidateWindow();
+    break;
+  }
+
+  case ID_WATCH_LIVE:
+  {
+    MemoryWatch* watch = g_HexData.getMemoryWatch();
+    if (watch)
+    {
+      watch->selectLive();
+      InvalidateWindow();
+    }
+    break;
+  }
+
+  case ID_SCAN_FIRST:
+  {
+#ifdef _WIN32
+    SearchDialogs::ShowInputDialog(
+      g_Hwnd,
+      "Value Scan",
+      "Type and value (u8-u64, i8-i64, f32, f64, str; ? for unknown):",
+      "i32 ?",
+      g_Options.darkMode,
+      [](const char* query) { RunFirstScan(query); },
+      nullptr);
+#elif defined(__APPLE__)
+    SearchDialogs::ShowInputDialog(
+      (NativeWindow)g_nsWindow,
+      "Value Scan",
+      "Type and value (u8-u64, i8-i64, f32, f64, str; ? for unknown):",
+      "i32 ?",
+      g_Options.darkMode,
+      [](const std::string& query) { RunFirstScan(query.c_str()); });
+#else
+    SearchDialogs::ShowInputDialog(
+      (void*)g_window,
+      "Value Scan",
+      "Type and value (u8-u64, i8-i64, f32, f64, str; ? for unknown):",
+      "i32 ?",
+      g_Options.darkMode,
+      [](const std::string& query) { RunFirstScan(query.c_str()); });
+#endif
+    break;
+  }
+
+  case ID_SCAN_CHANGED:
+    RunNextScan(SCAN_CHANGED, nullptr);
+    break;
+
+  case ID_SCAN_UNCHANGED:
+    RunNextScan(SCAN_UNCHANGED, nullptr);
+    break;
+
+  case ID_SCAN_INCREASED:
+    RunNextScan(SCAN_INCREASED, nullptr);
+    break;
+
+  case ID_SCAN_DECREASED:
+    RunNextScan(SCAN_DECREASED, nullptr);
+    break;
+
+  case ID_SCAN_EQUAL:
+  {
+#ifdef _WIN32
+    SearchDialogs::ShowInputDialog(
+      g_Hwnd,
+      "Next Scan",
+      "Value equal to:",
+      "",
+      g_Options.darkMode,
+      [](const char* text) { RunNextScan(SCAN_EXACT, text); },
+      nullptr);
+#elif defined(__APPLE__)
+    SearchDialogs::ShowInputDialog(
+      (NativeWindow)g_nsWindow,
+      "Next Scan",
+      "Value equal to:",
+      "",
+      g_Options.darkMode,
+      [](const std::string& text) { RunNextScan(SCAN_EXACT, text.c_str()); });
+#else
+    SearchDialogs::ShowInputDialog(
+      (void*)g_window,
+      "Next Scan",
+      "Value equal to:",
+      "",
+      g_Options.darkMode,
+      [](const std::string& text) { RunNextScan(SCAN_EXACT, text.c_str()); });
+#endif
+    break;
+  }
+
+  case ID_SCAN_NEXT_RESULT:
+    ShowScanResult(cursorBytePos >= 0 ? (uint64_t)cursorBytePos + 1 : 0);
+    break;
+
+  case ID_SCAN_RESET:
+    g_HexData.getValueScanner().reset();
+    InvalidateWindow();
+    break;
   }
 }
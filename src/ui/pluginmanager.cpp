@@ -521,6 +521,40 @@ void PluginManager::LoadPluginStates(PluginManagerData *data)
     }
 }
 
+static void FormatMicros(uint64_t micros, char* out)
+{
+  char whole[24];
+  itoaDec((long long)(micros / 1000), whole, 24);
+  strCopy(out, whole);
+  strCat(out, ".");
+  char tenth[2] = { (char)('0' + (micros / 100) % 10), 0 };
+  strCat(out, tenth);
+  strCat(out, "ms");
+}
+
+static void FormatByteCount(uint64_t bytes, char* out)
+{
+  const char* unit = "B";
+  uint64_t value = bytes;
+  if (bytes >= 1024ULL * 1024 * 1024)
+  {
+    value = bytes / (1024ULL * 1024 * 1024);
+    unit = "GB";
+  }
+  else if (bytes >= 1024 * 1024)
+  {
+    value = bytes / (1024 * 1024);
+    unit = "MB";
+  }
+  else if (bytes >= 1024)
+  {
+    value = bytes / 1024;
+    unit = "KB";
+  }
+  itoaDec((long long)value, out, 24);
+  strCat(out, unit);
+}
+
 void RenderPluginManager(PluginManagerData* data, int windowWidth, int windowHeight)
 {
   if (!data || !data->renderer)
@@ -543,7 +577,7 @@ void RenderPluginManager(PluginManagerData* data, int windowWidth, int windowHei
   data->renderer->drawRoundedRect(listRect, 4.0f, theme.controlBorder, false);
 
   int itemY = y + 10;
-  int itemHeight = 60;
+  int itemHeight = 78;
   int maxVisibleItems = (listHeight - 20) / itemHeight;
 
   int startIndex = data->scrollOffset;
@@ -591,6 +625,45 @@ void RenderPluginManager(PluginManagerData* data, int windowWidth, int windowHei
 
     Color descColor(120, 120, 120);
     data->renderer->drawText(plugin->description, textX, textY, descColor);
+    textY += 18;
+
+    PluginCallStats totals;
+    GetPluginProfileTotals(FindPluginProfile(plugin->path), &totals);
+
+    char column[64];
+    char value[32];
+    Color statColor(110, 150, 190);
+
+    strCopy(column, "Calls ");
+    itoaDec((long long)totals.calls, value, 32);
+    strCat(column, value);
+    data->renderer->drawText(column, textX, textY, statColor);
+
+    strCopy(column, "Total ");
+    FormatMicros(totals.totalMicros, value);
+    strCat(column, value);
+    data->renderer->drawText(column, textX + 70, textY, statColor);
+
+    strCopy(column, "Max ");
+    FormatMicros(totals.maxMicros, value);
+    strCat(column, value);
+    data->renderer->drawText(column, textX + 170, textY, statColor);
+
+    strCopy(column, "In ");
+    FormatByteCount(totals.bytesIn, value);
+    strCat(column, value);
+    data->renderer->drawText(column, textX + 260, textY, statColor);
+
+    strCopy(column, "Results ");
+    itoaDec((long long)totals.results, value, 32);
+    strCat(column, value);
+    data->renderer->drawText(column, textX + 345, textY, statColor);
+
+    strCopy(column, "Errors ");
+    itoaDec((long long)totals.errors, value, 32);
+    strCat(column, value);
+    data->renderer->drawText(column, textX + 430, textY,
+      totals.errors > 0 ? Color(220, 90, 90) : statColor);
 
     int badgeX = itemRect.x + itemRect.width - 80;
     int badgeY = itemRect.y + 10;
@@ -606,6 +679,23 @@ void RenderPluginManager(PluginManagerData* data, int windowWidth, int windowHei
     itemY += itemHeight;
   }
 
+  int statusY = listRect.y + listRect.height + 8;
+  if (data->statusText[0])
+  {
+    data->renderer->drawText(data->statusText, margin, statusY, Color(150, 150, 150));
+  }
+  else if (data->selectedPlugin >= 0 && data->selectedPlugin < (int)data->plugins.size())
+  {
+    const PluginProfile* profile = FindPluginProfile(data->plugins[data->selectedPlugin]->path);
+    if (profile && profile->lastError[0])
+    {
+      char errorLine[320];
+      strCopy(errorLine, "Last error: ");
+      stringCopy(errorLine + strLen(errorLine), profile->lastError, 300);
+      data->renderer->drawText(errorLine, margin, statusY, Color(220, 90, 90));
+    }
+  }
+
   int buttonWidth = 100;
   int buttonHeight = 30;
   int buttonSpacing = 10;
@@ -625,6 +715,13 @@ void RenderPluginManager(PluginManagerData* data, int windowWidth, int windowHei
   openFolderState.pressed = (data->pressedWidget == 1);
   data->renderer->drawModernButton(openFolderState, theme, "Plugin Folder");
 
+  Rect exportRect(margin + (buttonWidth + buttonSpacing) * 2 + 40, buttonY,
+    buttonWidth - 20, buttonHeight);
+  WidgetState exportState(exportRect);
+  exportState.hovered = (data->hoveredWidget == 4);
+  exportState.pressed = (data->pressedWidget == 4);
+  data->renderer->drawModernButton(exportState, theme, "Export");
+
   Rect okButtonRect(windowWidth - margin - buttonWidth * 2 - buttonSpacing,
     buttonY, buttonWidth, buttonHeight);
   WidgetState okButtonState(okButtonRect);
@@ -651,7 +748,7 @@ void UpdatePluginHoverState(PluginManagerData* data, int x, int y, int windowWid
   int listHeight = windowHeight - 150;
 
   int itemY = listY + 10;
-  int itemHeight = 60;
+  int itemHeight = 78;
   int maxVisibleItems = (listHeight - 20) / itemHeight;
 
   int startIndex = data->scrollOffset;
@@ -688,6 +785,14 @@ void UpdatePluginHoverState(PluginManagerData* data, int x, int y, int windowWid
     return;
   }
 
+  Rect exportRect(margin + (buttonWidth + buttonSpacing) * 2 + 40, buttonY,
+    buttonWidth - 20, buttonHeight);
+  if (IsPointInRect(x, y, exportRect))
+  {
+    data->hoveredWidget = 4;
+    return;
+  }
+
   Rect okButtonRect(windowWidth - margin - buttonWidth * 2 - buttonSpacing,
     buttonY, buttonWidth, buttonHeight);
   if (IsPointInRect(x, y, okButtonRect))
@@ -713,7 +818,7 @@ void HandlePluginClick(PluginManagerData* data, int x, int y, int windowWidth, i
 
     int margin = 20;
     int listY = margin + 35;
-    int itemHeight = 60;
+    int itemHeight = 78;
     int itemY = listY + 10 + (data->hoveredPlugin - data->scrollOffset) * itemHeight;
 
     Rect checkboxRect(margin + 20, itemY + 20, 18, 18);
@@ -775,6 +880,27 @@ void HandlePluginClick(PluginManagerData* data, int x, int y, int windowWidth, i
     break;
   }
 
+  case 4:
+  {
+    char statsPath[512];
+    GetConfigPath(statsPath, 512);
+    char* slash = strRChr(statsPath, '/');
+    char* backslash = strRChr(statsPath, '\\');
+    char* fileName = (backslash > slash) ? backslash + 1 : (slash ? slash + 1 : statsPath);
+    strCopy(fileName, "plugin_stats.json");
+
+    if (ExportPluginProfiles(statsPath))
+    {
+      strCopy(data->statusText, "Stats exported to ");
+      stringCopy(data->statusText + strLen(data->statusText), statsPath, 230);
+    }
+    else
+    {
+      strCopy(data->statusText, "Failed to export plugin stats");
+    }
+    break;
+  }
+
   case 2:
     PluginManager::SavePluginStates(data);
     data->dialogResult = true;
@@ -8,6 +8,8 @@
 #ifdef __linux__
 #include <dirent.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -44,6 +46,46 @@ extern void ApplyEnabledPlugins();
 
 static ProcessDialogData* g_processDialogData = nullptr;
 
+#define PROCESS_LIST_INITIAL_CAPACITY 256
+
+static bool GrowProcessArray(void** items, size_t itemSize, int count, int* capacity, int needed)
+{
+  if (*items && needed <= *capacity)
+    return true;
+
+  int newCapacity = *capacity > 0 ? *capacity : PROCESS_LIST_INITIAL_CAPACITY;
+  while (newCapacity < needed)
+    newCapacity *= 2;
+
+  void* grown = platformAlloc(itemSize * newCapacity);
+  if (!grown)
+    return false;
+
+  if (*items)
+  {
+    memCopy(grown, *items, itemSize * count);
+    platformFree(*items, itemSize * *capacity);
+  }
+
+  *items = grown;
+  *capacity = newCapacity;
+  return true;
+}
+
+static bool ReserveProcessList(ProcessList* list, int needed)
+{
+  return GrowProcessArray((void**)&list->entries, sizeof(ProcessEntry), list->count, &list->capacity, needed);
+}
+
+static void FreeProcessList(ProcessList* list)
+{
+  if (list->entries)
+    platformFree(list->entries, sizeof(ProcessEntry) * list->capacity);
+  list->entries = nullptr;
+  list->count = 0;
+  list->capacity = 0;
+}
+
 
 void RenderProcessDialog(ProcessDialogData* data, int windowWidth, int windowHeight)
 {
@@ -329,7 +371,7 @@ void SortProcessPriorities(ProcessPriority* priorities, int count)
 
 bool EnumerateProcesses(ProcessList* list)
 {
-  if (!list || !list->entries)
+  if (!list)
     return false;
 
   HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
@@ -346,8 +388,10 @@ bool EnumerateProcesses(ProcessList* list)
     return false;
   }
 
-  ProcessEntry* tempEntries = (ProcessEntry*)platformAlloc(sizeof(ProcessEntry) * 512);
-  ProcessPriority* priorities = (ProcessPriority*)platformAlloc(sizeof(ProcessPriority) * 512);
+  ProcessEntry* tempEntries = nullptr;
+  ProcessPriority* priorities = nullptr;
+  int entryCapacity = 0;
+  int priorityCapacity = 0;
   int tempCount = 0;
 
   FILETIME currentTime;
@@ -358,7 +402,8 @@ bool EnumerateProcesses(ProcessList* list)
 
   do
   {
-    if (tempCount >= 512)
+    if (!GrowProcessArray((void**)&tempEntries, sizeof(ProcessEntry), tempCount, &entryCapacity, tempCount + 1) ||
+        !GrowProcessArray((void**)&priorities, sizeof(ProcessPriority), tempCount, &priorityCapacity, tempCount + 1))
       break;
 
     if (pe.th32ProcessID == 0 || pe.th32ProcessID == 4)
@@ -448,15 +493,18 @@ bool EnumerateProcesses(ProcessList* list)
   SortProcessPriorities(priorities, tempCount);
 
   list->count = 0;
-  for (int i = 0; i < tempCount && i < (int)list->capacity; i++)
+  if (ReserveProcessList(list, tempCount))
   {
-    int sourceIndex = priorities[i].index;
-    list->entries[list->count] = tempEntries[sourceIndex];
-    list->count++;
+    for (int i = 0; i < tempCount; i++)
+    {
+      int sourceIndex = priorities[i].index;
+      list->entries[list->count] = tempEntries[sourceIndex];
+      list->count++;
+    }
   }
 
-  platformFree(tempEntries, sizeof(ProcessEntry) * 512);
-  platformFree(priorities, sizeof(ProcessPriority) * 512);
+  platformFree(tempEntries, sizeof(ProcessEntry) * entryCapacity);
+  platformFree(priorities, sizeof(ProcessPriority) * priorityCapacity);
 
   return true;
 }
@@ -496,6 +544,10 @@ bool ReadProcessMemoryData(int pid, HexData* hexData)
   void* moduleBase = modInfo.lpBaseOfDll;
   SIZE_T moduleSize = modInfo.SizeOfImage;
 
+  char moduleName[MEMORY_REGION_NAME_LEN];
+  if (!GetModuleBaseNameA(hProcess, hModules[0], moduleName, sizeof(moduleName)))
+    moduleName[0] = '\0';
+
   ByteBuffer tempBuffer;
   bb_init(&tempBuffer);
 
@@ -539,6 +591,15 @@ bool ReadProcessMemoryData(int pid, HexData* hexData)
             region.virtualAddress = (uint64_t)mbi.BaseAddress;
             region.bufferOffset = oldSize;
             region.size = bytesRead;
+            region.protection = MEMORY_PROT_READ;
+            if (mbi.Protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY))
+              region.protection |= MEMORY_PROT_WRITE;
+            if (mbi.Protect & (PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY))
+              region.protection |= MEMORY_PROT_EXEC;
+            if (mbi.Type == MEM_MAPPED)
+              region.protection |= MEMORY_PROT_SHARED;
+            region.fileOffset = (uint64_t)((uint8_t*)mbi.BaseAddress - (uint8_t*)moduleBase);
+            stringCopy(region.name, moduleName, sizeof(region.name));
             memoryMap.push_back(region);
 
             bb_resize(&tempBuffer, oldSize + bytesRead);
@@ -569,6 +630,7 @@ bool ReadProcessMemoryData(int pid, HexData* hexData)
   {
     hexData->fileData.data[i] = tempBuffer.data[i];
   }
+  hexData->invalidateContentHash();
 
   hexData->setMemoryMap(memoryMap);
   hexData->isProcessMemory = true;
@@ -720,26 +782,13 @@ bool ShowProcessDialog(HWND parent, AppOptions& options)
 
   g_processDialogData = &data;
 
-  data.processes.capacity = 512;
+  data.processes.entries = nullptr;
   data.processes.count = 0;
-  data.processes.entries = (ProcessEntry*)platformAlloc(sizeof(ProcessEntry) * 512);
-
-  if (!data.processes.entries)
-  {
-    g_processDialogData = nullptr;
-    return false;
-  }
-
-  for (int i = 0; i < 512; i++)
-  {
-    data.processes.entries[i].pid = 0;
-    data.processes.entries[i].name[0] = '\0';
-    data.processes.entries[i].is64bit = false;
-  }
+  data.processes.capacity = 0;
 
   if (!EnumerateProcesses(&data.processes))
   {
-    platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+    FreeProcessList(&data.processes);
     g_processDialogData = nullptr;
     return false;
   }
@@ -765,7 +814,7 @@ bool ShowProcessDialog(HWND parent, AppOptions& options)
 
   if (!hwnd)
   {
-    platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+    FreeProcessList(&data.processes);
     g_processDialogData = nullptr;
     return false;
   }
@@ -785,7 +834,7 @@ bool ShowProcessDialog(HWND parent, AppOptions& options)
     if (data.renderer)
       delete data.renderer;
     DestroyWindow(hwnd);
-    platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+    FreeProcessList(&data.processes);
     g_processDialogData = nullptr;
     return false;
   }
@@ -825,7 +874,7 @@ bool ShowProcessDialog(HWND parent, AppOptions& options)
   DestroyWindow(hwnd);
   UnregisterClassW(className, GetModuleHandleW(NULL));
 
-  platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+  FreeProcessList(&data.processes);
   g_processDialogData = nullptr;
 
   if (selectedPid > 0)
@@ -861,33 +910,105 @@ bool ShowProcessDialog(HWND parent, AppOptions& options)
 
 #ifdef __linux__
 
-bool IsProcessRecentlyAccessed(int pid, time_t* outTime)
+static ssize_t ReadProcFile(const char* path, char* buffer, size_t size)
 {
-  char statPath[256];
-  snprintf(statPath, sizeof(statPath), "/proc/%d/stat", pid);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return -1;
 
-  FILE* f = fopen(statPath, "r");
-  if (!f)
+  ssize_t total = 0;
+  while ((size_t)total < size)
+  {
+    ssize_t got = read(fd, buffer + total, size - (size_t)total);
+    if (got <= 0)
+      break;
+    total += got;
+  }
+
+  close(fd);
+  return total;
+}
+
+static bool ParseProcessStartTicks(const char* stat, ssize_t length, unsigned long long* outTicks)
+{
+  // The command name may contain spaces and parentheses, so fields are
+  // counted from the last ')'. The start time is field 22.
+  ssize_t pos = length - 1;
+  while (pos >= 0 && stat[pos] != ')')
+    pos--;
+  if (pos < 0)
     return false;
 
-  unsigned long long starttime;
-  char comm[256];
-  char state;
-  int ppid;
+  int field = 2;
+  for (pos++; pos < length && field < 22; pos++)
+  {
+    if (stat[pos] == ' ')
+      field++;
+  }
 
-  if (fscanf(f, "%*d %s %c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
-    comm, &state, &ppid, &starttime) < 4)
+  unsigned long long ticks = 0;
+  bool digits = false;
+  for (; pos < length && stat[pos] >= '0' && stat[pos] <= '9'; pos++)
   {
-    fclose(f);
-    return false;
+    ticks = ticks * 10 + (unsigned long long)(stat[pos] - '0');
+    digits = true;
+  }
+
+  *outTicks = ticks;
+  return digits;
+}
+
+static time_t GetBootTime()
+{
+  static time_t bootTime = -1;
+  if (bootTime >= 0)
+    return bootTime;
+
+  bootTime = 0;
+  FILE* f = fopen("/proc/stat", "r");
+  if (!f)
+    return bootTime;
+
+  char line[256];
+  while (fgets(line, sizeof(line), f))
+  {
+    unsigned long long seconds;
+    if (sscanf(line, "btime %llu", &seconds) == 1)
+    {
+      bootTime = (time_t)seconds;
+      break;
+    }
   }
 
   fclose(f);
+  return bootTime;
+}
+
+static time_t ProcessStartToTime(unsigned long long ticks)
+{
+  static long ticksPerSecond = 0;
+  if (ticksPerSecond <= 0)
+    ticksPerSecond = sysconf(_SC_CLK_TCK);
+  if (ticksPerSecond <= 0)
+    ticksPerSecond = 100;
+
+  return GetBootTime() + (time_t)(ticks / (unsigned long long)ticksPerSecond);
+}
+
+bool IsProcessRecentlyAccessed(int pid, time_t* outTime)
+{
+  char statPath[64];
+  snprintf(statPath, sizeof(statPath), "/proc/%d/stat", pid);
 
-  time_t procStartTime = starttime / sysconf(_SC_CLK_TCK);
+  char stat[512];
+  ssize_t length = ReadProcFile(statPath, stat, sizeof(stat));
+
+  unsigned long long starttime;
+  if (length <= 0 || !ParseProcessStartTicks(stat, length, &starttime))
+    return false;
 
   if (outTime)
-    *outTime = procStartTime;
+    *outTime = ProcessStartToTime(starttime);
 
   return true;
 }
@@ -973,142 +1094,233 @@ int CompareProcessPriority(const void* a, const void* b)
   return 0;
 }
 
-bool EnumerateProcesses(ProcessList* list)
+#define PROCESS_PROBE_BUFFER 4096
+#define PROCESS_PROBE_MAX_THREADS 8
+#define PROCESS_PROBE_PARALLEL_THRESHOLD 256
+
+struct ProcessCacheEntry
 {
+  int pid;
+  unsigned long long startTicks;
+  bool listed;
+  ProcessEntry entry;
+};
 
-  if (!list || !list->entries)
+struct ProcessProbeJob
+{
+  const Vector<ProcessCacheEntry>* previous;
+  ProcessCacheEntry* results;
+  int count;
+  volatile long next;
+};
+
+// Keyed by pid and start time, so a refresh only probes processes it has
+// not seen before. Sorted by pid.
+static Vector<ProcessCacheEntry> g_ProcessCache;
+
+static int CompareProcessIds(const void* a, const void* b)
+{
+  int pa = *(const int*)a;
+  int pb = *(const int*)b;
+  return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+static const ProcessCacheEntry* FindCachedProcess(const Vector<ProcessCacheEntry>& cache, int pid)
+{
+  size_t lo = 0;
+  size_t hi = cache.size();
+  while (lo < hi)
   {
-    return false;
+    size_t mid = lo + (hi - lo) / 2;
+    if (cache[mid].pid < pid)
+      lo = mid + 1;
+    else
+      hi = mid;
   }
+  return lo < cache.size() && cache[lo].pid == pid ? &cache[lo] : nullptr;
+}
 
-  DIR* procDir = opendir("/proc");
-  if (!procDir)
+static void ProbeProcess(ProcessCacheEntry* item, const Vector<ProcessCacheEntry>* previous, char* buffer)
+{
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%d/stat", item->pid);
+
+  ssize_t length = ReadProcFile(path, buffer, PROCESS_PROBE_BUFFER);
+  if (length <= 0 || !ParseProcessStartTicks(buffer, length, &item->startTicks))
   {
-    return false;
+    item->pid = 0;
+    return;
   }
 
-  ProcessEntry* tempEntries = (ProcessEntry*)platformAlloc(sizeof(ProcessEntry) * 512);
-  ProcessPriority* priorities = (ProcessPriority*)platformAlloc(sizeof(ProcessPriority) * 512);
+  const ProcessCacheEntry* cached = FindCachedProcess(*previous, item->pid);
+  if (cached && cached->startTicks == item->startTicks)
+  {
+    *item = *cached;
+    return;
+  }
+
+  ProcessEntry* e = &item->entry;
+  e->pid = item->pid;
+  e->name[0] = 0;
+  e->is64bit = false;
+
+  snprintf(path, sizeof(path), "/proc/%d/cmdline", item->pid);
+  length = ReadProcFile(path, buffer, PROCESS_PROBE_BUFFER - 1);
+  item->listed = length > 0;
+  if (!item->listed)
+    return;
+  buffer[length] = 0;
 
-  if (!tempEntries || !priorities)
+  const char* procName = buffer;
+  for (const char* c = buffer; *c; c++)
   {
+    if (*c == '/')
+      procName = c + 1;
+  }
 
-    if (tempEntries) platformFree(tempEntries, sizeof(ProcessEntry) * 512);
-    if (priorities) platformFree(priorities, sizeof(ProcessPriority) * 512);
-    closedir(procDir);
-    return false;
+  int i = 0;
+  while (i < 259 && procName[i] != 0)
+  {
+    e->name[i] = procName[i];
+    i++;
   }
+  e->name[i] = 0;
 
+  snprintf(path, sizeof(path), "/proc/%d/exe", item->pid);
+  unsigned char elfHeader[5];
+  if (ReadProcFile(path, (char*)elfHeader, sizeof(elfHeader)) == 5 &&
+    elfHeader[0] == 0x7F && elfHeader[1] == 'E' &&
+    elfHeader[2] == 'L' && elfHeader[3] == 'F')
+  {
+    e->is64bit = (elfHeader[4] == 2);
+  }
+}
 
-  int tempCount = 0;
-  time_t currentTime = time(NULL);
-  struct dirent* entry;
+static void* RunProcessProbe(void* param)
+{
+  ProcessProbeJob* job = (ProcessProbeJob*)param;
+  char* buffer = (char*)platformAlloc(PROCESS_PROBE_BUFFER);
+  if (!buffer)
+    return nullptr;
 
-  while ((entry = readdir(procDir)) != NULL && tempCount < 512)
+  for (;;)
   {
-    int pid = atoi(entry->d_name);
-    if (pid <= 0)
-      continue;
-
+    long index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+    if (index >= job->count)
+      break;
+    ProbeProcess(&job->results[index], job->previous, buffer);
+  }
 
-    char cmdlinePath[256];
-    snprintf(cmdlinePath, sizeof(cmdlinePath), "/proc/%d/cmdline", pid);
+  platformFree(buffer, PROCESS_PROBE_BUFFER);
+  return nullptr;
+}
 
-    FILE* cmdFile = fopen(cmdlinePath, "r");
-    if (!cmdFile)
-    {
-      continue;
-    }
+bool EnumerateProcesses(ProcessList* list)
+{
+  if (!list)
+    return false;
 
-    char cmdline[260];
-    size_t len = fread(cmdline, 1, sizeof(cmdline) - 1, cmdFile);
-    fclose(cmdFile);
-    cmdline[len] = '\0';
+  DIR* procDir = opendir("/proc");
+  if (!procDir)
+    return false;
 
-    if (len == 0)
-    {
-      continue;
-    }
+  Vector<int> pids;
+  struct dirent* entry;
+  while ((entry = readdir(procDir)) != NULL)
+  {
+    const char* name = entry->d_name;
+    int pid = 0;
+    while (*name >= '0' && *name <= '9')
+      pid = pid * 10 + (*name++ - '0');
+    if (pid > 0 && *name == 0)
+      pids.push_back(pid);
+  }
+  closedir(procDir);
 
-    ProcessEntry* e = &tempEntries[tempCount];
-    e->pid = pid;
+  int count = (int)pids.size();
+  if (count == 0)
+  {
+    list->count = 0;
+    return true;
+  }
 
-    const char* procName = cmdline;
-    const char* lastSlash = NULL;
-    for (size_t i = 0; i < len && cmdline[i]; i++)
-    {
-      if (cmdline[i] == '/')
-        lastSlash = &cmdline[i];
-    }
-    if (lastSlash)
-      procName = lastSlash + 1;
+  qsort(&pids[0], count, sizeof(int), CompareProcessIds);
 
-    int i = 0;
-    while (i < 259 && procName[i] != 0)
-    {
-      e->name[i] = procName[i];
-      i++;
-    }
-    e->name[i] = 0;
+  ProcessCacheEntry* results = (ProcessCacheEntry*)platformAlloc(sizeof(ProcessCacheEntry) * count);
+  if (!results)
+    return false;
+  for (int i = 0; i < count; i++)
+    results[i].pid = pids[i];
 
-    char exePath[256];
-    char exeLink[512];
-    snprintf(exePath, sizeof(exePath), "/proc/%d/exe", pid);
-    ssize_t linkLen = readlink(exePath, exeLink, sizeof(exeLink) - 1);
+  ProcessProbeJob job;
+  job.previous = &g_ProcessCache;
+  job.results = results;
+  job.count = count;
+  job.next = 0;
 
-    e->is64bit = false;
-    if (linkLen > 0)
-    {
-      exeLink[linkLen] = '\0';
+  // Probing is syscall-bound, so wide process tables are spread over a few
+  // threads; the calling thread always takes part.
+  int threadCount = 1;
+  if (count >= PROCESS_PROBE_PARALLEL_THRESHOLD)
+  {
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    threadCount = cpuCount > 1 ? (int)cpuCount : 1;
+    if (threadCount > PROCESS_PROBE_MAX_THREADS)
+      threadCount = PROCESS_PROBE_MAX_THREADS;
+  }
 
-      FILE* exeFile = fopen(exeLink, "rb");
-      if (exeFile)
-      {
-        unsigned char elfHeader[5];
-        if (fread(elfHeader, 1, 5, exeFile) == 5)
-        {
-          if (elfHeader[0] == 0x7F && elfHeader[1] == 'E' &&
-            elfHeader[2] == 'L' && elfHeader[3] == 'F')
-          {
-            e->is64bit = (elfHeader[4] == 2);
-          }
-        }
-        fclose(exeFile);
-      }
-    }
+  pthread_t threads[PROCESS_PROBE_MAX_THREADS];
+  bool started[PROCESS_PROBE_MAX_THREADS] = {};
+  for (int i = 1; i < threadCount; i++)
+    started[i] = pthread_create(&threads[i], nullptr, RunProcessProbe, &job) == 0;
 
-    priorities[tempCount].index = tempCount;
-    priorities[tempCount].priority = 1;
+  RunProcessProbe(&job);
 
-    time_t processTime;
-    if (IsProcessRecentlyAccessed(pid, &processTime))
-    {
-      priorities[tempCount].timestamp = (uint64_t)processTime;
+  for (int i = 1; i < threadCount; i++)
+  {
+    if (started[i])
+      pthread_join(threads[i], nullptr);
+  }
 
-      if ((currentTime - processTime) < 3600)
-        priorities[tempCount].priority = 3;
-    }
+  g_ProcessCache.clear();
 
-    tempCount++;
+  ProcessPriority* priorities = (ProcessPriority*)platformAlloc(sizeof(ProcessPriority) * count);
+  if (!priorities)
+  {
+    platformFree(results, sizeof(ProcessCacheEntry) * count);
+    return false;
   }
 
-  closedir(procDir);
+  int listedCount = 0;
+  time_t currentTime = time(NULL);
+  for (int i = 0; i < count; i++)
+  {
+    if (results[i].pid <= 0)
+      continue;
+
+    g_ProcessCache.push_back(results[i]);
+    if (!results[i].listed)
+      continue;
 
+    time_t processTime = ProcessStartToTime(results[i].startTicks);
+    priorities[listedCount].index = i;
+    priorities[listedCount].priority = (currentTime - processTime) < 3600 ? 3 : 1;
+    priorities[listedCount].timestamp = (uint64_t)processTime;
+    listedCount++;
+  }
 
-  qsort(priorities, tempCount, sizeof(ProcessPriority), CompareProcessPriority);
+  if (listedCount > 0)
+    qsort(priorities, listedCount, sizeof(ProcessPriority), CompareProcessPriority);
 
   list->count = 0;
-  for (int i = 0; i < tempCount && i < (int)list->capacity; i++)
+  if (ReserveProcessList(list, listedCount))
   {
-    int sourceIndex = priorities[i].index;
-    list->entries[list->count] = tempEntries[sourceIndex];
-    list->count++;
+    for (int i = 0; i < listedCount; i++)
+      list->entries[list->count++] = results[priorities[i].index].entry;
   }
 
-
-  platformFree(tempEntries, sizeof(ProcessEntry) * 512);
-  platformFree(priorities, sizeof(ProcessPriority) * 512);
-
+  platformFree(priorities, sizeof(ProcessPriority) * count);
+  platformFree(results, sizeof(ProcessCacheEntry) * count);
 
   return true;
 }
@@ -1129,70 +1341,46 @@ bool ReadProcessMemoryData(int pid, HexData* hexData)
     return false;
   }
 
-  ByteBuffer tempBuffer;
-  bb_init(&tempBuffer);
+  Vector<MemoryRegion> regions;
 
-  char line[512];
+  char line[1024];
   while (fgets(line, sizeof(line), mapsFile))
   {
-    unsigned long long startAddr, endAddr;
+    unsigned long long startAddr, endAddr, fileOffset;
     char perms[5];
+    int nameStart = 0;
 
-    if (sscanf(line, "%llx-%llx %4s", &startAddr, &endAddr, perms) != 3)
-      continue;
-
-    if (perms[0] != 'r')
+    if (sscanf(line, "%llx-%llx %4s %llx %*s %*s %n", &startAddr, &endAddr, perms, &fileOffset, &nameStart) != 4)
       continue;
 
-    size_t regionSize = (size_t)(endAddr - startAddr);
-
-    if (regionSize > 100 * 1024 * 1024)
+    if (perms[0] != 'r' || endAddr <= startAddr)
       continue;
 
-    size_t oldSize = tempBuffer.size;
-    size_t newSize = oldSize + regionSize;
-
-    if (!bb_resize(&tempBuffer, newSize))
-    {
-      continue;
-    }
-
-    struct iovec local[1];
-    struct iovec remote[1];
-
-    local[0].iov_base = tempBuffer.data + oldSize;
-    local[0].iov_len = regionSize;
-    remote[0].iov_base = (void*)startAddr;
-    remote[0].iov_len = regionSize;
+    MemoryRegion region;
+    region.virtualAddress = startAddr;
+    region.bufferOffset = 0;
+    region.size = (size_t)(endAddr - startAddr);
+    region.protection = MEMORY_PROT_READ;
+    if (perms[1] == 'w')
+      region.protection |= MEMORY_PROT_WRITE;
+    if (perms[2] == 'x')
+      region.protection |= MEMORY_PROT_EXEC;
+    if (perms[3] == 's')
+      region.protection |= MEMORY_PROT_SHARED;
+    region.fileOffset = fileOffset;
 
-    ssize_t nread = process_vm_readv(pid, local, 1, remote, 1, 0);
+    char* name = line + nameStart;
+    size_t nameLength = strlen(name);
+    while (nameLength > 0 && (name[nameLength - 1] == '\n' || name[nameLength - 1] == ' '))
+      name[--nameLength] = '\0';
+    stringCopy(region.name, name, sizeof(region.name));
 
-    if (nread > 0)
-    {
-      bb_resize(&tempBuffer, oldSize + (size_t)nread);
-    }
-    else
-    {
-      bb_resize(&tempBuffer, oldSize);
-    }
+    regions.push_back(region);
   }
 
   fclose(mapsFile);
 
-  if (tempBuffer.size > 0)
-  {
-    bb_resize(&hexData->fileData, tempBuffer.size);
-    for (size_t i = 0; i < tempBuffer.size; i++)
-    {
-      hexData->fileData.data[i] = tempBuffer.data[i];
-    }
-    hexData->convertDataToHex(16);
-    bb_free(&tempBuffer);
-    return true;
-  }
-
-  bb_free(&tempBuffer);
-  return false;
+  return hexData->attachProcess(pid, regions);
 }
 
 bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
@@ -1216,26 +1404,13 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
 
   g_processDialogData = &data;
 
-  data.processes.capacity = 512;
+  data.processes.entries = nullptr;
   data.processes.count = 0;
-  data.processes.entries = (ProcessEntry*)platformAlloc(sizeof(ProcessEntry) * 512);
-
-  if (!data.processes.entries)
-  {
-    g_processDialogData = nullptr;
-    return false;
-  }
-
-  for (int i = 0; i < 512; i++)
-  {
-    data.processes.entries[i].pid = 0;
-    data.processes.entries[i].name[0] = '\0';
-    data.processes.entries[i].is64bit = false;
-  }
+  data.processes.capacity = 0;
 
   if (!EnumerateProcesses(&data.processes))
   {
-    platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+    FreeProcessList(&data.processes);
     g_processDialogData = nullptr;
     return false;
   }
@@ -1277,7 +1452,7 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
 
   if (!dialog)
   {
-    platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+    FreeProcessList(&data.processes);
     g_processDialogData = nullptr;
     return false;
   }
@@ -1324,7 +1499,7 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
       delete data.renderer;
 
     XDestroyWindow(g_display, dialog);
-    platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+    FreeProcessList(&data.processes);
     g_processDialogData = nullptr;
     return false;
   }
@@ -1423,6 +1598,13 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
           data.dialogResult = false;
           data.running = false;
         }
+        else if (key == XK_F5)
+        {
+          EnumerateProcesses(&data.processes);
+          data.selectedIndex = -1;
+          data.hoveredIndex = -1;
+          needsRedraw = true;
+        }
       }
       break;
       }
@@ -1459,7 +1641,7 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
   XDestroyWindow(g_display, dialog);
   XFlush(g_display);
 
-  platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+  FreeProcessList(&data.processes);
   g_processDialogData = nullptr;
 
   if (selectedPid > 0)
@@ -1565,7 +1747,7 @@ int CompareProcessPriority(const void* a, const void* b)
 
 bool EnumerateProcesses(ProcessList* list)
 {
-  if (!list || !list->entries)
+  if (!list)
     return false;
 
   int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_ALL, 0 };
@@ -1586,18 +1768,24 @@ bool EnumerateProcesses(ProcessList* list)
 
   int procCount = (int)(size / sizeof(struct kinfo_proc));
 
-  ProcessEntry* tempEntries = (ProcessEntry*)platformAlloc(sizeof(ProcessEntry) * 512);
-  ProcessPriority* priorities = (ProcessPriority*)platformAlloc(sizeof(ProcessPriority) * 512);
+  ProcessEntry* tempEntries = nullptr;
+  ProcessPriority* priorities = nullptr;
+  int entryCapacity = 0;
+  int priorityCapacity = 0;
   int tempCount = 0;
 
   time_t currentTime = time(NULL);
 
-  for (int i = 0; i < procCount && tempCount < 512; i++)
+  for (int i = 0; i < procCount; i++)
   {
     int pid = procList[i].kp_proc.p_pid;
     if (pid <= 0)
       continue;
 
+    if (!GrowProcessArray((void**)&tempEntries, sizeof(ProcessEntry), tempCount, &entryCapacity, tempCount + 1) ||
+        !GrowProcessArray((void**)&priorities, sizeof(ProcessPriority), tempCount, &priorityCapacity, tempCount + 1))
+      break;
+
     ProcessEntry* e = &tempEntries[tempCount];
     e->pid = pid;
 
@@ -1673,18 +1861,22 @@ bool EnumerateProcesses(ProcessList* list)
 
   free(procList);
 
-  qsort(priorities, tempCount, sizeof(ProcessPriority), CompareProcessPriority);
+  if (tempCount > 0)
+    qsort(priorities, tempCount, sizeof(ProcessPriority), CompareProcessPriority);
 
   list->count = 0;
-  for (int i = 0; i < tempCount && i < (int)list->capacity; i++)
+  if (ReserveProcessList(list, tempCount))
   {
-    int sourceIndex = priorities[i].index;
-    list->entries[list->count] = tempEntries[sourceIndex];
-    list->count++;
+    for (int i = 0; i < tempCount; i++)
+    {
+      int sourceIndex = priorities[i].index;
+      list->entries[list->count] = tempEntries[sourceIndex];
+      list->count++;
+    }
   }
 
-  platformFree(tempEntries, sizeof(ProcessEntry) * 512);
-  platformFree(priorities, sizeof(ProcessPriority) * 512);
+  platformFree(tempEntries, sizeof(ProcessEntry) * entryCapacity);
+  platformFree(priorities, sizeof(ProcessPriority) * priorityCapacity);
 
   return true;
 }
@@ -1762,6 +1954,7 @@ bool ReadProcessMemoryData(int pid, HexData* hexData)
     {
       hexData->fileData.data[i] = tempBuffer.data[i];
     }
+    hexData->invalidateContentHash();
     hexData->convertDataToHex(16);
     bb_free(&tempBuffer);
     return true;
@@ -1787,26 +1980,13 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
 
     g_processDialogData = &data;
 
-    data.processes.capacity = 512;
+    data.processes.entries = nullptr;
     data.processes.count = 0;
-    data.processes.entries = (ProcessEntry*)platformAlloc(sizeof(ProcessEntry) * 512);
-
-    if (!data.processes.entries)
-    {
-      g_processDialogData = nullptr;
-      return false;
-    }
-
-    for (int i = 0; i < 512; i++)
-    {
-      data.processes.entries[i].pid = 0;
-      data.processes.entries[i].name[0] = '\0';
-      data.processes.entries[i].is64bit = false;
-    }
+    data.processes.capacity = 0;
 
     if (!EnumerateProcesses(&data.processes))
     {
-      platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+      FreeProcessList(&data.processes);
       g_processDialogData = nullptr;
       return false;
     }
@@ -1842,7 +2022,7 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
       if (data.renderer)
         delete data.renderer;
       [dialog close] ;
-      platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+      FreeProcessList(&data.processes);
       g_processDialogData = nullptr;
       return false;
     }
@@ -1896,7 +2076,7 @@ bool ShowProcessDialog(NativeWindow parent, AppOptions& options)
     [parentWindow removeChildWindow:dialog];
     [dialog close] ;
 
-    platformFree(data.processes.entries, sizeof(ProcessEntry) * 512);
+    FreeProcessList(&data.processes);
     g_processDialogData = nullptr;
 
     if (selectedPid > 0)
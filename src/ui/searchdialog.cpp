@@ -304,6 +304,57 @@ namespace SearchDialogs
             data->hoveredWidget = 1;
     }
 
+    static long long ParseGoToValue(const char* str)
+    {
+        long long value = 0;
+        bool isHex = false;
+
+        while (*str == ' ') str++;
+
+        if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+        {
+            isHex = true;
+            str += 2;
+        }
+        else if (str[0] == 'x' || str[0] == 'X')
+        {
+            isHex = true;
+            str += 1;
+        }
+        else
+        {
+            for (const char* check = str; *check; check++)
+            {
+                char c = *check;
+                if ((c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f'))
+                {
+                    isHex = true;
+                    break;
+                }
+            }
+        }
+
+        for (; *str; str++)
+        {
+            char c = *str;
+            int digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (isHex && c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            else if (isHex && c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c == ' ' || c == '`' || c == '_')
+                continue;
+            else
+                break;
+
+            value = value * (isHex ? 16 : 10) + digit;
+        }
+
+        return value;
+    }
+
     void HandleGoToClick(GoToDialogData *data, int x, int y, int windowWidth, int windowHeight)
 {
 	int margin = 20;
@@ -322,62 +373,9 @@ namespace SearchDialogs
 		if (data->callback)
 		{
 #ifdef _WIN32
-			const char* str = data->lineNumberText;
-			int offset = 0;
-			bool isHex = false;
-			
-			while (*str == ' ') str++;
-			
-			if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
-			{
-				isHex = true;
-				str += 2;
-			}
-			else if (str[0] == 'x' || str[0] == 'X')
-			{
-				isHex = true;
-				str += 1;
-			}
-			else
-			{
-				const char* check = str;
-				while (*check)
-				{
-					char c = *check;
-					if ((c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f'))
-					{
-						isHex = true;
-						break;
-					}
-					check++;
-				}
-			}
-			
-			if (isHex)
-			{
-				while (*str)
-				{
-					char c = *str;
-					if (c >= '0' && c <= '9')
-						offset = offset * 16 + (c - '0');
-					else if (c >= 'A' && c <= 'F')
-						offset = offset * 16 + (c - 'A' + 10);
-					else if (c >= 'a' && c <= 'f')
-						offset = offset * 16 + (c - 'a' + 10);
-					else if (c != ' ')
-						break;
-					str++;
-				}
-			}
-			else
-			{
-        offset = strToInt(data->lineNumberText);
-      }
-			
-			data->callback(offset);
+			data->callback(ParseGoToValue(data->lineNumberText));
 #else
-			int offset = strToInt(data->lineNumberText.c_str());
-			data->callback(offset);
+			data->callback(ParseGoToValue(data->lineNumberText.c_str()));
 #endif
 		}
 	}
@@ -1195,11 +1193,11 @@ namespace SearchDialogs
 
 #ifdef _WIN32
     void ShowGoToDialog(void *parentHandle, bool darkMode,
-                        void (*callback)(int), void *userData)
+                        void (*callback)(long long), void *userData)
     {
 #else
     void ShowGoToDialog(void *parentHandle, bool darkMode,
-                        std::function<void(int)> callback)
+                        std::function<void(long long)> callback)
     {
 #endif
 